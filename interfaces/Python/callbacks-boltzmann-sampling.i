@@ -24,6 +24,7 @@ static python_bs_callback_t *
 bind_bs_callback(PyObject *PyFunc,
                  PyObject *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   python_bs_callback_t *cb = (python_bs_callback_t *)vrna_alloc(sizeof(python_bs_callback_t));
 
@@ -38,6 +39,8 @@ bind_bs_callback(PyObject *PyFunc,
 static void
 release_bs_callback(python_bs_callback_t *cb)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   Py_DECREF(cb->cb);
   Py_DECREF(cb->data);
   free(cb); 
@@ -47,6 +50,8 @@ static void
 python_wrap_bs_cb(const char *structure,
                   void       *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject *func, *arglist, *result, *err;
   python_bs_callback_t *cb = (python_bs_callback_t *)data;
 
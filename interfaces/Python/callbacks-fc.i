@@ -59,6 +59,8 @@ delete_pydata(pycallback_t *cb)
 static void
 delete_pycallback(void * data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   pycallback_t *cb = (pycallback_t *)data;
   /* first delete user data */
   delete_pydata(cb);
@@ -134,6 +136,7 @@ py_wrap_fc_status_callback(vrna_fold_compound_t  *fc,
                            unsigned char status,
                            void          *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   PyObject *func, *arglist, *result, *err;
   pycallback_t *cb = (pycallback_t *)data;
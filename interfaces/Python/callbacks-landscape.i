@@ -58,6 +58,8 @@ python_wrap_move_update_cb(vrna_fold_compound_t *fc,
                            unsigned int         state,
                            void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject            *func, *arglist, *result, *err, *py_fc, *py_neighbor, *py_state;
   pycallback_simple_t *cb;
 
@@ -57,6 +57,8 @@ delete_py_log(pycallback_log_t *cb)
 static void
 delete_pycallback_log(void * data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   pycallback_log_t *cb = (pycallback_log_t *)data;
   /* first delete user data */
   delete_py_log(cb);
@@ -103,6 +105,7 @@ static void
 py_wrap_log_callback(vrna_log_event_t  *event,
                      void              *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   PyObject *func, *arglist, *result, *err;
   pycallback_log_t *cb = (pycallback_log_t *)data;
@@ -50,6 +50,8 @@ python_wrap_heat_capacity_cb(float temp,
                              float hc,
                              void  *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject                        *func, *arglist, *result, *err, *py_temp, *py_hc;
   python_heat_capacity_callback_t *cb;
 
@@ -38,6 +38,7 @@ static python_mfe_window_callback_t *
 bind_mfe_window_callback(PyObject *PyFunc,
                          PyObject *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   python_mfe_window_callback_t *cb = (python_mfe_window_callback_t *)vrna_alloc(sizeof(python_mfe_window_callback_t));
 
@@ -53,6 +54,8 @@ bind_mfe_window_callback(PyObject *PyFunc,
 static void
 release_mfe_window_callback(python_mfe_window_callback_t *cb)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   Py_DECREF(cb->cb);
   Py_DECREF(cb->data);
   free(cb); 
@@ -65,6 +68,8 @@ python_wrap_mfe_window_cb(unsigned int  start,
                           float         energy,
                           void          *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject *func, *arglist, *result, *err;
   python_mfe_window_callback_t *cb = (python_mfe_window_callback_t *)data;
 
@@ -118,6 +123,7 @@ python_wrap_mfe_window_zscore_cb(unsigned int start,
                                  float        zscore,
                                  void         *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   PyObject *func, *arglist, *result, *err;
   python_mfe_window_callback_t *cb = (python_mfe_window_callback_t *)data;
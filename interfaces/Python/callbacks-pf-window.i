@@ -31,6 +31,8 @@ static python_pf_window_callback_t *
 bind_pf_window_callback(PyObject *PyFunc,
                         PyObject *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   python_pf_window_callback_t *cb = (python_pf_window_callback_t *)vrna_alloc(sizeof(python_pf_window_callback_t));
 
   Py_INCREF(PyFunc);
@@ -46,6 +48,8 @@ bind_pf_window_callback(PyObject *PyFunc,
 static void
 release_pf_window_callback(python_pf_window_callback_t *cb)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   Py_DECREF(cb->cb);
   Py_DECREF(cb->data);
   free(cb); 
@@ -60,6 +64,8 @@ python_wrap_pf_window_cb(FLT_OR_DBL   *pr,
                          unsigned int type,
                          void *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject *func, *arglist, *result, *pr_list, *err;
   python_pf_window_callback_t *cb = (python_pf_window_callback_t *)data;
 
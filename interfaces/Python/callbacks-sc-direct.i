@@ -89,6 +89,8 @@
   static void
   delete_py_sc_direct_callback(void *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     py_sc_cb_direct_t *cb = (py_sc_cb_direct_t *)data;
 
     /* first delete user data */
@@ -176,6 +178,8 @@
                                int                  l,
                                void                 *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     int               ret;
     PyObject          *func, *arglist, *result, *err;
     py_sc_callback_t  *cb = (py_sc_callback_t *)data;
@@ -251,6 +255,8 @@
                                    int                  l,
                                    void                 *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     FLT_OR_DBL        ret;
     PyObject          *func, *arglist, *result, *err;
     py_sc_callback_t  *cb;
@@ -323,6 +329,8 @@
                                           unsigned int          event,
                                           void                  *event_data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     int               ret;
     PyObject          *func, *arglist, *result, *err;
     py_sc_cb_direct_t *cb = (py_sc_cb_direct_t *)data;
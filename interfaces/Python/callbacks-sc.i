@@ -90,6 +90,8 @@
   static void
   delete_py_sc_callback(void *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     py_sc_callback_t *cb = (py_sc_callback_t *)data;
 
     /* first delete user data */
@@ -594,6 +596,8 @@
                         unsigned char d,
                         void          *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     int               ret;
     PyObject          *func, *arglist, *result, *err;
     py_sc_callback_t  *cb = (py_sc_callback_t *)data;
@@ -666,6 +670,8 @@
                          unsigned char  d,
                          void           *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     int               c, len, num_pairs;
     PyObject          *func, *arglist, *result, *bp, *err;
     py_sc_callback_t  *cb;
@@ -785,6 +791,8 @@
                             unsigned char d,
                             void          *data)
   {
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
     FLT_OR_DBL        ret;
     PyObject          *func, *arglist, *result, *err;
     py_sc_callback_t  *cb;
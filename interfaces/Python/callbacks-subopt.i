@@ -25,6 +25,7 @@ static python_subopt_callback_t *
 bind_subopt_callback(PyObject *PyFunc,
                      PyObject *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
 
   python_subopt_callback_t *cb = (python_subopt_callback_t *)vrna_alloc(sizeof(python_subopt_callback_t));
 
@@ -39,6 +40,8 @@ bind_subopt_callback(PyObject *PyFunc,
 static void
 release_subopt_callback(python_subopt_callback_t *cb)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   Py_DECREF(cb->cb);
   Py_DECREF(cb->data);
   free(cb); 
@@ -50,6 +53,8 @@ python_wrap_subopt_cb(const char *structure,
                       float      energy,
                       void       *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject                  *func, *arglist, *result, *err, *py_structure, *py_energy;
   python_subopt_callback_t  *cb;
 
@@ -99,7 +104,11 @@ python_wrap_subopt_cb(const char *structure,
 %feature("autodoc") subopt_cb;
 %feature("kwargs") subopt_cb;
 
-  PyObject *
+  /*
+   *  runs without the GIL (see threads.i), so no Python object must be
+   *  touched here, the wrapper returns None for us
+   */
+  void
   subopt_cb(int      delta,
             PyObject *PyFunc,
             PyObject *data = Py_None)
@@ -108,7 +117,6 @@ python_wrap_subopt_cb(const char *structure,
     python_subopt_callback_t *cb = bind_subopt_callback(PyFunc, data);
     vrna_subopt_cb($self, delta, &python_wrap_subopt_cb, (void *)cb);
     release_subopt_callback(cb);
-    Py_RETURN_NONE;
   }
 
 }
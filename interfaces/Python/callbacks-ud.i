@@ -161,6 +161,8 @@ delete_py_ud_data(py_ud_callback_t *cb)
 static void
 delete_py_ud_callback(void * data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   py_ud_callback_t *cb = (py_ud_callback_t *)data;
   /* first delete user data */
   delete_py_ud_data(cb);
@@ -304,6 +306,8 @@ static void
 py_wrap_ud_prod_rule(vrna_fold_compound_t *vc,
                      void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject          *func, *arglist, *result, *err;
   py_ud_callback_t  *cb;
 
@@ -340,6 +344,8 @@ static void
 py_wrap_ud_exp_prod_rule(vrna_fold_compound_t *vc,
                          void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject          *func, *arglist, *result, *err;
   py_ud_callback_t  *cb;
 
@@ -379,6 +385,8 @@ py_wrap_ud_energy(vrna_fold_compound_t *vc,
                   unsigned int         looptype,
                   void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   int               ret;
   PyObject          *func, *arglist, *result, *err, *py_vc, *py_i, *py_j, *py_looptype;
   py_ud_callback_t  *cb;
@@ -439,6 +447,8 @@ py_wrap_ud_exp_energy(vrna_fold_compound_t *vc,
                       unsigned int         looptype,
                       void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   FLT_OR_DBL        ret;
   PyObject          *func, *arglist, *result, *err, *py_vc, *py_i, *py_j, *py_looptype;
   py_ud_callback_t  *cb;
@@ -500,6 +510,8 @@ py_wrap_ud_prob_add(vrna_fold_compound_t *vc,
                     FLT_OR_DBL           prob,
                     void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   PyObject          *func, *arglist, *result, *err, *py_vc, *py_i, *py_j, *py_looptype, *py_prob;
   py_ud_callback_t  *cb;
 
@@ -558,6 +570,8 @@ py_wrap_ud_prob_get(vrna_fold_compound_t *vc,
                     int                  motif,
                     void                 *data)
 {
+  SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+
   FLT_OR_DBL        ret;
   PyObject          *func, *arglist, *result, *err, *py_vc, *py_i, *py_j, *py_looptype, *py_motif;
   py_ud_callback_t  *cb;
@@ -0,0 +1,52 @@
+/*
+ *  Global interpreter lock (GIL) policy
+ *
+ *  By default, every wrapper keeps the GIL while the library is running.
+ *  The compute-heavy entry points below release it instead, such that
+ *  other Python threads may proceed, e.g. to fold different sequences
+ *  concurrently. Any Python callback invoked from within these functions
+ *  re-acquires the GIL first (see callbacks-*.i).
+ *
+ *  Note, that a single fold compound must never be used by two threads
+ *  at the same time!
+ */
+
+%nothread;
+
+/* MFE prediction */
+%thread vrna_fold_compound_t::mfe;
+%thread vrna_fold_compound_t::mfe_dimer;
+
+/* partition function and base pair probabilities */
+%thread vrna_fold_compound_t::pf;
+%thread vrna_fold_compound_t::pf_dimer;
+%thread vrna_fold_compound_t::pf_update;
+%thread vrna_fold_compound_t::bpp;
+
+/* suboptimal structures and stochastic backtracking */
+%thread vrna_fold_compound_t::subopt;
+%thread vrna_fold_compound_t::subopt_zuker;
+%thread vrna_fold_compound_t::subopt_cb;
+%thread vrna_fold_compound_t::pbacktrack;
+%thread vrna_fold_compound_t::pbacktrack5;
+%thread vrna_fold_compound_t::pbacktrack_sub;
+
+/* local (sliding window) predictions */
+%thread vrna_fold_compound_t::mfe_window;
+%thread vrna_fold_compound_t::mfe_window_zscore;
+%thread vrna_fold_compound_t::mfe_window_cb;
+%thread vrna_fold_compound_t::mfe_window_zscore_cb;
+%thread vrna_fold_compound_t::probs_window;
+%thread my_Lfold_cb;
+%thread my_Lfoldz_cb;
+%thread pfl_fold_cb;
+%thread pfl_fold_up_cb;
+
+/* energy evaluation */
+%thread vrna_fold_compound_t::eval_structure;
+%thread vrna_fold_compound_t::eval_structure_pt;
+
+/*
+ *  Batch functions, e.g. fold_many(), release the GIL themselves once
+ *  their arguments are converted and must therefore not be listed here
+ */
@@ -0,0 +1,8 @@
+/*
+ *  Global interpreter lock (GIL) policy
+ *
+ *  The Python 2 callbacks do not re-acquire the GIL, so all
+ *  wrappers keep it while the library is running.
+ */
+
+%nothread;
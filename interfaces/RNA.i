@@ -1,5 +1,6 @@
 #ifdef SWIGPYTHON
-%module(moduleimport="from . import _RNA") RNA
+%module(moduleimport="from . import _RNA", threads="1") RNA
+%include threads.i
 #else
 %module RNA
 #endif
@@ -15,6 +15,16 @@ typedef struct {
   var_array<unsigned int>   *const  up_hp;
   var_array<unsigned int>   *const  up_int;
   var_array<unsigned int>   *const  up_ml;
+
+#ifdef SWIGPYTHON
+%pythoncode %{
+mx      = _keep_owner(mx)
+up_ext  = _keep_owner(up_ext)
+up_hp   = _keep_owner(up_hp)
+up_int  = _keep_owner(up_int)
+up_ml   = _keep_owner(up_ml)
+%}
+#endif
 };
 
 %{
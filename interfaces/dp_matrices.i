@@ -30,6 +30,17 @@ typedef struct {
   const int             FcI;
   const int             FcM;
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+f5  = _keep_owner(f5)
+f3  = _keep_owner(f3)
+c   = _keep_owner(c)
+fML = _keep_owner(fML)
+fM1 = _keep_owner(fM1)
+fM2 = _keep_owner(fM2)
+%}
+#endif
+
   vrna_mx_mfe_t() { return NULL; }
   ~vrna_mx_mfe_t() {}
 };
@@ -141,6 +152,21 @@ typedef struct {
   const FLT_OR_DBL              qio;
   const FLT_OR_DBL              qmo;
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+scale     = _keep_owner(scale)
+expMLbase = _keep_owner(expMLbase)
+q         = _keep_owner(q)
+qb        = _keep_owner(qb)
+qm        = _keep_owner(qm)
+qm1       = _keep_owner(qm1)
+probs     = _keep_owner(probs)
+q1k       = _keep_owner(q1k)
+qln       = _keep_owner(qln)
+qm2       = _keep_owner(qm2)
+%}
+#endif
+
   vrna_mx_pf_t() { return NULL; }
   ~vrna_mx_pf_t() {}
 };
@@ -176,7 +202,7 @@ typedef struct {
   {
     return var_array_new(mx->length,
                          mx->q,
-                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED);
+                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED | VAR_ARRAY_IINDX);
   }
 
   var_array<FLT_OR_DBL> *
@@ -184,7 +210,7 @@ typedef struct {
   {
     return var_array_new(mx->length,
                          mx->qb,
-                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED);
+                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED | VAR_ARRAY_IINDX);
   }
 
   var_array<FLT_OR_DBL> *
@@ -192,7 +218,7 @@ typedef struct {
   {
     return var_array_new(mx->length,
                          mx->qm,
-                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED);
+                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED | VAR_ARRAY_IINDX);
   }
 
   var_array<FLT_OR_DBL> *
@@ -200,7 +226,7 @@ typedef struct {
   {
     return var_array_new(mx->length,
                          mx->probs,
-                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED);
+                         VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED | VAR_ARRAY_IINDX);
   }
 
   var_array<FLT_OR_DBL> *
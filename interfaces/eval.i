@@ -52,6 +52,19 @@
     return vrna_eval_structure_pt_verbose($self, pt.data, nullfile);
   }
   
+  /* compute free energies for a batch of structures given in dot-bracket notation */
+  std::vector<double>
+  eval_structures(std::vector<std::string> structures)
+  {
+    std::vector<const char*>  v;
+    std::vector<float>        energies(structures.size());
+    std::transform(structures.begin(), structures.end(), std::back_inserter(v), convert_vecstring2veccharcp);
+
+    vrna_eval_structures($self, (const char **)v.data(), v.size(), energies.data());
+
+    return std::vector<double>(energies.begin(), energies.end());
+  }
+
   /* compute covariance contributions for consensus structure given in dot-bracket notation */
   float
   eval_covar_structure(char *structure)
@@ -105,6 +118,45 @@
   }
 }
 
+%ignore vrna_eval_structures;
+%ignore vrna_eval_structures_pt;
+%ignore vrna_eval_batch;
+
+%rename (eval_batch) my_eval_batch;
+
+%{
+  std::vector<double>
+  my_eval_batch(std::vector<std::string> sequences,
+                std::vector<std::string> structures,
+                vrna_md_t                *md_p = NULL,
+                unsigned int             num_threads = 0)
+  {
+    std::vector<const char*>  seqs, ss;
+    std::vector<float>        energies;
+
+    if (sequences.size() == structures.size()) {
+      energies.resize(sequences.size());
+      std::transform(sequences.begin(), sequences.end(), std::back_inserter(seqs), convert_vecstring2veccharcp);
+      std::transform(structures.begin(), structures.end(), std::back_inserter(ss), convert_vecstring2veccharcp);
+
+      vrna_eval_batch((const char **)seqs.data(),
+                      (const char **)ss.data(),
+                      seqs.size(),
+                      md_p,
+                      energies.data(),
+                      num_threads);
+    }
+
+    return std::vector<double>(energies.begin(), energies.end());
+  }
+%}
+
+std::vector<double>
+my_eval_batch(std::vector<std::string> sequences,
+              std::vector<std::string> structures,
+              vrna_md_t                *md_p = NULL,
+              unsigned int             num_threads = 0);
+
 %ignore energy_of_struct_par;
 %ignore energy_of_circ_struct_par;
 %ignore energy_of_gquad_struct_par;
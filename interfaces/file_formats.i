@@ -227,6 +227,8 @@ my_file_connect_read_record(FILE         *fp,
 %constant unsigned int  INPUT_COMMENT             = VRNA_INPUT_COMMENT;
 %constant unsigned int  OPTION_MULTILINE          = VRNA_OPTION_MULTILINE;           
 
+%ignore vrna_file_reader_fasta_record;
+
 %include <ViennaRNA/io/file_formats.h>
 
 /**********************************************/
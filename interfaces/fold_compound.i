@@ -79,6 +79,22 @@ typedef struct {
   var_array<short>        *const sequence_encoding;
   var_array<short>        *const sequence_encoding2;
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+matrices            = _keep_owner(matrices)
+exp_matrices        = _keep_owner(exp_matrices)
+hc                  = _keep_owner(hc)
+strand_number       = _keep_owner(strand_number)
+strand_order        = _keep_owner(strand_order)
+strand_start        = _keep_owner(strand_start)
+strand_end          = _keep_owner(strand_end)
+iindx               = _keep_owner(iindx)
+jindx               = _keep_owner(jindx)
+sequence_encoding   = _keep_owner(sequence_encoding)
+sequence_encoding2  = _keep_owner(sequence_encoding2)
+%}
+#endif
+
   /* the default constructor, *md and option are optional, for single sequences*/
   vrna_fold_compound_t( const char    *sequence,
                         vrna_md_t     *md = NULL,
@@ -239,5 +255,7 @@ def __repr__(self):
 %constant unsigned int OPTION_HYBRID    = VRNA_OPTION_HYBRID;
 %constant unsigned int OPTION_EVAL_ONLY = VRNA_OPTION_EVAL_ONLY;
 %constant unsigned int OPTION_WINDOW    = VRNA_OPTION_WINDOW;
+%constant unsigned int OPTION_SPARSE    = VRNA_OPTION_SPARSE;
+%constant unsigned int OPTION_BEAM      = VRNA_OPTION_BEAM;
 
 %include <ViennaRNA/fold_compound.h>
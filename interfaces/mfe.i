@@ -391,6 +391,116 @@ char *my_circalifold(std::vector<std::string> alignment, char *constraints, floa
 }
 
 
+#ifdef SWIGPYTHON
+/*
+ *  Thread-parallel MFE prediction for a batch of sequences. The
+ *  predictions run natively, i.e. without holding the GIL, on a
+ *  pool of threads that share the model details md. Returns a tuple
+ *  (structures, energies) where energies is a read-only memoryview
+ *  of doubles. Sequences that could not be processed yield None and
+ *  NaN, respectively.
+ */
+%rename (fold_many) my_fold_many;
+
+%{
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+  PyObject *
+  my_fold_many(std::vector<std::string> sequences,
+               vrna_md_t                *md       = NULL,
+               int                      threads   = 0)
+  {
+    size_t                    i, n, num_threads;
+    char                      **structures;
+    double                    *energies;
+    vrna_md_t                 md_local;
+    std::atomic<size_t>       next(0);
+    std::vector<std::thread>  pool;
+    PyObject                  *py_structures, *py_energies;
+
+    n = sequences.size();
+
+    if (md)
+      md_local = *md;
+    else
+      vrna_md_set_default(&md_local);
+
+    structures  = (char **)vrna_alloc(sizeof(char *) * (n + 1));
+    energies    = (double *)vrna_alloc(sizeof(double) * (n + 1));
+    num_threads = (threads > 0) ? (size_t)threads : (size_t)std::thread::hardware_concurrency();
+    num_threads = MAX2(1, MIN2(num_threads, n));
+
+    auto worker = [&]() {
+      size_t                k;
+      vrna_fold_compound_t  *fc;
+
+      while ((k = next++) < n) {
+        fc = vrna_fold_compound(sequences[k].c_str(), &md_local, VRNA_OPTION_MFE);
+        if (fc) {
+          structures[k] = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
+          energies[k]   = (double)vrna_mfe(fc, structures[k]);
+          vrna_fold_compound_free(fc);
+        } else {
+          energies[k] = NAN;
+        }
+      }
+    };
+
+    {
+      SWIG_PYTHON_THREAD_BEGIN_ALLOW;
+
+      for (i = 1; i < num_threads; i++) {
+        try {
+          pool.emplace_back(worker);
+        } catch (const std::system_error &e) {
+          /* continue with the threads we already have */
+          break;
+        }
+      }
+
+      worker();
+
+      for (auto &t : pool)
+        t.join();
+    }
+
+    py_structures = PyList_New((Py_ssize_t)n);
+    for (i = 0; i < n; i++) {
+      if (structures[i]) {
+        PyList_SET_ITEM(py_structures, (Py_ssize_t)i, PyUnicode_FromString(structures[i]));
+        free(structures[i]);
+      } else {
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(py_structures, (Py_ssize_t)i, Py_None);
+      }
+    }
+
+    free(structures);
+
+    py_energies = var_array_buffer_new(NULL,
+                                       energies,
+                                       energies,
+                                       var_array_format<double>(),
+                                       sizeof(double),
+                                       1,
+                                       n,
+                                       1,
+                                       1);
+
+    return Py_BuildValue("(NN)", py_structures, py_energies);
+  }
+%}
+
+%feature("autodoc", "fold_many(sequences, md=None, threads=0) -> (structures, energies)") my_fold_many;
+%feature("kwargs") my_fold_many;
+
+PyObject *my_fold_many(std::vector<std::string> sequences, vrna_md_t *md = NULL, int threads = 0);
+
+#endif
+
+
 %clear  float *energy;
 
 %include  <ViennaRNA/mfe/global.h>
@@ -135,7 +135,7 @@ typedef struct {
 
   ~vrna_param_t()
   {
-    free($self);  
+    vrna_params_free($self);
   }
 
 #ifdef SWIGPYTHON
@@ -253,7 +253,7 @@ def __repr__(self):
 
   ~vrna_exp_param_t()
   {
-    free($self);  
+    vrna_exp_params_free($self);
   }
 
 #ifdef SWIGPYTHON
@@ -337,6 +337,14 @@ def __repr__(self):
 %ignore scale_pf_parameters;
 %ignore copy_pf_param;
 %ignore set_pf_param;
+%ignore vrna_params_free;
+%ignore vrna_exp_params_free;
+%ignore vrna_params_unshare;
+%ignore vrna_exp_params_unshare;
+
+%rename(params_snapshot_save) vrna_params_snapshot_save;
+%rename(params_snapshot_load) vrna_params_snapshot_load;
+%rename(params_cache_clear)   vrna_params_cache_clear;
 
 %include <ViennaRNA/params/basic.h>
 
@@ -114,6 +114,7 @@ double my_pf_add(double dG1, double dG2, double kT = 0);
 
 /* tell swig that these functions return objects that require memory management */
 %newobject vrna_fold_compound_t::pf;
+%newobject vrna_fold_compound_t::pf_update;
 
 %extend vrna_fold_compound_t{
 
@@ -125,6 +126,16 @@ double my_pf_add(double dG1, double dG2, double kT = 0);
     return structure;
   }
 
+  char *
+  pf_update(unsigned int  i,
+            unsigned int  j,
+            float         *OUTPUT)
+  {
+    char *structure = (char *)vrna_alloc(sizeof(char) * ($self->length + 1)); /*output is a structure pointer*/
+    *OUTPUT= vrna_pf_update($self, structure, i, j);
+    return structure;
+  }
+
   double
   mean_bp_distance()
   {
@@ -359,6 +370,30 @@ void my_get_concentrations(double FcAB, double FcAA, double FcBB, double FEA,dou
     return probabilities;
   }
 
+#ifdef SWIGPYTHON
+%pythoncode %{
+def bpp_view(self, dense=True):
+    """
+    Read-only view of the base pair probability matrix
+
+    In contrast to bpp(), the probabilities are not converted into Python
+    objects. The view is a (n + 1) x (n + 1) matrix with probabilities for
+    i < j (dense=True), or the raw linear array addressed by iindx[i] - j
+    (dense=False). The latter does not copy any data at all, but is only
+    valid until the DP matrices of the fold compound are re-allocated.
+
+    Returns
+    -------
+    memoryview
+        The base pair probabilities, e.g. for use with `numpy.asarray()`
+    """
+    mx = self.exp_matrices
+    if mx is None or mx.probs is None:
+        raise RuntimeError("base pair probabilities are not available, call pf() first")
+    return mx.probs.view(dense=dense, owner=self)
+%}
+#endif
+
   std::vector<vrna_ep_t>
   stack_prob(double cutoff = 1e-5)
   {
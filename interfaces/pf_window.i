@@ -79,10 +79,56 @@
 %}
 
 #ifdef SWIGPYTHON
+%{
+  /*
+   *  Same as pfl_fold_up() but returns the probabilities as read-only
+   *  (n + 1) x (ulength + 1) memoryview instead of nested lists
+   */
+  PyObject *
+  pfl_fold_up_array(std::string sequence,
+                    int         ulength,
+                    int         window_size,
+                    int         max_bp_span)
+  {
+    size_t  i, n, cols;
+    double  *mx, **up;
+
+    n     = sequence.length();
+    cols  = (size_t)ulength + 1;
+    up    = vrna_pfl_fold_up(sequence.c_str(), ulength, window_size, max_bp_span);
+    mx    = (double *)vrna_alloc(sizeof(double) * (n + 1) * cols);
+
+    free(up[0]);
+    for (i = 1; i <= n; i++) {
+      /* skip the 0th element, everything is 1-based */
+      memcpy(mx + i * cols + 1, up[i] + 1, sizeof(double) * ulength);
+      free(up[i]);
+    }
+    free(up);
+
+    return var_array_buffer_new(NULL,
+                                mx,
+                                mx,
+                                var_array_format<double>(),
+                                sizeof(double),
+                                2,
+                                n + 1,
+                                cols,
+                                cols);
+  }
+%}
+
 %feature("autodoc") my_pfl_fold;
 %feature("kwargs") my_pfl_fold;
 %feature("autodoc") pfl_fold_up;
 %feature("kwargs") pfl_fold_up;
+%feature("autodoc") pfl_fold_up_array;
+%feature("kwargs") pfl_fold_up_array;
+
+PyObject *pfl_fold_up_array(std::string sequence,
+                            int         ulength,
+                            int         window_size,
+                            int         max_bp_span);
 #endif
 
 std::vector<vrna_ep_t> my_pfl_fold(std::string sequence, int w, int L, double cutoff);
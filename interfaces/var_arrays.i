@@ -21,6 +21,7 @@
 #define VAR_ARRAY_SQR         4U
 #define VAR_ARRAY_ONE_BASED   8U
 #define VAR_ARRAY_OWNED       16U
+#define VAR_ARRAY_IINDX       32U
 
 template <typename T>
 struct var_array {
@@ -46,6 +47,9 @@ var_array_type_str(var_array<T> *a)
   if (a->type & VAR_ARRAY_ONE_BASED)
     out << " | RNA.VAR_ARRAY_ONE_BASED";
 
+  if (a->type & VAR_ARRAY_IINDX)
+    out << " | RNA.VAR_ARRAY_IINDX";
+
   return std::string(out.str());
 }
 
@@ -117,6 +121,242 @@ var_array_new(size_t        length,
 
 %}
 
+#ifdef SWIGPYTHON
+%{
+
+/*
+ *  A minimal object that exports (parts of) a var_array through the
+ *  Python buffer protocol, e.g. for memoryview() or numpy.asarray().
+ *  The exporter keeps a reference to the object that owns the memory
+ *  and optionally holds a dense copy of triangular matrices
+ */
+typedef struct {
+  PyObject_HEAD
+  PyObject    *owner;
+  void        *data;
+  void        *owned;
+  const char  *format;
+  Py_ssize_t  itemsize;
+  int         ndim;
+  Py_ssize_t  shape[2];
+  Py_ssize_t  strides[2];
+} var_array_buffer;
+
+
+static int
+var_array_buffer_get(PyObject   *obj,
+                     Py_buffer  *view,
+                     int        flags)
+{
+  var_array_buffer *b = (var_array_buffer *)obj;
+
+  if (flags & PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "var_array views are read-only");
+    view->obj = NULL;
+    return -1;
+  }
+
+  view->buf         = b->data;
+  view->obj         = obj;
+  view->len         = b->itemsize * b->shape[0] * ((b->ndim == 2) ? b->shape[1] : 1);
+  view->readonly    = 1;
+  view->itemsize    = b->itemsize;
+  view->format      = (flags & PyBUF_FORMAT) ? (char *)b->format : NULL;
+  view->ndim        = b->ndim;
+  view->shape       = (flags & PyBUF_ND) ? b->shape : NULL;
+  view->strides     = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? b->strides : NULL;
+  view->suboffsets  = NULL;
+  view->internal    = NULL;
+
+  /* overlapping rows of square matrices can not be represented without strides */
+  if ((view->strides == NULL) &&
+      (b->ndim == 2) &&
+      (b->strides[0] != b->shape[1] * b->itemsize)) {
+    PyErr_SetString(PyExc_BufferError, "var_array view requires strides");
+    view->obj = NULL;
+    return -1;
+  }
+
+  Py_INCREF(obj);
+
+  return 0;
+}
+
+
+static void
+var_array_buffer_dealloc(PyObject *obj)
+{
+  var_array_buffer *b = (var_array_buffer *)obj;
+
+  Py_XDECREF(b->owner);
+  free(b->owned);
+  Py_TYPE(obj)->tp_free(obj);
+}
+
+
+static PyBufferProcs  var_array_buffer_procs;
+static PyTypeObject   var_array_buffer_type = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+};
+
+
+static PyTypeObject *
+var_array_buffer_type_get(void)
+{
+  static int ready = 0;
+
+  if (!ready) {
+    var_array_buffer_procs.bf_getbuffer     = var_array_buffer_get;
+    var_array_buffer_procs.bf_releasebuffer = NULL;
+
+    var_array_buffer_type.tp_name       = "RNA.var_array_buffer";
+    var_array_buffer_type.tp_basicsize  = sizeof(var_array_buffer);
+    var_array_buffer_type.tp_dealloc    = var_array_buffer_dealloc;
+    var_array_buffer_type.tp_as_buffer  = &var_array_buffer_procs;
+    var_array_buffer_type.tp_flags      = Py_TPFLAGS_DEFAULT;
+    var_array_buffer_type.tp_doc        = "Read-only buffer of a ViennaRNA array";
+
+    if (PyType_Ready(&var_array_buffer_type) < 0)
+      return NULL;
+
+    ready = 1;
+  }
+
+  return &var_array_buffer_type;
+}
+
+
+/*
+ *  Create a read-only memoryview of ndim = 1 or 2 dimensions. If owned is
+ *  non-NULL, the exporter takes care of freeing it, otherwise the memory
+ *  is kept alive by keeping a reference to owner
+ */
+static PyObject *
+var_array_buffer_new(PyObject   *owner,
+                     void       *data,
+                     void       *owned,
+                     const char *format,
+                     size_t     itemsize,
+                     int        ndim,
+                     size_t     rows,
+                     size_t     cols,
+                     size_t     row_stride)
+{
+  PyTypeObject      *type;
+  PyObject          *view;
+  var_array_buffer  *b;
+
+  type = var_array_buffer_type_get();
+
+  if ((!type) ||
+      (!(b = PyObject_New(var_array_buffer, type)))) {
+    free(owned);
+    return NULL;
+  }
+
+  Py_XINCREF(owner);
+  b->owner      = owner;
+  b->data       = data;
+  b->owned      = owned;
+  b->format     = format;
+  b->itemsize   = (Py_ssize_t)itemsize;
+  b->ndim       = ndim;
+  b->shape[0]   = (Py_ssize_t)rows;
+  b->shape[1]   = (Py_ssize_t)cols;
+  b->strides[0] = (Py_ssize_t)(itemsize * ((ndim == 2) ? row_stride : 1));
+  b->strides[1] = (Py_ssize_t)itemsize;
+
+  view = PyMemoryView_FromObject((PyObject *)b);
+  Py_DECREF(b);
+
+  return view;
+}
+
+
+template <typename T> inline const char *var_array_format(void);
+template <> inline const char *var_array_format<unsigned char>(void) { return "B"; }
+template <> inline const char *var_array_format<char>(void) { return "b"; }
+template <> inline const char *var_array_format<short>(void) { return "h"; }
+template <> inline const char *var_array_format<unsigned int>(void) { return "I"; }
+template <> inline const char *var_array_format<int>(void) { return "i"; }
+template <> inline const char *var_array_format<float>(void) { return "f"; }
+template <> inline const char *var_array_format<double>(void) { return "d"; }
+
+
+/*
+ *  Export a var_array. Linear arrays and the raw memory of matrices are
+ *  exported without copying. Square matrices can be exported as 2D views
+ *  without copying, too. Triangular matrices, however, use the linear
+ *  iindx[i] - j (VAR_ARRAY_IINDX) or jindx[j] + i layout, so a dense 2D
+ *  view requires a copy into a (n + 1) x (n + 1) matrix
+ */
+template <typename T>
+PyObject *
+var_array_view(var_array<T> *a,
+               PyObject     *owner,
+               int          dense)
+{
+  size_t  i, j, n, rows;
+  T       *mx;
+
+  n = a->length;
+
+  if ((dense) &&
+      (a->type & (VAR_ARRAY_TRI | VAR_ARRAY_SQR))) {
+    rows = (a->type & VAR_ARRAY_ONE_BASED) ? n + 1 : n;
+
+    if (a->type & VAR_ARRAY_SQR)
+      return var_array_buffer_new(owner,
+                                  a->data,
+                                  NULL,
+                                  var_array_format<T>(),
+                                  sizeof(T),
+                                  2,
+                                  rows,
+                                  rows,
+                                  n);
+
+    mx = (T *)vrna_alloc(sizeof(T) * rows * rows);
+
+    for (i = 1; i <= n; i++)
+      for (j = i; j <= n; j++)
+        mx[rows * i + j] = (a->type & VAR_ARRAY_IINDX) ?
+                           a->data[((n + 1 - i) * (n - i)) / 2 + n + 1 - j] :
+                           a->data[(j * (j - 1)) / 2 + i];
+
+    return var_array_buffer_new(NULL,
+                                mx,
+                                mx,
+                                var_array_format<T>(),
+                                sizeof(T),
+                                2,
+                                rows,
+                                rows,
+                                rows);
+  }
+
+  n = (a->type & VAR_ARRAY_ONE_BASED) ? n + 1 : n;
+
+  if (a->type & VAR_ARRAY_TRI)
+    n = var_array_data_size_tri(n - 1);
+  else if (a->type & VAR_ARRAY_SQR)
+    n = var_array_data_size_sqr(n);
+
+  return var_array_buffer_new(owner,
+                              a->data,
+                              NULL,
+                              var_array_format<T>(),
+                              sizeof(T),
+                              1,
+                              n,
+                              1,
+                              1);
+}
+
+%}
+#endif
+
+
 %nodefaultctor var_array;
 %nodefaultdtor var_array;
 
@@ -173,6 +413,9 @@ struct var_array {};
     if ($self->type & VAR_ARRAY_ONE_BASED)
       out << " | RNA.VAR_ARRAY_ONE_BASED";
 
+    if ($self->type & VAR_ARRAY_IINDX)
+      out << " | RNA.VAR_ARRAY_IINDX";
+
     return std::string(out.str());
   }
 };
@@ -455,6 +698,60 @@ def __iter__(self):
 }
 %enddef
 
+/*
+ *  var_array objects do not own the memory of DP matrices, constraints, etc.
+ *  Attributes that return them (or the objects they are taken from) keep a
+ *  reference to their parent instead, such that views of the arrays keep the
+ *  fold compound alive
+ */
+%pythoncode %{
+def _keep_owner(prop):
+    def fget(self):
+        value = prop.fget(self)
+        if value is not None:
+            value._owner = self
+        return value
+
+    return property(fget, doc = prop.__doc__)
+%}
+
+%define varArrayExtend__view__(name, T)
+%extend name<T> {
+  PyObject *
+  _view(PyObject  *owner,
+        int       dense)
+  {
+    return var_array_view<T>($self, owner, dense);
+  }
+
+%pythoncode %{
+def view(self, dense=False, owner=None):
+    """
+    Read-only memoryview of the array data without copying
+
+    Parameters
+    ----------
+    dense: bool
+        Return triangular and square matrices as 2D (n + 1) x (n + 1) views. Triangular
+        matrices are copied into a dense matrix with zeros below the diagonal
+    owner: object
+        Object that owns the underlying memory and must be kept alive for as long as
+        the view exists (default: the array itself, which in turn keeps a reference to
+        the fold compound it was taken from)
+
+    Returns
+    -------
+    memoryview
+        A read-only view that can be passed to, e.g. `numpy.asarray()`
+    """
+    return self._view(self if owner is None else owner, 1 if dense else 0)
+
+def __buffer__(self, flags):
+    return self.view()
+%}
+}
+%enddef
+
 varArrayExtend__getitem__(var_array, unsigned char)
 varArrayExtend__getitem__(var_array, char)
 varArrayExtend__getitem__(var_array, short)
@@ -462,6 +759,13 @@ varArrayExtend__getitem__(var_array, unsigned int)
 varArrayExtend__getitem__(var_array, int)
 varArrayExtend__getitem__(var_array, FLT_OR_DBL)
 
+varArrayExtend__view__(var_array, unsigned char)
+varArrayExtend__view__(var_array, char)
+varArrayExtend__view__(var_array, short)
+varArrayExtend__view__(var_array, unsigned int)
+varArrayExtend__view__(var_array, int)
+varArrayExtend__view__(var_array, FLT_OR_DBL)
+
 %class_output_typemaps(var_array<vrna_move_t>)
 
 #endif
@@ -481,3 +785,4 @@ varArrayExtend__getitem__(var_array, FLT_OR_DBL)
 %constant unsigned int VAR_ARRAY_SQR        = VAR_ARRAY_SQR;
 %constant unsigned int VAR_ARRAY_ONE_BASED  = VAR_ARRAY_ONE_BASED;
 %constant unsigned int VAR_ARRAY_OWNED      = VAR_ARRAY_OWNED;
+%constant unsigned int VAR_ARRAY_IINDX      = VAR_ARRAY_IINDX;
@@ -58,6 +58,8 @@ RNA_ENABLE_STATIC_BIN
 RNA_ENABLE_SIMD
 RNA_ENABLE_VECTORIZE
 RNA_ENABLE_MPFR
+RNA_ENABLE_ZLIB
+RNA_ENABLE_ZSTD
 RNA_ENABLE_NAVIEW
 RNA_ENABLE_DEBUG_RNALIB
 
@@ -233,6 +235,8 @@ m4_map_args([ AC_RNA_COLOR_RESULT_PACKAGE],
 
 m4_map_args([ AC_RNA_COLOR_RESULT_FEATURE],
             [mpfr],
+            [zlib],
+            [zstd],
             [NRhash],
             [c11],
             [tty_colors],
@@ -299,6 +303,8 @@ Extra Libraries
   * Support Vector Machine    : ${result_svm}
   * GNU Scientific Library    : ${result_gsl}
   * GNU MPFR                  : ${result_mpfr}
+  * zlib (gzip input)         : ${result_zlib}
+  * Zstandard (zstd input)    : ${result_zstd}
 
 Features
 --------
@@ -196,6 +196,126 @@ You probably need to install the mpfr-devel package or similar
   AM_CONDITIONAL(VRNA_AM_SWITCH_MPFR, test "x$enable_mpfr" = "xyes")
 ])
 
+
+AC_DEFUN([RNA_ENABLE_ZLIB], [
+
+  RNA_ADD_FEATURE([zlib],
+                  [Use zlib to read gzip compressed input files],
+                  [yes])
+
+  RNA_FEATURE_IF_ENABLED([zlib],[
+    ## Check for zlib.h header first
+    AC_CHECK_HEADER([zlib.h], [
+      ## now, check if we can link a program
+      AC_MSG_CHECKING([whether we can compile programs with zlib support])
+      ac_save_LIBS="$LIBS"
+      LIBS="$ac_save_LIBS -lz"
+
+      AC_LANG_PUSH([C])
+
+      AC_LINK_IFELSE([
+        AC_LANG_PROGRAM(
+          [[#include <stdio.h>
+            #include <zlib.h>
+          ]],
+          [[  printf ("zlib library: %s\nzlib header:  %s\n", zlibVersion (), ZLIB_VERSION);
+              return 0;
+          ]])
+      ],[
+        ZLIB_LIBS="-lz"
+        SETUPCFG_SW_ZLIB="True"
+        SETUPCFG_ZLIB_MACRO="zlib_macro  = VRNA_WITH_ZLIB"
+        SETUPCFG_ZLIB_LIBS="zlib_libs   = z"
+        AC_DEFINE([VRNA_WITH_ZLIB], [1], [Read gzip compressed input files])
+      ],[
+        enable_zlib=no
+      ])
+      AC_LANG_POP([C])
+      LIBS="$ac_save_LIBS"
+      AC_MSG_RESULT([$enable_zlib])
+    ], [
+      AC_MSG_WARN([
+==========================
+Failed to find zlib.h!
+
+You probably need to install the zlib-devel package or similar
+==========================
+    ])
+    enable_zlib=no])
+  ])
+
+  RNA_FEATURE_IF_DISABLED([zlib],[
+    SETUPCFG_SW_ZLIB="False"
+  ])
+
+  AC_SUBST(ZLIB_LIBS)
+  AC_SUBST(SETUPCFG_SW_ZLIB)
+  AC_SUBST(SETUPCFG_ZLIB_MACRO)
+  AC_SUBST(SETUPCFG_ZLIB_LIBS)
+  AM_CONDITIONAL(VRNA_AM_SWITCH_ZLIB, test "x$enable_zlib" = "xyes")
+])
+
+
+AC_DEFUN([RNA_ENABLE_ZSTD], [
+
+  RNA_ADD_FEATURE([zstd],
+                  [Use libzstd to read Zstandard compressed input files],
+                  [no])
+
+  RNA_FEATURE_IF_ENABLED([zstd],[
+    ## Check for zstd.h header first
+    AC_CHECK_HEADER([zstd.h], [
+      ## now, check if we can link a program
+      AC_MSG_CHECKING([whether we can compile programs with zstd support])
+      ac_save_LIBS="$LIBS"
+      LIBS="$ac_save_LIBS -lzstd"
+
+      AC_LANG_PUSH([C])
+
+      AC_LINK_IFELSE([
+        AC_LANG_PROGRAM(
+          [[#include <stdio.h>
+            #include <zstd.h>
+          ]],
+          [[  ZSTD_DStream *ds = ZSTD_createDStream ();
+              printf ("zstd library: %s\n", ZSTD_versionString ());
+              ZSTD_freeDStream (ds);
+              return 0;
+          ]])
+      ],[
+        ZSTD_LIBS="-lzstd"
+        SETUPCFG_SW_ZSTD="True"
+        SETUPCFG_ZSTD_MACRO="zstd_macro  = VRNA_WITH_ZSTD"
+        SETUPCFG_ZSTD_LIBS="zstd_libs   = zstd"
+        AC_DEFINE([VRNA_WITH_ZSTD], [1], [Read Zstandard compressed input files])
+      ],[
+        enable_zstd=no
+      ])
+      AC_LANG_POP([C])
+      LIBS="$ac_save_LIBS"
+      AC_MSG_RESULT([$enable_zstd])
+    ], [
+      AC_MSG_WARN([
+==========================
+Failed to find zstd.h!
+
+You probably need to install the libzstd-devel package or similar
+==========================
+    ])
+    enable_zstd=no])
+  ])
+
+  RNA_FEATURE_IF_DISABLED([zstd],[
+    SETUPCFG_SW_ZSTD="False"
+  ])
+
+  AC_SUBST(ZSTD_LIBS)
+  AC_SUBST(SETUPCFG_SW_ZSTD)
+  AC_SUBST(SETUPCFG_ZSTD_MACRO)
+  AC_SUBST(SETUPCFG_ZSTD_LIBS)
+  AM_CONDITIONAL(VRNA_AM_SWITCH_ZSTD, test "x$enable_zstd" = "xyes")
+])
+
 #
 # OpenMP support
 #
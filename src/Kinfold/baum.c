@@ -28,6 +28,7 @@
 
 #include "nachbar.h"
 #include "globals.h"
+#include "simulation.h"
 
 #define MYTURN 1
 #define SAME_STRAND(I,J) (((I)>=cut_point)||((J)<cut_point))
@@ -46,50 +47,50 @@ typedef struct _baum {
 } baum;
 
 static char UNUSED rcsid[]="$Id: baum.c,v 1.9 2008/05/21 10:15:45 ivo Exp $";
-static short *pairList = NULL;
-static short *typeList = NULL;
-static short *aliasList = NULL;
-static baum *rl = NULL;         /* ringlist */
-static baum *wurzl = NULL;      /* virtualroot of ringlist-tree */
-static char **ptype = NULL;
 
 static int comp_struc(const void *A, const void *B);
 /* PUBLIC FUNCTIONES */
-void ini_or_reset_rl (void);
-void move_it (void);
-void update_tree (int i, int j);
-void clean_up_rl (void);
+void ini_shared_data (void);
+void ini_or_reset_rl (SimContext *ctx);
+void move_it (SimContext *ctx);
+int update_neighbors (SimContext *ctx);
+void update_tree (SimContext *ctx, int i, int j);
+void clean_up_rl (SimContext *ctx);
 
 /* PRIVATE FUNCTIONES */
-static void ini_ringlist(void);
-static void reset_ringlist(void);
-static void struc2tree (char *struc);
-static void close_bp_en (baum *i, baum *j);
-static void close_bp (baum *i, baum *j);
-static void open_bp (baum *i);
-static void open_bp_en (baum *i);
-static void inb (baum *root);
-static void inb_nolp (baum *root);
-static void dnb (baum *rli);
-static void dnb_nolp (baum *rli);
-static void fnb (baum *rli);
-static void make_ptypes(const short *S);
+static void ini_ringlist(SimContext *ctx);
+static void reset_ringlist(SimContext *ctx);
+static void struc2tree (SimContext *ctx, char *struc);
+static void close_bp_en (SimContext *ctx, baum *i, baum *j);
+static void close_bp (SimContext *ctx, baum *i, baum *j);
+static void open_bp (SimContext *ctx, baum *i);
+static void open_bp_en (SimContext *ctx, baum *i);
+static void inb (SimContext *ctx, baum *root);
+static void inb_nolp (SimContext *ctx, baum *root);
+static void dnb (SimContext *ctx, baum *rli);
+static void dnb_nolp (SimContext *ctx, baum *rli);
+static void fnb (SimContext *ctx, baum *rli);
+static void make_group (SimContext *ctx, baum *root);
+static baum *enclosing_loop (baum *x);
+static void touch_loop (SimContext *ctx, baum *root);
+static int eval_loop (SimContext *ctx, int i);
+static void make_ptypes(SimContext *ctx, const short *S);
 /* debugging tool(s) */
 #if 0
-static void rl_status(void);
+static void rl_status(SimContext *ctx);
 #endif
 
 /* convert structure in bracked-dot-notation to a ringlist-tree */
-static void struc2tree(char *struc) {
+static void struc2tree(SimContext *ctx, char *struc) {
   char* struc_copy;
   int ipos, jpos, balance = 0;
   baum *rli, *rlj;
 
-  struc_copy = (char *)calloc(GSV.len+1, sizeof(char));
+  struc_copy = (char *)calloc(ctx->len+1, sizeof(char));
   assert(struc_copy);
   strcpy(struc_copy,struc);
 
-  for (ipos = 0; ipos < GSV.len; ipos++) {
+  for (ipos = 0; ipos < ctx->len; ipos++) {
     if (struc_copy[ipos] == ')') {
       jpos = ipos;
       struc_copy[ipos] = '.';
@@ -97,40 +98,40 @@ static void struc2tree(char *struc) {
       while (struc_copy[--ipos] != '(');
       struc_copy[ipos] = '.';
       balance--;
-      rli = &rl[ipos];
-      rlj = &rl[jpos];
-      close_bp(rli, rlj);
+      rli = &ctx->rl[ipos];
+      rlj = &ctx->rl[jpos];
+      close_bp(ctx, rli, rlj);
     }
   }
 
   if (balance) {
     fprintf(stderr,
 	    "struc2tree(): start structure is not balanced !\n%s\n%s\n",
-	    GAV.farbe, struc);
+	    ctx->farbe, struc);
     exit(1);
   }
 
 #if HAVE_LIBRNA_API3
-  GSV.currE = GSV.startE = (float)vrna_eval_structure_pt(GAV.vc, pairList) / 100.0;
+  ctx->currE_int = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-  GSV.currE = GSV.startE =
-    (float )energy_of_struct_pt_par(GAV.farbe, pairList, typeList,
-				    aliasList, GAV.params, 0) / 100.0;
+  ctx->currE_int = energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList,
+                                           ctx->aliasList, GAV.params, 0);
 #endif
+  ctx->currE = ctx->startE = (float)ctx->currE_int / 100.0;
   {
     int i;
-    for(i = 0; i < GSV.len; i++) {
-      if (pairList[i+1]>i+1)
+    for(i = 0; i < ctx->len; i++) {
+      if (ctx->pairList[i+1]>i+1)
 #if HAVE_LIBRNA_API3
-        rl[i].loop_energy = vrna_eval_loop_pt(GAV.vc, i+1, pairList);
+        ctx->rl[i].loop_energy = vrna_eval_loop_pt(ctx->vc, i+1, ctx->pairList);
 #else
-	rl[i].loop_energy = loop_energy(pairList, typeList, aliasList,i+1);
+	ctx->rl[i].loop_energy = loop_energy(ctx->pairList, ctx->typeList, ctx->aliasList,i+1);
 #endif
     }
 #if HAVE_LIBRNA_API3
-    wurzl->loop_energy = vrna_eval_loop_pt(GAV.vc, 0, pairList);
+    ctx->wurzl->loop_energy = vrna_eval_loop_pt(ctx->vc, 0, ctx->pairList);
 #else
-    wurzl->loop_energy = loop_energy(pairList, typeList, aliasList,0);
+    ctx->wurzl->loop_energy = loop_energy(ctx->pairList, ctx->typeList, ctx->aliasList,0);
 #endif
   }
 
@@ -138,233 +139,240 @@ static void struc2tree(char *struc) {
 }
 
 /**/
-static void ini_ringlist(void) {
+static void ini_ringlist(SimContext *ctx) {
   int i;
 
   /* needed by function energy_of_struct_pt() from Vienna-RNA-1.4 */
-  pairList = (short *)calloc(GSV.len + 2, sizeof(short));
-  assert(pairList != NULL);
-  typeList = (short *)calloc(GSV.len + 2, sizeof(short));
-  assert(typeList != NULL);
-  aliasList = (short *)calloc(GSV.len + 2, sizeof(short));
-  assert(aliasList != NULL);
-  pairList[0] = typeList[0] = aliasList[0] = GSV.len;
-  ptype =  (char **)calloc(GSV.len + 2, sizeof(char *));
-  assert(ptype != NULL);
-  for (i=0; i<=GSV.len; i++) {
-    ptype[i] =   (char*)calloc(GSV.len + 2, sizeof(char));
-    assert(ptype[i] != NULL);
+  ctx->pairList = (short *)calloc(ctx->len + 2, sizeof(short));
+  assert(ctx->pairList != NULL);
+  ctx->typeList = (short *)calloc(ctx->len + 2, sizeof(short));
+  assert(ctx->typeList != NULL);
+  ctx->aliasList = (short *)calloc(ctx->len + 2, sizeof(short));
+  assert(ctx->aliasList != NULL);
+  ctx->pairList[0] = ctx->typeList[0] = ctx->aliasList[0] = ctx->len;
+  ctx->ptype =  (char **)calloc(ctx->len + 2, sizeof(char *));
+  assert(ctx->ptype != NULL);
+  for (i=0; i<=ctx->len; i++) {
+    ctx->ptype[i] =   (char*)calloc(ctx->len + 2, sizeof(char));
+    assert(ctx->ptype[i] != NULL);
   }
 
   /* allocate virtual root */
-  wurzl = (baum *)calloc(1, sizeof(baum));
-  assert(wurzl != NULL);
+  ctx->wurzl = (baum *)calloc(1, sizeof(baum));
+  assert(ctx->wurzl != NULL);
   /* allocate ringList */
-  rl = (baum *)calloc(GSV.len+1, sizeof(baum));
-  assert(rl != NULL);
+  ctx->rl = (baum *)calloc(ctx->len+1, sizeof(baum));
+  assert(ctx->rl != NULL);
   /* allocate PostOrderList */
 
   /* initialize virtualroot */
-  wurzl->typ = 'r';
-  wurzl->nummer = -1;
+  ctx->wurzl->typ = 'r';
+  ctx->wurzl->nummer = -1;
   /* connect virtualroot to ringlist-tree in down direction */
-  wurzl->down = &rl[GSV.len];
+  ctx->wurzl->down = &ctx->rl[ctx->len];
   /* initialize post-order list */
 
+  /* pair matrices are thread-private, so every simulation sets up its own */
   make_pair_matrix();
 
   /* initialize rest of ringlist-tree */
-  for(i = 0; i < GSV.len; i++) {
+  for(i = 0; i < ctx->len; i++) {
     int c;
-    GAV.currform[i] = '.';
-    GAV.prevform[i] = 'x';
-    pairList[i+1] = 0;
-    rl[i].typ = 'u';
+    ctx->currform[i] = '.';
+    ctx->prevform[i] = 'x';
+    ctx->pairList[i+1] = 0;
+    ctx->rl[i].typ = 'u';
     /* decode base to numeric value */
-    c = encode_char(GAV.farbe[i]);
-    rl[i].base = typeList[i+1] = c;
-    aliasList[i+1] = alias[typeList[i+1]];
+    c = encode_char(ctx->farbe[i]);
+    ctx->rl[i].base = ctx->typeList[i+1] = c;
+    ctx->aliasList[i+1] = alias[ctx->typeList[i+1]];
     /* astablish links for node of the ringlist-tree */
-    rl[i].nummer = i;
-    rl[i].next = &rl[i+1];
-    rl[i].prev = ((i == 0) ? &rl[GSV.len] : &rl[i-1]);
-    rl[i].up = rl[i].down = NULL;
+    ctx->rl[i].nummer = i;
+    ctx->rl[i].next = &ctx->rl[i+1];
+    ctx->rl[i].prev = ((i == 0) ? &ctx->rl[ctx->len] : &ctx->rl[i-1]);
+    ctx->rl[i].up = ctx->rl[i].down = NULL;
   }
-  GAV.currform[GSV.len] =   GAV.prevform[GSV.len] = '\0';
-  make_ptypes(aliasList);
+  ctx->currform[ctx->len] =   ctx->prevform[ctx->len] = '\0';
+  make_ptypes(ctx, ctx->aliasList);
 
-  rl[i].nummer = i;
-  rl[i].base = 0;
+  ctx->rl[i].nummer = i;
+  ctx->rl[i].base = 0;
   /* make ringlist circular in next, prev direction */
-  rl[i].next = &rl[0];
-  rl[i].prev = &rl[i-1];
+  ctx->rl[i].next = &ctx->rl[0];
+  ctx->rl[i].prev = &ctx->rl[i-1];
   /* make virtual basepair for virtualroot */
-  rl[i].up = wurzl;
-  rl[i].typ = 'x';
+  ctx->rl[i].up = ctx->wurzl;
+  ctx->rl[i].typ = 'x';
 
 }
 
-/**/
-void ini_or_reset_rl(void) {
-
-  /* if there is no ringList-tree make a new one */
-  if (wurzl == NULL) {
-    ini_ringlist();
+/* one-time initialization of data shared by all simulations */
+void ini_shared_data(void) {
 
-    /* start structure */
-    struc2tree(GAV.startform);
+  /* start structure */
 #if HAVE_LIBRNA_API3
-    GSV.currE = GSV.startE = vrna_eval_structure(GAV.vc, GAV.startform);
+  GSV.startE = vrna_eval_structure(GAV.vc, GAV.startform);
 #else
-    GSV.currE = GSV.startE = energy_of_structure(GAV.farbe, GAV.startform, 0);
+  GSV.startE = energy_of_structure(GAV.farbe_full, GAV.startform, 0);
 #endif
 
-    /* stop structure(s) */
-    if ( GTV.stop )  {
-      int i;
+  /* stop structure(s) */
+  if ( GTV.stop )  {
+    int i;
 
-      qsort(GAV.stopform, GSV.maxS, sizeof(char *), comp_struc);
+    qsort(GAV.stopform, GSV.maxS, sizeof(char *), comp_struc);
+    for (i = 0; i< GSV.maxS; i++)
 #if HAVE_LIBRNA_API3
-      /*
-        note that we need to hack the full length into GAV.vc again,
-        in case it was shortened due to chain growth simulation
-      */
-      unsigned int n, tmp_n;
-      n     = strlen(GAV.farbe_full);
-      tmp_n = GAV.vc->length;
-      GAV.vc->length = n;
-      for (i = 0; i< GSV.maxS; i++)
-        GAV.sE[i] = vrna_eval_structure(GAV.vc, GAV.stopform[i]);
-      GAV.vc->length = tmp_n;
+      GAV.sE[i] = vrna_eval_structure(GAV.vc, GAV.stopform[i]);
 #else
-      for (i = 0; i< GSV.maxS; i++)
-	GAV.sE[i] = energy_of_structure(GAV.farbe_full, GAV.stopform[i], 0);
+      GAV.sE[i] = energy_of_structure(GAV.farbe_full, GAV.stopform[i], 0);
 #endif
-    }
-    else {
+  }
+  else {
 #if HAVE_LIBRNA_API3
-      /* fold sequence to get Minimum free energy structure (Mfe) */
-      /*
-        note that we need to hack the full length into GAV.vc again,
-        in case it was shortened due to chain growth simulation
-      */
-      unsigned int n, tmp_n;
-      n     = strlen(GAV.farbe_full);
-      tmp_n = GAV.vc->length;
-      GAV.vc->length = n;
-      GAV.sE[0] = vrna_mfe_dimer(GAV.vc, GAV.stopform[0]);
-      vrna_mx_mfe_free(GAV.vc);
-      /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
-      GAV.sE[0] = vrna_eval_structure(GAV.vc, GAV.stopform[0]);
-      GAV.vc->length = tmp_n;
+    /* fold sequence to get Minimum free energy structure (Mfe) */
+    GAV.sE[0] = vrna_mfe_dimer(GAV.vc, GAV.stopform[0]);
+    vrna_mx_mfe_free(GAV.vc);
+    /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
+    GAV.sE[0] = vrna_eval_structure(GAV.vc, GAV.stopform[0]);
 #else
-      if(GTV.noLP)
-	noLonelyPairs=1;
-      initialize_cofold(GSV.len);
-      /* fold sequence to get Minimum free energy structure (Mfe) */
-      GAV.sE[0] = cofold(GAV.farbe_full, GAV.stopform[0]);
-      free_arrays();
-      /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
-      GAV.sE[0] = energy_of_structure(GAV.farbe_full, GAV.stopform[0], 0);
+    if(GTV.noLP)
+      noLonelyPairs=1;
+    initialize_cofold(strlen(GAV.farbe_full));
+    /* fold sequence to get Minimum free energy structure (Mfe) */
+    GAV.sE[0] = cofold(GAV.farbe_full, GAV.stopform[0]);
+    free_arrays();
+    /* revaluate energy of Mfe (maye differ if --logML=logarthmic */
+    GAV.sE[0] = energy_of_structure(GAV.farbe_full, GAV.stopform[0], 0);
 #endif
-    }
-    GSV.stopE = GAV.sE[0];
-    ini_nbList(strlen(GAV.farbe_full)*strlen(GAV.farbe_full));
+  }
+  GSV.stopE = GAV.sE[0];
+}
+
+/**/
+void ini_or_reset_rl(SimContext *ctx) {
+
+  /* if there is no ringList-tree make a new one */
+  if (ctx->wurzl == NULL) {
+    ini_ringlist(ctx);
+
+    /* start structure */
+    struc2tree(ctx, ctx->startform);
+#if HAVE_LIBRNA_API3
+    ctx->currE = ctx->startE = vrna_eval_structure(ctx->vc, ctx->startform);
+#else
+    ctx->currE = ctx->startE = energy_of_structure(ctx->farbe, ctx->startform, 0);
+#endif
+
+    ini_nbList(ctx);
   }
   else {
     /* reset ringlist-tree to start conditions */
-    reset_ringlist();
-    if(GTV.start) struc2tree(GAV.startform);
-    else {
-      GSV.currE = GSV.startE;
-    }
+    reset_ringlist(ctx);
+    /* also re-evaluates the loop energies of the open chain */
+    struc2tree(ctx, ctx->startform);
   }
+
+  /* neighbours of the start structure must be generated from scratch */
+  ctx->nb_valid = 0;
 }
 
 /**/
-static void reset_ringlist(void) {
+static void reset_ringlist(SimContext *ctx) {
   int i;
 
-  for(i = 0; i < GSV.len; i++) {
-    GAV.currform[i] = '.';
-    GAV.prevform[i] = 'x';
-    pairList[i+1] = 0;
-    rl[i].typ = 'u';
-    rl[i].next = &rl[i + 1];
-    rl[i].prev = ((i == 0) ? &rl[GSV.len] : &rl[i - 1]);
-    rl[i].up = rl[i].down = NULL;
+  for(i = 0; i < ctx->len; i++) {
+    ctx->currform[i] = '.';
+    ctx->prevform[i] = 'x';
+    ctx->pairList[i+1] = 0;
+    ctx->rl[i].typ = 'u';
+    ctx->rl[i].next = &ctx->rl[i + 1];
+    ctx->rl[i].prev = ((i == 0) ? &ctx->rl[ctx->len] : &ctx->rl[i - 1]);
+    ctx->rl[i].up = ctx->rl[i].down = NULL;
   }
-  rl[i].next = &rl[0];
-  rl[i].prev = &rl[i-1];
-  rl[i].up = wurzl;
+  ctx->rl[i].next = &ctx->rl[0];
+  ctx->rl[i].prev = &ctx->rl[i-1];
+  ctx->rl[i].up = ctx->wurzl;
 }
 
 /* update ringlist-tree */
-void update_tree(int i, int j) {
+void update_tree(SimContext *ctx, int i, int j) {
 
   baum *rli, *rlj, *tempb;
 
-  if ( abs(i) < GSV.len) { /* >> single basepair move */
+  if ( abs(i) < ctx->len) { /* >> single basepair move */
     if ((i > 0) && (j > 0)) { /* insert */
-      rli = &rl[i-1];
-      rlj = &rl[j-1];
-      close_bp_en(rli, rlj);
+      rli = &ctx->rl[i-1];
+      rlj = &ctx->rl[j-1];
+      close_bp_en(ctx, rli, rlj);
+      touch_loop(ctx, rli);
+      touch_loop(ctx, enclosing_loop(rli));
     }
     else if ((i < 0)&&(j < 0)) { /* delete */
       i = -i;
-      rli = &rl[i-1];
-      open_bp_en(rli);
+      rli = &ctx->rl[i-1];
+      open_bp_en(ctx, rli);
+      mark_nbGroup(ctx, i-1);
+      touch_loop(ctx, enclosing_loop(rli));
     }
     else { /* shift */
       if (i > 0) { /* i remains the same, j shifts */
 	j=-j;
-	rli=&rl[i-1];
-	rlj=&rl[j-1];
-	open_bp_en(rli);
+	rli=&ctx->rl[i-1];
+	rlj=&ctx->rl[j-1];
+	open_bp_en(ctx, rli);
+	mark_nbGroup(ctx, i-1);
 	ORDER(rli, rlj);
-	close_bp_en(rli, rlj);
+	close_bp_en(ctx, rli, rlj);
+	touch_loop(ctx, rli);
+	touch_loop(ctx, enclosing_loop(rli));
       }
       else { /* j remains the same, i shifts */
 	baum *old_rli;
 	i = -i;
-	rli = &rl[i-1];
-	rlj = &rl[j-1];
+	rli = &ctx->rl[i-1];
+	rlj = &ctx->rl[j-1];
 	old_rli = rlj->up;
-	open_bp_en(old_rli);
+	open_bp_en(ctx, old_rli);
+	mark_nbGroup(ctx, old_rli->nummer);
 	ORDER(rli, rlj);
-	close_bp_en(rli, rlj);
+	close_bp_en(ctx, rli, rlj);
+	touch_loop(ctx, rli);
+	touch_loop(ctx, enclosing_loop(rli));
       }
     }
   } /* << single basepair move */
   else { /* >> double basepair move */
     if ((i > 0) && (j > 0)) { /* insert */
-      rli = &rl[i-GSV.len-2];
-      rlj = &rl[j-GSV.len-2];
-      close_bp_en(rli->next, rlj->prev);
-      close_bp_en(rli, rlj);
+      rli = &ctx->rl[i-ctx->len-2];
+      rlj = &ctx->rl[j-ctx->len-2];
+      close_bp_en(ctx, rli->next, rlj->prev);
+      close_bp_en(ctx, rli, rlj);
     }
     else if ((i < 0)&&(j < 0)) { /* delete */
       i = -i;
-      rli = &rl[i-GSV.len-2];
-      open_bp_en(rli);
-      open_bp_en(rli->next);
+      rli = &ctx->rl[i-ctx->len-2];
+      open_bp_en(ctx, rli);
+      open_bp_en(ctx, rli->next);
     }
+    /* canonical neighbours are always generated from scratch */
+    ctx->nb_valid = 0;
   } /* << double basepair move */
 
 }
 
 /* open a particular base pair */
-void open_bp(baum *i) {
+static void open_bp(SimContext *ctx, baum *i) {
 
   baum *in; /* points to i->next */
 
   /* change string representation */
-  GAV.currform[i->nummer] = '.';
-  GAV.currform[i->down->nummer] = '.';
+  ctx->currform[i->nummer] = '.';
+  ctx->currform[i->down->nummer] = '.';
 
   /* change pairtable representation */
-  pairList[1 + i->nummer] = 0;
-  pairList[1 + i->down->nummer] = 0;
+  ctx->pairList[1 + i->nummer] = 0;
+  ctx->pairList[1 + i->down->nummer] = 0;
 
   /* change tree representation */
   in = i->next;
@@ -378,17 +386,17 @@ void open_bp(baum *i) {
 }
 
 /* close a particular base pair */
-void close_bp (baum *i, baum *j) {
+static void close_bp (SimContext *ctx, baum *i, baum *j) {
 
   baum *jn; /* points to j->next */
 
   /* change string representation */
-  GAV.currform[i->nummer] = '(';
-  GAV.currform[j->nummer] = ')';
+  ctx->currform[i->nummer] = '(';
+  ctx->currform[j->nummer] = ')';
 
   /* change pairtable representation */
-  pairList[1 + i->nummer] = 1+ j->nummer;
-  pairList[1 + j->nummer] = 1 + i->nummer;
+  ctx->pairList[1 + i->nummer] = 1+ j->nummer;
+  ctx->pairList[1 + j->nummer] = 1 + i->nummer;
 
   /* change tree representation */
   jn = j->next;
@@ -404,11 +412,11 @@ void close_bp (baum *i, baum *j) {
 
 # if 0
 /* for a given tree, generate postorder-list */
-static void make_poList (baum *root) {
+static void make_poList (SimContext *ctx, baum *root) {
 
   baum *stop, *rli;
 
-  if (!root) root = wurzl;
+  if (!root) root = ctx->wurzl;
   stop = root->down;
 
   /* foreach base in ringlist ... */
@@ -417,11 +425,11 @@ static void make_poList (baum *root) {
     if (rli->typ == 'p') {
       /*  fprintf(stderr, "%d >%d<\n", poListop, rli->nummer); */
       poList[poListop++] = rli;
-      if ( poListop > GSV.len+1 ) {
+      if ( poListop > ctx->len+1 ) {
 	fprintf(stderr, "Something went wrong in make_poList()\n");
 	exit(1);
       }
-      make_poList(rli);
+      make_poList(ctx, rli);
     }
   }
   return;
@@ -430,7 +438,7 @@ static void make_poList (baum *root) {
 
 /* for a given ringlist, generate all structures
    with one additional basepair */
-static void inb(baum *root) {
+static void inb(SimContext *ctx, baum *root) {
 
   int EoT;
   int E_old, E_new_in, E_new_out;
@@ -449,24 +457,24 @@ static void inb(baum *root) {
       /* potential j-position is already paired */
       if(rlj->typ=='p') continue;
       /* if i-j can form a base pair ... */
-      if(ptype[rli->nummer][rlj->nummer]){
+      if(ctx->ptype[rli->nummer][rlj->nummer]){
 	/* close the base bair and ... */
-	close_bp(rli,rlj);
+	close_bp(ctx, rli,rlj);
 #if HAVE_LIBRNA_API3
-        E_new_in  = vrna_eval_loop_pt(GAV.vc, rli->nummer+1, pairList);
-        E_new_out = vrna_eval_loop_pt(GAV.vc, root->nummer+1, pairList);
+        E_new_in  = vrna_eval_loop_pt(ctx->vc, rli->nummer+1, ctx->pairList);
+        E_new_out = vrna_eval_loop_pt(ctx->vc, root->nummer+1, ctx->pairList);
 #else
-	E_new_in  = loop_energy(pairList, typeList, aliasList,rli->nummer+1);
-	E_new_out = loop_energy(pairList, typeList, aliasList,root->nummer+1);
+	E_new_in  = loop_energy(ctx->pairList, ctx->typeList, ctx->aliasList,rli->nummer+1);
+	E_new_out = loop_energy(ctx->pairList, ctx->typeList, ctx->aliasList,root->nummer+1);
 #endif
 	/* ... evaluate energy of the structure */
-	EoT = (int) (GSV.currE*100 + ((GSV.currE<0)?-0.4:0.4)) +  E_new_in + E_new_out - E_old ;
-	/* assert(EoT ==  energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params)); */
+	EoT = ctx->currE_int + E_new_in + E_new_out - E_old ;
+	/* assert(EoT ==  energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params)); */
 	/* open the base pair again... */
-	open_bp(rli);
+	open_bp(ctx, rli);
 	/* ... and put the move and the enegy
 	   of the structure into the neighbour list */
-	update_nbList(1 + rli->nummer, 1 + rlj->nummer, EoT);
+	update_nbList(ctx, 1 + rli->nummer, 1 + rlj->nummer, EoT);
       }
     }
   }
@@ -474,7 +482,7 @@ static void inb(baum *root) {
 
 /* for a given ringlist, generate all structures (canonical)
    with one additional base pair (BUT WITHOUT ISOLATED BASE PAIRS) */
-static void inb_nolp(baum *root) {
+static void inb_nolp(SimContext *ctx, baum *root) {
 
   int EoT = 0;
   baum *stop, *rli, *rlj;
@@ -491,44 +499,44 @@ static void inb_nolp(baum *root) {
       /* potential j-position is already paired */
       if (rlj->typ=='p') continue;
       /* if i-j can form a base pair ... */
-      if (ptype[rli->nummer][rlj->nummer]) {
+      if (ctx->ptype[rli->nummer][rlj->nummer]) {
 	/* ... and extends a helix ... */
 	if (((rli->prev==stop && rlj->next==stop) && stop->typ != 'x') ||
 	    (rli->next == rlj->prev)) {
 	  /* ... close the base bair and ... */
-	  close_bp(rli,rlj);
+	  close_bp(ctx, rli,rlj);
 	  /* ... evaluate energy of the structure */
 #if HAVE_LIBRNA_API3
-	  EoT = vrna_eval_structure_pt(GAV.vc, pairList);
+	  EoT = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-	  EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
+	  EoT = energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params, 0);
 #endif
 	  /* open the base pair again... */
-	  open_bp(rli);
+	  open_bp(ctx, rli);
 	  /* ... and put the move and the enegy
 	     of the structure into the neighbour list */
-	  update_nbList(1 + rli->nummer, 1 + rlj->nummer, EoT);
+	  update_nbList(ctx, 1 + rli->nummer, 1 + rlj->nummer, EoT);
 	}
 	/* if double insertion is possible ... */
 	else if ((rlj->nummer - rli->nummer >= MYTURN+2)&&
 		 (rli->next->typ != 'p' && rlj->prev->typ != 'p') &&
 		 (rli->next->next != rlj->prev->prev) &&
-		 (ptype[rli->next->nummer][rlj->prev->nummer])) {
+		 (ctx->ptype[rli->next->nummer][rlj->prev->nummer])) {
 	  /* close the two base bair and ... */
-	  close_bp(rli->next, rlj->prev);
-	  close_bp(rli, rlj);
+	  close_bp(ctx, rli->next, rlj->prev);
+	  close_bp(ctx, rli, rlj);
 	  /* ... evaluate energy of the structure */
 #if HAVE_LIBRNA_API3
-	  EoT = vrna_eval_structure_pt(GAV.vc, pairList);
+	  EoT = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-	  EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
+	  EoT = energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params, 0);
 #endif
 	  /* open the two base pair again ... */
-	  open_bp(rli);
-	  open_bp(rli->next);
+	  open_bp(ctx, rli);
+	  open_bp(ctx, rli->next);
 	  /* ... and put the move and the enegy
 	     of the structure into the neighbour list */
-	  update_nbList(1+rli->nummer+GSV.len+1, 1+rlj->nummer+GSV.len+1, EoT);
+	  update_nbList(ctx, 1+rli->nummer+ctx->len+1, 1+rlj->nummer+ctx->len+1, EoT);
 	}
       }
     }
@@ -537,35 +545,34 @@ static void inb_nolp(baum *root) {
 
 /* for a given ringlist, generate all structures
  with one less base pair */
-static void dnb(baum *rli){
+static void dnb(SimContext *ctx, baum *rli){
 
   int EoT, E_old_in, E_old_out, E_new;
 
   baum *rlj, *r;
 
   rlj=rli->down;
-  open_bp(rli);
+  open_bp(ctx, rli);
   /* ... evaluate energy of the structure */
 
   for (r=rli->next; r->up==NULL; r=r->next);
   E_old_in = rli->loop_energy;
   E_old_out = r->up->loop_energy;
 #if HAVE_LIBRNA_API3
-  E_new = vrna_eval_loop_pt(GAV.vc, r->up->nummer+1, pairList);
+  E_new = vrna_eval_loop_pt(ctx->vc, r->up->nummer+1, ctx->pairList);
 #else
-  E_new = loop_energy(pairList,typeList,aliasList,r->up->nummer+1);
+  E_new = loop_energy(ctx->pairList,ctx->typeList,ctx->aliasList,r->up->nummer+1);
 #endif
-  EoT = (int) (GSV.currE*100 + ((GSV.currE<0)?-0.4:0.4)) -
-    E_old_in - E_old_out + E_new;
+  EoT = ctx->currE_int - E_old_in - E_old_out + E_new;
 
-  /* assert(EoT== energy_of_struct_pt(GAV.farbe, pairList, typeList, aliasList));*/
-  close_bp(rli,rlj);
-  update_nbList(-(1 + rli->nummer), -(1 + rlj->nummer), EoT);
+  /* assert(EoT== energy_of_struct_pt(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList));*/
+  close_bp(ctx, rli,rlj);
+  update_nbList(ctx, -(1 + rli->nummer), -(1 + rlj->nummer), EoT);
 }
 
 /* for a given ringlist, generate all structures (canonical)
  with one less base pair (BUT WITHOUT ISOLATED BASE PAIRS) */
-static void dnb_nolp(baum *rli) {
+static void dnb_nolp(SimContext *ctx, baum *rli) {
 
   int EoT = 0;
   baum *rlj;
@@ -591,50 +598,58 @@ static void dnb_nolp(baum *rli) {
   /* double delete ? */
   if (rlip==NULL && rlin && rljn->next != rljn->prev ) {
     /* open the two base pairs ... */
-    open_bp(rli);
-    open_bp(rlin);
+    open_bp(ctx, rli);
+    open_bp(ctx, rlin);
     /* ... evaluate energy of the structure ... */
 #if HAVE_LIBRNA_API3
-    EoT = vrna_eval_structure_pt(GAV.vc, pairList);
+    EoT = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-    EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
+    EoT = energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params, 0);
 #endif
     /* ... and put the move and the enegy
        of the structure into the neighbour list ... */
-    update_nbList(-(1+rli->nummer+GSV.len+1),-(1+rlj->nummer+GSV.len+1), EoT);
+    update_nbList(ctx, -(1+rli->nummer+ctx->len+1),-(1+rlj->nummer+ctx->len+1), EoT);
     /* ... and close the two base pairs again */
-    close_bp(rlin, rljn);
-    close_bp(rli, rlj);
+    close_bp(ctx, rlin, rljn);
+    close_bp(ctx, rli, rlj);
   } else { /* single delete */
     /* the following will work only if boolean expr are shortcicuited */
     if (rlip==NULL || (rlip->prev == rlip->next && rlip->prev->typ != 'x'))
       if (rlin ==NULL || (rljn->next == rljn->prev)) {
 	/* open the base pair ... */
-	open_bp(rli);
+	open_bp(ctx, rli);
 	/* ... evaluate energy of the structure ... */
 #if HAVE_LIBRNA_API3
-	EoT = vrna_eval_structure_pt(GAV.vc, pairList);
+	EoT = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-	EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
+	EoT = energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params, 0);
 #endif
 	/* ... and put the move and the enegy
 	   of the structure into the neighbour list ... */
-	update_nbList(-(1 + rli->nummer),-(1 + rlj->nummer), EoT);
+	update_nbList(ctx, -(1 + rli->nummer),-(1 + rlj->nummer), EoT);
 	/* and close the base pair again */
-	close_bp(rli, rlj);
+	close_bp(ctx, rli, rlj);
       }
   }
 }
 
 /* for a given ringlist, generate all structures
  with one shifted base pair */
-static void fnb(baum *rli) {
+static void fnb(SimContext *ctx, baum *rli) {
 
-  int EoT = 0, x;
-  baum *rlj, *stop, *help_rli, *help_rlj;
+  int EoT = 0, E_old, x;
+  baum *rlj, *stop, *help_rli, *help_rlj, *par;
 
   stop = rli->down;
 
+  /*
+    a shift only changes the loop closed by the pair and the loop
+    enclosing it, the latter is closed by the same pair par before
+    and after the move
+  */
+  par = enclosing_loop(rli);
+  E_old = ctx->currE_int - rli->loop_energy - par->loop_energy;
+
   /* examin interior loop of bp(ij); (.......)
      i of j move                      ->   <- */
   for (rlj = stop->next; rlj != stop; rlj = rlj->next) {
@@ -642,43 +657,35 @@ static void fnb(baum *rli) {
     if ((rlj->typ=='p')||(rlj->typ=='q')) continue;
     /* j-position of base pair shifts to k position (ij)->(ik) i<k<j */
     if ( (rlj->nummer-rli->nummer >= MYTURN)
-	 && (ptype[rli->nummer][rlj->nummer]) ) {
+	 && (ctx->ptype[rli->nummer][rlj->nummer]) ) {
       /* open original basepair */
-      open_bp(rli);
+      open_bp(ctx, rli);
       /* close shifted version of original basepair */
-      close_bp(rli, rlj);
-      /* evaluate energy of the structure */
-#if HAVE_LIBRNA_API3
-      EoT = vrna_eval_structure_pt(GAV.vc, pairList);
-#else
-      EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
-#endif
+      close_bp(ctx, rli, rlj);
+      /* evaluate energy of the two loops */
+      EoT = E_old + eval_loop(ctx, rli->nummer+1) + eval_loop(ctx, par->nummer+1);
       /* put the move and the enegy of the structure into the neighbour list */
-      update_nbList(1+rli->nummer, -(1+rlj->nummer), EoT);
+      update_nbList(ctx, 1+rli->nummer, -(1+rlj->nummer), EoT);
       /* open shifted basepair */
-      open_bp(rli);
+      open_bp(ctx, rli);
       /* restore original basepair */
-      close_bp(rli, stop);
+      close_bp(ctx, rli, stop);
     }
     /* i-position of base pair shifts to position k (ij)->(kj) i<k<j */
     if ( (stop->nummer-rlj->nummer >= MYTURN)
-	 && (ptype[stop->nummer][rlj->nummer]) ) {
+	 && (ctx->ptype[stop->nummer][rlj->nummer]) ) {
       /* open original basepair */
-      open_bp(rli);
+      open_bp(ctx, rli);
       /* close shifted version of original basepair */
-      close_bp(rlj, stop);
-      /* evaluate energy of the structure */
-#if HAVE_LIBRNA_API3
-      EoT = vrna_eval_structure_pt(GAV.vc, pairList);
-#else
-      EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
-#endif
+      close_bp(ctx, rlj, stop);
+      /* evaluate energy of the two loops */
+      EoT = E_old + eval_loop(ctx, rlj->nummer+1) + eval_loop(ctx, par->nummer+1);
       /* put the move and the enegy of the structure into the neighbour list */
-      update_nbList(-(1 + rlj->nummer), 1 + stop->nummer, EoT);
+      update_nbList(ctx, -(1 + rlj->nummer), 1 + stop->nummer, EoT);
       /* open shifted basepair */
-      open_bp(rlj);
+      open_bp(ctx, rlj);
       /* restore original basepair */
-      close_bp(rli, stop);
+      close_bp(ctx, rli, stop);
     }
   }
   /* examin exterior loop of bp(ij);   (.......)
@@ -688,7 +695,7 @@ static void fnb(baum *rli) {
     x=rlj->nummer-rli->nummer;
     if (x<0) x=-x;
     /* j-position of base pair shifts to position k */
-    if ((x >= MYTURN) && (ptype[rli->nummer][rlj->nummer])) {
+    if ((x >= MYTURN) && (ctx->ptype[rli->nummer][rlj->nummer])) {
       if (rli->nummer<rlj->nummer) {
 	help_rli=rli;
 	help_rlj=rlj;
@@ -698,26 +705,22 @@ static void fnb(baum *rli) {
 	help_rlj=rli;
       }
       /* open original basepair */
-      open_bp(rli);
+      open_bp(ctx, rli);
       /* close shifted version of original basepair */
-      close_bp(help_rli,help_rlj);
-      /* evaluate energy of the structure */
-#if HAVE_LIBRNA_API3
-      EoT = vrna_eval_structure_pt(GAV.vc, pairList);
-#else
-      EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
-#endif
+      close_bp(ctx, help_rli,help_rlj);
+      /* evaluate energy of the two loops */
+      EoT = E_old + eval_loop(ctx, help_rli->nummer+1) + eval_loop(ctx, par->nummer+1);
       /* put the move and the enegy of the structure into the neighbour list */
-      update_nbList(1 + rli->nummer, -(1 + rlj->nummer), EoT);
+      update_nbList(ctx, 1 + rli->nummer, -(1 + rlj->nummer), EoT);
       /* open shifted base pair */
-      open_bp(help_rli);
+      open_bp(ctx, help_rli);
       /* restore original basepair */
-      close_bp(rli,stop);
+      close_bp(ctx, rli,stop);
     }
     x = rlj->nummer-stop->nummer;
     if (x < 0) x = -x;
     /* i-position of base pair shifts to position k */
-    if ((x >= MYTURN) && (ptype[stop->nummer][rlj->nummer])) {
+    if ((x >= MYTURN) && (ctx->ptype[stop->nummer][rlj->nummer])) {
       if (stop->nummer < rlj->nummer) {
 	help_rli = stop;
 	help_rlj = rlj;
@@ -727,73 +730,130 @@ static void fnb(baum *rli) {
 	help_rlj = stop;
       }
       /* open original basepair */
-      open_bp(rli);
+      open_bp(ctx, rli);
        /* close shifted version of original basepair */
-      close_bp(help_rli, help_rlj);
-      /* evaluate energy of the structure */
-#if HAVE_LIBRNA_API3
-      EoT = vrna_eval_structure_pt(GAV.vc, pairList);
-#else
-      EoT = energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0);
-#endif
+      close_bp(ctx, help_rli, help_rlj);
+      /* evaluate energy of the two loops */
+      EoT = E_old + eval_loop(ctx, help_rli->nummer+1) + eval_loop(ctx, par->nummer+1);
       /* put the move and the enegy of the structure into the neighbour list */
-      update_nbList(-(1 + rlj->nummer), 1 + stop->nummer, EoT);
+      update_nbList(ctx, -(1 + rlj->nummer), 1 + stop->nummer, EoT);
       /* open shifted basepair */
-      open_bp(help_rli);
+      open_bp(ctx, help_rli);
       /* restore original basepair */
-      close_bp(rli,stop);
+      close_bp(ctx, rli,stop);
     }
   }
 }
 
 /* for a given tree (structure),
    generate all neighbours according to moveset */
-void move_it (void) {
+void move_it (SimContext *ctx) {
   int i;
   
 #if HAVE_LIBRNA_API3
-  GSV.currE = (float)vrna_eval_structure_pt(GAV.vc, pairList)/100.;
+  ctx->currE_int = vrna_eval_structure_pt(ctx->vc, ctx->pairList);
 #else
-  GSV.currE =
-    energy_of_struct_pt_par(GAV.farbe, pairList, typeList, aliasList, GAV.params, 0)/100.;
+  ctx->currE_int =
+    energy_of_struct_pt_par(ctx->farbe, ctx->pairList, ctx->typeList, ctx->aliasList, GAV.params, 0);
 #endif
-  
-  if ( GTV.noLP ) { /* canonical neighbours only */
-    inb_nolp(wurzl);
-    for (i = 0; i < GSV.len; i++) {
-      
-      if (pairList[i+1]>i+1) {
-	inb_nolp(rl+i);      /* insert pair neighbours */
-	dnb_nolp(rl+i);  /* delete pair neighbour */
-      }
+  ctx->currE = (float)ctx->currE_int/100.;
+
+  clear_nbList(ctx);
+  make_group(ctx, ctx->wurzl);
+  for (i = 0; i < ctx->len; i++)
+    if (ctx->pairList[i+1]>i+1) make_group(ctx, ctx->rl+i);
+
+  ctx->nb_valid = 1;
+  ctx->nb_from_scratch = 1;
+}
+
+/*
+  regenerate the neighbours of all loops changed by the last move,
+  returns 0 if the neighbourhood has to be generated from scratch
+*/
+int update_neighbors (SimContext *ctx) {
+  int k, g;
+  baum *root;
+
+  if ( !ctx->nb_valid || GTV.noLP ) return 0;
+
+  for (k = 0; k < ctx->num_dirty; k++) {
+    g = ctx->dirty[k];
+    ctx->is_dirty[g] = 0;
+    root = (g == ctx->num_groups-1) ? ctx->wurzl : ctx->rl+g;
+    if ((root == ctx->wurzl) || (root->typ == 'p'))
+      make_group(ctx, root);
+    else { /* base pair is gone */
+      begin_nbGroup(ctx, g);
+      end_nbGroup(ctx);
     }
   }
+  ctx->num_dirty = 0;
+
+  return 1;
+}
+
+/* generate all neighbours of the loop closed by root */
+static void make_group (SimContext *ctx, baum *root) {
+
+  begin_nbGroup(ctx, (root == ctx->wurzl) ? ctx->num_groups-1 : root->nummer);
+  if ( GTV.noLP ) { /* canonical neighbours only */
+    inb_nolp(ctx, root);                  /* insert pair neighbours */
+    if (root != ctx->wurzl)
+      dnb_nolp(ctx, root);                /* delete pair neighbour */
+  }
   else { /* all neighbours */
-    inb(wurzl);
-    for (i = 0; i < GSV.len; i++) {
-      
-      if (pairList[i+1]>i+1) {
-	inb(rl+i); 	 /* insert pair neighbours */
-	dnb(rl+i);  /* delete pair neighbour */
-	if ( GTV.noShift == 0 ) fnb(rl+i);
-      }
+    inb(ctx, root);                       /* insert pair neighbours */
+    if (root != ctx->wurzl) {
+      dnb(ctx, root);                     /* delete pair neighbour */
+      if ( GTV.noShift == 0 ) fnb(ctx, root);
     }
   }
+  end_nbGroup(ctx);
+}
+
+/* pair closing the loop that contains x (virtualroot for exterior loop) */
+static baum *enclosing_loop (baum *x) {
+  baum *r;
+
+  for (r=x->next; r->up==NULL; r=r->next);
+  return r->up;
+}
+
+/*
+  the loop closed by root changed, so its own neighbours and the ones
+  of the pairs in it (deletions and outward shifts) must be regenerated
+*/
+static void touch_loop (SimContext *ctx, baum *root) {
+  baum *stop, *r;
+
+  mark_nbGroup(ctx, (root == ctx->wurzl) ? ctx->num_groups-1 : root->nummer);
+  stop = root->down;
+  for (r = stop->next; r != stop; r = r->next)
+    if (r->typ == 'p') mark_nbGroup(ctx, r->nummer);
 }
 
+/* energy of the loop closed by the pair at position i (0 exterior loop) */
+static int eval_loop (SimContext *ctx, int i) {
+#if HAVE_LIBRNA_API3
+  return vrna_eval_loop_pt(ctx->vc, i, ctx->pairList);
+#else
+  return loop_energy(ctx->pairList, ctx->typeList, ctx->aliasList, i);
+#endif
+}
 
 /**/
-void clean_up_rl(void) {
+void clean_up_rl(SimContext *ctx) {
   int i;
-  free(pairList); pairList=NULL;
-  free(typeList); typeList = NULL;
-  free(aliasList); aliasList = NULL;
-  free(rl); rl=NULL;
-  free(wurzl);  wurzl=NULL;
-  for (i=0; i<=GSV.len; i++)
-    free(ptype[i]);
-  free(ptype);
-  ptype=NULL;
+  free(ctx->pairList); ctx->pairList=NULL;
+  free(ctx->typeList); ctx->typeList = NULL;
+  free(ctx->aliasList); ctx->aliasList = NULL;
+  free(ctx->rl); ctx->rl=NULL;
+  free(ctx->wurzl);  ctx->wurzl=NULL;
+  for (i=0; i<=ctx->len; i++)
+    free(ctx->ptype[i]);
+  free(ctx->ptype);
+  ctx->ptype=NULL;
 }
 
 /**/
@@ -806,27 +866,27 @@ static int comp_struc(const void *A, const void *B) {
 
 #if 0
 /**/
-static void rl_status(void) {
+static void rl_status(SimContext *ctx) {
 
   int i;
 
-  printf("\n%s\n%s\n", GAV.farbe, GAV.currform);
-  for (i=0; i <= GSV.len; i++) {
+  printf("\n%s\n%s\n", ctx->farbe, ctx->currform);
+  for (i=0; i <= ctx->len; i++) {
     printf("%2d %c %c %2d %2d %2d %2d\n",
-	   rl[i].nummer,
-	   i == GSV.len ? 'X': GAV.farbe[i],
-	   rl[i].typ,
-	   rl[i].up==NULL?0:(rl[i].up)->nummer,
-	   rl[i].down==NULL?0:(rl[i].down)->nummer,
-	   (rl[i].prev)->nummer,
-	   (rl[i].next)->nummer);
+	   ctx->rl[i].nummer,
+	   i == ctx->len ? 'X': ctx->farbe[i],
+	   ctx->rl[i].typ,
+	   ctx->rl[i].up==NULL?0:(ctx->rl[i].up)->nummer,
+	   ctx->rl[i].down==NULL?0:(ctx->rl[i].down)->nummer,
+	   (ctx->rl[i].prev)->nummer,
+	   (ctx->rl[i].next)->nummer);
   }
   printf("---\n");
 }
 #endif
 
 #define TURN 3
-static void make_ptypes(const short *S) {
+static void make_ptypes(SimContext *ctx, const short *S) {
   int n,i,j,k,l;
   n=S[0];
   for (k=1; k<n; k++)
@@ -840,7 +900,7 @@ static void make_ptypes(const short *S) {
 	if ((i>1)&&(j<n)) ntype = pair[S[i-1]][S[j+1]];
 	if (noLonelyPairs && (!otype) && (!ntype))
 	  type = 0; /* i.j can only form isolated pairs */
-	ptype[i-1][j-1] = ptype[j-1][i-1] = (char) type;
+	ctx->ptype[i-1][j-1] = ctx->ptype[j-1][i-1] = (char) type;
 	otype =  type;
 	type  = ntype;
 	i--; j++;
@@ -848,35 +908,35 @@ static void make_ptypes(const short *S) {
     }
 }
 
-static void close_bp_en (baum *i, baum *j) {
+static void close_bp_en (SimContext *ctx, baum *i, baum *j) {
   /* close bp and update energy */
   baum *r;
-  close_bp(i,j);
+  close_bp(ctx, i,j);
 
 #if HAVE_LIBRNA_API3
-  i->loop_energy = vrna_eval_loop_pt(GAV.vc, i->nummer+1, pairList);
+  i->loop_energy = vrna_eval_loop_pt(ctx->vc, i->nummer+1, ctx->pairList);
 #else
-  i->loop_energy = loop_energy(pairList,typeList,aliasList,i->nummer+1);
+  i->loop_energy = loop_energy(ctx->pairList,ctx->typeList,ctx->aliasList,i->nummer+1);
 #endif
 
   for (r=i->next; r->up==NULL; r=r->next);
 
 #if HAVE_LIBRNA_API3
-  r->up->loop_energy = vrna_eval_loop_pt(GAV.vc, r->up->nummer+1, pairList);
+  r->up->loop_energy = vrna_eval_loop_pt(ctx->vc, r->up->nummer+1, ctx->pairList);
 #else
-  r->up->loop_energy = loop_energy(pairList,typeList,aliasList,r->up->nummer+1);
+  r->up->loop_energy = loop_energy(ctx->pairList,ctx->typeList,ctx->aliasList,r->up->nummer+1);
 #endif
 };
 
-static void open_bp_en (baum *i) {
+static void open_bp_en (SimContext *ctx, baum *i) {
   /* open bp and update energy */
   baum *r;
   i->loop_energy=0;
-  open_bp(i);
+  open_bp(ctx, i);
   for (r=i->next; r->up==NULL; r=r->next);
 #if HAVE_LIBRNA_API3
-  r->up->loop_energy = vrna_eval_loop_pt(GAV.vc, r->up->nummer+1, pairList);
+  r->up->loop_energy = vrna_eval_loop_pt(ctx->vc, r->up->nummer+1, ctx->pairList);
 #else
-  r->up->loop_energy = loop_energy(pairList,typeList,aliasList,r->up->nummer+1);
+  r->up->loop_energy = loop_energy(ctx->pairList,ctx->typeList,ctx->aliasList,r->up->nummer+1);
 #endif
 };
@@ -9,12 +9,16 @@
 #ifndef BAUM_H
 #define BAUM_H
 
+#include "simulation.h"
+
 /* used in main.c */
-extern void ini_or_reset_rl(void);
-extern void move_it(void);
-extern void clean_up_rl(void);
+extern void ini_shared_data(void);
+extern void ini_or_reset_rl(SimContext *ctx);
+extern void move_it(SimContext *ctx);
+extern int update_neighbors(SimContext *ctx);
+extern void clean_up_rl(SimContext *ctx);
 
 /* used in nachbar.c */
-extern void update_tree(int i,int j);
+extern void update_tree(SimContext *ctx, int i,int j);
 
 #endif
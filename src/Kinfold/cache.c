@@ -19,6 +19,7 @@
 #endif
 
 #include "cache_util.h"
+#include "simulation.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -26,120 +27,262 @@
 # define INLINE
 #endif
 
-/*
-  modify cache_f(), cache_comp() and the typedef of cache_entry
-  in cache_utils.h to suit your application
-*/
-
 /* PUBLIC FUNCTIONES */
-cache_entry *lookup_cache (char *x);
-int write_cache (cache_entry *x);
-/*  void delete_cache (cache_entry *x); */
-void kill_cache();
-void initialize_cache();
+cache_entry *new_cache_entry(const char *structure, int top);
+cache_entry *lookup_cache (SimContext *ctx, char *x);
+int write_cache (SimContext *ctx, cache_entry *x);
+void kill_cache(SimContext *ctx);
+void initialize_cache(SimContext *ctx, size_t max_mem);
 
 /* PRIVATE FUNCTIONES */
-/*  static int cache_comp(cache_entry *x, cache_entry *y); */
-INLINE static unsigned cache_f (char *x);
-
-/* #define CACHESIZE 67108864 -1 */ /* 2^26 -1   must be power of 2 -1 */
-/* #define CACHESIZE 33554432 -1 */ /* 2^25 -1   must be power of 2 -1 */
-/* #define CACHESIZE 16777216 -1 */ /* 2^24 -1   must be power of 2 -1 */ 
-/* #define CACHESIZE  4194304 -1 */ /* 2^22 -1   must be power of 2 -1 */
-#define CACHESIZE  1048576 -1  /* 2^20 -1   must be power of 2 -1 */
-/* #define CACHESIZE   262144 -1 */ /* 2^18 -1   must be power of 2 -1 */
-/* next is default */
-/* #define CACHESIZE    65536 -1 */ /* 2^16 -1   must be power of 2 -1 */
-/* #define CACHESIZE    16384 -1 */ /* 2^14 -1   must be power of 2 -1 */
-/* #define CACHESIZE     4096 -1 */ /* 2^12 -1   must be power of 2 -1 */
-
-static cache_entry *cachetab[CACHESIZE+1];
+INLINE static unsigned cache_f (const unsigned char *x, int len);
+INLINE static int pack_struc(const char *x, unsigned char *p);
+static unsigned long find_slot(cache_table *T, const unsigned char *key, int len, unsigned hash);
+static void remove_slot(cache_table *T, unsigned long i);
+static void evict(cache_table *T);
+static void grow_table(cache_table *T);
+
+#define MINSLOTS 1024
+#define PACKED_SIZE(n) (((n)+3)/4)
+
 static char UNUSED rcsid[] ="$Id: cache.c,v 1.3 2006/10/04 12:45:12 xtof Exp $";
-unsigned long collisions=0;
-
-/* stolen from perl source */
-char coeff[] = {
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1};
-
-/* key must not be longer than 128 */
-INLINE static unsigned cache_f(char *x) { 
-  register char *s;
-  register int i;
-  register unsigned cache;
-
-  s = x;
-
-  for (i=0,    cache = 0;
-       /* while */ *s;
-       s++,           i++ , cache *= 5 ) {
-    cache += *s * coeff[i];
+
+/* FNV-1a */
+INLINE static unsigned cache_f(const unsigned char *x, int len) {
+  unsigned cache = 2166136261U;
+  int i;
+
+  for (i = 0; i < PACKED_SIZE(len); i++) {
+    cache ^= x[i];
+    cache *= 16777619U;
   }
+  cache ^= (unsigned)len;
+  cache *= 16777619U;
+  return cache;
+}
+
+/* store structure x with 2 bits per position, returns its length */
+INLINE static int pack_struc(const char *x, unsigned char *p) {
+  int i;
 
-   /* divide through CACHESIZE for normalization */
-  return ((cache) & (CACHESIZE));
+  for (i = 0; x[i]; i++) {
+    if ((i & 3) == 0) p[i>>2] = 0;
+    switch (x[i]) {
+      case '(': p[i>>2] |= 1 << (2*(i & 3)); break;
+      case ')': p[i>>2] |= 2 << (2*(i & 3)); break;
+      default : break;
+    }
+  }
+  return i;
 }
 
+/* allocate an entry for structure with top neighbours in one block */
+cache_entry *new_cache_entry(const char *structure, int top) {
+  cache_entry *c;
+  size_t size;
+  int len;
+  char *p;
 
-/* returns NULL unless x is in the cache */
-cache_entry *lookup_cache (char *x) {
-  int cacheval;
+  len = strlen(structure);
+  size = sizeof(cache_entry)
+    + top*(sizeof(double) + sizeof(int) + 3*sizeof(short))
+    + PACKED_SIZE(len);
+  if ((c = (cache_entry *) malloc(size))==NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  c->size = size;
+  c->len = len;
+  c->top = top;
+  /* arrays in order of decreasing alignment */
+  p = (char *)(c+1);
+  c->cum = (double *)p;       p += top*sizeof(double);
+  c->dE = (int *)p;           p += top*sizeof(int);
+  c->neighbors = (short *)p;  p += 2*top*sizeof(short);
+  c->groups = (short *)p;     p += top*sizeof(short);
+  c->structure = (unsigned char *)p;
+  pack_struc(structure, c->structure);
+
+  return c;
+}
+
+/* slot holding the structure key or the empty slot it would go to */
+static unsigned long find_slot(cache_table *T, const unsigned char *key, int len, unsigned hash) {
+  unsigned long i, mask = T->size - 1;
   cache_entry *c;
 
-  cacheval=cache_f(x);
-  if ((c=cachetab[cacheval]))
-    if (strcmp(c->structure,x)==0) return c;
-  
-  return NULL;
+  for (i = hash & mask; (c = T->slots[i].entry); i = (i+1) & mask)
+    if ((T->slots[i].hash == hash) && (c->len == len)
+        && (memcmp(c->structure, key, PACKED_SIZE(len)) == 0))
+      break;
+
+  return i;
+}
+
+/* returns NULL unless x is in the cache */
+cache_entry *lookup_cache (SimContext *ctx, char *x) {
+  cache_table *T = ctx->cache;
+  unsigned long i;
+  int len;
+
+  if (T->size == 0) return NULL;
+
+  len = strlen(x);
+  if (PACKED_SIZE(len) > T->key_size) {
+    T->key_size = PACKED_SIZE(len);
+    T->key = (unsigned char *)realloc(T->key, T->key_size);
+    if (T->key == NULL) {
+      fprintf(stderr, "out of memory\n"); exit(255);
+    }
+  }
+  pack_struc(x, T->key);
+
+  i = find_slot(T, T->key, len, cache_f(T->key, len));
+  if (T->slots[i].entry == NULL) {
+    T->misses++;
+    return NULL;
+  }
+
+  T->hits++;
+  T->slots[i].ref = 1;
+  return T->slots[i].entry;
+}
+
+/*
+  remove the entry in slot i and move following entries of
+  its probe sequence up, so no tombstones are needed
+*/
+static void remove_slot(cache_table *T, unsigned long i) {
+  unsigned long j, k, mask = T->size - 1;
+
+  T->mem -= T->slots[i].entry->size;
+  free(T->slots[i].entry);
+  T->count--;
+
+  for (j = (i+1) & mask; T->slots[j].entry; j = (j+1) & mask) {
+    k = T->slots[j].hash & mask;
+    /* entry in j may move to i unless its home k lies cyclically in (i,j] */
+    if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j))) continue;
+    T->slots[i] = T->slots[j];
+    i = j;
+  }
+  T->slots[i].entry = NULL;
+  T->slots[i].ref = 0;
+}
+
+/* CLOCK: evict the next entry that was not referenced since the last sweep */
+static void evict(cache_table *T) {
+  unsigned long mask = T->size - 1;
+
+  for (;; T->hand = (T->hand+1) & mask) {
+    if (T->slots[T->hand].entry == NULL) continue;
+    if (T->slots[T->hand].ref) {
+      T->slots[T->hand].ref = 0;
+      continue;
+    }
+    remove_slot(T, T->hand);
+    T->evictions++;
+    return;
+  }
+}
+
+/* double number of slots */
+static void grow_table(cache_table *T) {
+  cache_slot *old = T->slots;
+  unsigned long i, j, mask, n = T->size;
+
+  T->size *= 2;
+  mask = T->size - 1;
+  T->slots = (cache_slot *)calloc(T->size, sizeof(cache_slot));
+  if (T->slots == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  for (i = 0; i < n; i++) {
+    if (old[i].entry == NULL) continue;
+    for (j = old[i].hash & mask; T->slots[j].entry; j = (j+1) & mask);
+    T->slots[j] = old[i];
+  }
+  free(old);
+  T->mem += n*sizeof(cache_slot);
+  T->hand = 0;
 }
 
 /* returns 1 if x already was in the cache */
-int write_cache (cache_entry *x) {
-  int cacheval;
-  cache_entry *c;
-  
-  cacheval=cache_f(x->structure);
-  if ((c=cachetab[cacheval])) {
-    free(c->structure);
-    free(c->neighbors);
-    free(c->rates);
-    free(c->energies);
-    free(c);
+int write_cache (SimContext *ctx, cache_entry *x) {
+  cache_table *T = ctx->cache;
+  unsigned long i;
+  unsigned hash;
+  int found = 0;
+
+  /* entry would not fit even into an empty cache */
+  if ((T->size == 0) || (T->size*sizeof(cache_slot) + x->size > T->max_mem)) {
+    free(x);
+    return 0;
+  }
+
+  hash = cache_f(x->structure, x->len);
+  i = find_slot(T, x->structure, x->len, hash);
+  if (T->slots[i].entry) {
+    /* replace entry of same structure */
+    T->mem -= T->slots[i].entry->size;
+    free(T->slots[i].entry);
+    found = 1;
+  }
+  else {
+    /* keep load factor below 3/4, enlarge table while budget allows */
+    while (4*(T->count+1) > 3*T->size) {
+      if (T->mem + T->size*sizeof(cache_slot) + x->size <= T->max_mem)
+        grow_table(T);
+      else
+        evict(T);
+    }
+    while ((T->count > 0) && (T->mem + x->size > T->max_mem))
+      evict(T);
+    i = find_slot(T, x->structure, x->len, hash);
+    T->count++;
   }
-  cachetab[cacheval]=x;
-  return 0;
+  T->slots[i].entry = x;
+  T->slots[i].hash = hash;
+  T->slots[i].ref = 1;
+  T->mem += x->size;
+
+  return found;
 }
 
-/**/
-void initialize_cache () { }
+/*
+  every simulation context has a cache of its own that
+  never uses more than max_mem bytes (0 turns caching off)
+*/
+void initialize_cache (SimContext *ctx, size_t max_mem) {
+  cache_table *T;
 
-/**/
-void kill_cache () {
-  int i;
-  
-  for (i=0;i<CACHESIZE+1;i++) {
-    if ( cachetab[i] ) {
-      free (cachetab[i]->structure);
-      free (cachetab[i]->neighbors);
-      free (cachetab[i]->rates);
-      free (cachetab[i]->energies);
-      free (cachetab[i]);
+  T = (cache_table *)calloc(1, sizeof(cache_table));
+  if (T == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  T->max_mem = max_mem;
+  if (max_mem >= MINSLOTS*sizeof(cache_slot)) {
+    T->size = MINSLOTS;
+    T->slots = (cache_slot *)calloc(T->size, sizeof(cache_slot));
+    if (T->slots == NULL) {
+      fprintf(stderr, "out of memory\n"); exit(255);
     }
-    cachetab[i]=NULL;
+    T->mem = T->size*sizeof(cache_slot);
   }
+  ctx->cache = T;
 }
 
-#if 0
 /**/
-static int cache_comp(cache_entry *x, cache_entry *y) {
-  return strcmp(((cache_entry *)x)->structure, ((cache_entry *)y)->structure);
+void kill_cache (SimContext *ctx) {
+  unsigned long i;
+
+  if (ctx->cache == NULL) return;
+
+  for (i = 0; i < ctx->cache->size; i++)
+    free(ctx->cache->slots[i].entry);
+  free(ctx->cache->slots);
+  free(ctx->cache->key);
+  free(ctx->cache);
+  ctx->cache = NULL;
 }
-#endif
 
 /* End of file */
@@ -9,25 +9,57 @@
 #ifndef CACHE_UTIL_H
 #define CACHE_UTIL_H
 
+#include <stddef.h>
+
 #ifdef __GNUC__
 #define UNUSED __attribute__ ((unused))
 #else
 #define UNUSED
 #endif
 
+/*
+  a cache entry is a single block of memory, the arrays
+  point into the block right behind the header
+*/
 typedef struct {
-  char *structure;
+  size_t size;       /* size of the block in bytes */
+  int len;           /* length of structure */
   int top;           /* number of neighbors */
-  int lmin;          /* is a local minimum ? */
-  double flux;       /* sum of rates */
-  double energy;     /* energy of this structure */
-  short *neighbors;  
-  float *rates;
-  double *energies;
+  int energy;        /* energy of this structure in dcal/mol */
+  double *cum;       /* cumulative rates within each group */
+  int *dE;           /* energy change of the moves */
+  short *neighbors;
+  short *groups;     /* closing pair the neighbor was generated from */
+  unsigned char *structure; /* 2 bits per position */
 } cache_entry;
 
-extern cache_entry *lookup_cache (char *x);
-extern int write_cache (cache_entry *x);
-void kill_cache(void);
+typedef struct {
+  unsigned int hash;
+  unsigned int ref;  /* referenced since the clock hand passed by */
+  cache_entry *entry;
+} cache_slot;
+
+/* open addressing hash table with CLOCK eviction */
+typedef struct {
+  cache_slot *slots;
+  unsigned long size;      /* number of slots, power of 2 */
+  unsigned long count;     /* number of entries */
+  unsigned long hand;      /* position of clock hand */
+  size_t mem;              /* memory used by slots and entries */
+  size_t max_mem;          /* memory budget */
+  unsigned char *key;      /* packed structure of last lookup */
+  int key_size;
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+} cache_table;
+
+struct _SimContext;
+
+extern cache_entry *new_cache_entry(const char *structure, int top);
+extern cache_entry *lookup_cache (struct _SimContext *ctx, char *x);
+extern int write_cache (struct _SimContext *ctx, cache_entry *x);
+void initialize_cache(struct _SimContext *ctx, size_t max_mem);
+void kill_cache(struct _SimContext *ctx);
 
 #endif
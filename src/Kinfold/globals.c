@@ -76,6 +76,8 @@ static struct option const long_options[] =
   {"met",      no_argument,       &GTV.mc, 1},
   {"grow",    required_argument, 0,  0},
   {"glen",    required_argument, 0,  0},
+  {"jobs",    required_argument, 0,  0},
+  {"cache",   required_argument, 0,  0},
   {"log",     required_argument, 0,  0},
   {"silent",  no_argument,       0,  0},
   {"lmin",    no_argument,       &GTV.lmin, 1},
@@ -100,16 +102,14 @@ void clean_up_globals(void) {
   free(GAV.farbe);
   free(GAV.farbe_full);
   free(GAV.startform);
-  free(GAV.currform);
-  free(GAV.prevform);
   for (i = 0; i < GSV.maxS; i++) free(GAV.stopform[i]);
   free(GAV.stopform);
   free(GAV.sE);
-#if HAVE_RNALIB_API3
+#if HAVE_LIBRNA_API3
   vrna_fold_compound_free(GAV.vc);
 #else
-# if HAVE_RNALIB2
-  free(GAV.params);
+# if HAVE_LIBRNA_API2
+  vrna_params_free(GAV.params);
 # endif
 #endif
 }
@@ -139,6 +139,8 @@ static void usage(int status) {
 	  "  --fpt                 stop stop structure(s) is reached\n"
 	  "  --rect                stop start structure is reached\n"
 	  "  --grow <float>        grow chain every <float> time steps\n"
+	  "  --jobs <int>          simulate trajectories with <int> threads\n"
+	  "  --cache <int>         limit neighbourhood cache to <int> MB\n"
 	  "  --phi <double>        set phi value to <double>\n"
 	  "  --pbounds <d1=d2=d3>  set phi_min to d1\n"
 	  "                            phi_inc to d2\n"
@@ -382,6 +384,20 @@ static void process_options_gg (int argc, char *argv[]) {
   GTV.lmin = args_info.lmin_flag;
   GTV.fpt  = args_info.fpt_flag;
   GTV.rect = args_info.rect_flag;
+  if (args_info.jobs_given) {
+    if (args_info.jobs_arg < 0) {
+      fprintf(stderr, "Value of --jobs must be >= 0 >%d<\n", args_info.jobs_arg);
+      exit(EXIT_FAILURE);
+    }
+    GSV.jobs = args_info.jobs_arg;
+  }
+  if (args_info.cache_given) {
+    if (args_info.cache_arg < 0) {
+      fprintf(stderr, "Value of --cache must be >= 0 >%d<\n", args_info.cache_arg);
+      exit(EXIT_FAILURE);
+    }
+    GSV.cache = args_info.cache_arg;
+  }
   cmdline_parser_free(&args_info);
 }
 /**/
@@ -519,6 +535,30 @@ static int process_options (int argc, char *argv[]) {
 	  if (sscanf(optarg, "%d", &GSV.glen) == 0)
 	    usage(EXIT_FAILURE);
 
+	if (strcmp(long_options[option_index].name,"jobs")==0) {
+	  itmp = -1;
+	  if (sscanf(optarg, "%d", &itmp) == 0)
+	    usage(EXIT_FAILURE);
+	  else if ( itmp >= 0 )
+	    GSV.jobs = itmp;
+	  else {
+	    fprintf(stderr, "Value of --jobs must be >= 0 >%d<\n", itmp);
+	    usage(EXIT_FAILURE);
+	  }
+	}
+
+	if (strcmp(long_options[option_index].name,"cache")==0) {
+	  itmp = -1;
+	  if (sscanf(optarg, "%d", &itmp) == 0)
+	    usage(EXIT_FAILURE);
+	  else if ( itmp >= 0 )
+	    GSV.cache = itmp;
+	  else {
+	    fprintf(stderr, "Value of --cache must be >= 0 >%d<\n", itmp);
+	    usage(EXIT_FAILURE);
+	  }
+	}
+
 	break;
 
       case 'h':
@@ -558,11 +598,12 @@ static void ini_gvars(void) {
   GSV.Temp = 37.0;
   GSV.startE = 0.0;
   GSV.stopE = 0.0;
-  GSV.currE = 0.0;
   GSV.time = 500.0;
   GSV.phi = 1.0;
   GSV.simTime = 0.0;
   GSV.glen = 15;
+  GSV.jobs = 1;
+  GSV.cache = 64;
 }
 
 /**/
@@ -579,8 +620,7 @@ static void ini_garrays(void) {
   assert(GAV.stopform != NULL);
   GAV.farbe = NULL;
   GAV.startform = NULL;
-  GAV.currform = NULL;
-  GAV.prevform = NULL;
+  GAV.logFP = NULL;
   GAV.phi_bounds[0] = 0.1;
   GAV.phi_bounds[1] = 0.1;
   GAV.phi_bounds[2] = 2.0;
@@ -16,6 +16,7 @@
 #endif
 
 #include "config.h"
+#include <stdio.h>
 
 #if HAVE_LIBRNA_API3
 #include <ViennaRNA/model.h>
@@ -29,12 +30,13 @@ typedef struct _GlobVars {
   int len;
   int num;
   int maxS;
-  int steps;
+  int jobs;            /* number of trajectories simulated in parallel */
+  int cache;           /* memory budget of neighbourhood cache in MB */
+  size_t cache_max;    /* memory budget of cache of every simulation in bytes */
   float cut;
   float Temp;
   float startE;
   float stopE;
-  float currE;
   double grow;
   int    glen;
   double time;
@@ -50,11 +52,10 @@ typedef struct _GlobArrays {
   char *farbe_full;    /* full sequence (for chain growth simulation) */
   char *startform;     /* start structure */
   char **stopform;     /* stop structure(s) */
-  char *currform;      /* current structure */
-  char *prevform;      /* current structure of previous time step */
   float *sE;           /* energy(s) of stop structure(s) */
   double phi_bounds[3];   /* phi_min, phi_inc, phi_max */
   unsigned short subi[3]; /* seeds for random-number-generator */
+  FILE *logFP;         /* log-file */
 
 #if HAVE_LIBRNA_API3
   vrna_md_t md;
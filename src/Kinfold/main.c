@@ -29,20 +29,38 @@
 #include "nachbar.h"
 #include "cache_util.h"
 #include "globals.h"
+#include "simulation.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#if HAVE_LIBRNA_API3
+#include <ViennaRNA/datastructures/stream_output.h>
+#endif
+#endif
 
 static char UNUSED rcsid[] ="$Id: main.c,v 1.5 2008/08/28 09:40:55 ivo Exp $";
+static unsigned long cache_hits = 0, cache_misses = 0, cache_evictions = 0;
 extern void  read_parameter_file(const char fname[]);
-extern void get_from_cache(cache_entry *c);
 
 /* PRIVAT FUNCTIONS */
 static void ini_energy_model(void);
 static void read_data(void);
+static void ini_log(void);
+static void simulate(int jobs, const unsigned short *seeds, int *found, double *fpt);
+static void run_trajectory(SimContext *ctx);
+static void log_summary(const int *found, const double *fpt);
+static void collect_cache_stats(SimContext *ctx);
+static void log_cache_stats(void);
 static void clean_up(void);
 
 /**/
 int main(int argc, char *argv[]) {
-  int i;
-  char * start, *tmp;
+  int i, jobs, *found;
+  double *fpt;
+  unsigned short *seeds;
+#if HAVE_LIBRNA_API3
+  char *tmp;
+#endif
   
   /*
     process command-line optiones
@@ -70,63 +88,216 @@ int main(int argc, char *argv[]) {
   free(tmp);
 #endif
 
+  /*
+    energies of start and stop structure(s) are the same for all
+    simulations, so compute them only once
+  */
+  ini_shared_data();
+  ini_log();
+
+  /*
+    every simulation gets its own seed for the random-number-generator,
+    the first one is the seed of the program, every other one is derived
+    from the seed of the previous simulation
+  */
+  seeds = (unsigned short *)calloc(3*GSV.num, sizeof(unsigned short));
+  assert(seeds != NULL);
+  memcpy(seeds, GAV.subi, 3*sizeof(unsigned short));
+  for (i = 1; i < GSV.num; i++) {
+    memcpy(seeds + 3*i, seeds + 3*(i-1), 3*sizeof(unsigned short));
+    next_seed(seeds + 3*i);
+  }
+
+  found = (int *)calloc(GSV.num, sizeof(int));
+  assert(found != NULL);
+  fpt = (double *)calloc(GSV.num, sizeof(double));
+  assert(fpt != NULL);
+
+  jobs = GSV.jobs;
+#ifdef _OPENMP
+  if (jobs == 0) jobs = omp_get_num_procs();
+#else
+  jobs = 1;
+#endif
+  if (jobs > GSV.num) jobs = GSV.num;
+
+  /* every thread has a cache of its own, they share the memory budget */
+  GSV.cache_max = ((size_t)GSV.cache << 20) / jobs;
+
   /*
     perform GSV.num simulations
   */
-    
-  start = strdup(GAV.startform); /* remember startform for next run */
-  int rect; rect = GTV.rect; /* Backup and reset the recurrence time option for every simulation.  */
-  for (i = 0; i < GSV.num; i++) {
-    GTV.rect = rect;
+  simulate(jobs, seeds, found, fpt);
+
+  log_summary(found, fpt);
+  log_cache_stats();
+
+  /*
+    clean up memory
+  */
+  free(seeds);
+  free(found);
+  free(fpt);
+  clean_up();
+  return(0);
+}
+
+/**/
+static void run_trajectory(SimContext *ctx) {
+
+  /*
+    perform simulation
+  */
+  for (ctx->steps = 1;; ctx->steps++) {
+    cache_entry *c;
+
     /*
-      initialize or reset ringlist to start conditions
+      update neighbourhood of current structure after the last move,
+      else take it from cache if there or generate it from scratch
     */
-    ini_or_reset_rl();
-    if (GSV.grow>0) {
-      if (strlen(GAV.farbe)>GSV.glen) {
-        start[GSV.glen] = '\0';
-        GAV.farbe[GSV.glen] = '\0';
-        strcpy(GAV.startform,start);
-        strcpy(GAV.currform,start);
-        GSV.len=GSV.glen;
-#if HAVE_LIBRNA_API3
-        GAV.vc->length = GSV.len;
-#endif
-      }
-      clean_up_rl();
-      ini_or_reset_rl();
+    if ( !update_neighbors(ctx) ) {
+      if ( (c = lookup_cache(ctx, ctx->currform)) ) get_from_cache(ctx, c);
+      else move_it(ctx);
     }
 
     /*
-      perform simulation
+      select a structure from neighbourhood of current structure
+      and make it to the new current structure.
+      stop simulation if stop condition is met.
     */
-    for (GSV.steps = 1;; GSV.steps++) {
-      cache_entry *c;
-
-      /*
-	take neighbourhood of current structure from cache if there
-	else generate it from scratch
-      */
-      if ( (c = lookup_cache(GAV.currform)) ) get_from_cache(c);
-      else move_it();
-	
-      /*
-	select a structure from neighbourhood of current structure
-	and make it to the new current structure.
-	stop simulation if stop condition is met.
-      */
-      if ( sel_nb() > 0 ) break;
-
-      /* if (GSV.grow>0) grow_chain(); */
+    if ( sel_nb(ctx) > 0 ) break;
+  }
+}
+
+#if HAVE_LIBRNA_API3 && defined(_OPENMP)
+/* write output of a simulation once all previous ones are written */
+static void flush_output(void *auxdata, unsigned int i, void *data) {
+  vrna_cstr_t *buf = (vrna_cstr_t *)data;
+
+  vrna_cstr_free(buf[0]);
+  vrna_cstr_free(buf[1]);
+  free(buf);
+}
+#endif
+
+/**/
+static void simulate(int jobs, const unsigned short *seeds, int *found, double *fpt) {
+  int i;
+  SimContext *ctx;
+
+#if HAVE_LIBRNA_API3 && defined(_OPENMP)
+  if (jobs > 1) {
+    /*
+      trajectories are independent of each other. Each thread owns a
+      simulation context and buffers the output of its current
+      trajectory, which is written in order of the trajectories
+    */
+    vrna_ostream_t queue = vrna_ostream_init(&flush_output, NULL);
+    for (i = 0; i < GSV.num; i++) vrna_ostream_request(queue, i);
+
+#pragma omp parallel private(ctx, i) num_threads(jobs)
+    {
+      ctx = ini_sim_context();
+
+#pragma omp for schedule(dynamic, 1)
+      for (i = 0; i < GSV.num; i++) {
+        vrna_cstr_t *buf;
+
+        ctx->out = vrna_cstr(256, stdout);
+        ctx->log = vrna_cstr(256, GAV.logFP);
+        reset_sim_context(ctx, i, seeds + 3*i);
+        run_trajectory(ctx);
+        found[i] = ctx->found_stop;
+        fpt[i] = ctx->fpt;
+
+        buf = (vrna_cstr_t *)calloc(2, sizeof(vrna_cstr_t));
+        assert(buf != NULL);
+        buf[0] = ctx->out;
+        buf[1] = ctx->log;
+        ctx->out = ctx->log = NULL;
+        vrna_ostream_provide(queue, i, (void *)buf);
+      }
+
+      collect_cache_stats(ctx);
+      free_sim_context(ctx);
     }
+
+    vrna_ostream_free(queue);
+    return;
   }
-  
-  /*
-    clean up memory
-  */
-  free(start);
-  clean_up();
-  return(0);
+#endif
+
+  ctx = ini_sim_context();
+  for (i = 0; i < GSV.num; i++) {
+    reset_sim_context(ctx, i, seeds + 3*i);
+    run_trajectory(ctx);
+    found[i] = ctx->found_stop;
+    fpt[i] = ctx->fpt;
+    fflush(stdout);
+    fflush(GAV.logFP);
+  }
+  collect_cache_stats(ctx);
+  free_sim_context(ctx);
+}
+
+/**/
+static void ini_log(void) {
+  char logFN[256];
+
+  /* open log-file */
+  GAV.logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
+  assert(GAV.logFP != NULL);
+
+  /* log initial condition */
+  log_prog_params(GAV.logFP);
+  log_start_stop(GAV.logFP);
+}
+
+/* hits and first passage times of all stop structures */
+static void log_summary(const int *found, const double *fpt) {
+  int i, s, hits;
+  double sum, min, max;
+
+  for (s = 0; s <= GSV.maxS; s++) {
+    hits = 0;
+    sum = 0.;
+    min = max = 0.;
+    for (i = 0; i < GSV.num; i++) {
+      /* s == 0 collects all simulations that ran out of time */
+      if (found[i] != s) continue;
+      if ((hits == 0) || (fpt[i] < min)) min = fpt[i];
+      if ((hits == 0) || (fpt[i] > max)) max = fpt[i];
+      sum += fpt[i];
+      hits++;
+    }
+    if (s == 0)
+      fprintf(GAV.logFP, "#Summary: O   %6d\n", hits);
+    else if (hits > 0)
+      fprintf(GAV.logFP, "#Summary: X%02d %6d %12.3f %12.3f %12.3f\n",
+              s, hits, sum/hits, min, max);
+    else
+      fprintf(GAV.logFP, "#Summary: X%02d %6d\n", s, hits);
+  }
+}
+
+/**/
+static void collect_cache_stats(SimContext *ctx) {
+#pragma omp critical (kinfold_cache_stats)
+  {
+    cache_hits += ctx->cache->hits;
+    cache_misses += ctx->cache->misses;
+    cache_evictions += ctx->cache->evictions;
+  }
+}
+
+/* efficiency of the neighbourhood cache */
+static void log_cache_stats(void) {
+  unsigned long lookups = cache_hits + cache_misses;
+
+  if (GSV.cache == 0) return;
+  fprintf(GAV.logFP, "#Cache: hits=%lu misses=%lu evictions=%lu hitrate=%.2f%%\n",
+          cache_hits, cache_misses, cache_evictions,
+          (lookups > 0) ? 100.*cache_hits/lookups : 0.);
 }
 
 /**/
@@ -183,10 +354,6 @@ static void read_data(void) {
   for (i = 0; i < len; i++) GAV.farbe[i] = toupper(GAV.farbe[i]);
   free (ctmp);
   /* allocate some global arrays */
-  GAV.currform = (char *)calloc(GSV.len +1, sizeof(char));
-  assert(GAV.currform != NULL);
-  GAV.prevform = (char *)calloc(GSV.len +1, sizeof(char));
-  assert(GAV.prevform != NULL);
   GAV.startform = (char *)calloc(GSV.len +1, sizeof(char));
   assert(GAV.startform != NULL);
 
@@ -254,9 +421,8 @@ static void read_data(void) {
 }
 
 /**/
-void clean_up(void) {
+static void clean_up(void) {
+  fprintf(GAV.logFP, "\n");
+  fclose(GAV.logFP);
   clean_up_globals();
-  clean_up_rl();
-  clean_up_nbList();
-  kill_cache();
 }
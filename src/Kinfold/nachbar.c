@@ -25,313 +25,392 @@
 #endif
 
 #include "cache_util.h"
+#include "simulation.h"
 #include "baum.h"
 
 static char UNUSED rcsid[]="$Id: nachbar.c,v 1.8 2008/06/03 21:55:11 ivo Exp $";
 
-/* arrays */
-static short *neighbor_list=NULL;
-static float *bmf=NULL; /* boltzmann weight of structure */
-static const char *costring(const char *str);
-
-/* globals for laplace stuff */
-static double L = 0.0;
-static double D = 0.0;
-static double sumT = 0.0;
-static double sumK = 0.0;
-static double sumKK = 0.0;
-static double sumD = 0.0;
-static double *energies=NULL; /* energies of neighbors */
-
-/* variables */
-/*  static double highestE = -1000.0; */
-/*  static double OhighestE = -1000.0; */
-/*  static char *highestS, *OhighestS; */
-static int lmin = 1;
-static int top = 0;
-static int is_from_cache = 0;
-/*  static double meanE = 0.0; */
-static double totalflux = 0.0;
-static double Zeit = 0.0;
-static double zeitInc = 0.0;
-static double _RT = 0.6;
-
 /* public functiones */
-void ini_nbList(int chords);
-void update_nbList(int i, int j, int iE);
-int sel_nb(void);
-void clean_up_nbList(void);
-extern void update_tree(int i, int j);
+void ini_nbList(SimContext *ctx);
+void clear_nbList(SimContext *ctx);
+void begin_nbGroup(SimContext *ctx, int g);
+void update_nbList(SimContext *ctx, int i, int j, int iE);
+void end_nbGroup(SimContext *ctx);
+void mark_nbGroup(SimContext *ctx, int g);
+void get_from_cache(SimContext *ctx, cache_entry *c);
+int sel_nb(SimContext *ctx);
+void clean_up_nbList(SimContext *ctx);
 
 /* privat functiones */
-static void reset_nbList(void);
-static void grow_chain(void);
-static FILE *logFP=NULL;
+static void put_in_cache(SimContext *ctx);
+static void update_flux_tree(SimContext *ctx, int g);
+static int grow_chain(SimContext *ctx);
 
-/**/
-void ini_nbList(int chords) {
-  char logFN[256];
+/*
+  The neighbours of the current structure are kept in groups, one for
+  every loop, i.e. every closing pair plus the exterior loop (last
+  group). A move only changes the loops adjacent to the moved pair, so
+  only a few groups must be regenerated after a move (see update_tree()).
+  The rates of the groups are summed up in a binary sum-tree, such that
+  the next move is selected in O(log n) steps. Since every node of the
+  tree only depends on its leaves, the selection does not depend on the
+  order in which groups were updated.
+*/
+void ini_nbList(SimContext *ctx) {
+  int n;
 
-  _RT = (((temperature + K0) * GASCONST) / 1000.0);
-  if (neighbor_list!=NULL) return;
-  /*
-    list for move coding
-    make room for 2*chords neighbors (safe bet)
-  */
-  if (chords == 0) chords = 1;
-  neighbor_list = (short *)calloc(4*chords, sizeof(short));
-  assert(neighbor_list != NULL);
-  /*
-    list for Boltzmann-factors
-  */
-  bmf = (float *)calloc(2*chords, sizeof(double));
-  assert(bmf != NULL);
+  ctx->_RT = (((temperature + K0) * GASCONST) / 1000.0);
+  if (ctx->groups!=NULL) return;
+
+  /* one group per base (as 5' position of closing pair) and the exterior loop */
+  n = strlen(GAV.farbe_full) + 1;
+  ctx->num_groups = n;
+  ctx->groups = (nbGroup *)calloc(n, sizeof(nbGroup));
+  assert(ctx->groups != NULL);
+  for (ctx->tree_size = 1; ctx->tree_size < n; ctx->tree_size *= 2);
+  ctx->flux_tree = (double *)calloc(2*ctx->tree_size, sizeof(double));
+  assert(ctx->flux_tree != NULL);
+  ctx->dirty = (int *)calloc(n, sizeof(int));
+  assert(ctx->dirty != NULL);
+  ctx->is_dirty = (char *)calloc(n, sizeof(char));
+  assert(ctx->is_dirty != NULL);
+}
 
-  /* list of neighbor energies */
-  energies = (double*)calloc(2*chords, sizeof(double));
-  assert(energies != NULL);
-  
-  /* open log-file */
-  logFP = fopen(strcat(strcpy(logFN, GAV.BaseName), ".log"), "a+");
-  assert(logFP != NULL);
+/* remove all neighbours */
+void clear_nbList(SimContext *ctx) {
+  int g;
+
+  for (g = 0; g < ctx->num_groups; g++) {
+    ctx->groups[g].num = ctx->groups[g].neg = ctx->groups[g].zero = 0;
+    ctx->groups[g].sum_dE = 0;
+    ctx->is_dirty[g] = 0;
+  }
+  memset(ctx->flux_tree, 0, 2*ctx->tree_size*sizeof(double));
+  ctx->num_dirty = 0;
+  ctx->top = ctx->neg = ctx->zero = 0;
+  ctx->sum_dE = 0;
+  ctx->totalflux = 0.0;
+}
 
-  /* log initial condition */
-  log_prog_params(logFP);
-  log_start_stop(logFP);
+/* start (re-)generation of the neighbours of group g */
+void begin_nbGroup(SimContext *ctx, int g) {
+  nbGroup *G = ctx->groups + g;
+
+  ctx->top -= G->num;
+  ctx->neg -= G->neg;
+  ctx->zero -= G->zero;
+  ctx->sum_dE -= G->sum_dE;
+  G->num = G->neg = G->zero = 0;
+  G->sum_dE = 0;
+  ctx->cur_group = g;
 }
 
 /**/
-void update_nbList(int i, int j, int iE) {
-  double E, dE, p;
+void update_nbList(SimContext *ctx, int i, int j, int iE) {
+  double dE, p;
+  nbGroup *G = ctx->groups + ctx->cur_group;
+
+  if (G->num == G->size) {
+    G->size = (G->size == 0) ? 16 : 2*G->size;
+    G->moves = (short *)realloc(G->moves, 2*G->size*sizeof(short));
+    G->dE = (int *)realloc(G->dE, G->size*sizeof(int));
+    G->cum = (double *)realloc(G->cum, G->size*sizeof(double));
+    assert((G->moves != NULL) && (G->dE != NULL) && (G->cum != NULL));
+  }
+
+  G->moves[2*G->num] = (short )i;
+  G->moves[2*G->num+1] = (short )j;
+  G->dE[G->num] = iE - ctx->currE_int;
 
-  E = (double)iE/100.;
-  neighbor_list[2*top] = (short )i;
-  neighbor_list[2*top+1] = (short )j;
-  
   /* compute rates and some statistics */
-  /*    meanE += E; */
-  dE = E-GSV.currE;
+  dE = (double)G->dE[G->num]/100.;
 
-  /* laplace stuff */
-  energies[top] = E;
-  L += GSV.currE-E;
-  D++;
-  /* fprintf(stderr, ">>%g %g<<\n", L, D); */
-  
   if( GTV.mc ) {
     /* metropolis rule */
     if (dE < 0) p = 1;
-    else p = exp(-(dE / _RT*GSV.phi));
+    else p = exp(-(dE / ctx->_RT*GSV.phi));
   }
   else  /* kawasaki rule */
-    p = exp(-0.5 * (dE / _RT*GSV.phi));
+    p = exp(-0.5 * (dE / ctx->_RT*GSV.phi));
+
+  G->cum[G->num] = (G->num > 0) ? G->cum[G->num-1] + p : p;
+  if (G->dE[G->num] < 0) G->neg++;
+  if (G->dE[G->num] == 0) G->zero++;
+  G->sum_dE += G->dE[G->num];
+  G->num++;
+}
+
+/* finish (re-)generation of the current group */
+void end_nbGroup(SimContext *ctx) {
+  nbGroup *G = ctx->groups + ctx->cur_group;
+
+  ctx->top += G->num;
+  ctx->neg += G->neg;
+  ctx->zero += G->zero;
+  ctx->sum_dE += G->sum_dE;
+  update_flux_tree(ctx, ctx->cur_group);
+}
 
-  totalflux += p;
-  bmf[top++] = (float )p;
-  if (dE < 0) lmin = 0;
-  if ((dE == 0) && (lmin==1)) lmin = 2;
+/* group g has to be regenerated before the next move */
+void mark_nbGroup(SimContext *ctx, int g) {
+  if (ctx->is_dirty[g]) return;
+  ctx->is_dirty[g] = 1;
+  ctx->dirty[ctx->num_dirty++] = g;
 }
 
 /**/
-void get_from_cache(cache_entry *c) {
-  top = c->top;
-  totalflux = c->flux;
-  GSV.currE = c->energy;
-  lmin = c->lmin;
-  memcpy(neighbor_list, c->neighbors, 2*top*sizeof(short));
-  memcpy(bmf, c->rates, top*sizeof(float));
-  memcpy(energies, c->energies, top*sizeof(double));
-  is_from_cache = 1;
+static void update_flux_tree(SimContext *ctx, int g) {
+  int k;
+  nbGroup *G = ctx->groups + g;
+
+  k = ctx->tree_size + g;
+  ctx->flux_tree[k] = (G->num > 0) ? G->cum[G->num-1] : 0.0;
+  for (k /= 2; k > 0; k /= 2)
+    ctx->flux_tree[k] = ctx->flux_tree[2*k] + ctx->flux_tree[2*k+1];
+  ctx->totalflux = ctx->flux_tree[1];
 }
 
 /**/
-void put_in_cache(void) {
-  cache_entry *c;
+void get_from_cache(SimContext *ctx, cache_entry *c) {
+  int k, l, m, g;
+  nbGroup *G;
+
+  clear_nbList(ctx);
+  ctx->currE_int = c->energy;
+  ctx->currE = (float)c->energy/100.;
+
+  /* neighbours are stored group by group */
+  for (k = 0; k < c->top; k = l) {
+    g = c->groups[k];
+    for (l = k; (l < c->top) && (c->groups[l] == g); l++);
+    begin_nbGroup(ctx, g);
+    G = ctx->groups + g;
+    if (G->size < l-k) {
+      G->size = l-k;
+      G->moves = (short *)realloc(G->moves, 2*G->size*sizeof(short));
+      G->dE = (int *)realloc(G->dE, G->size*sizeof(int));
+      G->cum = (double *)realloc(G->cum, G->size*sizeof(double));
+      assert((G->moves != NULL) && (G->dE != NULL) && (G->cum != NULL));
+    }
+    G->num = l-k;
+    memcpy(G->moves, c->neighbors+2*k, 2*G->num*sizeof(short));
+    memcpy(G->dE, c->dE+k, G->num*sizeof(int));
+    memcpy(G->cum, c->cum+k, G->num*sizeof(double));
+    for (m = 0; m < G->num; m++) {
+      if (G->dE[m] < 0) G->neg++;
+      if (G->dE[m] == 0) G->zero++;
+      G->sum_dE += G->dE[m];
+    }
+    end_nbGroup(ctx);
+  }
 
-  if ((c = (cache_entry *) malloc(sizeof(cache_entry)))==NULL) {
-    fprintf(stderr, "out of memory\n"); exit(255);
+  ctx->nb_valid = 1;
+  ctx->nb_from_scratch = 0;
+}
+
+/**/
+static void put_in_cache(SimContext *ctx) {
+  cache_entry *c;
+  int g, i, k;
+  nbGroup *G;
+
+  if (GSV.cache_max == 0) return;
+
+  c = new_cache_entry(ctx->currform, ctx->top);
+  for (k = 0, g = 0; g < ctx->num_groups; g++) {
+    G = ctx->groups + g;
+    if (G->num == 0) continue;
+    memcpy(c->neighbors+2*k, G->moves, 2*G->num*sizeof(short));
+    memcpy(c->dE+k, G->dE, G->num*sizeof(int));
+    memcpy(c->cum+k, G->cum, G->num*sizeof(double));
+    for (i = 0; i < G->num; i++) c->groups[k++] = (short)g;
   }
-/*    c->structure = strdup(GAV.currform); */
-  c->structure = (char *) calloc(GSV.len+1, sizeof(char));
-  strcpy(c->structure, GAV.currform);
-  c->neighbors = (short *) malloc(top*2*sizeof(short));
-  memcpy(c->neighbors,neighbor_list,top*2*sizeof(short));
-  c->rates = (float *) malloc(top*sizeof(float));
-  memcpy(c->rates, bmf, top*sizeof(float));
-  c->energies = (double*)malloc(top*sizeof(double));
-  memcpy(c->energies, energies, top*sizeof(double));
-  c->top = top;
-  c->lmin = lmin;
-  c->flux = totalflux;
-  c->energy = GSV.currE;
-  write_cache(c);
+  c->energy = ctx->currE_int;
+  write_cache(ctx, c);
 }
 
 /*============*/
 
-int sel_nb(void) {
+int sel_nb(SimContext *ctx) {
 
   char trans, **s;
-  int next, i;
-  double pegel = 0.0, schwelle = 0.0, zufall = 0.0;
+  int next, g, k, l, r, mi = 0, mj = 0, mdE = 0;
+  double schwelle = 0.0, zufall = 0.0;
   int found_stop=0;
+  nbGroup *G;
 
   /* before we select a move, store current conformation in cache */
-  /* ... unless it just came from there */
-  if ( !is_from_cache ) put_in_cache();
-  else
-    /* laplace stuff */
-    for (i=0; i<top; i++) {
-      L += (GSV.currE - energies[i]);
-      D++;
-    }
-  is_from_cache = 0;
+  /* ... unless it did not have to be generated from scratch */
+  if ( ctx->nb_from_scratch ) put_in_cache(ctx);
+  ctx->nb_from_scratch = 0;
+
+  /* laplace stuff */
+  ctx->L += -(double)ctx->sum_dE/100.;
+  ctx->D += ctx->top;
+
+  /* local minimum: no downhill (0) or no neutral (2) neighbour */
+  ctx->lmin = (ctx->neg > 0) ? 0 : ((ctx->zero > 0) ? 2 : 1);
 
   /* draw 2 different a random number */
-  schwelle = urn();
-  while ( zufall==0 ) zufall = urn();
+  schwelle = sim_urn(ctx);
+  while ( zufall==0 ) zufall = sim_urn(ctx);
 
   /* advance internal clock */
-  if (totalflux>0)
-    zeitInc = (log(1. / zufall) / totalflux);
+  if (ctx->totalflux>0)
+    ctx->zeitInc = (log(1. / zufall) / ctx->totalflux);
   else {
-    if (GSV.grow>0) zeitInc=GSV.grow;
-    else zeitInc = GSV.time;
+    if (GSV.grow>0) ctx->zeitInc=GSV.grow;
+    else ctx->zeitInc = GSV.time;
   }
 
-  Zeit += zeitInc;
+  ctx->Zeit += ctx->zeitInc;
 
   /* laplace stuff */
-  sumK  += L*zeitInc;
-  sumKK += L*L*zeitInc;
-  sumD  += D*zeitInc;
+  ctx->sumK  += ctx->L*ctx->zeitInc;
+  ctx->sumKK += ctx->L*ctx->L*ctx->zeitInc;
+  ctx->sumD  += ctx->D*ctx->zeitInc;
   
-  if (GSV.grow>0 && GSV.len < strlen(GAV.farbe_full)) grow_chain();
-
-  /* meanE /= (double)top; */
-
-  /* normalize boltzmann weights */
-  schwelle *=totalflux;
-
-  /* and choose a neighbour structure next */
-  for (next = 0; next < top; next++) {
-    pegel += bmf[next];
-    if (pegel > schwelle) break;
+  next = 0;
+  if (GSV.grow>0 && ctx->len < strlen(GAV.farbe_full) && grow_chain(ctx))
+    next = -1;  /* prevent structure move */
+  else if (ctx->top == 0)
+    next = -1;  /* nothing to do */
+
+  if (next >= 0) {
+    /* normalize boltzmann weights */
+    schwelle *= ctx->totalflux;
+
+    /* descend the sum-tree to the group containing the move ... */
+    for (k = 1; k < ctx->tree_size; ) {
+      if ((schwelle < ctx->flux_tree[2*k]) || (ctx->flux_tree[2*k+1] <= 0.0))
+        k = 2*k;
+      else {
+        schwelle -= ctx->flux_tree[2*k];
+        k = 2*k+1;
+      }
+    }
+    g = k - ctx->tree_size;
+    /* in case of rounding errors */
+    while ((g >= ctx->num_groups) || (ctx->groups[g].num == 0)) g--;
+    G = ctx->groups + g;
+
+    /* ... and bisect its cumulative rates */
+    for (l = 0, r = G->num-1; l < r; ) {
+      k = (l+r)/2;
+      if (G->cum[k] > schwelle) r = k;
+      else l = k+1;
+    }
+    mi = G->moves[2*l];
+    mj = G->moves[2*l+1];
+    mdE = G->dE[l];
   }
 
-  /* in case of rounding errors */
-  if (next==top) next=top-1;
-
   /*
     process termination contitiones
   */
   /* is current structure identical to a stop structure ?*/
   for (found_stop = 0, s = GAV.stopform; *s; s++) {
-    if (strcmp(*s, GAV.currform) == 0) {
+    if (strcmp(*s, ctx->currform) == 0) {
       found_stop = (s - GAV.stopform) + 1;
       break;
     }
   }
 
   /* Recurrence time: Ignore when you observe the start structure for the first time. */
-  if ((found_stop > 0) && (GTV.rect == 1) && (strcmp(GAV.startform, GAV.currform) == 0)) {
-    GTV.rect = 0; found_stop = 0;
+  if ((found_stop > 0) && (ctx->rect == 1) && (strcmp(ctx->startform, ctx->currform) == 0)) {
+    ctx->rect = 0; found_stop = 0;
   }
 
-  if ( ((found_stop > 0) && (GTV.fpt == 1)) || (Zeit > GSV.time) ) {
+  if ( ((found_stop > 0) && (GTV.fpt == 1)) || (ctx->Zeit > GSV.time) ) {
     /* met condition to stop simulation */
 
     /* laplace stuff */
     double K, KK, N, sigma;
-    K = sumK/Zeit;
-    KK = sumKK/Zeit;
-    N = sumD/Zeit;
+    K = ctx->sumK/ctx->Zeit;
+    KK = ctx->sumKK/ctx->Zeit;
+    N = ctx->sumD/ctx->Zeit;
     /* graph Laplacian is - Laplace-Beltrami operator */
     sigma = -1.0*sqrt((KK-K*K)/N)/(K/N);
     
     /* this goes to stdout */
     if ( !GTV.silent ) {
-      printf("%s  %6.2f %10.3f", costring(GAV.currform), GSV.currE, Zeit);
+      sim_printf(ctx, "%s  %6.2f %10.3f", sim_costring(ctx, ctx->currform), ctx->currE, ctx->Zeit);
 
       /* laplace stuff*/
-      if (GTV.phi) printf(" %8.3f %8.3f %3g", zeitInc, L, D); 
+      if (GTV.phi) sim_printf(ctx, " %8.3f %8.3f %3g", ctx->zeitInc, ctx->L, ctx->D); 
 
-      if (GTV.verbose) printf(" %4d _ %d", top, lmin);
-      if (found_stop) printf(" X%d\n", found_stop);/* found a stop structure */
-      else printf(" O\n"); /* time for simulation is exceeded */
+      if (GTV.verbose) sim_printf(ctx, " %4d _ %d", ctx->top, ctx->lmin);
+      if (found_stop) sim_printf(ctx, " X%d\n", found_stop);/* found a stop structure */
+      else sim_printf(ctx, " O\n"); /* time for simulation is exceeded */
 
       /* laplace stuff */
-      if (GTV.phi) printf("Curvature fluctuation sigma = %7.5f\n", sigma);
+      if (GTV.phi) sim_printf(ctx, "Curvature fluctuation sigma = %7.5f\n", sigma);
 
-      fflush(stdout);
     }
 
     /* this goes to log */
-    fprintf(logFP, "(%5hu %5hu %5hu)", GAV.subi[0], GAV.subi[1], GAV.subi[2]);
+    sim_log(ctx, "(%5hu %5hu %5hu)", ctx->subi[0], ctx->subi[1], ctx->subi[2]);
     /* comment log steps of simulation as well !!! %6.2f  round */
     if ( found_stop ) {
-      fprintf(logFP," X%02d %12.3f", found_stop, Zeit);
+      sim_log(ctx, " X%02d %12.3f", found_stop, ctx->Zeit);
 
       /* laplace stuff */
-      if (GTV.phi) fprintf(logFP, " %3g %7.5f", GSV.phi, sigma);
+      if (GTV.phi) sim_log(ctx, " %3g %7.5f", GSV.phi, sigma);
 
-      fprintf(logFP,"\n");
+      sim_log(ctx, "\n");
     }
     else {
-      fprintf(logFP," O   %12.3f", Zeit);
+      sim_log(ctx, " O   %12.3f", ctx->Zeit);
 
       /* laplace stuff */
-      if (GTV.phi) fprintf(logFP, " %3g %7.5f", GSV.phi, sigma);      
+      if (GTV.phi) sim_log(ctx, " %3g %7.5f", GSV.phi, sigma);      
 
-      fprintf(logFP," %d %s\n", lmin, costring(GAV.currform));
+      sim_log(ctx, " %d %s\n", ctx->lmin, sim_costring(ctx, ctx->currform));
     }
-    fflush(logFP);
 
-    /* set random number for next round */
-    GAV.subi[0] = xsubi[0];
-    GAV.subi[1] = xsubi[1];
-    GAV.subi[2] = xsubi[2];
-    
-    Zeit = 0.0;
+    /* remember outcome of this trajectory */
+    ctx->found_stop = found_stop;
+    ctx->fpt = ctx->Zeit;
+
+    ctx->Zeit = 0.0;
 
     /* reset laplace stuff for next trajectory */
-    sumT = 0.0;
-    sumK = 0.0;
-    sumKK = 0.0;
-    sumD = 0.0;
-    L = 0.0;
-    D = 0.0;
+    ctx->sumT = 0.0;
+    ctx->sumK = 0.0;
+    ctx->sumKK = 0.0;
+    ctx->sumD = 0.0;
+    ctx->L = 0.0;
+    ctx->D = 0.0;
     
     /*  highestE = OhighestE = -1000.0; */
-    reset_nbList();
-    costring(NULL);
+    ctx->nb_valid = 0;
     return(1);
   }
   else {
     /* continue simulation */
     int flag = 0;
-    if( (!GTV.silent) && (GSV.currE <= GSV.stopE+GSV.cut) ) {
+    if( (!GTV.silent) && (ctx->currE <= GSV.stopE+GSV.cut) ) {
 
-      if (!GTV.lmin || (lmin==1 && strcmp(GAV.prevform, GAV.currform) != 0)) {
+      if (!GTV.lmin || (ctx->lmin==1 && strcmp(ctx->prevform, ctx->currform) != 0)) {
 	char format[64];
 	flag = 1;
 	sprintf(format, "%%-%ds %%6.2f %%10.3f", strlen(GAV.farbe_full)+1);
-	printf(format, costring(GAV.currform), GSV.currE, Zeit);
+	sim_printf(ctx, format, sim_costring(ctx, ctx->currform), ctx->currE, ctx->Zeit);
       }
 
       /* laplace stuff */
       if (GTV.phi) {
-	printf(" %8.3f %8.3f %3g", zeitInc, L, D);
-	L = D = 0.0; /* reset L and D for next structure */
+	sim_printf(ctx, " %8.3f %8.3f %3g", ctx->zeitInc, ctx->L, ctx->D);
+	ctx->L = ctx->D = 0.0; /* reset L and D for next structure */
       }
 
       if ( flag && GTV.verbose ) {
 	int ii, jj;
 	if (next<0) trans='g'; /* growth */
 	else {
-	  ii = neighbor_list[2*next];
-	  jj = neighbor_list[2*next+1];
-	  if (abs(ii) < GSV.len) {
+	  ii = mi;
+	  jj = mj;
+	  if (abs(ii) < ctx->len) {
 	    if ((ii > 0) && (jj > 0)) trans = 'i';
 	    else if ((ii < 0) && (jj < 0)) trans = 'd';
 	    else if ((ii > 0) && (jj < 0)) trans = 's';
@@ -341,120 +420,97 @@ int sel_nb(void) {
 	    else trans = 'D';
 	  }
 	}
-	printf(" %4d %c %d", top, trans, lmin);
+	sim_printf(ctx, " %4d %c %d", ctx->top, trans, ctx->lmin);
       }
-      if (flag) printf("\n");
+      if (flag) sim_printf(ctx, "\n");
     }
   }
 
 
   /* store last lmin seen, so we can avoid printing the same lmin twice */
-  if (lmin==1)
-    strcpy(GAV.prevform, GAV.currform);
+  if (ctx->lmin==1)
+    strcpy(ctx->prevform, ctx->currform);
 
 #if 0
-  if (lmin==1) {
+  if (ctx->lmin==1) {
     /* went back to previous lmin */
-    if (strcmp(GAV.prevform, GAV.currform) == 0) {
+    if (strcmp(ctx->prevform, ctx->currform) == 0) {
       if (OhighestE < highestE) {
 	highestE = OhighestE;  /* delete loop */
 	strcpy(highestS, OhighestS);
       }
     } else {
-      strcpy(GAV.prevform, GAV.currform);
+      strcpy(ctx->prevform, ctx->currform);
       OhighestE = 10000.;
     }
   }
 
-  if ( strcmp(GAV.currform, GAV.startform)==0 ) {
+  if ( strcmp(ctx->currform, ctx->startform)==0 ) {
     OhighestE = highestE = -1000.;
     highestS[0] = 0;
   }
 
   /* log highes energy */
-  if (GSV.currE > highestE) {
+  if (ctx->currE > highestE) {
     OhighestE = highestE;
-    highestE = GSV.currE;
+    highestE = ctx->currE;
     strcpy(OhighestS, highestS);
-    strcpy(highestS, GAV.currform);
+    strcpy(highestS, ctx->currform);
   }
 #endif
 
-  if (next>=0) update_tree(neighbor_list[2*next], neighbor_list[2*next+1]);
+  if (next>=0) {
+    ctx->currE_int += mdE;
+    ctx->currE = (float)ctx->currE_int/100.;
+    update_tree(ctx, mi, mj);
+  }
   else {
-    clean_up_rl(); ini_or_reset_rl();
+    clean_up_rl(ctx); ini_or_reset_rl(ctx);
   }
 
-  reset_nbList();
   return(0);
 }
 
-/*==========================*/
-static void reset_nbList(void) {
-
-  top = 0;
-  totalflux = 0.0;
-  /*    meanE = 0.0; */
-  lmin = 1;
-}
-
 /*======================*/
-void clean_up_nbList(void){
-
-  free(neighbor_list);
-  free(bmf);
-  free(energies);
-  fprintf(logFP,"\n");
-  fclose(logFP);
+void clean_up_nbList(SimContext *ctx){
+  int g;
+
+  if (ctx->groups == NULL) return;
+  for (g = 0; g < ctx->num_groups; g++) {
+    free(ctx->groups[g].moves);
+    free(ctx->groups[g].dE);
+    free(ctx->groups[g].cum);
+  }
+  free(ctx->groups);
+  free(ctx->flux_tree);
+  free(ctx->dirty);
+  free(ctx->is_dirty);
+  ctx->groups = NULL;
+  ctx->flux_tree = NULL;
+  ctx->dirty = NULL;
+  ctx->is_dirty = NULL;
+  ctx->num_groups = 0;
 }
 
 /*======================*/
-static void grow_chain(void){
+static int grow_chain(SimContext *ctx){
   int newl;
   /* note Zeit=0 corresponds to chain length GSV.glen */
-  if (Zeit<(GSV.len+1-GSV.glen) * GSV.grow) return;
-  newl = GSV.len+1;
-  Zeit = (newl-GSV.glen) * GSV.grow;
-  top=0; /* prevent structure move in sel_nb */
-
-  if (GSV.len<newl) {
-    strncpy(GAV.farbe, GAV.farbe_full, newl);
-    GAV.farbe[newl] = '\0';
-    strcpy(GAV.startform, GAV.currform);
-    strcat(GAV.startform, ".");
-
-    GSV.len = newl;
+  if (ctx->Zeit<(ctx->len+1-GSV.glen) * GSV.grow) return 0;
+  newl = ctx->len+1;
+  ctx->Zeit = (newl-GSV.glen) * GSV.grow;
+
+  if (ctx->len<newl) {
+    strncpy(ctx->farbe, GAV.farbe_full, newl);
+    ctx->farbe[newl] = '\0';
+    strcpy(ctx->startform, ctx->currform);
+    strcat(ctx->startform, ".");
+
+    ctx->len = newl;
 #if HAVE_LIBRNA_API3
-    /* fake actual length of sequence in GAV.vc */
-    GAV.vc->length = newl;
+    /* fake actual length of sequence in ctx->vc (not shared when the chain grows) */
+    ctx->vc->length = newl;
 #endif
   }
-}
-
-static const char *costring(const char *str) {
-  static char* buffer=NULL;
-  static int size=0;
-  int n;
-  if (str==NULL) {
-    if (buffer) {
-      /* make it possible to free buffer */
-      free(buffer);
-      size = 0; buffer = NULL;
-    }
-    return NULL;
-  }
-  n=strlen(str);
-  if (n>=size) {
-    size = n+2;
-    buffer = realloc(buffer, size);
-  }
-  if ((cut_point>0)&&(cut_point<=n)) {
-    strncpy(buffer, str, cut_point-1);
-    buffer[cut_point-1] = '&';
-    strncpy(buffer+cut_point, str+cut_point-1, n-cut_point+1);
-    buffer[n+1] = '\0';
-  } else {
-    strncpy(buffer, str, n+1);
-  }
-  return buffer;
+  return 1;
 }
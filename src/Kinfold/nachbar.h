@@ -9,13 +9,18 @@
 #ifndef NACHBAR_H
 #define NACHBAR_H
 
+#include "simulation.h"
+
 /* used in baum.c */
-extern void ini_nbList(int chords);
-extern void update_nbList(int i,int j, int iE);
+extern void ini_nbList(SimContext *ctx);
+extern void clear_nbList(SimContext *ctx);
+extern void begin_nbGroup(SimContext *ctx, int g);
+extern void update_nbList(SimContext *ctx, int i,int j, int iE);
+extern void end_nbGroup(SimContext *ctx);
+extern void mark_nbGroup(SimContext *ctx, int g);
 
 /* used in main.c */
-extern int sel_nb(void);
-extern void clean_up_nbList(void);
-
-extern void grow_chain(void);
+extern int sel_nb(SimContext *ctx);
+extern void get_from_cache(SimContext *ctx, cache_entry *c);
+extern void clean_up_nbList(SimContext *ctx);
 #endif
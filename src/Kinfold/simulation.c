@@ -0,0 +1,203 @@
+/*
+  c  Christoph Flamm and Ivo L Hofacker
+  {xtof,ivo}@tbi.univie.ac.at
+  Kinfold: $Name:  $
+*/
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+
+#if HAVE_LIBRNA_API3
+#include <ViennaRNA/fold_vars.h> /* contains global variable cut_point */
+#include <ViennaRNA/utils.h>
+#include <ViennaRNA/string_utils.h>
+#else
+#include <fold_vars.h>
+#include <utils.h>
+#endif
+
+#include "globals.h"
+#include "simulation.h"
+#include "cache_util.h"
+#include "baum.h"
+#include "nachbar.h"
+
+extern double erand48(unsigned short[3]);
+extern long nrand48(unsigned short[3]);
+
+/**/
+SimContext *ini_sim_context(void) {
+  SimContext *ctx;
+  int n;
+
+  n = strlen(GAV.farbe_full);
+  ctx = (SimContext *)calloc(1, sizeof(SimContext));
+  assert(ctx != NULL);
+  ctx->farbe = (char *)calloc(n+1, sizeof(char));
+  assert(ctx->farbe != NULL);
+  ctx->startform = (char *)calloc(n+1, sizeof(char));
+  assert(ctx->startform != NULL);
+  ctx->currform = (char *)calloc(n+1, sizeof(char));
+  assert(ctx->currform != NULL);
+  ctx->prevform = (char *)calloc(n+1, sizeof(char));
+  assert(ctx->prevform != NULL);
+  ctx->lmin = 1;
+  ctx->_RT = 0.6;
+
+#if HAVE_LIBRNA_API3
+  if (GSV.grow > 0) {
+    /*
+      chain growth fakes the sequence length in the fold compound,
+      so every simulation needs a private one
+    */
+    char *tmp = vrna_cut_point_insert(GAV.farbe_full, cut_point);
+    ctx->vc = vrna_fold_compound(tmp, &(GAV.md), VRNA_OPTION_EVAL_ONLY);
+    ctx->own_vc = 1;
+    free(tmp);
+  }
+  else {
+    ctx->vc = GAV.vc;
+    ctx->own_vc = 0;
+  }
+#endif
+
+  initialize_cache(ctx, GSV.cache_max);
+
+  return ctx;
+}
+
+/* prepare context for trajectory num starting with random seed seed */
+void reset_sim_context(SimContext *ctx, int num, const unsigned short seed[3]) {
+  int i, n;
+
+  ctx->num = num;
+  for (i = 0; i < 3; i++)
+    ctx->subi[i] = ctx->xsubi[i] = seed[i];
+
+  /* recurrence time toggle is consumed by every trajectory */
+  ctx->rect = GTV.rect;
+  ctx->found_stop = 0;
+  ctx->fpt = 0.0;
+
+  n = strlen(GAV.farbe_full);
+  strcpy(ctx->farbe, GAV.farbe_full);
+  strcpy(ctx->startform, GAV.startform);
+
+  if ((GSV.grow > 0) && (n > GSV.glen)) {
+    /* growing chain starts over with its initial length */
+    if (ctx->wurzl != NULL) clean_up_rl(ctx);
+    n = GSV.glen;
+    ctx->farbe[n] = '\0';
+    ctx->startform[n] = '\0';
+#if HAVE_LIBRNA_API3
+    ctx->vc->length = n;
+#endif
+  }
+
+  ctx->len = n;
+
+  /*
+    initialize or reset ringlist to start conditions
+  */
+  ini_or_reset_rl(ctx);
+}
+
+/**/
+void free_sim_context(SimContext *ctx) {
+  if (ctx == NULL) return;
+
+  if (ctx->wurzl != NULL) clean_up_rl(ctx);
+  clean_up_nbList(ctx);
+  kill_cache(ctx);
+
+#if HAVE_LIBRNA_API3
+  if (ctx->own_vc) vrna_fold_compound_free(ctx->vc);
+  if (ctx->out) vrna_cstr_free(ctx->out);
+  if (ctx->log) vrna_cstr_free(ctx->log);
+#endif
+
+  free(ctx->farbe);
+  free(ctx->startform);
+  free(ctx->currform);
+  free(ctx->prevform);
+  free(ctx->cobuf);
+  free(ctx);
+}
+
+/*
+  derive the seed of the next trajectory from the seed of the previous one.
+  trajectories therefore do not depend on each other's random numbers and
+  can be simulated in any order
+*/
+void next_seed(unsigned short seed[3]) {
+  unsigned short state[3];
+  int i;
+
+  memcpy(state, seed, 3*sizeof(unsigned short));
+  for (i = 0; i < 3; i++)
+    seed[i] = (unsigned short)(nrand48(state) >> 15);
+}
+
+/* uniform random number in [0,1) from the trajectory's own generator */
+double sim_urn(SimContext *ctx) {
+  return erand48(ctx->xsubi);
+}
+
+/* this goes to stdout */
+void sim_printf(SimContext *ctx, const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+#if HAVE_LIBRNA_API3
+  if (ctx->out) {
+    vrna_cstr_vprintf(ctx->out, format, args);
+    va_end(args);
+    return;
+  }
+#endif
+  vprintf(format, args);
+  va_end(args);
+}
+
+/* this goes to log */
+void sim_log(SimContext *ctx, const char *format, ...) {
+  va_list args;
+
+  va_start(args, format);
+#if HAVE_LIBRNA_API3
+  if (ctx->log) {
+    vrna_cstr_vprintf(ctx->log, format, args);
+    va_end(args);
+    return;
+  }
+#endif
+  vfprintf(GAV.logFP, format, args);
+  va_end(args);
+}
+
+/* insert cut point ('&') into structure str for output */
+const char *sim_costring(SimContext *ctx, const char *str) {
+  int n;
+
+  n=strlen(str);
+  if (n>=ctx->cobuf_size) {
+    ctx->cobuf_size = n+2;
+    ctx->cobuf = realloc(ctx->cobuf, ctx->cobuf_size);
+    assert(ctx->cobuf != NULL);
+  }
+  if ((cut_point>0)&&(cut_point<=n)) {
+    strncpy(ctx->cobuf, str, cut_point-1);
+    ctx->cobuf[cut_point-1] = '&';
+    strncpy(ctx->cobuf+cut_point, str+cut_point-1, n-cut_point+1);
+    ctx->cobuf[n+1] = '\0';
+  } else {
+    strncpy(ctx->cobuf, str, n+1);
+  }
+  return ctx->cobuf;
+}
+
+/* End of file */
@@ -0,0 +1,122 @@
+/*
+  c  Christoph Flamm and Ivo L Hofacker
+  {xtof,ivo}@tbi.univie.ac.at
+  Kinfold: $Name:  $
+*/
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdio.h>
+
+#include "globals.h"
+#include "cache_util.h"
+
+#if HAVE_LIBRNA_API3
+#include <ViennaRNA/datastructures/char_stream.h>
+#endif
+
+/*
+  neighbours of the current structure that are generated from the
+  loop closed by a particular base pair, i.e. insertions into the loop,
+  and deletion and shifts of the closing pair (see nachbar.c)
+*/
+typedef struct _nbGroup {
+  int num;                  /* number of neighbours */
+  int size;                 /* number of allocated neighbours */
+  short *moves;             /* move coding, two entries per neighbour */
+  int *dE;                  /* energy change of move in dcal/mol */
+  double *cum;              /* cumulative rates of moves */
+  int neg;                  /* number of downhill moves */
+  int zero;                 /* number of neutral moves */
+  long sum_dE;
+} nbGroup;
+
+/*
+  state of a single simulation, i.e. everything that changes
+  while a trajectory is computed. GSV, GAV, and GTV only hold
+  the settings and data shared (read-only) by all trajectories
+*/
+typedef struct _SimContext {
+  int num;                  /* number of current trajectory */
+  int len;                  /* current length of sequence (chain growth) */
+  int steps;
+  int rect;                 /* recurrence time toggle of current trajectory */
+  float startE;
+  float currE;
+  char *farbe;              /* current sequence (chain growth) */
+  char *startform;          /* start structure */
+  char *currform;           /* current structure */
+  char *prevform;           /* current structure of previous time step */
+  unsigned short subi[3];   /* seed of current trajectory */
+  unsigned short xsubi[3];  /* state of random-number-generator */
+
+#if HAVE_LIBRNA_API3
+  vrna_fold_compound_t *vc; /* shared with GAV.vc unless the chain grows */
+  int own_vc;
+#endif
+
+  /* ringlist-tree (baum.c) */
+  short *pairList;
+  short *typeList;
+  short *aliasList;
+  char **ptype;
+  struct _baum *rl;         /* ringlist */
+  struct _baum *wurzl;      /* virtualroot of ringlist-tree */
+
+  /* neighbourhood (nachbar.c) */
+  nbGroup *groups;          /* neighbours by closing pair, exterior loop last */
+  int num_groups;
+  double *flux_tree;        /* sum-tree of the rates of all groups */
+  int tree_size;            /* number of leaves of flux_tree */
+  int *dirty;               /* groups invalidated by the last move */
+  char *is_dirty;
+  int num_dirty;
+  int nb_valid;             /* neighbourhood can be updated incrementally */
+  int nb_from_scratch;      /* neighbourhood was generated from scratch */
+  int cur_group;
+  int currE_int;            /* energy of current structure in dcal/mol */
+  int lmin;
+  int top;
+  int neg;
+  int zero;
+  long sum_dE;
+  double totalflux;
+  double Zeit;
+  double zeitInc;
+  double _RT;
+  double L;                 /* laplace stuff */
+  double D;
+  double sumT;
+  double sumK;
+  double sumKK;
+  double sumD;
+
+  /* neighbourhood cache (cache.c) */
+  cache_table *cache;
+
+  /* output of current trajectory */
+#if HAVE_LIBRNA_API3
+  vrna_cstr_t out;
+  vrna_cstr_t log;
+#endif
+  char *cobuf;              /* buffer for costring() */
+  int cobuf_size;
+
+  /* result of current trajectory */
+  int found_stop;           /* number of stop structure reached, 0 otherwise */
+  double fpt;               /* simulation time at end of trajectory */
+} SimContext;
+
+SimContext *ini_sim_context(void);
+void reset_sim_context(SimContext *ctx, int num, const unsigned short seed[3]);
+void free_sim_context(SimContext *ctx);
+void next_seed(unsigned short seed[3]);
+double sim_urn(SimContext *ctx);
+void sim_printf(SimContext *ctx, const char *format, ...);
+void sim_log(SimContext *ctx, const char *format, ...);
+const char *sim_costring(SimContext *ctx, const char *str);
+
+#endif
+
+/* End of file */
@@ -15,6 +15,7 @@ bool compare_vect (const Structure &lhs, const Structure &rhs);
 // flood the structure - return one below saddle structure (should be freed then) energy of saddle is in "saddle_en"
   // minh_total - if set to true then flood also down and try to find energetically lower LM
   // maxh = height of flood (0 = infinity)
+  // reentrant: every call floods with a context of its own, so different minima can be flooded in parallel
   // if returns NULL - in saddle_en is fail status - 1 for maxh reached, 0 otherwise
 struct_en* flood(const struct_en &str, SeqInfo &sqi, int &saddle_en, int maxh = 0, bool pknots = false, bool minh_total = false);
 
@@ -7,6 +7,10 @@
 
 #include <stack>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 extern "C" {
   #include "pair_mat.h"
   #include "fold.h"
@@ -106,6 +110,11 @@ int Options::Init(gengetopt_args_info &args_info)
     ret = -1;
   }
 
+  if (args_info.jobs_arg<0) {
+    fprintf(stderr, "Number of jobs should be non-negative number\n");
+    ret = -1;
+  }
+
   if (ret ==-1) return -1;
 
   // adjust options
@@ -120,6 +129,18 @@ int Options::Init(gengetopt_args_info &args_info)
   pknots = args_info.pseudoknots_flag;
   neighs = args_info.neighborhood_flag;
 
+  // threads
+#ifdef _OPENMP
+  jobs = (args_info.jobs_arg == 0 ? omp_get_num_procs() : args_info.jobs_arg);
+#else
+  jobs = 1;
+#endif
+  // pseudoknot energies, neighborhood routines, and random walks keep global state
+  if (jobs>1 && (pknots || neighs || rand)) {
+    fprintf(stderr, "WARNING: --jobs cannot be combined with -k, -N, or -w R, using a single thread\n");
+    jobs = 1;
+  }
+
   return ret;
 }
 
@@ -42,6 +42,7 @@ public:
   bool neighs;  // use neighborhood routines?
 
   bool pknots; // flag for pseudoknots.
+  int jobs;     // number of threads for gradient walks, flooding, and findpath
 
 public:
   Options();
@@ -34,6 +34,7 @@ extern "C" {
 #include "neighbourhood.h"
 
 #include "barrier_tree.h"
+#include "saddle_cache.h"
 
 using namespace std;
 
@@ -104,7 +105,8 @@ struct barr_info { // info taken from barriers
 
 // functions that are down in file ;-)
 char *read_seq(char *seq_arg, char **name_out);
-int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, set<struct_en, comps_entries> &output_shallow, SeqInfo &sqi, bool pure_output);
+int read_structure(struct_en &str, SeqInfo &sqi);
+int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, SeqInfo &sqi, bool pure_output, int jobs, int &count, int find_num, int &not_canonical, clock_t clck1);
 char *read_previous(char *previous, map<struct_en, int, comps_entries> &output);
 char *read_barr(char *previous, map<struct_en, barr_info, comps_entries> &output);
 
@@ -210,20 +212,13 @@ int main(int argc, char **argv)
     // if direct output:
     if (args_info.just_output_flag) printf("%s\n", seq);
 
-    // hash
-    unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> structs (HASHSIZE); // structures to minima map
+    // hash (grows with the number of distinct input structures)
+    unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> structs; // structures to minima map
     while ((!args_info.find_num_given || count != args_info.find_num_arg) && !args_info.just_read_flag) {
-      int res = move(structs, output, output_shallow, sqi, args_info.just_output_flag);
-
-      // print out
-      //if (Opt.verbose_lvl>0 && num_moves%10000==0) fprintf(stderr, "processed %d, minima %d, time %f secs.\n", num_moves, count, (clock()-clck1)/(double)CLOCKS_PER_SEC);
-      if (Opt.verbose_lvl>0 && num_moves%(Opt.pknots?1000:10000)==0 && num_moves!=0) fprintf(stderr, "processed %d, minima %d, time %f secs.\n", num_moves, (int)output.size(), (clock()-clck1)/(double)CLOCKS_PER_SEC);
+      int res = move(structs, output, sqi, args_info.just_output_flag, Opt.jobs, count, args_info.find_num_given ? args_info.find_num_arg : -1, not_canonical, clck1);
 
       // evaluate results
-      if (res==0)   continue; // same structure has been processed already
       if (res==-1)  break; // error or end
-      if (res==-2)  not_canonical++;
-      if (res==1)   count=output.size();
     }
 
     if (args_info.just_output_flag) {
@@ -379,18 +374,47 @@ int main(int argc, char **argv)
         nodes[i].saddle_height = 1e10;
       }
 
+      // saddle cache
+      std::unique_ptr<SaddleCache> saddle_cache;
+      if (args_info.saddle_cache_given) {
+        // everything the findpath saddles depend on (the model details reflect the global energy model settings)
+        model_detailsT md;
+        set_model_details(&md);
+        char settings[512];
+        snprintf(settings, sizeof(settings), " depth=%d k=%d noLP=%d T=%.2f d=%d noGU=%d noGUclosure=%d special_hp=%d logML=%d circ=%d gquad=%d energy_set=%d max_bp_span=%d min_loop_size=%d salt=%g saltDPXInit=%d ns=%s P=",
+                 args_info.depth_arg, (int)args_info.pseudoknots_flag, (int)args_info.noLP_flag,
+                 md.temperature, md.dangles, md.noGU, md.noGUclosure, md.special_hp, md.logML, md.circ, md.gquad,
+                 md.energy_set, md.max_bp_span, md.min_loop_size, md.salt, md.saltDPXInit, md.nonstandards);
+        saddle_cache.reset(new SaddleCache(string(seq) + settings + (args_info.paramFile_given ? args_info.paramFile_arg : "-")));
+        int loaded = saddle_cache->Load(args_info.saddle_cache_arg);
+        if (args_info.verbose_lvl_arg>0) fprintf(stderr, "Saddle cache: %d saddles read from %s\n", loaded, args_info.saddle_cache_arg);
+      }
+
       int flooded = 0;
       // init union-findset
       init_union(num);
       // first try to flood the highest bins
+      // floods (and walks down from their exits) do not depend on each other, so do them all at once
+      vector<struct_en*> flooded_to(num, (struct_en*)NULL);
+      vector<int> saddles(num, 0);
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.jobs) if(Opt.jobs > 1)
       for (int i=num-1; i>=0; i--) {
         // flood only if low number of walks ended there
+        if (output_num[i]<=threshold && Opt.floodMax>0) {
+          flooded_to[i] = flood(output_he[i], sqi, saddles[i], Opt.minh, args_info.pseudoknots_flag);
+          // if flood succesfull - walk down to find father minima
+          if (flooded_to[i]) move_set(*flooded_to[i], sqi);
+        }
+      }
+
+      // then join the basins in the same order as before
+      for (int i=num-1; i>=0; i--) {
         if (output_num[i]<=threshold && Opt.floodMax>0) {
           //copy_arr(Enc.pt, output_he[i].structure);
           if (args_info.verbose_lvl_arg>2) fprintf(stderr,   "flooding  (%3d): %s %.2f\n", i+1, output_str[i].c_str(), output_he[i].energy/100.0);
 
-          int saddle;
-          struct_en *he = flood(output_he[i], sqi, saddle, Opt.minh, args_info.pseudoknots_flag);
+          int saddle = saddles[i];
+          struct_en *he = flooded_to[i];
 
           // print info
           if (args_info.verbose_lvl_arg>1) {
@@ -404,11 +428,8 @@ int main(int argc, char **argv)
                       output_str[i].c_str(), output_he[i].energy/100.0);
             }
           }
-          // if flood succesfull - walk down to find father minima
+          // if flood succesfull - find father minima (already walked down)
           if (he) {
-            // walk down
-            move_set(*he, sqi);
-
             // now check if we have the minimum already (hopefuly yes ;-) )
             vector<struct_en>::iterator it;
             it = lower_bound(output_he.begin(), output_he.end(), *he, compf_entries2);
@@ -454,18 +475,51 @@ int main(int argc, char **argv)
       }
 
       // findpath:
+      // saddles known from previous runs are taken from the cache, the rest is computed at once
+      vector<pair<int, int> > pairs;
+      vector<int> pair_saddle;
+      vector<int> to_compute;
       for (set<int>::iterator it=to_findpath.begin(); it!=to_findpath.end(); it++) {
         set<int>::iterator it2=it;
         it2++;
         for (; it2!=to_findpath.end(); it2++) {
-          if (args_info.pseudoknots_flag) energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle_pk(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          else energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          findpath_barr[(*it2)*num+(*it)] = findpath_barr[(*it)*num+(*it2)] = true;
-          if (args_info.verbose_lvl_arg>0 && findpath %10000==0){
-            fprintf(stderr, "Findpath:%7d/%7d\n", findpath, (int)(to_findpath.size()*(to_findpath.size()-1)/2));
+          int saddle;
+          if (!saddle_cache || !saddle_cache->Get(output_str[*it], output_str[*it2], saddle)) {
+            saddle = INT_MAX;
+            to_compute.push_back(pairs.size());
           }
-          findpath++;
+          pairs.push_back(make_pair(*it, *it2));
+          pair_saddle.push_back(saddle);
+        }
+      }
+
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.jobs) if(Opt.jobs > 1)
+      for (int k=0; k<(int)to_compute.size(); k++) {
+        int p = to_compute[k];
+        const char *s1 = output_str[pairs[p].first].c_str();
+        const char *s2 = output_str[pairs[p].second].c_str();
+        if (args_info.pseudoknots_flag) pair_saddle[p] = find_saddle_pk(seq, s1, s2, args_info.depth_arg);
+        else pair_saddle[p] = find_saddle(seq, s1, s2, args_info.depth_arg);
+      }
+
+      for (int p=0; p<(int)pairs.size(); p++) {
+        int a = pairs[p].first;
+        int b = pairs[p].second;
+        energy_barr[b*num+a] = energy_barr[a*num+b] = pair_saddle[p]/100.0;
+        findpath_barr[b*num+a] = findpath_barr[a*num+b] = true;
+        if (args_info.verbose_lvl_arg>0 && findpath %10000==0){
+          fprintf(stderr, "Findpath:%7d/%7d\n", findpath, (int)(to_findpath.size()*(to_findpath.size()-1)/2));
         }
+        findpath++;
+      }
+
+      if (saddle_cache) {
+        for (int k=0; k<(int)to_compute.size(); k++) {
+          int p = to_compute[k];
+          saddle_cache->Put(output_str[pairs[p].first], output_str[pairs[p].second], pair_saddle[p]);
+        }
+        if (args_info.verbose_lvl_arg>0) fprintf(stderr, "Saddle cache: %d of %d saddles reused\n", (int)(pairs.size()-to_compute.size()), (int)pairs.size());
+        if (!saddle_cache->Save(args_info.saddle_cache_arg)) fprintf(stderr, "WARNING: cannot write saddle cache %s\n", args_info.saddle_cache_arg);
       }
 
       // debug output
@@ -834,7 +888,8 @@ char *read_seq(char *seq_arg, char **name_out)
 }
 
 
-int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, set<struct_en, comps_entries> &output_shallow, SeqInfo &sqi, bool pure_output)
+// reads a structure from stdin, returns -1 at the end of input, 0 if the line has to be skipped, 1 otherwise
+int read_structure(struct_en &str, SeqInfo &sqi)
 {
   // read a line
   char *line = my_getline(stdin);
@@ -893,97 +948,172 @@ int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<
   }
 
   // make make_pair
-  struct_en str;
   str.structure = Opt.pknots? make_pair_table_PK(p):make_pair_table(p);
+  free(line);
 
   // only H,K,L,M types allowed:
-  if (!str.structure) {
-    free(line);
-    return 0;
-  } else {
-    str.energy = Opt.pknots? energy_of_struct_pk(sqi.seq, str.structure, sqi.s0, sqi.s1, Opt.verbose_lvl>3):energy_of_structure_pt(sqi.seq, str.structure, sqi.s0, sqi.s1, 0);
-    free(line);
+  if (!str.structure) return 0;
+
+  return 1;
+}
+
+// one input structure and the local minimum it descends to
+struct walk_item {
+  struct_en str;  // input structure
+  struct_en lm;   // local minimum
+  int num;        // number of the input structure
+  bool walk;      // structure has not been seen before
+  int first;      // index of first occurence of the structure in the batch (-1 if this is the first one)
+  int res;        // 1 - minimum found, 0 - discarded, -2 - not canonical
+  int gw_length;  // length of gradient walk
+};
+
+// gradient walk from a single structure, must not touch anything but the item (runs in parallel)
+void descend(walk_item &w, SeqInfo &sqi)
+{
+  w.str.energy = Opt.pknots? energy_of_struct_pk(sqi.seq, w.str.structure, sqi.s0, sqi.s1, Opt.verbose_lvl>3):energy_of_structure_pt(sqi.seq, w.str.structure, sqi.s0, sqi.s1, 0);
+
+  //is it canonical (noLP)
+  if (Opt.noLP && find_lone_pair(w.str.structure)!=-1) {
+    w.res = -2;
+    return;
   }
 
-  // if pure, just do descend and print it:
-  if (pure_output) {
-    //is it canonical (noLP)
-    if (Opt.noLP && find_lone_pair(str.structure)!=-1) {
-      if (Opt.verbose_lvl>0) fprintf(stderr, "WARNING: structure \"%s\" has lone pairs, skipping...\n", pt_to_str_pk(str.structure).c_str());
-      free(str.structure);
-      return -2;
-    }
+  // descend on a copy
+  w.lm.structure = allocopy(w.str.structure);
+  w.lm.energy = w.str.energy;
+  w.gw_length = move_set(w.lm, sqi);
+
+  // only some types of PK allowed!!!
+  if (Opt.pknots && w.lm.energy == INT_MAX) {
+    free(w.lm.structure);
+    w.lm.structure = NULL;
+    w.res = 0;
+    return;
+  }
 
-    //debugging
-    if (Opt.verbose_lvl>1) fprintf(stderr, "proc(pure): %d %s\n", num_moves, pt_to_str_pk(str.structure).c_str());
+  w.res = 1;
+}
 
-    // descend
-    int gw_length = move_set(str, sqi);
-    // only some types of PK allowed!!!
-    if (Opt.pknots && str.energy == INT_MAX) {
-      free(str.structure);
-      return 0;
+/*
+  reads a batch of structures (one per thread and a few more to balance the load),
+  descends from all new ones in parallel, and merges the minima in input order,
+  so the result does not depend on the number of threads.
+  returns -1 at the end of input, 1 otherwise.
+*/
+int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, SeqInfo &sqi, bool pure_output, int jobs, int &count, int find_num, int &not_canonical, clock_t clck1)
+{
+  int batch = (jobs > 1 ? 256*jobs : 1);
+  int end = 1;
+
+  // read
+  vector<walk_item> items;
+  unordered_map<struct_en, int, hash_fncts, hash_eq> in_batch;
+  while ((int)items.size() < batch) {
+    walk_item w;
+    w.str.structure = w.lm.structure = NULL;
+    w.walk = true;
+    w.first = -1;
+    w.res = 0;
+    w.gw_length = 0;
+
+    int res = read_structure(w.str, sqi);
+    if (res == -1) {
+      end = -1;
+      break;
     }
+    if (res == 0) continue;
+    w.num = num_moves;
 
-    if (Opt.verbose_lvl>2) fprintf(stderr, "\n  %s %d %d\n", pt_to_str_pk(str.structure).c_str(), str.energy, gw_length);
-    printf("%s %6.2f %4d\n", pt_to_str_pk(str.structure).c_str(), str.energy/100.0, gw_length);
-    free(str.structure);
-    return 1;
+    // structures seen before are not walked again
+    if (!pure_output) {
+      if (structs.count(w.str)) {
+        w.walk = false;
+      } else {
+        unordered_map<struct_en, int, hash_fncts, hash_eq>::iterator it = in_batch.find(w.str);
+        if (it != in_batch.end()) {
+          w.walk = false;
+          w.first = it->second;
+        } else in_batch[w.str] = (int)items.size();
+      }
+    }
+    items.push_back(w);
   }
 
-  // check if it was before
-  unordered_map<struct_en, gw_struct, hash_fncts, hash_eq>::iterator it_s = structs.find(str);
+  // descend
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(jobs) if(jobs > 1)
+#endif
+  for (int i=0; i<(int)items.size(); i++) {
+    if (items[i].walk) descend(items[i], sqi);
+  }
 
-  // if it was - release memory + get another
-  if (it_s != structs.end()) {
-    it_s->second.count++;
-    free(str.structure);
-    return 0;
-  } else {
-    // find energy only if not in input (not working - does energy_of_move require energy_of_struct run first???)
-    //str.energy = Enc.Energy(str);
-    //printf("\n%s\n%s %7.2f\n\n", Enc.seq, pt_to_str_pk(str.structure).c_str(), str.energy/100.0);
-    /*if (1 || !energy_found) str.energy = Enc.Energy(str);
-    else str.energy = (int)(energy*100.0+(energy<0.0 ? -0.5 : 0.5));*/
+  // merge in input order
+  unsigned int i;
+  for (i=0; i<items.size(); i++) {
+    walk_item &w = items[i];
+
+    // print out
+    if (Opt.verbose_lvl>0 && w.num%(Opt.pknots?1000:10000)==0) fprintf(stderr, "processed %d, minima %d, time %f secs.\n", w.num, (int)output.size(), (clock()-clck1)/(double)CLOCKS_PER_SEC);
+
+    // if pure, just print it:
+    if (pure_output) {
+      if (w.res==-2) {
+        if (Opt.verbose_lvl>0) fprintf(stderr, "WARNING: structure \"%s\" has lone pairs, skipping...\n", pt_to_str_pk(w.str.structure).c_str());
+        not_canonical++;
+      } else if (w.res==1) {
+        //debugging
+        if (Opt.verbose_lvl>1) fprintf(stderr, "proc(pure): %d %s\n", w.num, pt_to_str_pk(w.str.structure).c_str());
+        if (Opt.verbose_lvl>2) fprintf(stderr, "\n  %s %d %d\n", pt_to_str_pk(w.lm.structure).c_str(), w.lm.energy, w.gw_length);
+        printf("%s %6.2f %4d\n", pt_to_str_pk(w.lm.structure).c_str(), w.lm.energy/100.0, w.gw_length);
+        free(w.lm.structure);
+      }
+      free(w.str.structure);
+      continue;
+    }
+
+    // check if it was before
+    unordered_map<struct_en, gw_struct, hash_fncts, hash_eq>::iterator it_s = structs.find(w.str);
+
+    // if it was - release memory + get another
+    if (it_s != structs.end()) {
+      it_s->second.count++;
+      free(w.str.structure);
+      continue;
+    }
+
+    // same structure earlier in this batch, but it did not make it into the hash
+    int res = (w.first == -1 ? w.res : items[w.first].res);
+    if (w.first != -1) w.str.energy = items[w.first].str.energy;
 
     // allegiance hack:
-    struct_en he_str = str;
+    struct_en he_str = w.str;
     if (allegiance) {
       structures.push_back(he_str);
     }
 
     //is it canonical (noLP)
-    if (Opt.noLP && find_lone_pair(str.structure)!=-1) {
-      if (Opt.verbose_lvl>0) fprintf(stderr, "WARNING: structure \"%s\" has lone pairs, skipping...\n", pt_to_str_pk(str.structure).c_str());
-      free(str.structure);
-      return -2;
+    if (res==-2) {
+      if (Opt.verbose_lvl>0) fprintf(stderr, "WARNING: structure \"%s\" has lone pairs, skipping...\n", pt_to_str_pk(w.str.structure).c_str());
+      free(w.str.structure);
+      not_canonical++;
+      continue;
     }
 
-    // copy it anew
-    struct_en old = str;
-    str.structure = allocopy(str.structure);
-
     //debugging
-    if (Opt.verbose_lvl>1) fprintf(stderr, "processing: %d %s\n", num_moves, pt_to_str_pk(str.structure).c_str());
+    if (Opt.verbose_lvl>1) fprintf(stderr, "processing: %d %s\n", w.num, pt_to_str_pk(w.str.structure).c_str());
 
-    // descend
-    move_set(str, sqi);
     // only some types of PK allowed!!!
-    if (Opt.pknots && str.energy == INT_MAX) {
-      free(str.structure);
-      free(old.structure);
-      return 0;
+    if (res==0) {
+      free(w.str.structure);
+      continue;
     }
 
     // insert into hash (memory is here only on left side)
+    struct_en old = w.str;
+    struct_en str = w.lm;
     gw_struct &lm = structs[old];
     lm.count = 1;
-    /*
-    int i;
-    while ((i = (Opt.rand? move_rand(str) : move_set(str)))!=0) {
-      Deg.Clear();
-    }
-    Deg.Clear();*/
 
     if (Opt.verbose_lvl>2) fprintf(stderr, "\n  %s %d\n", pt_to_str_pk(str.structure).c_str(), str.energy);
 
@@ -1002,7 +1132,20 @@ int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<
       // allegiance hack:
       if (allegiance) str_to_LM[he_str] = str;
     }
+
+    // enough minima?
+    count = output.size();
+    if (count == find_num) {
+      i++;
+      break;
+    }
   }
 
-  return 1;
+  // discard the rest of the batch
+  for (; i<items.size(); i++) {
+    if (items[i].lm.structure) free(items[i].lm.structure);
+    free(items[i].str.structure);
+  }
+
+  return end;
 }
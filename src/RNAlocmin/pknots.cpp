@@ -13,6 +13,7 @@ extern "C" {
   #include "pair_mat.h"
   #include "fold.h"
   #include "loop_energies.h"
+  #include "params.h"
 
   #include "move_set_inside.h"
 }
@@ -24,7 +25,7 @@ static paramT *P = NULL;
 
 void freeP()
 {
-  if (P) free(P);
+  if (P) vrna_params_free(P);
   P = NULL;
 }
 
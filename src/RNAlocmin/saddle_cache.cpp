@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "saddle_cache.h"
+
+#define CACHE_HEADER "# RNAlocmin saddle cache"
+
+using namespace std;
+
+SaddleCache::SaddleCache(const string &settings)
+  : settings(settings)
+{
+}
+
+// 64-bit FNV-1a
+uint64_t SaddleCache::Hash(const string &structure)
+{
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i=0; i<structure.size(); i++) {
+    h ^= (unsigned char)structure[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// saddles are symmetric, so the key is ordered
+pair<uint64_t, uint64_t> SaddleCache::Key(const string &s1, const string &s2)
+{
+  uint64_t h1 = Hash(s1);
+  uint64_t h2 = Hash(s2);
+  return (h1<h2 ? make_pair(h1, h2) : make_pair(h2, h1));
+}
+
+int SaddleCache::Load(const char *filename)
+{
+  FILE *fp = fopen(filename, "r");
+  if (fp == NULL) return 0;
+
+  char line[256];
+  // header
+  if (fgets(line, sizeof(line), fp) == NULL || strncmp(line, CACHE_HEADER, strlen(CACHE_HEADER))!=0) {
+    fprintf(stderr, "WARNING: %s is not a saddle cache, ignoring it\n", filename);
+    fclose(fp);
+    return 0;
+  }
+
+  // settings (may be long, the sequence is part of them)
+  string file_settings;
+  int c;
+  while ((c = fgetc(fp))!=EOF && c!='\n') file_settings += (char)c;
+  if (file_settings != settings) {
+    fprintf(stderr, "WARNING: saddle cache %s was computed for another sequence or energy model, ignoring it\n", filename);
+    fclose(fp);
+    return 0;
+  }
+
+  int count = 0;
+  uint64_t h1, h2;
+  int saddle;
+  while (fgets(line, sizeof(line), fp)) {
+    if (sscanf(line, "%" SCNx64 " %" SCNx64 " %d", &h1, &h2, &saddle)!=3) continue;
+    saddles[(h1<h2 ? make_pair(h1, h2) : make_pair(h2, h1))] = saddle;
+    count++;
+  }
+  fclose(fp);
+
+  return count;
+}
+
+bool SaddleCache::Save(const char *filename) const
+{
+  FILE *fp = fopen(filename, "w");
+  if (fp == NULL) return false;
+
+  fprintf(fp, "%s\n%s\n", CACHE_HEADER, settings.c_str());
+  for (map<pair<uint64_t, uint64_t>, int>::const_iterator it=saddles.begin(); it!=saddles.end(); it++) {
+    fprintf(fp, "%016" PRIx64 " %016" PRIx64 " %d\n", it->first.first, it->first.second, it->second);
+  }
+
+  return fclose(fp)==0;
+}
+
+bool SaddleCache::Get(const string &s1, const string &s2, int &saddle) const
+{
+  map<pair<uint64_t, uint64_t>, int>::const_iterator it = saddles.find(Key(s1, s2));
+  if (it == saddles.end()) return false;
+  saddle = it->second;
+  return true;
+}
+
+void SaddleCache::Put(const string &s1, const string &s2, int saddle)
+{
+  saddles[Key(s1, s2)] = saddle;
+}
@@ -0,0 +1,34 @@
+#ifndef __SADDLE_CACHE_H
+#define __SADDLE_CACHE_H
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+// saddle heights between pairs of minima, kept on disk between runs of RNAlocmin
+// minima are identified by a 64-bit hash of their dot-bracket string
+class SaddleCache {
+  std::string settings; // sequence and energy model the saddles were computed for
+  std::map<std::pair<uint64_t, uint64_t>, int> saddles;
+
+  static uint64_t Hash(const std::string &structure);
+  static std::pair<uint64_t, uint64_t> Key(const std::string &s1, const std::string &s2);
+
+public:
+  SaddleCache(const std::string &settings);
+
+  // read saddles from file, returns number of saddles read (entries computed with other settings are dropped)
+  int Load(const char *filename);
+  // write all saddles to file, returns false on failure
+  bool Save(const char *filename) const;
+
+  // saddle height (in dcal/mol) between two minima, returns false if it is not known
+  bool Get(const std::string &s1, const std::string &s2, int &saddle) const;
+  void Put(const std::string &s1, const std::string &s2, int saddle);
+
+  int Size() const { return (int)saddles.size(); }
+};
+
+#endif
@@ -3,6 +3,9 @@
 #include <string.h>
 #include <unistd.h>
 #include <regex.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <ViennaRNA/model.h>
 #include <ViennaRNA/fold_compound.h>
@@ -52,6 +55,7 @@ struct options_s {
   /* common options */
   int                     iterations;
   int                     samples;
+  int                     jobs;         /* number of threads for gradient walks */
 
   /* PathFinder options */
   int                     max_storage;
@@ -430,6 +434,7 @@ default_options(void)
   /* common options to many methods */
   options->samples    = 1000;
   options->iterations = 1;
+  options->jobs       = 1;
 
   /* PathFinder options */
   options->max_storage = 10;
@@ -632,6 +637,21 @@ process_arguments(int   argc,
   options->ediff_penalty = args_info.ediff_penalty_flag;
   options->mu = args_info.mu_arg;
   options->verbose = args_info.verbose_flag;
+
+  /* parallel gradient walks */
+  if (args_info.jobs_given) {
+#ifdef _OPENMP
+    if (args_info.jobs_arg < 0) {
+      vrna_message_warning("Number of jobs must not be negative, using a single thread");
+      options->jobs = 1;
+    } else {
+      options->jobs = (args_info.jobs_arg == 0) ? omp_get_num_procs() : args_info.jobs_arg;
+    }
+#else
+    vrna_message_warning("This version of RNAxplorer has been built without parallel processing support, ignoring --jobs");
+#endif
+  }
+
   /* free allocated memory of command line data structure */
   RNAxplorer_cmdline_parser_free(&args_info);
 
@@ -1024,13 +1044,16 @@ sampling_repulsion(const char       *rec_id,
                    struct options_s *opt)
 {
   char                  *sequence = strdup(orig_sequence);
+  vrna_md_t             md        = opt->md;
 
   vrna_seq_toRNA(sequence);
   vrna_seq_toupper(sequence);
 
+  md.compute_bpp = 0;
+
   vrna_fold_compound_t  *fc = vrna_fold_compound(sequence,
-                                                 &(opt->md),
-                                                 VRNA_OPTION_DEFAULT);
+                                                 &md,
+                                                 VRNA_OPTION_MFE | VRNA_OPTION_PF);
 
   repellant_sampling(fc);
 
@@ -1811,7 +1834,115 @@ hashtable_list_strings_add_structure_and_count(hashtable_list_strings *htl, shor
   }
 }
 
-void reduce_lm_two_neighborhood(vrna_fold_compound_t *fc, hashtable_list_strings *lm, int verbose /*= False*/){
+/*
+ * Cache of gradient walks from sampled structures. Walks are performed on
+ * the fold compound without soft constraints, so the local minimum of a
+ * sample does not change between sampling rounds.
+ */
+typedef struct lm_cache_ {
+  unsigned long     length;
+  unsigned long     allocated_size;
+  char              **list_minima;
+  float             *list_energies;
+  structure_and_index **list_samples; // sample structure and index
+  vrna_hash_table_t ht_samples; // lookup table;
+} lm_cache;
+
+static lm_cache
+create_lm_cache(int hashbits)
+{
+  lm_cache cache;
+
+  cache.allocated_size  = 10;
+  cache.length          = 0;
+  cache.list_minima     = vrna_alloc(sizeof(char *) * cache.allocated_size);
+  cache.list_energies   = vrna_alloc(sizeof(float) * cache.allocated_size);
+  cache.list_samples    = vrna_alloc(sizeof(structure_and_index *) * cache.allocated_size);
+  cache.ht_samples      = create_string_hashtable(hashbits);
+  return cache;
+}
+
+static
+void
+free_lm_cache(lm_cache *cache)
+{
+  vrna_ht_free(cache->ht_samples);
+  int i;
+  for (i = 0; i < (int)cache->length; i++){
+    free(cache->list_samples[i]->structure);
+    free(cache->list_samples[i]);
+    free(cache->list_minima[i]);
+  }
+  free(cache->list_samples);
+  free(cache->list_minima);
+  free(cache->list_energies);
+}
+
+/*
+ * Determine the local minima of a NULL-terminated list of samples, i.e. the
+ * index of each sample's local minimum within the cache. Samples not seen
+ * before are walked down using up to 'jobs' threads; the walks do not depend
+ * on each other and are entered into the cache in the order of the samples,
+ * so the result does not depend on the number of threads.
+ */
+static int *
+local_minima_of_samples(vrna_fold_compound_t *fc, lm_cache *cache, char **samples, int jobs){
+    int i, num, num_new;
+
+    for(num = 0; samples[num]; num++){}
+
+    int *result = vrna_alloc(sizeof(int) * (num + 1));
+    int *todo = vrna_alloc(sizeof(int) * (num + 1));
+    num_new = 0;
+
+    /* look up samples in cache, remember those we have to walk down */
+    for(i = 0; i < num; i++){
+        structure_and_index to_check;
+        to_check.structure = samples[i];
+        structure_and_index *lookup_result = vrna_ht_get(cache->ht_samples, (void *)&to_check);
+        if(lookup_result == NULL){
+            if(cache->length >= cache->allocated_size){
+                cache->allocated_size += num;
+                cache->list_minima   = vrna_realloc(cache->list_minima, sizeof(char *) * cache->allocated_size);
+                cache->list_energies = vrna_realloc(cache->list_energies, sizeof(float) * cache->allocated_size);
+                cache->list_samples  = vrna_realloc(cache->list_samples, sizeof(structure_and_index *) * cache->allocated_size);
+            }
+            structure_and_index *to_insert = vrna_alloc(sizeof(structure_and_index));
+            to_insert->structure = strdup(samples[i]);
+            to_insert->index = (int)cache->length;
+            cache->list_samples[cache->length] = to_insert;
+            cache->list_minima[cache->length] = NULL;
+            cache->length++;
+            if(vrna_ht_insert(cache->ht_samples, (void *)to_insert) != 0)
+                fprintf(stderr, "Error: hash table insert failed!");
+            todo[num_new++] = to_insert->index;
+            result[i] = to_insert->index;
+        }
+        else{
+            result[i] = lookup_result->index;
+        }
+    }
+
+    /* gradient walks */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(jobs) if(jobs > 1)
+#endif
+    for(i = 0; i < num_new; i++){
+        int idx = todo[i];
+        short *s_pt = vrna_ptable(cache->list_samples[idx]->structure);
+        short *ss = detect_local_minimum(fc, s_pt);
+        cache->list_minima[idx] = vrna_db_from_ptable(ss);
+        cache->list_energies[idx] = vrna_eval_structure(fc, cache->list_minima[idx]);
+        free(ss);
+        free(s_pt);
+    }
+
+    free(todo);
+    result[num] = -1;
+    return result;
+}
+
+void reduce_lm_two_neighborhood(vrna_fold_compound_t *fc, hashtable_list_strings *lm, int verbose /*= False*/, int jobs){
     int cnt       = 1;
     int cnt_max   = (int)lm->length; //len(lm)
     int lm_remove_allocated = 10;
@@ -1823,14 +1954,27 @@ void reduce_lm_two_neighborhood(vrna_fold_compound_t *fc, hashtable_list_strings
         fprintf(stderr, "Applying 2-Neighborhood Filter...\n");
     }
     int i;
+
+    /* the extended gradient walks do not depend on each other */
+    char **lm_two = vrna_alloc(sizeof(char *) * (lm->length + 1));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(jobs) if(jobs > 1)
+#endif
+    for(i=0; i < (int)lm->length; i++){
+        if(lm->list_key_value_pairs[i] != NULL)
+            lm_two[i] = detect_local_minimum_two(fc, lm->list_key_value_pairs[i]->structure);
+    }
+
     for(i=0; i < (int)lm->length; i++){ //s in lm:
+        if(lm->list_key_value_pairs[i] == NULL)
+            continue;
         char *s = lm->list_key_value_pairs[i]->structure;
         int s_count = lm->list_counts[i];
         if(verbose){
             fprintf(stderr, "\rApplying 2-Neighborhood Filter...%6d / %6d\n", cnt, cnt_max);
         }
 
-        char *ss = detect_local_minimum_two(fc, s);
+        char *ss = lm_two[i];
 
         if(strcmp(s, ss) != 0){ //(s != ss){
             // store structure for removal
@@ -1888,6 +2032,7 @@ void reduce_lm_two_neighborhood(vrna_fold_compound_t *fc, hashtable_list_strings
         lm->list_key_value_pairs[lm_index_to_remove] = NULL;
     }
     free(lm_remove);
+    free(lm_two);
 
     // add newly detected local minima
     //lm.update(lm_novel)
@@ -2052,12 +2197,15 @@ void RNAlocmin_output(char *sequence, hashtable_list_strings htl, char *filename
 
     int i;
     int si;
+    int num = 0;
     for(si=0; sorted_indices[si].index > -1; si++){
         i = sorted_indices[si].index;
+        if(htl.list_key_value_pairs[i] == NULL)
+            continue; // removed by 2-neighborhood filter
         char *s = htl.list_key_value_pairs[i]->structure;
         int count = htl.list_counts[i];
         float energy = htl.list_energies[i];
-        fprintf(f, "%4d %s %6.2f %6d\n", si, s, energy, count);
+        fprintf(f, "%4d %s %6.2f %6d\n", num++, s, energy, count);
     }
     if(filename)
         fclose(f);
@@ -2228,6 +2376,7 @@ sampling_repellent_heuristic(const char       *rec_id,
     char **sample_list = vrna_alloc(sizeof(char *) * (sample_list_allocated+1)); // = []
 
     hashtable_list_strings pending_lm = create_hashtable_list_strings(13);// = dict()
+    lm_cache walks = create_lm_cache(13); // local minima of samples seen so far
     //int num_sc = 1;
 
     int num_iter      = (int)(ceil(opt->num_samples / (float)opt->granularity));
@@ -2265,34 +2414,31 @@ sampling_repellent_heuristic(const char       *rec_id,
         hashtable_list_strings current_lm = create_hashtable_list_strings(13); // = dict()
 
         // go through list of sampled structures and determine corresponding local minima
+        int *sample_lm = local_minima_of_samples(fc_base, &walks, sample_set, opt->jobs);
         for(i=0; sample_set[i]; i++){ // s in sample_set:
-            char *s = sample_set[i];
-            short *s_pt = vrna_ptable(s);
-            short *ss = detect_local_minimum(fc_base, s_pt);
-            free(s_pt);
-
-            char *ss_string = vrna_db_from_ptable(ss);
+            char *ss_string = walks.list_minima[sample_lm[i]];
             structure_and_index to_check;
             to_check.structure = ss_string;
             structure_and_index *lookup_result = vrna_ht_get(current_lm.ht_pairs, (void *)&to_check);
             if (lookup_result == NULL) {
-                float energy_kcal = vrna_eval_structure(fc_base, ss_string);
+                float energy_kcal = walks.list_energies[sample_lm[i]];
                 int count = 1;
+                short *ss = vrna_ptable(ss_string);
                 hashtable_list_strings_add_structure_and_count(&current_lm, ss, energy_kcal, count);
+                free(ss);
             }
             else{
                 int index = lookup_result->index;
                 current_lm.list_counts[index] += 1;
             }
-            free(ss_string);
-            free(ss);
         }
 
+        free(sample_lm);
         free(sample_set);
 
         // explore the 2-neighborhood of current local minima to reduce total number of local minima
         if(opt->explore_two_neighborhood)
-            reduce_lm_two_neighborhood(fc_base, &current_lm, opt->verbose);
+            reduce_lm_two_neighborhood(fc_base, &current_lm, opt->verbose, opt->jobs);
 
 
         // transfer local minima obtained in this iteration to list of pending local minima
@@ -2346,6 +2492,7 @@ sampling_repellent_heuristic(const char       *rec_id,
                 if(cnt_other > 0 && cnt_once > 0){
                     if(cnt_once <= (opt->mu * cnt_other)){
                         float repell_en = 0;
+                        unsigned int update_from = 0, update_to = 0;
                         if(opt->ediff_penalty){
                             //repell_en = kt_fact * (value['energy'] - pending_lm[struct_en_min]['energy'])
                             float energy = pending_lm.list_energies[i];
@@ -2381,9 +2528,23 @@ sampling_repellent_heuristic(const char       *rec_id,
                         }
                         else{
                           store_basepair_sc(fc, &sc_data, struct_cnt_max, repell_en, 0);
+                          /* only the penalties of pairs in struct_cnt_max changed */
+                          short *p_pt = vrna_ptable(struct_cnt_max);
+                          for(int k = 1; k <= p_pt[0]; k++){
+                            if(p_pt[k] > k){
+                              if(update_from == 0)
+                                update_from = k;
+                              if(p_pt[k] > update_to)
+                                update_to = p_pt[k];
+                            }
+                          }
+                          free(p_pt);
                         }
 
-                        vrna_pf(fc, NULL);
+                        if(update_from > 0)
+                          vrna_pf_update(fc, NULL, update_from, update_to);
+                        else
+                          vrna_pf(fc, NULL);
 
                         //for cmk in pending_lm.keys():
                         int j;
@@ -2436,7 +2597,7 @@ sampling_repellent_heuristic(const char       *rec_id,
     fprintf(stderr," ... done\n");
 
     if(opt->post_filter_two)
-        reduce_lm_two_neighborhood(fc_base, &minima, opt->verbose);
+        reduce_lm_two_neighborhood(fc_base, &minima, opt->verbose, opt->jobs);
 
     /* write local minima file and samples file */
     if(opt->lmin_file){
@@ -2682,9 +2843,10 @@ sampling_repellent_heuristic(const char       *rec_id,
       for(i=0; sample_list[i]; i++)
         free(sample_list[i]);
     free(sample_list);
+    free_lm_cache(&walks);
     vrna_fold_compound_free(fc);
     vrna_fold_compound_free(fc_base);
-    free(exp_param);
+    vrna_exp_params_free(exp_param);
 
     return EXIT_SUCCESS;
 }
@@ -2697,7 +2859,7 @@ retrieve_local_minima(const char       *rec_id,
   double temperature_celsius = opt->temperature_celsius;
   int shift_moves = opt->shift_moves;
   char *parameter_file = opt->parameter_file;
-  return gradient_walker(temperature_celsius, shift_moves, parameter_file, orig_sequence, structures);
+  return gradient_walker(temperature_celsius, shift_moves, parameter_file, orig_sequence, structures, opt->jobs);
 }
 
 
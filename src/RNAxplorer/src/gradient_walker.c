@@ -21,7 +21,6 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
-#include <unistd.h>
 
 PRIVATE void
 printStructure_pt(vrna_fold_compound_t *vc, short * pt, unsigned int index)
@@ -33,7 +32,7 @@ printStructure_pt(vrna_fold_compound_t *vc, short * pt, unsigned int index)
 }
 
 int
-gradient_walker(double temperature_celsius, int shift_moves, char *parameter_file, const char *sequence, char **structures)
+gradient_walker(double temperature_celsius, int shift_moves, char *parameter_file, const char *sequence, char **structures, int jobs)
 {
   double temperature = temperature_celsius;
   int shifts = shift_moves;
@@ -61,20 +60,25 @@ gradient_walker(double temperature_celsius, int shift_moves, char *parameter_fil
     num_structures++;
   }
 
-long int cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
-printf("%s\n",vc->sequence);
+  printf("%s\n",vc->sequence);
+
+  /* walk down in parallel, but print the minima in the order of the input */
+  short **minima = (short **)vrna_alloc(sizeof(short *) * (num_structures + 1));
 #ifdef _OPENMP
-#pragma omp parallel num_threads(cpu_count)
-#pragma omp for
+#pragma omp parallel for schedule(dynamic) num_threads(jobs) if(jobs > 1)
 #endif
   for(i = 0; i < num_structures; i++){
-    char *structure = structures[i];
-    short *pt = vrna_ptable (structure);
+    short *pt = vrna_ptable (structures[i]);
     vrna_move_t *moves = vrna_path_gradient(vc,pt, moveset);
     free(moves);
-    printStructure_pt(vc, pt, i+1);
-    free (pt);
+    minima[i] = pt;
+  }
+
+  for(i = 0; i < num_structures; i++){
+    printStructure_pt(vc, minima[i], i+1);
+    free (minima[i]);
   }
+  free(minima);
 
   //printf ("finish!\n");
   vrna_fold_compound_free (vc);
@@ -10,5 +10,5 @@
 
 
 int
-gradient_walker(double temperature_celsius, int shift_moves, char *parameter_file, const char *orig_sequence, char **structures);
+gradient_walker(double temperature_celsius, int shift_moves, char *parameter_file, const char *orig_sequence, char **structures, int jobs);
 
@@ -105,17 +105,14 @@ rnax_change_repulsion(vrna_fold_compound_t *fc,
 
 /* BEGIN interface for repulsive sampling */
 void
-repellant_sampling(vrna_fold_compound_t *vc)
+repellant_sampling(vrna_fold_compound_t *fc)
 {
   unsigned int  n;
-  vrna_md_t     md;
-
-  vrna_md_set_default(&md);
-  md.uniq_ML     = 1;
-  md.compute_bpp = 0;
-
-  vrna_fold_compound_t *fc = vrna_fold_compound(vc->sequence, &md, VRNA_OPTION_PF);
 
+  /*
+   *  the repulsion only adds soft constraints, so the fold compound
+   *  (and its DP matrices) provided by the caller is re-used throughout
+   */
   n = fc->length;
 
   /* compute 'real' MFE structure */
@@ -144,6 +141,8 @@ repellant_sampling(vrna_fold_compound_t *vc)
     printf("%s [ %6.2f ]\n", s, vrna_eval_structure_simple(fc->sequence, s));
     free(s);
   }
+
+  free(mfe_structure);
 }
 
 
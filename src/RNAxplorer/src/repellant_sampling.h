@@ -1,6 +1,7 @@
 #ifndef   _RNAXPLORER_REPELLANT_SAMPLING_H_
 #define   _RNAXPLORER_REPELLANT_SAMPLING_H_
 
+/* repulsion is added to fc as soft constraints, fc is re-used for all samples */
 void
 repellant_sampling(vrna_fold_compound_t *fc);
 
@@ -29,6 +29,8 @@
 #endif
 #include "ViennaRNA/2Dfold.h"
 
+#include "ViennaRNA/intern/arena.h"
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -110,15 +112,16 @@ backtrack_m2(unsigned int         i,
 
 
 PRIVATE void
-adjustArrayBoundaries(int ***array,
-                      int *k_min,
-                      int *k_max,
-                      int **l_min,
-                      int **l_max,
-                      int k_min_real,
-                      int k_max_real,
-                      int *l_min_real,
-                      int *l_max_real);
+adjustArrayBoundaries(vrna_mx_arena_t *arena,
+                      int             ***array,
+                      int             *k_min,
+                      int             *k_max,
+                      int             **l_min,
+                      int             **l_max,
+                      int             k_min_real,
+                      int             k_max_real,
+                      int             *l_min_real,
+                      int             *l_max_real);
 
 
 INLINE PRIVATE void
@@ -145,6 +148,8 @@ prepareBoundaries(int min_k_pre,
                   int min_l_pre,
                   int max_l_pre,
                   int bpdist,
+                  int max_d1,
+                  int max_d2,
                   int *min_k,
                   int *max_k,
                   int **min_l,
@@ -167,6 +172,11 @@ prepareArray2(unsigned long ***array,
               int           *max_l);
 
 
+PRIVATE INLINE void
+releaseArray(int  **array,
+             int  min_k);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -450,6 +460,10 @@ mfe_linear(vrna_fold_compound_t *vc)
   circ          = md->circ;
   turn          = md->min_loop_size;
 
+  /* release the matrix entries of any previous run */
+  arena_free(matrices->arena);
+  matrices->arena = arena_init();
+
   for (d = turn + 2; d <= seq_length; d++) {
     /* i,j in [1..length] */
 #ifdef _OPENMP
@@ -495,6 +509,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                           min_l,
                           max_l,
                           bpdist[ij],
+                          maxD1,
+                          maxD2,
                           &matrices->k_min_C[ij],
                           &matrices->k_max_C[ij],
                           &matrices->l_min_C[ij],
@@ -751,7 +767,8 @@ mfe_linear(vrna_fold_compound_t *vc)
         }
 
         /* resize and move memory portions of energy matrix E_C */
-        adjustArrayBoundaries(&matrices->E_C[ij],
+        adjustArrayBoundaries(matrices->arena,
+                              &matrices->E_C[ij],
                               &matrices->k_min_C[ij],
                               &matrices->k_max_C[ij],
                               &matrices->l_min_C[ij],
@@ -799,6 +816,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                         min_l_guess,
                         max_l_guess,
                         bpdist[ij],
+                        maxD1,
+                        maxD2,
                         &matrices->k_min_M[ij],
                         &matrices->k_max_M[ij],
                         &matrices->l_min_M[ij],
@@ -810,6 +829,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                         min_l_guess,
                         max_l_guess,
                         bpdist[ij],
+                        maxD1,
+                        maxD2,
                         &matrices->k_min_M1[ij],
                         &matrices->k_max_M1[ij],
                         &matrices->l_min_M1[ij],
@@ -1141,7 +1162,8 @@ mfe_linear(vrna_fold_compound_t *vc)
 
       /* thats all folks for the multiloop decomposition... */
 
-      adjustArrayBoundaries(&matrices->E_M[ij],
+      adjustArrayBoundaries(matrices->arena,
+                            &matrices->E_M[ij],
                             &matrices->k_min_M[ij],
                             &matrices->k_max_M[ij],
                             &matrices->l_min_M[ij],
@@ -1152,7 +1174,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                             max_l_real_m
                             );
 
-      adjustArrayBoundaries(&matrices->E_M1[ij],
+      adjustArrayBoundaries(matrices->arena,
+                            &matrices->E_M1[ij],
                             &matrices->k_min_M1[ij],
                             &matrices->k_max_M1[ij],
                             &matrices->l_min_M1[ij],
@@ -1173,13 +1196,13 @@ mfe_linear(vrna_fold_compound_t *vc)
 
   /* prepare first entries in E_F5 */
   for (cnt1 = 1; cnt1 <= turn + 1; cnt1++) {
-    matrices->E_F5[cnt1]        = (int **)vrna_alloc(sizeof(int *));
-    matrices->E_F5[cnt1][0]     = (int *)vrna_alloc(sizeof(int));
+    matrices->E_F5[cnt1]        = (int **)arena_alloc(matrices->arena, sizeof(int *));
+    matrices->E_F5[cnt1][0]     = (int *)arena_alloc(matrices->arena, sizeof(int));
     matrices->E_F5[cnt1][0][0]  = 0;
     matrices->E_F5_rem[cnt1]    = INF;
     matrices->k_min_F5[cnt1]    = matrices->k_max_F5[cnt1] = 0;
-    matrices->l_min_F5[cnt1]    = (int *)vrna_alloc(sizeof(int));
-    matrices->l_max_F5[cnt1]    = (int *)vrna_alloc(sizeof(int));
+    matrices->l_min_F5[cnt1]    = (int *)arena_alloc(matrices->arena, sizeof(int));
+    matrices->l_max_F5[cnt1]    = (int *)arena_alloc(matrices->arena, sizeof(int));
     matrices->l_min_F5[cnt1][0] = matrices->l_max_F5[cnt1][0] = 0;
 #ifdef COUNT_STATES
     matrices->N_F5[cnt1]        = (unsigned long **)vrna_alloc(sizeof(unsigned long *));
@@ -1215,6 +1238,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                       min_l_guess,
                       max_l_guess,
                       bpdist[my_iindx[1] - j],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_F5[j],
                       &matrices->k_max_F5[j],
                       &matrices->l_min_F5[j],
@@ -1388,7 +1413,8 @@ mfe_linear(vrna_fold_compound_t *vc)
     }
 
     /* resize and move memory portions of energy matrix E_F5 */
-    adjustArrayBoundaries(&matrices->E_F5[j],
+    adjustArrayBoundaries(matrices->arena,
+                          &matrices->E_F5[j],
                           &matrices->k_min_F5[j],
                           &matrices->k_max_F5[j],
                           &matrices->l_min_F5[j],
@@ -1404,12 +1430,12 @@ mfe_linear(vrna_fold_compound_t *vc)
   if (compute_2Dfold_F3) {
     /* prepare first entries in E_F3 */
     for (cnt1 = seq_length; cnt1 >= seq_length - turn - 1; cnt1--) {
-      matrices->E_F3[cnt1]        = (int **)vrna_alloc(sizeof(int *));
-      matrices->E_F3[cnt1][0]     = (int *)vrna_alloc(sizeof(int));
+      matrices->E_F3[cnt1]        = (int **)arena_alloc(matrices->arena, sizeof(int *));
+      matrices->E_F3[cnt1][0]     = (int *)arena_alloc(matrices->arena, sizeof(int));
       matrices->E_F3[cnt1][0][0]  = 0;
       matrices->k_min_F3[cnt1]    = matrices->k_max_F3[cnt1] = 0;
-      matrices->l_min_F3[cnt1]    = (int *)vrna_alloc(sizeof(int));
-      matrices->l_max_F3[cnt1]    = (int *)vrna_alloc(sizeof(int));
+      matrices->l_min_F3[cnt1]    = (int *)arena_alloc(matrices->arena, sizeof(int));
+      matrices->l_max_F3[cnt1]    = (int *)arena_alloc(matrices->arena, sizeof(int));
       matrices->l_min_F3[cnt1][0] = matrices->l_max_F3[cnt1][0] = 0;
     }
     /* begin calculations */
@@ -1441,6 +1467,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                         min_l_guess,
                         max_l_guess,
                         bpdist[my_iindx[j] - seq_length],
+                        maxD1,
+                        maxD2,
                         &matrices->k_min_F3[j],
                         &matrices->k_max_F3[j],
                         &matrices->l_min_F3[j],
@@ -1550,12 +1578,13 @@ mfe_linear(vrna_fold_compound_t *vc)
         }
       }
 
-      /* resize and move memory portions of energy matrix E_F5 */
-      adjustArrayBoundaries(&matrices->E_F5[j],
-                            &matrices->k_min_F5[j],
-                            &matrices->k_max_F5[j],
-                            &matrices->l_min_F5[j],
-                            &matrices->l_max_F5[j],
+      /* resize and move memory portions of energy matrix E_F3 */
+      adjustArrayBoundaries(matrices->arena,
+                            &matrices->E_F3[j],
+                            &matrices->k_min_F3[j],
+                            &matrices->k_max_F3[j],
+                            &matrices->l_min_F3[j],
+                            &matrices->l_max_F3[j],
                             min_k_real,
                             max_k_real,
                             min_l_real,
@@ -3270,6 +3299,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                       min_l,
                       max_l,
                       bpdist[my_iindx[i] - seq_length],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_M2[i],
                       &matrices->k_max_M2[i],
                       &matrices->l_min_M2[i],
@@ -3370,7 +3401,8 @@ mfe_circ(vrna_fold_compound_t *vc)
     }
 
     /* resize and move memory portions of energy matrix E_M2 */
-    adjustArrayBoundaries(&matrices->E_M2[i],
+    adjustArrayBoundaries(matrices->arena,
+                          &matrices->E_M2[i],
                           &matrices->k_min_M2[i],
                           &matrices->k_max_M2[i],
                           &matrices->l_min_M2[i],
@@ -3408,11 +3440,14 @@ mfe_circ(vrna_fold_compound_t *vc)
 #pragma omp section
     {
 #endif
+  /* no banding here, the open chain may lie outside the distance limits */
   prepareBoundaries(min_k,
                     max_k,
                     min_l,
                     max_l,
                     bpdist[my_iindx[1] - seq_length],
+                    max_k,
+                    max_l,
                     &matrices->k_min_Fc,
                     &matrices->k_max_Fc,
                     &matrices->l_min_Fc,
@@ -3436,6 +3471,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                     min_l,
                     max_l,
                     bpdist[my_iindx[1] - seq_length],
+                    maxD1,
+                    maxD2,
                     &matrices->k_min_FcH,
                     &matrices->k_max_FcH,
                     &matrices->l_min_FcH,
@@ -3457,6 +3494,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                     min_l,
                     max_l,
                     bpdist[my_iindx[1] - seq_length],
+                    maxD1,
+                    maxD2,
                     &matrices->k_min_FcI,
                     &matrices->k_max_FcI,
                     &matrices->l_min_FcI,
@@ -3478,6 +3517,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                     min_l,
                     max_l,
                     bpdist[my_iindx[1] - seq_length],
+                    maxD1,
+                    maxD2,
                     &matrices->k_min_FcM,
                     &matrices->k_max_FcM,
                     &matrices->l_min_FcM,
@@ -3610,7 +3651,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   /* end of i-j loop */
 
   /* resize and move memory portions of energy matrix E_FcH */
-  adjustArrayBoundaries(&matrices->E_FcH,
+  adjustArrayBoundaries(matrices->arena,
+                        &matrices->E_FcH,
                         &matrices->k_min_FcH,
                         &matrices->k_max_FcH,
                         &matrices->l_min_FcH,
@@ -3782,7 +3824,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   /* end of i-j loop */
 
   /* resize and move memory portions of energy matrix E_FcI */
-  adjustArrayBoundaries(&matrices->E_FcI,
+  adjustArrayBoundaries(matrices->arena,
+                        &matrices->E_FcI,
                         &matrices->k_min_FcI,
                         &matrices->k_max_FcI,
                         &matrices->l_min_FcI,
@@ -3878,7 +3921,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   }
 
   /* resize and move memory portions of energy matrix E_FcM */
-  adjustArrayBoundaries(&matrices->E_FcM,
+  adjustArrayBoundaries(matrices->arena,
+                        &matrices->E_FcM,
                         &matrices->k_min_FcM,
                         &matrices->k_max_FcM,
                         &matrices->l_min_FcM,
@@ -3957,7 +4001,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                             );
 
 
-  adjustArrayBoundaries(&matrices->E_Fc,
+  adjustArrayBoundaries(matrices->arena,
+                        &matrices->E_Fc,
                         &matrices->k_min_Fc,
                         &matrices->k_max_Fc,
                         &matrices->l_min_Fc,
@@ -3971,97 +4016,78 @@ mfe_circ(vrna_fold_compound_t *vc)
 
 
 PRIVATE void
-adjustArrayBoundaries(int ***array,
-                      int *k_min,
-                      int *k_max,
-                      int **l_min,
-                      int **l_max,
-                      int k_min_post,
-                      int k_max_post,
-                      int *l_min_post,
-                      int *l_max_post)
+adjustArrayBoundaries(vrna_mx_arena_t *arena,
+                      int             ***array,
+                      int             *k_min,
+                      int             *k_max,
+                      int             **l_min,
+                      int             **l_max,
+                      int             k_min_post,
+                      int             k_max_post,
+                      int             *l_min_post,
+                      int             *l_max_post)
 {
-  int cnt1;
-  int k_diff_pre  = k_min_post - *k_min;
-  int mem_size    = k_max_post - k_min_post + 1;
+  int     cnt1, k_size, mem_size, mem_size_pre, start, shift, cnt2;
+  int     **array_post, *l_min_arena, *l_max_arena, *row;
+  size_t  total;
 
   if (k_min_post < INF) {
-    /* free all the unused memory behind actual data */
-    for (cnt1 = k_max_post + 1; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
+    /*
+     *  move the actual data into a single contiguous block of the arena that
+     *  holds the offset table, the l-boundaries, and all rows of this cell
+     */
+    k_size  = k_max_post - k_min_post + 1;
+    total   = (size_t)k_size * (sizeof(int *) + 2 * sizeof(int));
+
+    for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++)
+      if (l_min_post[cnt1] < INF)
+        total += sizeof(int) * ((l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1);
+
+    array_post  = (int **)arena_alloc(arena, total);
+    l_min_arena = (int *)(array_post + k_size);
+    l_max_arena = l_min_arena + k_size;
+    row         = l_max_arena + k_size;
 
-    /* free unused memory before actual data */
-    for (cnt1 = *k_min; cnt1 < k_min_post; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    /* move data to front and thereby eliminating unused memory in front of actual data */
-    if (k_diff_pre > 0) {
-      memmove((int **)(*array), ((int **)(*array)) + k_diff_pre, sizeof(int *) * mem_size);
-      memmove((int *)(*l_min), ((int *)(*l_min)) + k_diff_pre, sizeof(int) * mem_size);
-      memmove((int *)(*l_max), ((int *)(*l_max)) + k_diff_pre, sizeof(int) * mem_size);
-    }
-
-    /* reallocating memory to actual size used */
-    *array  += *k_min;
-    *array  = (int **)realloc(*array, sizeof(int *) * mem_size);
-    *array  -= k_min_post;
-
-    *l_min  += *k_min;
-    *l_min  = (int *)realloc(*l_min, sizeof(int) * mem_size);
-    *l_min  -= k_min_post;
-
-    *l_max  += *k_min;
-    *l_max  = (int *)realloc(*l_max, sizeof(int) * mem_size);
-    *l_max  -= k_min_post;
-
-    /* adjust l dimension of array */
     for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++) {
-      if (l_min_post[cnt1] < INF) {
-        /* new memsize */
-        mem_size = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
-        /* reshift the pointer */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-
-        int shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
-        /* eliminate unused memory in front of actual data */
-        unsigned int start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
-        if (start > 0)
-          memmove((int *)((*array)[cnt1]), (int *)((*array)[cnt1]) + start, sizeof(int) * mem_size);
+      l_min_arena[cnt1 - k_min_post]  = l_min_post[cnt1];
+      l_max_arena[cnt1 - k_min_post]  = l_max_post[cnt1];
 
-        (*array)[cnt1] = (int *)realloc((*array)[cnt1], sizeof(int) * mem_size);
-
-        (*array)[cnt1] -= l_min_post[cnt1] / 2;
+      if (l_min_post[cnt1] < INF) {
+        mem_size      = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
+        mem_size_pre  = ((*l_max)[cnt1] - (*l_min)[cnt1] + 1) / 2 + 1;
+        shift         = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
+        /* skip unused memory in front of actual data */
+        start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
+
+        for (cnt2 = 0; (cnt2 < mem_size) && (start + cnt2 < mem_size_pre); cnt2++)
+          row[cnt2] = (*array)[cnt1][(*l_min)[cnt1] / 2 + start + cnt2];
+        for (; cnt2 < mem_size; cnt2++)
+          row[cnt2] = INF;
+
+        array_post[cnt1 - k_min_post] = row - l_min_post[cnt1] / 2;
+        row                           += mem_size;
       } else {
-        /* free according memory */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-        free((*array)[cnt1]);
+        array_post[cnt1 - k_min_post] = NULL;
       }
-
-      (*l_min)[cnt1]  = l_min_post[cnt1];
-      (*l_max)[cnt1]  = l_max_post[cnt1];
     }
+
+    releaseArray(*array, *k_min);
+    free(*l_min + *k_min);
+
+    *array  = array_post - k_min_post;
+    *l_min  = l_min_arena - k_min_post;
+    *l_max  = l_max_arena - k_min_post;
   } else {
-    /* we have to free all unused memory */
-    for (cnt1 = *k_min; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    (*l_min)  += *k_min;
-    (*l_max)  += *k_min;
-    free(*l_min);
-    free(*l_max);
-    (*array) += *k_min;
-    free(*array);
-    *array = NULL;
+    /* no data at all */
+    releaseArray(*array, *k_min);
+    free(*l_min + *k_min);
+
+    *array  = NULL;
+    *l_min  = NULL;
+    *l_max  = NULL;
   }
 
-  l_min_post  += *k_min;
-  l_max_post  += *k_min;
-  free(l_min_post);
-  free(l_max_post);
+  free(l_min_post + *k_min);
   *k_min  = k_min_post;
   *k_max  = k_max_post;
 }
@@ -4080,8 +4106,9 @@ preparePosteriorBoundaries(int  size,
   *min_k  = INF;
   *max_k  = 0;
 
-  *min_l  = (int *)vrna_alloc(sizeof(int) * size);
-  *max_l  = (int *)vrna_alloc(sizeof(int) * size);
+  /* min_l and max_l share the same memory block */
+  *min_l  = (int *)vrna_alloc(sizeof(int) * 2 * size);
+  *max_l  = *min_l + size;
 
   for (i = 0; i < size; i++) {
     (*min_l)[i] = INF;
@@ -4114,18 +4141,26 @@ prepareBoundaries(int min_k_pre,
                   int min_l_pre,
                   int max_l_pre,
                   int bpdist,
+                  int max_d1,
+                  int max_d2,
                   int *min_k,
                   int *max_k,
                   int **min_l,
                   int **max_l)
 {
   int cnt;
-  int mem = max_k_pre - min_k_pre + 1;
+  int mem;
+
+  /* (k,l) classes beyond the maximum distances are never stored */
+  max_k_pre = MIN2(max_k_pre, max_d1);
+  max_l_pre = MIN2(max_l_pre, max_d2);
+  mem       = max_k_pre - min_k_pre + 1;
 
   *min_k  = min_k_pre;
   *max_k  = max_k_pre;
-  *min_l  = (int *)vrna_alloc(sizeof(int) * mem);
-  *max_l  = (int *)vrna_alloc(sizeof(int) * mem);
+  /* min_l and max_l share the same memory block */
+  *min_l  = (int *)vrna_alloc(sizeof(int) * 2 * MAX2(mem, 1));
+  *max_l  = *min_l + MAX2(mem, 1);
 
   *min_l  -= min_k_pre;
   *max_l  -= min_k_pre;
@@ -4149,21 +4184,36 @@ prepareArray(int  ***array,
              int  *min_l,
              int  *max_l)
 {
-  int i, j, mem;
+  int     i, j, mem, *row;
+  size_t  total;
 
-  *array  = (int **)vrna_alloc(sizeof(int *) * (max_k - min_k + 1));
+  /* offset table and rows are stored in a single memory block */
+  total = 0;
+  for (i = min_k; i <= max_k; i++)
+    total += MAX2((max_l[i] - min_l[i] + 1) / 2 + 1, 0);
+
+  *array  = (int **)vrna_alloc(sizeof(int *) * MAX2(max_k - min_k + 1, 1) + sizeof(int) * total);
+  row     = (int *)(*array + MAX2(max_k - min_k + 1, 1));
   *array  -= min_k;
 
   for (i = min_k; i <= max_k; i++) {
-    mem         = (max_l[i] - min_l[i] + 1) / 2 + 1;
-    (*array)[i] = (int *)vrna_alloc(sizeof(int) * mem);
+    mem = MAX2((max_l[i] - min_l[i] + 1) / 2 + 1, 0);
     for (j = 0; j < mem; j++)
-      (*array)[i][j] = INF;
-    (*array)[i] -= min_l[i] / 2;
+      row[j] = INF;
+    (*array)[i] = row - min_l[i] / 2;
+    row         += mem;
   }
 }
 
 
+PRIVATE INLINE void
+releaseArray(int  **array,
+             int  min_k)
+{
+  free(array + min_k);
+}
+
+
 INLINE PRIVATE void
 prepareArray2(unsigned long ***array,
               int           min_k,
@@ -4346,7 +4396,7 @@ update_TwoDfold_params(TwoDfold_vars *vars)
 
   set_model_details(&md);
 
-  free(vars->compatibility->params);
+  vrna_params_free(vars->compatibility->params);
   vars->compatibility->params = vrna_params(&md);
 
   crosslink(vars);
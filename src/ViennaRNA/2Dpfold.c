@@ -26,6 +26,8 @@
 #include "ViennaRNA/eval/multibranch.h"
 #include "ViennaRNA/2Dpfold.h"
 
+#include "ViennaRNA/intern/arena.h"
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -118,15 +120,16 @@ backtrack_qcM(vrna_fold_compound_t  *vc,
 
 
 PRIVATE void
-adjustArrayBoundaries(FLT_OR_DBL  ***array,
-                      int         *k_min,
-                      int         *k_max,
-                      int         **l_min,
-                      int         **l_max,
-                      int         k_min_real,
-                      int         k_max_real,
-                      int         *l_min_real,
-                      int         *l_max_real);
+adjustArrayBoundaries(vrna_mx_arena_t *arena,
+                      FLT_OR_DBL      ***array,
+                      int             *k_min,
+                      int             *k_max,
+                      int             **l_min,
+                      int             **l_max,
+                      int             k_min_real,
+                      int             k_max_real,
+                      int             *l_min_real,
+                      int             *l_max_real);
 
 
 INLINE PRIVATE void
@@ -153,6 +156,8 @@ prepareBoundaries(int min_k_pre,
                   int min_l_pre,
                   int max_l_pre,
                   int bpdist,
+                  int max_d1,
+                  int max_d2,
                   int *min_k,
                   int *max_k,
                   int **min_l,
@@ -167,6 +172,11 @@ prepareArray(FLT_OR_DBL ***array,
              int        *max_l);
 
 
+PRIVATE INLINE void
+releaseArray(FLT_OR_DBL  **array,
+             int         min_k);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -436,12 +446,12 @@ pf2D_linear(vrna_fold_compound_t *vc)
       ij                        = my_iindx[i] - j;
       matrices->k_min_Q[ij]     = 0;
       matrices->k_max_Q[ij]     = 0;
-      matrices->l_min_Q[ij]     = (int *)vrna_alloc(sizeof(int));
-      matrices->l_max_Q[ij]     = (int *)vrna_alloc(sizeof(int));
+      matrices->l_min_Q[ij]     = (int *)arena_alloc(matrices->arena, sizeof(int));
+      matrices->l_max_Q[ij]     = (int *)arena_alloc(matrices->arena, sizeof(int));
       matrices->l_min_Q[ij][0]  = 0;
       matrices->l_max_Q[ij][0]  = 0;
-      matrices->Q[ij]           = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *));
-      matrices->Q[ij][0]        = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL));
+      matrices->Q[ij]           = (FLT_OR_DBL **)arena_alloc(matrices->arena, sizeof(FLT_OR_DBL *));
+      matrices->Q[ij][0]        = (FLT_OR_DBL *)arena_alloc(matrices->arena, sizeof(FLT_OR_DBL));
       matrices->Q[ij][0][0]     = 1.0 * scale[j - i + 1];
     }
 
@@ -482,6 +492,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
                             l_min_Q_B,
                             l_max_Q_B,
                             bpdist[ij],
+                            maxD1,
+                            maxD2,
                             &matrices->k_min_Q_B[ij],
                             &matrices->k_max_Q_B[ij],
                             &matrices->l_min_Q_B[ij],
@@ -696,7 +708,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
         }
 
         if (update_b) {
-          adjustArrayBoundaries(&matrices->Q_B[ij],
+          adjustArrayBoundaries(matrices->arena,
+                                &matrices->Q_B[ij],
                                 &matrices->k_min_Q_B[ij],
                                 &matrices->k_max_Q_B[ij],
                                 &matrices->l_min_Q_B[ij],
@@ -729,6 +742,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
                           l_min_Q_M,
                           l_max_Q_M,
                           bpdist[ij],
+                          maxD1,
+                          maxD2,
                           &matrices->k_min_Q_M[ij],
                           &matrices->k_max_Q_M[ij],
                           &matrices->l_min_Q_M[ij],
@@ -761,6 +776,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
                           l_min_Q_M1,
                           l_max_Q_M1,
                           bpdist[ij],
+                          maxD1,
+                          maxD2,
                           &matrices->k_min_Q_M1[jindx[j] + i],
                           &matrices->k_max_Q_M1[jindx[j] + i],
                           &matrices->l_min_Q_M1[jindx[j] + i],
@@ -1015,7 +1032,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_m) {
-        adjustArrayBoundaries(&matrices->Q_M[ij],
+        adjustArrayBoundaries(matrices->arena,
+                              &matrices->Q_M[ij],
                               &matrices->k_min_Q_M[ij],
                               &matrices->k_max_Q_M[ij],
                               &matrices->l_min_Q_M[ij],
@@ -1028,7 +1046,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_m1) {
-        adjustArrayBoundaries(&matrices->Q_M1[jindx[j] + i],
+        adjustArrayBoundaries(matrices->arena,
+                              &matrices->Q_M1[jindx[j] + i],
                               &matrices->k_min_Q_M1[jindx[j] + i],
                               &matrices->k_max_Q_M1[jindx[j] + i],
                               &matrices->l_min_Q_M1[jindx[j] + i],
@@ -1055,6 +1074,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
                           l_min,
                           l_max,
                           bpdist[ij],
+                          maxD1,
+                          maxD2,
                           &matrices->k_min_Q[ij],
                           &matrices->k_max_Q[ij],
                           &matrices->l_min_Q[ij],
@@ -1227,7 +1248,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_q) {
-        adjustArrayBoundaries(&matrices->Q[ij],
+        adjustArrayBoundaries(matrices->arena,
+                              &matrices->Q[ij],
                               &matrices->k_min_Q[ij],
                               &matrices->k_max_Q[ij],
                               &matrices->l_min_Q[ij],
@@ -1362,6 +1384,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
                         l_min_Q_M2,
                         l_max_Q_M2,
                         bpdist[my_iindx[k] - seq_length],
+                        maxD1,
+                        maxD2,
                         &matrices->k_min_Q_M2[k],
                         &matrices->k_max_Q_M2[k],
                         &matrices->l_min_Q_M2[k],
@@ -1449,7 +1473,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
       }
     }
     if (update_m2) {
-      adjustArrayBoundaries(&matrices->Q_M2[k],
+      adjustArrayBoundaries(matrices->arena,
+                            &matrices->Q_M2[k],
                             &matrices->k_min_Q_M2[k],
                             &matrices->k_max_Q_M2[k],
                             &matrices->l_min_Q_M2[k],
@@ -1497,6 +1522,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
                       min_l,
                       max_l,
                       bpdist[my_iindx[1] - seq_length],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_Q_c,
                       &matrices->k_max_Q_c,
                       &matrices->l_min_Q_c,
@@ -1531,6 +1558,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
                       min_l,
                       max_l,
                       bpdist[my_iindx[1] - seq_length],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_Q_cH,
                       &matrices->k_max_Q_cH,
                       &matrices->l_min_Q_cH,
@@ -1563,6 +1592,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
                       min_l,
                       max_l,
                       bpdist[my_iindx[1] - seq_length],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_Q_cI,
                       &matrices->k_max_Q_cI,
                       &matrices->l_min_Q_cI,
@@ -1595,6 +1626,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
                       min_l,
                       max_l,
                       bpdist[my_iindx[1] - seq_length],
+                      maxD1,
+                      maxD2,
                       &matrices->k_min_Q_cM,
                       &matrices->k_max_Q_cM,
                       &matrices->l_min_Q_cM,
@@ -1825,7 +1858,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
     }
 
   if (update_cH) {
-    adjustArrayBoundaries(&matrices->Q_cH,
+    adjustArrayBoundaries(matrices->arena,
+                          &matrices->Q_cH,
                           &matrices->k_min_Q_cH,
                           &matrices->k_max_Q_cH,
                           &matrices->l_min_Q_cH,
@@ -1838,7 +1872,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
   }
 
   if (update_cI) {
-    adjustArrayBoundaries(&matrices->Q_cI,
+    adjustArrayBoundaries(matrices->arena,
+                          &matrices->Q_cI,
                           &matrices->k_min_Q_cI,
                           &matrices->k_max_Q_cI,
                           &matrices->l_min_Q_cI,
@@ -1925,7 +1960,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
   }
 
   if (update_cM) {
-    adjustArrayBoundaries(&matrices->Q_cM,
+    adjustArrayBoundaries(matrices->arena,
+                          &matrices->Q_cM,
                           &matrices->k_min_Q_cM,
                           &matrices->k_max_Q_cM,
                           &matrices->l_min_Q_cM,
@@ -2009,7 +2045,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
     matrices->Q_c_rem += 1.0 * scale[seq_length];
   }
 
-  adjustArrayBoundaries(&matrices->Q_c,
+  adjustArrayBoundaries(matrices->arena,
+                        &matrices->Q_c,
                         &matrices->k_min_Q_c,
                         &matrices->k_max_Q_c,
                         &matrices->l_min_Q_c,
@@ -4254,103 +4291,81 @@ backtrack_qm_early_escape:
 
 
 PRIVATE void
-adjustArrayBoundaries(FLT_OR_DBL  ***array,
-                      int         *k_min,
-                      int         *k_max,
-                      int         **l_min,
-                      int         **l_max,
-                      int         k_min_post,
-                      int         k_max_post,
-                      int         *l_min_post,
-                      int         *l_max_post)
+adjustArrayBoundaries(vrna_mx_arena_t *arena,
+                      FLT_OR_DBL      ***array,
+                      int             *k_min,
+                      int             *k_max,
+                      int             **l_min,
+                      int             **l_max,
+                      int             k_min_post,
+                      int             k_max_post,
+                      int             *l_min_post,
+                      int             *l_max_post)
 {
-  int cnt1;
-  int k_diff_pre  = k_min_post - *k_min;
-  int mem_size    = k_max_post - k_min_post + 1;
+  int         cnt1, k_size, mem_size, mem_size_pre, start, shift, cnt2;
+  int         *l_min_arena, *l_max_arena;
+  FLT_OR_DBL  **array_post, *row;
+  size_t      total;
 
   if (k_min_post < INF) {
-    /* free all the unused memory behind actual data */
-    for (cnt1 = k_max_post + 1; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-
-    /* free unused memory before actual data */
-    for (cnt1 = *k_min; cnt1 < k_min_post; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    /* move data to front and thereby eliminating unused memory in front of actual data */
-    if (k_diff_pre > 0) {
-      memmove((FLT_OR_DBL **)(*array),
-              ((FLT_OR_DBL **)(*array)) + k_diff_pre,
-              sizeof(FLT_OR_DBL *) * mem_size);
-      memmove((int *)(*l_min), ((int *)(*l_min)) + k_diff_pre, sizeof(int) * mem_size);
-      memmove((int *)(*l_max), ((int *)(*l_max)) + k_diff_pre, sizeof(int) * mem_size);
-    }
-
-    /* reallocating memory to actual size used */
-    *array  += *k_min;
-    *array  = (FLT_OR_DBL **)realloc(*array, sizeof(FLT_OR_DBL *) * mem_size);
-    *array  -= k_min_post;
-
-    *l_min  += *k_min;
-    *l_min  = (int *)realloc(*l_min, sizeof(int) * mem_size);
-    *l_min  -= k_min_post;
-
-    *l_max  += *k_min;
-    *l_max  = (int *)realloc(*l_max, sizeof(int) * mem_size);
-    *l_max  -= k_min_post;
-
+    /*
+     *  move the actual data into a single contiguous block of the arena that
+     *  holds the offset table, the l-boundaries, and all rows of this cell
+     */
+    k_size  = k_max_post - k_min_post + 1;
+    total   = (size_t)k_size * (sizeof(int *) + 2 * sizeof(int));
+
+    for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++)
+      if (l_min_post[cnt1] < INF)
+        total += sizeof(FLT_OR_DBL) * ((l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1);
+
+    array_post  = (FLT_OR_DBL **)arena_alloc(arena, total);
+    l_min_arena = (int *)(array_post + k_size);
+    l_max_arena = l_min_arena + k_size;
+    row         = (FLT_OR_DBL *)(l_max_arena + k_size);
 
     for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++) {
-      if (l_min_post[cnt1] < INF) {
-        /* new memsize */
-        mem_size = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
-        /* reshift the pointer */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
+      l_min_arena[cnt1 - k_min_post]  = l_min_post[cnt1];
+      l_max_arena[cnt1 - k_min_post]  = l_max_post[cnt1];
 
-        int shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
-        /* eliminate unused memory in front of actual data */
-        unsigned int start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
-        if (start > 0)
-          memmove((FLT_OR_DBL *)((*array)[cnt1]), (FLT_OR_DBL *)((*array)[cnt1]) + start,
-                  sizeof(FLT_OR_DBL) * mem_size);
-
-        (*array)[cnt1] = (FLT_OR_DBL *)realloc((*array)[cnt1], sizeof(FLT_OR_DBL) * mem_size);
-
-        (*array)[cnt1] -= l_min_post[cnt1] / 2;
+      if (l_min_post[cnt1] < INF) {
+        mem_size      = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
+        mem_size_pre  = ((*l_max)[cnt1] - (*l_min)[cnt1] + 1) / 2 + 1;
+        shift         = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
+        /* skip unused memory in front of actual data */
+        start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
+
+        for (cnt2 = 0; (cnt2 < mem_size) && (start + cnt2 < mem_size_pre); cnt2++)
+          row[cnt2] = (*array)[cnt1][(*l_min)[cnt1] / 2 + start + cnt2];
+        for (; cnt2 < mem_size; cnt2++)
+          row[cnt2] = 0.;
+
+        array_post[cnt1 - k_min_post] = row - l_min_post[cnt1] / 2;
+        row                           += mem_size;
       } else {
-        /* free according memory */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-        free((*array)[cnt1]);
+        array_post[cnt1 - k_min_post] = NULL;
       }
-
-      (*l_min)[cnt1]  = l_min_post[cnt1];
-      (*l_max)[cnt1]  = l_max_post[cnt1];
     }
+
+    releaseArray(*array, *k_min);
+    free(*l_min + *k_min);
+
+    *array  = array_post - k_min_post;
+    *l_min  = l_min_arena - k_min_post;
+    *l_max  = l_max_arena - k_min_post;
   } else {
-    /* we have to free all unused memory */
-    for (cnt1 = *k_min; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    (*l_min)  += *k_min;
-    (*l_max)  += *k_min;
-    free(*l_min);
-    free(*l_max);
-    (*array) += *k_min;
-    free(*array);
-    *array = NULL;
-  }
+    /* no data at all */
+    releaseArray(*array, *k_min);
+    free(*l_min + *k_min);
 
-  l_min_post  += *k_min;
-  l_max_post  += *k_min;
-  *k_min      = k_min_post;
-  *k_max      = k_max_post;
+    *array  = NULL;
+    *l_min  = NULL;
+    *l_max  = NULL;
+  }
 
-  free(l_min_post);
-  free(l_max_post);
+  free(l_min_post + *k_min);
+  *k_min  = k_min_post;
+  *k_max  = k_max_post;
 }
 
 
@@ -4367,8 +4382,9 @@ preparePosteriorBoundaries(int  size,
   *min_k  = INF;
   *max_k  = 0;
 
-  *min_l  = (int *)vrna_alloc(sizeof(int) * size);
-  *max_l  = (int *)vrna_alloc(sizeof(int) * size);
+  /* min_l and max_l share the same memory block */
+  *min_l  = (int *)vrna_alloc(sizeof(int) * 2 * size);
+  *max_l  = *min_l + size;
 
   for (i = 0; i < size; i++) {
     (*min_l)[i] = INF;
@@ -4395,24 +4411,32 @@ updatePosteriorBoundaries(int d1,
 }
 
 
-PRIVATE INLINE void
+INLINE PRIVATE void
 prepareBoundaries(int min_k_pre,
                   int max_k_pre,
                   int min_l_pre,
                   int max_l_pre,
                   int bpdist,
+                  int max_d1,
+                  int max_d2,
                   int *min_k,
                   int *max_k,
                   int **min_l,
                   int **max_l)
 {
   int cnt;
-  int mem = max_k_pre - min_k_pre + 1;
+  int mem;
+
+  /* (k,l) classes beyond the maximum distances are never stored */
+  max_k_pre = MIN2(max_k_pre, max_d1);
+  max_l_pre = MIN2(max_l_pre, max_d2);
+  mem       = max_k_pre - min_k_pre + 1;
 
   *min_k  = min_k_pre;
   *max_k  = max_k_pre;
-  *min_l  = (int *)vrna_alloc(sizeof(int) * mem);
-  *max_l  = (int *)vrna_alloc(sizeof(int) * mem);
+  /* min_l and max_l share the same memory block */
+  *min_l  = (int *)vrna_alloc(sizeof(int) * 2 * MAX2(mem, 1));
+  *max_l  = *min_l + MAX2(mem, 1);
 
   *min_l  -= min_k_pre;
   *max_l  -= min_k_pre;
@@ -4429,26 +4453,43 @@ prepareBoundaries(int min_k_pre,
 }
 
 
-PRIVATE INLINE void
+INLINE PRIVATE void
 prepareArray(FLT_OR_DBL ***array,
              int        min_k,
              int        max_k,
              int        *min_l,
              int        *max_l)
 {
-  int i, mem;
-
-  *array  = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (max_k - min_k + 1));
+  int         i, mem;
+  size_t      total;
+  FLT_OR_DBL  *row;
+
+  /* offset table and rows are stored in a single memory block */
+  total = 0;
+  for (i = min_k; i <= max_k; i++)
+    total += MAX2((max_l[i] - min_l[i] + 1) / 2 + 1, 0);
+
+  *array  = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * MAX2(max_k - min_k + 1, 1) +
+                                     sizeof(FLT_OR_DBL) * total);
+  row     = (FLT_OR_DBL *)(*array + MAX2(max_k - min_k + 1, 1));
   *array  -= min_k;
 
   for (i = min_k; i <= max_k; i++) {
-    mem         = (max_l[i] - min_l[i] + 1) / 2 + 1;
-    (*array)[i] = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * mem);
-    (*array)[i] -= min_l[i] / 2;
+    mem         = MAX2((max_l[i] - min_l[i] + 1) / 2 + 1, 0);
+    (*array)[i] = row - min_l[i] / 2;
+    row         += mem;
   }
 }
 
 
+PRIVATE INLINE void
+releaseArray(FLT_OR_DBL  **array,
+             int         min_k)
+{
+  free(array + min_k);
+}
+
+
 /*
  #################################
  # DEPRECATED FUNCTIONS BELOW    #
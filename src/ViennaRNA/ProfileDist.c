@@ -19,12 +19,21 @@
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/profiledist.h"
+#include "ViennaRNA/structures/edit_distance.h"
 
-PRIVATE int *alignment[2];
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/edit_distance_dat.h"
 
 PRIVATE void
-sprint_aligned_bppm(const float *T1,
-                    const float *T2);
+sprint_aligned_bppm(vrna_edit_dist_t  *ctx,
+                    int               *alignment[2],
+                    const float       *T1,
+                    const float       *T2);
 
 
 PRIVATE double
@@ -42,134 +51,175 @@ average(double  x,
 /*---------------------------------------------------------------------------*/
 
 PUBLIC float
-profile_edit_distance(const float *T1,
-                      const float *T2)
+vrna_profile_edit_distance(vrna_edit_dist_t *ctx,
+                           const float      *T1,
+                           const float      *T2)
 {
   /* align the 2 probability profiles T1, T2 */
   /* This is like a Needleman-Wunsch alignment,
    * we should really use affine gap-costs ala Gotoh */
 
-  float **distance;
-  short **i_point, **j_point;
+  float   *distance, *prev, *cur;
+  short   *i_point, *j_point;
+  int     *alignment[2];
+  int     i, j, i1, j1, pos, length1, length2, cols;
+  float   minus, plus, change, temp;
+  size_t  cells;
+
+  if ((!ctx) || (!T1) || (!T2))
+    return (float)INF;
+
+  length1 = (int)T1[0];
+  length2 = (int)T2[0];
+  cols    = length2 + 1;
+
+  if (!(ctx->options & VRNA_EDIT_DIST_BACKTRACK)) {
+    /* without backtracking, two rows of the alignment matrix suffice */
+    ctx->fbuf = (float *)edit_dist_buffer(ctx->fbuf,
+                                          &(ctx->fbuf_size),
+                                          2 * (size_t)cols,
+                                          sizeof(float));
+    prev    = ctx->fbuf;
+    cur     = ctx->fbuf + cols;
+    prev[0] = 0.;
+
+    for (j = 1; j <= length2; j++)
+      prev[j] = prev[j - 1] + PrfEditCost(0, j, T1, T2);
+
+    for (i = 1; i <= length1; i++) {
+      cur[0] = prev[0] + PrfEditCost(i, 0, T1, T2);
+
+      for (j = 1; j <= length2; j++) {
+        minus   = prev[j] + PrfEditCost(i, 0, T1, T2);
+        plus    = cur[j - 1] + PrfEditCost(0, j, T1, T2);
+        change  = prev[j - 1] + PrfEditCost(i, j, T1, T2);
+
+        cur[j] = MIN3(minus, plus, change);
+      }
 
-  int   i, j, i1, j1, pos, length1, length2;
-  float minus, plus, change, temp;
+      distance  = prev;
+      prev      = cur;
+      cur       = distance;
+    }
 
-  i_point   = NULL;
-  j_point   = NULL;
-  length1   = (int)T1[0];
-  length2   = (int)T2[0];
-  distance  = (float **)vrna_alloc((length1 + 1) * sizeof(float *));
-  if (edit_backtrack) {
-    i_point = (short **)vrna_alloc((length1 + 1) * sizeof(short *));
-    j_point = (short **)vrna_alloc((length1 + 1) * sizeof(short *));
+    return prev[length2];
   }
 
-  for (i = 0; i <= length1; i++) {
-    distance[i] = (float *)vrna_alloc((length2 + 1) * sizeof(float));
-    if (edit_backtrack) {
-      i_point[i]  = (short *)vrna_alloc((length2 + 1) * sizeof(short));
-      j_point[i]  = (short *)vrna_alloc((length2 + 1) * sizeof(short));
-    }
-  }
+  cells     = (size_t)(length1 + 1) * (size_t)cols;
+  ctx->fbuf = (float *)edit_dist_buffer(ctx->fbuf,
+                                        &(ctx->fbuf_size),
+                                        cells,
+                                        sizeof(float));
+  ctx->sbuf = (short *)edit_dist_buffer(ctx->sbuf,
+                                        &(ctx->sbuf_size),
+                                        2 * cells,
+                                        sizeof(short));
+  ctx->ibuf = (int *)edit_dist_buffer(ctx->ibuf,
+                                      &(ctx->ibuf_size),
+                                      2 * (size_t)(length1 + length2 + 1),
+                                      sizeof(int));
+
+  distance      = ctx->fbuf;
+  i_point       = ctx->sbuf;
+  j_point       = ctx->sbuf + cells;
+  alignment[0]  = ctx->ibuf;
+  alignment[1]  = ctx->ibuf + length1 + length2 + 1;
+
+  distance[0] = 0.;
+  i_point[0]  = j_point[0] = 0;
 
   for (i = 1; i <= length1; i++) {
-    distance[i][0] = distance[i - 1][0] + PrfEditCost(i, 0, T1, T2);
-    if (edit_backtrack) {
-      i_point[i][0] = (short)i - 1;
-      j_point[i][0] = 0;
-    }
+    distance[i * cols]  = distance[(i - 1) * cols] + PrfEditCost(i, 0, T1, T2);
+    i_point[i * cols]   = (short)i - 1;
+    j_point[i * cols]   = 0;
   }
   for (j = 1; j <= length2; j++) {
-    distance[0][j] = distance[0][j - 1] + PrfEditCost(0, j, T1, T2);
-    if (edit_backtrack) {
-      i_point[0][j] = 0;
-      j_point[0][j] = (short)j - 1;
-    }
+    distance[j] = distance[j - 1] + PrfEditCost(0, j, T1, T2);
+    i_point[j]  = 0;
+    j_point[j]  = (short)j - 1;
   }
   for (i = 1; i <= length1; i++) {
     for (j = 1; j <= length2; j++) {
-      minus   = distance[i - 1][j] + PrfEditCost(i, 0, T1, T2);
-      plus    = distance[i][j - 1] + PrfEditCost(0, j, T1, T2);
-      change  = distance[i - 1][j - 1] + PrfEditCost(i, j, T1, T2);
-
-      distance[i][j] = MIN3(minus, plus, change);
-      /* printf("%g ", distance[i][j]); */
-
-      if (edit_backtrack) {
-        if (distance[i][j] == change) {
-          i_point[i][j] = (short)i - 1;
-          j_point[i][j] = (short)j - 1;
-        } else if (distance[i][j] == plus) {
-          i_point[i][j] = (short)i;
-          j_point[i][j] = (short)j - 1;
-        } else {
-          i_point[i][j] = (short)i - 1;
-          j_point[i][j] = (short)j;
-        }
+      minus   = distance[(i - 1) * cols + j] + PrfEditCost(i, 0, T1, T2);
+      plus    = distance[i * cols + j - 1] + PrfEditCost(0, j, T1, T2);
+      change  = distance[(i - 1) * cols + j - 1] + PrfEditCost(i, j, T1, T2);
+
+      distance[i * cols + j] = MIN3(minus, plus, change);
+
+      if (distance[i * cols + j] == change) {
+        i_point[i * cols + j] = (short)i - 1;
+        j_point[i * cols + j] = (short)j - 1;
+      } else if (distance[i * cols + j] == plus) {
+        i_point[i * cols + j] = (short)i;
+        j_point[i * cols + j] = (short)j - 1;
+      } else {
+        i_point[i * cols + j] = (short)i - 1;
+        j_point[i * cols + j] = (short)j;
       }
     }
-    /* printf("\n"); */
   }
-  /* printf("\n"); */
-  temp = distance[length1][length2];
-  for (i = 0; i <= length1; i++)
-    free(distance[i]);
-  free(distance);
-
-  if (edit_backtrack) {
-    alignment[0]  = (int *)vrna_alloc((length1 + length2 + 1) * sizeof(int));
-    alignment[1]  = (int *)vrna_alloc((length1 + length2 + 1) * sizeof(int));
-
-    pos = length1 + length2;
-    i   = length1;
-    j   = length2;
-    while ((i > 0) || (j > 0)) {
-      i1  = i_point[i][j];
-      j1  = j_point[i][j];
-      if (((i - i1) == 1) && ((j - j1) == 1)) {
-        /* substitution    */
-        alignment[0][pos] = i;
-        alignment[1][pos] = j;
-      }
-
-      if (((i - i1) == 1) && (j == j1)) {
-        /* Deletion in [1] */
-        alignment[0][pos] = i;
-        alignment[1][pos] = 0;
-      }
-
-      if ((i == i1) && ((j - j1) == 1)) {
-        /* Deletion in [0] */
-        alignment[0][pos] = 0;
-        alignment[1][pos] = j;
-      }
-
-      pos--;
-      i = i1;
-      j = j1;
+  temp = distance[length1 * cols + length2];
+
+  pos = length1 + length2;
+  i   = length1;
+  j   = length2;
+  while ((i > 0) || (j > 0)) {
+    i1  = i_point[i * cols + j];
+    j1  = j_point[i * cols + j];
+    if (((i - i1) == 1) && ((j - j1) == 1)) {
+      /* substitution    */
+      alignment[0][pos] = i;
+      alignment[1][pos] = j;
     }
-    for (i = pos + 1; i <= length1 + length2; i++) {
-      alignment[0][i - pos] = alignment[0][i];
-      alignment[1][i - pos] = alignment[1][i];
+
+    if (((i - i1) == 1) && (j == j1)) {
+      /* Deletion in [1] */
+      alignment[0][pos] = i;
+      alignment[1][pos] = 0;
     }
-    alignment[0][0] = length1 + length2 - pos;   /* length of alignment */
 
-    for (i = 0; i <= length1; i++) {
-      free(i_point[i]);
-      free(j_point[i]);
+    if ((i == i1) && ((j - j1) == 1)) {
+      /* Deletion in [0] */
+      alignment[0][pos] = 0;
+      alignment[1][pos] = j;
     }
-    free(i_point);
-    free(j_point);
-    sprint_aligned_bppm(T1, T2);
-    free(alignment[0]);
-    free(alignment[1]);
+
+    pos--;
+    i = i1;
+    j = j1;
+  }
+  for (i = pos + 1; i <= length1 + length2; i++) {
+    alignment[0][i - pos] = alignment[0][i];
+    alignment[1][i - pos] = alignment[1][i];
   }
+  alignment[0][0] = length1 + length2 - pos;   /* length of alignment */
+
+  sprint_aligned_bppm(ctx, alignment, T1, T2);
 
   return temp;
 }
 
 
+PUBLIC float
+profile_edit_distance(const float *T1,
+                      const float *T2)
+{
+  float             dist;
+  vrna_edit_dist_t  *ctx;
+
+  ctx = vrna_edit_dist_init((edit_backtrack) ? VRNA_EDIT_DIST_BACKTRACK : 0);
+
+  dist = vrna_profile_edit_distance(ctx, T1, T2);
+
+  if (edit_backtrack)
+    edit_dist_export_aligned_lines(ctx);
+
+  vrna_edit_dist_free(ctx);
+
+  return dist;
+}
+
+
 /*---------------------------------------------------------------------------*/
 
 PRIVATE double
@@ -259,25 +309,30 @@ Make_bp_profile_bppm(FLT_OR_DBL *bppm,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-sprint_aligned_bppm(const float *T1,
-                    const float *T2)
+sprint_aligned_bppm(vrna_edit_dist_t  *ctx,
+                    int               *alignment[2],
+                    const float       *T1,
+                    const float       *T2)
 {
-  int i, length;
+  int   i, length;
+  char  *a0, *a1;
 
-  length          = alignment[0][0];
-  aligned_line[0] = (char *)vrna_alloc((length + 1) * sizeof(char));
-  aligned_line[1] = (char *)vrna_alloc((length + 1) * sizeof(char));
+  length  = alignment[0][0];
+  a0      = (char *)vrna_alloc((length + 1) * sizeof(char));
+  a1      = (char *)vrna_alloc((length + 1) * sizeof(char));
   for (i = 1; i <= length; i++) {
     if (alignment[0][i] == 0)
-      aligned_line[0][i - 1] = '_';
+      a0[i - 1] = '_';
     else
-      aligned_line[0][i - 1] = vrna_bpp_symbol(T1 + alignment[0][i] * 3);
+      a0[i - 1] = vrna_bpp_symbol(T1 + alignment[0][i] * 3);
 
     if (alignment[1][i] == 0)
-      aligned_line[1][i - 1] = '_';
+      a1[i - 1] = '_';
     else
-      aligned_line[1][i - 1] = vrna_bpp_symbol(T2 + alignment[1][i] * 3);
+      a1[i - 1] = vrna_bpp_symbol(T2 + alignment[1][i] * 3);
   }
+
+  edit_dist_aligned_lines(ctx, a0, a1);
 }
 
 
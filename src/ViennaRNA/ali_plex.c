@@ -227,7 +227,7 @@ aliduplexfold(const char  *s1[],
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -527,7 +527,7 @@ aliLduplexfold(const char *s1[],
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1080,7 +1080,7 @@ aliduplexfold_XS(const char *s1[],
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1400,7 +1400,7 @@ aliLduplexfold_XS(const char  *s1[],
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2002,7 +2002,7 @@ update_dfold_params(void)
   vrna_md_t md;
 
   if (P)
-    free(P);
+    vrna_params_free(P);
 
   set_model_details(&md);
   P = vrna_params(&md);
@@ -260,7 +260,7 @@ duplexfold_CXS(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -576,7 +576,7 @@ Lduplexfold_CXS(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1049,7 +1049,7 @@ duplexfold_C(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1346,7 +1346,7 @@ Lduplexfold_C(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1733,7 +1733,7 @@ update_dfold_params(void)
   vrna_md_t md;
 
   if (P)
-    free(P);
+    vrna_params_free(P);
 
   set_model_details(&md);
   P = vrna_params(&md);
@@ -82,6 +82,10 @@ PRIVATE void
 hc_reset_to_default(vrna_fold_compound_t *vc);
 
 
+PRIVATE INLINE void
+hc_init_on_demand(vrna_fold_compound_t *fc);
+
+
 PRIVATE void
 hc_update_up(vrna_fold_compound_t *vc);
 
@@ -269,6 +273,10 @@ vrna_hc_prepare(vrna_fold_compound_t  *fc,
       if ((!fc->hc) || (fc->hc->type != VRNA_HC_WINDOW) || (!fc->hc->matrix_local))
         vrna_hc_init_window(fc);
     } else {
+      /* fold compounds of the beam search engine come without hard constraints */
+      if (!fc->hc)
+        vrna_hc_init(fc);
+
       if (fc->hc->state & STATE_UNINITIALIZED) {
         default_hc_up(fc, options);
         default_hc_bp(fc, options);
@@ -310,6 +318,8 @@ vrna_hc_add_up_strand(vrna_fold_compound_t  *fc,
   unsigned int  strand, n_i;
   int           ret = 0;
 
+  hc_init_on_demand(fc);
+
   if ((fc) &&
       (fc->hc) &&
       (strand_indicator < (int)fc->strands) &&
@@ -354,6 +364,8 @@ vrna_hc_add_up_batch(vrna_fold_compound_t *fc,
 
   ret = 0; /* failure */
 
+  hc_init_on_demand(fc);
+
   if ((fc) &&
       (constraints)) {
     if (fc->hc) {
@@ -397,6 +409,8 @@ vrna_hc_add_up_strand_batch(vrna_fold_compound_t  *fc,
 
   ret = 0; /* failure */
 
+  hc_init_on_demand(fc);
+
   if ((fc) &&
       (constraints)) {
     if (fc->hc) {
@@ -442,6 +456,8 @@ vrna_hc_add_bp_nonspecific(vrna_fold_compound_t *vc,
   unsigned int  strand, actual_i, *sn, *ss;
   vrna_hc_t     *hc;
 
+  hc_init_on_demand(vc);
+
   if (vc) {
     if (vc->hc) {
       if ((i <= 0) || (i > vc->length)) {
@@ -481,6 +497,8 @@ vrna_hc_add_bp_strand(vrna_fold_compound_t  *fc,
 
   ret = 0;
 
+  hc_init_on_demand(fc);
+
   if ((fc) &&
       (fc->hc) &&
       (strand_i < (int)fc->strands) &&
@@ -547,6 +565,8 @@ vrna_hc_add_bp(vrna_fold_compound_t *vc,
 
   ret = 0;
 
+  hc_init_on_demand(vc);
+
   if (vc) {
     sn  = vc->strand_number;
     ss  = vc->strand_start;
@@ -1022,6 +1042,7 @@ prepare_hc_bp(vrna_fold_compound_t  *fc,
 
             /* is the ptype reset actually required??? */
             if ((fc->type == VRNA_FC_TYPE_SINGLE) &&
+                (fc->ptype) &&
                 (option & VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS)) {
               /* reset ptype in case (i,j) is a non-canonical pair */
               if (fc->ptype[idx[j] + i] == 0)
@@ -1735,6 +1756,17 @@ hc_reset_to_default(vrna_fold_compound_t *vc)
 }
 
 
+/* fold compounds of the beam search engine only get hard constraints once they are requested */
+PRIVATE INLINE void
+hc_init_on_demand(vrna_fold_compound_t *fc)
+{
+  if ((fc) &&
+      (!fc->hc) &&
+      (fc->engine & VRNA_OPTION_BEAM))
+    vrna_hc_init(fc);
+}
+
+
 PRIVATE void
 hc_update_up(vrna_fold_compound_t *vc)
 {
@@ -28,6 +28,8 @@
 #include "ViennaRNA/mfe/gquad.h"
 #include "ViennaRNA/datastructures/dp_matrices.h"
 
+#include "ViennaRNA/intern/arena.h"
+
 /*
  #################################
  # PRIVATE MACROS                #
@@ -215,6 +217,11 @@ vrna_mx_pf_free(vrna_fold_compound_t *vc)
 {
   if (vc) {
     vrna_mx_pf_t *self = vc->exp_matrices;
+
+    /* probabilities of the beam search engine */
+    free(vc->beam_probs);
+    vc->beam_probs = NULL;
+
     if (self) {
       switch (self->type) {
         case VRNA_MX_DEFAULT:
@@ -633,14 +640,20 @@ mfe_matrices_free_window(vrna_mx_mfe_t  *self,
 
 PRIVATE void
 mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
-                         unsigned int   length,
-                         int            turn,
-                         int            *indx)
+                         unsigned int   length VRNA_UNUSED,
+                         int            turn VRNA_UNUSED,
+                         int            *indx VRNA_UNUSED)
 {
+#ifdef COUNT_STATES
   unsigned int  i, j, ij;
   int           cnt1;
+#endif
 
-  /* This will be some fun... */
+  /*
+   *  All (k,l) entries and boundaries of the individual cells live in
+   *  the memory arena, so we only need to release the cell pointers.
+   *  The state counts, however, are still allocated separately.
+   */
 #ifdef COUNT_STATES
   if (self->N_F5 != NULL) {
     for (i = 1; i <= length; i++) {
@@ -663,60 +676,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 #endif
 
-  if (self->E_F5 != NULL) {
-    for (i = 1; i <= length; i++) {
-      if (!self->E_F5[i])
-        continue;
-
-      for (cnt1 = self->k_min_F5[i]; cnt1 <= self->k_max_F5[i]; cnt1++)
-        if (self->l_min_F5[i][cnt1] < INF) {
-          self->E_F5[i][cnt1] += self->l_min_F5[i][cnt1] / 2;
-          free(self->E_F5[i][cnt1]);
-        }
-
-      if (self->k_min_F5[i] < INF) {
-        self->E_F5[i] += self->k_min_F5[i];
-        free(self->E_F5[i]);
-        self->l_min_F5[i] += self->k_min_F5[i];
-        self->l_max_F5[i] += self->k_min_F5[i];
-        free(self->l_min_F5[i]);
-        free(self->l_max_F5[i]);
-      }
-    }
-    free(self->E_F5);
-    free(self->l_min_F5);
-    free(self->l_max_F5);
-    free(self->k_min_F5);
-    free(self->k_max_F5);
-  }
-
-  if (self->E_F3 != NULL) {
-    for (i = 1; i <= length; i++) {
-      if (!self->E_F3[i])
-        continue;
-
-      for (cnt1 = self->k_min_F3[i]; cnt1 <= self->k_max_F3[i]; cnt1++)
-        if (self->l_min_F3[i][cnt1] < INF) {
-          self->E_F3[i][cnt1] += self->l_min_F3[i][cnt1] / 2;
-          free(self->E_F3[i][cnt1]);
-        }
-
-      if (self->k_min_F3[i] < INF) {
-        self->E_F3[i] += self->k_min_F3[i];
-        free(self->E_F3[i]);
-        self->l_min_F3[i] += self->k_min_F3[i];
-        self->l_max_F3[i] += self->k_min_F3[i];
-        free(self->l_min_F3[i]);
-        free(self->l_max_F3[i]);
-      }
-    }
-    free(self->E_F3);
-    free(self->l_min_F3);
-    free(self->l_max_F3);
-    free(self->k_min_F3);
-    free(self->k_max_F3);
-  }
-
 #ifdef COUNT_STATES
   if (self->N_C != NULL) {
     for (i = 1; i < length; i++) {
@@ -742,36 +701,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 #endif
 
-  if (self->E_C != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_C[ij])
-          continue;
-
-        for (cnt1 = self->k_min_C[ij]; cnt1 <= self->k_max_C[ij]; cnt1++)
-          if (self->l_min_C[ij][cnt1] < INF) {
-            self->E_C[ij][cnt1] += self->l_min_C[ij][cnt1] / 2;
-            free(self->E_C[ij][cnt1]);
-          }
-
-        if (self->k_min_C[ij] < INF) {
-          self->E_C[ij] += self->k_min_C[ij];
-          free(self->E_C[ij]);
-          self->l_min_C[ij] += self->k_min_C[ij];
-          self->l_max_C[ij] += self->k_min_C[ij];
-          free(self->l_min_C[ij]);
-          free(self->l_max_C[ij]);
-        }
-      }
-    }
-    free(self->E_C);
-    free(self->l_min_C);
-    free(self->l_max_C);
-    free(self->k_min_C);
-    free(self->k_max_C);
-  }
-
 #ifdef COUNT_STATES
   if (self->N_M != NULL) {
     for (i = 1; i < length; i++) {
@@ -797,36 +726,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 #endif
 
-  if (self->E_M != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_M[ij])
-          continue;
-
-        for (cnt1 = self->k_min_M[ij]; cnt1 <= self->k_max_M[ij]; cnt1++)
-          if (self->l_min_M[ij][cnt1] < INF) {
-            self->E_M[ij][cnt1] += self->l_min_M[ij][cnt1] / 2;
-            free(self->E_M[ij][cnt1]);
-          }
-
-        if (self->k_min_M[ij] < INF) {
-          self->E_M[ij] += self->k_min_M[ij];
-          free(self->E_M[ij]);
-          self->l_min_M[ij] += self->k_min_M[ij];
-          self->l_max_M[ij] += self->k_min_M[ij];
-          free(self->l_min_M[ij]);
-          free(self->l_max_M[ij]);
-        }
-      }
-    }
-    free(self->E_M);
-    free(self->l_min_M);
-    free(self->l_max_M);
-    free(self->k_min_M);
-    free(self->k_max_M);
-  }
-
 #ifdef COUNT_STATES
   if (self->N_M1 != NULL) {
     for (i = 1; i < length; i++) {
@@ -852,130 +751,41 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 #endif
 
-  if (self->E_M1 != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_M1[ij])
-          continue;
-
-        for (cnt1 = self->k_min_M1[ij]; cnt1 <= self->k_max_M1[ij]; cnt1++)
-          if (self->l_min_M1[ij][cnt1] < INF) {
-            self->E_M1[ij][cnt1] += self->l_min_M1[ij][cnt1] / 2;
-            free(self->E_M1[ij][cnt1]);
-          }
-
-        if (self->k_min_M1[ij] < INF) {
-          self->E_M1[ij] += self->k_min_M1[ij];
-          free(self->E_M1[ij]);
-          self->l_min_M1[ij]  += self->k_min_M1[ij];
-          self->l_max_M1[ij]  += self->k_min_M1[ij];
-          free(self->l_min_M1[ij]);
-          free(self->l_max_M1[ij]);
-        }
-      }
-    }
-    free(self->E_M1);
-    free(self->l_min_M1);
-    free(self->l_max_M1);
-    free(self->k_min_M1);
-    free(self->k_max_M1);
-  }
-
-  if (self->E_M2 != NULL) {
-    for (i = 1; i < length - turn - 1; i++) {
-      if (!self->E_M2[i])
-        continue;
-
-      for (cnt1 = self->k_min_M2[i]; cnt1 <= self->k_max_M2[i]; cnt1++)
-        if (self->l_min_M2[i][cnt1] < INF) {
-          self->E_M2[i][cnt1] += self->l_min_M2[i][cnt1] / 2;
-          free(self->E_M2[i][cnt1]);
-        }
-
-      if (self->k_min_M2[i] < INF) {
-        self->E_M2[i] += self->k_min_M2[i];
-        free(self->E_M2[i]);
-        self->l_min_M2[i] += self->k_min_M2[i];
-        self->l_max_M2[i] += self->k_min_M2[i];
-        free(self->l_min_M2[i]);
-        free(self->l_max_M2[i]);
-      }
-    }
-    free(self->E_M2);
-    free(self->l_min_M2);
-    free(self->l_max_M2);
-    free(self->k_min_M2);
-    free(self->k_max_M2);
-  }
-
-  if (self->E_Fc != NULL) {
-    for (cnt1 = self->k_min_Fc; cnt1 <= self->k_max_Fc; cnt1++)
-      if (self->l_min_Fc[cnt1] < INF) {
-        self->E_Fc[cnt1] += self->l_min_Fc[cnt1] / 2;
-        free(self->E_Fc[cnt1]);
-      }
-
-    if (self->k_min_Fc < INF) {
-      self->E_Fc += self->k_min_Fc;
-      free(self->E_Fc);
-      self->l_min_Fc  += self->k_min_Fc;
-      self->l_max_Fc  += self->k_min_Fc;
-      free(self->l_min_Fc);
-      free(self->l_max_Fc);
-    }
-  }
-
-  if (self->E_FcI != NULL) {
-    for (cnt1 = self->k_min_FcI; cnt1 <= self->k_max_FcI; cnt1++)
-      if (self->l_min_FcI[cnt1] < INF) {
-        self->E_FcI[cnt1] += self->l_min_FcI[cnt1] / 2;
-        free(self->E_FcI[cnt1]);
-      }
-
-    if (self->k_min_FcI < INF) {
-      self->E_FcI += self->k_min_FcI;
-      free(self->E_FcI);
-      self->l_min_FcI += self->k_min_FcI;
-      self->l_max_FcI += self->k_min_FcI;
-      free(self->l_min_FcI);
-      free(self->l_max_FcI);
-    }
-  }
-
-  if (self->E_FcH != NULL) {
-    for (cnt1 = self->k_min_FcH; cnt1 <= self->k_max_FcH; cnt1++)
-      if (self->l_min_FcH[cnt1] < INF) {
-        self->E_FcH[cnt1] += self->l_min_FcH[cnt1] / 2;
-        free(self->E_FcH[cnt1]);
-      }
-
-    if (self->k_min_FcH < INF) {
-      self->E_FcH += self->k_min_FcH;
-      free(self->E_FcH);
-      self->l_min_FcH += self->k_min_FcH;
-      self->l_max_FcH += self->k_min_FcH;
-      free(self->l_min_FcH);
-      free(self->l_max_FcH);
-    }
-  }
-
-  if (self->E_FcM != NULL) {
-    for (cnt1 = self->k_min_FcM; cnt1 <= self->k_max_FcM; cnt1++)
-      if (self->l_min_FcM[cnt1] < INF) {
-        self->E_FcM[cnt1] += self->l_min_FcM[cnt1] / 2;
-        free(self->E_FcM[cnt1]);
-      }
-
-    if (self->k_min_FcM < INF) {
-      self->E_FcM += self->k_min_FcM;
-      free(self->E_FcM);
-      self->l_min_FcM += self->k_min_FcM;
-      self->l_max_FcM += self->k_min_FcM;
-      free(self->l_min_FcM);
-      free(self->l_max_FcM);
-    }
-  }
+  free(self->E_F5);
+  free(self->l_min_F5);
+  free(self->l_max_F5);
+  free(self->k_min_F5);
+  free(self->k_max_F5);
+
+  free(self->E_F3);
+  free(self->l_min_F3);
+  free(self->l_max_F3);
+  free(self->k_min_F3);
+  free(self->k_max_F3);
+
+  free(self->E_C);
+  free(self->l_min_C);
+  free(self->l_max_C);
+  free(self->k_min_C);
+  free(self->k_max_C);
+
+  free(self->E_M);
+  free(self->l_min_M);
+  free(self->l_max_M);
+  free(self->k_min_M);
+  free(self->k_max_M);
+
+  free(self->E_M1);
+  free(self->l_min_M1);
+  free(self->l_max_M1);
+  free(self->k_min_M1);
+  free(self->k_max_M1);
+
+  free(self->E_M2);
+  free(self->l_min_M2);
+  free(self->l_max_M2);
+  free(self->k_min_M2);
+  free(self->k_max_M2);
 
   free(self->E_F5_rem);
   free(self->E_F3_rem);
@@ -983,6 +793,8 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
   free(self->E_M_rem);
   free(self->E_M1_rem);
   free(self->E_M2_rem);
+
+  arena_free(self->arena);
 }
 
 
@@ -999,6 +811,9 @@ pf_matrices_free_default(vrna_mx_pf_t *self)
   free(self->probs);
   free(self->q1k);
   free(self->qln);
+  free(self->aux_qq);
+  free(self->aux_qqm);
+  free(self->aux_qqm2);
 #ifndef VRNA_DISABLE_C11_FEATURES
   vrna_smx_csr_free(self->q_gq);
   vrna_smx_csr_free(self->p_gq);
@@ -1028,240 +843,52 @@ pf_matrices_free_window(vrna_mx_pf_t  *self,
 
 PRIVATE void
 pf_matrices_free_2Dfold(vrna_mx_pf_t  *self,
-                        unsigned int  length,
-                        int           turn,
-                        int           *indx,
-                        int           *jindx)
+                        unsigned int  length VRNA_UNUSED,
+                        int           turn VRNA_UNUSED,
+                        int           *indx VRNA_UNUSED,
+                        int           *jindx VRNA_UNUSED)
 {
-  unsigned int  i, j, ij;
-  int           cnt1;
-
-  /* This will be some fun... */
-  if (self->Q != NULL) {
-    for (i = 1; i <= length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q[ij]; cnt1 <= self->k_max_Q[ij]; cnt1++)
-          if (self->l_min_Q[ij][cnt1] < INF) {
-            self->Q[ij][cnt1] += self->l_min_Q[ij][cnt1] / 2;
-            free(self->Q[ij][cnt1]);
-          }
-
-        if (self->k_min_Q[ij] < INF) {
-          self->Q[ij] += self->k_min_Q[ij];
-          free(self->Q[ij]);
-          self->l_min_Q[ij] += self->k_min_Q[ij];
-          self->l_max_Q[ij] += self->k_min_Q[ij];
-          free(self->l_min_Q[ij]);
-          free(self->l_max_Q[ij]);
-        }
-      }
-    }
-  }
-
+  /*
+   *  All (k,l) entries and boundaries of the individual cells live in
+   *  the memory arena, so we only need to release the cell pointers
+   */
   free(self->Q);
   free(self->l_min_Q);
   free(self->l_max_Q);
   free(self->k_min_Q);
   free(self->k_max_Q);
 
-  if (self->Q_B != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q_B[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_B[ij]; cnt1 <= self->k_max_Q_B[ij]; cnt1++)
-          if (self->l_min_Q_B[ij][cnt1] < INF) {
-            self->Q_B[ij][cnt1] += self->l_min_Q_B[ij][cnt1] / 2;
-            free(self->Q_B[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_B[ij] < INF) {
-          self->Q_B[ij] += self->k_min_Q_B[ij];
-          free(self->Q_B[ij]);
-          self->l_min_Q_B[ij] += self->k_min_Q_B[ij];
-          self->l_max_Q_B[ij] += self->k_min_Q_B[ij];
-          free(self->l_min_Q_B[ij]);
-          free(self->l_max_Q_B[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_B);
   free(self->l_min_Q_B);
   free(self->l_max_Q_B);
   free(self->k_min_Q_B);
   free(self->k_max_Q_B);
 
-  if (self->Q_M != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q_M[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_M[ij]; cnt1 <= self->k_max_Q_M[ij]; cnt1++)
-          if (self->l_min_Q_M[ij][cnt1] < INF) {
-            self->Q_M[ij][cnt1] += self->l_min_Q_M[ij][cnt1] / 2;
-            free(self->Q_M[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_M[ij] < INF) {
-          self->Q_M[ij] += self->k_min_Q_M[ij];
-          free(self->Q_M[ij]);
-          self->l_min_Q_M[ij] += self->k_min_Q_M[ij];
-          self->l_max_Q_M[ij] += self->k_min_Q_M[ij];
-          free(self->l_min_Q_M[ij]);
-          free(self->l_max_Q_M[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_M);
   free(self->l_min_Q_M);
   free(self->l_max_Q_M);
   free(self->k_min_Q_M);
   free(self->k_max_Q_M);
 
-  if (self->Q_M1 != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = jindx[j] + i;
-        if (!self->Q_M1[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_M1[ij]; cnt1 <= self->k_max_Q_M1[ij]; cnt1++)
-          if (self->l_min_Q_M1[ij][cnt1] < INF) {
-            self->Q_M1[ij][cnt1] += self->l_min_Q_M1[ij][cnt1] / 2;
-            free(self->Q_M1[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_M1[ij] < INF) {
-          self->Q_M1[ij] += self->k_min_Q_M1[ij];
-          free(self->Q_M1[ij]);
-          self->l_min_Q_M1[ij]  += self->k_min_Q_M1[ij];
-          self->l_max_Q_M1[ij]  += self->k_min_Q_M1[ij];
-          free(self->l_min_Q_M1[ij]);
-          free(self->l_max_Q_M1[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_M1);
   free(self->l_min_Q_M1);
   free(self->l_max_Q_M1);
   free(self->k_min_Q_M1);
   free(self->k_max_Q_M1);
 
-  if (self->Q_M2 != NULL) {
-    for (i = 1; i < length - turn - 1; i++) {
-      if (!self->Q_M2[i])
-        continue;
-
-      for (cnt1 = self->k_min_Q_M2[i]; cnt1 <= self->k_max_Q_M2[i]; cnt1++)
-        if (self->l_min_Q_M2[i][cnt1] < INF) {
-          self->Q_M2[i][cnt1] += self->l_min_Q_M2[i][cnt1] / 2;
-          free(self->Q_M2[i][cnt1]);
-        }
-
-      if (self->k_min_Q_M2[i] < INF) {
-        self->Q_M2[i] += self->k_min_Q_M2[i];
-        free(self->Q_M2[i]);
-        self->l_min_Q_M2[i] += self->k_min_Q_M2[i];
-        self->l_max_Q_M2[i] += self->k_min_Q_M2[i];
-        free(self->l_min_Q_M2[i]);
-        free(self->l_max_Q_M2[i]);
-      }
-    }
-  }
-
   free(self->Q_M2);
   free(self->l_min_Q_M2);
   free(self->l_max_Q_M2);
   free(self->k_min_Q_M2);
   free(self->k_max_Q_M2);
 
-  if (self->Q_c != NULL) {
-    for (cnt1 = self->k_min_Q_c; cnt1 <= self->k_max_Q_c; cnt1++)
-      if (self->l_min_Q_c[cnt1] < INF) {
-        self->Q_c[cnt1] += self->l_min_Q_c[cnt1] / 2;
-        free(self->Q_c[cnt1]);
-      }
-
-    if (self->k_min_Q_c < INF) {
-      self->Q_c += self->k_min_Q_c;
-      free(self->Q_c);
-      self->l_min_Q_c += self->k_min_Q_c;
-      self->l_max_Q_c += self->k_min_Q_c;
-      free(self->l_min_Q_c);
-      free(self->l_max_Q_c);
-    }
-  }
-
-  if (self->Q_cI != NULL) {
-    for (cnt1 = self->k_min_Q_cI; cnt1 <= self->k_max_Q_cI; cnt1++)
-      if (self->l_min_Q_cI[cnt1] < INF) {
-        self->Q_cI[cnt1] += self->l_min_Q_cI[cnt1] / 2;
-        free(self->Q_cI[cnt1]);
-      }
-
-    if (self->k_min_Q_cI < INF) {
-      self->Q_cI += self->k_min_Q_cI;
-      free(self->Q_cI);
-      self->l_min_Q_cI  += self->k_min_Q_cI;
-      self->l_max_Q_cI  += self->k_min_Q_cI;
-      free(self->l_min_Q_cI);
-      free(self->l_max_Q_cI);
-    }
-  }
-
-  if (self->Q_cH != NULL) {
-    for (cnt1 = self->k_min_Q_cH; cnt1 <= self->k_max_Q_cH; cnt1++)
-      if (self->l_min_Q_cH[cnt1] < INF) {
-        self->Q_cH[cnt1] += self->l_min_Q_cH[cnt1] / 2;
-        free(self->Q_cH[cnt1]);
-      }
-
-    if (self->k_min_Q_cH < INF) {
-      self->Q_cH += self->k_min_Q_cH;
-      free(self->Q_cH);
-      self->l_min_Q_cH  += self->k_min_Q_cH;
-      self->l_max_Q_cH  += self->k_min_Q_cH;
-      free(self->l_min_Q_cH);
-      free(self->l_max_Q_cH);
-    }
-  }
-
-  if (self->Q_cM != NULL) {
-    for (cnt1 = self->k_min_Q_cM; cnt1 <= self->k_max_Q_cM; cnt1++)
-      if (self->l_min_Q_cM[cnt1] < INF) {
-        self->Q_cM[cnt1] += self->l_min_Q_cM[cnt1] / 2;
-        free(self->Q_cM[cnt1]);
-      }
-
-    if (self->k_min_Q_cM < INF) {
-      self->Q_cM += self->k_min_Q_cM;
-      free(self->Q_cM);
-      self->l_min_Q_cM  += self->k_min_Q_cM;
-      self->l_max_Q_cM  += self->k_min_Q_cM;
-      free(self->l_min_Q_cM);
-      free(self->l_max_Q_cM);
-    }
-  }
-
   free(self->Q_rem);
   free(self->Q_B_rem);
   free(self->Q_M_rem);
   free(self->Q_M1_rem);
   free(self->Q_M2_rem);
+
+  arena_free(self->arena);
 }
 
 
@@ -1408,6 +1035,8 @@ init_mx_mfe_2Dfold(vrna_fold_compound_t *fc,
     mx->length  = n;
     mx->strands = fc->strands;
 
+    mx->arena   = arena_init();
+
     if (alloc_vector & ALLOC_F5) {
       mx->E_F5      = (int ***)vrna_alloc(sizeof(int **) * lin_size);
       mx->l_min_F5  = (int **)vrna_alloc(sizeof(int *) * lin_size);
@@ -1590,6 +1219,8 @@ nullify_mfe(vrna_mx_mfe_t *mx)
         mx->k_max_FcM = 0;
         mx->E_FcM_rem = INF;
 
+        mx->arena = NULL;
+
 #ifdef COUNT_STATES
         mx->N_F5  = NULL;
         mx->N_C   = NULL;
@@ -1759,6 +1390,7 @@ init_mx_pf_2Dfold(vrna_fold_compound_t  *fc,
     size        = ((n + 1) * (n + 2)) / 2;
     lin_size    = n + 2;
     mx->length  = n;
+    mx->arena   = arena_init();
 
     if (alloc_vector & ALLOC_F) {
       mx->Q       = (FLT_OR_DBL ***)vrna_alloc(sizeof(FLT_OR_DBL * *) * size);
@@ -1839,6 +1471,9 @@ nullify_pf(vrna_mx_pf_t *mx)
         mx->qln   = NULL;
         mx->q_gq  = NULL;
         mx->p_gq  = NULL;
+        mx->aux_qq    = NULL;
+        mx->aux_qqm   = NULL;
+        mx->aux_qqm2  = NULL;
         break;
 
       case VRNA_MX_WINDOW:
@@ -1917,6 +1552,8 @@ nullify_pf(vrna_mx_pf_t *mx)
         mx->k_max_Q_cM  = 0;
         mx->Q_cM_rem    = 0.;
 
+        mx->arena = NULL;
+
         break;
     }
   }
@@ -203,6 +203,9 @@ struct {
   int           E_FcI_rem;
   int           E_FcM_rem;
 
+  /* memory arena that holds the (k,l) entries and boundaries of all cells above */
+  struct vrna_mx_arena_s *arena;
+
 #ifdef COUNT_STATES
   unsigned long ***N_F5;
   unsigned long ***N_C;
@@ -266,6 +269,11 @@ struct vrna_mx_pf_s {
   FLT_OR_DBL qio;
   FLT_OR_DBL qmo;
 
+  FLT_OR_DBL *aux_qq;       /**<  @brief  Snapshot of exterior loop helper array (see vrna_pf_update()) */
+  FLT_OR_DBL *aux_qqm;      /**<  @brief  Snapshot of multibranch loop helper array (see vrna_pf_update()) */
+  FLT_OR_DBL *aux_qqm2;     /**<  @brief  Snapshot of multibranch loop helper array (see vrna_pf_update()) */
+  FLT_OR_DBL aux_pf_scale;  /**<  @brief  Scaling factor the snapshots were computed with */
+
   /**
    *  @}
    */
@@ -371,6 +379,9 @@ struct {
   FLT_OR_DBL Q_cH_rem;
   FLT_OR_DBL Q_cI_rem;
   FLT_OR_DBL Q_cM_rem;
+
+  /* memory arena that holds the (k,l) entries and boundaries of all cells above */
+  struct vrna_mx_arena_s *arena;
   /**
    *  @}
    */
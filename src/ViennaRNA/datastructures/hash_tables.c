@@ -1,40 +1,157 @@
 /* Taken from the barriers tool and modified by GE. */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
 
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#elif defined(_OPENMP)
+# include <omp.h>
+#endif
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/datastructures/hash_tables.h"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  A new hash table starts with 2^MIN(hash_bits, HT_INIT_BITS) slots and
+ *  doubles its size as soon as more than HT_MAX_LOAD_NUM / HT_MAX_LOAD_DEN
+ *  of the slots are occupied
+ */
+#define HT_INIT_BITS          6
+#define HT_MAX_LOAD_NUM       4
+#define HT_MAX_LOAD_DEN       5
+
+/* default number of shards for the concurrent hash table */
+#define HT_MT_DEFAULT_SHARDS  64
+
+/*
+ *  The hash table uses open addressing with linear probing and Robin Hood
+ *  displacement. Each slot holds the entry together with its hash value,
+ *  such that the compare callback is only invoked for entries with equal
+ *  hash values, and growing the table never calls the hash function again
+ */
+typedef struct {
+  void          *entry;           /* NULL for empty slots */
+  unsigned int  hash;
+} ht_slot_t;
+
 
 struct vrna_hash_table_s {
-  unsigned int                      hash_bits;
-  unsigned long                     Hash_size;
-  /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )*/
-  void                              **Hash_table;
-  unsigned long                     Collisions;
-  vrna_ht_cmp_f  Compare_function;
-  vrna_ht_hashfunc_f    Hash_function;
-  vrna_ht_free_f       Free_hash_entry;
+  unsigned int        hash_bits;
+  unsigned long       Hash_size;  /* number of slots, always a power of 2 */
+  unsigned long       mask;
+  unsigned long       num_entries;
+  ht_slot_t           *slots;
+  unsigned long       Collisions;
+  vrna_ht_cmp_f       Compare_function;
+  vrna_ht_hashfunc_f  Hash_function;
+  vrna_ht_free_f      Free_hash_entry;
 };
 
 
-typedef struct vrna_hash_entry_list_s {
-  unsigned long length;
-  unsigned long allocated_length;
-  void          **hash_entries;
-} vrna_hash_entry_list_t;
+struct vrna_hash_table_mt_s {
+  unsigned int              num_shards; /* always a power of 2 */
+  unsigned int              shard_shift;
+  struct vrna_hash_table_s  **shards;
+#if VRNA_WITH_PTHREADS
+  pthread_rwlock_t          *locks;
+#elif defined(_OPENMP)
+  omp_lock_t                *locks;     /* no read-write locks in OpenMP, readers block each other */
+#endif
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE INLINE unsigned int
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x);
+
+
+PRIVATE INLINE int
+ht_equal(struct vrna_hash_table_s *ht,
+         void                     *x,
+         void                     *y);
+
+
+PRIVATE INLINE unsigned long
+ht_probe_length(struct vrna_hash_table_s  *ht,
+                unsigned long             pos,
+                unsigned int              hash);
+
+
+PRIVATE long
+ht_find(struct vrna_hash_table_s  *ht,
+        void                      *x,
+        unsigned int              hash);
+
+
+PRIVATE void
+ht_place(struct vrna_hash_table_s *ht,
+         void                     *x,
+         unsigned int             hash);
+
+
+PRIVATE int
+ht_grow(struct vrna_hash_table_s *ht);
+
+
+PRIVATE int
+ht_insert(struct vrna_hash_table_s  *ht,
+          void                      *x,
+          unsigned int              hash,
+          void                      **stored);
+
+
+PRIVATE void
+ht_delete(struct vrna_hash_table_s  *ht,
+          void                      *x,
+          unsigned int              hash);
+
+
+PRIVATE INLINE unsigned int
+ht_mt_shard(struct vrna_hash_table_mt_s *ht,
+            unsigned int                hash);
 
-/* ----------------------------------------------------------------- */
 
+PRIVATE INLINE void
+ht_mt_lock(struct vrna_hash_table_mt_s  *ht,
+           unsigned int                 shard,
+           int                          exclusive);
+
+
+PRIVATE INLINE void
+ht_mt_unlock(struct vrna_hash_table_mt_s  *ht,
+             unsigned int                 shard);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
 PUBLIC struct vrna_hash_table_s *
-vrna_ht_init(unsigned int                     hash_bits,
-             vrna_ht_cmp_f compare_function,
-             vrna_ht_hashfunc_f   hash_function,
-             vrna_ht_free_f      free_hash_entry)
+vrna_ht_init(unsigned int       hash_bits,
+             vrna_ht_cmp_f      compare_function,
+             vrna_ht_hashfunc_f hash_function,
+             vrna_ht_free_f     free_hash_entry)
 {
   struct vrna_hash_table_s *ht = NULL;
 
@@ -42,12 +159,16 @@ vrna_ht_init(unsigned int                     hash_bits,
     ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
 
     ht->hash_bits = hash_bits;
-    /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )
-    * if we want to use '&' instead of modulo '%' for limiting the hash value. */
-    ht->Hash_size   = (((unsigned long)1 << hash_bits) - 1);
-    ht->Hash_table  = calloc((ht->Hash_size + 1), sizeof(void *));
-    if (!ht->Hash_table) {
-      fprintf(stderr, "Error: could not allocate space for the hash table!\n");
+    /*
+     *  hash_bits only limits the initial size of the table, since
+     *  many tables never get close to 2^hash_bits entries
+     */
+    ht->Hash_size   = (unsigned long)1 << MIN2(hash_bits, HT_INIT_BITS);
+    ht->mask        = ht->Hash_size - 1;
+    ht->num_entries = 0;
+    ht->slots       = calloc(ht->Hash_size, sizeof(ht_slot_t));
+    if (!ht->slots) {
+      vrna_log_error("could not allocate space for the hash table!");
       free(ht);
       return NULL;
     }
@@ -77,6 +198,7 @@ vrna_ht_init(unsigned int                     hash_bits,
        *  One of the function pointers is missing, so we don't initialize
        *  anything!
        */
+      free(ht->slots);
       free(ht);
       ht = NULL;
     }
@@ -86,7 +208,7 @@ vrna_ht_init(unsigned int                     hash_bits,
 }
 
 
-unsigned long
+PUBLIC unsigned long
 vrna_ht_size(struct vrna_hash_table_s *ht)
 {
   if (ht)
@@ -96,7 +218,7 @@ vrna_ht_size(struct vrna_hash_table_s *ht)
 }
 
 
-unsigned long
+PUBLIC unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht)
 {
   if (ht)
@@ -106,29 +228,70 @@ vrna_ht_collisions(struct vrna_hash_table_s *ht)
 }
 
 
+PUBLIC unsigned long
+vrna_ht_num_entries(struct vrna_hash_table_s *ht)
+{
+  if (ht)
+    return ht->num_entries;
+
+  return 0L;
+}
+
+
+PUBLIC double
+vrna_ht_load_factor(struct vrna_hash_table_s *ht)
+{
+  if (ht)
+    return (double)ht->num_entries / (double)ht->Hash_size;
+
+  return 0.;
+}
+
+
+PUBLIC unsigned long *
+vrna_ht_probe_lengths(struct vrna_hash_table_s  *ht,
+                      unsigned long             *max_length)
+{
+  unsigned long i, d, max_d, *histogram;
+
+  if (max_length)
+    *max_length = 0;
+
+  if (!ht)
+    return NULL;
+
+  max_d = 0;
+
+  for (i = 0; i < ht->Hash_size; i++)
+    if (ht->slots[i].entry) {
+      d = ht_probe_length(ht, i, ht->slots[i].hash);
+      if (d > max_d)
+        max_d = d;
+    }
+
+  histogram = (unsigned long *)vrna_alloc(sizeof(unsigned long) * (max_d + 1));
+
+  for (i = 0; i < ht->Hash_size; i++)
+    if (ht->slots[i].entry)
+      histogram[ht_probe_length(ht, i, ht->slots[i].hash)]++;
+
+  if (max_length)
+    *max_length = max_d;
+
+  return histogram;
+}
+
+
 PUBLIC void *
 vrna_ht_get(struct vrna_hash_table_s  *ht,
             void                      *x)             /* returns NULL unless x is in the hash */
 {
-  unsigned int hashval;
+  long pos;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return NULL;
-    }
-
-    vrna_hash_entry_list_t *entries = ht->Hash_table[hashval];
-    if (entries) {
-      size_t i;
-      for (i = 0; i < entries->length; i++) {
-        if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
-          //found the same entry
-          return entries->hash_entries[i]; /* success */
-      }
-    }
+    pos = ht_find(ht, x, ht_hash(ht, x));
+    if (pos >= 0)
+      return ht->slots[pos].entry; /* success */
   }
 
   return NULL;
@@ -139,53 +302,10 @@ vrna_ht_get(struct vrna_hash_table_s  *ht,
 
 PUBLIC int
 vrna_ht_insert(struct vrna_hash_table_s *ht,
-               void                     *x)         /* returns 1 if x already was in the hash */
+               void                     *x)
 {
-  unsigned int hashval;
-
-  if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return -1; /* failure */;
-    } else {
-      vrna_hash_entry_list_t *entries = (vrna_hash_entry_list_t *)ht->Hash_table[hashval];
-      if (entries) {
-        //at first test if the entry is already in the list.
-        size_t i;
-        for (i = 0; i < entries->length; i++) {
-          if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
-            //found the same entry
-            return 0; /* success */
-        }
-
-        ht->Collisions++;
-        //append the entry to the list with same hash values.
-        if (i >= entries->length) {
-          if (i >= entries->allocated_length) {
-            //we have to extend the list.
-            entries->allocated_length += 100;
-            entries->hash_entries     = vrna_realloc(entries->hash_entries,
-                                                     entries->allocated_length * sizeof(void *));
-          }
-
-          entries->hash_entries[entries->length] = x;
-          entries->length++;
-        }
-      } else {
-        //allocate new list and insert the value
-        entries                   = malloc(sizeof(vrna_hash_entry_list_t));
-        entries->allocated_length = 2;
-        entries->hash_entries     = vrna_alloc(entries->allocated_length * sizeof(void *));
-        entries->hash_entries[0]  = x;
-        entries->length           = 1;
-        ht->Hash_table[hashval]   = entries;
-      }
-
-      return 0; /* success */
-    }
-  }
+  if ((ht) && (x))
+    return ht_insert(ht, x, ht_hash(ht, x), NULL);
 
   return -1; /* failure */
 }
@@ -194,23 +314,19 @@ vrna_ht_insert(struct vrna_hash_table_s *ht,
 PUBLIC void
 vrna_ht_clear(struct vrna_hash_table_s *ht)
 {
-  unsigned int k;
+  unsigned long k;
 
   if (ht) {
-    for (k = 0; k < ht->Hash_size + 1; k++) {
-      vrna_hash_entry_list_t *entries = ht->Hash_table[k];
-      if (entries) {
-        size_t i;
-        for (i = 0; i < entries->length; i++) {
-          ht->Free_hash_entry(entries->hash_entries[i]);
-          entries->hash_entries[i] = NULL;
-        }
-        free(entries->hash_entries);
-        free(entries);
+    for (k = 0; k < ht->Hash_size; k++) {
+      if (ht->slots[k].entry) {
+        ht->Free_hash_entry(ht->slots[k].entry);
+        ht->slots[k].entry  = NULL;
+        ht->slots[k].hash   = 0;
       }
     }
 
-    ht->Collisions = 0;
+    ht->num_entries = 0;
+    ht->Collisions  = 0;
   }
 }
 
@@ -220,7 +336,7 @@ vrna_ht_free(struct vrna_hash_table_s *ht)
 {
   if (ht) {
     vrna_ht_clear(ht);
-    free(ht->Hash_table);
+    free(ht->slots);
     free(ht);
   }
 }
@@ -233,38 +349,471 @@ vrna_ht_remove(struct vrna_hash_table_s *ht,
                void                     *x)
 {
   /* doesn't free anything ! */
-  unsigned int hashval;
+  if ((ht) && (x))
+    ht_delete(ht, x, ht_hash(ht, x));
+}
+
+
+/* ----------------------------------------------------------------- */
+
+PUBLIC struct vrna_hash_table_mt_s *
+vrna_ht_mt_init(unsigned int        hash_bits,
+                unsigned int        num_shards,
+                vrna_ht_cmp_f       compare_function,
+                vrna_ht_hashfunc_f  hash_function,
+                vrna_ht_free_f      free_hash_entry)
+{
+  unsigned int                i, bits;
+  struct vrna_hash_table_mt_s *ht;
+
+#if !VRNA_WITH_PTHREADS && !defined(_OPENMP)
+  vrna_log_warning("vrna_ht_mt_init: "
+                   "RNAlib has been compiled without POSIX threads and OpenMP support, "
+                   "concurrent hash tables are not available");
+  return NULL;
+#endif
+
+  if (num_shards == 0)
+    num_shards = HT_MT_DEFAULT_SHARDS;
+
+  /* round up to the next power of 2 */
+  for (bits = 0; (bits < 16) && ((1U << bits) < num_shards); bits++);
+
+  ht              = (struct vrna_hash_table_mt_s *)vrna_alloc(sizeof(struct vrna_hash_table_mt_s));
+  ht->num_shards  = 1U << bits;
+  ht->shard_shift = 32 - bits;
+  ht->shards      = (struct vrna_hash_table_s **)vrna_alloc(
+    sizeof(struct vrna_hash_table_s *) * ht->num_shards);
+#if VRNA_WITH_PTHREADS
+  ht->locks = (pthread_rwlock_t *)vrna_alloc(sizeof(pthread_rwlock_t) * ht->num_shards);
+#elif defined(_OPENMP)
+  ht->locks = (omp_lock_t *)vrna_alloc(sizeof(omp_lock_t) * ht->num_shards);
+#endif
+
+  for (i = 0; i < ht->num_shards; i++) {
+    ht->shards[i] = vrna_ht_init(hash_bits,
+                                 compare_function,
+                                 hash_function,
+                                 free_hash_entry);
+    if (!ht->shards[i]) {
+      while (i > 0)
+        vrna_ht_free(ht->shards[--i]);
+
+      free(ht->shards);
+#if VRNA_WITH_PTHREADS || defined(_OPENMP)
+      free(ht->locks);
+#endif
+      free(ht);
+      return NULL;
+    }
+
+#if VRNA_WITH_PTHREADS
+    pthread_rwlock_init(&(ht->locks[i]), NULL);
+#elif defined(_OPENMP)
+    omp_init_lock(&(ht->locks[i]));
+#endif
+  }
+
+  return ht;
+}
+
+
+PUBLIC void *
+vrna_ht_mt_get(struct vrna_hash_table_mt_s  *ht,
+               void                         *x)
+{
+  unsigned int  h, s;
+  long          pos;
+  void          *entry = NULL;
+
+  if ((ht) && (x)) {
+    h = ht_hash(ht->shards[0], x);
+    s = ht_mt_shard(ht, h);
+
+    ht_mt_lock(ht, s, 0);
+
+    pos = ht_find(ht->shards[s], x, h);
+    if (pos >= 0)
+      entry = ht->shards[s]->slots[pos].entry;
+
+    ht_mt_unlock(ht, s);
+  }
+
+  return entry;
+}
+
+
+PUBLIC int
+vrna_ht_mt_insert(struct vrna_hash_table_mt_s *ht,
+                  void                        *x)
+{
+  unsigned int  h, s;
+  int           ret = -1;
+
+  if ((ht) && (x)) {
+    h = ht_hash(ht->shards[0], x);
+    s = ht_mt_shard(ht, h);
+
+    ht_mt_lock(ht, s, 1);
+    ret = ht_insert(ht->shards[s], x, h, NULL);
+    ht_mt_unlock(ht, s);
+  }
+
+  return ret;
+}
+
+
+PUBLIC void *
+vrna_ht_mt_get_or_insert(struct vrna_hash_table_mt_s  *ht,
+                         void                         *x)
+{
+  unsigned int  h, s;
+  void          *entry = NULL;
+
+  if ((ht) && (x)) {
+    h = ht_hash(ht->shards[0], x);
+    s = ht_mt_shard(ht, h);
+
+    ht_mt_lock(ht, s, 1);
+    if (ht_insert(ht->shards[s], x, h, &entry) != 0)
+      entry = NULL;
+
+    ht_mt_unlock(ht, s);
+  }
+
+  return entry;
+}
+
+
+PUBLIC void
+vrna_ht_mt_remove(struct vrna_hash_table_mt_s *ht,
+                  void                        *x)
+{
+  unsigned int h, s;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return;
+    h = ht_hash(ht->shards[0], x);
+    s = ht_mt_shard(ht, h);
+
+    ht_mt_lock(ht, s, 1);
+    ht_delete(ht->shards[s], x, h);
+    ht_mt_unlock(ht, s);
+  }
+}
+
+
+PUBLIC unsigned long
+vrna_ht_mt_num_entries(struct vrna_hash_table_mt_s *ht)
+{
+  unsigned int  s;
+  unsigned long n = 0;
+
+  if (ht) {
+    for (s = 0; s < ht->num_shards; s++) {
+      ht_mt_lock(ht, s, 0);
+      n += ht->shards[s]->num_entries;
+      ht_mt_unlock(ht, s);
     }
+  }
 
-    vrna_hash_entry_list_t *entries = ht->Hash_table[hashval];
-    if (entries) {
-      size_t i;
-      for (i = 0; i < entries->length; i++) {
-        if (ht->Compare_function(x, entries->hash_entries[i]) == 0) {
-          //found the same entry --> shift the list to the left in order to delete the value.
-          size_t size_rest = entries->length - i - 1;
-          if (size_rest == 0) {
-            entries->hash_entries[i] = 0;
-          } else {
-            void  *offset     = entries->hash_entries + i;
-            void  *next_entry = entries->hash_entries + i + 1;
-            memcpy(offset, next_entry, size_rest * sizeof(void *));
-          }
-
-          entries->hash_entries[entries->length - 1] = NULL;
-          entries->length--;
-          return; /* success */
-        }
-      }
+  return n;
+}
+
+
+PUBLIC void
+vrna_ht_mt_clear(struct vrna_hash_table_mt_s *ht)
+{
+  unsigned int s;
+
+  if (ht) {
+    for (s = 0; s < ht->num_shards; s++) {
+      ht_mt_lock(ht, s, 1);
+      vrna_ht_clear(ht->shards[s]);
+      ht_mt_unlock(ht, s);
+    }
+  }
+}
+
+
+PUBLIC void
+vrna_ht_mt_free(struct vrna_hash_table_mt_s *ht)
+{
+  unsigned int s;
+
+  if (ht) {
+    for (s = 0; s < ht->num_shards; s++) {
+      vrna_ht_free(ht->shards[s]);
+#if VRNA_WITH_PTHREADS
+      pthread_rwlock_destroy(&(ht->locks[s]));
+#elif defined(_OPENMP)
+      omp_destroy_lock(&(ht->locks[s]));
+#endif
+    }
+
+    free(ht->shards);
+#if VRNA_WITH_PTHREADS || defined(_OPENMP)
+    free(ht->locks);
+#endif
+    free(ht);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE INLINE unsigned int
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x)
+{
+  unsigned int h;
+
+  /*
+   *  Slots are addressed by the lower bits of the hash value that grow
+   *  with the table. Hence, we request the full 32-bit range from the
+   *  hash function and finally scramble its value (MurmurHash3 finalizer)
+   *  since many hash functions, e.g. for integer keys, are rather weak
+   */
+  if (ht->Hash_function == &vrna_ht_db_hash_func)
+    h = vrna_ht_db_hash_func(x, (unsigned long)UINT_MAX);
+  else
+    h = ht->Hash_function(x, (unsigned long)UINT_MAX);
+
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+
+  return h;
+}
+
+
+PRIVATE INLINE int
+ht_equal(struct vrna_hash_table_s *ht,
+         void                     *x,
+         void                     *y)
+{
+  if (ht->Compare_function == &vrna_ht_db_comp)
+    return vrna_ht_db_comp(x, y) == 0;
+
+  return ht->Compare_function(x, y) == 0;
+}
+
+
+/* distance of slot pos from the home slot of an entry with hash value hash */
+PRIVATE INLINE unsigned long
+ht_probe_length(struct vrna_hash_table_s  *ht,
+                unsigned long             pos,
+                unsigned int              hash)
+{
+  return (pos - (hash & ht->mask)) & ht->mask;
+}
+
+
+/* returns the slot that stores x, or -1 if x is not in the table */
+PRIVATE long
+ht_find(struct vrna_hash_table_s  *ht,
+        void                      *x,
+        unsigned int              hash)
+{
+  unsigned long pos, d;
+  ht_slot_t     *slot;
+
+  pos = hash & ht->mask;
+
+  /* the table is never full, so we always hit an empty slot eventually */
+  for (d = 0; ; d++, pos = (pos + 1) & ht->mask) {
+    slot = ht->slots + pos;
+
+    if (!slot->entry)
+      return -1;
+
+    /* due to Robin Hood displacement, x would have been stored before this slot */
+    if (ht_probe_length(ht, pos, slot->hash) < d)
+      return -1;
+
+    if ((slot->hash == hash) &&
+        (ht_equal(ht, x, slot->entry)))
+      return (long)pos;
+  }
+}
+
+
+/* insert an entry that is not yet in the table and fits without growing */
+PRIVATE void
+ht_place(struct vrna_hash_table_s *ht,
+         void                     *x,
+         unsigned int             hash)
+{
+  unsigned long pos, d, d_slot;
+  unsigned int  tmp_hash;
+  void          *tmp_entry;
+  ht_slot_t     *slot;
+
+  pos = hash & ht->mask;
+
+  for (d = 0; ; d++, pos = (pos + 1) & ht->mask) {
+    slot = ht->slots + pos;
+
+    if (!slot->entry) {
+      slot->entry = x;
+      slot->hash  = hash;
+      break;
+    }
+
+    /* take the slot from entries that are closer to their home slot */
+    d_slot = ht_probe_length(ht, pos, slot->hash);
+    if (d_slot < d) {
+      tmp_entry   = slot->entry;
+      tmp_hash    = slot->hash;
+      slot->entry = x;
+      slot->hash  = hash;
+      x           = tmp_entry;
+      hash        = tmp_hash;
+      d           = d_slot;
     }
   }
+
+  ht->num_entries++;
+}
+
+
+PRIVATE int
+ht_grow(struct vrna_hash_table_s *ht)
+{
+  unsigned long i, old_size;
+  ht_slot_t     *old_slots, *slots;
+
+  old_size  = ht->Hash_size;
+  old_slots = ht->slots;
+  slots     = calloc(2 * old_size, sizeof(ht_slot_t));
+
+  if (!slots) {
+    vrna_log_error("could not allocate space for the hash table!");
+    return 0;
+  }
+
+  ht->slots       = slots;
+  ht->Hash_size   = 2 * old_size;
+  ht->mask        = ht->Hash_size - 1;
+  ht->num_entries = 0;
+
+  for (i = 0; i < old_size; i++)
+    if (old_slots[i].entry)
+      ht_place(ht, old_slots[i].entry, old_slots[i].hash);
+
+  free(old_slots);
+
+  return 1;
+}
+
+
+PRIVATE int
+ht_insert(struct vrna_hash_table_s  *ht,
+          void                      *x,
+          unsigned int              hash,
+          void                      **stored)
+{
+  long pos;
+
+  pos = ht_find(ht, x, hash);
+
+  if (pos >= 0) {
+    /* entry is already in the table */
+    if (stored)
+      *stored = ht->slots[pos].entry;
+
+    return 0;
+  }
+
+  if (((ht->num_entries + 1) * HT_MAX_LOAD_DEN > ht->Hash_size * HT_MAX_LOAD_NUM) &&
+      (!ht_grow(ht)))
+    return -1; /* failure */
+
+  if (ht->slots[hash & ht->mask].entry)
+    ht->Collisions++;
+
+  ht_place(ht, x, hash);
+
+  if (stored)
+    *stored = x;
+
+  return 0; /* success */
+}
+
+
+PRIVATE void
+ht_delete(struct vrna_hash_table_s  *ht,
+          void                      *x,
+          unsigned int              hash)
+{
+  long          p;
+  unsigned long pos, next;
+
+  p = ht_find(ht, x, hash);
+
+  if (p < 0)
+    return;
+
+  /* backward shift deletion, i.e. move the following entries closer to their home slot */
+  pos   = (unsigned long)p;
+  next  = (pos + 1) & ht->mask;
+
+  while ((ht->slots[next].entry) &&
+         (ht_probe_length(ht, next, ht->slots[next].hash) > 0)) {
+    ht->slots[pos]  = ht->slots[next];
+    pos             = next;
+    next            = (next + 1) & ht->mask;
+  }
+
+  ht->slots[pos].entry  = NULL;
+  ht->slots[pos].hash   = 0;
+  ht->num_entries--;
+}
+
+
+PRIVATE INLINE unsigned int
+ht_mt_shard(struct vrna_hash_table_mt_s *ht,
+            unsigned int                hash)
+{
+  /* shards are selected by the upper bits, slots within a shard by the lower bits */
+  if (ht->num_shards > 1)
+    return hash >> ht->shard_shift;
+
+  return 0;
+}
+
+
+PRIVATE INLINE void
+ht_mt_lock(struct vrna_hash_table_mt_s  *ht,
+           unsigned int                 shard,
+           int                          exclusive)
+{
+#if VRNA_WITH_PTHREADS
+  if (exclusive)
+    pthread_rwlock_wrlock(&(ht->locks[shard]));
+  else
+    pthread_rwlock_rdlock(&(ht->locks[shard]));
+
+#elif defined(_OPENMP)
+  (void)exclusive;
+  omp_set_lock(&(ht->locks[shard]));
+#endif
+}
+
+
+PRIVATE INLINE void
+ht_mt_unlock(struct vrna_hash_table_mt_s  *ht,
+             unsigned int                 shard)
+{
+#if VRNA_WITH_PTHREADS
+  pthread_rwlock_unlock(&(ht->locks[shard]));
+#elif defined(_OPENMP)
+  omp_unset_lock(&(ht->locks[shard]));
+#endif
 }
 
 
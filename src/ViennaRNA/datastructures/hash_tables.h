@@ -64,10 +64,14 @@ DEPRECATED(typedef int (vrna_callback_ht_compare_entries)(void *x,
 /**
  *  @brief  Callback function to generate a hash key, i.e. hash function
  *
+ *  @note   Since hash tables grow automatically, @p hashtable_size is not the
+ *          actual number of slots but an upper bound for the hash value. Hash
+ *          functions should therefore make use of the entire range.
+ *
  *  @see    vrna_ht_init(), vrna_ht_db_hash_func()
  *
  *  @param  x               A hash table entry
- *  @param  hashtable_size  The size of the hash table
+ *  @param  hashtable_size  The upper bound (exclusive) for the hash value
  *  @return                 The hash table key for entry @p x
  */
 typedef unsigned int (*vrna_ht_hashfunc_f)(void          *x,
@@ -96,7 +100,9 @@ DEPRECATED(typedef int (vrna_callback_ht_free_entry)(void *x),
  *  @brief  Get an initialized hash table
  *
  *  This function returns a ready-to-use hash table with pre-allocated
- *  memory for a particular number of entries.
+ *  memory for a particular number of entries. The table uses open addressing
+ *  with Robin Hood hashing, stores the hash value of each entry alongside
+ *  the entry, and doubles its size whenever it becomes too full.
  *
  *  @note
  *  @parblock
@@ -109,10 +115,7 @@ DEPRECATED(typedef int (vrna_callback_ht_free_entry)(void *x),
  *  arguments.
  *  @endparblock
  *
- *  @warning  If @p hash_bits is larger than 27 you have to compile it with
- *            the flag gcc -mcmodel=large.
- *
- *  @param  b                 Number of bits for the hash table. This determines the size (@f$2^b -1@f$).
+ *  @param  b                 Number of bits for the hash table. The initial size is at most @f$2^b@f$ slots.
  *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
  *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
  *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
@@ -129,7 +132,7 @@ vrna_ht_init(unsigned int                     b,
  *  @brief  Get the size of the hash table
  *
  *  @param  ht  The hash table
- *  @return     The size of the hash table, i.e. the maximum number of entries
+ *  @return     The size of the hash table, i.e. the current number of slots
  */
 unsigned long
 vrna_ht_size(vrna_hash_table_t ht);
@@ -145,6 +148,42 @@ unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht);
 
 
+/**
+ *  @brief  Get the number of entries stored in the hash table
+ *
+ *  @param  ht  The hash table
+ *  @return     The number of entries in the hash table
+ */
+unsigned long
+vrna_ht_num_entries(vrna_hash_table_t ht);
+
+
+/**
+ *  @brief  Get the load factor of the hash table
+ *
+ *  @param  ht  The hash table
+ *  @return     The ratio of the number of entries and the number of slots
+ */
+double
+vrna_ht_load_factor(vrna_hash_table_t ht);
+
+
+/**
+ *  @brief  Get the histogram of probe lengths in the hash table
+ *
+ *  The probe length of an entry is the distance of its slot from the
+ *  slot its hash value points to, i.e. the number of additional slots
+ *  a look-up of this entry has to inspect.
+ *
+ *  @param  ht          The hash table
+ *  @param  max_length  A pointer to store the maximum probe length (may be @p NULL)
+ *  @return             An array of size @p max_length + 1 where the i-th entry is the number of entries with probe length i, or @p NULL on any error
+ */
+unsigned long *
+vrna_ht_probe_lengths(vrna_hash_table_t ht,
+                      unsigned long     *max_length);
+
+
 /**
  *  @brief  Get an element from the hash table
  *
@@ -167,17 +206,14 @@ vrna_ht_get(vrna_hash_table_t ht,
 /**
  *  @brief  Insert an object into a hash table
  *
- *  Writes the pointer to your hash entry into the table.
- *
- *  @warning  In case of collisions, this function simply
- *            increments the hash key until a free entry in
- *            the hash table is found.
+ *  Writes the pointer to your hash entry into the table. If an
+ *  equal entry is already stored, the table remains unchanged.
  *
  *  @see vrna_ht_init(), vrna_hash_delete(), vrna_ht_clear()
  *
  *  @param  ht  The hash table
  *  @param  x   The hash entry
- *  @return     0 on success, 1 if the value is already in the hash table, -1 on error.
+ *  @return     0 on success or if the value is already in the hash table, -1 on error.
  */
 int
 vrna_ht_insert(vrna_hash_table_t  ht,
@@ -232,6 +268,146 @@ vrna_ht_free(vrna_hash_table_t ht);
 /* End of abstract interface */
 /**@}*/
 
+/**
+ *  @name Concurrent hash tables
+ *  @{
+ */
+
+/**
+ *  @brief  A hash table object for concurrent access by multiple threads
+ *
+ *  The table is split into a number of shards, i.e. independent hash tables,
+ *  each protected by its own read-write lock. Entries are assigned to the
+ *  shards by their hash value, so threads only block each other if they
+ *  access the same shard at the same time.
+ *
+ *  @note   Thread-safety requires that the library was compiled with
+ *          POSIX threads or OpenMP support. Without POSIX threads, the shards
+ *          are protected by plain OpenMP locks, i.e. concurrent readers of the
+ *          same shard block each other. If neither is available,
+ *          vrna_ht_mt_init() fails. Moreover, the table only protects its
+ *          own data. Entries must not be removed and free'd while other
+ *          threads may still use them.
+ *
+ *  @see  vrna_ht_mt_init(), vrna_ht_mt_free()
+ */
+typedef struct vrna_hash_table_mt_s *vrna_hash_table_mt_t;
+
+
+/**
+ *  @brief  Get an initialized concurrent hash table
+ *
+ *  @see  vrna_ht_init()
+ *
+ *  @param  b                 Number of bits for each shard of the hash table, see vrna_ht_init()
+ *  @param  num_shards        Number of shards (rounded up to the next power of 2, 0 for a default number)
+ *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
+ *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
+ *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
+ *  @return                   An initialized, empty hash table, or @p NULL on any error
+ */
+vrna_hash_table_mt_t
+vrna_ht_mt_init(unsigned int        b,
+                unsigned int        num_shards,
+                vrna_ht_cmp_f       compare_function,
+                vrna_ht_hashfunc_f  hash_function,
+                vrna_ht_free_f      free_hash_entry);
+
+
+/**
+ *  @brief  Get an element from a concurrent hash table
+ *
+ *  @see  vrna_ht_get()
+ *
+ *  @param  ht  The hash table
+ *  @param  x   The hash entry to look-up
+ *  @return     The stored entry equal to @p x, @p NULL if there is none
+ */
+void *
+vrna_ht_mt_get(vrna_hash_table_mt_t ht,
+               void                 *x);
+
+
+/**
+ *  @brief  Insert an object into a concurrent hash table
+ *
+ *  @see  vrna_ht_insert(), vrna_ht_mt_get_or_insert()
+ *
+ *  @param  ht  The hash table
+ *  @param  x   The hash entry
+ *  @return     0 on success or if the value is already in the hash table, -1 on error.
+ */
+int
+vrna_ht_mt_insert(vrna_hash_table_mt_t  ht,
+                  void                  *x);
+
+
+/**
+ *  @brief  Look-up an object and insert it if it is not stored yet
+ *
+ *  In contrast to a call of vrna_ht_mt_get() followed by vrna_ht_mt_insert(),
+ *  this function is atomic, i.e. no other thread can insert an equal entry
+ *  in between. Use the return value to find out whether @p x has been
+ *  inserted or not.
+ *
+ *  @param  ht  The hash table
+ *  @param  x   The hash entry
+ *  @return     The entry equal to @p x that was already stored, @p x if it has been inserted, or @p NULL on error
+ */
+void *
+vrna_ht_mt_get_or_insert(vrna_hash_table_mt_t ht,
+                         void                 *x);
+
+
+/**
+ *  @brief  Remove an object from a concurrent hash table
+ *
+ *  @note This function doesn't free any memory occupied by
+ *        the hash entry.
+ *
+ *  @param  ht  The hash table
+ *  @param  x   The hash entry
+ */
+void
+vrna_ht_mt_remove(vrna_hash_table_mt_t  ht,
+                  void                  *x);
+
+
+/**
+ *  @brief  Get the number of entries stored in a concurrent hash table
+ *
+ *  @param  ht  The hash table
+ *  @return     The number of entries in the hash table
+ */
+unsigned long
+vrna_ht_mt_num_entries(vrna_hash_table_mt_t ht);
+
+
+/**
+ *  @brief  Clear a concurrent hash table
+ *
+ *  @see  vrna_ht_clear()
+ *
+ *  @param  ht  The hash table
+ */
+void
+vrna_ht_mt_clear(vrna_hash_table_mt_t ht);
+
+
+/**
+ *  @brief  Free all memory occupied by a concurrent hash table
+ *
+ *  @see  vrna_ht_free()
+ *
+ *  @param  ht  The hash table
+ */
+void
+vrna_ht_mt_free(vrna_hash_table_mt_t ht);
+
+
+/* End of concurrent interface */
+/**@}*/
+
 /**
  *  @name Dot-Bracket / Free Energy entries
  *  @{
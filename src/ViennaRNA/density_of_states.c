@@ -0,0 +1,625 @@
+/*
+ *                Compute the density of states
+ *
+ *                c Gregor Entzian, Ronny Lorenz
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include  <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include  <math.h>
+
+#ifdef _OPENMP
+#include  <omp.h>
+#endif
+
+#include  "ViennaRNA/utils/basic.h"
+#include  "ViennaRNA/utils/log.h"
+#include  "ViennaRNA/params/basic.h"
+#include  "ViennaRNA/eval/exterior.h"
+#include  "ViennaRNA/eval/hairpin.h"
+#include  "ViennaRNA/eval/internal.h"
+#include  "ViennaRNA/eval/multibranch.h"
+#include  "ViennaRNA/mfe/global.h"
+#include  "ViennaRNA/density_of_states.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  Counts of a single DP matrix cell. The cell only stores the range of
+ *  energy bands that are actually populated, i.e. c[k] is the number of
+ *  (sub-)structures with energy lo + k
+ */
+typedef struct {
+  int     lo;
+  int     len;
+  double  *c;
+} dos_cell_t;
+
+
+/*
+ *  Accumulator for the counts of the cell that is currently computed.
+ *  It spans the entire energy range [e_min, e_max] and keeps track
+ *  of the bands that have been touched
+ */
+typedef struct {
+  int     e_min;
+  int     e_max;
+  double  *c;
+  int     first;
+  int     last;
+} dos_acc_t;
+
+
+typedef struct {
+  dos_cell_t  *C;   /* (i, j) pair */
+  dos_cell_t  *M;   /* multibranch loop part with at least one branch */
+  dos_cell_t  *M1;  /* multibranch loop part with exactly one branch */
+  dos_cell_t  *F5;  /* exterior loop, 5' fragments */
+} dos_matrices_t;
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+dos_min_energy(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+acc_init(dos_acc_t  *acc,
+         int        e_min,
+         int        e_max);
+
+
+PRIVATE INLINE void
+acc_add(dos_acc_t   *acc,
+        dos_cell_t  *cell,
+        int         shift,
+        double      factor);
+
+
+PRIVATE INLINE void
+acc_add_conv(dos_acc_t  *acc,
+             dos_cell_t *a,
+             dos_cell_t *b,
+             int        shift);
+
+
+PRIVATE INLINE void
+acc_add_one(dos_acc_t *acc,
+            int       e);
+
+
+PRIVATE void
+acc_commit(dos_acc_t  *acc,
+           dos_cell_t *cell);
+
+
+PRIVATE void
+fill_pair(vrna_fold_compound_t  *fc,
+          dos_matrices_t        *mx,
+          dos_acc_t             *acc,
+          int                   i,
+          int                   j);
+
+
+PRIVATE void
+fill_ml(vrna_fold_compound_t  *fc,
+        dos_matrices_t        *mx,
+        dos_acc_t             *acc,
+        int                   i,
+        int                   j);
+
+
+PRIVATE void
+fill_exterior(vrna_fold_compound_t  *fc,
+              dos_matrices_t        *mx,
+              dos_acc_t             *acc);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_dos_t *
+vrna_dos(vrna_fold_compound_t *fc,
+         int                  e_max)
+{
+  int                   n, turn, d, e_min, e_max_int, size, k;
+  dos_acc_t             acc;
+  dos_matrices_t        mx;
+  vrna_md_t             *md;
+  vrna_dos_t            *dos;
+  vrna_fold_compound_t  *fc_dos;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1)) {
+    vrna_log_warning("vrna_dos: only single RNA sequences are supported");
+    return NULL;
+  }
+
+  md = &(fc->params->model_details);
+
+  if (md->circ) {
+    vrna_log_warning("vrna_dos: circular RNAs are not supported");
+    return NULL;
+  }
+
+  if ((md->dangles != 0) && (md->dangles != 2)) {
+    vrna_log_warning("vrna_dos: only dangle models d0 and d2 are supported");
+    return NULL;
+  }
+
+  /*
+   *  work on a fold compound of our own that shares sequence, model
+   *  details, and energy parameters with the one provided by the caller,
+   *  but leaves its DP matrices and constraints untouched
+   */
+  fc_dos = vrna_fold_compound(fc->sequence, md, VRNA_OPTION_MFE);
+  if (!fc_dos) {
+    vrna_log_warning("vrna_dos: failed to prepare fold compound");
+    return NULL;
+  }
+
+  vrna_params_subst(fc_dos, fc->params);
+
+  fc    = fc_dos;
+  md    = &(fc->params->model_details);
+  n     = (int)fc->length;
+  turn  = md->min_loop_size;
+  e_min = dos_min_energy(fc);
+
+  /* we only need the counts from here on */
+  vrna_mx_mfe_free(fc);
+
+  /*
+   *  sub-structures may exceed the energy threshold and still end
+   *  up in a structure below it if the remainder is negative
+   */
+  e_max_int = (e_min < 0) ? e_max - 2 * e_min : e_max;
+
+  vrna_log_info("minimum energy: %d, maximum energy: %d (internal: %d)",
+                e_min,
+                e_max,
+                e_max_int);
+
+  size  = ((n + 1) * (n + 2)) / 2 + 1;
+  mx.C  = (dos_cell_t *)vrna_alloc(sizeof(dos_cell_t) * size);
+  mx.M  = (dos_cell_t *)vrna_alloc(sizeof(dos_cell_t) * size);
+  mx.M1 = (dos_cell_t *)vrna_alloc(sizeof(dos_cell_t) * size);
+  mx.F5 = (dos_cell_t *)vrna_alloc(sizeof(dos_cell_t) * (n + 1));
+
+  /* cells of the same span are independent of each other */
+#ifdef _OPENMP
+#pragma omp parallel private(acc, d)
+#endif
+  {
+    acc_init(&acc, e_min, e_max_int);
+
+    for (d = turn + 2; d <= n; d++) {
+      int i, j;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (j = d; j <= n; j++) {
+        i = j - d + 1;
+        fill_pair(fc, &mx, &acc, i, j);
+        fill_ml(fc, &mx, &acc, i, j);
+      }
+    }
+
+    free(acc.c);
+  }
+
+  acc_init(&acc, e_min, e_max_int);
+  fill_exterior(fc, &mx, &acc);
+  free(acc.c);
+
+  /* collect counts of the entire sequence */
+  dos         = (vrna_dos_t *)vrna_alloc(sizeof(vrna_dos_t));
+  dos->e_min  = e_min;
+  dos->e_max  = MAX2(e_max, e_min - 1);
+  dos->counts = (double *)vrna_alloc(sizeof(double) * (dos->e_max - e_min + 2));
+
+  for (k = 0; k < mx.F5[n].len; k++)
+    if ((mx.F5[n].lo + k >= e_min) &&
+        (mx.F5[n].lo + k <= dos->e_max))
+      dos->counts[mx.F5[n].lo + k - e_min] = mx.F5[n].c[k];
+
+  for (k = 0; k < size; k++) {
+    free(mx.C[k].c);
+    free(mx.M[k].c);
+    free(mx.M1[k].c);
+  }
+
+  for (k = 0; k <= n; k++)
+    free(mx.F5[k].c);
+
+  free(mx.C);
+  free(mx.M);
+  free(mx.M1);
+  free(mx.F5);
+
+  vrna_fold_compound_free(fc_dos);
+
+  return dos;
+}
+
+
+PUBLIC void
+vrna_dos_free(vrna_dos_t *dos)
+{
+  if (dos) {
+    free(dos->counts);
+    free(dos);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+
+/* lower bound for the energy of any (sub-)structure */
+PRIVATE int
+dos_min_energy(vrna_fold_compound_t *fc)
+{
+  int i, j, ij, e, e_min, n, *indx;
+
+  n     = (int)fc->length;
+  indx  = fc->jindx;
+  e_min = (int)round(vrna_mfe(fc, NULL) * 100.0);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      ij  = indx[j] + i;
+      e   = fc->matrices->c[ij];
+      if (e < e_min)
+        e_min = e;
+
+      e = fc->matrices->fML[ij];
+      if (e < e_min)
+        e_min = e;
+    }
+
+  for (i = 1; i <= n; i++) {
+    e = fc->matrices->f5[i];
+    if (e < e_min)
+      e_min = e;
+  }
+
+  return e_min;
+}
+
+
+PRIVATE void
+acc_init(dos_acc_t  *acc,
+         int        e_min,
+         int        e_max)
+{
+  acc->e_min  = e_min;
+  acc->e_max  = e_max;
+  acc->c      = (double *)vrna_alloc(sizeof(double) * (MAX2(e_max - e_min, 0) + 1));
+  acc->first  = e_max - e_min + 1;
+  acc->last   = -1;
+}
+
+
+/* add factor * cell, shifted by energy shift, to the accumulator */
+PRIVATE INLINE void
+acc_add(dos_acc_t   *acc,
+        dos_cell_t  *cell,
+        int         shift,
+        double      factor)
+{
+  int           k, k_min, k_max, offset;
+  double        *dst;
+  const double  *src;
+
+  /* position of cell->c[0] in the accumulator */
+  offset  = cell->lo + shift - acc->e_min;
+  k_min   = MAX2(0, -offset);
+  k_max   = MIN2(cell->len - 1, acc->e_max - acc->e_min - offset);
+
+  if (k_min > k_max)
+    return;
+
+  dst = acc->c + offset;
+  src = cell->c;
+
+  for (k = k_min; k <= k_max; k++)
+    dst[k] += factor * src[k];
+
+  acc->first  = MIN2(acc->first, offset + k_min);
+  acc->last   = MAX2(acc->last, offset + k_max);
+}
+
+
+/* add the convolution of cells a and b, shifted by energy shift, to the accumulator */
+PRIVATE INLINE void
+acc_add_conv(dos_acc_t  *acc,
+             dos_cell_t *a,
+             dos_cell_t *b,
+             int        shift)
+{
+  int         k, e;
+  dos_cell_t  *tmp;
+
+  if ((a->len == 0) ||
+      (b->len == 0))
+    return;
+
+  /* iterate over the shorter cell and add the longer one as a whole */
+  if (a->len > b->len) {
+    tmp = a;
+    a   = b;
+    b   = tmp;
+  }
+
+  for (k = 0; k < a->len; k++) {
+    e = a->lo + k + shift;
+    if (e + b->lo > acc->e_max)
+      break;
+
+    if (a->c[k] != 0.)
+      acc_add(acc, b, e, a->c[k]);
+  }
+}
+
+
+PRIVATE INLINE void
+acc_add_one(dos_acc_t *acc,
+            int       e)
+{
+  if ((e < acc->e_min) ||
+      (e > acc->e_max))
+    return;
+
+  e -= acc->e_min;
+
+  acc->c[e]   += 1.;
+  acc->first  = MIN2(acc->first, e);
+  acc->last   = MAX2(acc->last, e);
+}
+
+
+/* move the accumulated counts into a cell and reset the accumulator */
+PRIVATE void
+acc_commit(dos_acc_t  *acc,
+           dos_cell_t *cell)
+{
+  if (acc->first > acc->last) {
+    cell->lo  = 0;
+    cell->len = 0;
+    cell->c   = NULL;
+    return;
+  }
+
+  cell->lo  = acc->e_min + acc->first;
+  cell->len = acc->last - acc->first + 1;
+  cell->c   = (double *)vrna_alloc(sizeof(double) * cell->len);
+
+  memcpy(cell->c, acc->c + acc->first, sizeof(double) * cell->len);
+  memset(acc->c + acc->first, 0, sizeof(double) * cell->len);
+
+  acc->first  = acc->e_max - acc->e_min + 1;
+  acc->last   = -1;
+}
+
+
+/* decompose subsegment [i, j] with pair (i, j) */
+PRIVATE void
+fill_pair(vrna_fold_compound_t  *fc,
+          dos_matrices_t        *mx,
+          dos_acc_t             *acc,
+          int                   i,
+          int                   j)
+{
+  int           ij, p, q, maxp, pq, u, type, type_2, no_close, turn, dangles, *rtype, e, *indx;
+  short         *S1;
+  vrna_param_t  *P;
+
+  P       = fc->params;
+  indx    = fc->jindx;
+  S1      = fc->sequence_encoding;
+  rtype   = &(P->model_details.rtype[0]);
+  turn    = P->model_details.min_loop_size;
+  dangles = P->model_details.dangles;
+  ij      = indx[j] + i;
+  type    = fc->ptype[ij];
+
+  if (type) {
+    no_close = (((type == 3) || (type == 4)) && P->model_details.noGUclosure);
+
+    /* hairpin loop */
+    acc_add_one(acc,
+                E_Hairpin(j - i - 1, type, S1[i + 1], S1[j - 1], fc->sequence + i - 1, P));
+
+    /* internal loops */
+    maxp = MIN2(j - 2 - turn, i + MAXLOOP + 1);
+    for (p = i + 1; p <= maxp; p++) {
+      for (q = p + turn + 1; q < j; q++) {
+        pq      = indx[q] + p;
+        type_2  = fc->ptype[pq];
+
+        if ((type_2 == 0) ||
+            (mx->C[pq].len == 0))
+          continue;
+
+        type_2 = rtype[type_2];
+
+        if (P->model_details.noGUclosure)
+          if (no_close || (type_2 == 3) || (type_2 == 4))
+            if ((p > i + 1) || (q < j - 1))
+              continue;
+
+        e = E_IntLoop(p - i - 1,
+                      j - q - 1,
+                      type,
+                      type_2,
+                      S1[i + 1],
+                      S1[j - 1],
+                      S1[p - 1],
+                      S1[q + 1],
+                      P);
+
+        acc_add(acc, &(mx->C[pq]), e, 1.);
+      }
+    }
+
+    /* multibranch loops */
+    if (!no_close) {
+      e = P->MLclosing;
+      if (dangles == 2)
+        e += E_MLstem(rtype[type], S1[j - 1], S1[i + 1], P);
+      else
+        e += E_MLstem(rtype[type], -1, -1, P);
+
+      for (u = i + turn + 2; u < j - turn - 2; u++)
+        acc_add_conv(acc,
+                     &(mx->M[indx[u] + i + 1]),
+                     &(mx->M1[indx[j - 1] + u + 1]),
+                     e);
+    }
+  }
+
+  acc_commit(acc, &(mx->C[ij]));
+}
+
+
+/* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
+PRIVATE void
+fill_ml(vrna_fold_compound_t  *fc,
+        dos_matrices_t        *mx,
+        dos_acc_t             *acc,
+        int                   i,
+        int                   j)
+{
+  int           n, ij, u, u1j, type, turn, dangles, e, e_stem, *indx;
+  short         *S1;
+  vrna_param_t  *P;
+
+  P       = fc->params;
+  n       = (int)fc->length;
+  indx    = fc->jindx;
+  S1      = fc->sequence_encoding;
+  turn    = P->model_details.min_loop_size;
+  dangles = P->model_details.dangles;
+  ij      = indx[j] + i;
+  type    = fc->ptype[ij];
+
+  if (dangles == 2)
+    e_stem = E_MLstem(type, (i == 1) ? S1[n] : S1[i - 1], S1[j + 1], P);
+  else
+    e_stem = E_MLstem(type, -1, -1, P);
+
+  /* E_M1[ij] = E_C[ij] + b, or E_M1[i,j-1] + c */
+  acc_add(acc, &(mx->C[ij]), e_stem, 1.);
+  acc_add(acc, &(mx->M1[indx[j - 1] + i]), P->MLbase, 1.);
+  acc_commit(acc, &(mx->M1[ij]));
+
+  /* E_M[ij] = E_C[ij] + b, or E_M[i,j-1] + c */
+  acc_add(acc, &(mx->C[ij]), e_stem, 1.);
+  acc_add(acc, &(mx->M[indx[j - 1] + i]), P->MLbase, 1.);
+
+  if (j > turn + 2) {
+    for (u = i; u < j; u++) {
+      u1j = indx[j] + u + 1;
+
+      if (mx->C[u1j].len == 0)
+        continue;
+
+      type = fc->ptype[u1j];
+
+      if (dangles == 2)
+        e = E_MLstem(type, S1[u], S1[j + 1], P);
+      else
+        e = E_MLstem(type, -1, -1, P);
+
+      /* [i..u] is unpaired */
+      acc_add(acc, &(mx->C[u1j]), e + (u - i + 1) * P->MLbase, 1.);
+
+      /* [i...u] has at least one stem */
+      acc_add_conv(acc, &(mx->C[u1j]), &(mx->M[indx[u] + i]), e);
+    }
+  }
+
+  acc_commit(acc, &(mx->M[ij]));
+}
+
+
+/* compute counts of the 5' fragments */
+PRIVATE void
+fill_exterior(vrna_fold_compound_t  *fc,
+              dos_matrices_t        *mx,
+              dos_acc_t             *acc)
+{
+  int           n, i, j, ij, type, turn, dangles, e, *indx;
+  short         *S1;
+  vrna_param_t  *P;
+
+  P       = fc->params;
+  n       = (int)fc->length;
+  indx    = fc->jindx;
+  S1      = fc->sequence_encoding;
+  turn    = P->model_details.min_loop_size;
+  dangles = P->model_details.dangles;
+
+  /* only the open chain is possible */
+  for (j = 1; j <= MIN2(turn + 1, n); j++) {
+    acc_add_one(acc, 0);
+    acc_commit(acc, &(mx->F5[j]));
+  }
+
+  for (j = turn + 2; j <= n; j++) {
+    /* j is unpaired */
+    acc_add(acc, &(mx->F5[j - 1]), 0, 1.);
+
+    /* j pairs with 1 */
+    ij    = indx[j] + 1;
+    type  = fc->ptype[ij];
+    e     = 0;
+
+    if (type) {
+      if (dangles == 2)
+        e += E_ExtLoop(type, -1, j < n ? S1[j + 1] : -1, P);
+      else
+        e += E_ExtLoop(type, -1, -1, P);
+    }
+
+    acc_add(acc, &(mx->C[ij]), e, 1.);
+
+    /* j pairs with some other nucleotide */
+    for (i = j - turn - 1; i > 1; i--) {
+      ij    = indx[j] + i;
+      type  = fc->ptype[ij];
+
+      if (type) {
+        if (dangles == 2)
+          e = E_ExtLoop(type, S1[i - 1], j < n ? S1[j + 1] : -1, P);
+        else
+          e = E_ExtLoop(type, -1, -1, P);
+
+        acc_add_conv(acc, &(mx->C[ij]), &(mx->F5[i - 1]), e);
+      }
+    }
+
+    acc_commit(acc, &(mx->F5[j]));
+  }
+}
@@ -0,0 +1,98 @@
+#ifndef VIENNA_RNA_PACKAGE_DENSITY_OF_STATES_H
+#define VIENNA_RNA_PACKAGE_DENSITY_OF_STATES_H
+
+#include <ViennaRNA/fold_compound.h>
+
+/**
+ *
+ *  @file density_of_states.h
+ *  @ingroup  thermodynamics
+ *
+ *  @brief Compute the density of states for an RNA
+ *
+ *  This file includes the interface to all functions related to counting the
+ *  number of secondary structures within each energy band of an RNA.
+ */
+
+
+/**
+ *  @addtogroup  thermodynamics
+ *  @{
+ */
+
+
+/**
+ *  @brief  The density of states of an RNA
+ *
+ *  This is a convenience typedef for #vrna_dos_s, i.e. results as obtained from vrna_dos()
+ */
+typedef struct vrna_dos_s vrna_dos_t;
+
+
+/**
+ *  @brief  The density of states of an RNA
+ *
+ *  The number of secondary structures with free energy @f$ e @f$ is stored in
+ *  @p counts[e - e_min] for all @f$ e_{\text{min}} \leq e \leq e_{\text{max}} @f$.
+ *
+ *  @see vrna_dos(), vrna_dos_free()
+ */
+struct vrna_dos_s {
+  int     e_min;    /**< @brief   The lowest energy in dcal/mol, i.e. the MFE */
+  int     e_max;    /**< @brief   The highest energy in dcal/mol */
+  double  *counts;  /**< @brief   The number of structures per energy band of 0.01 kcal/mol */
+};
+
+
+/**
+ *  @name Density of states interface
+ *  @{
+ */
+
+/**
+ *  @brief  Compute the density of states for an RNA
+ *
+ *  This function counts the number of secondary structures within each energy
+ *  band of width 0.01 kcal/mol, starting at the minimum free energy up to
+ *  the energy threshold @p e_max. The recursions follow the MFE decomposition
+ *  with unique multibranch loop decomposition and store one count per energy
+ *  band in each cell of the dynamic programming matrices. Each cell therefore
+ *  holds a dense array of counts that only spans the energy bands actually
+ *  populated. Cells of the same span are computed in parallel if the library
+ *  has been compiled with OpenMP support.
+ *
+ *  @note Only single RNA sequences (no circular RNAs, no multiple strands)
+ *        and the dangle models @p d0 and @p d2 are supported. Constraints,
+ *        unstructured domains, and grammar extensions are ignored. The
+ *        DP matrices of @p fc remain untouched.
+ *
+ *  @see  vrna_dos_free(), vrna_dos_t
+ *
+ *  @param  fc      The #vrna_fold_compound_t with the RNA sequence to analyze
+ *  @param  e_max   The energy threshold in dcal/mol, i.e. structures with free energy up to @p e_max are counted
+ *  @return         The density of states, or @em NULL upon any failure
+ */
+vrna_dos_t *
+vrna_dos(vrna_fold_compound_t *fc,
+         int                  e_max);
+
+
+/**
+ *  @brief  Free memory occupied by a density of states object
+ *
+ *  @see  vrna_dos()
+ *
+ *  @param  dos   The density of states
+ */
+void
+vrna_dos_free(vrna_dos_t *dos);
+
+
+/* End basic interface */
+/**@}*/
+
+/**
+ * @}
+ */
+
+#endif
@@ -30,6 +30,8 @@ extern char *aligned_line[4];
  */
 extern int  cost_matrix;
 
+#endif
+
 /*  Global type defs for Distance-Package */
 
 /**
@@ -59,6 +61,5 @@ typedef struct {
                  int    sign;
                  float  weight;
                } swString;
-#endif
 
 #endif
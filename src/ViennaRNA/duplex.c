@@ -141,7 +141,7 @@ duplexfold_cu(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       P = vrna_params(&md);
       make_pair_matrix();
     }
@@ -444,7 +444,7 @@ aliduplexfold_cu(const char *s1[],
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       P = vrna_params(&md);
       make_pair_matrix();
     }
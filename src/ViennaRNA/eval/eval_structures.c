@@ -35,7 +35,12 @@
 
 #include <limits.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/structures/pairtable.h"
 #include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/params/default.h"
@@ -59,6 +64,9 @@
 
 #define   ADD_OR_INF(a, b)     (((a) != INF) && ((b) != INF) ?  (a) + (b) : INF)
 
+/* number of sequence/structure pairs a thread processes at once in vrna_eval_batch() */
+#define   EVAL_BATCH_BLOCK_SIZE 256
+
 typedef enum {
   VRNA_STRUCTURE_ELEM_EXT_LOOP  = 0,
   VRNA_STRUCTURE_ELEM_HP_LOOP   = 1,
@@ -83,6 +91,17 @@ typedef struct {
 } vrna_struct_elem_t;
 
 
+/*
+ *  Memory re-used for all structures of a batch, see vrna_eval_structures()
+ */
+typedef struct {
+  unsigned int  size;
+  short         *pt;        /* pair table of the current structure */
+  unsigned int  *branches;  /* pairs whose loops are yet to be evaluated */
+  unsigned int  *stacks;    /* stacking pair indices into P->stack */
+} eval_batch_ws_t;
+
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -179,6 +198,49 @@ print_structure_elements(const char                     *s,
                          vrna_cstr_t                    output_stream);
 
 
+PRIVATE void
+batch_ws_fit(eval_batch_ws_t  *ws,
+             unsigned int     n);
+
+
+PRIVATE void
+batch_ws_free(eval_batch_ws_t *ws);
+
+
+PRIVATE int
+batch_fast_path(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+batch_ptable(const char       *structure,
+             unsigned int     n,
+             eval_batch_ws_t  *ws);
+
+
+PRIVATE int
+eval_pt_fast(vrna_fold_compound_t *fc,
+             const short          *pt,
+             eval_batch_ws_t      *ws,
+             int                  *energy);
+
+
+PRIVATE void
+eval_structures(vrna_fold_compound_t  *fc,
+                const char            **structures,
+                size_t                num,
+                float                 *energies,
+                eval_batch_ws_t       *ws);
+
+
+PRIVATE void
+eval_batch_block(const char       **sequences,
+                 const char       **structures,
+                 size_t           start,
+                 size_t           end,
+                 const vrna_md_t  *md,
+                 float            *energies);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -211,23 +273,28 @@ vrna_eval_structure_v(vrna_fold_compound_t  *fc,
     if (verbosity_level > 0)
       vrna_array_init(elements);
 
-    output_stream = vrna_cstr(fc->length, (file) ? file : stdout);
-    pt            = vrna_ptable(structure);
-    en            = wrap_eval_structure(fc,
-                                        structure,
-                                        pt,
-                                        &elements);
-    if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
-      sequence = fc->cons_seq;
-    else
-      sequence = fc->sequence;
+    pt  = vrna_ptable(structure);
+    en  = wrap_eval_structure(fc,
+                              structure,
+                              pt,
+                              &elements);
 
-    print_structure_elements(sequence,
-                             elements,
-                             output_stream);
+    /* only set up an output stream if there is anything to print */
+    if (elements) {
+      if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
+        sequence = fc->cons_seq;
+      else
+        sequence = fc->sequence;
+
+      output_stream = vrna_cstr(fc->length, (file) ? file : stdout);
+
+      print_structure_elements(sequence,
+                               elements,
+                               output_stream);
 
-    vrna_cstr_fflush(output_stream);
-    vrna_cstr_free(output_stream);
+      vrna_cstr_fflush(output_stream);
+      vrna_cstr_free(output_stream);
+    }
 
     vrna_array_free(elements);
     free(pt);
@@ -293,8 +360,7 @@ vrna_eval_structure_pt_v(vrna_fold_compound_t *fc,
                          int                  verbosity_level,
                          FILE                 *file)
 {
-  int         e;
-  vrna_cstr_t output_stream;
+  int e;
 
   vrna_array(vrna_struct_elem_t) elements = NULL;
 
@@ -313,13 +379,10 @@ vrna_eval_structure_pt_v(vrna_fold_compound_t *fc,
     if (verbosity_level > 0)
       vrna_array_init(elements);
 
-    output_stream = vrna_cstr(fc->length, (file) ? file : stdout);
-    e             = eval_pt(fc,
-                            pt,
-                            &elements);
+    e = eval_pt(fc,
+                pt,
+                &elements);
 
-    vrna_cstr_fflush(output_stream);
-    vrna_cstr_free(output_stream);
     vrna_array_free(elements);
   }
 
@@ -487,11 +550,389 @@ vrna_eval_move_pt(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC int
+vrna_eval_structures(vrna_fold_compound_t *fc,
+                     const char           **structures,
+                     size_t               num,
+                     float                *energies)
+{
+  eval_batch_ws_t ws;
+
+  if ((fc) &&
+      (structures) &&
+      (energies)) {
+    memset(&ws, 0, sizeof(eval_batch_ws_t));
+
+    eval_structures(fc, structures, num, energies, &ws);
+
+    batch_ws_free(&ws);
+
+    return 1;
+  }
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_eval_structures_pt(vrna_fold_compound_t  *fc,
+                        const short           **pts,
+                        size_t                num,
+                        int                   *energies)
+{
+  size_t          k;
+  int             fast;
+  eval_batch_ws_t ws;
+
+  if ((fc) &&
+      (pts) &&
+      (energies)) {
+    memset(&ws, 0, sizeof(eval_batch_ws_t));
+
+    fast = batch_fast_path(fc);
+
+    if (fast)
+      batch_ws_fit(&ws, fc->length);
+
+    for (k = 0; k < num; k++) {
+      if ((!fast) ||
+          (!pts[k]) ||
+          (pts[k][0] != (short)fc->length) ||
+          (!eval_pt_fast(fc, pts[k], &ws, energies + k)))
+        energies[k] = vrna_eval_structure_pt_v(fc, pts[k], VRNA_VERBOSITY_QUIET, NULL);
+    }
+
+    batch_ws_free(&ws);
+
+    return 1;
+  }
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_eval_batch(const char      **sequences,
+                const char      **structures,
+                size_t          num,
+                const vrna_md_t *md,
+                float           *energies,
+                unsigned int    num_threads)
+{
+  size_t  b, num_blocks;
+  int     threads;
+
+  if ((!sequences) ||
+      (!structures) ||
+      (!energies))
+    return 0;
+
+  num_blocks  = (num + EVAL_BATCH_BLOCK_SIZE - 1) / EVAL_BATCH_BLOCK_SIZE;
+  threads     = 1;
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = (unsigned int)omp_get_max_threads();
+
+  if (omp_in_parallel())
+    num_threads = 1;
+
+  threads = (int)MIN2(num_threads, num_blocks);
+#else
+  (void)num_threads;
+#endif
+
+  if (threads > 1) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
+    for (b = 0; b < num_blocks; b++)
+      eval_batch_block(sequences,
+                       structures,
+                       b * EVAL_BATCH_BLOCK_SIZE,
+                       MIN2(num, (b + 1) * EVAL_BATCH_BLOCK_SIZE),
+                       md,
+                       energies);
+#endif
+  } else {
+    eval_batch_block(sequences, structures, 0, num, md, energies);
+  }
+
+  return 1;
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
  #################################
  */
+PRIVATE void
+batch_ws_fit(eval_batch_ws_t  *ws,
+             unsigned int     n)
+{
+  if (ws->size < n) {
+    ws->pt        = (short *)vrna_realloc(ws->pt, sizeof(short) * (n + 2));
+    ws->branches  = (unsigned int *)vrna_realloc(ws->branches, sizeof(unsigned int) * (n + 2));
+    ws->stacks    = (unsigned int *)vrna_realloc(ws->stacks, sizeof(unsigned int) * (n + 2));
+    ws->size      = n;
+  }
+}
+
+
+PRIVATE void
+batch_ws_free(eval_batch_ws_t *ws)
+{
+  free(ws->pt);
+  free(ws->branches);
+  free(ws->stacks);
+  memset(ws, 0, sizeof(eval_batch_ws_t));
+}
+
+
+/*
+ *  Whether structures for this fold compound can be evaluated by eval_pt_fast().
+ *  Everything else, e.g. multiple strands, circular RNAs, G-Quadruplexes, soft
+ *  constraints or unstructured domains, takes the default route
+ */
+PRIVATE int
+batch_fast_path(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md = &(fc->params->model_details);
+
+  return (fc->type == VRNA_FC_TYPE_SINGLE) &&
+         (fc->strands == 1) &&
+         (fc->length < SHRT_MAX) &&
+         (!md->circ) &&
+         (!md->gquad) &&
+         (!fc->sc) &&
+         (!fc->domains_up);
+}
+
+
+/*
+ *  Convert a plain dot-bracket string of length n into the pair table
+ *  of the workspace. Returns 0 for any other symbol or unbalanced brackets
+ */
+PRIVATE int
+batch_ptable(const char       *structure,
+             unsigned int     n,
+             eval_batch_ws_t  *ws)
+{
+  short         *pt;
+  unsigned int  i, j, open;
+
+  pt    = ws->pt;
+  pt[0] = (short)n;
+
+  for (open = 0, i = 1; i <= n; i++) {
+    switch (structure[i - 1]) {
+      case '.':
+        pt[i] = 0;
+        break;
+
+      case '(':
+        ws->branches[open++]  = i;
+        pt[i]                 = 0;
+        break;
+
+      case ')':
+        if (open == 0)
+          return 0;
+
+        j     = ws->branches[--open];
+        pt[i] = (short)j;
+        pt[j] = (short)i;
+        break;
+
+      default:
+        return 0;
+    }
+  }
+
+  return (open == 0) ? 1 : 0;
+}
+
+
+/*
+ *  Iterative loop decomposition of a single-stranded, linear structure without
+ *  any printing. Energies of all stacking pairs are collected as indices into
+ *  the stack parameter table and summed up by a single gather operation at the
+ *  end. Whenever a loop is encountered that the default evaluation would warn
+ *  about, e.g. non-canonical pairs or forbidden loops, we return 0 and leave
+ *  the structure to eval_pt() instead
+ */
+PRIVATE int
+eval_pt_fast(vrna_fold_compound_t *fc,
+             const short          *pt,
+             eval_batch_ws_t      *ws,
+             int                  *energy)
+{
+  short         *s;
+  unsigned int  i, j, p, q, n, n_branches, n_stacks, type, type_2;
+  int           e, ee;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  n           = fc->length;
+  s           = fc->sequence_encoding2;
+  P           = fc->params;
+  md          = &(P->model_details);
+  n_branches  = 0;
+  n_stacks    = 0;
+
+  e = energy_of_extLoop_pt(fc, 0, pt);
+  if (e == INF)
+    return 0;
+
+  for (i = 1; i <= n; i++)
+    if ((unsigned int)pt[i] > i) {
+      ws->branches[n_branches++]  = i;
+      i                           = (unsigned int)pt[i];
+    }
+
+  while (n_branches > 0) {
+    i     = ws->branches[--n_branches];
+    j     = (unsigned int)pt[i];
+    type  = md->pair[s[i]][s[j]];
+
+    if (type == 0)
+      return 0;
+
+    /* process all stacks and internal loops */
+    while (1) {
+      p = i;
+      q = j;
+      while (pt[++p] == 0);
+      while (pt[--q] == 0);
+
+      if (((unsigned int)pt[q] != p) || (p > q))
+        break;
+
+      type_2 = md->pair[s[q]][s[p]];
+
+      if (type_2 == 0)
+        return 0;
+
+      if ((p == i + 1) && (q == j - 1)) {
+        if (type == 0)
+          return 0;
+
+        ws->stacks[n_stacks++] = type * (NBPAIRS + 1) + type_2;
+      } else {
+        ee = vrna_eval_internal(fc, i, j, p, q, VRNA_EVAL_LOOP_NO_HC);
+        if (ee == INF)
+          return 0;
+
+        e += ee;
+      }
+
+      i     = p;
+      j     = q;
+      type  = md->pair[s[p]][s[q]];
+    }
+
+    if (p > q) {
+      /* hairpin */
+      ee = vrna_eval_hairpin(fc, i, j, VRNA_EVAL_LOOP_NO_HC);
+    } else {
+      /* multibranch loop, enqueue its branches */
+      ee = energy_of_ml_pt(fc, i, pt);
+
+      while (p < j) {
+        ws->branches[n_branches++]  = p;
+        p                           = (unsigned int)pt[p];
+        while (pt[++p] == 0);
+      }
+    }
+
+    if (ee == INF)
+      return 0;
+
+    e += ee;
+  }
+
+  ee = vrna_fun_gather_sum(&(P->stack[0][0]), ws->stacks, n_stacks);
+  if (ee == INF)
+    return 0;
+
+  *energy = e + ee + (int)n_stacks * P->SaltStack;
+
+  return 1;
+}
+
+
+PRIVATE void
+eval_structures(vrna_fold_compound_t  *fc,
+                const char            **structures,
+                size_t                num,
+                float                 *energies,
+                eval_batch_ws_t       *ws)
+{
+  size_t        k;
+  unsigned int  n;
+  int           e, fast;
+
+  n     = fc->length;
+  fast  = batch_fast_path(fc);
+
+  if (fast)
+    batch_ws_fit(ws, n);
+
+  for (k = 0; k < num; k++) {
+    if ((fast) &&
+        (structures[k]) &&
+        (strlen(structures[k]) == n) &&
+        (batch_ptable(structures[k], n, ws)) &&
+        (eval_pt_fast(fc, ws->pt, ws, &e)))
+      energies[k] = (float)e / 100.;
+    else
+      energies[k] = vrna_eval_structure_v(fc, structures[k], VRNA_VERBOSITY_QUIET, NULL);
+  }
+}
+
+
+/*
+ *  Evaluate pairs [start, end) where each run of identical sequences
+ *  shares a single fold compound
+ */
+PRIVATE void
+eval_batch_block(const char       **sequences,
+                 const char       **structures,
+                 size_t           start,
+                 size_t           end,
+                 const vrna_md_t  *md,
+                 float            *energies)
+{
+  size_t                i, k;
+  eval_batch_ws_t       ws;
+  vrna_fold_compound_t  *fc;
+
+  memset(&ws, 0, sizeof(eval_batch_ws_t));
+
+  for (i = start; i < end; i = k) {
+    for (k = i + 1; k < end; k++)
+      if ((!sequences[i]) ||
+          (!sequences[k]) ||
+          (strcmp(sequences[i], sequences[k])))
+        break;
+
+    fc = vrna_fold_compound(sequences[i],
+                            md,
+                            VRNA_OPTION_MFE | VRNA_OPTION_EVAL_ONLY);
+
+    if (fc) {
+      eval_structures(fc, structures + i, k - i, energies + i, &ws);
+      vrna_fold_compound_free(fc);
+    } else {
+      for (size_t l = i; l < k; l++)
+        energies[l] = (float)INF / 100.;
+    }
+  }
+
+  batch_ws_free(&ws);
+}
+
+
 PRIVATE float
 wrap_eval_structure(vrna_fold_compound_t            *fc,
                     const char                      *structure,
@@ -748,7 +748,7 @@ recycle_last_call(const char    *string,
     seq                       = vrna_cut_point_insert(string, cut_point);
     backward_compat_compound  = fc = vrna_fold_compound(seq, md, VRNA_OPTION_EVAL_ONLY);
     if (P) {
-      free(fc->params);
+      vrna_params_free(fc->params);
       fc->params = get_updated_params(P, 1);
     }
 
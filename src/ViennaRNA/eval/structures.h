@@ -236,6 +236,100 @@ vrna_eval_structure_pt_v(vrna_fold_compound_t *fc,
 /**@}*/
 
 
+/**
+ *  @name Batch Energy Evaluation
+ *  @{
+ */
+
+/**
+ *  @brief Calculate the free energies of many structures for the same sequence
+ *
+ *  This function evaluates @p num secondary structures in dot-bracket notation
+ *  for the sequence stored in @p fc and writes their free energies in kcal/mol
+ *  to @p energies, i.e. the result is identical to calling vrna_eval_structure()
+ *  for each structure individually. The pair table and loop decomposition
+ *  buffers are allocated only once for the entire batch and all stacking pair
+ *  energies of a structure are looked up at once, using SIMD gather instructions
+ *  where available.
+ *
+ *  Structures with loops that require special treatment, e.g. non-canonical base
+ *  pairs, forbidden loops, or single structures that can not be parsed, are passed
+ *  on to the default evaluation and may produce the usual warnings.
+ *
+ *  @see vrna_eval_structure(), vrna_eval_structures_pt(), vrna_eval_batch()
+ *
+ *  @param fc         A vrna_fold_compound_t containing the energy parameters and model details
+ *  @param structures The secondary structures in dot-bracket notation
+ *  @param num        The number of structures
+ *  @param energies   An array of size at least @p num where the free energies (in kcal/mol) will be stored
+ *  @return           1 on success, 0 otherwise
+ */
+int
+vrna_eval_structures(vrna_fold_compound_t *fc,
+                     const char           **structures,
+                     size_t               num,
+                     float                *energies);
+
+
+/**
+ *  @brief Calculate the free energies of many structures in pair table format for the same sequence
+ *
+ *  Same as vrna_eval_structures() but for structures provided as pair tables. The
+ *  energies are stored in dcal/mol, i.e. the result is identical to calling
+ *  vrna_eval_structure_pt() for each structure individually.
+ *
+ *  @see vrna_eval_structure_pt(), vrna_eval_structures()
+ *
+ *  @param fc         A vrna_fold_compound_t containing the energy parameters and model details
+ *  @param pts        The secondary structures as pair tables
+ *  @param num        The number of structures
+ *  @param energies   An array of size at least @p num where the free energies (in dcal/mol) will be stored
+ *  @return           1 on success, 0 otherwise
+ */
+int
+vrna_eval_structures_pt(vrna_fold_compound_t  *fc,
+                        const short           **pts,
+                        size_t                num,
+                        int                   *energies);
+
+
+/**
+ *  @brief Calculate the free energies of many sequence/structure pairs
+ *
+ *  Evaluates the structure @p structures[i] for sequence @p sequences[i] for
+ *  all @p num pairs and stores the free energies in kcal/mol in @p energies.
+ *  Consecutive pairs with identical sequences share a single #vrna_fold_compound_t
+ *  and are evaluated by vrna_eval_structures(). Sequences may consist of multiple
+ *  strands separated by '&', the corresponding structures must not contain
+ *  strand delimiters. Energies for sequences that could not be processed are set
+ *  to @f$ \infty @f$, i.e. @p INF / 100.
+ *
+ *  If RNAlib has been compiled with OpenMP support, the pairs are processed by
+ *  @p num_threads threads in parallel. A value of 0 uses the OpenMP default.
+ *
+ *  @see vrna_eval_structures(), vrna_eval()
+ *
+ *  @param sequences    The RNA sequences
+ *  @param structures   The corresponding secondary structures in dot-bracket notation
+ *  @param num          The number of sequence/structure pairs
+ *  @param md           The model details (may be NULL to use default settings)
+ *  @param energies     An array of size at least @p num where the free energies (in kcal/mol) will be stored
+ *  @param num_threads  The number of threads to use
+ *  @return             1 on success, 0 otherwise
+ */
+int
+vrna_eval_batch(const char      **sequences,
+                const char      **structures,
+                size_t          num,
+                const vrna_md_t *md,
+                float           *energies,
+                unsigned int    num_threads);
+
+
+/* End batch eval interface */
+/**@}*/
+
+
 /**
  *  @name Simplified Energy Evaluation with Sequence and Dot-Bracket Strings
  *  @{
@@ -59,6 +59,8 @@
 #define WITH_PTYPE          1L    /* passed to set_fold_compound() to indicate that we need to set fc->ptype */
 #define WITH_PTYPE_COMPAT   2L    /* passed to set_fold_compound() to indicate that we need to set fc->ptype_compat */
 
+#define ENGINE_OPTIONS      (VRNA_OPTION_SPARSE | VRNA_OPTION_BEAM)  /* option flags that select alternative recursion engines */
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -125,8 +127,8 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
     vrna_mx_pf_free(fc);
     free(fc->iindx);
     free(fc->jindx);
-    free(fc->params);
-    free(fc->exp_params);
+    vrna_params_free(fc->params);
+    vrna_exp_params_free(fc->exp_params);
 
     vrna_hc_free(fc->hc);
     vrna_ud_remove(fc);
@@ -253,6 +255,15 @@ vrna_fold_compound(const char       *sequence,
       /* add DP matrices */
       vrna_mx_add(fc, VRNA_MX_WINDOW, options);
     }
+  } else if ((options & VRNA_OPTION_BEAM) &&
+             (!(options & VRNA_OPTION_EVAL_ONLY))) {
+    /*
+     *  the beam search engine evaluates pair types and default hard constraints
+     *  on the fly and does without DP matrices. Hard constraints are only added
+     *  once they are requested, and everything else is prepared on demand when
+     *  falling back to the default recursions
+     */
+    set_fold_compound(fc, options, aux_options);
   } else {
     /* regular global structure prediction */
     aux_options |= WITH_PTYPE;
@@ -266,7 +277,7 @@ vrna_fold_compound(const char       *sequence,
       /* add default hard constraints */
       vrna_hc_init(fc);
 
-      /* add DP matrices (if required) */
+      /* add DP matrices */
       vrna_mx_add(fc, VRNA_MX_DEFAULT, options);
     }
   }
@@ -613,7 +624,7 @@ add_params(vrna_fold_compound_t *fc,
    */
   if (fc->params) {
     if (memcmp(md_p, &(fc->params->model_details), sizeof(vrna_md_t)) != 0) {
-      free(fc->params);
+      vrna_params_free(fc->params);
       fc->params = NULL;
     }
   }
@@ -639,6 +650,9 @@ set_fold_compound(vrna_fold_compound_t  *fc,
 
   md_p = &(fc->params->model_details);
 
+  fc->engine    = options & ENGINE_OPTIONS;
+  fc->beam_size = VRNA_BEAM_SIZE_DEFAULT;
+
   switch (fc->type) {
     case VRNA_FC_TYPE_SINGLE:
       sequence = fc->sequence;
@@ -967,5 +981,10 @@ nullify(vrna_fold_compound_t *fc)
 #ifdef VRNA_WITH_SVM
     fc->zscore_data = NULL;
 #endif
+
+    fc->engine      = 0;
+    fc->beam_size   = VRNA_BEAM_SIZE_DEFAULT;
+    fc->beam_probs  = NULL;
+    fc->beam_energy = 0.;
   }
 }
@@ -387,6 +387,20 @@ struct {
   /**
    *  @}
    */
+
+  /**
+   *  @name Additional data fields for alternative recursion engines
+   *  @{
+   */
+  unsigned int  engine;           /**<  @brief  Recursion engine flags requested upon creation, e.g. #VRNA_OPTION_SPARSE */
+  unsigned int  beam_size;        /**<  @brief  Number of states retained per position and state type by the
+                                   *            beam search engine (#VRNA_OPTION_BEAM), 0 disables pruning
+                                   */
+  struct vrna_elem_prob_s *beam_probs;  /**<  @brief  Base pair probabilities obtained from the beam search engine */
+  double        beam_energy;      /**<  @brief  Ensemble free energy in kcal/mol obtained from the beam search engine */
+  /**
+   *  @}
+   */
 };
 
 
@@ -440,6 +454,55 @@ struct {
 #define VRNA_OPTION_WINDOW_F5       (VRNA_OPTION_WINDOW | VRNA_OPTION_F5)
 #define VRNA_OPTION_WINDOW_F3       (VRNA_OPTION_WINDOW | VRNA_OPTION_F3)
 
+/**
+ *  @brief  Option flag to request sparsified recursions for global structure prediction
+ *
+ *  Only split points that may actually contribute to the optimum (candidates) are
+ *  considered in the multibranch loop decomposition. The results are identical to
+ *  the default recursions. Whenever the current model settings do not permit the
+ *  sparsification, the default recursions are used instead. Note, that only the
+ *  number of operations is reduced. All DP matrices, including @p f5, @p fML, and
+ *  @p fM1, are still allocated in full, and the candidate lists require additional
+ *  memory on top of that.
+ *
+ *  For the partition function and base pair probabilities, multibranch and exterior
+ *  loop splits are restricted to segments that start with a possible stem, and the
+ *  outside recursions only visit enclosing pairs with non-zero contributions. Again,
+ *  the results are the same as for the default recursions, up to rounding.
+ *
+ *  @see vrna_fold_compound(), vrna_fold_compound_comparative(), vrna_mfe(), vrna_pf(), #vrna_fold_compound_t.engine
+ */
+#define VRNA_OPTION_SPARSE          (1 << 7)
+
+/**
+ *  @brief  Option flag to request the approximate beam search engine for global structure prediction
+ *
+ *  Instead of the cubic time dynamic programming recursions, MFE and partition function are
+ *  obtained from a left-to-right beam search (LinearFold/LinearPartition) that only retains the
+ *  #vrna_fold_compound_t.beam_size best partial structures per sequence position and state type.
+ *  Hence, time and memory of the recursions scale linearly with the sequence length. Neither DP
+ *  matrices nor the quadratic pair type and hard constraint arrays are allocated. Default hard
+ *  constraints are derived from the sequence on the fly instead, and the full hard constraint
+ *  data structure is only created once hard constraints are added. The results are approximate,
+ *  but they use the same energy parameters and hard constraints as the default recursions. Base pair probabilities are stored as a sparse
+ *  list that is transparently used by vrna_plist_from_probs(), vrna_centroid(), vrna_MEA(), and
+ *  similar functions.
+ *
+ *  Models with circular RNAs, G-quadruplexes, multiple strands, lonely pair restrictions, odd
+ *  dangle models, or generic constraint callbacks are not supported by the beam search. In
+ *  such cases, the default recursions are used instead.
+ *
+ *  @see vrna_fold_compound(), vrna_mfe_beam(), vrna_pf_beam(), #VRNA_BEAM_SIZE_DEFAULT
+ */
+#define VRNA_OPTION_BEAM            (1 << 8)
+
+/**
+ *  @brief  Default beam size for the beam search engine
+ *
+ *  @see #VRNA_OPTION_BEAM, #vrna_fold_compound_t.beam_size
+ */
+#define VRNA_BEAM_SIZE_DEFAULT      100
+
 /**
  *  @brief  Retrieve a #vrna_fold_compound_t data structure for single sequences and hybridizing sequences
  *
@@ -457,6 +520,7 @@ struct {
  *  * #VRNA_OPTION_MFE      - @copybrief #VRNA_OPTION_MFE
  *  * #VRNA_OPTION_PF       - @copybrief #VRNA_OPTION_PF
  *  * #VRNA_OPTION_WINDOW   - @copybrief #VRNA_OPTION_WINDOW
+ *  * #VRNA_OPTION_SPARSE   - @copybrief #VRNA_OPTION_SPARSE
  *
  *  The above options may be OR-ed together.
  *
@@ -499,6 +563,7 @@ vrna_fold_compound(const char       *sequence,
  *  * #VRNA_OPTION_MFE      - @copybrief #VRNA_OPTION_MFE
  *  * #VRNA_OPTION_PF       - @copybrief #VRNA_OPTION_PF
  *  * #VRNA_OPTION_WINDOW   - @copybrief #VRNA_OPTION_WINDOW
+ *  * #VRNA_OPTION_SPARSE   - @copybrief #VRNA_OPTION_SPARSE
  *
  *  The above options may be OR-ed together.
  *
@@ -2,14 +2,18 @@
 #include  <stdlib.h>
 #include  <math.h>
 
+#ifdef _OPENMP
+#include  <omp.h>
+#endif
+
 #include  "ViennaRNA/utils/basic.h"
+#include  "ViennaRNA/utils/strings.h"
+#include  "ViennaRNA/utils/log.h"
 #include  "ViennaRNA/params/constants.h"
 #include  "ViennaRNA/mfe/global.h"
 #include  "ViennaRNA/partfunc/global.h"
 #include  "ViennaRNA/heat_capacity.h"
 
-#define MAXWIDTH  201
-
 struct data_collector {
   struct vrna_heat_capacity_s *data;
   size_t                      num_entries;
@@ -29,6 +33,29 @@ store_results_cb(float  t,
                  void   *data);
 
 
+PRIVATE void
+free_energies(vrna_fold_compound_t  *fc,
+              vrna_md_t             *md_p,
+              const double          *temperatures,
+              float                 *F,
+              size_t                from,
+              size_t                to,
+              float                 h);
+
+
+#ifdef _OPENMP
+PRIVATE int
+sweep_replicable(vrna_fold_compound_t *fc);
+
+
+PRIVATE vrna_fold_compound_t *
+replicate_fold_compound(vrna_fold_compound_t  *fc,
+                        vrna_md_t             *md);
+
+
+#endif
+
+
 PUBLIC struct vrna_heat_capacity_s *
 vrna_heat_capacity_simple(const char    *sequence,
                           float         T_min,
@@ -93,18 +120,32 @@ vrna_heat_capacity(vrna_fold_compound_t *fc,
 
 
 PUBLIC int
-vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
-                      float                       T_min,
-                      float                       T_max,
-                      float                       h,
-                      unsigned int                m,
-                      vrna_heat_capacity_f cb,
-                      void                        *data)
+vrna_heat_capacity_cb(vrna_fold_compound_t  *fc,
+                      float                 T_min,
+                      float                 T_max,
+                      float                 h,
+                      unsigned int          m,
+                      vrna_heat_capacity_f  cb,
+                      void                  *data)
 {
-  unsigned int  i, n;
+  return vrna_heat_capacity_cb_mt(fc, T_min, T_max, h, m, 0, cb, data);
+}
+
+
+PUBLIC int
+vrna_heat_capacity_cb_mt(vrna_fold_compound_t *fc,
+                         float                T_min,
+                         float                T_max,
+                         float                h,
+                         unsigned int         m,
+                         unsigned int         num_threads,
+                         vrna_heat_capacity_f cb,
+                         void                 *data)
+{
+  unsigned int  i, k, num_points, num_results, threads;
   int           ret;
-  float         hc, F[MAXWIDTH];
-  double        min_en;
+  float         hc, *F;
+  double        t, *temperatures;
   vrna_md_t     md, md_init;
 
   ret = 0;
@@ -128,8 +169,43 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
     if (h > (T_max - T_min))
       h = T_max - T_min;
 
-    /* now for the actual algorithm */
-    n       = fc->length;
+    if (h <= 0.) {
+      vrna_log_warning("Temperature increment must be positive for heat capacity computations");
+      return ret;
+    }
+
+    /*
+     *  collect the temperatures in the order the sliding window passes
+     *  through them. The window of 2 * m + 1 ensemble free energies
+     *  centered at the r-th result ends with the point 2 * m + r, such
+     *  that we require 2 * m + num_results points in total
+     */
+    temperatures  = NULL;
+    num_points    = 0;
+    num_results   = 0;
+    t             = T_min - m * h;
+
+    for (i = 0; i < 2 * m + 1; i++, t += h) {
+      temperatures                = (double *)vrna_realloc(temperatures,
+                                                           sizeof(double) * (num_points + 1));
+      temperatures[num_points++]  = t;
+    }
+
+    for (; t <= (T_max + m * h + h); t += h, num_results++) {
+      temperatures                = (double *)vrna_realloc(temperatures,
+                                                           sizeof(double) * (num_points + 1));
+      temperatures[num_points++]  = t;
+    }
+
+    if (num_results == 0) {
+      free(temperatures);
+      return 1;
+    }
+
+    /* the temperature that follows the last result requires no free energy */
+    num_points--;
+
+    F       = (float *)vrna_alloc(sizeof(float) * num_points);
     md_init = md = fc->params->model_details;
 
     /* required for vrna_exp_param_rescale() in subsequent calls */
@@ -137,56 +213,160 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
     md.backtrack    = 0;
     md.compute_bpp  = 0;
 
-    md.temperature = T_min - m * h;
+    threads = 1;
+
+#ifdef _OPENMP
+    if (num_threads == 0)
+      num_threads = (unsigned int)omp_get_max_threads();
+
+    if (omp_in_parallel())
+      num_threads = 1;
+
+    if (sweep_replicable(fc))
+      threads = MIN2(num_threads, num_points);
+#endif
+
+    if (threads > 1) {
+#ifdef _OPENMP
+      /*
+       *  each thread processes a consecutive chunk of temperatures with its
+       *  own fold compound, such that all but the first point of a chunk can
+       *  use the free energy of the previous temperature to scale the Boltzmann
+       *  factors
+       */
+#pragma omp parallel for schedule(static, 1) num_threads(threads)
+      for (k = 0; k < threads; k++) {
+        vrna_fold_compound_t *fc_thread = replicate_fold_compound(fc, &md);
+
+        free_energies(fc_thread,
+                      &md,
+                      temperatures,
+                      F,
+                      (size_t)k * num_points / threads,
+                      (size_t)(k + 1) * num_points / threads,
+                      h);
+
+        vrna_fold_compound_free(fc_thread);
+      }
+#endif
+    } else {
+      free_energies(fc, &md, temperatures, F, 0, num_points, h);
+
+      /* restore original state of (the model of) the fold_compound */
+      vrna_params_reset(fc, &md_init);
+    }
+
+    /* numerical differentiation over a sliding window, in order of temperature */
+    for (i = 0; i < num_results; i++) {
+      t   = temperatures[2 * m + 1 + i];
+      hc  = -ddiff(F + i, h, m) * (t + K0 - m * h - h);
+
+      /* return results */
+      cb((t - (float)m * h - h), hc, data);
+    }
+
+    free(temperatures);
+    free(F);
+
+    ret = 1;
+  }
+
+  return ret;
+}
+
+
+PRIVATE void
+free_energies(vrna_fold_compound_t  *fc,
+              vrna_md_t             *md_p,
+              const double          *temperatures,
+              float                 *F,
+              size_t                from,
+              size_t                to,
+              float                 h)
+{
+  size_t    i;
+  double    min_en;
+  vrna_md_t md;
+
+  md = *md_p;
+
+  for (i = from; i < to; i++) {
+    /* reset all energy parameters according to temperature changes */
+    md.temperature = temperatures[i];
     vrna_params_reset(fc, &md);
 
-    min_en = (double)vrna_mfe(fc, NULL);
+    if (i == from)
+      min_en = (double)vrna_mfe(fc, NULL);
+    else
+      min_en = F[i - 1] + h * 0.00727 * fc->length;
 
     vrna_exp_params_rescale(fc, &min_en);
 
-    for (i = 0; i < 2 * m + 1; i++) {
-      F[i] = vrna_pf(fc, NULL);
-      /* increase temperature */
-      md.temperature += h;
-      /* reset all energy parameters according to temperature changes */
-      vrna_params_reset(fc, &md);
+    F[i] = vrna_pf(fc, NULL);
+  }
+}
 
-      min_en = F[i] + h * 0.00727 * n;
 
-      vrna_exp_params_rescale(fc, &min_en);
-    }
+#ifdef _OPENMP
 
-    while (md.temperature <= (T_max + m * h + h)) {
-      hc = -ddiff(F, h, m) * (md.temperature + K0 - m * h - h);
+/*
+ *  Check whether we are able to create independent copies of a
+ *  fold compound from its sequence(s) and model details alone, i.e.
+ *  there are no constraints or grammar extensions attached to it
+ */
+PRIVATE int
+sweep_replicable(vrna_fold_compound_t *fc)
+{
+  if ((fc->hc) &&
+      ((fc->hc->depot) || (fc->hc->f)))
+    return 0;
 
-      /* return results */
-      cb((md.temperature - (float)m * h - h), hc, data);
+  if ((fc->domains_up) || (fc->aux_grammar) || (fc->strands > 2))
+    return 0;
 
-      for (i = 0; i < 2 * m; i++)
-        F[i] = F[i + 1];
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      return (fc->sc == NULL) ? 1 : 0;
 
-      F[2 * m] = vrna_pf(fc, NULL);
+    case VRNA_FC_TYPE_COMPARATIVE:
+      return (fc->scs == NULL) ? 1 : 0;
 
-      /*       printf("%g\n", F[2*m]);*/
-      md.temperature += h;
+    default:
+      return 0;
+  }
+}
 
-      vrna_params_reset(fc, &md);
 
-      min_en = F[i] + h * 0.00727 * n;
+PRIVATE vrna_fold_compound_t *
+replicate_fold_compound(vrna_fold_compound_t  *fc,
+                        vrna_md_t             *md)
+{
+  char                  *sequence;
+  vrna_fold_compound_t  *fc_copy;
 
-      vrna_exp_params_rescale(fc, &min_en);
-    }
+  if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
+    return vrna_fold_compound_comparative((const char **)fc->sequences,
+                                          md,
+                                          VRNA_OPTION_DEFAULT);
 
-    /* restore original state of (the model of) the fold_compound */
-    vrna_params_reset(fc, &md_init);
+  sequence = vrna_strdup_printf("%s", fc->sequence);
 
-    ret = 1;
+  if (fc->strands > 1) {
+    free(sequence);
+    sequence = vrna_cut_point_insert(fc->sequence, (int)fc->strand_start[1]);
   }
 
-  return ret;
+  fc_copy = vrna_fold_compound(sequence, md, VRNA_OPTION_DEFAULT);
+
+  free(sequence);
+
+  return fc_copy;
 }
 
 
+#endif
+
+
 PRIVATE float
 ddiff(float f[],
       float h,
@@ -135,7 +135,12 @@ vrna_heat_capacity(vrna_fold_compound_t *fc,
  *  to @f$ 2 \cdot mpoints + 1 @f$ data points to calculate 2nd derivatives. Increasing this
  *  parameter produces a smoother curve.
  *
- *  @see  vrna_heat_capacity(), vrna_heat_capacity_f
+ *  @note If compiled with OpenMP support, the ensemble free energies are computed
+ *        with the default number of threads, unless this function is called from
+ *        within a parallel region. Use vrna_heat_capacity_cb_mt() to control the
+ *        number of threads.
+ *
+ *  @see  vrna_heat_capacity(), vrna_heat_capacity_cb_mt(), vrna_heat_capacity_f
  *
  *  @param  fc            The #vrna_fold_compound_t with the RNA sequence to analyze
  *  @param  T_min         Lowest temperature in &deg;C
@@ -156,6 +161,43 @@ vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
                       void                        *data);
 
 
+/**
+ *  @brief  Compute the specific heat for an RNA using multiple threads (callback variant)
+ *
+ *  Same as vrna_heat_capacity_cb() but with control over the number of threads
+ *  that compute the ensemble free energies of the individual temperatures. The
+ *  temperature range is split into consecutive chunks that are processed in parallel,
+ *  each with its own copy of the fold compound. The numerical differentiation and
+ *  callback invocations still happen in the calling thread and in order of increasing
+ *  temperature.
+ *
+ *  Copies are created from the sequence(s) and the model details of @p fc. Hence,
+ *  if constraints, unstructured domains, or grammar extensions are attached to @p fc,
+ *  the computations fall back to a single thread that operates on @p fc directly.
+ *
+ *  @see  vrna_heat_capacity_cb(), vrna_heat_capacity_f
+ *
+ *  @param  fc            The #vrna_fold_compound_t with the RNA sequence to analyze
+ *  @param  T_min         Lowest temperature in &deg;C
+ *  @param  T_max         Highest temperature in &deg;C
+ *  @param  T_increment   Stepsize for temperature incrementation in &deg;C (a reasonable choice might be 1&deg;C)
+ *  @param  mpoints       The number of interpolation points to calculate 2nd derivative (a reasonable choice might be 2, min: 1, max: 100)
+ *  @param  num_threads   The number of threads to use (0 for the default number)
+ *  @param  cb            The user-defined callback function that receives the individual results
+ *  @param  data          An arbitrary data structure that will be passed to the callback in conjunction with the results
+ *  @return               Returns 0 upon failure, and non-zero otherwise
+ */
+int
+vrna_heat_capacity_cb_mt(vrna_fold_compound_t *fc,
+                         float                T_min,
+                         float                T_max,
+                         float                T_increment,
+                         unsigned int         mpoints,
+                         unsigned int         num_threads,
+                         vrna_heat_capacity_f cb,
+                         void                 *data);
+
+
 /* End basic interface */
 /**@}*/
 
@@ -0,0 +1,109 @@
+#ifndef VRNA_INTERN_ARENA_H
+#define VRNA_INTERN_ARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ViennaRNA/utils/basic.h>
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/*
+ *  Simple memory arena (bump allocator). Memory is handed out from large
+ *  blocks and can only be released all at once, which avoids the overhead
+ *  of many small allocations that live until the arena is destroyed, e.g.
+ *  the cells of the distance class DP matrices. Allocation is thread-safe
+ *  with respect to OpenMP threads.
+ */
+
+#define ARENA_BLOCK_SIZE  (1UL << 20)
+#define ARENA_ALIGN       (sizeof(double) > sizeof(void *) ? sizeof(double) : sizeof(void *))
+
+typedef struct arena_block_s {
+  struct arena_block_s  *next;
+  size_t                size;
+  size_t                used;
+} arena_block_t;
+
+struct vrna_mx_arena_s {
+  arena_block_t *blocks;    /* current block first */
+  size_t        allocated;  /* total number of bytes in all blocks */
+};
+
+typedef struct vrna_mx_arena_s vrna_mx_arena_t;
+
+
+PRIVATE INLINE vrna_mx_arena_t *
+arena_init(void)
+{
+  return (vrna_mx_arena_t *)vrna_alloc(sizeof(vrna_mx_arena_t));
+}
+
+
+PRIVATE INLINE void *
+arena_alloc(vrna_mx_arena_t *arena,
+            size_t          size)
+{
+  size_t        header;
+  void          *mem;
+  arena_block_t *b;
+
+  header  = (sizeof(arena_block_t) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+  size    = (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+  mem     = NULL;
+
+#ifdef _OPENMP
+#pragma omp critical (vrna_mx_arena)
+#endif
+  {
+    b = arena->blocks;
+
+    if ((!b) ||
+        (b->size - b->used < size)) {
+      size_t block_size = MAX2(ARENA_BLOCK_SIZE, size);
+
+      b             = (arena_block_t *)vrna_alloc(header + block_size);
+      b->size       = block_size;
+      b->used       = 0;
+      arena->allocated += block_size;
+
+      /* keep the current block in front if the new one is an oversized single allocation */
+      if ((block_size > ARENA_BLOCK_SIZE) &&
+          (arena->blocks)) {
+        b->next             = arena->blocks->next;
+        arena->blocks->next = b;
+      } else {
+        b->next       = arena->blocks;
+        arena->blocks = b;
+      }
+    }
+
+    mem     = (char *)b + header + b->used;
+    b->used += size;
+  }
+
+  return mem;
+}
+
+
+PRIVATE INLINE void
+arena_free(vrna_mx_arena_t *arena)
+{
+  arena_block_t *b, *next;
+
+  if (arena) {
+    for (b = arena->blocks; b; b = next) {
+      next = b->next;
+      free(b);
+    }
+
+    free(arena);
+  }
+}
+
+
+#endif
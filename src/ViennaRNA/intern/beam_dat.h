@@ -0,0 +1,144 @@
+#ifndef VRNA_INTERN_BEAM_DAT_H
+#define VRNA_INTERN_BEAM_DAT_H
+
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/params/basic.h"
+
+/*
+ *  Left-to-right beam search (LinearFold/LinearPartition style) shared by
+ *  the MFE and the partition function variant of the #VRNA_OPTION_BEAM
+ *  engine. For each position j and each state type we keep a bucket of
+ *  states keyed by the 5' position i of the span [i:j]. Before a bucket
+ *  is expanded, only its beam_size best states are retained, where states
+ *  are ranked by their own score plus the score of the exterior loop
+ *  prefix [1:i-1].
+ *
+ *  The same transitions are used for the MFE (min, +), the inside (+, *)
+ *  and the outside pass. The latter simply replays the transitions of all
+ *  surviving states from right to left and propagates the outside weight
+ *  of the target back to its sources.
+ *
+ *  The implementation resides in mfe/beam.c. Its entry points below are
+ *  shared by mfe/mfe_beam.c and partfunc/pf_beam.c only, and are hidden
+ *  from the symbol table of the shared library.
+ */
+
+#if defined(__clang__) || defined(__GNUC__)
+# define BEAM_INTERNAL __attribute__((visibility("hidden")))
+#else
+# define BEAM_INTERNAL
+#endif
+
+#define BEAM_MODE_MFE         0U
+#define BEAM_MODE_INSIDE      1U
+#define BEAM_MODE_OUTSIDE     2U
+
+#define BEAM_H                0U  /* hairpin loop candidates, (i,j) yet to be committed */
+#define BEAM_MULTI            1U  /* multibranch loop with closing pair (i,j) yet to be committed */
+#define BEAM_P                2U  /* base pair (i,j) */
+#define BEAM_M2               3U  /* multibranch loop segment with at least two stems */
+#define BEAM_M                4U  /* multibranch loop segment with at least one stem */
+#define BEAM_TYPES            5U
+
+#define BEAM_MANNER_NONE      (unsigned char)0
+#define BEAM_MANNER_HAIRPIN   (unsigned char)1
+#define BEAM_MANNER_INTERNAL  (unsigned char)2
+#define BEAM_MANNER_ML        (unsigned char)3
+#define BEAM_MANNER_SPLIT     (unsigned char)4
+#define BEAM_MANNER_FROM_P    (unsigned char)5
+#define BEAM_MANNER_FROM_M2   (unsigned char)6
+#define BEAM_MANNER_UNPAIRED  (unsigned char)7
+#define BEAM_MANNER_STEM      (unsigned char)8
+
+
+typedef struct {
+  double        v;        /* free energy (MFE), or log of inside weight (PF) */
+  double        w;        /* log of outside weight (PF) */
+  unsigned int  t1;       /* backtracking information (MFE) */
+  unsigned int  t2;
+  unsigned char manner;
+} beam_state_t;
+
+
+typedef struct {
+  unsigned int  *keys;    /* 5' positions, 0 marks an empty slot */
+  beam_state_t  *states;
+  unsigned int  num;
+  unsigned int  cap;      /* 0 or a power of 2 */
+} beam_bucket_t;
+
+
+struct beam_dat {
+  vrna_fold_compound_t  *fc;
+  unsigned int          mode;
+  unsigned int          n;
+  unsigned int          beam;
+  unsigned int          span;
+  unsigned int          min_loop;
+  unsigned int          dangles;
+  unsigned int          noGUclosure;
+  short                 *S1;
+  short                 *S2;
+  vrna_param_t          *P;
+  vrna_md_t             *md;
+  double                kT_inv;     /* 10 / kT, converts dcal/mol into units of kT */
+
+  unsigned char         *mx;        /* hard constraints, or NULL for default constraints evaluated on the fly */
+  unsigned int          *up_ext;
+  unsigned int          *up_hp;
+  unsigned int          *up_int;
+  unsigned int          *up_ml;
+
+  unsigned char         with_sc;
+  int                   **sc_up;
+  int                   *sc_bp;
+  int                   *idx;
+
+  unsigned int          **next_pair; /* next_pair[c][k] = min{q >= k | c may pair with q}, or 0 */
+  unsigned int          classes;
+
+  beam_bucket_t         *buckets[BEAM_TYPES];
+  beam_state_t          *C;           /* exterior loop prefixes [1:j], j = 0...n */
+
+  double                *scores;
+  unsigned int          scores_size;
+};
+
+
+/* check whether the beam search engine supports the settings of fc */
+BEAM_INTERNAL int
+beam_applicable(vrna_fold_compound_t *fc);
+
+
+/* prepare fc (parameters, constraints) for a beam search run */
+BEAM_INTERNAL int
+beam_prepare(vrna_fold_compound_t  *fc,
+             unsigned int          options);
+
+
+BEAM_INTERNAL struct beam_dat *
+beam_dat_init(vrna_fold_compound_t *fc,
+              unsigned int         mode);
+
+
+BEAM_INTERNAL void
+beam_dat_free(struct beam_dat *d);
+
+
+/* left-to-right pass, MFE or inside partition function depending on d->mode */
+BEAM_INTERNAL void
+beam_inside(struct beam_dat *d);
+
+
+/* right-to-left pass that propagates outside weights to all surviving states */
+BEAM_INTERNAL void
+beam_outside(struct beam_dat *d);
+
+
+/* state of the span [i:j] in bucket b, or NULL if it has been pruned */
+BEAM_INTERNAL beam_state_t *
+beam_bucket_get(beam_bucket_t  *b,
+                unsigned int   i);
+
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef VRNA_INTERN_EDIT_DISTANCE_DAT_H
+#define VRNA_INTERN_EDIT_DISTANCE_DAT_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include "ViennaRNA/dist_vars.h"
+#include "ViennaRNA/structures/edit_distance.h"
+
+/*
+ *  Workspace of the tree-, string-, and profile edit distance functions.
+ *  All buffers only ever grow, such that a context that is re-used for
+ *  many pairwise comparisons of similarly sized objects allocates its
+ *  memory only once.
+ */
+struct vrna_edit_dist_s {
+  unsigned int  options;
+
+  int           *ibuf;            /* tree distance, forest distance and alignment tables */
+  size_t        ibuf_size;
+  int           **rows;           /* row pointers into ibuf */
+  size_t        rows_size;
+
+  float         *fbuf;            /* dynamic programming tables of string alignments */
+  size_t        fbuf_size;
+  short         *sbuf;            /* backtracking pointers of string alignments */
+  size_t        sbuf_size;
+
+  char          *aligned_line[2]; /* alignment of the last comparison (backtracking only) */
+};
+
+
+PRIVATE INLINE void *
+edit_dist_buffer(void   *buf,
+                 size_t *size,
+                 size_t elements,
+                 size_t element_size)
+{
+  if (elements > *size) {
+    buf   = vrna_realloc(buf, element_size * elements);
+    *size = elements;
+  }
+
+  return buf;
+}
+
+
+PRIVATE INLINE void
+edit_dist_aligned_lines(vrna_edit_dist_t  *ctx,
+                        char              *a0,
+                        char              *a1)
+{
+  free(ctx->aligned_line[0]);
+  free(ctx->aligned_line[1]);
+
+  ctx->aligned_line[0]  = a0;
+  ctx->aligned_line[1]  = a1;
+}
+
+
+/*
+ *  hand the alignment of the last comparison over to the global aligned_line,
+ *  if the comparison failed, aligned_line is reset to NULL
+ */
+PRIVATE INLINE void
+edit_dist_export_aligned_lines(vrna_edit_dist_t *ctx)
+{
+  free(aligned_line[0]);
+  free(aligned_line[1]);
+
+  aligned_line[0]       = ctx->aligned_line[0];
+  aligned_line[1]       = ctx->aligned_line[1];
+  ctx->aligned_line[0]  = NULL;
+  ctx->aligned_line[1]  = NULL;
+}
+
+
+#endif
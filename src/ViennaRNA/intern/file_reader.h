@@ -0,0 +1,47 @@
+#ifndef VRNA_INTERN_FILE_READER_H
+#define VRNA_INTERN_FILE_READER_H
+
+#include <stdio.h>
+
+#include <ViennaRNA/io/file_reader.h>
+
+/*
+ *  Look-ahead of the (FASTA) record parser. The parser may read one line
+ *  beyond the current data block (inbuf2), or a complete data block that
+ *  belongs to the next record (inbuf, typebuf). For input read via
+ *  vrna_file_fasta_read_record() this is a single global state, each
+ *  buffered reader carries its own.
+ */
+typedef struct {
+  char          *inbuf;
+  char          *inbuf2;
+  unsigned int  typebuf;
+} vrna_record_lookahead_t;
+
+
+struct vrna_file_reader_s {
+  FILE                    *fp;          /* input stream */
+  int                     own_fp;       /* whether fp is closed together with the reader */
+  int                     tty;          /* read line by line from a terminal */
+  int                     done;         /* no more data will be appended to buf */
+
+  unsigned char           *map;         /* memory-mapped input file */
+  size_t                  map_size;
+
+  unsigned char           *in;          /* raw (compressed) input */
+  size_t                  in_size;
+  size_t                  in_len;
+
+  char                    *buf;         /* (decompressed) text */
+  size_t                  buf_size;
+  size_t                  buf_len;
+  size_t                  buf_pos;
+
+  unsigned int            compression;
+  void                    *decoder;
+
+  vrna_record_lookahead_t lookahead;
+};
+
+
+#endif
@@ -26,7 +26,9 @@
 #include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/io/file_reader.h"
 #include "ViennaRNA/io/file_formats.h"
+#include "ViennaRNA/intern/file_reader.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -52,9 +54,10 @@ typedef struct {
 } ct_data;
 
 
-PRIVATE char          *inbuf  = NULL;
-PRIVATE char          *inbuf2 = NULL;
-PRIVATE unsigned int  typebuf = 0;
+/* look-ahead of vrna_file_fasta_read_record() */
+PRIVATE vrna_record_lookahead_t lookahead = {
+  NULL, NULL, 0
+};
 
 /*
  #################################
@@ -63,9 +66,29 @@ PRIVATE unsigned int  typebuf = 0;
  */
 
 PRIVATE unsigned int
-read_multiple_input_lines(char          **string,
-                          FILE          *file,
-                          unsigned int  option);
+read_multiple_input_lines(char                    **string,
+                          FILE                    *file,
+                          vrna_file_reader_t      *reader,
+                          vrna_record_lookahead_t *la,
+                          unsigned int            option);
+
+
+PRIVATE INLINE void
+append_line(char    **string,
+            size_t  *str_length,
+            size_t  *str_size,
+            char    **line,
+            size_t  l);
+
+
+PRIVATE unsigned int
+read_fasta_record(char                    **header,
+                  char                    **sequence,
+                  char                    ***rest,
+                  FILE                    *file,
+                  vrna_file_reader_t      *reader,
+                  vrna_record_lookahead_t *la,
+                  unsigned int            options);
 
 
 PRIVATE void
@@ -284,18 +307,27 @@ vrna_file_json(const char *seq,
 
 
 PRIVATE unsigned int
-read_multiple_input_lines(char          **string,
-                          FILE          *file,
-                          unsigned int  option)
+read_multiple_input_lines(char                    **string,
+                          FILE                    *file,
+                          vrna_file_reader_t      *reader,
+                          vrna_record_lookahead_t *la,
+                          unsigned int            option)
 {
-  char  *line;
-  int   i, l;
-  int   state       = 0;
-  int   str_length  = 0;
-  FILE  *in         = (file) ? file : stdin;
+  char    *line;
+  int     i;
+  int     state = 0;
+  size_t  l, str_length, str_size;
+  FILE    *in = (file) ? file : stdin;
+
+  str_length  = (*string) ? strlen(*string) : 0;
+  str_size    = str_length + 1;
+
+  if (la->inbuf2)
+    line = la->inbuf2;
+  else
+    line = (reader) ? vrna_file_reader_line(reader) : vrna_read_line(in);
 
-  line    = (inbuf2) ? inbuf2 : vrna_read_line(in);
-  inbuf2  = NULL;
+  la->inbuf2 = NULL;
   do{
     /*
      * read lines until informative data appears or
@@ -304,19 +336,16 @@ read_multiple_input_lines(char          **string,
     if (!line)
       return VRNA_INPUT_ERROR;
 
-    l = (int)strlen(line);
-
     /* eliminate whitespaces at the end of the line read */
     if (!(option & VRNA_INPUT_NO_TRUNCATION))
       elim_trailing_ws(line);
 
-    l           = (int)strlen(line);
-    str_length  = (*string) ? (int)strlen(*string) : 0;
+    l = strlen(line);
 
     switch (*line) {
       case  '@':    /* user abort */
         if (state)
-          inbuf2 = line;
+          la->inbuf2 = line;
         else
           free(line);
 
@@ -326,7 +355,7 @@ read_multiple_input_lines(char          **string,
       case  '\0':   /* empty line */
         if (option & VRNA_INPUT_NOSKIP_BLANK_LINES) {
           if (state)
-            inbuf2 = line;
+            la->inbuf2 = line;
           else
             free(line);
 
@@ -345,7 +374,7 @@ read_multiple_input_lines(char          **string,
       case ' ':   /* comments */
         if (option & VRNA_INPUT_NOSKIP_COMMENTS) {
           if (state)
-            inbuf2 = line;
+            la->inbuf2 = line;
           else
             *string = line;
 
@@ -358,7 +387,7 @@ read_multiple_input_lines(char          **string,
 
       case  '>':  /* fasta header */
         if (state)
-          inbuf2 = line;
+          la->inbuf2 = line;
         else
           *string = line;
 
@@ -383,14 +412,10 @@ read_multiple_input_lines(char          **string,
           if (option & VRNA_INPUT_FASTA_HEADER) {
             /* are we in structure mode? Then we remember this line for the next round */
             if (state == 2) {
-              inbuf2 = line;
+              la->inbuf2 = line;
               return VRNA_INPUT_CONSTRAINT;
             } else {
-              *string = (char *)vrna_realloc(*string, sizeof(char) * (str_length + l + 1));
-              memcpy(*string + str_length,
-                     line,
-                     sizeof(char) * l);
-              (*string)[str_length + l] = '\0';
+              append_line(string, &str_length, &str_size, &line, l);
               state                     = 1;
             }
 
@@ -424,14 +449,10 @@ read_multiple_input_lines(char          **string,
          */
         if (option & VRNA_INPUT_FASTA_HEADER) {
           if (state == 1) {
-            inbuf2 = line;
+            la->inbuf2 = line;
             return VRNA_INPUT_SEQUENCE;
           } else {
-            *string = (char *)vrna_realloc(*string, sizeof(char) * (str_length + l + 1));
-            memcpy(*string + str_length,
-                   line,
-                   sizeof(char) * l);
-            (*string)[str_length + l] = '\0';
+            append_line(string, &str_length, &str_size, &line, l);
             state                     = 2;
           }
         }
@@ -446,14 +467,10 @@ read_multiple_input_lines(char          **string,
         if (option & VRNA_INPUT_FASTA_HEADER) {
           /* are we already in sequence mode? */
           if (state == 2) {
-            inbuf2 = line;
+            la->inbuf2 = line;
             return VRNA_INPUT_CONSTRAINT;
           } else {
-            *string = (char *)vrna_realloc(*string, sizeof(char) * (str_length + l + 1));
-            memcpy(*string + str_length,
-                   line,
-                   sizeof(char) * l);
-            (*string)[str_length + l] = '\0';
+            append_line(string, &str_length, &str_size, &line, l);
             state                     = 1;
           }
         }
@@ -464,7 +481,7 @@ read_multiple_input_lines(char          **string,
         }
     }
     free(line);
-    line = vrna_read_line(in);
+    line = (reader) ? vrna_file_reader_line(reader) : vrna_read_line(in);
   } while (line);
 
   return (state == 2) ? VRNA_INPUT_CONSTRAINT : (state ==
@@ -472,12 +489,69 @@ read_multiple_input_lines(char          **string,
 }
 
 
+PRIVATE INLINE void
+append_line(char    **string,
+            size_t  *str_length,
+            size_t  *str_size,
+            char    **line,
+            size_t  l)
+{
+  if (!(*string)) {
+    /* first line of a data block, simply take over the line read */
+    *string     = *line;
+    *line       = NULL;
+    *str_length = l;
+    *str_size   = l + 1;
+    return;
+  }
+
+  if (*str_length + l + 1 > *str_size) {
+    *str_size = MAX2(2 * (*str_size), *str_length + l + 1);
+    *string   = (char *)vrna_realloc(*string, sizeof(char) * (*str_size));
+  }
+
+  memcpy(*string + *str_length, *line, sizeof(char) * l);
+  *str_length               += l;
+  (*string)[*str_length]    = '\0';
+}
+
+
 PUBLIC unsigned int
 vrna_file_fasta_read_record(char          **header,
                             char          **sequence,
                             char          ***rest,
                             FILE          *file,
                             unsigned int  options)
+{
+  return read_fasta_record(header, sequence, rest, file, NULL, &lookahead, options);
+}
+
+
+PUBLIC unsigned int
+vrna_file_reader_fasta_record(vrna_file_reader_t  *reader,
+                              char                **header,
+                              char                **sequence,
+                              char                ***rest,
+                              unsigned int        options)
+{
+  if (!reader) {
+    *header   = *sequence = NULL;
+    *rest     = (char **)vrna_alloc(sizeof(char *));
+    return VRNA_INPUT_ERROR;
+  }
+
+  return read_fasta_record(header, sequence, rest, NULL, reader, &(reader->lookahead), options);
+}
+
+
+PRIVATE unsigned int
+read_fasta_record(char                    **header,
+                  char                    **sequence,
+                  char                    ***rest,
+                  FILE                    *file,
+                  vrna_file_reader_t      *reader,
+                  vrna_record_lookahead_t *la,
+                  unsigned int            options)
 {
   unsigned int  input_type, return_type, tmp_type;
   int           rest_count;
@@ -492,13 +566,13 @@ vrna_file_fasta_read_record(char          **header,
   options &= ~VRNA_INPUT_FASTA_HEADER;
 
   /* read first input or last buffered input */
-  if (typebuf) {
-    input_type    = typebuf;
-    input_string  = inbuf;
-    typebuf       = 0;
-    inbuf         = NULL;
+  if (la->typebuf) {
+    input_type    = la->typebuf;
+    input_string  = la->inbuf;
+    la->typebuf   = 0;
+    la->inbuf     = NULL;
   } else {
-    input_type = read_multiple_input_lines(&input_string, file, options);
+    input_type = read_multiple_input_lines(&input_string, file, reader, la, options);
   }
 
   if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR))
@@ -508,7 +582,7 @@ vrna_file_fasta_read_record(char          **header,
   while (input_type & (VRNA_INPUT_MISC | VRNA_INPUT_CONSTRAINT | VRNA_INPUT_BLANK_LINE)) {
     free(input_string);
     input_string  = NULL;
-    input_type    = read_multiple_input_lines(&input_string, file, options);
+    input_type    = read_multiple_input_lines(&input_string, file, reader, la, options);
     if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR))
       return input_type;
   }
@@ -521,6 +595,8 @@ vrna_file_fasta_read_record(char          **header,
     input_type = read_multiple_input_lines(
       &input_string,
       file,
+      reader,
+      la,
       ((options & VRNA_INPUT_NO_SPAN) ? 0 : VRNA_INPUT_FASTA_HEADER) | options
       );
     if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR))
@@ -544,7 +620,11 @@ vrna_file_fasta_read_record(char          **header,
     if (options & VRNA_INPUT_NOSKIP_BLANK_LINES)
       tmp_type |= VRNA_INPUT_BLANK_LINE;
 
-    while (!((input_type = read_multiple_input_lines(&input_string, file, options)) & tmp_type)) {
+    while (!((input_type = read_multiple_input_lines(&input_string,
+                                                      file,
+                                                      reader,
+                                                      la,
+                                                      options)) & tmp_type)) {
       *rest                   = vrna_realloc(*rest, sizeof(char **) * (++rest_count + 1));
       (*rest)[rest_count - 1] = input_string;
       input_string            = NULL;
@@ -557,8 +637,8 @@ vrna_file_fasta_read_record(char          **header,
      *   we now put the last line into the buffer if necessary
      *   since it should belong to the next record
      */
-    inbuf   = input_string;
-    typebuf = input_type;
+    la->inbuf   = input_string;
+    la->typebuf = input_type;
   }
 
   (*rest)[rest_count] = NULL;
@@ -1261,7 +1341,7 @@ PUBLIC unsigned int
 get_multi_input_line(char         **string,
                      unsigned int option)
 {
-  return read_multiple_input_lines(string, NULL, option);
+  return read_multiple_input_lines(string, NULL, NULL, &lookahead, option);
 }
 
 
@@ -27,6 +27,7 @@
 #include <stdio.h>
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/io/file_reader.h>
 
 /**
  *  @brief Print a secondary structure as helix list
@@ -178,7 +179,8 @@ vrna_file_json(const char *seq,
  *
  *  @note This function will exit any program with an error message if no sequence could be read!<br>
  *        This function is NOT threadsafe! It uses a global variable to store information about
- *        the next data block.
+ *        the next data block. See vrna_file_reader_fasta_record() for an alternative that keeps
+ *        this information within a buffered reader.
  *        Do not forget to free the memory occupied by header, sequence and rest!
  *
  *  @param  header    A pointer which will be set such that it points to the header of the record
@@ -196,6 +198,33 @@ vrna_file_fasta_read_record(char          **header,
                             unsigned int  options);
 
 
+/**
+ *  @brief  Get a (fasta) data set from a buffered reader
+ *
+ *  Same as vrna_file_fasta_read_record(), but lines are taken from a buffered
+ *  reader as obtained from vrna_file_reader_open() or vrna_file_reader_stream().
+ *  This allows for processing gzip or Zstandard compressed input and avoids
+ *  the overhead of reading line by line for large inputs. The information about
+ *  the next data block is stored within the reader, so different readers may be
+ *  used concurrently.
+ *
+ *  @see vrna_file_fasta_read_record(), vrna_file_reader_open(), vrna_file_reader_close()
+ *
+ *  @param  reader    The reader to take the input from
+ *  @param  header    A pointer which will be set such that it points to the header of the record
+ *  @param  sequence  A pointer which will be set such that it points to the sequence of the record
+ *  @param  rest      A pointer which will be set such that it points to an array of lines which also belong to the record
+ *  @param  options   Some options which may be passed to alter the behavior of the function, use 0 for no options
+ *  @return           A flag with information about what the function actually did read
+ */
+unsigned int
+vrna_file_reader_fasta_record(vrna_file_reader_t  *reader,
+                              char                **header,
+                              char                **sequence,
+                              char                ***rest,
+                              unsigned int        options);
+
+
 /** @brief Extract a dot-bracket structure string from (multiline)character array
  *
  * This function extracts a dot-bracket structure string from the 'rest' array as
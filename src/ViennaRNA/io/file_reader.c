@@ -0,0 +1,629 @@
+/*
+ *  io/file_reader.c
+ *
+ *  Buffered, line-based input from plain and compressed files
+ *
+ *  Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#else
+#include "ViennaRNA/intern/unistd_win.h"
+#endif
+
+#ifdef VRNA_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef VRNA_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/io/file_reader.h"
+#include "ViennaRNA/intern/file_reader.h"
+
+/*
+ #################################
+ # PRIVATE MACROS                #
+ #################################
+ */
+
+/* initial size of the text buffer, it grows for lines that do not fit */
+#define READER_BUFFER_SIZE  (1UL << 20)
+
+/* number of bytes read from an input stream at once */
+#define READER_RAW_CHUNK    (1UL << 20)
+
+/* number of bytes of a memory-mapped file passed to a decompressor at once */
+#define READER_MAP_CHUNK    (1UL << 30)
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+
+#ifdef VRNA_WITH_ZLIB
+typedef struct {
+  z_stream  zs;
+  int       member_end; /* whether the last gzip member has been decompressed completely */
+  int       pending;    /* whether the last call filled the output entirely, i.e. may hold back output */
+} gzip_decoder_t;
+#endif
+
+#ifdef VRNA_WITH_ZSTD
+typedef struct {
+  ZSTD_DStream    *ds;
+  ZSTD_inBuffer   in;
+  size_t          hint;     /* last return value of ZSTD_decompressStream(), 0 at frame end */
+  int             pending;  /* whether the last call filled the output entirely, i.e. may hold back output */
+} zstd_decoder_t;
+#endif
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE vrna_file_reader_t *
+reader_init(FILE  *fp,
+            int   own_fp);
+
+
+PRIVATE unsigned int
+detect_compression(const unsigned char  *data,
+                   size_t               n);
+
+
+PRIVATE int
+decoder_init(vrna_file_reader_t *reader);
+
+
+PRIVATE void
+decoder_free(vrna_file_reader_t *reader);
+
+
+PRIVATE size_t
+stream_read(vrna_file_reader_t  *reader,
+            unsigned char       *dst,
+            size_t              size);
+
+
+#if defined(VRNA_WITH_ZLIB) || defined(VRNA_WITH_ZSTD)
+PRIVATE size_t
+raw_read(vrna_file_reader_t   *reader,
+         const unsigned char  **data);
+
+
+#endif
+
+
+PRIVATE size_t
+fill(vrna_file_reader_t *reader);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_file_reader_t *
+vrna_file_reader_open(const char *filename)
+{
+  FILE *fp;
+
+  if ((!filename) ||
+      (strcmp(filename, "-") == 0))
+    return reader_init(stdin, 0);
+
+  fp = fopen(filename, "rb");
+  if (!fp) {
+    vrna_log_warning("vrna_file_reader_open: Failed to open file \"%s\"", filename);
+    return NULL;
+  }
+
+  return reader_init(fp, 1);
+}
+
+
+PUBLIC vrna_file_reader_t *
+vrna_file_reader_stream(FILE *fp)
+{
+  return reader_init((fp) ? fp : stdin, 0);
+}
+
+
+PUBLIC char *
+vrna_file_reader_line(vrna_file_reader_t *reader)
+{
+  char    *nl, *line;
+  size_t  l, searched;
+
+  if (!reader)
+    return NULL;
+
+  searched = 0;
+
+  while (!(nl = memchr(reader->buf + reader->buf_pos + searched,
+                       '\n',
+                       reader->buf_len - reader->buf_pos - searched))) {
+    /* the remainder of the buffer does not contain a newline, so we need more data */
+    searched = reader->buf_len - reader->buf_pos;
+
+    if ((reader->done) ||
+        (fill(reader) == 0)) {
+      reader->done = 1;
+
+      /* last line without trailing newline */
+      l = reader->buf_len - reader->buf_pos;
+      if (l == 0)
+        return NULL;
+
+      line = (char *)vrna_alloc(sizeof(char) * (l + 1));
+      memcpy(line, reader->buf + reader->buf_pos, sizeof(char) * l);
+      line[l]         = '\0';
+      reader->buf_pos = reader->buf_len;
+
+      return line;
+    }
+  }
+
+  l     = (size_t)(nl - (reader->buf + reader->buf_pos));
+  line  = (char *)vrna_alloc(sizeof(char) * (l + 1));
+  memcpy(line, reader->buf + reader->buf_pos, sizeof(char) * l);
+  line[l]         = '\0';
+  reader->buf_pos += l + 1;
+
+  return line;
+}
+
+
+PUBLIC unsigned int
+vrna_file_reader_compression(vrna_file_reader_t *reader)
+{
+  return (reader) ? reader->compression : VRNA_FILE_READER_PLAIN;
+}
+
+
+PUBLIC void
+vrna_file_reader_close(vrna_file_reader_t *reader)
+{
+  if (reader) {
+    decoder_free(reader);
+
+    /* plain text of memory-mapped files is read from the mapping directly */
+    if ((!reader->map) ||
+        (reader->compression != VRNA_FILE_READER_PLAIN))
+      free(reader->buf);
+
+#ifndef _WIN32
+    if (reader->map)
+      munmap(reader->map, reader->map_size);
+
+#endif
+
+    free(reader->in);
+    free(reader->lookahead.inbuf);
+    free(reader->lookahead.inbuf2);
+
+    if (reader->own_fp)
+      fclose(reader->fp);
+
+    free(reader);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE vrna_file_reader_t *
+reader_init(FILE  *fp,
+            int   own_fp)
+{
+  size_t              n;
+  vrna_file_reader_t  *reader;
+
+#ifndef _WIN32
+  struct stat         st;
+  long                offset;
+  void                *map;
+#endif
+
+  reader          = (vrna_file_reader_t *)vrna_alloc(sizeof(vrna_file_reader_t));
+  reader->fp      = fp;
+  reader->own_fp  = own_fp;
+  reader->tty     = isatty(fileno(fp));
+
+  if (reader->tty) {
+    /* interactive input is always plain text that we read line by line */
+    reader->buf_size  = READER_BUFFER_SIZE;
+    reader->buf       = (char *)vrna_alloc(sizeof(char) * reader->buf_size);
+    return reader;
+  }
+
+#ifndef _WIN32
+  offset = ftell(fp);
+
+  if ((offset >= 0) &&
+      (fstat(fileno(fp), &st) == 0) &&
+      (S_ISREG(st.st_mode)) &&
+      (st.st_size > offset)) {
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (map != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+      (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+      reader->map       = (unsigned char *)map;
+      reader->map_size  = (size_t)st.st_size;
+      reader->in_len    = (size_t)offset;   /* position within the mapping */
+
+      reader->compression = detect_compression(reader->map + offset,
+                                               reader->map_size - offset);
+
+      if (reader->compression == VRNA_FILE_READER_PLAIN) {
+        /* lines are extracted directly from the mapped file */
+        reader->buf       = (char *)(reader->map + offset);
+        reader->buf_size  = reader->buf_len = reader->map_size - offset;
+        reader->done      = 1;
+        return reader;
+      }
+
+      if (!decoder_init(reader))
+        reader->done = 1;
+
+      return reader;
+    }
+  }
+
+#endif
+
+  /* read the first bytes of the stream to detect compressed input */
+  reader->in_size = READER_RAW_CHUNK;
+  reader->in      = (unsigned char *)vrna_alloc(sizeof(unsigned char) * reader->in_size);
+
+  do {
+    n = stream_read(reader,
+                    reader->in + reader->in_len,
+                    reader->in_size - reader->in_len);
+    reader->in_len += n;
+  } while ((n > 0) &&
+           ((reader->in_len < 2) ||
+            ((reader->in_len < 4) && (reader->in[0] == 0x28))));
+
+  reader->compression = detect_compression(reader->in, reader->in_len);
+
+  if (reader->compression == VRNA_FILE_READER_PLAIN) {
+    reader->buf_size  = MAX2(READER_BUFFER_SIZE, reader->in_len);
+    reader->buf       = (char *)vrna_alloc(sizeof(char) * reader->buf_size);
+    memcpy(reader->buf, reader->in, sizeof(char) * reader->in_len);
+    reader->buf_len = reader->in_len;
+    reader->done    = (n == 0) ? 1 : 0;
+
+    free(reader->in);
+    reader->in      = NULL;
+    reader->in_len  = 0;
+  } else if (!decoder_init(reader)) {
+    reader->done = 1;
+  }
+
+  return reader;
+}
+
+
+PRIVATE unsigned int
+detect_compression(const unsigned char  *data,
+                   size_t               n)
+{
+  if ((n >= 2) &&
+      (data[0] == 0x1f) &&
+      (data[1] == 0x8b))
+    return VRNA_FILE_READER_GZIP;
+
+  if ((n >= 4) &&
+      (data[0] == 0x28) &&
+      (data[1] == 0xb5) &&
+      (data[2] == 0x2f) &&
+      (data[3] == 0xfd))
+    return VRNA_FILE_READER_ZSTD;
+
+  return VRNA_FILE_READER_PLAIN;
+}
+
+
+PRIVATE int
+decoder_init(vrna_file_reader_t *reader)
+{
+  reader->buf_size  = READER_BUFFER_SIZE;
+  reader->buf       = (char *)vrna_alloc(sizeof(char) * reader->buf_size);
+
+  switch (reader->compression) {
+    case VRNA_FILE_READER_GZIP:
+#ifdef VRNA_WITH_ZLIB
+      {
+        gzip_decoder_t *dec = (gzip_decoder_t *)vrna_alloc(sizeof(gzip_decoder_t));
+        /* automatic gzip/zlib header detection */
+        if (inflateInit2(&(dec->zs), 15 + 32) != Z_OK) {
+          vrna_log_warning("vrna_file_reader: Failed to initialize gzip decompression");
+          free(dec);
+          return 0;
+        }
+
+        reader->decoder = dec;
+        return 1;
+      }
+#else
+      vrna_log_warning("vrna_file_reader: Input is gzip compressed "
+                       "but RNAlib has been compiled without zlib support");
+      return 0;
+#endif
+
+    case VRNA_FILE_READER_ZSTD:
+#ifdef VRNA_WITH_ZSTD
+      {
+        zstd_decoder_t *dec = (zstd_decoder_t *)vrna_alloc(sizeof(zstd_decoder_t));
+        dec->ds = ZSTD_createDStream();
+        if ((!dec->ds) ||
+            (ZSTD_isError(ZSTD_initDStream(dec->ds)))) {
+          vrna_log_warning("vrna_file_reader: Failed to initialize Zstandard decompression");
+          ZSTD_freeDStream(dec->ds);
+          free(dec);
+          return 0;
+        }
+
+        reader->decoder = dec;
+        return 1;
+      }
+#else
+      vrna_log_warning("vrna_file_reader: Input is Zstandard compressed "
+                       "but RNAlib has been compiled without libzstd support");
+      return 0;
+#endif
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+
+PRIVATE void
+decoder_free(vrna_file_reader_t *reader)
+{
+  if (reader->decoder) {
+    switch (reader->compression) {
+#ifdef VRNA_WITH_ZLIB
+      case VRNA_FILE_READER_GZIP:
+        inflateEnd(&(((gzip_decoder_t *)reader->decoder)->zs));
+        break;
+#endif
+#ifdef VRNA_WITH_ZSTD
+      case VRNA_FILE_READER_ZSTD:
+        ZSTD_freeDStream(((zstd_decoder_t *)reader->decoder)->ds);
+        break;
+#endif
+      default:
+        break;
+    }
+
+    free(reader->decoder);
+    reader->decoder = NULL;
+  }
+}
+
+
+/* read whatever is available from the input stream, 0 at the end of input */
+PRIVATE size_t
+stream_read(vrna_file_reader_t  *reader,
+            unsigned char       *dst,
+            size_t              size)
+{
+#ifndef _WIN32
+  ssize_t n;
+
+  /*
+   *  in contrast to fread(), read() returns as soon as some data is
+   *  available, which keeps line-wise communication through pipes intact
+   */
+  do
+    n = read(fileno(reader->fp), dst, size);
+  while ((n < 0) && (errno == EINTR));
+
+  return (n > 0) ? (size_t)n : 0;
+#else
+  return fread(dst, sizeof(unsigned char), size, reader->fp);
+#endif
+}
+
+
+#if defined(VRNA_WITH_ZLIB) || defined(VRNA_WITH_ZSTD)
+/* get the next chunk of raw (compressed) input, 0 at the end of input */
+PRIVATE size_t
+raw_read(vrna_file_reader_t   *reader,
+         const unsigned char  **data)
+{
+  size_t n;
+
+  if (reader->map) {
+    /* in_len is the current position within the mapping */
+    n               = MIN2(reader->map_size - reader->in_len, READER_MAP_CHUNK);
+    *data           = reader->map + reader->in_len;
+    reader->in_len  += n;
+    return n;
+  }
+
+  /* bytes left over from compression detection */
+  if (reader->in_len > 0) {
+    n               = reader->in_len;
+    reader->in_len  = 0;
+  } else {
+    n = stream_read(reader, reader->in, reader->in_size);
+  }
+
+  *data = reader->in;
+
+  return n;
+}
+
+
+#endif
+
+
+/* append more text to the buffer, returns the number of characters added */
+PRIVATE size_t
+fill(vrna_file_reader_t *reader)
+{
+  size_t before;
+
+  /* move the incomplete line to the front of the buffer */
+  if (reader->buf_pos > 0) {
+    memmove(reader->buf,
+            reader->buf + reader->buf_pos,
+            sizeof(char) * (reader->buf_len - reader->buf_pos));
+    reader->buf_len -= reader->buf_pos;
+    reader->buf_pos = 0;
+  }
+
+  /* the incomplete line occupies the entire buffer */
+  if (reader->buf_size - reader->buf_len < 2) {
+    reader->buf_size  *= 2;
+    reader->buf       = (char *)vrna_realloc(reader->buf, sizeof(char) * reader->buf_size);
+  }
+
+  before = reader->buf_len;
+
+  switch (reader->compression) {
+    case VRNA_FILE_READER_PLAIN:
+      if (reader->tty) {
+        if (fgets(reader->buf + reader->buf_len,
+                  (int)MIN2(reader->buf_size - reader->buf_len, INT_MAX),
+                  reader->fp))
+          reader->buf_len += strlen(reader->buf + reader->buf_len);
+      } else {
+        reader->buf_len += stream_read(reader,
+                                       (unsigned char *)reader->buf + reader->buf_len,
+                                       reader->buf_size - reader->buf_len);
+      }
+
+      break;
+
+#ifdef VRNA_WITH_ZLIB
+    case VRNA_FILE_READER_GZIP:
+    {
+      int                 ret;
+      size_t              n;
+      const unsigned char *data;
+      gzip_decoder_t      *dec  = (gzip_decoder_t *)reader->decoder;
+      z_stream            *zs   = &(dec->zs);
+
+      while (reader->buf_len == before) {
+        /* flush whatever the decoder still holds back before asking for more input */
+        if ((zs->avail_in == 0) &&
+            (!dec->pending)) {
+          n = raw_read(reader, &data);
+          if (n == 0) {
+            if (!dec->member_end)
+              vrna_log_warning("vrna_file_reader: Unexpected end of gzip compressed input");
+
+            break;
+          }
+
+          zs->next_in   = (unsigned char *)data;
+          zs->avail_in  = (uInt)n;
+        }
+
+        zs->next_out  = (unsigned char *)(reader->buf + reader->buf_len);
+        zs->avail_out = (uInt)MIN2(reader->buf_size - reader->buf_len, UINT_MAX);
+
+        ret             = inflate(zs, Z_NO_FLUSH);
+        reader->buf_len = (size_t)((char *)zs->next_out - reader->buf);
+        dec->pending    = (zs->avail_out == 0);
+
+        if (ret == Z_STREAM_END) {
+          /* concatenated gzip members are decompressed one after another */
+          dec->member_end = 1;
+          inflateReset(zs);
+        } else if ((ret == Z_OK) ||
+                   (ret == Z_BUF_ERROR)) {
+          if (reader->buf_len > before)
+            dec->member_end = 0;
+        } else {
+          /* ignore trailing garbage after the last member, just like gzip does */
+          if (!dec->member_end)
+            vrna_log_warning("vrna_file_reader: Corrupt gzip compressed input");
+
+          break;
+        }
+      }
+    }
+    break;
+#endif
+
+#ifdef VRNA_WITH_ZSTD
+    case VRNA_FILE_READER_ZSTD:
+    {
+      size_t          ret;
+      ZSTD_outBuffer  out;
+      zstd_decoder_t  *dec = (zstd_decoder_t *)reader->decoder;
+
+      while (reader->buf_len == before) {
+        /* flush whatever the decoder still holds back before asking for more input */
+        if ((dec->in.pos == dec->in.size) &&
+            (!dec->pending)) {
+          const unsigned char *data;
+          dec->in.size  = raw_read(reader, &data);
+          dec->in.src   = data;
+          dec->in.pos   = 0;
+
+          if (dec->in.size == 0) {
+            if (dec->hint != 0)
+              vrna_log_warning("vrna_file_reader: Unexpected end of Zstandard compressed input");
+
+            break;
+          }
+        }
+
+        out.dst   = reader->buf + reader->buf_len;
+        out.size  = reader->buf_size - reader->buf_len;
+        out.pos   = 0;
+
+        ret = ZSTD_decompressStream(dec->ds, &out, &(dec->in));
+        if (ZSTD_isError(ret)) {
+          vrna_log_warning("vrna_file_reader: Corrupt Zstandard compressed input (%s)",
+                           ZSTD_getErrorName(ret));
+          break;
+        }
+
+        reader->buf_len += out.pos;
+        dec->hint       = ret;
+        dec->pending    = (out.pos == out.size);
+      }
+    }
+    break;
+#endif
+
+    default:
+      break;
+  }
+
+  return reader->buf_len - before;
+}
@@ -0,0 +1,118 @@
+#ifndef VIENNA_RNA_PACKAGE_FILE_READER_H
+#define VIENNA_RNA_PACKAGE_FILE_READER_H
+
+/**
+ *  @file     ViennaRNA/io/file_reader.h
+ *  @ingroup  utils, file_utils
+ *  @brief    Buffered line-based input from plain and compressed files
+ */
+
+#include <stdio.h>
+
+/**
+ *  @addtogroup file_utils
+ *  @{
+ */
+
+/**
+ *  @brief  An opaque buffered input reader, see vrna_file_reader_open()
+ */
+typedef struct vrna_file_reader_s vrna_file_reader_t;
+
+
+/**
+ *  @brief  Input compression: Plain text
+ */
+#define VRNA_FILE_READER_PLAIN      0U
+/**
+ *  @brief  Input compression: gzip
+ */
+#define VRNA_FILE_READER_GZIP       1U
+/**
+ *  @brief  Input compression: Zstandard
+ */
+#define VRNA_FILE_READER_ZSTD       2U
+
+
+/**
+ *  @brief  Open a file for buffered line-based reading
+ *
+ *  In contrast to reading line by line with vrna_read_line(), the reader
+ *  fetches the input in large blocks and extracts lines directly from its
+ *  buffer. Regular files are mapped into memory where possible, such that
+ *  lines are copied exactly once, i.e. into the string handed out to the caller.
+ *
+ *  Compressed input is detected automatically from the first bytes of the
+ *  data and decompressed on the fly. Support for gzip compressed files requires
+ *  RNAlib to be compiled with zlib, support for Zstandard compressed files
+ *  requires RNAlib to be compiled with libzstd (see the @p --with-zstd configure
+ *  option).
+ *
+ *  @see vrna_file_reader_stream(), vrna_file_reader_line(), vrna_file_reader_fasta_record(),
+ *       vrna_file_reader_close()
+ *
+ *  @param  filename  The name of the file to read from, or NULL or "-" for @p stdin
+ *  @return           A new reader, or NULL if the file could not be opened
+ */
+vrna_file_reader_t *
+vrna_file_reader_open(const char *filename);
+
+
+/**
+ *  @brief  Create a buffered reader for an already opened input stream
+ *
+ *  Input from a terminal is read line by line to retain interactive use. The
+ *  reader takes over all further input from @p fp, i.e. the stream must not be
+ *  read by other means until the reader is closed. Closing the reader does not
+ *  close @p fp.
+ *
+ *  @see vrna_file_reader_open(), vrna_file_reader_close()
+ *
+ *  @param  fp  The input stream (if NULL, the reader reads from @p stdin)
+ *  @return     A new reader
+ */
+vrna_file_reader_t *
+vrna_file_reader_stream(FILE *fp);
+
+
+/**
+ *  @brief  Read the next line from a buffered reader
+ *
+ *  Similar to vrna_read_line(), the returned line is stripped of its newline
+ *  character. The necessary memory is allocated and should be released using
+ *  @e free() when the string is no longer needed.
+ *
+ *  @param  reader  The reader
+ *  @return         The next line, or NULL at the end of the input or on any error
+ */
+char *
+vrna_file_reader_line(vrna_file_reader_t *reader);
+
+
+/**
+ *  @brief  Get the compression of the input of a buffered reader
+ *
+ *  @param  reader  The reader
+ *  @return         One of #VRNA_FILE_READER_PLAIN, #VRNA_FILE_READER_GZIP, or #VRNA_FILE_READER_ZSTD
+ */
+unsigned int
+vrna_file_reader_compression(vrna_file_reader_t *reader);
+
+
+/**
+ *  @brief  Release a buffered reader
+ *
+ *  The input stream is closed only if the reader has been created
+ *  by vrna_file_reader_open() for a file other than @p stdin.
+ *
+ *  @param  reader  The reader
+ */
+void
+vrna_file_reader_close(vrna_file_reader_t *reader);
+
+
+/**
+ *  @}
+ */
+
+#endif
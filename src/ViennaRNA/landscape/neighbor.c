@@ -234,6 +234,68 @@ move_noLP_bpshift(const vrna_fold_compound_t  *vc,
                   int                         verbose);
 
 
+struct nbhd_group {
+  vrna_move_t   *moves;
+  int           *dE;
+  unsigned int  num;
+  unsigned int  size;
+};
+
+
+struct vrna_nbhd_s {
+  vrna_fold_compound_t  *fc;
+  unsigned int          options;
+  unsigned int          length;
+  short                 *pt;
+  int                   *up;          /* 5' position of the pair closing the loop a position belongs to (0 = exterior loop) */
+  int                   *loop_en;     /* energy of the loop closed by the pair at a 5' position ([0] = exterior loop) */
+  int                   energy;
+  size_t                num_moves;
+  struct nbhd_group     *groups;      /* neighbors generated from each loop */
+  int                   *dirty;
+  unsigned int          num_dirty;
+  unsigned char         *is_dirty;
+  int                   *buf;
+  int                   *buf2;
+};
+
+
+PRIVATE void
+nbhd_set_up(struct vrna_nbhd_s  *nb,
+            int                 g);
+
+
+PRIVATE unsigned int
+nbhd_unpaired(struct vrna_nbhd_s  *nb,
+              int                 g,
+              int                 *u);
+
+
+PRIVATE void
+nbhd_add(struct nbhd_group  *G,
+         vrna_move_t        m,
+         int                dE);
+
+
+PRIVATE void
+nbhd_make_group(struct vrna_nbhd_s  *nb,
+                int                 g);
+
+
+PRIVATE void
+nbhd_mark(struct vrna_nbhd_s  *nb,
+          int                 g);
+
+
+PRIVATE void
+nbhd_touch(struct vrna_nbhd_s *nb,
+           int                g);
+
+
+PRIVATE void
+nbhd_refresh(struct vrna_nbhd_s *nb);
+
+
 /*
  *************************************
  * private helper methods
@@ -2243,3 +2305,510 @@ vrna_neighbors_successive(const vrna_fold_compound_t  *vc,
 
   return newMoves;
 }
+
+
+/*
+ *************************************
+ * neighborhood object
+ *************************************
+ */
+
+/*
+ *  Neighbors are grouped by the loop they are generated from, i.e. the
+ *  insertions into a loop, and the deletion and shifts of its closing pair.
+ *  The energy change of a move only depends on the loop closed by the pair
+ *  and its enclosing loop, so after a move only groups of the (at most two)
+ *  loops that changed, and of the pairs directly inside them need an update.
+ */
+PUBLIC vrna_nbhd_t
+vrna_nbhd_init(vrna_fold_compound_t *fc,
+               const short          *pt,
+               unsigned int         options)
+{
+  unsigned int        i, n;
+  struct vrna_nbhd_s  *nb;
+
+  if ((!fc) ||
+      (!pt))
+    return NULL;
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (fc->params->model_details.circ) ||
+      (fc->params->model_details.gquad)) {
+    vrna_log_warning("vrna_nbhd_init: "
+                     "only available for single, linear RNA sequences without G-quadruplexes");
+    return NULL;
+  }
+
+  if (options & VRNA_MOVESET_NO_LP) {
+    vrna_log_warning("vrna_nbhd_init: move sets without lonely pairs are not supported");
+    return NULL;
+  }
+
+  n   = fc->length;
+  nb  = (struct vrna_nbhd_s *)vrna_alloc(sizeof(struct vrna_nbhd_s));
+
+  nb->fc        = fc;
+  nb->options   = options;
+  nb->length    = n;
+  nb->pt        = vrna_ptable_copy(pt);
+  nb->up        = (int *)vrna_alloc(sizeof(int) * (n + 2));
+  nb->loop_en   = (int *)vrna_alloc(sizeof(int) * (n + 2));
+  nb->groups    = (struct nbhd_group *)vrna_alloc(sizeof(struct nbhd_group) * (n + 1));
+  nb->dirty     = (int *)vrna_alloc(sizeof(int) * (n + 1));
+  nb->is_dirty  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (n + 1));
+  nb->buf       = (int *)vrna_alloc(sizeof(int) * (n + 1));
+  nb->buf2      = (int *)vrna_alloc(sizeof(int) * (n + 1));
+
+  nb->energy      = vrna_eval_structure_pt(fc, nb->pt);
+  nb->loop_en[0]  = vrna_eval_loop_pt(fc, 0, nb->pt);
+  nbhd_set_up(nb, 0);
+
+  for (i = 1; i <= n; i++)
+    if (nb->pt[i] > i) {
+      nb->loop_en[i] = vrna_eval_loop_pt(fc, i, nb->pt);
+      nbhd_set_up(nb, i);
+    }
+
+  for (i = 0; i <= n; i++)
+    if ((i == 0) ||
+        (nb->pt[i] > i))
+      nbhd_make_group(nb, i);
+
+  return nb;
+}
+
+
+PUBLIC void
+vrna_nbhd_free(vrna_nbhd_t nb)
+{
+  unsigned int i;
+
+  if (nb) {
+    for (i = 0; i <= nb->length; i++) {
+      free(nb->groups[i].moves);
+      free(nb->groups[i].dE);
+    }
+
+    free(nb->groups);
+    free(nb->pt);
+    free(nb->up);
+    free(nb->loop_en);
+    free(nb->dirty);
+    free(nb->is_dirty);
+    free(nb->buf);
+    free(nb->buf2);
+    free(nb);
+  }
+}
+
+
+PUBLIC int
+vrna_nbhd_energy(vrna_nbhd_t nb)
+{
+  return (nb) ? nb->energy : INF;
+}
+
+
+PUBLIC const short *
+vrna_nbhd_ptable(vrna_nbhd_t nb)
+{
+  return (nb) ? (const short *)nb->pt : NULL;
+}
+
+
+PUBLIC size_t
+vrna_nbhd_size(vrna_nbhd_t nb)
+{
+  if (!nb)
+    return 0;
+
+  nbhd_refresh(nb);
+
+  return nb->num_moves;
+}
+
+
+PUBLIC vrna_move_t *
+vrna_nbhd_list(vrna_nbhd_t  nb,
+               int          **dE)
+{
+  unsigned int  g;
+  size_t        k;
+  vrna_move_t   *moves;
+
+  if (!nb)
+    return NULL;
+
+  nbhd_refresh(nb);
+
+  moves = (vrna_move_t *)vrna_alloc(sizeof(vrna_move_t) * (nb->num_moves + 1));
+  if (dE)
+    *dE = (int *)vrna_alloc(sizeof(int) * (nb->num_moves + 1));
+
+  for (k = 0, g = 0; g <= nb->length; g++) {
+    if (nb->groups[g].num == 0)
+      continue;
+
+    memcpy(moves + k, nb->groups[g].moves, sizeof(vrna_move_t) * nb->groups[g].num);
+    if (dE)
+      memcpy(*dE + k, nb->groups[g].dE, sizeof(int) * nb->groups[g].num);
+
+    k += nb->groups[g].num;
+  }
+
+  moves[k] = vrna_move_init(0, 0);
+
+  return moves;
+}
+
+
+PUBLIC int
+vrna_nbhd_apply(vrna_nbhd_t       nb,
+                const vrna_move_t *m)
+{
+  short                 *pt;
+  int                   i, j, k, f, p, q, a, b, P, dE, mingap;
+  vrna_fold_compound_t  *fc;
+
+  if ((!nb) ||
+      (!m) ||
+      (m->pos_5 == 0) ||
+      (m->pos_3 == 0) ||
+      (abs(m->pos_5) > (int)nb->length) ||
+      (abs(m->pos_3) > (int)nb->length))
+    return INF;
+
+  fc      = nb->fc;
+  pt      = nb->pt;
+  mingap  = fc->params->model_details.min_loop_size;
+
+  if (vrna_move_is_insertion(m)) {
+    i = m->pos_5;
+    j = m->pos_3;
+    P = nb->up[i];
+
+    if ((j - i <= mingap) ||
+        (pt[i] != 0) ||
+        (pt[j] != 0) ||
+        (nb->up[j] != P) ||
+        (!is_compatible(fc, i, j)))
+      return INF;
+
+    pt[i]           = j;
+    pt[j]           = i;
+    nb->loop_en[i]  = vrna_eval_loop_pt(fc, i, pt);
+    dE              = nb->loop_en[i] - nb->loop_en[P];
+    nb->loop_en[P]  = vrna_eval_loop_pt(fc, P, pt);
+    dE              += nb->loop_en[P];
+
+    nbhd_set_up(nb, i);
+    nbhd_touch(nb, i);
+    nbhd_touch(nb, P);
+  } else if (vrna_move_is_removal(m)) {
+    i = -m->pos_5;
+    j = -m->pos_3;
+
+    if ((i > j) ||
+        (pt[i] != j))
+      return INF;
+
+    P               = nb->up[i];
+    pt[i]           = 0;
+    pt[j]           = 0;
+    dE              = -nb->loop_en[i] - nb->loop_en[P];
+    nb->loop_en[i]  = 0;
+    nb->loop_en[P]  = vrna_eval_loop_pt(fc, P, pt);
+    dE              += nb->loop_en[P];
+
+    nbhd_set_up(nb, P);
+    nbhd_mark(nb, i);
+    nbhd_touch(nb, P);
+  } else if (vrna_move_is_shift(m)) {
+    /* the position that remains paired is positive, its new partner negative */
+    f = (m->pos_5 > 0) ? m->pos_5 : m->pos_3;
+    k = (m->pos_5 > 0) ? -m->pos_3 : -m->pos_5;
+
+    if ((pt[f] == 0) ||
+        (pt[k] != 0) ||
+        (abs(f - k) <= mingap) ||
+        (!is_compatible(fc, MIN2(f, k), MAX2(f, k))))
+      return INF;
+
+    p = MIN2(f, pt[f]);
+    q = MAX2(f, pt[f]);
+    P = nb->up[p];
+
+    /* new partner must be in the loop closed by the pair or its enclosing loop */
+    if ((nb->up[k] != p) &&
+        (nb->up[k] != P))
+      return INF;
+
+    a = MIN2(f, k);
+    b = MAX2(f, k);
+
+    dE              = -nb->loop_en[p] - nb->loop_en[P];
+    pt[p]           = 0;
+    pt[q]           = 0;
+    nb->loop_en[p]  = 0;
+    pt[a]           = b;
+    pt[b]           = a;
+    nb->loop_en[a]  = vrna_eval_loop_pt(fc, a, pt);
+    nb->loop_en[P]  = vrna_eval_loop_pt(fc, P, pt);
+    dE              += nb->loop_en[a] + nb->loop_en[P];
+
+    nbhd_set_up(nb, P);
+    nbhd_set_up(nb, a);
+    nbhd_mark(nb, p);
+    nbhd_touch(nb, a);
+    nbhd_touch(nb, P);
+  } else {
+    return INF;
+  }
+
+  nb->energy += dE;
+
+  return dE;
+}
+
+
+/* assign loop g to all positions directly inside of it */
+PRIVATE void
+nbhd_set_up(struct vrna_nbhd_s  *nb,
+            int                 g)
+{
+  int   k, end;
+  short *pt = nb->pt;
+
+  k   = (g == 0) ? 1 : g + 1;
+  end = (g == 0) ? (int)nb->length + 1 : pt[g];
+
+  for (; k < end; k++) {
+    nb->up[k] = g;
+    if (pt[k] > k) {
+      k         = pt[k];
+      nb->up[k] = g;
+    }
+  }
+}
+
+
+/* collect unpaired positions of loop g */
+PRIVATE unsigned int
+nbhd_unpaired(struct vrna_nbhd_s  *nb,
+              int                 g,
+              int                 *u)
+{
+  unsigned int  cnt;
+  int           k, end;
+  short         *pt = nb->pt;
+
+  k   = (g == 0) ? 1 : g + 1;
+  end = (g == 0) ? (int)nb->length + 1 : pt[g];
+
+  for (cnt = 0; k < end; k++) {
+    if (pt[k] > k)
+      k = pt[k];
+    else
+      u[cnt++] = k;
+  }
+
+  return cnt;
+}
+
+
+PRIVATE void
+nbhd_add(struct nbhd_group  *G,
+         vrna_move_t        m,
+         int                dE)
+{
+  if (G->num == G->size) {
+    G->size   = (G->size == 0) ? 16 : 2 * G->size;
+    G->moves  = (vrna_move_t *)vrna_realloc(G->moves, sizeof(vrna_move_t) * G->size);
+    G->dE     = (int *)vrna_realloc(G->dE, sizeof(int) * G->size);
+  }
+
+  G->moves[G->num]  = m;
+  G->dE[G->num]     = dE;
+  G->num++;
+}
+
+
+/* (re-)generate all neighbors of loop g */
+PRIVATE void
+nbhd_make_group(struct vrna_nbhd_s  *nb,
+                int                 g)
+{
+  short                 *pt;
+  unsigned int          nu, nv, x, y;
+  int                   i, j, k, P, e, E_old, mingap;
+  int                   *u, *v;
+  vrna_fold_compound_t  *fc;
+  struct nbhd_group     *G;
+
+  fc      = nb->fc;
+  pt      = nb->pt;
+  mingap  = fc->params->model_details.min_loop_size;
+  G       = nb->groups + g;
+
+  nb->num_moves -= G->num;
+  G->num        = 0;
+
+  if ((g > 0) &&
+      (pt[g] <= g))
+    return; /* base pair is gone */
+
+  u   = nb->buf;
+  nu  = nbhd_unpaired(nb, g, u);
+
+  if (nb->options & VRNA_MOVESET_INSERTION) {
+    for (x = 0; x < nu; x++)
+      for (y = x + 1; y < nu; y++) {
+        i = u[x];
+        j = u[y];
+        if ((j - i <= mingap) ||
+            (!is_compatible(fc, i, j)))
+          continue;
+
+        pt[i] = j;
+        pt[j] = i;
+        e     = vrna_eval_loop_pt(fc, i, pt) +
+                vrna_eval_loop_pt(fc, g, pt) -
+                nb->loop_en[g];
+        pt[i] = 0;
+        pt[j] = 0;
+        nbhd_add(G, vrna_move_init(i, j), e);
+      }
+  }
+
+  if (g == 0) {
+    nb->num_moves += G->num;
+    return;
+  }
+
+  i     = g;
+  j     = pt[g];
+  P     = nb->up[g];
+  E_old = nb->loop_en[g] + nb->loop_en[P];
+
+  if (nb->options & VRNA_MOVESET_DELETION) {
+    pt[i] = 0;
+    pt[j] = 0;
+    e     = vrna_eval_loop_pt(fc, P, pt) - E_old;
+    pt[i] = j;
+    pt[j] = i;
+    nbhd_add(G, vrna_move_init(-i, -j), e);
+  }
+
+  if (nb->options & VRNA_MOVESET_SHIFT) {
+    v   = nb->buf2;
+    nv  = nbhd_unpaired(nb, P, v);
+
+    pt[i] = 0;
+    pt[j] = 0;
+
+    /* shifts into the loop closed by (i,j) */
+    for (x = 0; x < nu; x++) {
+      k = u[x];
+      if ((k - i > mingap) &&
+          (is_compatible(fc, i, k))) {
+        pt[i] = k;
+        pt[k] = i;
+        e     = vrna_eval_loop_pt(fc, i, pt) +
+                vrna_eval_loop_pt(fc, P, pt) -
+                E_old;
+        pt[i] = 0;
+        pt[k] = 0;
+        nbhd_add(G, vrna_move_init(i, -k), e);
+      }
+
+      if ((j - k > mingap) &&
+          (is_compatible(fc, k, j))) {
+        pt[k] = j;
+        pt[j] = k;
+        e     = vrna_eval_loop_pt(fc, k, pt) +
+                vrna_eval_loop_pt(fc, P, pt) -
+                E_old;
+        pt[k] = 0;
+        pt[j] = 0;
+        nbhd_add(G, vrna_move_init(-k, j), e);
+      }
+    }
+
+    /* shifts into the enclosing loop */
+    for (x = 0; x < nv; x++) {
+      int a, b, f;
+      k = v[x];
+      for (f = i; f != 0; f = (f == i) ? j : 0) {
+        a = MIN2(f, k);
+        b = MAX2(f, k);
+        if ((b - a <= mingap) ||
+            (!is_compatible(fc, a, b)))
+          continue;
+
+        pt[a] = b;
+        pt[b] = a;
+        e     = vrna_eval_loop_pt(fc, a, pt) +
+                vrna_eval_loop_pt(fc, P, pt) -
+                E_old;
+        pt[a] = 0;
+        pt[b] = 0;
+        nbhd_add(G, (k < f) ? vrna_move_init(-k, f) : vrna_move_init(f, -k), e);
+      }
+    }
+
+    pt[i] = j;
+    pt[j] = i;
+  }
+
+  nb->num_moves += G->num;
+}
+
+
+PRIVATE void
+nbhd_mark(struct vrna_nbhd_s  *nb,
+          int                 g)
+{
+  if (!nb->is_dirty[g]) {
+    nb->is_dirty[g]               = 1;
+    nb->dirty[nb->num_dirty++]  = g;
+  }
+}
+
+
+/* loop g changed, so did the neighbors of its closing pair and the pairs inside */
+PRIVATE void
+nbhd_touch(struct vrna_nbhd_s *nb,
+           int                g)
+{
+  int   k, end;
+  short *pt = nb->pt;
+
+  nbhd_mark(nb, g);
+
+  k   = (g == 0) ? 1 : g + 1;
+  end = (g == 0) ? (int)nb->length + 1 : pt[g];
+
+  for (; k < end; k++)
+    if (pt[k] > k) {
+      nbhd_mark(nb, k);
+      k = pt[k];
+    }
+}
+
+
+PRIVATE void
+nbhd_refresh(struct vrna_nbhd_s *nb)
+{
+  unsigned int  k;
+  int           g;
+
+  for (k = 0; k < nb->num_dirty; k++) {
+    g               = nb->dirty[k];
+    nb->is_dirty[g] = 0;
+    nbhd_make_group(nb, g);
+  }
+
+  nb->num_dirty = 0;
+}
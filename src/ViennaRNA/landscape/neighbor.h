@@ -200,6 +200,116 @@ vrna_move_neighbor_diff(vrna_fold_compound_t  *fc,
                         unsigned int          options);
 
 
+/**
+ *  @brief  A neighborhood object for successive moves with incrementally updated energy changes
+ *
+ *  @see  vrna_nbhd_init(), vrna_nbhd_list(), vrna_nbhd_apply(), vrna_nbhd_free()
+ */
+typedef struct vrna_nbhd_s *vrna_nbhd_t;
+
+
+/**
+ *  @brief  Create a neighborhood object for a secondary structure
+ *
+ *  The neighborhood object keeps a copy of the structure, the free energy of each of its loops,
+ *  and all neighbors of the structure together with their free energy changes. Neighbors are
+ *  grouped by the loop they originate from, i.e. the base pair insertions into a loop and the
+ *  deletion and shifts of its closing pair. Since the energy change of a move only depends on
+ *  the loops it modifies, applying a move through vrna_nbhd_apply() only re-evaluates the
+ *  neighbors of the loops that have actually changed. This makes successive neighbor
+ *  enumeration, e.g. in a gradient walk, much cheaper than calling vrna_neighbors() and
+ *  vrna_eval_move_pt() for each neighbor after every step.
+ *
+ *  @note   Only linear, single stranded sequences without G-Quadruplexes are supported. The
+ *          #VRNA_MOVESET_NO_LP move set is not available. In these cases, @em NULL is returned.
+ *
+ *  @see  vrna_nbhd_free(), vrna_nbhd_list(), vrna_nbhd_apply(), vrna_neighbors(),
+ *        #VRNA_MOVESET_INSERTION, #VRNA_MOVESET_DELETION, #VRNA_MOVESET_SHIFT, #VRNA_MOVESET_DEFAULT
+ *
+ *  @param  fc        A fold compound for the RNA sequence this function operates on
+ *  @param  pt        The pair table of the initial structure
+ *  @param  options   Options to modify the behavior of this function, e.g. available move set
+ *  @return           A neighborhood object, or @em NULL on error
+ */
+vrna_nbhd_t
+vrna_nbhd_init(vrna_fold_compound_t *fc,
+               const short          *pt,
+               unsigned int         options);
+
+
+/**
+ *  @brief  Release memory occupied by a neighborhood object
+ *
+ *  @see  vrna_nbhd_init()
+ *
+ *  @param  nb  The neighborhood object
+ */
+void
+vrna_nbhd_free(vrna_nbhd_t nb);
+
+
+/**
+ *  @brief  Get the free energy of the current structure of a neighborhood object
+ *
+ *  @param  nb  The neighborhood object
+ *  @return     The free energy of the current structure in dcal/mol
+ */
+int
+vrna_nbhd_energy(vrna_nbhd_t nb);
+
+
+/**
+ *  @brief  Get the pair table of the current structure of a neighborhood object
+ *
+ *  @param  nb  The neighborhood object
+ *  @return     The pair table of the current structure (must not be modified)
+ */
+const short *
+vrna_nbhd_ptable(vrna_nbhd_t nb);
+
+
+/**
+ *  @brief  Get the number of neighbors of the current structure
+ *
+ *  @param  nb  The neighborhood object
+ *  @return     The number of neighbors
+ */
+size_t
+vrna_nbhd_size(vrna_nbhd_t nb);
+
+
+/**
+ *  @brief  List the neighbors of the current structure and their free energy changes
+ *
+ *  @see  vrna_nbhd_apply()
+ *
+ *  @param  nb  The neighborhood object
+ *  @param  dE  A pointer to store the free energy changes in dcal/mol (same order as the moves), may be @em NULL
+ *  @return     Neighbors as a list of moves (the last element in the list has both of its fields set to 0)
+ */
+vrna_move_t *
+vrna_nbhd_list(vrna_nbhd_t  nb,
+               int          **dE);
+
+
+/**
+ *  @brief  Apply a move to the current structure of a neighborhood object
+ *
+ *  The move must be a neighbor of the current structure, i.e. of the same form as returned by
+ *  vrna_nbhd_list(). For shift moves, the position that remains paired is positive and its new
+ *  partner is negative. Only the loops affected by the move are re-evaluated.
+ *
+ *  @see  vrna_nbhd_list()
+ *
+ *  @param  nb  The neighborhood object
+ *  @param  m   The move to apply
+ *  @return     The free energy change of the move in dcal/mol, or #INF if the move is not a valid neighbor
+ */
+int
+vrna_nbhd_apply(vrna_nbhd_t       nb,
+                const vrna_move_t *m);
+
+
 /**
  *  @}
  */
@@ -76,6 +76,13 @@ gradient_descent(vrna_fold_compound_t *fc,
                  unsigned int         options);
 
 
+PRIVATE vrna_move_t *
+steepest_descent_nbhd(vrna_fold_compound_t  *fc,
+                      short                 *pt,
+                      vrna_nbhd_t           nb,
+                      unsigned int          options);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -116,8 +123,25 @@ vrna_path(vrna_fold_compound_t  *vc,
           unsigned int          steps,
           unsigned int          options)
 {
-  if ((vc) && (ptStartAndResultStructure))
+  vrna_nbhd_t nb;
+
+  if ((vc) && (ptStartAndResultStructure)) {
+    /*
+     *  steepest descent with shift moves uses the incrementally updated
+     *  neighborhood whenever the energy model allows for it
+     */
+    if ((options & VRNA_PATH_STEEPEST_DESCENT) &&
+        (options & VRNA_MOVESET_SHIFT) &&
+        (!(options & VRNA_MOVESET_NO_LP)) &&
+        (vc->type == VRNA_FC_TYPE_SINGLE) &&
+        (vc->strands == 1) &&
+        (!vc->params->model_details.circ) &&
+        (!vc->params->model_details.gquad) &&
+        (nb = vrna_nbhd_init(vc, ptStartAndResultStructure, options)))
+      return steepest_descent_nbhd(vc, ptStartAndResultStructure, nb, options);
+
     return do_path(vc, ptStartAndResultStructure, steps, options);
+  }
 
   return NULL;
 }
@@ -187,25 +211,12 @@ isLexicographicallySmaller(short        *ptStructure,
   vrna_move_apply(s_n, n);
   bool  isSmaller = false;
 
-  for (int i = 1; i < s_m[0]; i++) {
-    if (s_m[i] != s_n[i]) {
-      char  c_m = '.';
-      char  c_n = '.';
-      if (s_m[i] != 0) {
-        if (s_m[i] < i)
-          c_m = '(';
-
-        if (s_m[i] > i)
-          c_m = ')';
-      }
-
-      if (s_n[i] != 0) {
-        if (s_n[i] < i)
-          c_n = '(';
-        else
-          c_n = ')';
-      }
+  for (int i = 1; i <= s_m[0]; i++) {
+    char  c_m = (s_m[i] == 0) ? '.' : ((s_m[i] > i) ? '(' : ')');
+    char  c_n = (s_n[i] == 0) ? '.' : ((s_n[i] > i) ? '(' : ')');
 
+    /* pair tables may differ where the dot-bracket strings do not */
+    if (c_m != c_n) {
       isSmaller = c_m < c_n;
       break;
     }
@@ -326,6 +337,77 @@ do_path(vrna_fold_compound_t  *vc,
 }
 
 
+/*
+ *  Same walk as do_path() with VRNA_PATH_STEEPEST_DESCENT, but the energy
+ *  changes of all neighbors are taken from the neighborhood object that
+ *  only re-evaluates the loops affected by the previous move
+ */
+PRIVATE vrna_move_t *
+steepest_descent_nbhd(vrna_fold_compound_t  *fc,
+                      short                 *pt,
+                      vrna_nbhd_t           nb,
+                      unsigned int          options)
+{
+  int         i, lowestEnergy, lowestEnergyIndex, *dE;
+  size_t      num_moves, mem_moves;
+  vrna_move_t *moveset, *moves, m;
+
+  num_moves = 0;
+  mem_moves = fc->length;
+  moves     = NULL;
+
+  if (!(options & VRNA_PATH_NO_TRANSITION_OUTPUT))
+    moves = vrna_alloc(sizeof(vrna_move_t) * (mem_moves + 1));
+
+  while (1) {
+    moveset           = vrna_nbhd_list(nb, &dE);
+    lowestEnergyIndex = -1;
+    lowestEnergy      = 0;
+    m                 = vrna_move_init(0, 0);
+
+    for (i = 0; moveset[i].pos_5 != 0; i++) {
+      if (dE[i] <= lowestEnergy) {
+        /* make the walk unique */
+        if ((dE[i] == lowestEnergy) &&
+            !isLexicographicallySmaller(pt, moveset + i, &m))
+          continue;
+
+        lowestEnergy      = dE[i];
+        lowestEnergyIndex = i;
+        m                 = moveset[i];
+      }
+    }
+
+    free(moveset);
+    free(dE);
+
+    if (lowestEnergyIndex == -1)
+      break;
+
+    if (moves) {
+      if (num_moves >= mem_moves) {
+        mem_moves += fc->length;
+        moves     = vrna_realloc(moves, sizeof(vrna_move_t) * (mem_moves + 1));
+      }
+
+      moves[num_moves++] = m;
+    }
+
+    vrna_nbhd_apply(nb, &m);
+    vrna_move_apply(pt, &m);
+  }
+
+  vrna_nbhd_free(nb);
+
+  if (moves) {
+    moves[num_moves]  = vrna_move_init(0, 0);
+    moves             = vrna_realloc(moves, sizeof(vrna_move_t) * (num_moves + 1));
+  }
+
+  return moves;
+}
+
+
 PRIVATE INLINE unsigned int
 rev_idx(const vrna_move_t *m)
 {
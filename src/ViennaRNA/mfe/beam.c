@@ -0,0 +1,1003 @@
+/*
+ *                Left-to-right beam search shared by the approximate
+ *                minimum free energy and partition function engines
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/sequences/alphabet.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/constraints/soft.h"
+#include "ViennaRNA/eval/basic.h"
+#include "ViennaRNA/eval/exterior.h"
+#include "ViennaRNA/eval/hairpin.h"
+#include "ViennaRNA/eval/internal.h"
+#include "ViennaRNA/eval/multibranch.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/beam_dat.h"
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+BEAM_INTERNAL int
+beam_applicable(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md;
+
+  md = &(fc->params->model_details);
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (md->circ) ||
+      (md->gquad) ||
+      (md->noLP) ||
+      ((md->dangles != 0) && (md->dangles != 2)) ||
+      ((fc->hc) && ((fc->hc->type == VRNA_HC_WINDOW) || (fc->hc->f))) ||
+      ((fc->sc) && ((fc->sc->type != VRNA_SC_DEFAULT) || (fc->sc->f) || (fc->sc->exp_f))) ||
+      ((fc->domains_up) && (fc->domains_up->energy_cb)) ||
+      (fc->aux_grammar))
+    return 0;
+
+  return 1;
+}
+
+
+BEAM_INTERNAL int
+beam_prepare(vrna_fold_compound_t  *fc,
+             unsigned int          options)
+{
+  if (fc->length > vrna_sequence_length_max(options))
+    return 0;
+
+  vrna_params_prepare(fc, options);
+
+  /* without user-defined hard constraints, default constraints are evaluated on the fly */
+  if (fc->hc)
+    vrna_hc_prepare(fc, options);
+
+  vrna_sc_prepare(fc, options);
+
+  return 1;
+}
+
+
+PRIVATE INLINE double
+beam_logadd(double  a,
+            double  b)
+{
+  if (a < b) {
+    double t = a;
+    a = b;
+    b = t;
+  }
+
+  if (b == -INFINITY)
+    return a;
+
+  return a + log1p(exp(b - a));
+}
+
+
+PRIVATE INLINE void
+beam_state_init(beam_state_t  *s,
+                unsigned int  mode)
+{
+  s->v      = (mode == BEAM_MODE_MFE) ? INFINITY : -INFINITY;
+  s->w      = -INFINITY;
+  s->t1     = 0;
+  s->t2     = 0;
+  s->manner = BEAM_MANNER_NONE;
+}
+
+
+PRIVATE INLINE unsigned int
+beam_hash(unsigned int  i,
+          unsigned int  cap)
+{
+  return (i * 2654435761U) & (cap - 1);
+}
+
+
+BEAM_INTERNAL beam_state_t *
+beam_bucket_get(beam_bucket_t  *b,
+                unsigned int   i)
+{
+  unsigned int h;
+
+  if (b->cap == 0)
+    return NULL;
+
+  for (h = beam_hash(i, b->cap); b->keys[h]; h = (h + 1) & (b->cap - 1))
+    if (b->keys[h] == i)
+      return b->states + h;
+
+  return NULL;
+}
+
+
+PRIVATE void
+beam_bucket_resize(beam_bucket_t  *b,
+                   unsigned int   cap)
+{
+  unsigned int  s, h, *keys;
+  beam_state_t  *states;
+
+  keys    = b->keys;
+  states  = b->states;
+
+  b->keys   = (unsigned int *)vrna_alloc(sizeof(unsigned int) * cap);
+  b->states = (beam_state_t *)vrna_alloc(sizeof(beam_state_t) * cap);
+
+  for (s = 0; s < b->cap; s++) {
+    if (keys[s]) {
+      for (h = beam_hash(keys[s], cap); b->keys[h]; h = (h + 1) & (cap - 1));
+      b->keys[h]    = keys[s];
+      b->states[h]  = states[s];
+    }
+  }
+
+  b->cap = cap;
+
+  free(keys);
+  free(states);
+}
+
+
+PRIVATE INLINE beam_state_t *
+beam_bucket_insert(beam_bucket_t  *b,
+                   unsigned int   i,
+                   unsigned int   mode)
+{
+  unsigned int  h;
+  beam_state_t  *s;
+
+  if ((s = beam_bucket_get(b, i)))
+    return s;
+
+  if (2 * (b->num + 1) > b->cap)
+    beam_bucket_resize(b, (b->cap) ? 2 * b->cap : 8);
+
+  for (h = beam_hash(i, b->cap); b->keys[h]; h = (h + 1) & (b->cap - 1));
+
+  b->keys[h] = i;
+  b->num++;
+  beam_state_init(b->states + h, mode);
+
+  return b->states + h;
+}
+
+
+PRIVATE INLINE void
+beam_bucket_free(beam_bucket_t *b)
+{
+  free(b->keys);
+  free(b->states);
+  b->keys   = NULL;
+  b->states = NULL;
+  b->num    = b->cap = 0;
+}
+
+
+/* k-th smallest element (0-based) of an array, partially reorders the array */
+PRIVATE double
+beam_select(double        *a,
+            unsigned int  num,
+            unsigned int  k)
+{
+  long    l, r, i, j;
+  double  pivot, t;
+
+  l = 0;
+  r = (long)num - 1;
+
+  while (l < r) {
+    pivot = a[l + (r - l) / 2];
+    i     = l;
+    j     = r;
+
+    do {
+      while (a[i] < pivot)
+        i++;
+      while (pivot < a[j])
+        j--;
+
+      if (i <= j) {
+        t     = a[i];
+        a[i]  = a[j];
+        a[j]  = t;
+        i++;
+        j--;
+      }
+    } while (i <= j);
+
+    if ((long)k <= j)
+      r = j;
+    else if ((long)k >= i)
+      l = i;
+    else
+      break;
+  }
+
+  return a[k];
+}
+
+
+PRIVATE INLINE double
+beam_rank(struct beam_dat *d,
+          unsigned int    i,
+          beam_state_t    *s)
+{
+  double r = s->v + d->C[i - 1].v;
+
+  return (d->mode == BEAM_MODE_MFE) ? r : -r;
+}
+
+
+PRIVATE void
+beam_prune(struct beam_dat  *d,
+           beam_bucket_t    *b)
+{
+  unsigned int  s, cnt, cap;
+  double        threshold;
+  beam_bucket_t pruned;
+
+  if ((d->beam == 0) ||
+      (b->num <= d->beam))
+    return;
+
+  if (b->num > d->scores_size) {
+    d->scores_size  = b->num;
+    d->scores       = (double *)vrna_realloc(d->scores, sizeof(double) * d->scores_size);
+  }
+
+  for (cnt = s = 0; s < b->cap; s++)
+    if (b->keys[s])
+      d->scores[cnt++] = beam_rank(d, b->keys[s], b->states + s);
+
+  threshold = beam_select(d->scores, cnt, d->beam - 1);
+
+  for (cap = 8; cap < 2 * d->beam; cap *= 2);
+
+  pruned.keys   = (unsigned int *)vrna_alloc(sizeof(unsigned int) * cap);
+  pruned.states = (beam_state_t *)vrna_alloc(sizeof(beam_state_t) * cap);
+  pruned.num    = 0;
+  pruned.cap    = cap;
+
+  for (s = 0; s < b->cap; s++)
+    if ((b->keys[s]) &&
+        (beam_rank(d, b->keys[s], b->states + s) <= threshold))
+      *(beam_bucket_insert(&pruned, b->keys[s], d->mode)) = b->states[s];
+
+  beam_bucket_free(b);
+  *b = pruned;
+}
+
+
+BEAM_INTERNAL struct beam_dat *
+beam_dat_init(vrna_fold_compound_t *fc,
+              unsigned int         mode)
+{
+  unsigned int    n, c, k, t;
+  struct beam_dat *d;
+
+  n = fc->length;
+  d = (struct beam_dat *)vrna_alloc(sizeof(struct beam_dat));
+
+  d->fc           = fc;
+  d->mode         = mode;
+  d->n            = n;
+  d->beam         = fc->beam_size;
+  d->S1           = fc->sequence_encoding;
+  d->S2           = fc->sequence_encoding2;
+  d->P            = fc->params;
+  d->md           = &(fc->params->model_details);
+  d->dangles      = d->md->dangles;
+  d->noGUclosure  = d->md->noGUclosure;
+  d->min_loop     = d->md->min_loop_size;
+  d->span         = ((d->md->max_bp_span <= 0) || ((unsigned int)d->md->max_bp_span > n)) ?
+                    n :
+                    (unsigned int)d->md->max_bp_span;
+  d->kT_inv       = (fc->exp_params) ? 10. / fc->exp_params->kT : 0.;
+
+  if (fc->hc) {
+    d->mx     = fc->hc->mx;
+    d->up_ext = fc->hc->up_ext;
+    d->up_hp  = fc->hc->up_hp;
+    d->up_int = fc->hc->up_int;
+    d->up_ml  = fc->hc->up_ml;
+  } else {
+    d->mx     = NULL;
+    d->up_ext = d->up_hp = d->up_int = d->up_ml = NULL;
+  }
+
+  d->idx    = fc->jindx;
+  d->sc_up  = (fc->sc) ? fc->sc->energy_up : NULL;
+  d->sc_bp  = (fc->sc) ? fc->sc->energy_bp : NULL;
+  d->with_sc = (fc->sc) ? 1 : 0;
+
+  /* nucleotide classes and next possible pairing partners */
+  for (d->classes = 0, k = 1; k <= n; k++)
+    if ((unsigned int)d->S2[k] >= d->classes)
+      d->classes = d->S2[k] + 1;
+
+  d->next_pair = (unsigned int **)vrna_alloc(sizeof(unsigned int *) * d->classes);
+  for (c = 0; c < d->classes; c++) {
+    d->next_pair[c] = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (n + 2));
+    for (k = n; k > 0; k--)
+      d->next_pair[c][k] = (d->md->pair[c][d->S2[k]]) ? k : d->next_pair[c][k + 1];
+  }
+
+  for (t = 0; t < BEAM_TYPES; t++)
+    d->buckets[t] = (beam_bucket_t *)vrna_alloc(sizeof(beam_bucket_t) * (n + 2));
+
+  d->C = (beam_state_t *)vrna_alloc(sizeof(beam_state_t) * (n + 2));
+  for (k = 0; k <= n; k++)
+    beam_state_init(d->C + k, mode);
+
+  d->scores       = NULL;
+  d->scores_size  = 0;
+
+  return d;
+}
+
+
+BEAM_INTERNAL void
+beam_dat_free(struct beam_dat *d)
+{
+  unsigned int c, t, j;
+
+  if (d) {
+    for (c = 0; c < d->classes; c++)
+      free(d->next_pair[c]);
+
+    free(d->next_pair);
+
+    for (t = 0; t < BEAM_TYPES; t++) {
+      for (j = 0; j <= d->n + 1; j++)
+        beam_bucket_free(d->buckets[t] + j);
+      free(d->buckets[t]);
+    }
+
+    free(d->C);
+    free(d->scores);
+    free(d);
+  }
+}
+
+
+/*
+ *  Energy contributions of the individual loop decompositions. All of them
+ *  return INF if the decomposition is prohibited by hard constraints.
+ */
+PRIVATE INLINE unsigned int
+beam_next_pair(struct beam_dat  *d,
+               unsigned int     i,
+               unsigned int     k)
+{
+  return (k <= d->n) ? d->next_pair[d->S2[i]][k] : 0;
+}
+
+
+/*
+ *  Loop contexts the pair (i,j) may appear in. Unless the fold compound
+ *  has hard constraints, the default constraints are derived from the
+ *  sequence and the model details on the fly, as for vrna_hc_init()
+ */
+PRIVATE INLINE unsigned char
+beam_hc_bp(struct beam_dat  *d,
+           unsigned int     i,
+           unsigned int     j)
+{
+  if (d->mx)
+    return d->mx[d->n * i + j];
+
+  if ((j - i >= (unsigned int)d->md->max_bp_span) ||
+      (j - i <= d->min_loop))
+    return VRNA_CONSTRAINT_CONTEXT_NONE;
+
+  switch (d->md->pair[d->S2[i]][d->S2[j]]) {
+    case 0:
+      return VRNA_CONSTRAINT_CONTEXT_NONE;
+
+    case 3:
+    /* fallthrough */
+    case 4:
+      if (d->md->noGU)
+        return VRNA_CONSTRAINT_CONTEXT_NONE;
+      else if (d->noGUclosure)
+        return VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS &
+               ~(VRNA_CONSTRAINT_CONTEXT_HP_LOOP | VRNA_CONSTRAINT_CONTEXT_MB_LOOP);
+
+    /* else fallthrough */
+    default:
+      return VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS;
+  }
+}
+
+
+/* whether u nucleotides starting at position i may stay unpaired */
+PRIVATE INLINE int
+beam_hc_up(unsigned int *up,
+           unsigned int i,
+           unsigned int u)
+{
+  return (!up) || (up[i] >= u);
+}
+
+
+PRIVATE INLINE int
+beam_e_hp(struct beam_dat *d,
+          unsigned int    i,
+          unsigned int    j)
+{
+  unsigned int type;
+
+  if (!(beam_hc_bp(d, i, j) & VRNA_CONSTRAINT_CONTEXT_HP_LOOP))
+    return INF;
+
+  type = vrna_get_ptype_md(d->S2[i], d->S2[j], d->md);
+
+  if ((d->noGUclosure) &&
+      ((type == 3) || (type == 4)))
+    return INF;
+
+  if (d->with_sc)
+    return vrna_eval_hairpin(d->fc, i, j, VRNA_EVAL_LOOP_NO_HC);
+
+  return vrna_E_hairpin(j - i - 1,
+                        type,
+                        d->S1[i + 1],
+                        d->S1[j - 1],
+                        d->fc->sequence + i - 1,
+                        d->P);
+}
+
+
+/* internal loop enclosed by (p,q) with inner pair (i,j) */
+PRIVATE INLINE int
+beam_e_int(struct beam_dat  *d,
+           unsigned int     p,
+           unsigned int     q,
+           unsigned int     i,
+           unsigned int     j)
+{
+  if ((!(beam_hc_bp(d, p, q) & VRNA_CONSTRAINT_CONTEXT_INT_LOOP)) ||
+      (!(beam_hc_bp(d, i, j) & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC)))
+    return INF;
+
+  if (d->with_sc)
+    return vrna_eval_internal(d->fc, p, q, i, j, VRNA_EVAL_LOOP_NO_HC);
+
+  return vrna_E_internal(i - p - 1,
+                         q - j - 1,
+                         vrna_get_ptype_md(d->S2[p], d->S2[q], d->md),
+                         vrna_get_ptype_md(d->S2[j], d->S2[i], d->md),
+                         d->S1[p + 1],
+                         d->S1[q - 1],
+                         d->S1[i - 1],
+                         d->S1[j + 1],
+                         d->P);
+}
+
+
+PRIVATE INLINE int
+beam_e_ml_stem(struct beam_dat  *d,
+               unsigned int     i,
+               unsigned int     j)
+{
+  if (!(beam_hc_bp(d, i, j) & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC))
+    return INF;
+
+  return vrna_E_multibranch_stem(vrna_get_ptype_md(d->S2[i], d->S2[j], d->md),
+                                 (d->dangles == 2) ? d->S1[i - 1] : -1,
+                                 (d->dangles == 2) ? d->S1[j + 1] : -1,
+                                 d->P);
+}
+
+
+PRIVATE INLINE int
+beam_e_ml_closing(struct beam_dat *d,
+                  unsigned int    i,
+                  unsigned int    j)
+{
+  int e;
+
+  if (!(beam_hc_bp(d, i, j) & VRNA_CONSTRAINT_CONTEXT_MB_LOOP))
+    return INF;
+
+  e = vrna_E_multibranch_stem(vrna_get_ptype_md(d->S2[j], d->S2[i], d->md),
+                              (d->dangles == 2) ? d->S1[j - 1] : -1,
+                              (d->dangles == 2) ? d->S1[i + 1] : -1,
+                              d->P) +
+      d->P->MLclosing;
+
+  if (d->sc_bp)
+    e += d->sc_bp[d->idx[j] + i];
+
+  return e;
+}
+
+
+PRIVATE INLINE int
+beam_e_ext_stem(struct beam_dat *d,
+                unsigned int    i,
+                unsigned int    j)
+{
+  if (!(beam_hc_bp(d, i, j) & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP))
+    return INF;
+
+  return vrna_E_exterior_stem(vrna_get_ptype_md(d->S2[i], d->S2[j], d->md),
+                              ((d->dangles == 2) && (i > 1)) ? d->S1[i - 1] : -1,
+                              ((d->dangles == 2) && (j < d->n)) ? d->S1[j + 1] : -1,
+                              d->P);
+}
+
+
+/* u unpaired nucleotides starting at position i within a multibranch loop */
+PRIVATE INLINE int
+beam_e_ml_up(struct beam_dat  *d,
+             unsigned int     i,
+             unsigned int     u)
+{
+  int e;
+
+  if (u == 0)
+    return 0;
+
+  if (!beam_hc_up(d->up_ml, i, u))
+    return INF;
+
+  e = (int)u * d->P->MLbase;
+
+  if (d->sc_up)
+    e += d->sc_up[i][u];
+
+  return e;
+}
+
+
+PRIVATE INLINE int
+beam_e_ext_up(struct beam_dat *d,
+              unsigned int    i,
+              unsigned int    u)
+{
+  if (!beam_hc_up(d->up_ext, i, u))
+    return INF;
+
+  return (d->sc_up) ? d->sc_up[i][u] : 0;
+}
+
+
+/*
+ *  Transitions
+ */
+PRIVATE INLINE beam_state_t *
+beam_target(struct beam_dat *d,
+            unsigned int    type,
+            unsigned int    j,
+            unsigned int    i)
+{
+  if (d->mode == BEAM_MODE_OUTSIDE)
+    return beam_bucket_get(d->buckets[type] + j, i);
+
+  return beam_bucket_insert(d->buckets[type] + j, i, d->mode);
+}
+
+
+PRIVATE INLINE void
+beam_relax(struct beam_dat  *d,
+           beam_state_t     *tgt,
+           beam_state_t     *src,
+           beam_state_t     *src2,
+           int              e,
+           unsigned char    manner,
+           unsigned int     t1,
+           unsigned int     t2)
+{
+  double x;
+
+  if (!tgt)
+    return;
+
+  switch (d->mode) {
+    case BEAM_MODE_MFE:
+      x = src->v + (double)e;
+      if (src2)
+        x += src2->v;
+
+      if (x < tgt->v) {
+        tgt->v      = x;
+        tgt->manner = manner;
+        tgt->t1     = t1;
+        tgt->t2     = t2;
+      }
+
+      break;
+
+    case BEAM_MODE_INSIDE:
+      x = src->v - (double)e * d->kT_inv;
+      if (src2)
+        x += src2->v;
+
+      tgt->v = beam_logadd(tgt->v, x);
+      break;
+
+    case BEAM_MODE_OUTSIDE:
+      x = tgt->w - (double)e * d->kT_inv;
+      if (src2) {
+        src->w  = beam_logadd(src->w, x + src2->v);
+        src2->w = beam_logadd(src2->w, x + src->v);
+      } else {
+        src->w = beam_logadd(src->w, x);
+      }
+
+      break;
+  }
+}
+
+
+/* find the first hairpin loop (i,q) with q >= k and store it as new candidate */
+PRIVATE INLINE void
+beam_hairpin_next(struct beam_dat *d,
+                  unsigned int    i,
+                  unsigned int    k)
+{
+  unsigned int  q;
+  int           e;
+  beam_state_t  *s;
+
+  for (q = beam_next_pair(d, i, k); q; q = beam_next_pair(d, i, q + 1)) {
+    if ((q - i > d->span) ||
+        (!beam_hc_up(d->up_hp, i + 1, q - i - 1)))
+      break;
+
+    e = beam_e_hp(d, i, q);
+    if (e != INF) {
+      s     = beam_bucket_insert(d->buckets[BEAM_H] + q, i, d->mode);
+      s->v  = (d->mode == BEAM_MODE_MFE) ? (double)e : -(double)e * d->kT_inv;
+      break;
+    }
+  }
+}
+
+
+PRIVATE void
+beam_expand_H(struct beam_dat *d,
+              unsigned int    j)
+{
+  unsigned int  k, i;
+  beam_bucket_t *b;
+
+  b = d->buckets[BEAM_H] + j;
+
+  for (k = 0; k < b->cap; k++) {
+    if ((i = b->keys[k])) {
+      beam_relax(d,
+                 beam_target(d, BEAM_P, j, i),
+                 b->states + k,
+                 NULL,
+                 0,
+                 BEAM_MANNER_HAIRPIN,
+                 0,
+                 0);
+
+      /* hairpin candidates are axioms, i.e. the next one does not derive from this one */
+      if (d->mode != BEAM_MODE_OUTSIDE)
+        beam_hairpin_next(d, i, j + 1);
+    }
+  }
+}
+
+
+PRIVATE void
+beam_expand_Multi(struct beam_dat *d,
+                  unsigned int    j)
+{
+  unsigned int  k, i, q;
+  int           e;
+  beam_bucket_t *b;
+  beam_state_t  *s;
+
+  b = d->buckets[BEAM_MULTI] + j;
+
+  for (k = 0; k < b->cap; k++) {
+    if ((i = b->keys[k])) {
+      s = b->states + k;
+
+      /* close the multibranch loop with (i,j) */
+      e = beam_e_ml_closing(d, i, j);
+      if (e != INF)
+        beam_relax(d,
+                   beam_target(d, BEAM_P, j, i),
+                   s,
+                   NULL,
+                   e,
+                   BEAM_MANNER_ML,
+                   0,
+                   0);
+
+      /* or leave [j:q-1] unpaired and try the next closing pair (i,q) */
+      q = beam_next_pair(d, i, j + 1);
+      if ((q) &&
+          (q - i <= d->span)) {
+        e = beam_e_ml_up(d, j, q - j);
+        if (e != INF)
+          beam_relax(d,
+                     beam_target(d, BEAM_MULTI, q, i),
+                     s,
+                     NULL,
+                     e,
+                     BEAM_MANNER_UNPAIRED,
+                     s->t1,
+                     s->t2);
+      }
+    }
+  }
+}
+
+
+PRIVATE void
+beam_expand_P(struct beam_dat *d,
+              unsigned int    j)
+{
+  unsigned int  k, l, i, p, q, u1, u2;
+  int           e;
+  beam_bucket_t *b, *bm;
+  beam_state_t  *s;
+
+  b = d->buckets[BEAM_P] + j;
+
+  for (k = 0; k < b->cap; k++) {
+    if (!(i = b->keys[k]))
+      continue;
+
+    s = b->states + k;
+
+    /* (i,j) enclosed by (p,q) in an internal loop */
+    for (p = i - 1; p > 0; p--) {
+      u1 = i - p - 1;
+      if ((u1 > MAXLOOP) ||
+          ((u1) && (!beam_hc_up(d->up_int, p + 1, u1))))
+        break;
+
+      for (q = beam_next_pair(d, p, j + 1); q; q = beam_next_pair(d, p, q + 1)) {
+        u2 = q - j - 1;
+        if ((u1 + u2 > MAXLOOP) ||
+            (q - p > d->span) ||
+            ((u2) && (!beam_hc_up(d->up_int, j + 1, u2))))
+          break;
+
+        e = beam_e_int(d, p, q, i, j);
+        if (e != INF)
+          beam_relax(d,
+                     beam_target(d, BEAM_P, q, p),
+                     s,
+                     NULL,
+                     e,
+                     BEAM_MANNER_INTERNAL,
+                     i,
+                     j);
+      }
+    }
+
+    /* (i,j) as stem in a multibranch loop */
+    e = beam_e_ml_stem(d, i, j);
+    if (e != INF) {
+      beam_relax(d,
+                 beam_target(d, BEAM_M, j, i),
+                 s,
+                 NULL,
+                 e,
+                 BEAM_MANNER_FROM_P,
+                 0,
+                 0);
+
+      bm = d->buckets[BEAM_M] + i - 1;
+      for (l = 0; l < bm->cap; l++)
+        if (bm->keys[l])
+          beam_relax(d,
+                     beam_target(d, BEAM_M2, j, bm->keys[l]),
+                     s,
+                     bm->states + l,
+                     e,
+                     BEAM_MANNER_SPLIT,
+                     i,
+                     0);
+    }
+
+    /* (i,j) as stem in the exterior loop */
+    e = beam_e_ext_stem(d, i, j);
+    if (e != INF)
+      beam_relax(d,
+                 d->C + j,
+                 s,
+                 d->C + i - 1,
+                 e,
+                 BEAM_MANNER_STEM,
+                 i,
+                 0);
+  }
+}
+
+
+PRIVATE void
+beam_expand_M2(struct beam_dat  *d,
+               unsigned int     j)
+{
+  unsigned int  k, i, p, q, u1;
+  int           e, e2;
+  beam_bucket_t *b;
+  beam_state_t  *s;
+
+  b = d->buckets[BEAM_M2] + j;
+
+  for (k = 0; k < b->cap; k++) {
+    if (!(i = b->keys[k]))
+      continue;
+
+    s = b->states + k;
+
+    beam_relax(d,
+               beam_target(d, BEAM_M, j, i),
+               s,
+               NULL,
+               0,
+               BEAM_MANNER_FROM_M2,
+               0,
+               0);
+
+    /* enclose [i:j] by a closing pair (p,q) with p < i and q > j */
+    for (p = i - 1; p > 0; p--) {
+      u1 = i - p - 1;
+      if ((u1 > MAXLOOP) ||
+          ((e = beam_e_ml_up(d, p + 1, u1)) == INF))
+        break;
+
+      q = beam_next_pair(d, p, j + 1);
+      if ((!q) ||
+          (q - p > d->span))
+        continue;
+
+      e2 = beam_e_ml_up(d, j + 1, q - j - 1);
+      if (e2 != INF)
+        beam_relax(d,
+                   beam_target(d, BEAM_MULTI, q, p),
+                   s,
+                   NULL,
+                   e + e2,
+                   BEAM_MANNER_NONE,
+                   i,
+                   j);
+    }
+  }
+}
+
+
+PRIVATE void
+beam_expand_M(struct beam_dat *d,
+              unsigned int    j)
+{
+  unsigned int  k;
+  int           e;
+  beam_bucket_t *b;
+
+  if (j == d->n)
+    return;
+
+  b = d->buckets[BEAM_M] + j;
+  e = beam_e_ml_up(d, j + 1, 1);
+
+  if (e == INF)
+    return;
+
+  for (k = 0; k < b->cap; k++)
+    if (b->keys[k])
+      beam_relax(d,
+                 beam_target(d, BEAM_M, j + 1, b->keys[k]),
+                 b->states + k,
+                 NULL,
+                 e,
+                 BEAM_MANNER_UNPAIRED,
+                 0,
+                 0);
+}
+
+
+PRIVATE void
+beam_expand_C(struct beam_dat *d,
+              unsigned int    j)
+{
+  int e;
+
+  if (j == d->n)
+    return;
+
+  e = beam_e_ext_up(d, j + 1, 1);
+  if (e != INF)
+    beam_relax(d,
+               d->C + j + 1,
+               d->C + j,
+               NULL,
+               e,
+               BEAM_MANNER_UNPAIRED,
+               0,
+               0);
+}
+
+
+BEAM_INTERNAL void
+beam_inside(struct beam_dat *d)
+{
+  unsigned int j, t;
+
+  d->C[0].v = 0.;
+  beam_expand_C(d, 0);
+
+  for (j = 1; j <= d->n; j++) {
+    beam_hairpin_next(d, j, j + d->min_loop + 1);
+
+    for (t = 0; t < BEAM_TYPES; t++) {
+      beam_prune(d, d->buckets[t] + j);
+
+      switch (t) {
+        case BEAM_H:
+          beam_expand_H(d, j);
+          break;
+        case BEAM_MULTI:
+          beam_expand_Multi(d, j);
+          break;
+        case BEAM_P:
+          beam_expand_P(d, j);
+          break;
+        case BEAM_M2:
+          beam_expand_M2(d, j);
+          break;
+        case BEAM_M:
+          beam_expand_M(d, j);
+          break;
+      }
+    }
+
+    beam_expand_C(d, j);
+  }
+}
+
+
+BEAM_INTERNAL void
+beam_outside(struct beam_dat *d)
+{
+  unsigned int j;
+
+  d->mode         = BEAM_MODE_OUTSIDE;
+  d->C[d->n].w    = 0.;
+
+  for (j = d->n; j > 0; j--) {
+    beam_expand_C(d, j);
+    beam_expand_M(d, j);
+    beam_expand_M2(d, j);
+    beam_expand_P(d, j);
+    beam_expand_Multi(d, j);
+    beam_expand_H(d, j);
+  }
+
+  beam_expand_C(d, 0);
+}
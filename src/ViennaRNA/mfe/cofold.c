@@ -167,10 +167,10 @@ wrap_cofold(const char    *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
-    free(P);
+    vrna_params_free(P);
   }
 
   /* handle hard constraints in pseudo dot-bracket format if passed via simple interface */
@@ -253,10 +253,10 @@ wrap_zukersubopt(const char   *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
-    free(P);
+    vrna_params_free(P);
   }
 
   if (backward_compat_compound)
@@ -363,7 +363,7 @@ update_cofold_params(void)
     v = backward_compat_compound;
 
     if (v->params)
-      free(v->params);
+      vrna_params_free(v->params);
 
     set_model_details(&md);
     v->params = vrna_params(&md);
@@ -380,7 +380,7 @@ update_cofold_params_par(vrna_param_t *parameters)
     v = backward_compat_compound;
 
     if (v->params)
-      free(v->params);
+      vrna_params_free(v->params);
 
     if (parameters) {
       v->params = vrna_params_copy(parameters);
@@ -192,10 +192,10 @@ wrap_fold(const char    *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(vc->params);
+    vrna_params_free(vc->params);
     vc->params = P;
   } else {
-    free(P);
+    vrna_params_free(P);
   }
 
   /* handle hard constraints in pseudo dot-bracket format if passed via simple interface */
@@ -70,6 +70,35 @@ vrna_mfe(vrna_fold_compound_t *fc,
          char                 *structure);
 
 
+/**
+ *  @brief Compute an approximate minimum free energy and secondary structure using beam search
+ *
+ *  This function implements a left-to-right beam search in the spirit of LinearFold.
+ *  For each sequence position and each type of partial structure (hairpin candidate,
+ *  base pair, multibranch loop segments, and multibranch loop candidate) only the
+ *  #vrna_fold_compound_t.beam_size best partial structures are kept. Time and memory
+ *  requirements of the recursions are therefore linear in the sequence length. The
+ *  energy parameters and hard constraints are the same as in vrna_mfe(), soft constraints
+ *  are limited to those added via vrna_sc_set_up() and vrna_sc_set_bp().
+ *
+ *  Usually, this function is not called directly. Instead, vrna_mfe() dispatches to it
+ *  whenever the #vrna_fold_compound_t was created with the #VRNA_OPTION_BEAM flag. If
+ *  the model settings can not be handled by the beam search, the default recursions of
+ *  vrna_mfe() are used instead.
+ *
+ *  @see  vrna_mfe(), #VRNA_OPTION_BEAM, vrna_pf_beam()
+ *
+ *  @param fc             fold compound
+ *  @param structure      A pointer to the character array where the
+ *                        secondary structure in dot-bracket notation will be written to (Maybe NULL)
+ *
+ *  @return the (approximate) minimum free energy (MFE) in kcal/mol
+ */
+float
+vrna_mfe_beam(vrna_fold_compound_t  *fc,
+              char                  *structure);
+
+
 /**
  *  @brief Compute the minimum free energy of two interacting RNA molecules
  *
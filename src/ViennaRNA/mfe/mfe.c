@@ -135,7 +135,7 @@ decompose_pair(vrna_fold_compound_t *fc,
 
 
 PRIVATE INLINE struct aux_arrays *
-get_aux_arrays(unsigned int length);
+get_aux_arrays(vrna_fold_compound_t *fc);
 
 
 PRIVATE INLINE void
@@ -220,6 +220,10 @@ vrna_mfe(vrna_fold_compound_t *fc,
   vrna_bps_t        bp;
   struct ms_helpers *ms_dat;
 
+  if ((fc) &&
+      (fc->engine & VRNA_OPTION_BEAM))
+    return vrna_mfe_beam(fc, structure);
+
   bt_stack  = vrna_bts_init(MAXSECTORS);
   bp        = NULL;
 
@@ -448,7 +452,7 @@ fill_arrays(vrna_fold_compound_t  *fc,
   sn          = fc->strand_number;
 
   /* allocate memory for all helper arrays */
-  helper_arrays = get_aux_arrays(length);
+  helper_arrays = get_aux_arrays(fc);
 
   /* pre-processing ligand binding production rule(s) */
   if (domains_up && domains_up->prod_cb)
@@ -4390,15 +4394,19 @@ decompose_pair(vrna_fold_compound_t *fc,
 
 
 PRIVATE INLINE struct aux_arrays *
-get_aux_arrays(unsigned int length)
+get_aux_arrays(vrna_fold_compound_t *fc)
 {
-  struct aux_arrays *aux = (struct aux_arrays *)vrna_alloc(sizeof(struct aux_arrays));
+  unsigned int      length  = fc->length;
+  struct aux_arrays *aux    = (struct aux_arrays *)vrna_alloc(sizeof(struct aux_arrays));
 
   aux->cc   = (int *)vrna_alloc(sizeof(int) * (length + 2));    /* auxilary arrays for canonical structures     */
   aux->cc1  = (int *)vrna_alloc(sizeof(int) * (length + 2));    /* auxilary arrays for canonical structures     */
 
   /* get fast multiloop decomposition helpers */
-  aux->ml_helpers = vrna_mfe_multibranch_fast_init(length);
+  if (fc->engine & VRNA_OPTION_SPARSE)
+    aux->ml_helpers = vrna_mfe_multibranch_sparse_init(fc);
+  else
+    aux->ml_helpers = vrna_mfe_multibranch_fast_init(length);
 
   return aux;
 }
@@ -0,0 +1,217 @@
+/*
+ *                Approximate minimum free energy prediction
+ *                using left-to-right beam search
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/datastructures/array.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/mfe/global.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/beam_dat.h"
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+#define BT_C  BEAM_TYPES  /* pseudo state type for exterior loop prefixes */
+
+struct beam_bt {
+  unsigned int  type;
+  unsigned int  i;
+  unsigned int  j;
+};
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE void
+backtrack(struct beam_dat *d,
+          char            *structure);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC float
+vrna_mfe_beam(vrna_fold_compound_t  *fc,
+              char                  *structure)
+{
+  float           mfe;
+  struct beam_dat *d;
+
+  mfe = (float)(INF / 100.);
+
+  if (fc) {
+    if (!beam_applicable(fc)) {
+      vrna_log_warning("vrna_mfe_beam: "
+                       "Beam search is not available for the current model settings, "
+                       "using default recursions instead");
+      fc->engine &= ~VRNA_OPTION_BEAM;
+      return vrna_mfe(fc, structure);
+    }
+
+    if (!beam_prepare(fc, VRNA_OPTION_MFE)) {
+      vrna_log_warning("vrna_mfe_beam: Failed to prepare vrna_fold_compound");
+      return mfe;
+    }
+
+    if (fc->stat_cb)
+      fc->stat_cb(fc, VRNA_STATUS_MFE_PRE, fc->auxdata);
+
+    d = beam_dat_init(fc, BEAM_MODE_MFE);
+
+    beam_inside(d);
+
+    if (d->C[d->n].v < (double)INF) {
+      mfe = (float)(d->C[d->n].v / 100.);
+
+      if ((structure) &&
+          (fc->params->model_details.backtrack))
+        backtrack(d, structure);
+    } else if (structure) {
+      memset(structure, '\0', sizeof(char) * (fc->length + 1));
+    }
+
+    beam_dat_free(d);
+
+    if (fc->stat_cb)
+      fc->stat_cb(fc, VRNA_STATUS_MFE_POST, fc->auxdata);
+  }
+
+  return mfe;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+backtrack(struct beam_dat *d,
+          char            *structure)
+{
+  unsigned int    n, i, j;
+  beam_state_t    *s, *m;
+  struct beam_bt  e;
+  vrna_array(struct beam_bt) stack;
+
+  n = d->n;
+
+  memset(structure, '.', sizeof(char) * n);
+  structure[n] = '\0';
+
+  vrna_array_init_size(stack, 64);
+
+  e.type  = BT_C;
+  e.i     = 0;
+  e.j     = n;
+  vrna_array_append(stack, e);
+
+  while (vrna_array_size(stack) > 0) {
+    e = stack[--vrna_array_size(stack)];
+    i = e.i;
+    j = e.j;
+
+    if (e.type == BT_C) {
+      if (j == 0)
+        continue;
+
+      s = d->C + j;
+      if (s->manner == BEAM_MANNER_STEM) {
+        e.type  = BEAM_P;
+        e.i     = s->t1;
+        vrna_array_append(stack, e);
+        e.type  = BT_C;
+        e.i     = 0;
+        e.j     = s->t1 - 1;
+        vrna_array_append(stack, e);
+      } else {
+        e.j = j - 1;
+        vrna_array_append(stack, e);
+      }
+
+      continue;
+    }
+
+    s = beam_bucket_get(d->buckets[e.type] + j, i);
+    if (!s) {
+      vrna_log_warning("vrna_mfe_beam: backtracking failed in state %u of [%u:%u]",
+                       e.type, i, j);
+      break;
+    }
+
+    switch (e.type) {
+      case BEAM_P:
+        structure[i - 1]  = '(';
+        structure[j - 1]  = ')';
+
+        if (s->manner == BEAM_MANNER_INTERNAL) {
+          e.i = s->t1;
+          e.j = s->t2;
+          vrna_array_append(stack, e);
+        } else if (s->manner == BEAM_MANNER_ML) {
+          m = beam_bucket_get(d->buckets[BEAM_MULTI] + j, i);
+          if (m) {
+            e.type  = BEAM_M2;
+            e.i     = m->t1;
+            e.j     = m->t2;
+            vrna_array_append(stack, e);
+          }
+        }
+
+        break;
+
+      case BEAM_M2:
+        e.type  = BEAM_P;
+        e.i     = s->t1;
+        vrna_array_append(stack, e);
+        e.type  = BEAM_M;
+        e.i     = i;
+        e.j     = s->t1 - 1;
+        vrna_array_append(stack, e);
+        break;
+
+      case BEAM_M:
+        if (s->manner == BEAM_MANNER_FROM_P)
+          e.type = BEAM_P;
+        else if (s->manner == BEAM_MANNER_FROM_M2)
+          e.type = BEAM_M2;
+        else
+          e.j = j - 1;
+
+        vrna_array_append(stack, e);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  vrna_array_free(stack);
+}
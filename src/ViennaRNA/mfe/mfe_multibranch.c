@@ -39,12 +39,22 @@
 
 #include "ViennaRNA/mfe/multibranch.h"
 
+struct ml_candidate {
+  unsigned int  p;  /* 5' end of the multibranch loop part */
+  int           e;  /* energy of the part, i.e. fML[p,j] */
+};
+
 struct vrna_mx_mfe_aux_ml_s {
   unsigned int  n;
   int           *Fmi;
   int           *DMLi;
   int           *DMLi1;
   int           *DMLi2;
+
+  /* data for the sparse decomposition, see vrna_mfe_multibranch_sparse_init() */
+  int                               *FM1i;  /* holds row i of the leftmost-stem energies */
+  vrna_array(struct ml_candidate)   *cand;  /* cand[j] holds all candidates p for parts [p,j] */
+  size_t                            cand_num;
 };
 
 
@@ -66,6 +76,27 @@ PRIVATE void
 free_aux_arrays(struct vrna_mx_mfe_aux_ml_s *aux);
 
 
+PRIVATE int
+sparse_applicable(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+mfe_multibranch_m2_sparse(unsigned int                i,
+                          unsigned int                j,
+                          struct vrna_mx_mfe_aux_ml_s *helpers);
+
+
+PRIVATE INLINE void
+sparse_candidates_update(vrna_fold_compound_t         *fc,
+                         unsigned int                 i,
+                         unsigned int                 j,
+                         int                          e,
+                         struct vrna_mx_mfe_aux_ml_s  *helpers,
+                         vrna_hc_eval_f               evaluate,
+                         struct hc_mb_def_dat         *hc_dat_local,
+                         struct sc_mb_dat             *sc_wrapper);
+
+
 PRIVATE int
 mfe_multibranch_m2_fast(vrna_fold_compound_t        *fc,
                         unsigned int                i,
@@ -146,6 +177,45 @@ vrna_mfe_multibranch_fast_init(unsigned int length)
 }
 
 
+PUBLIC struct vrna_mx_mfe_aux_ml_s *
+vrna_mfe_multibranch_sparse_init(vrna_fold_compound_t *fc)
+{
+  unsigned int                j;
+  struct vrna_mx_mfe_aux_ml_s *aux;
+
+  if (!fc)
+    return NULL;
+
+  aux = get_aux_arrays(fc->length);
+
+  if (sparse_applicable(fc)) {
+    aux->FM1i = (int *)vrna_alloc(sizeof(int) * (fc->length + 1));
+    aux->cand = (vrna_array(struct ml_candidate) *)vrna_alloc(
+      sizeof(vrna_array(struct ml_candidate)) * (fc->length + 1));
+
+    for (j = 0; j <= fc->length; j++) {
+      aux->FM1i[j] = INF;
+      vrna_array_init_size(aux->cand[j], 4);
+    }
+  } else {
+    vrna_log_debug("sparse multibranch loop decomposition not applicable, "
+                   "using default recursions");
+  }
+
+  return aux;
+}
+
+
+PUBLIC size_t
+vrna_mfe_multibranch_sparse_candidates(struct vrna_mx_mfe_aux_ml_s *aux)
+{
+  if ((aux) && (aux->cand))
+    return aux->cand_num;
+
+  return 0;
+}
+
+
 PUBLIC void
 vrna_mfe_multibranch_fast_rotate(struct vrna_mx_mfe_aux_ml_s *aux)
 {
@@ -276,6 +346,9 @@ get_aux_arrays(unsigned int length)
   aux->DMLi   = (int *)vrna_alloc(sizeof(int) * (length + 1));  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
   aux->DMLi1  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   aux->DMLi2  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+  aux->FM1i     = NULL;
+  aux->cand     = NULL;
+  aux->cand_num = 0;
 
   /* prefill helper arrays */
   for (j = 0; j <= length; j++)
@@ -298,16 +371,31 @@ rotate_aux_arrays(struct vrna_mx_mfe_aux_ml_s *aux)
 
   for (j = 1; j <= aux->n; j++)
     aux->Fmi[j] = aux->DMLi[j] = INF;
+
+  if (aux->FM1i)
+    for (j = 1; j <= aux->n; j++)
+      aux->FM1i[j] = INF;
 }
 
 
 PRIVATE void
 free_aux_arrays(struct vrna_mx_mfe_aux_ml_s *aux)
 {
+  unsigned int j;
+
   free(aux->Fmi);
   free(aux->DMLi);
   free(aux->DMLi1);
   free(aux->DMLi2);
+
+  if (aux->cand) {
+    for (j = 0; j <= aux->n; j++)
+      vrna_array_free(aux->cand[j]);
+
+    free(aux->cand);
+  }
+
+  free(aux->FM1i);
   free(aux);
 }
 
@@ -1176,6 +1264,9 @@ mfe_multibranch_m2_fast(vrna_fold_compound_t        *fc,
   dmli      = helpers->DMLi;
   decomp    = INF;
 
+  if (helpers->cand)
+    return mfe_multibranch_m2_sparse(i, j, helpers);
+
   init_sc_mb(fc, &sc_wrapper);
 
   /* modular decomposition -------------------------------*/
@@ -1620,12 +1711,208 @@ E_ml_stems_fast(vrna_fold_compound_t        *fc,
 
   fmi[j] = e;
 
+  if (helpers->cand)
+    sparse_candidates_update(fc, i, j, e, helpers, evaluate, &hc_dat_local, &sc_wrapper);
+
   free_sc_mb(&sc_wrapper);
 
   return e;
 }
 
 
+/*
+ *  The sparse multibranch loop decomposition follows the candidate list
+ *  approach of Wexler et al. 2007 and Backofen et al. 2011. In the split
+ *  fML[i,k] + fML[k+1,j] we only need to consider those k where the 3' part
+ *  [k+1,j] starts with a stem, i.e. where fML[k+1,j] equals the energy of
+ *  a part whose leftmost branch is delimited by k+1 (fM1-like). In all other
+ *  cases, k+1 either stays unpaired, or [k+1,j] decomposes further, and the
+ *  same energy is obtained by a split at some l > k.
+ *
+ *  This argument requires that unpaired nucleotides in multibranch loops
+ *  contribute independently of their context, and that splits are never
+ *  penalized. Thus, we restrict ourselves to single strands, dangles = 0 or 2,
+ *  and the absence of callback-based constraints or grammar extensions.
+ */
+PRIVATE int
+sparse_applicable(vrna_fold_compound_t *fc)
+{
+  unsigned int  s;
+  vrna_md_t     *md;
+
+  md = &(fc->params->model_details);
+
+  if ((fc->hc->type == VRNA_HC_WINDOW) ||
+      (fc->strands > 1) ||
+      ((md->dangles != 0) && (md->dangles != 2)) ||
+      (fc->hc->f) ||
+      ((fc->domains_up) && (fc->domains_up->energy_cb)))
+    return 0;
+
+  if ((fc->aux_grammar) &&
+      ((vrna_array_size(fc->aux_grammar->m) > 0) ||
+       (vrna_array_size(fc->aux_grammar->m2) > 0)))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      if ((fc->sc) && (fc->sc->f))
+        return 0;
+
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      if (fc->scs)
+        for (s = 0; s < fc->n_seq; s++)
+          if ((fc->scs[s]) && (fc->scs[s]->f))
+            return 0;
+
+      break;
+  }
+
+  return 1;
+}
+
+
+PRIVATE int
+mfe_multibranch_m2_sparse(unsigned int                i,
+                          unsigned int                j,
+                          struct vrna_mx_mfe_aux_ml_s *helpers)
+{
+  unsigned int        p;
+  int                 e, en, *fmi;
+  size_t              c, cnt;
+  struct ml_candidate *cand;
+
+  e     = INF;
+  fmi   = helpers->Fmi;
+  cand  = helpers->cand[j];
+  cnt   = vrna_array_size(cand);
+
+  /* candidates are stored in order of decreasing 5' ends */
+  for (c = 0; c < cnt; c++) {
+    p = cand[c].p;
+    if (p < i + 2)
+      break;
+
+    if ((p + 2 <= j) &&
+        (fmi[p - 1] != INF)) {
+      en  = fmi[p - 1] + cand[c].e;
+      e   = MIN2(e, en);
+    }
+  }
+
+  return e;
+}
+
+
+/*
+ *  Compute the energy of the multibranch loop part [i,j] whose leftmost
+ *  branch starts at i, and store (i, fML[i,j]) as candidate for all
+ *  later splits if this is how fML[i,j] is realized.
+ */
+PRIVATE INLINE void
+sparse_candidates_update(vrna_fold_compound_t         *fc,
+                         unsigned int                 i,
+                         unsigned int                 j,
+                         int                          e,
+                         struct vrna_mx_mfe_aux_ml_s  *helpers,
+                         vrna_hc_eval_f               evaluate,
+                         struct hc_mb_def_dat         *hc_dat_local,
+                         struct sc_mb_dat             *sc_wrapper)
+{
+  short               *S, **SS, **S5, **S3;
+  unsigned int        n_seq, s, type;
+  int                 ij, en, e1, *fm1i, *c;
+  vrna_param_t        *P;
+  vrna_md_t           *md;
+  struct ml_candidate cand;
+
+  vrna_smx_csr(int) * c_gq;
+
+  P     = fc->params;
+  md    = &(P->model_details);
+  n_seq = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
+  S     = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
+  SS    = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
+  S5    = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
+  S3    = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
+  c     = fc->matrices->c;
+  c_gq  = fc->matrices->c_gq;
+  ij    = fc->jindx[j] + i;
+  fm1i  = helpers->FM1i;
+  e1    = INF;
+
+  /* branch (i,j) */
+  if ((c[ij] != INF) &&
+      (evaluate(i, j, i, j, VRNA_DECOMP_ML_STEM, hc_dat_local))) {
+    en = c[ij];
+
+    switch (fc->type) {
+      case VRNA_FC_TYPE_SINGLE:
+        type = vrna_get_ptype(ij, fc->ptype);
+        if (md->dangles == 2)
+          en += vrna_E_multibranch_stem(type, (i == 1) ? S[fc->length] : S[i - 1], S[j + 1], P);
+        else
+          en += vrna_E_multibranch_stem(type, -1, -1, P);
+
+        break;
+
+      case VRNA_FC_TYPE_COMPARATIVE:
+        for (s = 0; s < n_seq; s++) {
+          type = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
+          if (md->dangles == 2)
+            en += vrna_E_multibranch_stem(type, S5[s][i], S3[s][j], P);
+          else
+            en += vrna_E_multibranch_stem(type, -1, -1, P);
+        }
+
+        break;
+    }
+
+    if (sc_wrapper->red_stem)
+      en += sc_wrapper->red_stem(i, j, i, j, sc_wrapper);
+
+    e1 = MIN2(e1, en);
+  }
+
+  /* G-quadruplex delimited by i and j */
+  if (md->gquad) {
+#ifndef VRNA_DISABLE_C11_FEATURES
+    en = vrna_smx_csr_get(c_gq, i, j, INF);
+#else
+    en = vrna_smx_csr_int_get(c_gq, i, j, INF);
+#endif
+    if (en != INF) {
+      en  += vrna_E_multibranch_stem(0, -1, -1, P) * n_seq;
+      e1  = MIN2(e1, en);
+    }
+  }
+
+  /* leftmost branch followed by unpaired nucleotide j */
+  if ((fm1i[j - 1] != INF) &&
+      (evaluate(i, j, i, j - 1, VRNA_DECOMP_ML_ML, hc_dat_local))) {
+    en = fm1i[j - 1] +
+         P->MLbase * n_seq;
+
+    if (sc_wrapper->red_ml)
+      en += sc_wrapper->red_ml(i, j, i, j - 1, sc_wrapper);
+
+    e1 = MIN2(e1, en);
+  }
+
+  fm1i[j] = e1;
+
+  if ((e1 != INF) &&
+      (e1 == e)) {
+    cand.p  = i;
+    cand.e  = e;
+    vrna_array_append(helpers->cand[j], cand);
+    helpers->cand_num++;
+  }
+}
+
+
 /*
  * ###########################################
  * # deprecated functions below              #
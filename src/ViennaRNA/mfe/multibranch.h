@@ -46,6 +46,35 @@ vrna_mx_mfe_aux_ml_t
 vrna_mfe_multibranch_fast_init(unsigned int length);
 
 
+/**
+ *  @brief  Prepare helper arrays for the sparsified multibranch loop decomposition
+ *
+ *  Same as vrna_mfe_multibranch_fast_init() but additionally sets up candidate
+ *  lists that restrict the split points of multibranch loop parts with at least
+ *  two branches to those where the 3' part starts with a stem. The resulting MFE
+ *  is identical to that of the default recursions. If the sparsification is not
+ *  applicable to @p fc, e.g. for odd dangle models, multiple strands, or callback
+ *  based constraints, the default decomposition is used instead.
+ *
+ *  @note The candidate lists are stored in addition to the (dense) @p fML and
+ *        @p fM1 matrices, i.e. the sparsification reduces the run time but not
+ *        the memory requirements.
+ *
+ *  @see #VRNA_OPTION_SPARSE, vrna_mfe_multibranch_sparse_candidates()
+ */
+vrna_mx_mfe_aux_ml_t
+vrna_mfe_multibranch_sparse_init(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Get the number of candidates stored so far in sparse helper arrays
+ *
+ *  @return The number of candidates, or 0 if @p aux does not use the sparse decomposition
+ */
+size_t
+vrna_mfe_multibranch_sparse_candidates(vrna_mx_mfe_aux_ml_t aux);
+
+
 void
 vrna_mfe_multibranch_fast_rotate(vrna_mx_mfe_aux_ml_t aux);
 
@@ -61,8 +61,8 @@ struct vrna_param_s {
   int           dangle5[NBPAIRS + 1][5];
   int           dangle3[NBPAIRS + 1][5];
   int           int11[NBPAIRS + 1][NBPAIRS + 1][5][5];
-  int           int21[NBPAIRS + 1][NBPAIRS + 1][5][5][5];
-  int           int22[NBPAIRS + 1][NBPAIRS + 1][5][5][5][5];
+  int           (*int21)[NBPAIRS + 1][5][5][5];     /**<  @brief  1x2 interior loop energies, shared between copies (see vrna_params_unshare()) */
+  int           (*int22)[NBPAIRS + 1][5][5][5][5];  /**<  @brief  2x2 interior loop energies, shared between copies (see vrna_params_unshare()) */
   int           ninio[5];
   double        lxc;
   int           MLbase;
@@ -116,8 +116,8 @@ struct vrna_exp_param_s {
   double        expdangle5[NBPAIRS + 1][5];
   double        expdangle3[NBPAIRS + 1][5];
   double        expint11[NBPAIRS + 1][NBPAIRS + 1][5][5];
-  double        expint21[NBPAIRS + 1][NBPAIRS + 1][5][5][5];
-  double        expint22[NBPAIRS + 1][NBPAIRS + 1][5][5][5][5];
+  double        (*expint21)[NBPAIRS + 1][5][5][5];    /**<  @brief  1x2 interior loop Boltzmann factors, shared between copies (see vrna_exp_params_unshare()) */
+  double        (*expint22)[NBPAIRS + 1][5][5][5][5]; /**<  @brief  2x2 interior loop Boltzmann factors, shared between copies (see vrna_exp_params_unshare()) */
   double        expninio[5][MAXLOOP + 1];
   double        lxc;
   double        expMLbase;
@@ -193,6 +193,38 @@ vrna_param_t *
 vrna_params_copy(vrna_param_t *par);
 
 
+/**
+ *  @brief  Release a free energy parameter data structure
+ *
+ *  The largest tables of a #vrna_param_t data structure, i.e. the 1x2 and 2x2 interior
+ *  loop energies, are reference counted and shared among all copies of the same set of
+ *  parameters. Thus, many fold compounds created with equivalent model details only
+ *  store them once. Use this function instead of @p free() to release parameter data
+ *  structures obtained from vrna_params() or vrna_params_copy().
+ *
+ *  @see vrna_params(), vrna_params_copy(), vrna_params_unshare()
+ *
+ *  @param  par   The free energy parameters to release (Maybe NULL)
+ */
+void
+vrna_params_free(vrna_param_t *par);
+
+
+/**
+ *  @brief  Obtain private copies of the shared tables of a free energy parameter data structure
+ *
+ *  The shared tables of a #vrna_param_t data structure are considered immutable. Call
+ *  this function before modifying any of them, such that other copies of the same
+ *  parameters remain unaffected (copy-on-write).
+ *
+ *  @see vrna_params_free(), vrna_params_copy()
+ *
+ *  @param  par   The free energy parameters that are about to be modified
+ */
+void
+vrna_params_unshare(vrna_param_t *par);
+
+
 /**
  *  @brief  Get a data structure containing prescaled free energy parameters
  *          already transformed to Boltzmann factors
@@ -252,6 +284,33 @@ vrna_exp_param_t *
 vrna_exp_params_copy(vrna_exp_param_t *par);
 
 
+/**
+ *  @brief  Release a Boltzmann factor data structure
+ *
+ *  Similar to vrna_params_free(), the 1x2 and 2x2 interior loop Boltzmann factors are
+ *  reference counted and shared among all copies of the same set of parameters. Use this
+ *  function instead of @p free() to release data structures obtained from vrna_exp_params(),
+ *  vrna_exp_params_comparative(), or vrna_exp_params_copy().
+ *
+ *  @see vrna_exp_params(), vrna_exp_params_copy(), vrna_exp_params_unshare()
+ *
+ *  @param  par   The Boltzmann factors to release (Maybe NULL)
+ */
+void
+vrna_exp_params_free(vrna_exp_param_t *par);
+
+
+/**
+ *  @brief  Obtain private copies of the shared tables of a Boltzmann factor data structure
+ *
+ *  @see vrna_params_unshare(), vrna_exp_params_free()
+ *
+ *  @param  par   The Boltzmann factors that are about to be modified
+ */
+void
+vrna_exp_params_unshare(vrna_exp_param_t *par);
+
+
 /**
  *  @brief  Update/Reset energy parameters data structure within a #vrna_fold_compound_t
  *
@@ -377,6 +436,85 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
                     unsigned int          options);
 
 
+/**
+ *  @brief  Store a binary snapshot of fully derived energy parameters and Boltzmann factors
+ *
+ *  This function computes the free energy parameters (see vrna_params()) and the
+ *  Boltzmann factors (see vrna_exp_params()) for the model details @p md and writes
+ *  them to a binary file. Loading the snapshot with vrna_params_snapshot_load()
+ *  makes them available to any subsequent call of vrna_params() and vrna_exp_params()
+ *  with matching model details without parsing a parameter file or re-computing any
+ *  of the temperature and salt dependent tables.
+ *
+ *  @note The snapshot is a plain memory image of the parameter data structures.
+ *        It can therefore only be used by the same version of RNAlib compiled for the
+ *        same platform, which is verified when loading the file. The snapshot also
+ *        stores a fingerprint of the currently loaded energy parameter set, such that
+ *        it is only accepted as long as the same parameter set is in use.
+ *
+ *  @see vrna_params_snapshot_load(), vrna_params_cache_clear()
+ *
+ *  @param  filename  The name of the snapshot file
+ *  @param  md        The model details the parameters are derived for (Maybe NULL)
+ *  @return           Non-zero on success, 0 otherwise
+ */
+int
+vrna_params_snapshot_save(const char  *filename,
+                          vrna_md_t   *md);
+
+
+/**
+ *  @brief  Load a binary snapshot of energy parameters and Boltzmann factors
+ *
+ *  This function loads a snapshot previously written by vrna_params_snapshot_save()
+ *  into the in-process parameter cache. Whenever vrna_params() or vrna_exp_params()
+ *  are called with model details that result in the same parameters as those of the
+ *  snapshot, the data is copied from the snapshot instead of being re-computed.
+ *  Model details that do not match the snapshot are handled as usual, i.e. using
+ *  the current energy parameter set.
+ *
+ *  Loading fails if the snapshot was derived from another energy parameter set than
+ *  the one currently in use, e.g. a snapshot saved with the default Turner 2004
+ *  parameters after a call to vrna_params_load_RNA_Andronescu2007().
+ *
+ *  Where possible, the file is mapped into memory copy-on-write, i.e. writable but
+ *  private to the process. Only the few pages that hold process specific pointers
+ *  and reference counters are copied, such that several processes loading the same
+ *  snapshot share the memory pages of its (unmodified) energy tables.
+ *
+ *  @note Loading another energy parameter set, e.g. via vrna_params_load(), removes
+ *        the snapshot from the cache again.
+ *
+ *  @warning  The snapshot file must not be modified or truncated while it is in use,
+ *            i.e. until it has been removed from the cache, e.g. by vrna_params_cache_clear(),
+ *            and all energy parameters obtained from it have been released.
+ *
+ *  @see vrna_params_snapshot_save(), vrna_params_cache_clear()
+ *
+ *  @param  filename  The name of the snapshot file
+ *  @return           Non-zero on success, 0 otherwise
+ */
+int
+vrna_params_snapshot_load(const char *filename);
+
+
+/**
+ *  @brief  Clear the in-process cache of energy parameters and Boltzmann factors
+ *
+ *  To avoid re-computing the energy parameters and Boltzmann factors for model
+ *  details that have been used before, vrna_params() and vrna_exp_params() keep
+ *  the most recently derived parameters in a small cache that is keyed by the
+ *  attributes of #vrna_md_t that affect them, e.g. temperature, dangle model,
+ *  and salt concentration. The cache is cleared automatically whenever a new
+ *  energy parameter set is loaded. Use this function to clear it manually, e.g.
+ *  after changing the energy parameter set by other means.
+ *
+ *  @see vrna_params(), vrna_exp_params(), vrna_params_snapshot_load()
+ */
+void
+vrna_params_cache_clear(void);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /**
@@ -21,6 +21,7 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/params/default.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/static/energy_parameter_sets.h"
 
@@ -495,6 +496,9 @@ set_parameters_from_string(char       **file_content,
       (!file_content[line_no]))
     return 0;
 
+  /* parameters derived from the previous data set are outdated now */
+  vrna_params_cache_clear();
+
   /* store file name of parameter data set */
   free(last_param_file);
   last_param_file = (name) ? strdup(name) : NULL;
@@ -11,14 +11,29 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <math.h>
 #include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
+
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/salt.h"
+#include "ViennaRNA/utils/log.h"
 
 /**
  *** \file ViennaRNA/params/basic.c
@@ -84,6 +99,107 @@
 
 #define saltT md->temperature+K0
 
+/* number of distinct model details whose parameters are kept in the cache */
+#define PARAMS_CACHE_SIZE         8
+
+#define PARAMS_SNAPSHOT_MAGIC     "VRNApsnp"
+#define PARAMS_SNAPSHOT_VERSION   3
+#define PARAMS_SNAPSHOT_ALIGN     64
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+
+/* memory of a loaded parameter snapshot */
+typedef struct {
+  void    *mem;
+  size_t  size;
+  int     mapped;     /* whether the snapshot is memory-mapped */
+  int     refcount;   /* number of shared tables still stored in mem */
+} params_snapshot_t;
+
+
+/* common header of reference counted parameter tables */
+typedef struct {
+  int               refcount;
+  params_snapshot_t *snapshot;  /* the snapshot that holds the tables, or NULL if allocated */
+} shared_tables_t;
+
+
+/* the large tables of vrna_param_t that are shared among copies */
+typedef struct {
+  shared_tables_t shared;
+  int             int21[NBPAIRS + 1][NBPAIRS + 1][5][5][5];
+  int             int22[NBPAIRS + 1][NBPAIRS + 1][5][5][5][5];
+} param_tables_t;
+
+
+/* the large tables of vrna_exp_param_t that are shared among copies */
+typedef struct {
+  shared_tables_t shared;
+  double          expint21[NBPAIRS + 1][NBPAIRS + 1][5][5][5];
+  double          expint22[NBPAIRS + 1][NBPAIRS + 1][5][5][5][5];
+} exp_param_tables_t;
+
+
+#define PARAM_TABLES(P)     ((P)->int21 ? \
+                             (param_tables_t *)((char *)((P)->int21) - \
+                                                offsetof(param_tables_t, int21)) : \
+                             NULL)
+
+#define EXP_PARAM_TABLES(P) ((P)->expint21 ? \
+                             (exp_param_tables_t *)((char *)((P)->expint21) - \
+                                                    offsetof(exp_param_tables_t, expint21)) : \
+                             NULL)
+
+
+/* the attributes of the model details that affect the derived parameters */
+typedef struct {
+  double  temperature;
+  double  betaScale;
+  double  salt;
+  int     pf_smooth;
+  int     dangles;
+  int     saltMLLower;
+  int     saltMLUpper;
+  int     saltDPXInit;
+  float   saltDPXInitFact;
+  float   helical_rise;
+  float   backbone_length;
+} params_key_t;
+
+
+typedef struct {
+  params_key_t      key;
+  uint64_t          hash;
+  vrna_param_t      *P;
+  vrna_exp_param_t  *exp_P;
+  int               in_snapshot;    /* whether P and exp_P are stored in a loaded snapshot */
+  unsigned int      last_used;
+} params_cache_entry_t;
+
+
+/* file header of binary parameter snapshots */
+typedef struct {
+  char      magic[8];
+  uint32_t  version;
+  uint32_t  size_header;
+  uint32_t  size_param;
+  uint32_t  size_exp_param;
+  uint32_t  size_md;
+  uint32_t  size_pointer;
+  char      lib_version[32];
+  uint64_t  hash;
+  uint64_t  fingerprint;        /* hash of the energy parameter set the snapshot was derived from */
+  uint64_t  offset_param;
+  uint64_t  offset_exp_param;
+  uint64_t  offset_tables;
+  uint64_t  offset_exp_tables;
+  uint64_t  size_total;
+} params_snapshot_header_t;
+
 /*
  #################################
  # PRIVATE VARIABLES             #
@@ -99,6 +215,14 @@ PRIVATE int               pf_id = -1;
 #pragma omp threadprivate(id, pf_id)
 #endif
 
+PRIVATE params_cache_entry_t  params_cache[PARAMS_CACHE_SIZE];
+PRIVATE unsigned int          params_cache_clock = 0;
+
+#if VRNA_WITH_PTHREADS
+/* semaphore to prevent concurrent access to the cache */
+PRIVATE pthread_mutex_t params_cache_mtx = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -124,6 +248,60 @@ PRIVATE void
 rescale_params(vrna_fold_compound_t *vc);
 
 
+PRIVATE vrna_param_t *
+get_params_cached(vrna_md_t *md);
+
+
+PRIVATE vrna_exp_param_t *
+get_exp_params_cached(vrna_md_t *md);
+
+
+PRIVATE void
+params_key(vrna_md_t    *md,
+           params_key_t *key,
+           uint64_t     *hash);
+
+
+PRIVATE uint64_t
+params_hash(uint64_t    hash,
+            const void  *data,
+            size_t      size);
+
+
+PRIVATE uint64_t
+params_fingerprint(void);
+
+
+PRIVATE params_cache_entry_t *
+params_cache_find(params_key_t  *key,
+                  uint64_t      hash);
+
+
+PRIVATE params_cache_entry_t *
+params_cache_slot(params_key_t  *key,
+                  uint64_t      hash);
+
+
+PRIVATE void
+params_cache_entry_free(params_cache_entry_t *entry);
+
+
+PRIVATE void
+tables_init(vrna_param_t *P);
+
+
+PRIVATE void
+exp_tables_init(vrna_exp_param_t *P);
+
+
+PRIVATE void
+tables_retain(shared_tables_t *tables);
+
+
+PRIVATE void
+tables_release(shared_tables_t *tables);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -133,11 +311,11 @@ PUBLIC vrna_param_t *
 vrna_params(vrna_md_t *md)
 {
   if (md) {
-    return get_scaled_params(md);
+    return get_params_cached(md);
   } else {
     vrna_md_t md;
     vrna_md_set_default(&md);
-    return get_scaled_params(&md);
+    return get_params_cached(&md);
   }
 }
 
@@ -146,11 +324,11 @@ PUBLIC vrna_exp_param_t *
 vrna_exp_params(vrna_md_t *md)
 {
   if (md) {
-    return get_scaled_exp_params(md, -1.);
+    return get_exp_params_cached(md);
   } else {
     vrna_md_t md;
     vrna_md_set_default(&md);
-    return get_scaled_exp_params(&md, -1.);
+    return get_exp_params_cached(&md);
   }
 }
 
@@ -177,12 +355,48 @@ vrna_params_copy(vrna_param_t *par)
   if (par) {
     copy = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
     memcpy(copy, par, sizeof(vrna_param_t));
+
+    /* the copy shares the large tables with the original */
+    if (PARAM_TABLES(par))
+      tables_retain(&(PARAM_TABLES(par)->shared));
   }
 
   return copy;
 }
 
 
+PUBLIC void
+vrna_params_free(vrna_param_t *par)
+{
+  if (par) {
+    if (PARAM_TABLES(par))
+      tables_release(&(PARAM_TABLES(par)->shared));
+
+    free(par);
+  }
+}
+
+
+PUBLIC void
+vrna_params_unshare(vrna_param_t *par)
+{
+  param_tables_t *tables, *old;
+
+  if ((par) &&
+      (old = PARAM_TABLES(par))) {
+    tables = (param_tables_t *)vrna_alloc(sizeof(param_tables_t));
+    memcpy(tables->int21, old->int21, sizeof(tables->int21));
+    memcpy(tables->int22, old->int22, sizeof(tables->int22));
+    tables->shared.refcount = 1;
+
+    par->int21  = tables->int21;
+    par->int22  = tables->int22;
+
+    tables_release(&(old->shared));
+  }
+}
+
+
 PUBLIC vrna_exp_param_t *
 vrna_exp_params_copy(vrna_exp_param_t *par)
 {
@@ -191,19 +405,54 @@ vrna_exp_params_copy(vrna_exp_param_t *par)
   if (par) {
     copy = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
     memcpy(copy, par, sizeof(vrna_exp_param_t));
+
+    if (EXP_PARAM_TABLES(par))
+      tables_retain(&(EXP_PARAM_TABLES(par)->shared));
   }
 
   return copy;
 }
 
 
+PUBLIC void
+vrna_exp_params_free(vrna_exp_param_t *par)
+{
+  if (par) {
+    if (EXP_PARAM_TABLES(par))
+      tables_release(&(EXP_PARAM_TABLES(par)->shared));
+
+    free(par);
+  }
+}
+
+
+PUBLIC void
+vrna_exp_params_unshare(vrna_exp_param_t *par)
+{
+  exp_param_tables_t *tables, *old;
+
+  if ((par) &&
+      (old = EXP_PARAM_TABLES(par))) {
+    tables = (exp_param_tables_t *)vrna_alloc(sizeof(exp_param_tables_t));
+    memcpy(tables->expint21, old->expint21, sizeof(tables->expint21));
+    memcpy(tables->expint22, old->expint22, sizeof(tables->expint22));
+    tables->shared.refcount = 1;
+
+    par->expint21 = tables->expint21;
+    par->expint22 = tables->expint22;
+
+    tables_release(&(old->shared));
+  }
+}
+
+
 PUBLIC void
 vrna_params_subst(vrna_fold_compound_t  *vc,
                   vrna_param_t          *parameters)
 {
   if (vc) {
     if (vc->params)
-      free(vc->params);
+      vrna_params_free(vc->params);
 
     if (parameters) {
       vc->params = vrna_params_copy(parameters);
@@ -233,12 +482,12 @@ vrna_params_reset(vrna_fold_compound_t  *vc,
 
       case VRNA_FC_TYPE_COMPARATIVE:
         if (vc->params)
-          free(vc->params);
+          vrna_params_free(vc->params);
 
         vc->params = vrna_params(md_p);
 
         if (vc->exp_params) {
-          free(vc->exp_params);
+          vrna_exp_params_free(vc->exp_params);
 
           vc->exp_params = vrna_exp_params(md_p);
         }
@@ -262,7 +511,7 @@ vrna_exp_params_reset(vrna_fold_compound_t  *vc,
 
       case VRNA_FC_TYPE_COMPARATIVE:
         if (vc->exp_params)
-          free(vc->exp_params);
+          vrna_exp_params_free(vc->exp_params);
 
         vc->exp_params = vrna_exp_params(md_p);
         break;
@@ -280,7 +529,7 @@ vrna_exp_params_subst(vrna_fold_compound_t  *vc,
 {
   if (vc) {
     if (vc->exp_params)
-      free(vc->exp_params);
+      vrna_exp_params_free(vc->exp_params);
 
     if (params) {
       vc->exp_params = vrna_exp_params_copy(params);
@@ -380,7 +629,7 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
       /* remove previous parameters if present and they differ from reference model */
       if (fc->exp_params) {
         if (memcmp(md_p, &(fc->exp_params->model_details), sizeof(vrna_md_t)) != 0) {
-          free(fc->exp_params);
+          vrna_exp_params_free(fc->exp_params);
           fc->exp_params = NULL;
         }
       }
@@ -394,6 +643,331 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC int
+vrna_params_snapshot_save(const char  *filename,
+                          vrna_md_t   *md)
+{
+  int                       ret;
+  unsigned int              i;
+  size_t                    pos, size[4];
+  uint64_t                  *offset[4];
+  void                      *data[4];
+  FILE                      *fp;
+  vrna_md_t                 md_default;
+  vrna_param_t              *P;
+  vrna_exp_param_t          *exp_P;
+  params_key_t              key;
+  params_snapshot_header_t  header;
+  char                      padding[PARAMS_SNAPSHOT_ALIGN];
+
+  if (!filename)
+    return 0;
+
+  if (!md) {
+    vrna_md_set_default(&md_default);
+    md = &md_default;
+  }
+
+  fp = fopen(filename, "wb");
+  if (!fp) {
+    vrna_log_warning("vrna_params_snapshot_save: Failed to open file \"%s\"", filename);
+    return 0;
+  }
+
+  P     = get_scaled_params(md);
+  exp_P = get_scaled_exp_params(md, -1.);
+
+  memset(&header, 0, sizeof(params_snapshot_header_t));
+  memset(padding, 0, sizeof(padding));
+  memcpy(header.magic, PARAMS_SNAPSHOT_MAGIC, 8);
+  strncpy(header.lib_version, VRNA_VERSION, 31);
+
+  header.version        = PARAMS_SNAPSHOT_VERSION;
+  header.size_header    = sizeof(params_snapshot_header_t);
+  header.size_param     = sizeof(vrna_param_t);
+  header.size_exp_param = sizeof(vrna_exp_param_t);
+  header.size_md        = sizeof(vrna_md_t);
+  header.size_pointer   = sizeof(void *);
+
+  /* the parameter data structures followed by their shared tables */
+  data[0]   = P;
+  size[0]   = sizeof(vrna_param_t);
+  offset[0] = &(header.offset_param);
+  data[1]   = exp_P;
+  size[1]   = sizeof(vrna_exp_param_t);
+  offset[1] = &(header.offset_exp_param);
+  data[2]   = PARAM_TABLES(P);
+  size[2]   = sizeof(param_tables_t);
+  offset[2] = &(header.offset_tables);
+  data[3]   = EXP_PARAM_TABLES(exp_P);
+  size[3]   = sizeof(exp_param_tables_t);
+  offset[3] = &(header.offset_exp_tables);
+
+  pos = sizeof(params_snapshot_header_t);
+  for (i = 0; i < 4; i++) {
+    pos         = PARAMS_SNAPSHOT_ALIGN * ((pos + PARAMS_SNAPSHOT_ALIGN - 1) / PARAMS_SNAPSHOT_ALIGN);
+    *offset[i]  = pos;
+    pos         += size[i];
+  }
+
+  header.size_total = pos;
+
+  params_key(md, &key, &(header.hash));
+  header.fingerprint = params_fingerprint();
+
+  ret = 1;
+  pos = sizeof(params_snapshot_header_t);
+
+  if (fwrite(&header, sizeof(params_snapshot_header_t), 1, fp) != 1)
+    ret = 0;
+
+  /*
+   *  the id and table pointers are meaningless outside the current process,
+   *  they are written as is and re-assigned when loading the snapshot
+   */
+  for (i = 0; (ret) && (i < 4); i++) {
+    if ((fwrite(padding, 1, *offset[i] - pos, fp) != *offset[i] - pos) ||
+        (fwrite(data[i], size[i], 1, fp) != 1))
+      ret = 0;
+
+    pos = *offset[i] + size[i];
+  }
+
+  if (!ret)
+    vrna_log_warning("vrna_params_snapshot_save: Failed to write to file \"%s\"", filename);
+
+  if (fclose(fp) != 0)
+    ret = 0;
+
+  vrna_params_free(P);
+  vrna_exp_params_free(exp_P);
+
+  return ret;
+}
+
+
+PUBLIC int
+vrna_params_snapshot_load(const char *filename)
+{
+  unsigned int              i;
+  size_t                    size;
+  uint64_t                  hash;
+  uint64_t                  offset[4], size_block[4];
+  void                      *mem;
+  FILE                      *fp;
+  vrna_param_t              *P;
+  vrna_exp_param_t          *exp_P;
+  param_tables_t            *tables;
+  exp_param_tables_t        *exp_tables;
+  params_key_t              key, key_exp;
+  params_cache_entry_t      *entry;
+  params_snapshot_header_t  *header;
+  params_snapshot_t         *snapshot;
+
+#ifndef _WIN32
+  int                       fd;
+  struct stat               st;
+#endif
+
+  if (!filename)
+    return 0;
+
+  snapshot = (params_snapshot_t *)vrna_alloc(sizeof(params_snapshot_t));
+  mem      = NULL;
+  size     = 0;
+
+#ifndef _WIN32
+  fd = open(filename, O_RDONLY);
+  if (fd == -1) {
+    vrna_log_warning("vrna_params_snapshot_load: Failed to open file \"%s\"", filename);
+    free(snapshot);
+    return 0;
+  }
+
+  if ((fstat(fd, &st) == 0) &&
+      (st.st_size > 0)) {
+    size = (size_t)st.st_size;
+    /*
+     *  map privately, such that only the pages with reference counters and
+     *  process specific pointers are copied, while the tables remain shared
+     */
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mem == MAP_FAILED)
+      mem = NULL;
+    else
+      snapshot->mapped = 1;
+  }
+
+  close(fd);
+#endif
+
+  if (!mem) {
+    /* fall back to reading the file into memory */
+    fp = fopen(filename, "rb");
+    if (!fp) {
+      vrna_log_warning("vrna_params_snapshot_load: Failed to open file \"%s\"", filename);
+      free(snapshot);
+      return 0;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    size = (size_t)ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    mem = vrna_alloc(MAX2(size, 1));
+
+    if (fread(mem, 1, size, fp) != size) {
+      vrna_log_warning("vrna_params_snapshot_load: Failed to read file \"%s\"", filename);
+      fclose(fp);
+      free(mem);
+      free(snapshot);
+      return 0;
+    }
+
+    fclose(fp);
+  }
+
+  snapshot->mem   = mem;
+  snapshot->size  = size;
+  header          = (params_snapshot_header_t *)mem;
+
+  if ((size < sizeof(params_snapshot_header_t)) ||
+      (memcmp(header->magic, PARAMS_SNAPSHOT_MAGIC, 8) != 0)) {
+    vrna_log_warning("vrna_params_snapshot_load: \"%s\" is not an energy parameter snapshot",
+                     filename);
+    goto snapshot_load_fail;
+  }
+
+  if ((header->version != PARAMS_SNAPSHOT_VERSION) ||
+      (header->size_header != sizeof(params_snapshot_header_t)) ||
+      (header->size_param != sizeof(vrna_param_t)) ||
+      (header->size_exp_param != sizeof(vrna_exp_param_t)) ||
+      (header->size_md != sizeof(vrna_md_t)) ||
+      (header->size_pointer != sizeof(void *)) ||
+      (strncmp(header->lib_version, VRNA_VERSION, 32) != 0)) {
+    vrna_log_warning("vrna_params_snapshot_load: "
+                     "Snapshot \"%s\" has been created by an incompatible version of RNAlib",
+                     filename);
+    goto snapshot_load_fail;
+  }
+
+  if (header->fingerprint != params_fingerprint()) {
+    vrna_log_warning("vrna_params_snapshot_load: "
+                     "Snapshot \"%s\" has been created for a different energy parameter set",
+                     filename);
+    goto snapshot_load_fail;
+  }
+
+  offset[0]     = header->offset_param;
+  size_block[0] = sizeof(vrna_param_t);
+  offset[1]     = header->offset_exp_param;
+  size_block[1] = sizeof(vrna_exp_param_t);
+  offset[2]     = header->offset_tables;
+  size_block[2] = sizeof(param_tables_t);
+  offset[3]     = header->offset_exp_tables;
+  size_block[3] = sizeof(exp_param_tables_t);
+
+  if (header->size_total > size) {
+    vrna_log_warning("vrna_params_snapshot_load: Snapshot \"%s\" is truncated", filename);
+    goto snapshot_load_fail;
+  }
+
+  for (i = 0; i < 4; i++)
+    if ((offset[i] < sizeof(params_snapshot_header_t)) ||
+        (offset[i] + size_block[i] > header->size_total) ||
+        (offset[i] % PARAMS_SNAPSHOT_ALIGN)) {
+      vrna_log_warning("vrna_params_snapshot_load: Snapshot \"%s\" is truncated", filename);
+      goto snapshot_load_fail;
+    }
+
+  P           = (vrna_param_t *)((char *)mem + offset[0]);
+  exp_P       = (vrna_exp_param_t *)((char *)mem + offset[1]);
+  tables      = (param_tables_t *)((char *)mem + offset[2]);
+  exp_tables  = (exp_param_tables_t *)((char *)mem + offset[3]);
+
+  params_key(&(P->model_details), &key, &hash);
+  params_key(&(exp_P->model_details), &key_exp, NULL);
+
+  if ((hash != header->hash) ||
+      (memcmp(&key, &key_exp, sizeof(params_key_t)) != 0)) {
+    vrna_log_warning("vrna_params_snapshot_load: Snapshot \"%s\" is corrupt", filename);
+    goto snapshot_load_fail;
+  }
+
+  /*
+   *  attach the tables to the parameter data structures, each of them is
+   *  referenced by the cache entry, and keeps the snapshot memory alive
+   */
+  P->id                       = 0;
+  P->int21                    = tables->int21;
+  P->int22                    = tables->int22;
+  exp_P->id                   = 0;
+  exp_P->expint21             = exp_tables->expint21;
+  exp_P->expint22             = exp_tables->expint22;
+  tables->shared.refcount     = 1;
+  tables->shared.snapshot     = snapshot;
+  exp_tables->shared.refcount = 1;
+  exp_tables->shared.snapshot = snapshot;
+  snapshot->refcount          = 2;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+  {
+    /* replace whatever is stored for these model details */
+    entry = params_cache_slot(&key, hash);
+    params_cache_entry_free(entry);
+
+    entry->key          = key;
+    entry->hash         = hash;
+    entry->last_used    = ++params_cache_clock;
+    entry->P            = P;
+    entry->exp_P        = exp_P;
+    entry->in_snapshot  = 1;
+  }
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&params_cache_mtx);
+#endif
+
+  return 1;
+
+snapshot_load_fail:
+
+#ifndef _WIN32
+  if (snapshot->mapped)
+    munmap(mem, size);
+  else
+#endif
+  free(mem);
+
+  free(snapshot);
+
+  return 0;
+}
+
+
+PUBLIC void
+vrna_params_cache_clear(void)
+{
+  unsigned int i;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+  {
+    for (i = 0; i < PARAMS_CACHE_SIZE; i++)
+      params_cache_entry_free(&(params_cache[i]));
+  }
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&params_cache_mtx);
+#endif
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -409,6 +983,7 @@ get_scaled_params(vrna_md_t *md)
   double saltStandard = VRNA_MODEL_DEFAULT_SALT;
 
   params = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
+  tables_init(params);
 
   memset(params->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
@@ -608,6 +1183,7 @@ get_scaled_exp_params(vrna_md_t *md,
   vrna_exp_param_t  *pf;
 
   pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+  exp_tables_init(pf);
 
   memset(pf->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
@@ -843,6 +1419,7 @@ get_exp_params_ali(vrna_md_t    *md,
   vrna_exp_param_t  *pf;
 
   pf                = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+  exp_tables_init(pf);
   pf->model_details = *md;
   pf->alpha         = md->betaScale;
   pf->temperature   = md->temperature;
@@ -1075,6 +1652,389 @@ get_exp_params_ali(vrna_md_t    *md,
 }
 
 
+PRIVATE vrna_param_t *
+get_params_cached(vrna_md_t *md)
+{
+  uint64_t              hash;
+  params_key_t          key;
+  params_cache_entry_t  *entry;
+  vrna_param_t          *P;
+
+  P = NULL;
+
+  params_key(md, &key, &hash);
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+  {
+    entry = params_cache_find(&key, hash);
+    if ((entry) &&
+        (entry->P))
+      P = vrna_params_copy(entry->P);
+  }
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&params_cache_mtx);
+#endif
+
+  if (P) {
+    P->model_details  = *md;
+    P->id             = ++id;
+  } else {
+    P = get_scaled_params(md);
+
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+    {
+      entry = params_cache_slot(&key, hash);
+      if (!entry->P)
+        entry->P = vrna_params_copy(P);
+    }
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_unlock(&params_cache_mtx);
+#endif
+  }
+
+  return P;
+}
+
+
+PRIVATE vrna_exp_param_t *
+get_exp_params_cached(vrna_md_t *md)
+{
+  uint64_t              hash;
+  params_key_t          key;
+  params_cache_entry_t  *entry;
+  vrna_exp_param_t      *exp_P;
+
+  exp_P = NULL;
+
+  params_key(md, &key, &hash);
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+  {
+    entry = params_cache_find(&key, hash);
+    if ((entry) &&
+        (entry->exp_P))
+      exp_P = vrna_exp_params_copy(entry->exp_P);
+  }
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&params_cache_mtx);
+#endif
+
+  if (exp_P) {
+    exp_P->model_details = *md;
+  } else {
+    exp_P = get_scaled_exp_params(md, -1.);
+
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_lock(&params_cache_mtx);
+#elif defined(_OPENMP)
+#pragma omp critical (vrna_params_cache)
+#endif
+    {
+      entry = params_cache_slot(&key, hash);
+      if (!entry->exp_P)
+        entry->exp_P = vrna_exp_params_copy(exp_P);
+    }
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_unlock(&params_cache_mtx);
+#endif
+  }
+
+  return exp_P;
+}
+
+
+PRIVATE void
+params_key(vrna_md_t    *md,
+           params_key_t *key,
+           uint64_t     *hash)
+{
+  /* clear padding bytes such that keys may be compared and hashed as a whole */
+  memset(key, 0, sizeof(params_key_t));
+
+  key->temperature      = md->temperature;
+  key->betaScale        = md->betaScale;
+  key->salt             = md->salt;
+  key->pf_smooth        = md->pf_smooth;
+  key->dangles          = (md->dangles) ? 1 : 0;
+  key->saltMLLower      = md->saltMLLower;
+  key->saltMLUpper      = md->saltMLUpper;
+  key->saltDPXInit      = md->saltDPXInit;
+  key->saltDPXInitFact  = md->saltDPXInitFact;
+  key->helical_rise     = md->helical_rise;
+  key->backbone_length  = md->backbone_length;
+
+  if (hash)
+    *hash = params_hash(14695981039346656037ULL, key, sizeof(params_key_t));
+}
+
+
+/* 64-bit FNV-1a */
+PRIVATE uint64_t
+params_hash(uint64_t    hash,
+            const void  *data,
+            size_t      size)
+{
+  size_t              i;
+  const unsigned char *c = (const unsigned char *)data;
+
+  for (i = 0; i < size; i++) {
+    hash  ^= c[i];
+    hash  *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+
+/* hash of the raw energy parameter set that all derived parameters depend on */
+PRIVATE uint64_t
+params_fingerprint(void)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+#define HASH_PARAM(x)   hash = params_hash(hash, &(x), sizeof(x))
+#define HASH_STRING(x)  hash = params_hash(hash, (x), strlen(x))
+
+  HASH_PARAM(lxc37);
+  HASH_PARAM(Tmeasure);
+  HASH_PARAM(stack37);
+  HASH_PARAM(stackdH);
+  HASH_PARAM(hairpin37);
+  HASH_PARAM(hairpindH);
+  HASH_PARAM(bulge37);
+  HASH_PARAM(bulgedH);
+  HASH_PARAM(internal_loop37);
+  HASH_PARAM(internal_loopdH);
+  HASH_PARAM(mismatchI37);
+  HASH_PARAM(mismatchIdH);
+  HASH_PARAM(mismatch1nI37);
+  HASH_PARAM(mismatch23I37);
+  HASH_PARAM(mismatch1nIdH);
+  HASH_PARAM(mismatch23IdH);
+  HASH_PARAM(mismatchH37);
+  HASH_PARAM(mismatchM37);
+  HASH_PARAM(mismatchHdH);
+  HASH_PARAM(mismatchMdH);
+  HASH_PARAM(mismatchExt37);
+  HASH_PARAM(mismatchExtdH);
+  HASH_PARAM(dangle5_37);
+  HASH_PARAM(dangle3_37);
+  HASH_PARAM(dangle3_dH);
+  HASH_PARAM(dangle5_dH);
+  HASH_PARAM(int11_37);
+  HASH_PARAM(int11_dH);
+  HASH_PARAM(int21_37);
+  HASH_PARAM(int21_dH);
+  HASH_PARAM(int22_37);
+  HASH_PARAM(int22_dH);
+  HASH_PARAM(ML_BASE37);
+  HASH_PARAM(ML_BASEdH);
+  HASH_PARAM(ML_closing37);
+  HASH_PARAM(ML_closingdH);
+  HASH_PARAM(ML_intern37);
+  HASH_PARAM(ML_interndH);
+  HASH_PARAM(TripleC37);
+  HASH_PARAM(TripleCdH);
+  HASH_PARAM(MultipleCA37);
+  HASH_PARAM(MultipleCAdH);
+  HASH_PARAM(MultipleCB37);
+  HASH_PARAM(MultipleCBdH);
+  HASH_PARAM(MAX_NINIO);
+  HASH_PARAM(ninio37);
+  HASH_PARAM(niniodH);
+  HASH_PARAM(TerminalAU37);
+  HASH_PARAM(TerminalAUdH);
+  HASH_PARAM(DuplexInit37);
+  HASH_PARAM(DuplexInitdH);
+  HASH_STRING(Tetraloops);
+  HASH_PARAM(Tetraloop37);
+  HASH_PARAM(TetraloopdH);
+  HASH_STRING(Triloops);
+  HASH_PARAM(Triloop37);
+  HASH_PARAM(TriloopdH);
+  HASH_STRING(Hexaloops);
+  HASH_PARAM(Hexaloop37);
+  HASH_PARAM(HexaloopdH);
+  HASH_PARAM(GQuadAlpha37);
+  HASH_PARAM(GQuadAlphadH);
+  HASH_PARAM(GQuadBeta37);
+  HASH_PARAM(GQuadBetadH);
+  HASH_PARAM(GQuadLayerMismatch37);
+  HASH_PARAM(GQuadLayerMismatchH);
+  HASH_PARAM(GQuadLayerMismatchMax);
+
+#undef HASH_PARAM
+#undef HASH_STRING
+
+  return hash;
+}
+
+
+PRIVATE params_cache_entry_t *
+params_cache_find(params_key_t  *key,
+                  uint64_t      hash)
+{
+  unsigned int i;
+
+  for (i = 0; i < PARAMS_CACHE_SIZE; i++)
+    if (((params_cache[i].P) || (params_cache[i].exp_P)) &&
+        (params_cache[i].hash == hash) &&
+        (memcmp(&(params_cache[i].key), key, sizeof(params_key_t)) == 0)) {
+      params_cache[i].last_used = ++params_cache_clock;
+      return &(params_cache[i]);
+    }
+
+  return NULL;
+}
+
+
+/*
+ *  Return the cache entry for key. A new entry replaces an unused one, or
+ *  the one that has not been used for the longest time
+ */
+PRIVATE params_cache_entry_t *
+params_cache_slot(params_key_t  *key,
+                  uint64_t      hash)
+{
+  unsigned int          i;
+  params_cache_entry_t  *entry;
+
+  entry = params_cache_find(key, hash);
+
+  if (!entry) {
+    entry = &(params_cache[0]);
+    for (i = 1; i < PARAMS_CACHE_SIZE; i++)
+      if (params_cache[i].last_used < entry->last_used)
+        entry = &(params_cache[i]);
+
+    params_cache_entry_free(entry);
+
+    entry->key        = *key;
+    entry->hash       = hash;
+    entry->last_used  = ++params_cache_clock;
+  }
+
+  return entry;
+}
+
+
+PRIVATE void
+params_cache_entry_free(params_cache_entry_t *entry)
+{
+  if (entry->in_snapshot) {
+    /* the data structures are part of the snapshot memory, only drop their tables */
+    if (entry->P)
+      tables_release(&(PARAM_TABLES(entry->P)->shared));
+
+    if (entry->exp_P)
+      tables_release(&(EXP_PARAM_TABLES(entry->exp_P)->shared));
+  } else {
+    vrna_params_free(entry->P);
+    vrna_exp_params_free(entry->exp_P);
+  }
+
+  memset(entry, 0, sizeof(params_cache_entry_t));
+}
+
+
+PRIVATE void
+tables_init(vrna_param_t *P)
+{
+  param_tables_t *tables;
+
+  tables                  = (param_tables_t *)vrna_alloc(sizeof(param_tables_t));
+  tables->shared.refcount = 1;
+  P->int21                = tables->int21;
+  P->int22                = tables->int22;
+}
+
+
+PRIVATE void
+exp_tables_init(vrna_exp_param_t *P)
+{
+  exp_param_tables_t *tables;
+
+  tables                  = (exp_param_tables_t *)vrna_alloc(sizeof(exp_param_tables_t));
+  tables->shared.refcount = 1;
+  P->expint21             = tables->expint21;
+  P->expint22             = tables->expint22;
+}
+
+
+PRIVATE void
+tables_retain(shared_tables_t *tables)
+{
+#ifdef __GNUC__
+  (void)__atomic_fetch_add(&(tables->refcount), 1, __ATOMIC_RELAXED);
+#else
+# ifdef _OPENMP
+#pragma omp critical (vrna_params_tables)
+# endif
+  tables->refcount++;
+#endif
+}
+
+
+PRIVATE void
+tables_release(shared_tables_t *tables)
+{
+  int               refs;
+  params_snapshot_t *snapshot;
+
+  snapshot = NULL;
+
+  /* tables stored in a snapshot keep the entire snapshot memory alive */
+#ifdef __GNUC__
+  refs = __atomic_fetch_sub(&(tables->refcount), 1, __ATOMIC_ACQ_REL) - 1;
+
+  if ((refs == 0) &&
+      (tables->snapshot) &&
+      (__atomic_fetch_sub(&(tables->snapshot->refcount), 1, __ATOMIC_ACQ_REL) == 1))
+    snapshot = tables->snapshot;
+
+#else
+# ifdef _OPENMP
+#pragma omp critical (vrna_params_tables)
+# endif
+  {
+    refs = --(tables->refcount);
+
+    if ((refs == 0) &&
+        (tables->snapshot) &&
+        (--(tables->snapshot->refcount) == 0))
+      snapshot = tables->snapshot;
+  }
+#endif
+
+  if (refs == 0) {
+    if (snapshot) {
+#ifndef _WIN32
+      if (snapshot->mapped)
+        munmap(snapshot->mem, snapshot->size);
+      else
+#endif
+      free(snapshot->mem);
+
+      free(snapshot);
+    } else if (!tables->snapshot) {
+      free(tables);
+    }
+  }
+}
+
+
 PRIVATE void
 rescale_params(vrna_fold_compound_t *vc)
 {
@@ -1193,24 +2153,26 @@ get_parameter_copy(vrna_param_t *par)
 PUBLIC vrna_param_t *
 copy_parameters(void)
 {
-  vrna_param_t *copy;
-
   if (p.id != id) {
     vrna_md_t md;
     set_model_details(&md);
     return vrna_params(&md);
-  } else {
-    copy = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
-    memcpy(copy, &p, sizeof(vrna_param_t));
   }
 
-  return copy;
+  return vrna_params_copy(&p);
 }
 
 
 PUBLIC vrna_param_t *
 set_parameters(vrna_param_t *dest)
 {
+  /* the static copy holds its own reference to the shared tables */
+  if (PARAM_TABLES(dest))
+    tables_retain(&(PARAM_TABLES(dest)->shared));
+
+  if (PARAM_TABLES(&p))
+    tables_release(&(PARAM_TABLES(&p)->shared));
+
   memcpy(&p, dest, sizeof(vrna_param_t));
   return &p;
 }
@@ -1227,18 +2189,23 @@ copy_pf_param(void)
     copy            = vrna_exp_params(&md);
     copy->pf_scale  = pf_scale;
     return copy;
-  } else {
-    copy = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
-    memcpy(copy, &pf, sizeof(vrna_exp_param_t));
   }
 
-  return copy;
+  return vrna_exp_params_copy(&pf);
 }
 
 
 PUBLIC vrna_exp_param_t *
 set_pf_param(vrna_param_t *dest)
 {
+  vrna_exp_param_t *exp_dest = (vrna_exp_param_t *)dest;
+
+  if (EXP_PARAM_TABLES(exp_dest))
+    tables_retain(&(EXP_PARAM_TABLES(exp_dest)->shared));
+
+  if (EXP_PARAM_TABLES(&pf))
+    tables_release(&(EXP_PARAM_TABLES(&pf)->shared));
+
   memcpy(&pf, dest, sizeof(vrna_exp_param_t));
   return &pf;
 }
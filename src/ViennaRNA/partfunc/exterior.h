@@ -61,6 +61,16 @@ void
 vrna_exp_E_ext_fast_free(vrna_mx_pf_aux_el_t aux_mx);
 
 
+const FLT_OR_DBL *
+vrna_exp_E_ext_fast_qq(vrna_mx_pf_aux_el_t aux_mx);
+
+
+void
+vrna_exp_E_ext_fast_restore(vrna_mx_pf_aux_el_t aux_mx,
+                            int                 i,
+                            FLT_OR_DBL          qq);
+
+
 FLT_OR_DBL
 vrna_exp_E_ext_fast(vrna_fold_compound_t  *fc,
                     int                   i,
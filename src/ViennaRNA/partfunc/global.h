@@ -113,6 +113,70 @@ vrna_pf(vrna_fold_compound_t  *fc,
         char                  *structure);
 
 
+/**
+ *  @brief  Update the partition function after soft constraints changed for a stretch of nucleotides
+ *
+ *  Re-computes only those parts of the partition function decomposition, i.e. the segments
+ *  @f$[k,l]@f$ that overlap the interval @f$[i,j]@f$, and re-uses the results of the previous
+ *  call to vrna_pf() or vrna_pf_update() for all other segments. This is useful whenever
+ *  soft constraints, e.g. via vrna_sc_add_up() or vrna_sc_add_bp(), are modified in a small
+ *  region only, as is the case for repellent or attractive sampling strategies. Base pair
+ *  probabilities are still computed for the entire sequence if the model's compute_bpp is set.
+ *
+ *  To allow for subsequent updates, the first call to this function computes the full
+ *  partition function and stores snapshots of all intermediate results in the
+ *  #vrna_fold_compound_t. Since these snapshots are only valid for the same energy parameters,
+ *  scaling factor, and hard constraints, any changes to them require a call to vrna_pf() first.
+ *  Changes of the scaling factor are detected automatically and lead to a full re-computation,
+ *  as do unstructured domains and auxiliary grammar extensions.
+ *
+ *  @note Soft constraint callbacks added with vrna_sc_add_exp_f() must only depend on the
+ *        positions they are evaluated for. Otherwise, use vrna_pf() instead.
+ *
+ *  @see  vrna_pf(), vrna_sc_add_up(), vrna_sc_add_bp()
+ *
+ *  @param[in,out]  fc              The fold compound data structure
+ *  @param[in,out]  structure       A pointer to the character array where position-wise pairing propensity
+ *                                  will be stored. (Maybe NULL)
+ *  @param          i               The first nucleotide with modified soft constraints
+ *  @param          j               The last nucleotide with modified soft constraints
+ *  @return         The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+FLT_OR_DBL
+vrna_pf_update(vrna_fold_compound_t *fc,
+               char                 *structure,
+               unsigned int         i,
+               unsigned int         j);
+
+
+/**
+ *  @brief Compute an approximate partition function and base pair probabilities using beam search
+ *
+ *  This is the partition function counterpart of vrna_mfe_beam() in the spirit of
+ *  LinearPartition. The inside pass only retains the #vrna_fold_compound_t.beam_size
+ *  partial structures with the highest Boltzmann weight per sequence position and state
+ *  type. If the model's compute_bpp is set, an outside pass over the retained states yields
+ *  base pair probabilities, which are stored as sparse list in #vrna_fold_compound_t.beam_probs.
+ *  The list is transparently used by vrna_plist_from_probs(), vrna_centroid(), vrna_MEA(),
+ *  vrna_mean_bp_distance(), vrna_pairing_tendency(), and vrna_pr_energy().
+ *
+ *  Usually, this function is not called directly. Instead, vrna_pf() dispatches to it
+ *  whenever the #vrna_fold_compound_t was created with the #VRNA_OPTION_BEAM flag. If
+ *  the model settings can not be handled by the beam search, the default recursions of
+ *  vrna_pf() are used instead.
+ *
+ *  @see  vrna_pf(), #VRNA_OPTION_BEAM, vrna_mfe_beam()
+ *
+ *  @param[in,out]  fc              The fold compound data structure
+ *  @param[in,out]  structure       A pointer to the character array where position-wise pairing propensity
+ *                                  will be stored. (Maybe NULL)
+ *  @return         The (approximate) ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+FLT_OR_DBL
+vrna_pf_beam(vrna_fold_compound_t *fc,
+             char                 *structure);
+
+
 /**
  *  @brief  Calculate partition function and base pair probabilities of
  *          nucleic acid/nucleic acid dimers
@@ -83,6 +83,17 @@ const FLT_OR_DBL *
 vrna_exp_E_ml_fast_qqm1(vrna_mx_pf_aux_ml_t aux_mx);
 
 
+const FLT_OR_DBL *
+vrna_exp_E_ml_fast_qqm2(vrna_mx_pf_aux_ml_t aux_mx);
+
+
+void
+vrna_exp_E_ml_fast_restore(vrna_mx_pf_aux_ml_t  aux_mx,
+                           int                  i,
+                           FLT_OR_DBL           qqm,
+                           FLT_OR_DBL           qqm2);
+
+
 FLT_OR_DBL
 vrna_exp_E_ml_fast(vrna_fold_compound_t *fc,
                    int                  i,
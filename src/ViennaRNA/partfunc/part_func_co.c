@@ -188,7 +188,7 @@ wrap_co_pf_fold(char              *sequence,
    *  default parameters but take care of re-setting it to (initialized)
    *  model details
    */
-  free(vc->exp_params);
+  vrna_exp_params_free(vc->exp_params);
   if (parameters) {
     vrna_md_copy(&(parameters->model_details), &(vc->params->model_details));
     vc->exp_params = vrna_exp_params_copy(parameters);
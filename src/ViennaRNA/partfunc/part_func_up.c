@@ -1311,7 +1311,7 @@ scale_stru_pf_params(unsigned int length)
    * and/or if temperature has changed*/
   if (init_temp != temperature) {
     if (Pf)
-      free(Pf);
+      vrna_exp_params_free(Pf);
 
     vrna_md_t md;
     set_model_details(&md);
@@ -64,8 +64,17 @@
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE FLT_OR_DBL
+pf_global(vrna_fold_compound_t  *fc,
+          char                  *structure,
+          unsigned int          from,
+          unsigned int          to);
+
+
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays(vrna_fold_compound_t  *fc,
+            unsigned int          from,
+            unsigned int          to);
 
 
 PRIVATE void
@@ -96,6 +105,129 @@ extract_dimer_props(vrna_fold_compound_t  *fc,
 PUBLIC FLT_OR_DBL
 vrna_pf(vrna_fold_compound_t  *fc,
         char                  *structure)
+{
+  return pf_global(fc, structure, 0, 0);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_pf_update(vrna_fold_compound_t *fc,
+               char                 *structure,
+               unsigned int         i,
+               unsigned int         j)
+{
+  if (fc) {
+    if (j < i) {
+      unsigned int t = j;
+      j = i;
+      i = t;
+    }
+
+    if (i < 1)
+      i = 1;
+
+    if (j > fc->length)
+      j = fc->length;
+
+    return pf_global(fc, structure, i, j);
+  }
+
+  return (FLT_OR_DBL)(INF / 100.);
+}
+
+
+PUBLIC vrna_dimer_pf_t
+vrna_pf_dimer(vrna_fold_compound_t  *fc,
+              char                  *structure)
+{
+  vrna_dimer_pf_t X;
+
+  X.F0AB = X.FAB = X.FcAB = X.FA = X.FB = 0.;
+
+  if (fc) {
+    (void)vrna_pf(fc, structure);
+
+    /* backward compatibility partition function and ensemble energy computation */
+    extract_dimer_props(fc,
+                        &(X.F0AB),
+                        &(X.FAB),
+                        &(X.FcAB),
+                        &(X.FA),
+                        &(X.FB));
+  }
+
+  return X;
+}
+
+
+PUBLIC int
+vrna_pf_float_precision(void)
+{
+  return sizeof(FLT_OR_DBL) == sizeof(float);
+}
+
+
+PUBLIC FLT_OR_DBL *
+vrna_pf_substrands(vrna_fold_compound_t *fc,
+                   size_t               complex_size)
+{
+  FLT_OR_DBL *Q_sub = NULL;
+
+  if ((fc) &&
+      (fc->strands >= complex_size) &&
+      (fc->exp_matrices) &&
+      (fc->exp_matrices->q)) {
+    unsigned int      *ss, *se, *so;
+    FLT_OR_DBL        Q;
+    vrna_exp_param_t  *params;
+    vrna_mx_pf_t      *matrices;
+
+    ss        = fc->strand_start;
+    se        = fc->strand_end;
+    so        = fc->strand_order;
+    params    = fc->exp_params;
+    matrices  = fc->exp_matrices;
+
+    Q_sub = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (fc->strands - complex_size + 1));
+
+    for (size_t i = 0; i < fc->strands - complex_size + 1; i++) {
+      size_t start, end;
+      start     = ss[so[i]];
+      end       = se[so[i + complex_size - 1]];
+      Q         = matrices->q[fc->iindx[start] - end];
+      Q_sub[i]  = (-log(Q) - (end - start + 1) * log(params->pf_scale)) *
+                  params->kT /
+                  1000.0;
+    }
+  }
+
+  return Q_sub;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_pf_add(FLT_OR_DBL  dG1,
+            FLT_OR_DBL  dG2,
+            double      kT)
+{
+  double  x1  = -(double)dG1 / kT;
+  double  x2  = -(double)dG2 / kT;
+  double  xs  = MAX2(x1, x2);
+
+  return -kT * (xs + log(exp(x1 - xs) + exp(x2 - xs)));
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE FLT_OR_DBL
+pf_global(vrna_fold_compound_t  *fc,
+          char                  *structure,
+          unsigned int          from,
+          unsigned int          to)
 {
   int               n;
   FLT_OR_DBL        Q, dG;
@@ -105,7 +237,15 @@ vrna_pf(vrna_fold_compound_t  *fc,
 
   dG = (FLT_OR_DBL)(INF / 100.);
 
+  if ((fc) &&
+      (fc->engine & VRNA_OPTION_BEAM))
+    return vrna_pf_beam(fc, structure);
+
   if (fc) {
+    /* discard probabilities of a previous beam search run */
+    free(fc->beam_probs);
+    fc->beam_probs = NULL;
+
     /* make sure, everything is set up properly to start partition function computations */
     if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
       vrna_log_warning("vrna_pf@part_func.c: Failed to prepare vrna_fold_compound");
@@ -143,7 +283,7 @@ vrna_pf(vrna_fold_compound_t  *fc,
           fc->aux_grammar->cbs_status[i](fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->datas[i]);
     }
 
-    if (!fill_arrays(fc)) {
+    if (!fill_arrays(fc, from, to)) {
 #ifdef SUN4
       standard_arithmetic();
 #elif defined(HP9)
@@ -231,98 +371,15 @@ vrna_pf(vrna_fold_compound_t  *fc,
 }
 
 
-PUBLIC vrna_dimer_pf_t
-vrna_pf_dimer(vrna_fold_compound_t  *fc,
-              char                  *structure)
-{
-  vrna_dimer_pf_t X;
-
-  X.F0AB = X.FAB = X.FcAB = X.FA = X.FB = 0.;
-
-  if (fc) {
-    (void)vrna_pf(fc, structure);
-
-    /* backward compatibility partition function and ensemble energy computation */
-    extract_dimer_props(fc,
-                        &(X.F0AB),
-                        &(X.FAB),
-                        &(X.FcAB),
-                        &(X.FA),
-                        &(X.FB));
-  }
-
-  return X;
-}
-
-
-PUBLIC int
-vrna_pf_float_precision(void)
-{
-  return sizeof(FLT_OR_DBL) == sizeof(float);
-}
-
-
-PUBLIC FLT_OR_DBL *
-vrna_pf_substrands(vrna_fold_compound_t *fc,
-                   size_t               complex_size)
-{
-  FLT_OR_DBL *Q_sub = NULL;
-
-  if ((fc) &&
-      (fc->strands >= complex_size) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->q)) {
-    unsigned int      *ss, *se, *so;
-    FLT_OR_DBL        Q;
-    vrna_exp_param_t  *params;
-    vrna_mx_pf_t      *matrices;
-
-    ss        = fc->strand_start;
-    se        = fc->strand_end;
-    so        = fc->strand_order;
-    params    = fc->exp_params;
-    matrices  = fc->exp_matrices;
-
-    Q_sub = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (fc->strands - complex_size + 1));
-
-    for (size_t i = 0; i < fc->strands - complex_size + 1; i++) {
-      size_t start, end;
-      start     = ss[so[i]];
-      end       = se[so[i + complex_size - 1]];
-      Q         = matrices->q[fc->iindx[start] - end];
-      Q_sub[i]  = (-log(Q) - (end - start + 1) * log(params->pf_scale)) *
-                  params->kT /
-                  1000.0;
-    }
-  }
-
-  return Q_sub;
-}
-
-
-PUBLIC FLT_OR_DBL
-vrna_pf_add(FLT_OR_DBL  dG1,
-            FLT_OR_DBL  dG2,
-            double      kT)
-{
-  double  x1  = -(double)dG1 / kT;
-  double  x2  = -(double)dG2 / kT;
-  double  xs  = MAX2(x1, x2);
-
-  return -kT * (xs + log(exp(x1 - xs) + exp(x2 - xs)));
-}
-
-
-/*
- #################################
- # STATIC helper functions below #
- #################################
- */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays(vrna_fold_compound_t  *fc,
+            unsigned int          from,
+            unsigned int          to)
 {
-  int                 n, i, j, k, ij, *my_iindx, *jindx, with_gquad, with_ud;
-  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *qm2, *q1k, *qln;
+  int                 n, i, j, k, ij, *my_iindx, *jindx, with_gquad, with_ud, incremental;
+  size_t              size;
+  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *qm2, *q1k, *qln, *snap_qq, *snap_qqm,
+                      *snap_qqm2;
   double              max_real;
   vrna_ud_t           *domains_up;
   vrna_md_t           *md;
@@ -355,6 +412,33 @@ fill_arrays(vrna_fold_compound_t *fc)
   if (with_ud && domains_up->exp_prod_cb)
     domains_up->exp_prod_cb(fc, domains_up->data);
 
+  /*
+   *  Incremental updates (from > 0) only re-compute segments [i, j] that
+   *  overlap the interval [from, to]. All other segments are taken from
+   *  the previous run, including the state of the auxiliary arrays for
+   *  exterior and multibranch loops which we keep as snapshots. Whenever
+   *  we can't guarantee that the snapshots are still valid, we silently
+   *  fall back to re-computing everything.
+   */
+  incremental = 0;
+
+  if (from > 0) {
+    if (!matrices->aux_qq) {
+      size                = sizeof(FLT_OR_DBL) * (((n + 1) * (n + 2)) / 2);
+      matrices->aux_qq    = (FLT_OR_DBL *)vrna_alloc(size);
+      matrices->aux_qqm   = (FLT_OR_DBL *)vrna_alloc(size);
+      matrices->aux_qqm2  = (FLT_OR_DBL *)vrna_alloc(size);
+    } else if ((!with_ud) &&
+               (!fc->aux_grammar) &&
+               (matrices->aux_pf_scale == pf_params->pf_scale)) {
+      incremental = 1;
+    }
+  }
+
+  snap_qq   = matrices->aux_qq;
+  snap_qqm  = matrices->aux_qqm;
+  snap_qqm2 = matrices->aux_qqm2;
+
   /* no G-Quadruplexes for comparative partition function (yet) */
   if (with_gquad) {
 #ifndef VRNA_DISABLE_C11_FEATURES
@@ -380,6 +464,14 @@ fill_arrays(vrna_fold_compound_t *fc)
     for (i = j - 1; i >= 1; i--) {
       ij = my_iindx[i] - j;
 
+      if ((incremental) &&
+          ((i > (int)to) || (j < (int)from))) {
+        /* segment [i, j] is unaffected by the changes, re-use previous results */
+        vrna_exp_E_ml_fast_restore(aux_mx_ml, i, snap_qqm[ij], snap_qqm2[ij]);
+        vrna_exp_E_ext_fast_restore(aux_mx_el, i, snap_qq[ij]);
+        continue;
+      }
+
       qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
 
       if (qm2)
@@ -413,6 +505,12 @@ fill_arrays(vrna_fold_compound_t *fc)
         }
       }
 
+      if (snap_qq) {
+        snap_qq[ij]   = vrna_exp_E_ext_fast_qq(aux_mx_el)[i];
+        snap_qqm[ij]  = vrna_exp_E_ml_fast_qqm(aux_mx_ml)[i];
+        snap_qqm2[ij] = vrna_exp_E_ml_fast_qqm2(aux_mx_ml)[i];
+      }
+
       if (q[ij] > Qmax) {
         Qmax = q[ij];
         if (Qmax > max_real / 10.)
@@ -426,6 +524,14 @@ fill_arrays(vrna_fold_compound_t *fc)
         vrna_exp_E_ml_fast_free(aux_mx_ml);
         vrna_exp_E_ext_fast_free(aux_mx_el);
 
+        /* snapshots are incomplete now */
+        free(matrices->aux_qq);
+        free(matrices->aux_qqm);
+        free(matrices->aux_qqm2);
+        matrices->aux_qq    = NULL;
+        matrices->aux_qqm   = NULL;
+        matrices->aux_qqm2  = NULL;
+
         return 0; /* failure */
       }
     }
@@ -435,6 +541,8 @@ fill_arrays(vrna_fold_compound_t *fc)
     vrna_exp_E_ml_fast_rotate(aux_mx_ml);
   }
 
+  matrices->aux_pf_scale = pf_params->pf_scale;
+
   /* prefill linear qln, q1k arrays */
   if (q1k && qln) {
     for (k = 1; k <= n; k++) {
@@ -0,0 +1,188 @@
+/*
+ *                Approximate partition function and base pair probabilities
+ *                using left-to-right beam search
+ *
+ *                Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/datastructures/basic.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/structures/problist.h"
+#include "ViennaRNA/structures/dotbracket.h"
+#include "ViennaRNA/partfunc/global.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/beam_dat.h"
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE vrna_ep_t *
+collect_probs(struct beam_dat *d);
+
+
+PRIVATE int
+sort_plist_by_pos(const void  *a,
+                  const void  *b);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC FLT_OR_DBL
+vrna_pf_beam(vrna_fold_compound_t *fc,
+             char                 *structure)
+{
+  char            *s;
+  double          logZ;
+  FLT_OR_DBL      dG;
+  struct beam_dat *d;
+
+  dG = (FLT_OR_DBL)(INF / 100.);
+
+  if (fc) {
+    free(fc->beam_probs);
+    fc->beam_probs = NULL;
+
+    if (!beam_applicable(fc)) {
+      vrna_log_warning("vrna_pf_beam: "
+                       "Beam search is not available for the current model settings, "
+                       "using default recursions instead");
+      fc->engine &= ~VRNA_OPTION_BEAM;
+      return vrna_pf(fc, structure);
+    }
+
+    if (!beam_prepare(fc, VRNA_OPTION_PF)) {
+      vrna_log_warning("vrna_pf_beam: Failed to prepare vrna_fold_compound");
+      return dG;
+    }
+
+    if (fc->stat_cb)
+      fc->stat_cb(fc, VRNA_STATUS_PF_PRE, fc->auxdata);
+
+    d = beam_dat_init(fc, BEAM_MODE_INSIDE);
+
+    beam_inside(d);
+
+    logZ = d->C[d->n].v;
+
+    if (logZ == -INFINITY) {
+      vrna_log_warning("vrna_pf_beam: no valid structure within the constraints");
+      beam_dat_free(d);
+      return dG;
+    }
+
+    dG = (FLT_OR_DBL)(-logZ * fc->exp_params->kT / 1000.);
+
+    fc->beam_energy = (double)dG;
+
+    if (fc->exp_params->model_details.compute_bpp) {
+      beam_outside(d);
+
+      fc->beam_probs = collect_probs(d);
+
+      if (structure) {
+        s = vrna_pairing_tendency(fc);
+        strncpy(structure, s, fc->length + 1);
+        free(s);
+      }
+    }
+
+    beam_dat_free(d);
+
+    if (fc->stat_cb)
+      fc->stat_cb(fc, VRNA_STATUS_PF_POST, fc->auxdata);
+  }
+
+  return dG;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE vrna_ep_t *
+collect_probs(struct beam_dat *d)
+{
+  unsigned int  j, k, num, size;
+  double        logZ, p;
+  beam_bucket_t *b;
+  vrna_ep_t     *pl;
+
+  logZ  = d->C[d->n].v;
+  size  = d->n + 1;
+  num   = 0;
+  pl    = (vrna_ep_t *)vrna_alloc(sizeof(vrna_ep_t) * size);
+
+  for (j = 1; j <= d->n; j++) {
+    b = d->buckets[BEAM_P] + j;
+
+    for (k = 0; k < b->cap; k++) {
+      if (!b->keys[k])
+        continue;
+
+      p = exp(b->states[k].v + b->states[k].w - logZ);
+      if (p <= 0.)
+        continue;
+
+      if (num + 1 >= size) {
+        size  *= 2;
+        pl    = (vrna_ep_t *)vrna_realloc(pl, sizeof(vrna_ep_t) * size);
+      }
+
+      pl[num].i       = b->keys[k];
+      pl[num].j       = j;
+      pl[num].p       = (float)MIN2(p, 1.);
+      pl[num++].type  = VRNA_PLIST_TYPE_BASEPAIR;
+    }
+  }
+
+  qsort(pl, num, sizeof(vrna_ep_t), sort_plist_by_pos);
+
+  pl[num].i     = pl[num].j = 0;
+  pl[num].p     = 0.;
+  pl[num].type  = 0;
+
+  return (vrna_ep_t *)vrna_realloc(pl, sizeof(vrna_ep_t) * (num + 1));
+}
+
+
+PRIVATE int
+sort_plist_by_pos(const void  *a,
+                  const void  *b)
+{
+  const vrna_ep_t *x, *y;
+
+  x = (const vrna_ep_t *)a;
+  y = (const vrna_ep_t *)b;
+
+  if (x->i != y->i)
+    return (x->i < y->i) ? -1 : 1;
+
+  if (x->j != y->j)
+    return (x->j < y->j) ? -1 : 1;
+
+  return 0;
+}
@@ -41,6 +41,8 @@ struct vrna_mx_pf_aux_el_s {
 
   int         qqu_size;
   FLT_OR_DBL  **qqu;
+
+  vrna_array(unsigned int)  nz; /* positions k > i with qq[k] > 0, i.e. candidate split points */
 };
 
 /*
@@ -132,6 +134,17 @@ vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc)
     aux_mx->qq1       = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
     aux_mx->qqu_size  = 0;
     aux_mx->qqu       = NULL;
+    aux_mx->nz        = NULL;
+
+    /*
+     *  for the sparse engine, we keep track of all non-zero entries in qq,
+     *  i.e. exterior loop parts [k,j] that start with a stem. Only those
+     *  need to be considered as split points in subsequent decompositions
+     */
+    if ((fc->engine & VRNA_OPTION_SPARSE) &&
+        (fc->hc->type != VRNA_HC_WINDOW)) {
+      vrna_array_init_size(aux_mx->nz, n + 1);
+    }
 
     /* pre-processing ligand binding production rule(s) and auxiliary memory */
     if (with_ud) {
@@ -208,6 +221,10 @@ vrna_exp_E_ext_fast_rotate(struct vrna_mx_pf_aux_el_s *aux_mx)
     aux_mx->qq1 = aux_mx->qq;
     aux_mx->qq  = tmp;
 
+    /* candidate split points are only valid for the current 3' end */
+    if (aux_mx->nz)
+      vrna_array_size(aux_mx->nz) = 0;
+
     /* rotate auxiliary arrays for unstructured domains */
     if (aux_mx->qqu) {
       tmp = aux_mx->qqu[aux_mx->qqu_size];
@@ -235,11 +252,44 @@ vrna_exp_E_ext_fast_free(struct vrna_mx_pf_aux_el_s *aux_mx)
       free(aux_mx->qqu);
     }
 
+    vrna_array_free(aux_mx->nz);
+
     free(aux_mx);
   }
 }
 
 
+PUBLIC const FLT_OR_DBL *
+vrna_exp_E_ext_fast_qq(struct vrna_mx_pf_aux_el_s *aux_mx)
+{
+  if (aux_mx)
+    return (const FLT_OR_DBL *)aux_mx->qq;
+
+  return NULL;
+}
+
+
+PUBLIC void
+vrna_exp_E_ext_fast_restore(struct vrna_mx_pf_aux_el_s  *aux_mx,
+                            int                         i,
+                            FLT_OR_DBL                  qq)
+{
+  /*
+   *  re-use the contribution of a segment [i, j] that has been computed
+   *  before instead of calling vrna_exp_E_ext_fast(), e.g. for
+   *  incremental updates. This leaves the auxiliary arrays in exactly the
+   *  same state as if the segment had been decomposed again
+   */
+  if (aux_mx) {
+    aux_mx->qq[i] = qq;
+
+    if ((aux_mx->nz) &&
+        (qq != 0.))
+      vrna_array_append(aux_mx->nz, (unsigned int)i);
+  }
+}
+
+
 PUBLIC FLT_OR_DBL
 vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
                     int                         i,
@@ -484,6 +534,7 @@ split_ext_fast(vrna_fold_compound_t       *fc,
 {
   unsigned int      k;
   int               *idx, ij1;
+  size_t            pos;
   FLT_OR_DBL        qbt, *q, *qq, *qqq;
   sc_ext_exp_split  sc_split;
 
@@ -530,38 +581,48 @@ split_ext_fast(vrna_fold_compound_t       *fc,
   ij1 = factor * ((int)j - 1);
 
   /* do actual decomposition (skip hard constraint checks if we use default settings) */
-#if SPEEDUP_HC
-  /*
-   *  checking whether we actually are provided with hard constraints and
-   *  otherwise not evaluating the default ones within the loop drastically
-   *  increases speed. However, once we check for the split point between
-   *  strands in hard constraints, we have to think of something else...
-   */
-  if ((evaluate == &hc_ext_cb_def) || (evaluate == &hc_ext_cb_def_window)) {
-    for (k = j; k > i; k--) {
-      qbt += q[ij1] *
-             qqq[k];
-      ij1 -= factor;
+  if (aux_mx->nz) {
+    /* only visit candidate positions k, i.e. where qq[k] > 0 */
+    for (pos = 0; pos < vrna_array_size(aux_mx->nz); pos++) {
+      k = aux_mx->nz[pos];
+      if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local))
+        qbt += q[factor * ((int)k - 1)] *
+               qqq[k];
     }
   } else {
-    for (k = j; k > i; k--) {
-      if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local))
+#if SPEEDUP_HC
+    /*
+     *  checking whether we actually are provided with hard constraints and
+     *  otherwise not evaluating the default ones within the loop drastically
+     *  increases speed. However, once we check for the split point between
+     *  strands in hard constraints, we have to think of something else...
+     */
+    if ((evaluate == &hc_ext_cb_def) || (evaluate == &hc_ext_cb_def_window)) {
+      for (k = j; k > i; k--) {
         qbt += q[ij1] *
                qqq[k];
+        ij1 -= factor;
+      }
+    } else {
+      for (k = j; k > i; k--) {
+        if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local))
+          qbt += q[ij1] *
+                 qqq[k];
 
-      ij1 -= factor;
+        ij1 -= factor;
+      }
     }
-  }
 
 #else
-  for (k = j; k > i; k--) {
-    if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local))
-      qbt += q[ij1] *
-             qqq[k];
+    for (k = j; k > i; k--) {
+      if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local))
+        qbt += q[ij1] *
+               qqq[k];
 
-    ij1 -= factor;
-  }
+      ij1 -= factor;
+    }
 #endif
+  }
 
   if (qqq != qq) {
     qqq += i;
@@ -634,6 +695,11 @@ exp_E_ext_fast(vrna_fold_compound_t       *fc,
 
   qbt1 += split_ext_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
 
+  /* register [i,j] as candidate for all subsequent splits with 3' end j */
+  if ((aux_mx->nz) &&
+      (qq[i] != 0.))
+    vrna_array_append(aux_mx->nz, i);
+
   /* apply auxiliary grammar rule for exterior loop case */
   if (fc->aux_grammar) {
     for (size_t c = 0; c < vrna_array_size(fc->aux_grammar->exp_f); c++) {
@@ -39,6 +39,8 @@ struct vrna_mx_pf_aux_ml_s {
 
   unsigned int  qqmu_size;
   FLT_OR_DBL    **qqmu;
+
+  vrna_array(unsigned int)  nz; /* positions k > i with qqm[k] > 0, i.e. candidate split points */
 };
 
 
@@ -162,6 +164,17 @@ vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc)
     aux_mx->qqm21     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
     aux_mx->qqmu_size = 0;
     aux_mx->qqmu      = NULL;
+    aux_mx->nz        = NULL;
+
+    /*
+     *  for the sparse engine, we keep track of all non-zero entries in qqm,
+     *  i.e. multibranch loop parts [k,j] that start with a stem. Only those
+     *  need to be considered as split points in subsequent decompositions
+     */
+    if ((fc->engine & VRNA_OPTION_SPARSE) &&
+        (fc->hc->type != VRNA_HC_WINDOW)) {
+      vrna_array_init_size(aux_mx->nz, n + 1);
+    }
 
     if (fc->type == VRNA_FC_TYPE_SINGLE) {
       vrna_ud_t     *domains_up = fc->domains_up;
@@ -232,6 +245,10 @@ vrna_exp_E_ml_fast_rotate(struct vrna_mx_pf_aux_ml_s *aux_mx)
     aux_mx->qqm21 = aux_mx->qqm2;
     aux_mx->qqm2  = tmp;
 
+    /* candidate split points are only valid for the current 3' end */
+    if (aux_mx->nz)
+      vrna_array_size(aux_mx->nz) = 0;
+
     /* rotate auxiliary arrays for unstructured domains */
     if (aux_mx->qqmu) {
       tmp = aux_mx->qqmu[aux_mx->qqmu_size];
@@ -261,6 +278,8 @@ vrna_exp_E_ml_fast_free(struct vrna_mx_pf_aux_ml_s *aux_mx)
       free(aux_mx->qqmu);
     }
 
+    vrna_array_free(aux_mx->nz);
+
     free(aux_mx);
   }
 }
@@ -286,6 +305,34 @@ vrna_exp_E_ml_fast_qqm1(struct vrna_mx_pf_aux_ml_s *aux_mx)
 }
 
 
+PUBLIC const FLT_OR_DBL *
+vrna_exp_E_ml_fast_qqm2(struct vrna_mx_pf_aux_ml_s *aux_mx)
+{
+  if (aux_mx)
+    return (const FLT_OR_DBL *)aux_mx->qqm2;
+
+  return NULL;
+}
+
+
+PUBLIC void
+vrna_exp_E_ml_fast_restore(struct vrna_mx_pf_aux_ml_s *aux_mx,
+                           int                        i,
+                           FLT_OR_DBL                 qqm,
+                           FLT_OR_DBL                 qqm2)
+{
+  /* counterpart of vrna_exp_E_ext_fast_restore() for multibranch loops */
+  if (aux_mx) {
+    aux_mx->qqm[i]  = qqm;
+    aux_mx->qqm2[i] = qqm2;
+
+    if ((aux_mx->nz) &&
+        (qqm != 0.))
+      vrna_array_append(aux_mx->nz, (unsigned int)i);
+  }
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -453,6 +500,7 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   unsigned char             sliding_window;
   unsigned int              k, maxk, *sn, *se, with_ud, *hc_up_ml, ii;
   int                       *iidx;
+  size_t                    pos;
   FLT_OR_DBL                temp, *qm2, *qqm, *qqm2, *expMLbase;
   vrna_ud_t                 *domains_up;
   vrna_hc_t                 *hc;
@@ -510,9 +558,22 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   ii = maxk - i; /* length of unpaired stretch */
 
   /* finally, decompose segment */
-  for (k = maxk; k > i; k--, ii--)
-    temp += expMLbase[ii] *
-            qqm_tmp[k];
+  if (aux_mx->nz) {
+    /* only visit candidate positions k, i.e. where qqm[k] > 0 */
+    for (pos = 0; pos < vrna_array_size(aux_mx->nz); pos++) {
+      k = aux_mx->nz[pos];
+      if (k <= i)
+        break;
+
+      if (k <= maxk)
+        temp += expMLbase[k - i] *
+                qqm_tmp[k];
+    }
+  } else {
+    for (k = maxk; k > i; k--, ii--)
+      temp += expMLbase[ii] *
+              qqm_tmp[k];
+  }
 
   if (with_ud) {
     ii = maxk - i; /* length of unpaired stretch */
@@ -556,6 +617,7 @@ exp_E_m2_fast(vrna_fold_compound_t        *fc,
   unsigned int              n, k, *sn, *ss, n_seq, s, with_ud,
                             u, circular, with_gquad, type;
   int                       *iidx, ij, kl;
+  size_t                    pos;
   FLT_OR_DBL                qbt1, temp, *qm, *qb, *qqm, *qqm1, **qqmu, q_temp, q_temp2,
                             *expMLbase, **qb_local, **qm_local, **G_local;
   vrna_md_t                 *md;
@@ -710,6 +772,14 @@ exp_E_m2_fast(vrna_fold_compound_t        *fc,
     for (; k > i; k--)
       temp += qm_local[i][k - 1] *
               qqm_tmp[k];
+  } else if (aux_mx->nz) {
+    /* only visit candidate positions k, and skip splits between strands */
+    for (pos = 0; pos < vrna_array_size(aux_mx->nz); pos++) {
+      k = aux_mx->nz[pos];
+      if (sn[k] == sn[k - 1])
+        temp += qm[iidx[i] - k + 1] *
+                qqm_tmp[k];
+    }
   } else {
     kl = iidx[i] - j + 1; /* ii-k=[i,k-1] */
 
@@ -733,6 +803,11 @@ exp_E_m2_fast(vrna_fold_compound_t        *fc,
     free(qqm_tmp);
   }
 
+  /* register [i,j] as candidate for all subsequent splits with 3' end j */
+  if ((aux_mx->nz) &&
+      (qqm[i] != 0.))
+    vrna_array_append(aux_mx->nz, i);
+
   /* apply auxiliary grammar rule for multibranch loop case */
   if (fc->aux_grammar) {
     for (size_t c = 0; c < vrna_array_size(fc->aux_grammar->exp_m2); c++) {
@@ -146,6 +146,201 @@ evaluate_perturbation_vector_score(vrna_fold_compound_t *vc,
 }
 
 
+/*
+ *  compute the probabilities to be unpaired under the perturbation
+ *  epsilon + step * direction. The Boltzmann factors must already be
+ *  scaled appropriately. Returns the ensemble free energy
+ */
+static double
+perturbed_probability_unpaired(vrna_fold_compound_t *vc,
+                               const double         *epsilon,
+                               const double         *direction,
+                               double               step,
+                               double               *probability)
+{
+  int     i, j, length;
+  double  kT, G, *e;
+
+  length  = vc->length;
+  kT      = vc->exp_params->kT;
+  e       = vrna_alloc(sizeof(double) * (length + 1));
+
+  for (i = 1; i <= length; ++i) {
+    e[i] = (epsilon) ? epsilon[i] : 0.;
+    if (direction)
+      e[i] += step * direction[i];
+  }
+
+  addSoftConstraint(vc, e, length);
+
+  vc->params->model_details.compute_bpp     = 1;
+  vc->exp_params->model_details.compute_bpp = 1;
+
+  /*
+   *  soft constraints are stored in units of 10cal/mol which is too coarse
+   *  for numerical derivatives. So we replace the Boltzmann factors with
+   *  the exact ones once they have been prepared
+   */
+  vrna_sc_prepare(vc, VRNA_OPTION_PF);
+
+  if ((vc->sc) &&
+      (vc->sc->exp_energy_up)) {
+    for (i = 1; i <= length; ++i) {
+      vc->sc->exp_energy_up[i][0] = 1.;
+      for (j = 1; j <= length - i + 1; ++j)
+        vc->sc->exp_energy_up[i][j] = vc->sc->exp_energy_up[i][j - 1] *
+                                      (FLT_OR_DBL)exp(-e[i + j - 1] * 1000. / kT);
+    }
+  }
+
+  G = (double)vrna_pf(vc, NULL);
+
+  calculate_probability_unpaired(vc, probability);
+
+  free(e);
+
+  return G;
+}
+
+
+/*
+ *  directional derivative of the probabilities to be unpaired, i.e.
+ *
+ *  derivative[i] = sum_mu d p_i / d epsilon_mu * direction[mu]
+ *
+ *  by central differences. Since d p_i / d epsilon_mu is the (symmetric)
+ *  Hessian of the ensemble free energy, this equals the sums over the
+ *  conditional probabilities otherwise obtained from n restricted
+ *  partition functions, but only requires two additional ones
+ */
+static void
+directional_derivative_unpaired(vrna_fold_compound_t  *vc,
+                                const double          *epsilon,
+                                const double          *direction,
+                                double                *derivative)
+{
+  int     i, length;
+  double  step, norm, *p_plus, *p_minus;
+
+  length  = vc->length;
+  norm    = 0.;
+
+  for (i = 1; i <= length; ++i)
+    if (fabs(direction[i]) > norm)
+      norm = fabs(direction[i]);
+
+  if (norm == 0.) {
+    for (i = 0; i <= length; ++i)
+      derivative[i] = 0.;
+
+    return;
+  }
+
+  /* perturb each nucleotide by at most 1e-3 kcal/mol */
+  step    = 1e-3 / norm;
+  p_plus  = vrna_alloc(sizeof(double) * (length + 1));
+  p_minus = vrna_alloc(sizeof(double) * (length + 1));
+
+  perturbed_probability_unpaired(vc, epsilon, direction, step, p_plus);
+  perturbed_probability_unpaired(vc, epsilon, direction, -step, p_minus);
+
+  derivative[0] = 0.;
+  for (i = 1; i <= length; ++i)
+    derivative[i] = (p_plus[i] - p_minus[i]) / (2. * step);
+
+  free(p_plus);
+  free(p_minus);
+}
+
+
+/*
+ *  gradient of the objective function from the probabilities to be unpaired
+ *  p_prob_unpaired at perturbation epsilon. Requires two additional
+ *  partition functions for the directional derivative
+ */
+static void
+gradient_from_probabilities(vrna_fold_compound_t  *vc,
+                            const double          *epsilon,
+                            const double          *p_prob_unpaired,
+                            const double          *q_prob_unpaired,
+                            double                sigma_squared,
+                            double                tau_squared,
+                            int                   objective_function,
+                            double                *gradient)
+{
+  int     mu, length;
+  double  *w, *dp;
+
+  length  = vc->length;
+  w       = vrna_alloc(sizeof(double) * (length + 1));
+  dp      = vrna_alloc(sizeof(double) * (length + 1));
+
+  /* derivative of the discrepancy term with respect to p_i */
+  for (mu = 1; mu <= length; ++mu) {
+    if (q_prob_unpaired[mu] < 0) /* ignore positions with missing data */
+      continue;
+
+    if (objective_function == VRNA_OBJECTIVE_FUNCTION_QUADRATIC)
+      w[mu] = (p_prob_unpaired[mu] - q_prob_unpaired[mu]) / sigma_squared;
+    else if (p_prob_unpaired[mu] != q_prob_unpaired[mu])
+      w[mu] = (p_prob_unpaired[mu] > q_prob_unpaired[mu] ? 1. : -1.) / sigma_squared;
+  }
+
+  directional_derivative_unpaired(vc, epsilon, w, dp);
+
+  for (mu = 1; mu <= length; ++mu) {
+    if (objective_function == VRNA_OBJECTIVE_FUNCTION_QUADRATIC) {
+      gradient[mu] = 2 * (epsilon[mu] / tau_squared + dp[mu]);
+    } else if (objective_function == VRNA_OBJECTIVE_FUNCTION_ABSOLUTE) {
+      gradient[mu] = dp[mu];
+      if (epsilon[mu])
+        gradient[mu] += (epsilon[mu] > 0 ? 1. : -1.) / tau_squared;
+    }
+  }
+
+  free(w);
+  free(dp);
+}
+
+
+static void
+evaluate_exact_gradient(vrna_fold_compound_t  *vc,
+                        const double          *epsilon,
+                        const double          *q_prob_unpaired,
+                        double                sigma_squared,
+                        double                tau_squared,
+                        int                   objective_function,
+                        double                *gradient)
+{
+  int     length;
+  double  mfe, *p_prob_unpaired;
+
+  length          = vc->length;
+  p_prob_unpaired = vrna_alloc(sizeof(double) * (length + 1));
+
+  addSoftConstraint(vc, epsilon, length);
+
+  /* get new (constrained) MFE to scale pf computations properly */
+  mfe = (double)vrna_mfe(vc, NULL);
+  vrna_exp_params_rescale(vc, &mfe);
+
+  perturbed_probability_unpaired(vc, epsilon, NULL, 0., p_prob_unpaired);
+
+  gradient_from_probabilities(vc,
+                              epsilon,
+                              p_prob_unpaired,
+                              q_prob_unpaired,
+                              sigma_squared,
+                              tau_squared,
+                              objective_function,
+                              gradient);
+
+  vrna_sc_remove(vc);
+
+  free(p_prob_unpaired);
+}
+
+
 static void
 pairing_probabilities_from_restricted_pf(vrna_fold_compound_t *vc,
                                          const double         *epsilon,
@@ -307,6 +502,17 @@ evaluate_perturbation_vector_gradient(vrna_fold_compound_t  *vc,
   int     length  = vc->length;
   double  kT      = vc->exp_params->kT / 1000;
 
+  if (sample_size == 0) {
+    evaluate_exact_gradient(vc,
+                            epsilon,
+                            q_prob_unpaired,
+                            sigma_squared,
+                            tau_squared,
+                            objective_function,
+                            gradient);
+    return;
+  }
+
   allocateProbabilityArrays(&p_prob_unpaired, &p_conditional_prob_unpaired, length);
 
   if (sample_size > 0) {
@@ -364,6 +570,310 @@ evaluate_perturbation_vector_gradient(vrna_fold_compound_t  *vc,
 }
 
 
+static double
+objective_from_probabilities(const double *epsilon,
+                             const double *p_prob_unpaired,
+                             const double *q_prob_unpaired,
+                             int          length,
+                             double       sigma_squared,
+                             double       tau_squared,
+                             int          objective_function)
+{
+  int     i;
+  double  ret = 0.;
+
+  for (i = 1; i <= length; ++i) {
+    ret += evaluate_objective_function_contribution(epsilon[i], objective_function) / tau_squared;
+
+    if (q_prob_unpaired[i] >= 0) /* ignore positions with missing data */
+      ret += evaluate_objective_function_contribution(p_prob_unpaired[i] - q_prob_unpaired[i],
+                                                      objective_function) / sigma_squared;
+  }
+
+  return ret;
+}
+
+
+static double
+dot_product(const double  *a,
+            const double  *b,
+            int           length)
+{
+  int     i;
+  double  sum = 0.;
+
+  for (i = 1; i <= length; ++i)
+    sum += a[i] * b[i];
+
+  return sum;
+}
+
+
+#define LBFGS_MEMORY  7
+
+/*
+ *  Limited-memory BFGS with backtracking line search. Each trial point
+ *  costs a single partition function, the gradient is only evaluated for
+ *  accepted points. The Boltzmann factors are re-scaled with the ensemble
+ *  free energy of the current point, so no MFE computations are required
+ *  during the iterations
+ */
+static void
+minimize_lbfgs(vrna_fold_compound_t *vc,
+               const double         *q_prob_unpaired,
+               int                  objective_function,
+               double               sigma_squared,
+               double               tau_squared,
+               int                  sample_size,
+               double               *epsilon,
+               double               initialStepSize,
+               double               minStepSize,
+               double               minimizerTolerance,
+               progress_callback    callback)
+{
+  int           i, k, h, length, iteration, num, head, accepted;
+  double        f, f_new, G, mfe, gd, step, gamma, beta, sy, dmax,
+                *x, *x_new, *g, *g_new, *d, *p, *tmp, *s[LBFGS_MEMORY], *y[LBFGS_MEMORY],
+                rho[LBFGS_MEMORY], alpha[LBFGS_MEMORY];
+  const int     max_iterations = 100;
+  const double  armijo = 1e-4;
+
+  length  = vc->length;
+  x       = vrna_alloc(sizeof(double) * (length + 1));
+  x_new   = vrna_alloc(sizeof(double) * (length + 1));
+  g       = vrna_alloc(sizeof(double) * (length + 1));
+  g_new   = vrna_alloc(sizeof(double) * (length + 1));
+  d       = vrna_alloc(sizeof(double) * (length + 1));
+  p       = vrna_alloc(sizeof(double) * (length + 1));
+
+  for (k = 0; k < LBFGS_MEMORY; k++) {
+    s[k]  = vrna_alloc(sizeof(double) * (length + 1));
+    y[k]  = vrna_alloc(sizeof(double) * (length + 1));
+  }
+
+  memcpy(x, epsilon, sizeof(double) * (length + 1));
+
+  /* get (constrained) MFE to scale pf computations properly */
+  addSoftConstraint(vc, x, length);
+  mfe = (double)vrna_mfe(vc, NULL);
+  vrna_exp_params_rescale(vc, &mfe);
+
+  G = perturbed_probability_unpaired(vc, x, NULL, 0., p);
+  f = objective_from_probabilities(x,
+                                   p,
+                                   q_prob_unpaired,
+                                   length,
+                                   sigma_squared,
+                                   tau_squared,
+                                   objective_function);
+
+  if (sample_size == 0)
+    gradient_from_probabilities(vc,
+                                x,
+                                p,
+                                q_prob_unpaired,
+                                sigma_squared,
+                                tau_squared,
+                                objective_function,
+                                g);
+  else
+    evaluate_perturbation_vector_gradient(vc,
+                                          x,
+                                          q_prob_unpaired,
+                                          sigma_squared,
+                                          tau_squared,
+                                          objective_function,
+                                          sample_size,
+                                          g);
+
+  if (callback)
+    callback(0, f, x);
+
+  num   = 0;
+  head  = 0;
+
+  for (iteration = 1; iteration <= max_iterations; iteration++) {
+    if (sqrt(dot_product(g, g, length)) < minimizerTolerance)
+      break;
+
+    /* two-loop recursion for the search direction d = -H * g */
+    for (i = 1; i <= length; ++i)
+      d[i] = -g[i];
+
+    for (k = 0; k < num; k++) {
+      h         = (head - 1 - k + LBFGS_MEMORY) % LBFGS_MEMORY;
+      alpha[h]  = rho[h] * dot_product(s[h], d, length);
+      for (i = 1; i <= length; ++i)
+        d[i] -= alpha[h] * y[h][i];
+    }
+
+    if (num > 0) {
+      h     = (head - 1 + LBFGS_MEMORY) % LBFGS_MEMORY;
+      gamma = dot_product(s[h], y[h], length) / dot_product(y[h], y[h], length);
+    } else {
+      /* without curvature information, start like the gradient descent, i.e. with initialStepSize * g */
+      gamma = initialStepSize;
+    }
+
+    for (i = 1; i <= length; ++i)
+      d[i] *= gamma;
+
+    for (k = num - 1; k >= 0; k--) {
+      h     = (head - 1 - k + LBFGS_MEMORY) % LBFGS_MEMORY;
+      beta  = rho[h] * dot_product(y[h], d, length);
+      for (i = 1; i <= length; ++i)
+        d[i] += s[h][i] * (alpha[h] - beta);
+    }
+
+    gd = dot_product(g, d, length);
+
+    if (gd >= 0) {
+      /* not a descent direction, start over with steepest descent */
+      num   = 0;
+      gamma = initialStepSize;
+      for (i = 1; i <= length; ++i)
+        d[i] = -gamma * g[i];
+
+      gd = dot_product(g, d, length);
+    }
+
+    dmax = 0.;
+    for (i = 1; i <= length; ++i)
+      if (fabs(d[i]) > dmax)
+        dmax = fabs(d[i]);
+
+    /* backtracking line search */
+    accepted  = 0;
+    step      = 1.;
+
+    while (step * dmax >= minStepSize) {
+      for (i = 1; i <= length; ++i)
+        x_new[i] = x[i] + step * d[i];
+
+      G     = perturbed_probability_unpaired(vc, x_new, NULL, 0., p);
+      f_new = objective_from_probabilities(x_new,
+                                           p,
+                                           q_prob_unpaired,
+                                           length,
+                                           sigma_squared,
+                                           tau_squared,
+                                           objective_function);
+
+      if (f_new <= f + armijo * step * gd) {
+        accepted = 1;
+        break;
+      }
+
+      step /= 2;
+    }
+
+    if (!accepted)
+      break;
+
+    /* warm start, i.e. scale the Boltzmann factors of subsequent points by the current ensemble */
+    vrna_exp_params_rescale(vc, &G);
+
+    if (sample_size == 0)
+      gradient_from_probabilities(vc,
+                                  x_new,
+                                  p,
+                                  q_prob_unpaired,
+                                  sigma_squared,
+                                  tau_squared,
+                                  objective_function,
+                                  g_new);
+    else
+      evaluate_perturbation_vector_gradient(vc,
+                                            x_new,
+                                            q_prob_unpaired,
+                                            sigma_squared,
+                                            tau_squared,
+                                            objective_function,
+                                            sample_size,
+                                            g_new);
+
+    /* update curvature pairs */
+    for (i = 1; i <= length; ++i) {
+      s[head][i]  = x_new[i] - x[i];
+      y[head][i]  = g_new[i] - g[i];
+    }
+
+    sy = dot_product(s[head], y[head], length);
+    if (sy > 1e-12) {
+      rho[head] = 1. / sy;
+      head      = (head + 1) % LBFGS_MEMORY;
+      if (num < LBFGS_MEMORY)
+        num++;
+    }
+
+    tmp   = x;
+    x     = x_new;
+    x_new = tmp;
+    tmp   = g;
+    g     = g_new;
+    g_new = tmp;
+    f     = f_new;
+
+    if (callback)
+      callback(iteration, f, x);
+  }
+
+  memcpy(epsilon, x, sizeof(double) * (length + 1));
+
+  vrna_sc_remove(vc);
+
+  for (k = 0; k < LBFGS_MEMORY; k++) {
+    free(s[k]);
+    free(y[k]);
+  }
+
+  free(x);
+  free(x_new);
+  free(g);
+  free(g_new);
+  free(d);
+  free(p);
+}
+
+
+PUBLIC int
+vrna_sc_perturbation_derivatives(vrna_fold_compound_t *fc,
+                                 const double         *epsilon,
+                                 const double         *direction,
+                                 double               *prob_unpaired,
+                                 double               *derivative)
+{
+  int     length;
+  double  mfe;
+
+  if ((!fc) ||
+      (!prob_unpaired) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE))
+    return 0;
+
+  length = fc->length;
+
+  if (epsilon)
+    addSoftConstraint(fc, epsilon, length);
+  else
+    vrna_sc_init(fc);
+
+  /* get new (constrained) MFE to scale pf computations properly */
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+
+  perturbed_probability_unpaired(fc, epsilon, NULL, 0., prob_unpaired);
+
+  if ((direction) &&
+      (derivative))
+    directional_derivative_unpaired(fc, epsilon, direction, derivative);
+
+  vrna_sc_remove(fc);
+
+  return 1;
+}
+
+
 #ifdef VRNA_WITH_GSL
 typedef struct parameters_gsl {
   vrna_fold_compound_t  *vc;
@@ -440,6 +950,21 @@ vrna_sc_minimize_pertubation(vrna_fold_compound_t *vc,
   const int                             max_iterations  = 100;
   int                                   length          = vc->length;
 
+  if (algorithm == VRNA_MINIMIZER_LBFGS) {
+    minimize_lbfgs(vc,
+                   q_prob_unpaired,
+                   objective_function,
+                   sigma_squared,
+                   tau_squared,
+                   sample_size,
+                   epsilon,
+                   initialStepSize,
+                   minStepSize,
+                   minimizerTolerance,
+                   callback);
+    return;
+  }
+
 #ifdef VRNA_WITH_GSL
   const gsl_multimin_fdfminimizer_type  *minimizer_type = 0;
 
@@ -80,6 +80,16 @@
  */
 #define VRNA_MINIMIZER_STEEPEST_DESCENT 5
 
+/**
+ * @brief Use a custom implementation of the limited-memory Broyden-Fletcher-Goldfarb-Shanno algorithm to minimize the objective function
+ *
+ * This algorithm does not require the GNU Scientific Library. For an exact evaluation of the gradient (sample_size = 0), each iteration
+ * requires three partition function computations, and each additional trial step of the line search one more.
+ *
+ * @ingroup perturbation
+ */
+#define VRNA_MINIMIZER_LBFGS 6
+
 /**
  * @brief Callback for following the progress of the minimization process
  *
@@ -149,4 +159,42 @@ void vrna_sc_minimize_pertubation(vrna_fold_compound_t  *fc,
                                   progress_callback     callback);
 
 
+/**
+ *  @brief Compute derivatives of the ensemble with respect to unpaired perturbation energies
+ *
+ *  Applies the perturbation energies @p epsilon as soft constraints for unpaired nucleotides
+ *  and computes the probabilities @f$ p_i(\vec\epsilon) @f$ of each nucleotide to be unpaired.
+ *  These are, at the same time, the gradient of the ensemble free energy
+ *  @f$ \partial G / \partial \epsilon_i = p_i(\vec\epsilon) @f$, i.e. they are obtained
+ *  from a single inside-outside pass.
+ *
+ *  If a @p direction vector @f$ \vec w @f$ is provided, this function additionally computes
+ *  the directional derivative
+ *
+ *  @f[
+ *  d_i = \sum_{\mu}{ \frac{\partial p_i(\vec\epsilon)}{\partial \epsilon_\mu} w_\mu },
+ *  @f]
+ *
+ *  i.e. the product of the Hessian of @f$ G @f$ with @f$ \vec w @f$, by central differences.
+ *  This requires two additional partition function computations instead of one restricted
+ *  partition function per nucleotide and is what vrna_sc_minimize_pertubation() uses for an
+ *  exact evaluation of the gradient of its objective function.
+ *
+ *  @ingroup perturbation
+ *
+ *  @param fc             Pointer to a fold compound
+ *  @param epsilon        The perturbation energies in kcal/mol (1-based, may be NULL)
+ *  @param direction      The direction vector (1-based, may be NULL)
+ *  @param prob_unpaired  A pointer to an array of size n + 1 used for storing the probabilities to be unpaired
+ *  @param derivative     A pointer to an array of size n + 1 used for storing the directional derivative (may be NULL)
+ *  @return               1 on success, 0 otherwise
+ */
+int
+vrna_sc_perturbation_derivatives(vrna_fold_compound_t *fc,
+                                 const double         *epsilon,
+                                 const double         *direction,
+                                 double               *prob_unpaired,
+                                 double               *derivative);
+
+
 #endif
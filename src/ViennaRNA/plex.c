@@ -316,7 +316,7 @@ duplexfold_XS(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -658,7 +658,7 @@ fduplexfold_XS(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1144,7 +1144,7 @@ fbacktrack_XS(int       i,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2004,7 +2004,7 @@ Lduplexfold_XS(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_dfold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2725,7 +2725,7 @@ duplexfold(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2949,7 +2949,7 @@ fduplexfold(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -3888,7 +3888,7 @@ Lduplexfold(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       update_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -4533,7 +4533,7 @@ update_dfold_params(void)
   vrna_md_t md;
 
   if (P)
-    free(P);
+    vrna_params_free(P);
 
   set_model_details(&md);
   P = vrna_params(&md);
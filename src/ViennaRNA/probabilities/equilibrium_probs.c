@@ -68,6 +68,8 @@ typedef struct {
   unsigned int  ud_max_size;
   FLT_OR_DBL    **pmlu;
   FLT_OR_DBL    *prm_MLbu;
+
+  vrna_array(unsigned int)  *outer; /* outer[i] lists all j with non-zero outside contributions for (i,j) */
 } helper_arrays;
 
 
@@ -146,7 +148,8 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc);
 
 
 PRIVATE void
-free_ml_helper_arrays(helper_arrays *ml_helpers);
+free_ml_helper_arrays(helper_arrays *ml_helpers,
+                      unsigned int  n);
 
 
 PRIVATE void
@@ -220,6 +223,16 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     constraints_helper    *constraints);
 
 
+PRIVATE INLINE FLT_OR_DBL
+contrib_ml_leftmost_stem(vrna_fold_compound_t   *fc,
+                         int                    i,
+                         int                    j,
+                         int                    l,
+                         vrna_hc_eval_f         hc_eval,
+                         struct hc_mb_def_dat   *hc_dat,
+                         struct sc_mb_exp_dat   *sc_wrapper);
+
+
 PRIVATE FLT_OR_DBL
 contrib_ext_pair(vrna_fold_compound_t *fc,
                  unsigned int         i,
@@ -690,7 +703,7 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                            ov, pf_params->pf_scale);
 
     /* clean up */
-    free_ml_helper_arrays(ml_helpers);
+    free_ml_helper_arrays(ml_helpers, n);
 
     free_constraints_helper(constraints);
 
@@ -744,6 +757,22 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
   ml_helpers->ud_max_size = 0;
   ml_helpers->pmlu        = NULL;
   ml_helpers->prm_MLbu    = NULL;
+  ml_helpers->outer       = NULL;
+
+  /*
+   *  for the sparse engine, we collect all pairs (i,j) with non-zero outside
+   *  contribution once they are final, such that multibranch loop contributions
+   *  only need to visit possible enclosing pairs
+   */
+  if ((fc->engine & VRNA_OPTION_SPARSE) &&
+      (fc->type == VRNA_FC_TYPE_SINGLE) &&
+      (fc->strands == 1)) {
+    ml_helpers->outer = (vrna_array(unsigned int) *)vrna_alloc(
+      sizeof(vrna_array(unsigned int)) * (n + 2));
+
+    for (u = 0; u <= n + 1; u++)
+      vrna_array_init(ml_helpers->outer[u]);
+  }
 
   if (with_ud) {
     /* find out maximum size of any unstructured domain */
@@ -769,7 +798,8 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
 
 
 PRIVATE void
-free_ml_helper_arrays(helper_arrays *ml_helpers)
+free_ml_helper_arrays(helper_arrays *ml_helpers,
+                      unsigned int  n)
 {
   unsigned int u;
 
@@ -783,6 +813,13 @@ free_ml_helper_arrays(helper_arrays *ml_helpers)
     free(ml_helpers->pmlu);
   }
 
+  if (ml_helpers->outer) {
+    for (u = 0; u <= n + 1; u++)
+      vrna_array_free(ml_helpers->outer[u]);
+
+    free(ml_helpers->outer);
+  }
+
   free(ml_helpers->prm_MLbu);
   free(ml_helpers);
 }
@@ -1309,6 +1346,7 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
   unsigned int              *sn;
   int                       cnt, i, j, k, n, u, ii, ij, kl, lj, *my_iindx, *jindx,
                             *rtype, with_gquad, with_ud;
+  size_t                    pos;
   FLT_OR_DBL                temp, ppp, prm_MLb, prmt, prmt1, *qb, *probs, *qm, *scale,
                             *expMLbase, expMLclosing, expMLstem;
   double                    max_real;
@@ -1350,6 +1388,12 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
   prm_MLb   = 0.;
   max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
+  /* all pairs (i, l + 1) received their final outside contributions by now */
+  if (ml_helpers->outer)
+    for (i = 1; i <= l; i++)
+      if (probs[my_iindx[i] - (l + 1)] != 0.)
+        vrna_array_append(ml_helpers->outer[i], (unsigned int)(l + 1));
+
   if (sn[l + 1] != sn[l]) {
     /* set prm_l to 0 to get prm_l1 in the next round to be 0 */
     for (i = 0; i <= n; i++)
@@ -1360,29 +1404,35 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
       i     = k - 1;
       prmt  = prmt1 = 0.0;
 
-      ij  = my_iindx[i] - (l + 2);
-      lj  = my_iindx[l + 1] - (l + 1);
-      s3  = S1[i + 1];
       if (sn[k] == sn[i]) {
-        for (j = l + 2; j <= n; j++, ij--, lj--) {
-          if (hc_eval(i, j, i + 1, j - 1, VRNA_DECOMP_PAIR_ML, hc_dat)) {
-            tt = vrna_get_ptype_md(S[j], S[i], md);
+        if (ml_helpers->outer) {
+          /* only visit enclosing pairs (i, j) with non-zero outside contribution */
+          for (pos = 0; pos < vrna_array_size(ml_helpers->outer[i]); pos++) {
+            j = ml_helpers->outer[i][pos];
+            if (j < l + 2)
+              break;
 
-            /* which decomposition is covered here? =>
-             * i + 1 = k < l < j:
-             * (i,j)       -> enclosing pair
-             * (k, l)      -> enclosed pair
-             * (l+1, j-1)  -> multiloop part with at least one stem
-             * a.k.a. (k,l) is left-most stem in multiloop closed by (k-1, j)
-             */
-            ppp = probs[ij] *
-                  vrna_exp_E_multibranch_stem(tt, S1[j - 1], s3, pf_params) *
-                  qm[lj];
+            prmt += contrib_ml_leftmost_stem(fc, i, j, l, hc_eval, hc_dat, sc_wrapper);
+          }
+        } else {
+          ij  = my_iindx[i] - (l + 2);
+          lj  = my_iindx[l + 1] - (l + 1);
+          s3  = S1[i + 1];
 
-            if (sc_wrapper->pair)
-              ppp *= sc_wrapper->pair(i, j, sc_wrapper);
+          for (j = l + 2; j <= n; j++, ij--, lj--) {
+            if (hc_eval(i, j, i + 1, j - 1, VRNA_DECOMP_PAIR_ML, hc_dat)) {
+              tt = vrna_get_ptype_md(S[j], S[i], md);
 
-            prmt += ppp;
+              /* same decomposition as in contrib_ml_leftmost_stem() */
+              ppp = probs[ij] *
+                    vrna_exp_E_multibranch_stem(tt, S1[j - 1], s3, pf_params) *
+                    qm[lj];
+
+              if (sc_wrapper->pair)
+                ppp *= sc_wrapper->pair(i, j, sc_wrapper);
+
+              prmt += ppp;
+            }
           }
         }
 
@@ -1560,6 +1610,55 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
 }
 
 
+/*
+ *  contribution of pair (i, j) to the outside partition function of all pairs
+ *  (i + 1, l) that are left-most stem in the multibranch loop closed by (i, j)
+ */
+PRIVATE INLINE FLT_OR_DBL
+contrib_ml_leftmost_stem(vrna_fold_compound_t   *fc,
+                         int                    i,
+                         int                    j,
+                         int                    l,
+                         vrna_hc_eval_f         hc_eval,
+                         struct hc_mb_def_dat   *hc_dat,
+                         struct sc_mb_exp_dat   *sc_wrapper)
+{
+  unsigned char     tt;
+  short             *S, *S1;
+  int               *my_iindx;
+  FLT_OR_DBL        ppp;
+  vrna_exp_param_t  *pf_params;
+  vrna_md_t         *md;
+
+  ppp = 0.;
+
+  if (hc_eval(i, j, i + 1, j - 1, VRNA_DECOMP_PAIR_ML, hc_dat)) {
+    S         = fc->sequence_encoding2;
+    S1        = fc->sequence_encoding;
+    my_iindx  = fc->iindx;
+    pf_params = fc->exp_params;
+    md        = &(pf_params->model_details);
+    tt        = vrna_get_ptype_md(S[j], S[i], md);
+
+    /* which decomposition is covered here? =>
+     * i + 1 = k < l < j:
+     * (i,j)       -> enclosing pair
+     * (k, l)      -> enclosed pair
+     * (l+1, j-1)  -> multiloop part with at least one stem
+     * a.k.a. (k,l) is left-most stem in multiloop closed by (k-1, j)
+     */
+    ppp = fc->exp_matrices->probs[my_iindx[i] - j] *
+          vrna_exp_E_multibranch_stem(tt, S1[j - 1], S1[i + 1], pf_params) *
+          fc->exp_matrices->qm[my_iindx[l + 1] - (j - 1)];
+
+    if (sc_wrapper->pair)
+      ppp *= sc_wrapper->pair(i, j, sc_wrapper);
+  }
+
+  return ppp;
+}
+
+
 PRIVATE void
 compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     int                   l,
@@ -111,8 +111,14 @@ vrna_pr_energy(vrna_fold_compound_t *fc,
 {
   if ((fc) &&
       (fc->exp_params) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->q)) {
+      (fc->beam_probs)) {
+    double kT = fc->exp_params->kT / 1000.;
+
+    return exp((fc->beam_energy - e) / kT);
+  } else if ((fc) &&
+             (fc->exp_params) &&
+             (fc->exp_matrices) &&
+             (fc->exp_matrices->q)) {
     unsigned int      n;
     double            kT, Q, dG, p;
     vrna_exp_param_t  *params = fc->exp_params;
@@ -161,6 +167,14 @@ vrna_mean_bp_distance(vrna_fold_compound_t *vc)
 {
   if (!vc) {
     vrna_log_warning("vrna_mean_bp_distance: run vrna_pf_fold first!");
+  } else if (vc->beam_probs) {
+    double    d = 0.;
+    vrna_ep_t *ptr;
+
+    for (ptr = vc->beam_probs; ptr->i > 0; ptr++)
+      d += ptr->p * (1 - ptr->p);
+
+    return 2 * d;
   } else if (!vc->exp_matrices) {
     vrna_log_warning("vrna_mean_bp_distance: exp_matrices == NULL!");
   } else if (!vc->exp_matrices->probs) {
@@ -186,8 +200,38 @@ vrna_ensemble_defect_pt(vrna_fold_compound_t  *fc,
   if ((fc) &&
       (pt) &&
       ((unsigned int)pt[0] == fc->length) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->probs)) {
+      (fc->beam_probs)) {
+    double    *pp;
+    vrna_ep_t *ptr;
+
+    n   = fc->length;
+    pp  = (double *)vrna_alloc(sizeof(double) * (n + 1));
+
+    /* probability to be paired, and sum of unpaired and correctly paired probabilities */
+    for (ptr = fc->beam_probs; ptr->i > 0; ptr++) {
+      pp[ptr->i]  += ptr->p;
+      pp[ptr->j]  += ptr->p;
+    }
+
+    ed = 0.;
+    for (i = 1; i <= n; i++)
+      if (pt[i] == 0)
+        ed += pp[i];
+      else
+        ed += 1.;
+
+    for (ptr = fc->beam_probs; ptr->i > 0; ptr++)
+      if (pt[ptr->i] == ptr->j)
+        ed -= 2 * ptr->p;
+
+    free(pp);
+
+    ed /= (double)n;
+  } else if ((fc) &&
+             (pt) &&
+             ((unsigned int)pt[0] == fc->length) &&
+             (fc->exp_matrices) &&
+             (fc->exp_matrices->probs)) {
     n = fc->length;
 
     FLT_OR_DBL  *probs  = fc->exp_matrices->probs;
@@ -114,6 +114,10 @@ PRIVATE char  *info_no_circ =
   "No implementation for circular RNAs available.";
 
 
+PRIVATE char  *info_no_beam =
+  "Not available for the beam search engine (VRNA_OPTION_BEAM).";
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -222,6 +226,8 @@ vrna_pbacktrack_sub_resume_cb(vrna_fold_compound_t  *fc,
       vrna_log_warning("vrna_pbacktrack*(): interval end coordinate exceeds sequence length");
     } else if (end < start) {
       vrna_log_warning("vrna_pbacktrack*(): interval end < start");
+    } else if (fc->engine & VRNA_OPTION_BEAM) {
+      vrna_log_warning("vrna_pbacktrack*(): %s", info_no_beam);
     } else if ((!matrices) || (!matrices->q) || (!matrices->qb) || (!matrices->qm) ||
                (!fc->exp_params)) {
       vrna_log_warning("vrna_pbacktrack*(): %s", info_call_pf);
@@ -1362,7 +1368,7 @@ backtrack_qm2(vrna_fold_compound_t            *fc,
         q_temp *= sc_wrapper->decomp_ml(i, j, k - 1, k, sc_wrapper);
 
       if (sc_wrapper->red_stem)
-        q_temp *= sc_wrapper->decomp_ml(k, j, k, j, sc_wrapper);
+        q_temp *= sc_wrapper->red_stem(k, j, k, j, sc_wrapper);
 
       if (current_node) {
         fbds = NR_GET_WEIGHT(*current_node, memorized_node_cur, NRT_QM2_BRANCH, k, j) *
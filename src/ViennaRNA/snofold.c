@@ -1393,7 +1393,7 @@ snoupdate_fold_params(void)
   vrna_md_t md;
 
   if (P)
-    free(P);
+    vrna_params_free(P);
 
   set_model_details(&md);
   P = vrna_params(&md);
@@ -293,7 +293,7 @@ alisnoopfold(const char **s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1167,7 +1167,7 @@ Lsnoop_subopt(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1410,7 +1410,7 @@ Lsnoop_subopt_list(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -1817,7 +1817,7 @@ snoopfold(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2009,7 +2009,7 @@ snoopfold_XS_fill(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -2897,7 +2897,7 @@ Lsnoop_subopt_list_XS(const char  *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -3300,7 +3300,7 @@ snoopfold_XS(const char *s1,
     md.max_bp_span = P->model_details.max_bp_span;
     /* check if model_details are the same as before */
     if (memcmp(&md, &(P->model_details), sizeof(vrna_md_t))) {
-      free(P);
+      vrna_params_free(P);
       snoupdate_fold_params();
       P = vrna_params(&md);
       make_pair_matrix();
@@ -17,6 +17,15 @@
 #include "ViennaRNA/dist_vars.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/structures/edit_distance.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/edit_distance_dat.h"
 
 PUBLIC float
 string_edit_distance(swString *T1,
@@ -36,15 +45,18 @@ print_alignment_list(void);
 
 
 PRIVATE void
-sprint_aligned_swStrings(swString *T1,
-                         swString *T2);
+sprint_aligned_swStrings(vrna_edit_dist_t *ctx,
+                         int              *alignment[2],
+                         const swString   *T1,
+                         const swString   *T2);
 
 
 PRIVATE float
-StrEditCost(int       i,
-            int       j,
-            swString  *T1,
-            swString  *T2);
+StrEditCost(int             i,
+            int             j,
+            const swString  *T1,
+            const swString  *T2,
+            CostMatrix      *cost);
 
 
 PRIVATE void
@@ -65,178 +77,226 @@ encode(int  type,
 
 PRIVATE int *alignment[2];       /* contains information from backtracking
                                   *  alignment[0][n] is the node in tree2
-                                  *  matching node n in tree1               */
+                                  *  matching node n in tree1
+                                  *  (legacy interface only)                */
 
 
 /*---------------------------------------------------------------------------*/
 
 PUBLIC float
-string_edit_distance(swString *T1,
-                     swString *T2)
-
+vrna_string_edit_distance(vrna_edit_dist_t  *ctx,
+                          const swString    *T1,
+                          const swString    *T2)
 {
-  float **distance;
-  short **i_point, **j_point;
-
-  int   i, j, i1, j1, pos, length1, length2;
-  float minus, plus, change, temp;
-
-  if (cost_matrix == 0)
-    EditCost = &UsualCost;
-  else
-    EditCost = &ShapiroCost;
-
-  i_point = NULL;
-  j_point = NULL;
+  float       *distance, *prev, *cur;
+  short       *i_point, *j_point;
+  int         *alignment[2];
+  int         i, j, i1, j1, pos, length1, length2, cols;
+  float       minus, plus, change, temp;
+  size_t      cells;
+  CostMatrix  *cost;
+
+  if ((!ctx) || (!T1) || (!T2))
+    return (float)INF;
+
+  cost    = (ctx->options & VRNA_EDIT_DIST_SHAPIRO) ? &ShapiroCost : &UsualCost;
   length1 = T1[0].sign;
   length2 = T2[0].sign;
+  cols    = length2 + 1;
+
+  if (!(ctx->options & VRNA_EDIT_DIST_BACKTRACK)) {
+    /* without backtracking, two rows of the alignment matrix suffice */
+    ctx->fbuf = (float *)edit_dist_buffer(ctx->fbuf,
+                                          &(ctx->fbuf_size),
+                                          2 * (size_t)cols,
+                                          sizeof(float));
+    prev    = ctx->fbuf;
+    cur     = ctx->fbuf + cols;
+    prev[0] = 0.;
+
+    for (j = 1; j <= length2; j++)
+      prev[j] = prev[j - 1] + StrEditCost(0, j, T1, T2, cost);
+
+    for (i = 1; i <= length1; i++) {
+      cur[0] = prev[0] + StrEditCost(i, 0, T1, T2, cost);
+
+      for (j = 1; j <= length2; j++) {
+        minus   = prev[j] + StrEditCost(i, 0, T1, T2, cost);
+        plus    = cur[j - 1] + StrEditCost(0, j, T1, T2, cost);
+        change  = prev[j - 1] + StrEditCost(i, j, T1, T2, cost);
+
+        cur[j] = MIN3(minus, plus, change);
+      }
 
-  distance = (float **)vrna_alloc((length1 + 1) * sizeof(float *));
-  if (edit_backtrack) {
-    i_point = (short **)vrna_alloc((length1 + 1) * sizeof(short *));
-    j_point = (short **)vrna_alloc((length1 + 1) * sizeof(short *));
-  }
-
-  for (i = 0; i <= length1; i++) {
-    distance[i] = (float *)vrna_alloc((length2 + 1) * sizeof(float));
-    if (edit_backtrack) {
-      i_point[i]  = (short *)vrna_alloc((length2 + 1) * sizeof(short));
-      j_point[i]  = (short *)vrna_alloc((length2 + 1) * sizeof(short));
+      distance  = prev;
+      prev      = cur;
+      cur       = distance;
     }
+
+    return prev[length2];
   }
 
-  for (i = 1; i <= length1; i++) {
-    if (edit_backtrack) {
-      i_point[i][0] = i - 1;
-      j_point[i][0] = 0;
-    }
+  cells     = (size_t)(length1 + 1) * (size_t)cols;
+  ctx->fbuf = (float *)edit_dist_buffer(ctx->fbuf,
+                                        &(ctx->fbuf_size),
+                                        cells,
+                                        sizeof(float));
+  ctx->sbuf = (short *)edit_dist_buffer(ctx->sbuf,
+                                        &(ctx->sbuf_size),
+                                        2 * cells,
+                                        sizeof(short));
+  ctx->ibuf = (int *)edit_dist_buffer(ctx->ibuf,
+                                      &(ctx->ibuf_size),
+                                      2 * (size_t)(length1 + length2 + 1),
+                                      sizeof(int));
+
+  distance      = ctx->fbuf;
+  i_point       = ctx->sbuf;
+  j_point       = ctx->sbuf + cells;
+  alignment[0]  = ctx->ibuf;
+  alignment[1]  = ctx->ibuf + length1 + length2 + 1;
+
+  distance[0] = 0.;
+  i_point[0]  = j_point[0] = 0;
 
-    distance[i][0] = distance[i - 1][0] + StrEditCost(i, 0, T1, T2);
+  for (i = 1; i <= length1; i++) {
+    i_point[i * cols]   = i - 1;
+    j_point[i * cols]   = 0;
+    distance[i * cols]  = distance[(i - 1) * cols] + StrEditCost(i, 0, T1, T2, cost);
   }
   for (j = 1; j <= length2; j++) {
-    if (edit_backtrack) {
-      j_point[0][j] = j - 1;
-      i_point[0][j] = 0;
-    }
-
-    distance[0][j] = distance[0][j - 1] + StrEditCost(0, j, T1, T2);
+    j_point[j]  = j - 1;
+    i_point[j]  = 0;
+    distance[j] = distance[j - 1] + StrEditCost(0, j, T1, T2, cost);
   }
 
   for (i = 1; i <= length1; i++) {
     for (j = 1; j <= length2; j++) {
-      minus   = distance[i - 1][j] + StrEditCost(i, 0, T1, T2);
-      plus    = distance[i][j - 1] + StrEditCost(0, j, T1, T2);
-      change  = distance[i - 1][j - 1] + StrEditCost(i, j, T1, T2);
-
-      distance[i][j] = MIN3(minus, plus, change);
-      /* printf("%g ", distance[i][j]); */
-
-      if (edit_backtrack) {
-        if (distance[i][j] == change) {
-          i_point[i][j] = i - 1;
-          j_point[i][j] = j - 1;
-        } else if (distance[i][j] == plus) {
-          i_point[i][j] = i;
-          j_point[i][j] = j - 1;
-        } else {
-          i_point[i][j] = i - 1;
-          j_point[i][j] = j;
-        }
+      minus   = distance[(i - 1) * cols + j] + StrEditCost(i, 0, T1, T2, cost);
+      plus    = distance[i * cols + j - 1] + StrEditCost(0, j, T1, T2, cost);
+      change  = distance[(i - 1) * cols + j - 1] + StrEditCost(i, j, T1, T2, cost);
+
+      distance[i * cols + j] = MIN3(minus, plus, change);
+
+      if (distance[i * cols + j] == change) {
+        i_point[i * cols + j] = i - 1;
+        j_point[i * cols + j] = j - 1;
+      } else if (distance[i * cols + j] == plus) {
+        i_point[i * cols + j] = i;
+        j_point[i * cols + j] = j - 1;
+      } else {
+        i_point[i * cols + j] = i - 1;
+        j_point[i * cols + j] = j;
       }
     }
-    /* printf("\n"); */
   }
-  /* printf("\n"); */
-  temp = distance[length1][length2];
-  for (i = 0; i <= length1; i++)
-    free(distance[i]);
-  free(distance);
+  temp = distance[length1 * cols + length2];
+
+  pos = length1 + length2;
+  i   = length1;
+  j   = length2;
+  while ((i > 0) || (j > 0)) {
+    i1  = i_point[i * cols + j];
+    j1  = j_point[i * cols + j];
+    if (((i - i1) == 1) && ((j - j1) == 1)) {
+      /* substitution    */
+      alignment[0][pos] = i;
+      alignment[1][pos] = j;
+    }
 
-  if (edit_backtrack) {
-    if (alignment[0] != NULL)
-      free(alignment[0]);
-
-    if (alignment[1] != NULL)
-      free(alignment[1]);
-
-    alignment[0]  = (int *)vrna_alloc((length1 + length2 + 1) * sizeof(int));
-    alignment[1]  = (int *)vrna_alloc((length1 + length2 + 1) * sizeof(int));
-
-    pos = length1 + length2;
-    i   = length1;
-    j   = length2;
-    while ((i > 0) || (j > 0)) {
-      i1  = i_point[i][j];
-      j1  = j_point[i][j];
-      if (((i - i1) == 1) && ((j - j1) == 1)) {
-        /* substitution    */
-        alignment[0][pos] = i;
-        alignment[1][pos] = j;
-      }
+    if (((i - i1) == 1) && (j == j1)) {
+      /* Deletion in [1] */
+      alignment[0][pos] = i;
+      alignment[1][pos] = 0;
+    }
 
-      if (((i - i1) == 1) && (j == j1)) {
-        /* Deletion in [1] */
-        alignment[0][pos] = i;
-        alignment[1][pos] = 0;
-      }
+    if ((i == i1) && ((j - j1) == 1)) {
+      /* Deletion in [0] */
+      alignment[0][pos] = 0;
+      alignment[1][pos] = j;
+    }
 
-      if ((i == i1) && ((j - j1) == 1)) {
-        /* Deletion in [0] */
-        alignment[0][pos] = 0;
-        alignment[1][pos] = j;
-      }
+    pos--;
+    i = i1;
+    j = j1;
+  }
+  for (i = pos + 1; i <= length1 + length2; i++) {
+    alignment[0][i - pos] = alignment[0][i];
+    alignment[1][i - pos] = alignment[1][i];
+  }
+  alignment[0][0] = length1 + length2 - pos;  /* length of alignment */
 
-      pos--;
-      i = i1;
-      j = j1;
-    }
-    for (i = pos + 1; i <= length1 + length2; i++) {
-      alignment[0][i - pos] = alignment[0][i];
-      alignment[1][i - pos] = alignment[1][i];
-    }
-    alignment[0][0] = length1 + length2 - pos;  /* length of alignment */
+  sprint_aligned_swStrings(ctx, alignment, T1, T2);
+
+  return temp;
+}
+
+
+PUBLIC float
+string_edit_distance(swString *T1,
+                     swString *T2)
+{
+  int               k, l;
+  float             dist;
+  vrna_edit_dist_t  *ctx;
 
-    for (i = 0; i <= length1; i++) {
-      free(i_point[i]);
-      free(j_point[i]);
+  ctx = vrna_edit_dist_init(((cost_matrix) ? VRNA_EDIT_DIST_SHAPIRO : VRNA_EDIT_DIST_DEFAULT) |
+                            ((edit_backtrack) ? VRNA_EDIT_DIST_BACKTRACK : 0));
+
+  dist = vrna_string_edit_distance(ctx, T1, T2);
+
+  if (edit_backtrack) {
+    /* keep a copy of the alignment for print_alignment_list() */
+    free(alignment[0]);
+    free(alignment[1]);
+
+    l             = T1[0].sign + T2[0].sign + 1;
+    alignment[0]  = (int *)vrna_alloc(sizeof(int) * l);
+    alignment[1]  = (int *)vrna_alloc(sizeof(int) * l);
+
+    for (k = 0; k <= ctx->ibuf[0]; k++) {
+      alignment[0][k] = ctx->ibuf[k];
+      alignment[1][k] = ctx->ibuf[l + k];
     }
-    free(i_point);
-    free(j_point);
-    sprint_aligned_swStrings(T1, T2);
+
+    edit_dist_export_aligned_lines(ctx);
   }
 
-  return temp;
+  vrna_edit_dist_free(ctx);
+
+  return dist;
 }
 
 
 /*---------------------------------------------------------------------------*/
 
 PRIVATE float
-StrEditCost(int       i,
-            int       j,
-            swString  *T1,
-            swString  *T2)
+StrEditCost(int             i,
+            int             j,
+            const swString  *T1,
+            const swString  *T2,
+            CostMatrix      *cost)
 {
   float c, diff, cd, min, a, b, dist;
 
   if (i == 0) {
-    cd    = (float)(*EditCost)[0][T2[j].type];
+    cd    = (float)(*cost)[0][T2[j].type];
     diff  = T2[j].weight;
     dist  = cd * diff;
   } else
   if (j == 0) {
-    cd    = (float)(*EditCost)[T1[i].type][0];
+    cd    = (float)(*cost)[T1[i].type][0];
     diff  = T1[i].weight;
     dist  = cd * diff;
   } else
   if (((T1[i].sign) * (T2[j].sign)) > 0) {
-    c     = (float)(*EditCost)[T1[i].type][T2[j].type];
+    c     = (float)(*cost)[T1[i].type][T2[j].type];
     diff  = (float)fabs((a = T1[i].weight) - (b = T2[j].weight));
     min   = MIN2(a, b);
     if (min == a)
-      cd = (float)(*EditCost)[0][T2[j].type];
+      cd = (float)(*cost)[0][T2[j].type];
     else
-      cd = (float)(*EditCost)[T1[i].type][0];
+      cd = (float)(*cost)[T1[i].type][0];
 
     dist = c * min + cd * diff;
   } else {
@@ -443,8 +503,10 @@ encode(int  type,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-sprint_aligned_swStrings(swString *T1,
-                         swString *T2)
+sprint_aligned_swStrings(vrna_edit_dist_t *ctx,
+                         int              *alignment[2],
+                         const swString   *T1,
+                         const swString   *T2)
 {
   int   i, j, l0, l1, ltmp = 0, weights;
   char  label[10], *a0, *a1, tmp0[20], tmp1[20];
@@ -510,20 +572,7 @@ sprint_aligned_swStrings(swString *T1,
     strcat(a1, tmp1);
     ltmp = strlen(a0);
   }
-  if (aligned_line[0] != NULL) {
-    free(aligned_line[0]);
-    aligned_line[0] = NULL;
-  }
-
-  if (aligned_line[1] != NULL) {
-    free(aligned_line[1]);
-    aligned_line[1] = NULL;
-  }
-
-  aligned_line[0] = strdup(a0);
-  free(a0);
-  aligned_line[1] = strdup(a1);
-  free(a1);
+  edit_dist_aligned_lines(ctx, a0, a1);
 }
 
 
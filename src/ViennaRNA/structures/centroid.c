@@ -149,7 +149,9 @@ vrna_centroid(vrna_fold_compound_t  *fc,
   } else if (!dist) {
     vrna_log_error("pointer to centroid distance is missing");
     return NULL;
-  } else if (!fc->exp_matrices->probs) {
+  } else if (fc->beam_probs) {
+    return vrna_centroid_from_plist((int)fc->length, dist, fc->beam_probs);
+  } else if ((!fc->exp_matrices) || (!fc->exp_matrices->probs)) {
     vrna_log_warning("probs == NULL!");
     return NULL;
   }
@@ -0,0 +1,218 @@
+#ifndef VIENNA_RNA_PACKAGE_STRUCTURES_EDIT_DISTANCE_H
+#define VIENNA_RNA_PACKAGE_STRUCTURES_EDIT_DISTANCE_H
+
+#include <ViennaRNA/dist_vars.h>
+#include <ViennaRNA/structures/metrics.h>
+
+/**
+ *  @file     ViennaRNA/structures/edit_distance.h
+ *  @ingroup  struct_utils
+ *  @brief    Reentrant tree-, string-, and profile edit distances and all-vs-all distance matrices
+ */
+
+/**
+ *  @addtogroup struct_utils_metrics
+ *  @{
+ */
+
+/**
+ *  @brief  Workspace for tree-, string-, and profile edit distance computations
+ *
+ *  In contrast to tree_edit_distance(), string_edit_distance(), and
+ *  profile_edit_distance() that depend on the global settings #cost_matrix and
+ *  #edit_backtrack and store alignments in the global #aligned_line, all settings,
+ *  working memory, and the alignment of the last comparison are kept in this
+ *  object. Different threads may therefore compute distances simultaneously as
+ *  long as each of them uses its own workspace. A workspace may be re-used for an
+ *  arbitrary number of comparisons.
+ *
+ *  @see vrna_edit_dist_init(), vrna_edit_dist_free(), vrna_tree_edit_distance(),
+ *  vrna_string_edit_distance(), vrna_profile_edit_distance()
+ */
+typedef struct vrna_edit_dist_s vrna_edit_dist_t;
+
+
+/**
+ *  @brief  Option flag for vrna_edit_dist_init() to use the default cost matrix
+ */
+#define VRNA_EDIT_DIST_DEFAULT    0U
+
+/**
+ *  @brief  Option flag for vrna_edit_dist_init() to use Shapiro's cost matrix
+ */
+#define VRNA_EDIT_DIST_SHAPIRO    1U
+
+/**
+ *  @brief  Option flag for vrna_edit_dist_init() to produce an alignment of the compared objects
+ *
+ *  @see vrna_edit_dist_aligned_line()
+ */
+#define VRNA_EDIT_DIST_BACKTRACK  2U
+
+
+/**
+ *  @brief  Object type flag for vrna_edit_dist_matrix() indicating trees, see make_tree()
+ */
+#define VRNA_EDIT_DIST_TREE       1U
+
+/**
+ *  @brief  Object type flag for vrna_edit_dist_matrix() indicating strings, see Make_swString()
+ */
+#define VRNA_EDIT_DIST_STRING     2U
+
+/**
+ *  @brief  Object type flag for vrna_edit_dist_matrix() indicating base pair probability profiles, see Make_bp_profile_bppm()
+ */
+#define VRNA_EDIT_DIST_PROFILE    3U
+
+
+/**
+ *  @brief  Create a workspace for edit distance computations
+ *
+ *  @see  vrna_edit_dist_free(), #VRNA_EDIT_DIST_DEFAULT, #VRNA_EDIT_DIST_SHAPIRO,
+ *        #VRNA_EDIT_DIST_BACKTRACK
+ *
+ *  @param  options   Bit-wise OR of options
+ *  @return           A new workspace
+ */
+vrna_edit_dist_t *
+vrna_edit_dist_init(unsigned int options);
+
+
+/**
+ *  @brief  Release memory occupied by an edit distance workspace
+ *
+ *  @param  ctx   The workspace
+ */
+void
+vrna_edit_dist_free(vrna_edit_dist_t *ctx);
+
+
+/**
+ *  @brief  Get one line of the alignment of the last comparison
+ *
+ *  The alignment is only available if the workspace has been created with
+ *  #VRNA_EDIT_DIST_BACKTRACK.
+ *
+ *  @param  ctx   The workspace
+ *  @param  k     The line of the alignment (0 or 1)
+ *  @return       The aligned representation of the first (@p k = 0) or second (@p k = 1) object, or @p NULL
+ */
+const char *
+vrna_edit_dist_aligned_line(const vrna_edit_dist_t  *ctx,
+                            unsigned int            k);
+
+
+/**
+ *  @brief  Compute the tree edit distance of two trees
+ *
+ *  @see make_tree(), tree_edit_distance()
+ *
+ *  @param  ctx   The workspace
+ *  @param  T1    The first tree
+ *  @param  T2    The second tree
+ *  @return       The tree edit distance of @p T1 and @p T2
+ */
+float
+vrna_tree_edit_distance(vrna_edit_dist_t  *ctx,
+                        const Tree        *T1,
+                        const Tree        *T2);
+
+
+/**
+ *  @brief  Compute the string edit distance of two structures in string alignment representation
+ *
+ *  @see Make_swString(), string_edit_distance()
+ *
+ *  @param  ctx   The workspace
+ *  @param  T1    The first string
+ *  @param  T2    The second string
+ *  @return       The string edit distance of @p T1 and @p T2
+ */
+float
+vrna_string_edit_distance(vrna_edit_dist_t  *ctx,
+                          const swString    *T1,
+                          const swString    *T2);
+
+
+/**
+ *  @brief  Compute the alignment distance of two base pair probability profiles
+ *
+ *  The cost matrix options of the workspace are ignored.
+ *
+ *  @see Make_bp_profile_bppm(), profile_edit_distance()
+ *
+ *  @param  ctx   The workspace
+ *  @param  T1    The first profile
+ *  @param  T2    The second profile
+ *  @return       The alignment distance of @p T1 and @p T2
+ */
+float
+vrna_profile_edit_distance(vrna_edit_dist_t *ctx,
+                           const float      *T1,
+                           const float      *T2);
+
+
+/**
+ *  @brief  Compute all pairwise edit distances of a set of objects
+ *
+ *  The lower triangle of the distance matrix is split into square tiles that are
+ *  processed in parallel, each thread using its own workspace. Within a tile,
+ *  only a small number of objects is accessed repeatedly, which keeps them in
+ *  the processor caches. Backtracking is not available for this function, i.e.
+ *  #VRNA_EDIT_DIST_BACKTRACK is ignored.
+ *
+ *  @see vrna_dist_mx_init(), vrna_dist_mx_free(), #VRNA_EDIT_DIST_TREE,
+ *  #VRNA_EDIT_DIST_STRING, #VRNA_EDIT_DIST_PROFILE
+ *
+ *  @param  objects     The objects to compare, i.e. trees, strings, or profiles
+ *  @param  num         The number of objects
+ *  @param  type        The type of the objects
+ *  @param  options     Options for the workspaces, see vrna_edit_dist_init()
+ *  @param  num_threads The number of threads to use (0 for the default number)
+ *  @param  filename    The name of a file that stores the distances (may be @p NULL), see vrna_dist_mx_init()
+ *  @return             The triangular distance matrix, or @p NULL on any error
+ */
+vrna_dist_mx_t *
+vrna_edit_dist_matrix(const void    **objects,
+                      unsigned int  num,
+                      unsigned int  type,
+                      unsigned int  options,
+                      unsigned int  num_threads,
+                      const char    *filename);
+
+
+/**
+ *  @brief  Compute all pairwise edit distances of a set of objects row by row
+ *
+ *  Same as vrna_edit_dist_matrix() but instead of storing the entire matrix,
+ *  the rows are computed in bands of a few rows that are passed to the callback
+ *  @p cb in increasing order and discarded afterwards. Hence, the memory required
+ *  only grows linearly with the number of objects, which allows for printing
+ *  distance matrices of many objects.
+ *
+ *  @see vrna_edit_dist_matrix(), #vrna_dist_mx_row_f
+ *
+ *  @param  objects     The objects to compare, i.e. trees, strings, or profiles
+ *  @param  num         The number of objects
+ *  @param  type        The type of the objects
+ *  @param  options     Options for the workspaces, see vrna_edit_dist_init()
+ *  @param  num_threads The number of threads to use (0 for the default number)
+ *  @param  cb          The callback that receives the rows of the matrix
+ *  @param  data        Auxiliary data passed through to @p cb
+ *  @return             1 on success, 0 on any error
+ */
+int
+vrna_edit_dist_matrix_cb(const void         **objects,
+                         unsigned int       num,
+                         unsigned int       type,
+                         unsigned int       options,
+                         unsigned int       num_threads,
+                         vrna_dist_mx_row_f cb,
+                         void               *data);
+
+
+/* End metrics interface */
+/** @} */
+
+#endif
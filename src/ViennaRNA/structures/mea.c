@@ -122,8 +122,8 @@ vrna_MEA(vrna_fold_compound_t *fc,
   if ((fc) &&
       (mea) &&
       (fc->exp_params) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->probs)) {
+      ((fc->beam_probs) ||
+       ((fc->exp_matrices) && (fc->exp_matrices->probs)))) {
     structure = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
     pl        = vrna_plist_from_probs(fc, 1e-4 / (1 + gamma));
 
@@ -176,7 +176,7 @@ vrna_MEA_from_plist(vrna_ep_t   *plist,
                        structure);
 
     vrna_fold_compound_free(fc);
-    free(exp_params);
+    vrna_exp_params_free(exp_params);
   }
 
   return structure;
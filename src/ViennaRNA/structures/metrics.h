@@ -13,6 +13,8 @@
 # define DEPRECATED(func, msg) func
 #endif
 
+#include <stddef.h>
+
 /**
  *  @file     ViennaRNA/structures/metrics.h
  *  @ingroup  struct_utils
@@ -66,6 +68,265 @@ vrna_dist_mountain(const char   *str1,
                    unsigned int p);
 
 
+/**
+ *  @brief  A compact triangular matrix of pairwise distances
+ *
+ *  Distances between @p num objects are symmetric and vanish on the diagonal.
+ *  Thus, only the strict lower triangle is stored row-wise in a single array of
+ *  @f$ num \cdot (num - 1) / 2 @f$ floats. The distance between the (0-based)
+ *  objects @f$ i > j @f$ is found at position #VRNA_DIST_MX_IDX(i, j), which
+ *  corresponds to the order in which the lower triangle of a distance matrix is
+ *  printed by our programs.
+ *
+ *  @see vrna_dist_mx_init(), vrna_dist_mx_get(), vrna_dist_mx_free()
+ */
+typedef struct vrna_dist_mx_s vrna_dist_mx_t;
+
+
+/**
+ *  @brief  Position of the distance between objects @p i and @p j (0-based, @f$ i > j @f$) in a #vrna_dist_mx_t
+ */
+#define VRNA_DIST_MX_IDX(i, j)  ((size_t)(i) * ((size_t)(i) - 1) / 2 + (size_t)(j))
+
+
+/**
+ *  @brief  A compact triangular matrix of pairwise distances
+ */
+struct vrna_dist_mx_s {
+  unsigned int  num;    /**<  @brief  Number of objects */
+  size_t        size;   /**<  @brief  Number of entries in @p data */
+  float         *data;  /**<  @brief  Strict lower triangle in row-wise order */
+  int           mapped; /**<  @brief  Whether @p data is a memory-mapped file */
+};
+
+
+/**
+ *  @brief  Create a triangular distance matrix for @p num objects
+ *
+ *  If @p filename is not @p NULL, the matrix is backed by a memory-mapped file of
+ *  that name. The file is created or truncated and simply consists of the raw
+ *  entries of the matrix in row-wise order. This allows for distance matrices
+ *  that exceed the available memory and makes the result directly available for
+ *  downstream processing, e.g. clustering, once the matrix is released via
+ *  vrna_dist_mx_free(). On platforms without memory-mapped files, the matrix is
+ *  held in memory instead.
+ *
+ *  @see vrna_dist_mx_free(), vrna_dist_mx_get()
+ *
+ *  @param  num       The number of objects
+ *  @param  filename  The name of the backing file (may be @p NULL)
+ *  @return           An initialized distance matrix with all entries set to 0, or @p NULL on any error
+ */
+vrna_dist_mx_t *
+vrna_dist_mx_init(unsigned int  num,
+                  const char    *filename);
+
+
+/**
+ *  @brief  Get the distance between two objects from a triangular distance matrix
+ *
+ *  @param  mx  The distance matrix
+ *  @param  i   The first object (0-based)
+ *  @param  j   The second object (0-based)
+ *  @return     The distance between objects @p i and @p j
+ */
+float
+vrna_dist_mx_get(const vrna_dist_mx_t *mx,
+                 unsigned int         i,
+                 unsigned int         j);
+
+
+/**
+ *  @brief  Release memory occupied by a triangular distance matrix
+ *
+ *  For file-backed matrices, this flushes the data to disk and unmaps the file.
+ *
+ *  @param  mx  The distance matrix
+ */
+void
+vrna_dist_mx_free(vrna_dist_mx_t *mx);
+
+
+/**
+ *  @brief  Callback that receives a single row of a triangular distance matrix
+ *
+ *  Row-wise distance matrix computations, e.g. vrna_edit_dist_matrix_cb(), call
+ *  this function for each object @f$ i > 0 @f$ in increasing order. The @p row
+ *  is only valid until the callback returns.
+ *
+ *  @param  i     The (0-based) object the row belongs to
+ *  @param  row   The distances between object @p i and the objects @f$ 0, \ldots, i - 1 @f$
+ *  @param  data  Auxiliary data
+ */
+typedef void (*vrna_dist_mx_row_f)(unsigned int i,
+                                   const float  *row,
+                                   void         *data);
+
+
+/**
+ *  @brief  A set of secondary structures in packed bitset representation
+ *
+ *  All distinct base pairs that occur in at least one structure of the set
+ *  form the pair universe of the set. Each structure is then stored as a
+ *  bitset over this universe with one bit per base pair. The base pair
+ *  distance of two structures of the set is simply the number of bits set in
+ *  the exclusive-or of their bitsets, which is evaluated word-wise with
+ *  vectorized population count kernels, see vrna_fun_xor_popcount().
+ *
+ *  For structure ensembles, e.g. stochastically sampled structures, the pair
+ *  universe is usually small compared to the sequence length, such that each
+ *  structure occupies only a few machine words.
+ *
+ *  @see vrna_bp_set(), vrna_bp_set_pt(), vrna_bp_set_free(),
+ *  vrna_bp_set_distance(), vrna_bp_set_distance_matrix()
+ */
+typedef struct vrna_bp_set_s vrna_bp_set_t;
+
+
+/**
+ *  @brief  Create a packed set of secondary structures from dot-bracket strings
+ *
+ *  @see vrna_bp_set_pt(), vrna_bp_set_free()
+ *
+ *  @param  structures  The structures in dot-bracket notation, all of the same length
+ *  @param  num         The number of structures
+ *  @return             The packed structure set, or @p NULL on any error
+ */
+vrna_bp_set_t *
+vrna_bp_set(const char    **structures,
+            unsigned int  num);
+
+
+/**
+ *  @brief  Create a packed set of secondary structures from pair tables
+ *
+ *  @see vrna_bp_set(), vrna_bp_set_free()
+ *
+ *  @param  pts   The pair tables of the structures, all of the same length
+ *  @param  num   The number of structures
+ *  @return       The packed structure set, or @p NULL on any error
+ */
+vrna_bp_set_t *
+vrna_bp_set_pt(const short  **pts,
+               unsigned int num);
+
+
+/**
+ *  @brief  Release memory occupied by a packed set of secondary structures
+ *
+ *  @param  set   The packed structure set
+ */
+void
+vrna_bp_set_free(vrna_bp_set_t *set);
+
+
+/**
+ *  @brief  Get the number of structures in a packed structure set
+ *
+ *  @param  set   The packed structure set
+ *  @return       The number of structures
+ */
+unsigned int
+vrna_bp_set_size(const vrna_bp_set_t *set);
+
+
+/**
+ *  @brief  Compute the base pair distance between two structures of a packed structure set
+ *
+ *  @see vrna_bp_distance_pt()
+ *
+ *  @param  set   The packed structure set
+ *  @param  i     The first structure (0-based)
+ *  @param  j     The second structure (0-based)
+ *  @return       The base pair distance between structures @p i and @p j, or -1 on any error
+ */
+int
+vrna_bp_set_distance(const vrna_bp_set_t  *set,
+                     unsigned int         i,
+                     unsigned int         j);
+
+
+/**
+ *  @brief  Compute the base pair distances between a reference structure and all structures of a packed structure set
+ *
+ *  The reference structure need not be part of the set. Its base pairs that
+ *  are not contained in the pair universe of the set simply add to all
+ *  distances.
+ *
+ *  @see vrna_bp_distance_pt()
+ *
+ *  @param  set   The packed structure set
+ *  @param  pt    The pair table of the reference structure
+ *  @return       An array of the distances between @p pt and each structure of the set, or @p NULL on any error
+ */
+int *
+vrna_bp_set_distances(const vrna_bp_set_t *set,
+                      const short         *pt);
+
+
+/**
+ *  @brief  Compute all pairwise base pair distances of a packed structure set
+ *
+ *  Like vrna_edit_dist_matrix(), the lower triangle of the distance matrix is
+ *  split into square tiles that are processed in parallel.
+ *
+ *  @see vrna_bp_distance_matrix(), vrna_dist_mx_init(), vrna_dist_mx_free()
+ *
+ *  @param  set         The packed structure set
+ *  @param  num_threads The number of threads to use (0 for the default number)
+ *  @param  filename    The name of a file that stores the distances (may be @p NULL), see vrna_dist_mx_init()
+ *  @return             The triangular distance matrix, or @p NULL on any error
+ */
+vrna_dist_mx_t *
+vrna_bp_set_distance_matrix(const vrna_bp_set_t *set,
+                            unsigned int        num_threads,
+                            const char          *filename);
+
+
+/**
+ *  @brief  Compute all pairwise base pair distances of a list of secondary structures
+ *
+ *  This is a convenience wrapper that packs the structures into a
+ *  #vrna_bp_set_t and calls vrna_bp_set_distance_matrix().
+ *
+ *  @see vrna_bp_set_distance_matrix(), vrna_bp_distance()
+ *
+ *  @param  structures  The structures in dot-bracket notation, all of the same length
+ *  @param  num         The number of structures
+ *  @param  num_threads The number of threads to use (0 for the default number)
+ *  @param  filename    The name of a file that stores the distances (may be @p NULL), see vrna_dist_mx_init()
+ *  @return             The triangular distance matrix, or @p NULL on any error
+ */
+vrna_dist_mx_t *
+vrna_bp_distance_matrix(const char    **structures,
+                        unsigned int  num,
+                        unsigned int  num_threads,
+                        const char    *filename);
+
+
+/**
+ *  @brief  Compute all pairwise base pair distances of a packed structure set row by row
+ *
+ *  Same as vrna_bp_set_distance_matrix() but instead of storing the entire matrix,
+ *  the rows are computed in bands of a few rows that are passed to the callback
+ *  @p cb in increasing order and discarded afterwards. Hence, the memory required
+ *  only grows linearly with the number of structures.
+ *
+ *  @see vrna_bp_set_distance_matrix(), #vrna_dist_mx_row_f
+ *
+ *  @param  set         The packed structure set
+ *  @param  num_threads The number of threads to use (0 for the default number)
+ *  @param  cb          The callback that receives the rows of the matrix
+ *  @param  data        Auxiliary data passed through to @p cb
+ *  @return             1 on success, 0 on any error
+ */
+int
+vrna_bp_set_distance_matrix_cb(const vrna_bp_set_t  *set,
+                               unsigned int         num_threads,
+                               vrna_dist_mx_row_f   cb,
+                               void                 *data);
+
+
 /* End metrics interface */
 /** @} */
 
@@ -48,6 +48,11 @@ assign_elements_pair(short  *pt,
                      char   *elements);
 
 
+PRIVATE char *
+pairing_tendency_plist(const vrna_ep_t  *pl,
+                       unsigned int     n);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -440,8 +445,12 @@ vrna_pairing_tendency(vrna_fold_compound_t *fc)
   s = NULL;
 
   if ((fc) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->probs)) {
+      (fc->beam_probs)) {
+    n = fc->length;
+    s = pairing_tendency_plist(fc->beam_probs, n);
+  } else if ((fc) &&
+             (fc->exp_matrices) &&
+             (fc->exp_matrices->probs)) {
     n   = fc->length;
     idx = fc->iindx;
     p   = fc->exp_matrices->probs;
@@ -1008,6 +1017,39 @@ assign_elements_pair(short  *pt,
 }
 
 
+PRIVATE char *
+pairing_tendency_plist(const vrna_ep_t  *pl,
+                       unsigned int     n)
+{
+  unsigned int    i;
+  char            *s;
+  float           *P;
+  const vrna_ep_t *ptr;
+
+  s = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  P = (float *)vrna_alloc(sizeof(float) * 3 * (n + 1));
+
+  for (i = 1; i <= n; i++)
+    P[3 * i] = 1.0;
+
+  for (ptr = pl; ptr->i > 0; ptr++) {
+    P[3 * ptr->i + 1] += ptr->p;  /* i is paired upstream */
+    P[3 * ptr->i]     -= ptr->p;
+    P[3 * ptr->j + 2] += ptr->p;  /* j is paired downstream */
+    P[3 * ptr->j]     -= ptr->p;
+  }
+
+  for (i = 1; i <= n; i++)
+    s[i - 1] = vrna_bpp_symbol(P + 3 * i);
+
+  s[n] = '\0';
+
+  free(P);
+
+  return s;
+}
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /*
@@ -0,0 +1,322 @@
+/*
+ *  ViennaRNA/structures/structure_edit_distance.c
+ *
+ *  Workspaces for reentrant edit distance computations and
+ *  all-vs-all edit distance matrices
+ *
+ *              Vienna RNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/structures/metrics.h"
+#include "ViennaRNA/structures/edit_distance.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/edit_distance_dat.h"
+
+#define EDIT_DIST_TILE  64  /* number of objects per row/column of a tile */
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+typedef float (*edit_dist_f)(vrna_edit_dist_t *,
+                             const void *,
+                             const void *);
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE float
+dist_tree(vrna_edit_dist_t  *ctx,
+          const void        *a,
+          const void        *b);
+
+
+PRIVATE float
+dist_string(vrna_edit_dist_t  *ctx,
+            const void        *a,
+            const void        *b);
+
+
+PRIVATE float
+dist_profile(vrna_edit_dist_t *ctx,
+             const void       *a,
+             const void       *b);
+
+
+PRIVATE void
+fill_tile(vrna_edit_dist_t  *ctx,
+          edit_dist_f       f,
+          const void        **objects,
+          unsigned int      num,
+          unsigned int      bi,
+          unsigned int      bj,
+          float             *data,
+          size_t            offset);
+
+
+PRIVATE edit_dist_f
+get_dist_function(unsigned int type);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_edit_dist_t *
+vrna_edit_dist_init(unsigned int options)
+{
+  vrna_edit_dist_t *ctx;
+
+  ctx           = (vrna_edit_dist_t *)vrna_alloc(sizeof(vrna_edit_dist_t));
+  ctx->options  = options;
+
+  return ctx;
+}
+
+
+PUBLIC void
+vrna_edit_dist_free(vrna_edit_dist_t *ctx)
+{
+  if (ctx) {
+    free(ctx->ibuf);
+    free(ctx->rows);
+    free(ctx->fbuf);
+    free(ctx->sbuf);
+    free(ctx->aligned_line[0]);
+    free(ctx->aligned_line[1]);
+    free(ctx);
+  }
+}
+
+
+PUBLIC const char *
+vrna_edit_dist_aligned_line(const vrna_edit_dist_t  *ctx,
+                            unsigned int            k)
+{
+  if ((ctx) && (k < 2))
+    return ctx->aligned_line[k];
+
+  return NULL;
+}
+
+
+PUBLIC vrna_dist_mx_t *
+vrna_edit_dist_matrix(const void    **objects,
+                      unsigned int  num,
+                      unsigned int  type,
+                      unsigned int  options,
+                      unsigned int  num_threads,
+                      const char    *filename)
+{
+  unsigned int    i, j, blocks, *tiles;
+  long            t, num_tiles;
+  edit_dist_f     f;
+  vrna_dist_mx_t  *mx;
+
+  if (!objects)
+    return NULL;
+
+  f = get_dist_function(type);
+  if (!f)
+    return NULL;
+
+  mx = vrna_dist_mx_init(num, filename);
+
+  if ((!mx) || (mx->size == 0))
+    return mx;
+
+  options &= ~VRNA_EDIT_DIST_BACKTRACK;
+
+  /* enumerate all tiles (bi, bj) with bi >= bj of the lower triangle */
+  blocks    = (num + EDIT_DIST_TILE - 1) / EDIT_DIST_TILE;
+  num_tiles = (long)blocks * (long)(blocks + 1) / 2;
+  tiles     = (unsigned int *)vrna_alloc(sizeof(unsigned int) * 2 * num_tiles);
+
+  for (t = 0, i = 0; i < blocks; i++)
+    for (j = 0; j <= i; j++, t++) {
+      tiles[2 * t]      = i;
+      tiles[2 * t + 1]  = j;
+    }
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = (unsigned int)omp_get_max_threads();
+
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+    vrna_edit_dist_t *ctx = vrna_edit_dist_init(options);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (t = 0; t < num_tiles; t++)
+      fill_tile(ctx, f, objects, num, tiles[2 * t], tiles[2 * t + 1], mx->data, 0);
+
+    vrna_edit_dist_free(ctx);
+  }
+
+  free(tiles);
+
+  return mx;
+}
+
+
+PUBLIC int
+vrna_edit_dist_matrix_cb(const void         **objects,
+                         unsigned int       num,
+                         unsigned int       type,
+                         unsigned int       options,
+                         unsigned int       num_threads,
+                         vrna_dist_mx_row_f cb,
+                         void               *data)
+{
+  unsigned int  i, bi, blocks, i_min, i_max;
+  size_t        offset;
+  float         *band;
+  edit_dist_f   f;
+
+  if ((!objects) ||
+      (!cb))
+    return 0;
+
+  f = get_dist_function(type);
+  if (!f)
+    return 0;
+
+  options &= ~VRNA_EDIT_DIST_BACKTRACK;
+
+  /* a band holds all rows of one row of tiles */
+  blocks  = (num + EDIT_DIST_TILE - 1) / EDIT_DIST_TILE;
+  band    = (float *)vrna_alloc(sizeof(float) * ((size_t)EDIT_DIST_TILE * num + 1));
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = (unsigned int)omp_get_max_threads();
+
+#pragma omp parallel private(i, bi, i_min, i_max, offset) num_threads(num_threads)
+#endif
+  {
+    vrna_edit_dist_t *ctx = vrna_edit_dist_init(options);
+
+    for (bi = 0; bi < blocks; bi++) {
+      i_min   = bi * EDIT_DIST_TILE;
+      i_max   = MIN2(num, i_min + EDIT_DIST_TILE);
+      offset  = VRNA_DIST_MX_IDX(i_min, 0);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for (long bj = 0; bj <= (long)bi; bj++)
+        fill_tile(ctx, f, objects, num, bi, (unsigned int)bj, band, offset);
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+      for (i = MAX2(1, i_min); i < i_max; i++)
+        cb(i, band + VRNA_DIST_MX_IDX(i, 0) - offset, data);
+    }
+
+    vrna_edit_dist_free(ctx);
+  }
+
+  free(band);
+
+  return 1;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE edit_dist_f
+get_dist_function(unsigned int type)
+{
+  switch (type) {
+    case VRNA_EDIT_DIST_TREE:
+      return &dist_tree;
+    case VRNA_EDIT_DIST_STRING:
+      return &dist_string;
+    case VRNA_EDIT_DIST_PROFILE:
+      return &dist_profile;
+    default:
+      vrna_log_warning("vrna_edit_dist_matrix*: Unknown object type %u", type);
+      return NULL;
+  }
+}
+
+
+PRIVATE float
+dist_tree(vrna_edit_dist_t  *ctx,
+          const void        *a,
+          const void        *b)
+{
+  return vrna_tree_edit_distance(ctx, (const Tree *)a, (const Tree *)b);
+}
+
+
+PRIVATE float
+dist_string(vrna_edit_dist_t  *ctx,
+            const void        *a,
+            const void        *b)
+{
+  return vrna_string_edit_distance(ctx, (const swString *)a, (const swString *)b);
+}
+
+
+PRIVATE float
+dist_profile(vrna_edit_dist_t *ctx,
+             const void       *a,
+             const void       *b)
+{
+  return vrna_profile_edit_distance(ctx, (const float *)a, (const float *)b);
+}
+
+
+PRIVATE void
+fill_tile(vrna_edit_dist_t  *ctx,
+          edit_dist_f       f,
+          const void        **objects,
+          unsigned int      num,
+          unsigned int      bi,
+          unsigned int      bj,
+          float             *data,
+          size_t            offset)
+{
+  unsigned int  i, j, i_min, i_max, j_min, j_max;
+
+  i_min = bi * EDIT_DIST_TILE;
+  i_max = MIN2(num, i_min + EDIT_DIST_TILE);
+  j_min = bj * EDIT_DIST_TILE;
+  j_max = MIN2(num, j_min + EDIT_DIST_TILE);
+
+  for (i = i_min; i < i_max; i++)
+    for (j = j_min; (j < j_max) && (j < i); j++)
+      data[VRNA_DIST_MX_IDX(i, j) - offset] = f(ctx, objects[i], objects[j]);
+}
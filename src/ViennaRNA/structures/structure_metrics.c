@@ -14,11 +14,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include <limits.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/structures/metrics.h"
 
 #ifdef __GNUC__
@@ -27,11 +40,34 @@
 # define INLINE
 #endif
 
+#define BP_SET_TILE   64  /* number of structures per row/column of a tile */
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+struct vrna_bp_set_s {
+  unsigned int  num;      /* number of structures */
+  unsigned int  length;   /* length of the structures */
+  unsigned int  *first;   /* first[i] .. first[i + 1] - 1 are the indices of all pairs (i, j) */
+  unsigned int  *partner; /* partner j of each pair (i, j) in the pair universe */
+  unsigned int  words;    /* number of 64-bit words per structure */
+  uint64_t      *bits;    /* bitsets of all structures, one after another */
+};
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE void
+bp_set_fill_tile(const vrna_bp_set_t  *set,
+                 unsigned int         bi,
+                 unsigned int         bj,
+                 float                *data,
+                 size_t               offset);
+
 
 
 /*
@@ -156,6 +192,432 @@ vrna_dist_mountain(const char   *str1,
 }
 
 
+PUBLIC vrna_dist_mx_t *
+vrna_dist_mx_init(unsigned int  num,
+                  const char    *filename)
+{
+  vrna_dist_mx_t  *mx;
+
+  mx          = (vrna_dist_mx_t *)vrna_alloc(sizeof(vrna_dist_mx_t));
+  mx->num     = num;
+  mx->size    = (num > 1) ? VRNA_DIST_MX_IDX(num, 0) : 0;
+  mx->data    = NULL;
+  mx->mapped  = 0;
+
+  if ((filename) && (mx->size > 0)) {
+#ifndef _WIN32
+    int   fd;
+    void  *ptr;
+
+    fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+      vrna_log_warning("vrna_dist_mx_init: Failed to open file \"%s\"", filename);
+      free(mx);
+      return NULL;
+    }
+
+    if (ftruncate(fd, (off_t)(sizeof(float) * mx->size)) != 0) {
+      vrna_log_warning("vrna_dist_mx_init: Failed to resize file \"%s\"", filename);
+      close(fd);
+      free(mx);
+      return NULL;
+    }
+
+    ptr = mmap(NULL,
+               sizeof(float) * mx->size,
+               PROT_READ | PROT_WRITE,
+               MAP_SHARED,
+               fd,
+               0);
+    close(fd);
+
+    if (ptr == MAP_FAILED) {
+      vrna_log_warning("vrna_dist_mx_init: Failed to map file \"%s\" into memory", filename);
+      free(mx);
+      return NULL;
+    }
+
+    mx->data    = (float *)ptr;
+    mx->mapped  = 1;
+
+    return mx;
+#else
+    vrna_log_warning("vrna_dist_mx_init: "
+                     "Memory-mapped files are not supported on this platform, "
+                     "keeping distance matrix in memory");
+#endif
+  }
+
+  if (mx->size > 0)
+    mx->data = (float *)vrna_alloc(sizeof(float) * mx->size);
+
+  return mx;
+}
+
+
+PUBLIC float
+vrna_dist_mx_get(const vrna_dist_mx_t *mx,
+                 unsigned int         i,
+                 unsigned int         j)
+{
+  if ((mx) &&
+      (i < mx->num) &&
+      (j < mx->num) &&
+      (i != j))
+    return (i > j) ? mx->data[VRNA_DIST_MX_IDX(i, j)] : mx->data[VRNA_DIST_MX_IDX(j, i)];
+
+  return 0.;
+}
+
+
+PUBLIC void
+vrna_dist_mx_free(vrna_dist_mx_t *mx)
+{
+  if (mx) {
+    if (mx->mapped) {
+#ifndef _WIN32
+      munmap(mx->data, sizeof(float) * mx->size);
+#endif
+    } else {
+      free(mx->data);
+    }
+
+    free(mx);
+  }
+}
+
+
+PUBLIC vrna_bp_set_t *
+vrna_bp_set(const char    **structures,
+            unsigned int  num)
+{
+  unsigned int  k;
+  short         **pts;
+  vrna_bp_set_t *set;
+
+  if (!structures)
+    return NULL;
+
+  pts = (short **)vrna_alloc(sizeof(short *) * (num + 1));
+
+  for (k = 0; k < num; k++) {
+    if (!structures[k]) {
+      vrna_log_warning("vrna_bp_set: Missing structure %u", k);
+      break;
+    }
+
+    pts[k] = vrna_ptable(structures[k]);
+  }
+
+  set = (k == num) ? vrna_bp_set_pt((const short **)pts, num) : NULL;
+
+  while (k > 0)
+    free(pts[--k]);
+
+  free(pts);
+
+  return set;
+}
+
+
+PUBLIC vrna_bp_set_t *
+vrna_bp_set_pt(const short  **pts,
+               unsigned int num)
+{
+  unsigned int  i, j, k, n, p, size, *stamp;
+  uint64_t      *b;
+  vrna_bp_set_t *set;
+
+  if (!pts)
+    return NULL;
+
+  n = (num > 0) ? (unsigned int)pts[0][0] : 0;
+
+  for (k = 1; k < num; k++)
+    if ((unsigned int)pts[k][0] != n) {
+      vrna_log_warning("vrna_bp_set_pt: Structures have unequal lengths");
+      return NULL;
+    }
+
+  set           = (vrna_bp_set_t *)vrna_alloc(sizeof(vrna_bp_set_t));
+  set->num      = num;
+  set->length   = n;
+  set->first    = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (n + 2));
+  size          = n + 1;
+  set->partner  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * size);
+  stamp         = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (n + 1));
+
+  /*
+   *  collect the pair universe, ordered by the 5' position of the pairs.
+   *  stamp[j] == i marks (i, j) as already known
+   */
+  for (p = 0, i = 1; i <= n; i++) {
+    set->first[i] = p;
+    for (k = 0; k < num; k++) {
+      j = (unsigned int)pts[k][i];
+      if ((j > i) && (stamp[j] != i)) {
+        stamp[j] = i;
+        if (p == size) {
+          size          *= 2;
+          set->partner  = (unsigned int *)vrna_realloc(set->partner, sizeof(unsigned int) * size);
+        }
+
+        set->partner[p++] = j;
+      }
+    }
+  }
+
+  set->first[0]     = 0;
+  set->first[n + 1] = p;
+  set->partner      = (unsigned int *)vrna_realloc(set->partner, sizeof(unsigned int) * (p + 1));
+  set->words        = (p + 63) / 64;
+  set->bits         = (uint64_t *)vrna_alloc(sizeof(uint64_t) * ((size_t)set->words * num + 1));
+
+  /* re-use stamp as map j -> index of pair (i, j) */
+  for (i = 1; i <= n; i++) {
+    for (p = set->first[i]; p < set->first[i + 1]; p++)
+      stamp[set->partner[p]] = p;
+
+    for (k = 0; k < num; k++) {
+      j = (unsigned int)pts[k][i];
+      if (j > i) {
+        p     = stamp[j];
+        b     = set->bits + (size_t)set->words * k;
+        b[p / 64] |= (uint64_t)1 << (p % 64);
+      }
+    }
+  }
+
+  free(stamp);
+
+  return set;
+}
+
+
+PUBLIC void
+vrna_bp_set_free(vrna_bp_set_t *set)
+{
+  if (set) {
+    free(set->first);
+    free(set->partner);
+    free(set->bits);
+    free(set);
+  }
+}
+
+
+PUBLIC unsigned int
+vrna_bp_set_size(const vrna_bp_set_t *set)
+{
+  return (set) ? set->num : 0;
+}
+
+
+PUBLIC int
+vrna_bp_set_distance(const vrna_bp_set_t  *set,
+                     unsigned int         i,
+                     unsigned int         j)
+{
+  if ((!set) ||
+      (i >= set->num) ||
+      (j >= set->num))
+    return -1;
+
+  return (int)vrna_fun_xor_popcount(set->bits + (size_t)set->words * i,
+                                    set->bits + (size_t)set->words * j,
+                                    set->words);
+}
+
+
+PUBLIC int *
+vrna_bp_set_distances(const vrna_bp_set_t *set,
+                      const short         *pt)
+{
+  unsigned int  i, j, k, n, p, extra;
+  int           *d;
+  uint64_t      *ref;
+
+  if ((!set) ||
+      (!pt))
+    return NULL;
+
+  n = MIN2(set->length, (unsigned int)pt[0]);
+
+  /* pack the reference, counting its pairs outside of the pair universe separately */
+  ref   = (uint64_t *)vrna_alloc(sizeof(uint64_t) * (set->words + 1));
+  extra = 0;
+
+  for (i = 1; i <= n; i++) {
+    j = (unsigned int)pt[i];
+    if (j <= i)
+      continue;
+
+    for (p = set->first[i]; p < set->first[i + 1]; p++)
+      if (set->partner[p] == j)
+        break;
+
+    if (p < set->first[i + 1])
+      ref[p / 64] |= (uint64_t)1 << (p % 64);
+    else
+      extra++;
+  }
+
+  d = (int *)vrna_alloc(sizeof(int) * (set->num + 1));
+
+  for (k = 0; k < set->num; k++)
+    d[k] = (int)(extra +
+                 vrna_fun_xor_popcount(set->bits + (size_t)set->words * k,
+                                       ref,
+                                       set->words));
+
+  free(ref);
+
+  return d;
+}
+
+
+PUBLIC vrna_dist_mx_t *
+vrna_bp_set_distance_matrix(const vrna_bp_set_t *set,
+                            unsigned int        num_threads,
+                            const char          *filename)
+{
+  unsigned int    i, j, blocks, *tiles;
+  long            t, num_tiles;
+  vrna_dist_mx_t  *mx;
+
+  if (!set)
+    return NULL;
+
+  mx = vrna_dist_mx_init(set->num, filename);
+
+  if ((!mx) || (mx->size == 0))
+    return mx;
+
+  /* enumerate all tiles (bi, bj) with bi >= bj of the lower triangle */
+  blocks    = (set->num + BP_SET_TILE - 1) / BP_SET_TILE;
+  num_tiles = (long)blocks * (long)(blocks + 1) / 2;
+  tiles     = (unsigned int *)vrna_alloc(sizeof(unsigned int) * 2 * num_tiles);
+
+  for (t = 0, i = 0; i < blocks; i++)
+    for (j = 0; j <= i; j++, t++) {
+      tiles[2 * t]      = i;
+      tiles[2 * t + 1]  = j;
+    }
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = (unsigned int)omp_get_max_threads();
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+#endif
+  for (t = 0; t < num_tiles; t++)
+    bp_set_fill_tile(set, tiles[2 * t], tiles[2 * t + 1], mx->data, 0);
+
+  free(tiles);
+
+  return mx;
+}
+
+
+PUBLIC int
+vrna_bp_set_distance_matrix_cb(const vrna_bp_set_t  *set,
+                               unsigned int         num_threads,
+                               vrna_dist_mx_row_f   cb,
+                               void                 *data)
+{
+  unsigned int  i, bi, blocks, i_min, i_max;
+  size_t        offset;
+  float         *band;
+
+  if ((!set) ||
+      (!cb))
+    return 0;
+
+  /* a band holds all rows of one row of tiles */
+  blocks  = (set->num + BP_SET_TILE - 1) / BP_SET_TILE;
+  band    = (float *)vrna_alloc(sizeof(float) * ((size_t)BP_SET_TILE * set->num + 1));
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = (unsigned int)omp_get_max_threads();
+
+#pragma omp parallel private(i, bi, i_min, i_max, offset) num_threads(num_threads)
+#endif
+  {
+    for (bi = 0; bi < blocks; bi++) {
+      i_min   = bi * BP_SET_TILE;
+      i_max   = MIN2(set->num, i_min + BP_SET_TILE);
+      offset  = VRNA_DIST_MX_IDX(i_min, 0);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+      for (long bj = 0; bj <= (long)bi; bj++)
+        bp_set_fill_tile(set, bi, (unsigned int)bj, band, offset);
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+      for (i = MAX2(1, i_min); i < i_max; i++)
+        cb(i, band + VRNA_DIST_MX_IDX(i, 0) - offset, data);
+    }
+  }
+
+  free(band);
+
+  return 1;
+}
+
+
+PUBLIC vrna_dist_mx_t *
+vrna_bp_distance_matrix(const char    **structures,
+                        unsigned int  num,
+                        unsigned int  num_threads,
+                        const char    *filename)
+{
+  vrna_bp_set_t   *set;
+  vrna_dist_mx_t  *mx;
+
+  set = vrna_bp_set(structures, num);
+  mx  = vrna_bp_set_distance_matrix(set, num_threads, filename);
+
+  vrna_bp_set_free(set);
+
+  return mx;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+bp_set_fill_tile(const vrna_bp_set_t  *set,
+                 unsigned int         bi,
+                 unsigned int         bj,
+                 float                *data,
+                 size_t               offset)
+{
+  unsigned int  i, j, i_min, i_max, j_min, j_max;
+  uint64_t      *a;
+
+  i_min = bi * BP_SET_TILE;
+  i_max = MIN2(set->num, i_min + BP_SET_TILE);
+  j_min = bj * BP_SET_TILE;
+  j_max = MIN2(set->num, j_min + BP_SET_TILE);
+
+  for (i = i_min; i < i_max; i++) {
+    a = set->bits + (size_t)set->words * i;
+    for (j = j_min; (j < j_max) && (j < i); j++)
+      data[VRNA_DIST_MX_IDX(i, j) - offset] = (float)vrna_fun_xor_popcount(a,
+                                                                  set->bits +
+                                                                  (size_t)set->words * j,
+                                                                  set->words);
+  }
+}
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /*
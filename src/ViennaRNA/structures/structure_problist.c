@@ -49,6 +49,11 @@ wrap_plist(vrna_fold_compound_t *vc,
            double               cut_off);
 
 
+PRIVATE vrna_ep_t *
+wrap_plist_beam(vrna_fold_compound_t  *vc,
+                double                cut_off);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -113,7 +118,9 @@ vrna_plist_from_probs(vrna_fold_compound_t  *vc,
 {
   if (!vc)
     vrna_log_warning("vrna_pl_get_from_pr: run vrna_pf_fold first!");
-  else if (!vc->exp_matrices->probs)
+  else if (vc->beam_probs)
+    return wrap_plist_beam(vc, cut_off);
+  else if ((!vc->exp_matrices) || (!vc->exp_matrices->probs))
     vrna_log_warning("vrna_pl_get_from_pr: probs==NULL!");
   else
     return wrap_plist(vc, cut_off);
@@ -558,7 +565,7 @@ assign_plist_from_pr(vrna_ep_t  **pl,
                        cut_off);
 
   free(index);
-  free(pf_params);
+  vrna_exp_params_free(pf_params);
   free(matrices);
 }
 
@@ -572,3 +579,28 @@ assign_plist_from_db(vrna_ep_t  **pl,
 }
 
 #endif
+
+
+PRIVATE vrna_ep_t *
+wrap_plist_beam(vrna_fold_compound_t  *vc,
+                double                cut_off)
+{
+  unsigned int  k;
+  vrna_ep_t     *ptr, *pl;
+
+  for (k = 0, ptr = vc->beam_probs; ptr->i > 0; ptr++)
+    if (ptr->p >= cut_off)
+      k++;
+
+  pl = (vrna_ep_t *)vrna_alloc(sizeof(vrna_ep_t) * (k + 1));
+
+  for (k = 0, ptr = vc->beam_probs; ptr->i > 0; ptr++)
+    if (ptr->p >= cut_off)
+      pl[k++] = *ptr;
+
+  pl[k].i     = pl[k].j = 0;
+  pl[k].p     = 0.;
+  pl[k].type  = 0;
+
+  return pl;
+}
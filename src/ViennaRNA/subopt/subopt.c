@@ -545,6 +545,13 @@ vrna_subopt_cb(vrna_fold_compound_t *fc,
   int                 *f5;
   constraint_helpers  constraints_dat;
 
+  /* the beam search engine does not provide the DP matrices we backtrack from */
+  if ((fc) &&
+      (fc->engine & VRNA_OPTION_BEAM)) {
+    vrna_log_warning("vrna_subopt*(): Not available for the beam search engine (VRNA_OPTION_BEAM)");
+    return;
+  }
+
   vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE);
 
   length  = fc->length;
@@ -3494,10 +3501,10 @@ wrap_subopt(char          *string,
 
   if (parameters) {
     /* replace params if necessary */
-    free(fc->params);
+    vrna_params_free(fc->params);
     fc->params = P;
   } else {
-    free(P);
+    vrna_params_free(P);
   }
 
   /* handle hard constraints in pseudo dot-bracket format if passed via simple interface */
@@ -123,7 +123,10 @@ vrna_subopt_zuker(vrna_fold_compound_t *fc)
 
   sol = NULL;
 
-  if (fc) {
+  if ((fc) &&
+      (fc->engine & VRNA_OPTION_BEAM)) {
+    vrna_log_warning("vrna_subopt_zuker(): Not available for the beam search engine (VRNA_OPTION_BEAM)");
+  } else if (fc) {
     (void)vrna_mfe(fc, NULL);
 
     n             = fc->length;
@@ -16,12 +16,32 @@
 #include "ViennaRNA/dist_vars.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/log.h"
+#include "ViennaRNA/structures/edit_distance.h"
 
 #define PRIVATE  static
 #define PUBLIC
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#include "ViennaRNA/intern/edit_distance_dat.h"
+
 #define MNODES    4000    /* Maximal number of nodes for alignment    */
 
+struct tree_dat {
+  const Tree  *tree1;
+  const Tree  *tree2;
+  int         **tdist;        /* contains distances between subtrees */
+  int         **fdist;        /* contains distances between forests */
+  int         *alignment[2];  /* contains numeric information on the alignment:
+                               * alignment[0][p], aligment[1][p] are aligned postions.
+                               * INDELs have one 0. */
+  CostMatrix  *cost;
+};
+
 PUBLIC Tree *
 make_tree(char *struc);
 
@@ -40,13 +60,15 @@ free_tree(Tree *t);
 
 
 PRIVATE void
-tree_dist(int i,
-          int j);
+tree_dist(struct tree_dat *d,
+          int             i,
+          int             j);
 
 
 PRIVATE int
-edit_cost(int i,
-          int j);
+edit_cost(struct tree_dat *d,
+          int             i,
+          int             j);
 
 
 PRIVATE int *
@@ -84,99 +106,123 @@ print_postorder_list(Postorder_list *pl);
 
 
 PRIVATE void
-backtracking(void);
+backtracking(struct tree_dat *d);
 
 
 PRIVATE void
-sprint_aligned_trees(void);
+sprint_aligned_trees(vrna_edit_dist_t *ctx,
+                     struct tree_dat  *d);
 
 
-PRIVATE Tree  *tree1, *tree2;
-PRIVATE int   **tdist;        /* contains distances between subtrees */
-PRIVATE int   **fdist;        /* contains distances between forests */
-PRIVATE int   *alignment[2];  /* contains numeric information on the alignment:
-                               * alignment[0][p], aligment[1][p] are aligned postions.
-                               * INDELs have one 0.
-                               * alignment[0][0] contains the length of the alignment. */
-
 /*---------------------------------------------------------------------------*/
 
 PUBLIC float
-tree_edit_distance(Tree *T1,
-                   Tree *T2)
+vrna_tree_edit_distance(vrna_edit_dist_t  *ctx,
+                        const Tree        *T1,
+                        const Tree        *T2)
 {
-  int i1, j1, i, j, dist;
-  int n1, n2;
-
-  if (cost_matrix == 0)
-    EditCost = &UsualCost;
-  else
-    EditCost = &ShapiroCost;
+  int             i1, j1, i, j, dist;
+  int             n1, n2;
+  size_t          cells;
+  struct tree_dat d;
+
+  if ((!ctx) || (!T1) || (!T2))
+    return (float)INF;
+
+  n1    = T1->postorder_list[0].sons;
+  n2    = T2->postorder_list[0].sons;
+  cells = (size_t)(n1 + 1) * (size_t)(n2 + 1);
+
+  if ((ctx->options & VRNA_EDIT_DIST_BACKTRACK) &&
+      ((n1 > MNODES) || (n2 > MNODES))) {
+    vrna_log_error("tree too large for alignment");
+    return (float)INF;
+  }
 
-  n1  = T1->postorder_list[0].sons;
-  n2  = T2->postorder_list[0].sons;
+  /* tdist and fdist share the integer buffer of the workspace */
+  ctx->ibuf = (int *)edit_dist_buffer(ctx->ibuf,
+                                      &(ctx->ibuf_size),
+                                      2 * cells + (size_t)(n1 + n2 + 2),
+                                      sizeof(int));
+  ctx->rows = (int **)edit_dist_buffer(ctx->rows,
+                                       &(ctx->rows_size),
+                                       2 * (size_t)(n1 + 1),
+                                       sizeof(int *));
+
+  memset(ctx->ibuf, 0, sizeof(int) * (2 * cells + (size_t)(n1 + n2 + 2)));
+
+  d.tree1         = T1;
+  d.tree2         = T2;
+  d.tdist         = ctx->rows;
+  d.fdist         = ctx->rows + n1 + 1;
+  d.alignment[0]  = ctx->ibuf + 2 * cells;
+  d.alignment[1]  = d.alignment[0] + n1 + 1;
+  d.cost          = (ctx->options & VRNA_EDIT_DIST_SHAPIRO) ? &ShapiroCost : &UsualCost;
 
-  tdist = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  fdist = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
   for (i = 0; i <= n1; i++) {
-    tdist[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    fdist[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
+    d.tdist[i]  = ctx->ibuf + (size_t)i * (n2 + 1);
+    d.fdist[i]  = ctx->ibuf + cells + (size_t)i * (n2 + 1);
   }
 
-  tree1 = T1;
-  tree2 = T2;
-
   for (i1 = 1; i1 <= T1->keyroots[0]; i1++) {
     i = T1->keyroots[i1];
     for (j1 = 1; j1 <= T2->keyroots[0]; j1++) {
       j = T2->keyroots[j1];
 
-      tree_dist(i, j);
+      tree_dist(&d, i, j);
     }
   }
 
-  if (edit_backtrack) {
-    if ((n1 > MNODES) || (n2 > MNODES)) {
-      vrna_log_error("tree too large for alignment");
-      for (i = 0; i <= n1; i++) {
-        free(tdist[i]);
-        free(fdist[i]);
-      }
-      free(tdist);
-      free(fdist);
-      return (float)INF;
-    }
-
-    alignment[0]  = (int *)vrna_alloc((n1 + 1) * sizeof(int));
-    alignment[1]  = (int *)vrna_alloc((n2 + 1) * sizeof(int));
-
-    backtracking();
-    sprint_aligned_trees();
-    free(alignment[0]);
-    free(alignment[1]);
+  if (ctx->options & VRNA_EDIT_DIST_BACKTRACK) {
+    backtracking(&d);
+    sprint_aligned_trees(ctx, &d);
   }
 
-  dist = tdist[n1][n2];
-  for (i = 0; i <= n1; i++) {
-    free(tdist[i]);
-    free(fdist[i]);
-  }
-  free(tdist);
-  free(fdist);
+  dist = d.tdist[n1][n2];
 
   return (float)dist;
 }
 
 
+PUBLIC float
+tree_edit_distance(Tree *T1,
+                   Tree *T2)
+{
+  float             dist;
+  vrna_edit_dist_t  *ctx;
+
+  ctx = vrna_edit_dist_init(((cost_matrix) ? VRNA_EDIT_DIST_SHAPIRO : VRNA_EDIT_DIST_DEFAULT) |
+                            ((edit_backtrack) ? VRNA_EDIT_DIST_BACKTRACK : 0));
+
+  dist = vrna_tree_edit_distance(ctx, T1, T2);
+
+  if (edit_backtrack)
+    edit_dist_export_aligned_lines(ctx);
+
+  vrna_edit_dist_free(ctx);
+
+  return dist;
+}
+
+
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-tree_dist(int i,
-          int j)
+tree_dist(struct tree_dat *d,
+          int             i,
+          int             j)
 {
+  int         **fdist, **tdist;
+  const Tree  *tree1, *tree2;
+
   int li, lj, i1, j1, i1_1, j1_1, li1_1, lj1_1, f1, f2, f3, f;
   int cost, lleaf_i1, lleaf_j1;
 
+  fdist = d->fdist;
+  tdist = d->tdist;
+  tree1 = d->tree1;
+  tree2 = d->tree2;
+
   fdist[0][0] = 0;
 
   li  = tree1->postorder_list[i].leftmostleaf;
@@ -184,31 +230,31 @@ tree_dist(int i,
 
   for (i1 = li; i1 <= i; i1++) {
     i1_1          = (li == i1 ? 0 : i1 - 1);
-    fdist[i1][0]  = fdist[i1_1][0] + edit_cost(i1, 0);
+    fdist[i1][0]  = fdist[i1_1][0] + edit_cost(d, i1, 0);
   }
 
   for (j1 = lj; j1 <= j; j1++) {
     j1_1          = (lj == j1 ? 0 : j1 - 1);
-    fdist[0][j1]  = fdist[0][j1_1] + edit_cost(0, j1);
+    fdist[0][j1]  = fdist[0][j1_1] + edit_cost(d, 0, j1);
   }
 
   for (i1 = li; i1 <= i; i1++) {
     lleaf_i1  = tree1->postorder_list[i1].leftmostleaf;
     li1_1     = (li > lleaf_i1 - 1 ? 0 : lleaf_i1 - 1);
     i1_1      = (i1 == li ? 0 : i1 - 1);
-    cost      = edit_cost(i1, 0);
+    cost      = edit_cost(d, i1, 0);
 
     for (j1 = lj; j1 <= j; j1++) {
       lleaf_j1  = tree2->postorder_list[j1].leftmostleaf;
       j1_1      = (j1 == lj ? 0 : j1 - 1);
 
       f1  = fdist[i1_1][j1] + cost;
-      f2  = fdist[i1][j1_1] + edit_cost(0, j1);
+      f2  = fdist[i1][j1_1] + edit_cost(d, 0, j1);
 
       f = f1 < f2 ? f1 : f2;
 
       if (lleaf_i1 == li && lleaf_j1 == lj) {
-        f3 = fdist[i1_1][j1_1] + edit_cost(i1, j1);
+        f3 = fdist[i1_1][j1_1] + edit_cost(d, i1, j1);
 
         fdist[i1][j1] = f3 < f ? f3 : f;
 
@@ -228,20 +274,25 @@ tree_dist(int i,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE int
-edit_cost(int i,
-          int j)
+edit_cost(struct tree_dat *d,
+          int             i,
+          int             j)
 {
-  int c, diff, cd, min, a, b;
+  int         c, diff, cd, min, a, b;
+  const Tree  *tree1, *tree2;
+
+  tree1 = d->tree1;
+  tree2 = d->tree2;
 
-  c = (*EditCost)[tree1->postorder_list[i].type][tree2->postorder_list[j].type];
+  c = (*(d->cost))[tree1->postorder_list[i].type][tree2->postorder_list[j].type];
 
   diff = abs((a = tree1->postorder_list[i].weight) - (b = tree2->postorder_list[j].weight));
 
   min = (a < b ? a : b);
   if (min == a)
-    cd = (*EditCost)[0][tree2->postorder_list[j].type];
+    cd = (*(d->cost))[0][tree2->postorder_list[j].type];
   else
-    cd = (*EditCost)[0][tree1->postorder_list[i].type];
+    cd = (*(d->cost))[0][tree1->postorder_list[i].type];
 
   return c * min + cd * diff;
 }
@@ -593,16 +644,22 @@ free_tree(Tree *t)
 
 
 PRIVATE void
-backtracking(void)
+backtracking(struct tree_dat *d)
 {
-  int li, lj, i1, j1, i1_1, j1_1, li1_1, lj1_1, f;
-  int cost, lleaf_i1, lleaf_j1, ss, i, j, k;
+  int         li, lj, i1, j1, i1_1, j1_1, li1_1, lj1_1, f;
+  int         cost, lleaf_i1, lleaf_j1, ss, i, j, k;
+  int         **fdist, **alignment;
+  const Tree  *tree1, *tree2;
 
   struct {
     int i, j;
   } sector[MNODES / 2];
 
-  ss = 0;
+  fdist     = d->fdist;
+  alignment = d->alignment;
+  tree1     = d->tree1;
+  tree2     = d->tree2;
+  ss        = 0;
 
   i = i1 = tree1->postorder_list[0].sons;
   j = j1 = tree2->postorder_list[0].sons;
@@ -622,12 +679,12 @@ start:
 
     f = fdist[i1][j1];
 
-    cost = edit_cost(i1, 0);
+    cost = edit_cost(d, i1, 0);
     if (f == fdist[i1_1][j1] + cost) {
       alignment[0][i1]  = 0;
       i1                = i1_1;
     } else {
-      if (f == fdist[i1][j1_1] + edit_cost(0, j1)) {
+      if (f == fdist[i1][j1_1] + edit_cost(d, 0, j1)) {
         alignment[1][j1]  = 0;
         j1                = j1_1;
       } else if (lleaf_i1 == li && lleaf_j1 == lj) {
@@ -666,7 +723,7 @@ start:
           tree2->postorder_list[j1].leftmostleaf)
         break;
     }
-    tree_dist(i, j);
+    tree_dist(d, i, j);
     goto start;
   }
 }
@@ -675,12 +732,19 @@ start:
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-sprint_aligned_trees(void)
+sprint_aligned_trees(vrna_edit_dist_t *ctx,
+                     struct tree_dat  *d)
 {
-  int   i, j, n1, n2, k, l, p, ni, nj, weights;
-  char  t1[2 * MNODES + 1], t2[2 * MNODES + 1], a1[8 * MNODES], a2[8 * MNODES], ll[20], ll1[20];
-
-  weights = 0;
+  int         i, j, n1, n2, k, l, p, ni, nj, weights;
+  char        t1[2 * MNODES + 1], t2[2 * MNODES + 1], a1[8 * MNODES], a2[8 * MNODES], ll[20],
+              ll1[20];
+  int         **alignment;
+  const Tree  *tree1, *tree2;
+
+  alignment = d->alignment;
+  tree1     = d->tree1;
+  tree2     = d->tree2;
+  weights   = 0;
   n1      = tree1->postorder_list[0].sons;
   n2      = tree2->postorder_list[0].sons;
   for (i = 1; i <= n1; i++)
@@ -805,24 +869,11 @@ sprint_aligned_trees(void)
   a1[l] = a2[l] = '\0';
   if (l > 8 * MNODES) {
     vrna_log_error("structure too long in sprint_aligned_trees");
-    free(aligned_line[0]);
-    free(aligned_line[1]);
-
-    aligned_line[0] = NULL;
-    aligned_line[1] = NULL;
+    edit_dist_aligned_lines(ctx, NULL, NULL);
     return;
   }
 
-  if (aligned_line[0] != NULL)
-    free(aligned_line[0]);
-
-  if (aligned_line[1] != NULL)
-    free(aligned_line[1]);
-
-  aligned_line[0] = (char *)vrna_alloc((l + 1) * sizeof(char));
-  aligned_line[1] = (char *)vrna_alloc((l + 1) * sizeof(char));
-  strcpy(aligned_line[0], a1);
-  strcpy(aligned_line[1], a2);
+  edit_dist_aligned_lines(ctx, strdup(a1), strdup(a2));
 }
 
 
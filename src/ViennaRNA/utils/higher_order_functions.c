@@ -16,6 +16,16 @@ typedef int (*proto_fun_zip_reduce)(const int  *a,
                                     int        size);
 
 
+typedef unsigned int (*proto_fun_xor_popcount)(const uint64_t *a,
+                                               const uint64_t *b,
+                                               unsigned int   size);
+
+
+typedef int (*proto_fun_gather_sum)(const int           *table,
+                                    const unsigned int  *idx,
+                                    unsigned int        size);
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -33,6 +43,30 @@ fun_zip_add_min_default(const int *e1,
                         int       count);
 
 
+static unsigned int
+xor_popcount_dispatcher(const uint64_t  *a,
+                        const uint64_t  *b,
+                        unsigned int    size);
+
+
+static unsigned int
+fun_xor_popcount_default(const uint64_t *a,
+                         const uint64_t *b,
+                         unsigned int   count);
+
+
+static int
+gather_sum_dispatcher(const int           *table,
+                      const unsigned int  *idx,
+                      unsigned int        size);
+
+
+static int
+fun_gather_sum_default(const int          *table,
+                       const unsigned int *idx,
+                       unsigned int       count);
+
+
 #if VRNA_WITH_SIMD_AVX512
 extern int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -40,6 +74,18 @@ vrna_fun_zip_add_min_avx512(const int *e1,
                             int       count);
 
 
+extern unsigned int
+vrna_fun_xor_popcount_avx512(const uint64_t *a,
+                             const uint64_t *b,
+                             unsigned int   count);
+
+
+extern int
+vrna_fun_gather_sum_avx512(const int          *table,
+                           const unsigned int *idx,
+                           unsigned int       count);
+
+
 #endif
 
 #if VRNA_WITH_SIMD_SSE41
@@ -49,10 +95,18 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
                            int        count);
 
 
+extern unsigned int
+vrna_fun_xor_popcount_sse41(const uint64_t  *a,
+                            const uint64_t  *b,
+                            unsigned int    count);
+
+
 #endif
 
 
 static proto_fun_zip_reduce fun_zip_add_min = &zip_add_min_dispatcher;
+static proto_fun_xor_popcount fun_xor_popcount = &xor_popcount_dispatcher;
+static proto_fun_gather_sum fun_gather_sum = &gather_sum_dispatcher;
 
 
 /*
@@ -63,14 +117,18 @@ static proto_fun_zip_reduce fun_zip_add_min = &zip_add_min_dispatcher;
 PUBLIC void
 vrna_fun_dispatch_disable(void)
 {
-  fun_zip_add_min = &fun_zip_add_min_default;
+  fun_zip_add_min   = &fun_zip_add_min_default;
+  fun_xor_popcount  = &fun_xor_popcount_default;
+  fun_gather_sum    = &fun_gather_sum_default;
 }
 
 
 PUBLIC void
 vrna_fun_dispatch_enable(void)
 {
-  fun_zip_add_min = &zip_add_min_dispatcher;
+  fun_zip_add_min   = &zip_add_min_dispatcher;
+  fun_xor_popcount  = &xor_popcount_dispatcher;
+  fun_gather_sum    = &gather_sum_dispatcher;
 }
 
 
@@ -83,6 +141,24 @@ vrna_fun_zip_add_min(const int  *e1,
 }
 
 
+PUBLIC unsigned int
+vrna_fun_xor_popcount(const uint64_t  *a,
+                      const uint64_t  *b,
+                      unsigned int    count)
+{
+  return (*fun_xor_popcount)(a, b, count);
+}
+
+
+PUBLIC int
+vrna_fun_gather_sum(const int           *table,
+                    const unsigned int  *idx,
+                    unsigned int        count)
+{
+  return (*fun_gather_sum)(table, idx, count);
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -138,3 +214,98 @@ fun_zip_add_min_default(const int *e1,
 
   return decomp;
 }
+
+
+/* xor_popcount() dispatcher */
+static unsigned int
+xor_popcount_dispatcher(const uint64_t  *a,
+                        const uint64_t  *b,
+                        unsigned int    size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX512
+  if (features & VRNA_CPU_SIMD_AVX512F) {
+    fun_xor_popcount = &vrna_fun_xor_popcount_avx512;
+    goto exec_fun_xor_popcount;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_xor_popcount = &vrna_fun_xor_popcount_sse41;
+    goto exec_fun_xor_popcount;
+  }
+
+#endif
+
+  fun_xor_popcount = &fun_xor_popcount_default;
+
+exec_fun_xor_popcount:
+
+  return (*fun_xor_popcount)(a, b, size);
+}
+
+
+static unsigned int
+fun_xor_popcount_default(const uint64_t *a,
+                         const uint64_t *b,
+                         unsigned int   count)
+{
+  unsigned int  i, bits;
+  uint64_t      x;
+
+  for (bits = 0, i = 0; i < count; i++) {
+    x = a[i] ^ b[i];
+#ifdef __GNUC__
+    bits += (unsigned int)__builtin_popcountll(x);
+#else
+    x     = x - ((x >> 1) & 0x5555555555555555ULL);
+    x     = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x     = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    bits  += (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+  }
+
+  return bits;
+}
+
+
+/* gather_sum() dispatcher */
+static int
+gather_sum_dispatcher(const int           *table,
+                      const unsigned int  *idx,
+                      unsigned int        size)
+{
+  fun_gather_sum = &fun_gather_sum_default;
+
+  /* SSE4.1 lacks gather instructions, so there is no SSE4.1 variant */
+#if VRNA_WITH_SIMD_AVX512
+  if (vrna_cpu_simd_capabilities() & VRNA_CPU_SIMD_AVX512F)
+    fun_gather_sum = &vrna_fun_gather_sum_avx512;
+
+#endif
+
+  return (*fun_gather_sum)(table, idx, size);
+}
+
+
+static int
+fun_gather_sum_default(const int          *table,
+                       const unsigned int *idx,
+                       unsigned int       count)
+{
+  unsigned int  i;
+  int           e, sum;
+
+  for (sum = 0, i = 0; i < count; i++) {
+    e = table[idx[i]];
+    if (e == INF)
+      return INF;
+
+    sum += e;
+  }
+
+  return sum;
+}
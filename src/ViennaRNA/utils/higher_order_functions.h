@@ -1,6 +1,8 @@
 #ifndef VIENNA_RNA_PACKAGE_UTILS_FUN_H
 #define VIENNA_RNA_PACKAGE_UTILS_FUN_H
 
+#include <stdint.h>
+
 void
 vrna_fun_dispatch_disable(void);
 
@@ -15,4 +17,16 @@ vrna_fun_zip_add_min(const int  *e1,
                      int        count);
 
 
+unsigned int
+vrna_fun_xor_popcount(const uint64_t  *a,
+                      const uint64_t  *b,
+                      unsigned int    count);
+
+
+int
+vrna_fun_gather_sum(const int           *table,
+                    const unsigned int  *idx,
+                    unsigned int        count);
+
+
 #endif
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 
 #include "ViennaRNA/utils/basic.h"
@@ -48,3 +49,90 @@ vrna_fun_zip_add_min_avx512(const int *e1,
 
   return decomp;
 }
+
+
+/*
+ *  Population count of a ^ b. AVX512F lacks both, byte shuffles and the
+ *  VPOPCNTQ instruction, so we use the classic bit-slicing reduction within
+ *  each of the eight 64-bit lanes instead
+ */
+PUBLIC unsigned int
+vrna_fun_xor_popcount_avx512(const uint64_t *a,
+                             const uint64_t *b,
+                             unsigned int   count)
+{
+  unsigned int  i, bits;
+  uint64_t      x;
+
+  const __m512i m1  = _mm512_set1_epi64(0x5555555555555555LL);
+  const __m512i m2  = _mm512_set1_epi64(0x3333333333333333LL);
+  const __m512i m4  = _mm512_set1_epi64(0x0f0f0f0f0f0f0f0fLL);
+  const __m512i m7  = _mm512_set1_epi64(0x7f);
+  __m512i       acc = _mm512_setzero_si512();
+
+  for (i = 0; i + 7 < count; i += 8) {
+    __m512i v = _mm512_xor_si512(_mm512_loadu_si512((void *)&a[i]),
+                                 _mm512_loadu_si512((void *)&b[i]));
+
+    v = _mm512_sub_epi64(v, _mm512_and_si512(_mm512_srli_epi64(v, 1), m1));
+    v = _mm512_add_epi64(_mm512_and_si512(v, m2),
+                         _mm512_and_si512(_mm512_srli_epi64(v, 2), m2));
+    v = _mm512_and_si512(_mm512_add_epi64(v, _mm512_srli_epi64(v, 4)), m4);
+    v = _mm512_add_epi64(v, _mm512_srli_epi64(v, 8));
+    v = _mm512_add_epi64(v, _mm512_srli_epi64(v, 16));
+    v = _mm512_add_epi64(v, _mm512_srli_epi64(v, 32));
+
+    acc = _mm512_add_epi64(acc, _mm512_and_si512(v, m7));
+  }
+
+  bits = (unsigned int)_mm512_reduce_add_epi64(acc);
+
+  for (; i < count; i++) {
+    x     = a[i] ^ b[i];
+    x     = x - ((x >> 1) & 0x5555555555555555ULL);
+    x     = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x     = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    bits  += (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+  }
+
+  return bits;
+}
+
+
+/*
+ *  Sum of table[idx[i]], or INF if any of the gathered values is INF
+ */
+PUBLIC int
+vrna_fun_gather_sum_avx512(const int          *table,
+                           const unsigned int *idx,
+                           unsigned int       count)
+{
+  unsigned int  i;
+  int           e, sum;
+
+  __m512i       inf = _mm512_set1_epi32(INF);
+  __m512i       acc = _mm512_setzero_si512();
+
+  for (i = 0; i + 15 < count; i += 16) {
+    __m512i v = _mm512_i32gather_epi32(_mm512_loadu_si512((void *)&idx[i]),
+                                       (const void *)table,
+                                       4);
+
+    if (_mm512_cmpeq_epi32_mask(v, inf))
+      return INF;
+
+    acc = _mm512_add_epi32(acc, v);
+  }
+
+  sum = _mm512_reduce_add_epi32(acc);
+
+  for (; i < count; i++) {
+    e = table[idx[i]];
+    if (e == INF)
+      return INF;
+
+    sum += e;
+  }
+
+  return sum;
+}
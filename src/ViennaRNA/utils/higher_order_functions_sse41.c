@@ -4,17 +4,23 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 
 #include "ViennaRNA/utils/basic.h"
 
 #include <emmintrin.h>
+#include <tmmintrin.h>
 #include <smmintrin.h>
 
 static int
 horizontal_min_Vec4i(__m128i x);
 
 
+static unsigned int
+popcount_u64(uint64_t x);
+
+
 PUBLIC int
 vrna_fun_zip_add_min_sse41(const int  *e1,
                            const int  *e2,
@@ -55,6 +61,63 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
 }
 
 
+/*
+ *  Population count of a ^ b using a 4-bit lookup table in a byte shuffle
+ *  (SSSE3, implied by SSE4.1). The per-byte counts are accumulated for at most
+ *  31 iterations (31 * 8 < 256) before they are summed up via _mm_sad_epu8()
+ */
+PUBLIC unsigned int
+vrna_fun_xor_popcount_sse41(const uint64_t  *a,
+                            const uint64_t  *b,
+                            unsigned int    count)
+{
+  unsigned int  i, k, bits;
+  uint64_t      sums[2];
+
+  const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3,
+                                    1, 2, 2, 3, 2, 3, 3, 4);
+  const __m128i low_mask  = _mm_set1_epi8(0x0f);
+  __m128i       total     = _mm_setzero_si128();
+
+  for (i = 0; i + 1 < count;) {
+    __m128i acc = _mm_setzero_si128();
+
+    for (k = 0; (k < 31) && (i + 1 < count); k++, i += 2) {
+      __m128i x = _mm_xor_si128(_mm_loadu_si128((__m128i *)&a[i]),
+                                _mm_loadu_si128((__m128i *)&b[i]));
+      __m128i lo  = _mm_and_si128(x, low_mask);
+      __m128i hi  = _mm_and_si128(_mm_srli_epi16(x, 4), low_mask);
+
+      acc = _mm_add_epi8(acc,
+                         _mm_add_epi8(_mm_shuffle_epi8(lut, lo),
+                                      _mm_shuffle_epi8(lut, hi)));
+    }
+
+    total = _mm_add_epi64(total, _mm_sad_epu8(acc, _mm_setzero_si128()));
+  }
+
+  _mm_storeu_si128((__m128i *)sums, total);
+
+  bits = (unsigned int)(sums[0] + sums[1]);
+
+  for (; i < count; i++)
+    bits += popcount_u64(a[i] ^ b[i]);
+
+  return bits;
+}
+
+
+static unsigned int
+popcount_u64(uint64_t x)
+{
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+  return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+
 /*
  *  SSE minimum
  *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
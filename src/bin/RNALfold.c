@@ -68,6 +68,7 @@ main(int  argc,
      char *argv[])
 {
   FILE                        *input, *output;
+  vrna_file_reader_t          *reader;
   struct  RNALfold_args_info  args_info;
   char                        *ParamFile, *ns_bases, *rec_sequence, *rec_id, **rec_rest,
                               *command_file, *orig_sequence, *infile, *outfile, *filename_delim,
@@ -277,6 +278,7 @@ main(int  argc,
     input = stdin;
   }
 
+  reader = vrna_file_reader_stream(input);
 
   if (command_file != NULL)
     commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
@@ -297,7 +299,7 @@ main(int  argc,
    #############################################
    */
   while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, input, read_opt))
+    !((rec_type = vrna_file_reader_fasta_record(reader, &rec_id, &rec_sequence, &rec_rest, read_opt))
       & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
     /*
      ########################################################
@@ -483,6 +485,8 @@ main(int  argc,
       vrna_message_input_seq_simple();
   }
 
+  vrna_file_reader_close(reader);
+
   if (infile && input)
     fclose(input);
 
@@ -61,6 +61,7 @@ main(int  argc,
   float                   cutoff;
   double                  subopts, pk_penalty;
   vrna_md_t               md;
+  vrna_file_reader_t      *reader;
 
   options     = 0;
   subopts     = 0.0;
@@ -158,13 +159,15 @@ main(int  argc,
   if (istty)
     vrna_message_input_seq_simple();
 
+  reader = vrna_file_reader_stream(stdin);
+
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
-  while (!(vrna_file_fasta_read_record(&id_s1, &s1, &rest, NULL,
-                                       options) & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
+  while (!(vrna_file_reader_fasta_record(reader, &id_s1, &s1, &rest,
+                                         options) & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
     /*
      ########################################################
      # handle user input from 'stdin'
@@ -316,6 +319,8 @@ main(int  argc,
       vrna_message_input_seq_simple();
   }
 
+  vrna_file_reader_close(reader);
+
   if (vrna_log_fp() != stderr)
     fclose(vrna_log_fp());
 
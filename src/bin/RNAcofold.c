@@ -559,11 +559,13 @@ process_input(FILE            *input_stream,
               const char      *input_filename,
               struct options  *opt)
 {
-  unsigned int  read_opt;
-  int           istty, istty_in, istty_out, ret;
+  unsigned int        read_opt;
+  int                 istty, istty_in, istty_out, ret;
+  vrna_file_reader_t  *reader;
 
   ret       = 1;
   read_opt  = 0;
+  reader    = vrna_file_reader_stream(input_stream);
 
   istty_in  = isatty(fileno(input_stream));
   istty_out = isatty(fileno(stdout));
@@ -582,7 +584,7 @@ process_input(FILE            *input_stream,
     }
   }
 
-  /* set options we wanna pass to vrna_file_fasta_read_record() */
+  /* set options we wanna pass to vrna_file_reader_fasta_record() */
   if (istty)
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
 
@@ -603,11 +605,11 @@ process_input(FILE            *input_stream,
     rec_rest        = NULL;
     maybe_multiline = 0;
 
-    rec_type = vrna_file_fasta_read_record(&rec_id,
-                                           &rec_sequence,
-                                           &rec_rest,
-                                           input_stream,
-                                           read_opt);
+    rec_type = vrna_file_reader_fasta_record(reader,
+                                             &rec_id,
+                                             &rec_sequence,
+                                             &rec_rest,
+                                             read_opt);
 
     if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
       break;
@@ -663,6 +665,8 @@ process_input(FILE            *input_stream,
     }
   } while (1);
 
+  vrna_file_reader_close(reader);
+
   return ret;
 }
 
@@ -23,6 +23,7 @@
 #include "ViennaRNA/structures/pairtable.h"
 #include "ViennaRNA/structures/dotbracket.h"
 #include "ViennaRNA/structures/tree.h"
+#include "ViennaRNA/structures/edit_distance.h"
 #include "ViennaRNA/utils/log.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/datastructures/basic.h"
@@ -57,6 +58,12 @@ PRIVATE void
 print_aligned_lines(FILE *somewhere);
 
 
+PRIVATE void
+print_distance_row(unsigned int  i,
+                   const float   *row,
+                   void          *data);
+
+
 PRIVATE char  ruler[] = "....,....1....,....2....,....3....,....4"
                         "....,....5....,....6....,....7....,....8";
 PRIVATE int   types = 1;
@@ -66,6 +73,7 @@ PRIVATE char  outfile[FILENAME_MAX_LENGTH], *list_title;
 
 PRIVATE char  ttype[10] = "f";
 PRIVATE int   n         = 0;
+PRIVATE int   jobs      = 1;
 
 int
 main(int  argc,
@@ -117,19 +125,28 @@ main(int  argc,
       for (tt = 0; tt < types; tt++) {
         printf("> %c   %d\n", ttype[tt], n);
         if (islower(ttype[tt])) {
-          for (i = 1; i < n; i++) {
-            for (j = 0; j < i; j++) {
-              printf("%g ", tree_edit_distance(T[ttree][i], T[ttree][j]));
-              if (edit_backtrack) {
+          if (edit_backtrack) {
+            for (i = 1; i < n; i++) {
+              for (j = 0; j < i; j++) {
+                printf("%g ", tree_edit_distance(T[ttree][i], T[ttree][j]));
                 fprintf(somewhere, "%d %d", i + 1, j + 1);
                 if (ttype[tt] == 'f')
                   unexpand_aligned_F(aligned_line);
 
                 print_aligned_lines(somewhere);
               }
+              printf("\n");
             }
-            printf("\n");
+          } else {
+            (void)vrna_edit_dist_matrix_cb((const void **)T[ttree],
+                                           (unsigned int)n,
+                                           VRNA_EDIT_DIST_TREE,
+                                           (cost_matrix) ? VRNA_EDIT_DIST_SHAPIRO : VRNA_EDIT_DIST_DEFAULT,
+                                           (unsigned int)jobs,
+                                           &print_distance_row,
+                                           NULL);
           }
+
           printf("\n");
           for (i = 0; i < n; i++)
             free_tree(T[ttree][i]);
@@ -137,28 +154,53 @@ main(int  argc,
         }
 
         if (ttype[tt] == 'P') {
-          for (i = 1; i < n; i++) {
-            for (j = 0; j < i; j++)
-              printf("%g ", (float)vrna_bp_distance(P[i], P[j]));
-            printf("\n");
+          for (i = 1; i < n; i++)
+            if (strlen(P[i]) != strlen(P[0]))
+              break;
+
+          if (i >= n) {
+            vrna_bp_set_t *set = vrna_bp_set((const char **)P, (unsigned int)n);
+
+            (void)vrna_bp_set_distance_matrix_cb(set,
+                                                 (unsigned int)jobs,
+                                                 &print_distance_row,
+                                                 NULL);
+            vrna_bp_set_free(set);
+          } else {
+            /* structures of unequal length */
+            for (i = 1; i < n; i++) {
+              for (j = 0; j < i; j++)
+                printf("%g ", (float)vrna_bp_distance(P[i], P[j]));
+              printf("\n");
+            }
           }
+
           printf("\n");
           for (i = 0; i < n; i++)
             free(P[i]);
         } else if (isupper(ttype[tt])) {
-          for (i = 1; i < n; i++) {
-            for (j = 0; j < i; j++) {
-              printf("%g ", string_edit_distance(S[tstr][i], S[tstr][j]));
-              if (edit_backtrack) {
+          if (edit_backtrack) {
+            for (i = 1; i < n; i++) {
+              for (j = 0; j < i; j++) {
+                printf("%g ", string_edit_distance(S[tstr][i], S[tstr][j]));
                 fprintf(somewhere, "%d %d", i + 1, j + 1);
                 if (ttype[tt] == 'F')
                   unexpand_aligned_F(aligned_line);
 
                 print_aligned_lines(somewhere);
               }
+              printf("\n");
             }
-            printf("\n");
+          } else {
+            (void)vrna_edit_dist_matrix_cb((const void **)S[tstr],
+                                           (unsigned int)n,
+                                           VRNA_EDIT_DIST_STRING,
+                                           (cost_matrix) ? VRNA_EDIT_DIST_SHAPIRO : VRNA_EDIT_DIST_DEFAULT,
+                                           (unsigned int)jobs,
+                                           &print_distance_row,
+                                           NULL);
           }
+
           printf("\n");
           for (i = 0; i < n; i++)
             free(S[tstr][i]);
@@ -684,6 +726,14 @@ command_line(int  argc,
     edit_backtrack = 1;
   }
 
+  /* number of threads for distance matrix computations, 0 means all cores */
+  if (args_info.jobs_arg < 0) {
+    vrna_log_error("Number of jobs must be non-negative");
+    exit(EXIT_FAILURE);
+  }
+
+  jobs = args_info.jobs_arg;
+
   /* free allocated memory of command line data structure */
   RNAdistance_cmdline_parser_free(&args_info);
 }
@@ -699,3 +749,19 @@ print_aligned_lines(FILE *somewhere)
     fflush(somewhere);
   }
 }
+
+
+/*--------------------------------------------------------------------------*/
+
+PRIVATE void
+print_distance_row(unsigned int  i,
+                   const float   *row,
+                   void          *data)
+{
+  unsigned int j;
+
+  for (j = 0; j < i; j++)
+    printf("%g ", row[j]);
+
+  printf("\n");
+}
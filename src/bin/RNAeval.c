@@ -33,6 +33,7 @@
 #include "ViennaRNA/eval/structures.h"
 #include "ViennaRNA/cofold.h"
 #include "ViennaRNA/sequences/alignments.h"
+#include "ViennaRNA/sequences/alphabet.h"
 #include "ViennaRNA/datastructures/char_stream.h"
 #include "ViennaRNA/datastructures/stream_output.h"
 #include "ViennaRNA/datastructures/string.h"
@@ -45,6 +46,9 @@
 
 #define DBL_ROUND(a, digits) (round((a) * pow(10., (double)(digits))) / pow(10., (double)(digits)))
 
+/* number of records a single job evaluates at once, see process_record_batch() */
+#define RECORD_BATCH_SIZE 64
+
 struct options {
   unsigned int    msa_format;
   int             filename_full;
@@ -92,6 +96,12 @@ struct record_data_msa {
 };
 
 
+struct record_batch {
+  unsigned int        num;
+  struct record_data  *records[RECORD_BATCH_SIZE];
+};
+
+
 struct output_stream {
   vrna_cstr_t data;
   vrna_cstr_t err;
@@ -114,10 +124,35 @@ static void
 process_record(struct record_data *record);
 
 
+static void
+process_record_batch(struct record_batch *batch);
+
+
 static void
 process_alignment_record(struct record_data_msa *record);
 
 
+static char *
+record_sequence(struct record_data *record);
+
+
+static char *
+record_structure(struct record_data *record,
+                 const char         *sequence);
+
+
+static void
+output_record(struct record_data    *record,
+              struct output_stream  *o_stream,
+              const char            *structure,
+              int                   cutpoint,
+              float                 energy);
+
+
+static void
+free_record(struct record_data *record);
+
+
 void
 init_default_options(struct options *opt)
 {
@@ -395,11 +430,22 @@ process_input(FILE            *input_stream,
               const char      *input_filename,
               struct options  *opt)
 {
-  int           ret       = 1;
-  int           istty_in  = isatty(fileno(input_stream));
-  int           istty_out = isatty(fileno(stdout));
+  int                 ret       = 1;
+  int                 istty_in  = isatty(fileno(input_stream));
+  int                 istty_out = isatty(fileno(stdout));
 
-  unsigned int  read_opt = 0;
+  unsigned int        read_opt  = 0;
+  vrna_file_reader_t  *reader   = vrna_file_reader_stream(input_stream);
+
+  /*
+   *  with multiple jobs, hand over records in batches whenever
+   *  we only need to print the energy for each structure
+   */
+  int                 batched   = (opt->jobs > 1) &&
+                                  (!opt->verbose) &&
+                                  (!opt->shape) &&
+                                  (!(istty_in && istty_out));
+  struct record_batch *batch    = NULL;
 
   /* print user help if we get input from tty */
   if (istty_in && istty_out) {
@@ -422,11 +468,11 @@ process_input(FILE            *input_stream,
     rec_rest        = NULL;
     maybe_multiline = 0;
 
-    rec_type = vrna_file_fasta_read_record(&rec_id,
-                                           &rec_sequence,
-                                           &rec_rest,
-                                           input_stream,
-                                           read_opt);
+    rec_type = vrna_file_reader_fasta_record(reader,
+                                             &rec_id,
+                                             &rec_sequence,
+                                             &rec_rest,
+                                             read_opt);
 
     if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
       break;
@@ -460,7 +506,19 @@ process_input(FILE            *input_stream,
     if (opt->output_queue)
       vrna_ostream_request(opt->output_queue, opt->next_record_number++);
 
-    RUN_IN_PARALLEL(process_record, record);
+    if (batched) {
+      if (!batch)
+        batch = (struct record_batch *)vrna_alloc(sizeof(struct record_batch));
+
+      batch->records[batch->num++] = record;
+
+      if (batch->num == RECORD_BATCH_SIZE) {
+        RUN_IN_PARALLEL(process_record_batch, batch);
+        batch = NULL;
+      }
+    } else {
+      RUN_IN_PARALLEL(process_record, record);
+    }
 
     if (opt->shape) {
       ret = 0;
@@ -473,6 +531,12 @@ process_input(FILE            *input_stream,
                              "Input sequence (upper or lower case) followed by structure");
   } while (1);
 
+  /* process remaining records */
+  if (batch)
+    RUN_IN_PARALLEL(process_record_batch, batch);
+
+  vrna_file_reader_close(reader);
+
   return ret;
 }
 
@@ -622,23 +686,14 @@ process_record(struct record_data *record)
 {
   struct options        *opt;
   struct output_stream  *o_stream;
-  char                  *rec_sequence, *structure, *tmp;
+  char                  *rec_sequence, *structure;
   int                   n;
   float                 energy;
   vrna_fold_compound_t  *vc;
 
   opt           = record->options;
   o_stream      = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
-  rec_sequence  = strdup(record->sequence);
-
-  /* convert DNA alphabet to RNA if not explicitely switched off */
-  if (!opt->noconv) {
-    vrna_seq_toRNA(rec_sequence);
-    vrna_seq_toRNA(record->sequence);
-  }
-
-  /* convert sequence to uppercase letters only */
-  vrna_seq_toupper(rec_sequence);
+  rec_sequence  = record_sequence(record);
 
   vc = vrna_fold_compound(rec_sequence,
                           &(opt->md),
@@ -666,47 +721,7 @@ process_record(struct record_data *record)
   /* retrieve string stream bound to stderr for any info messages */
   o_stream->err = vrna_cstr(n, stderr);
 
-  tmp = vrna_extract_record_rest_structure((const char **)record->rest,
-                                           0,
-                                           (record->multiline_input) ? VRNA_OPTION_MULTILINE : 0);
-
-  if (!tmp) {
-    vrna_log_error("structure missing for record %d\n", record->number);
-    exit(EXIT_FAILURE);
-  }
-
-  {
-    char **structures = vrna_strsplit(tmp, "&");
-    for (unsigned int a = 0; a < vc->strands; a++) {
-      if (!structures[a])
-        vrna_log_error("Sequence and Structure have different number of strand delimiters");
-
-      unsigned int l = strlen(structures[a]);
-      switch (vc->type) {
-        case VRNA_FC_TYPE_SINGLE:
-          if (vc->nucleotides[a].length != l) {
-            vrna_log_error(
-              "Structure and sequence part of strand %u differ in length (%u vs. %u)",
-              a,
-              l,
-              vc->nucleotides[a].length);
-            exit(EXIT_FAILURE);
-          }
-
-          break;
-
-        case VRNA_FC_TYPE_COMPARATIVE:
-          break;
-      }
-    }
-    structure = vrna_strjoin((const char **)structures, NULL);
-
-    for (unsigned int a = 0; a < vc->strands; a++)
-      free(structures[a]);
-
-    free(structures);
-    free(tmp);
-  }
+  structure = record_structure(record, rec_sequence);
 
   if (record->tty) {
     char          *tmp;
@@ -746,38 +761,83 @@ process_record(struct record_data *record)
   vrna_cstr_print_fasta_header(o_stream->data, record->id);
 
   energy = vrna_eval_structure_cstr(vc, structure, opt->verbose, o_stream->data);
-  vrna_cstr_printf(o_stream->data, "%s\n", record->sequence);
 
-  char *pstruct = vrna_cut_point_insert(structure, vc->cutpoint);
-  vrna_cstr_printf_structure(o_stream->data,
-                             pstruct,
-                             record->tty ? "\n energy = %6.2f kcal/mol" : " (%6.2f)",
-                             energy);
-  free(pstruct);
-
-  if (opt->output_queue)
-    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
-  else
-    flush_cstr_callback(NULL, 0, (void *)o_stream);
+  output_record(record, o_stream, structure, vc->cutpoint, energy);
 
   /* clean up */
   vrna_fold_compound_free(vc);
-  free(record->id);
-  free(record->SEQ_ID);
-  free(record->sequence);
   free(rec_sequence);
   free(structure);
+  free_record(record);
+}
 
-  /* free the rest of current dataset */
-  if (record->rest) {
-    for (int i = 0; record->rest[i]; i++)
-      free(record->rest[i]);
-    free(record->rest);
+
+/*
+ *  Evaluate a batch of records at once. This is only used for plain energy
+ *  output, i.e. without SHAPE data and verbose loop energies, and produces
+ *  exactly the same output as process_record() for each of the records
+ */
+static void
+process_record_batch(struct record_batch *batch)
+{
+  struct options        *opt;
+  struct output_stream  *o_stream;
+  struct record_data    *records[RECORD_BATCH_SIZE];
+  char                  *sequences[RECORD_BATCH_SIZE], *structures[RECORD_BATCH_SIZE], *ptr;
+  unsigned int          i, num, n;
+  float                 energies[RECORD_BATCH_SIZE];
+
+  for (num = i = 0; i < batch->num; i++) {
+    ptr = record_sequence(batch->records[i]);
+    n   = strlen(ptr);
+
+    /* leave records we can't create a fold compound for to the default route */
+    if ((n == 0) ||
+        (n > vrna_sequence_length_max(VRNA_OPTION_MFE | VRNA_OPTION_EVAL_ONLY))) {
+      free(ptr);
+      process_record(batch->records[i]);
+      continue;
+    }
+
+    records[num]    = batch->records[i];
+    sequences[num]  = ptr;
+    structures[num] = record_structure(records[num], ptr);
+    num++;
   }
 
-  free(record->input_filename);
+  if (num > 0) {
+    opt = records[0]->options;
 
-  free(record);
+    vrna_eval_batch((const char **)sequences,
+                    (const char **)structures,
+                    num,
+                    &(opt->md),
+                    energies,
+                    1);
+
+    for (i = 0; i < num; i++) {
+      n               = strlen(structures[i]);
+      o_stream        = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+      o_stream->data  = vrna_cstr(6 * n, stdout);
+      o_stream->err   = vrna_cstr(n, stderr);
+
+      vrna_cstr_print_fasta_header(o_stream->data, records[i]->id);
+
+      ptr = strchr(sequences[i], '&');
+
+      output_record(records[i],
+                    o_stream,
+                    structures[i],
+                    (ptr) ? (int)(ptr - sequences[i]) + 1 : -1,
+                    energies[i]);
+
+      free(sequences[i]);
+      free(structures[i]);
+      free_record(records[i]);
+    }
+  }
+
+  free(batch);
 }
 
 
@@ -871,3 +931,124 @@ process_alignment_record(struct record_data_msa *record)
 
   free(record);
 }
+
+
+/* prepare the sequence of a record for evaluation */
+static char *
+record_sequence(struct record_data *record)
+{
+  char *sequence = strdup(record->sequence);
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!record->options->noconv) {
+    vrna_seq_toRNA(sequence);
+    vrna_seq_toRNA(record->sequence);
+  }
+
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(sequence);
+
+  return sequence;
+}
+
+
+/*
+ *  extract the structure of a record, check its strands against those
+ *  of the sequence and remove the strand delimiters
+ */
+static char *
+record_structure(struct record_data *record,
+                 const char         *sequence)
+{
+  char          *tmp, *structure, **strands, **structures;
+  unsigned int  a, l;
+
+  tmp = vrna_extract_record_rest_structure((const char **)record->rest,
+                                           0,
+                                           (record->multiline_input) ? VRNA_OPTION_MULTILINE : 0);
+
+  if (!tmp) {
+    vrna_log_error("structure missing for record %d\n", record->number);
+    exit(EXIT_FAILURE);
+  }
+
+  strands     = vrna_strsplit(sequence, "&");
+  structures  = vrna_strsplit(tmp, "&");
+
+  for (a = 0; strands[a]; a++) {
+    if (!structures[a]) {
+      vrna_log_error("Sequence and Structure have different number of strand delimiters");
+      exit(EXIT_FAILURE);
+    }
+
+    l = strlen(structures[a]);
+    if (strlen(strands[a]) != l) {
+      vrna_log_error(
+        "Structure and sequence part of strand %u differ in length (%u vs. %u)",
+        a,
+        l,
+        (unsigned int)strlen(strands[a]));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  structure = vrna_strjoin((const char **)structures, NULL);
+
+  for (a = 0; strands[a]; a++)
+    free(strands[a]);
+
+  for (a = 0; structures[a]; a++)
+    free(structures[a]);
+
+  free(strands);
+  free(structures);
+  free(tmp);
+
+  return structure;
+}
+
+
+/* print sequence, structure, and energy of a record and hand over its output */
+static void
+output_record(struct record_data    *record,
+              struct output_stream  *o_stream,
+              const char            *structure,
+              int                   cutpoint,
+              float                 energy)
+{
+  char *pstruct;
+
+  vrna_cstr_printf(o_stream->data, "%s\n", record->sequence);
+
+  pstruct = vrna_cut_point_insert(structure, cutpoint);
+  vrna_cstr_printf_structure(o_stream->data,
+                             pstruct,
+                             record->tty ? "\n energy = %6.2f kcal/mol" : " (%6.2f)",
+                             energy);
+  free(pstruct);
+
+  if (record->options->output_queue)
+    vrna_ostream_provide(record->options->output_queue, record->number, (void *)o_stream);
+  else
+    flush_cstr_callback(NULL, 0, (void *)o_stream);
+}
+
+
+static void
+free_record(struct record_data *record)
+{
+  free(record->id);
+  free(record->SEQ_ID);
+  free(record->sequence);
+
+  /* free the rest of current dataset */
+  if (record->rest) {
+    for (int i = 0; record->rest[i]; i++)
+      free(record->rest[i]);
+    free(record->rest);
+  }
+
+  free(record->input_filename);
+
+  free(record);
+}
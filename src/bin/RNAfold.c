@@ -74,6 +74,9 @@ struct options {
   int             lucky;
   int             MEA;
   double          MEAgamma;
+  int             sparse;
+  int             beam;
+  unsigned int    beam_size;
   double          bppmThreshold;
   int             verbose;
   char            *ligandMotif;
@@ -403,6 +406,9 @@ init_default_options(struct options *opt)
   opt->lucky          = 0;
   opt->MEA            = 0;
   opt->MEAgamma       = 1.;
+  opt->sparse         = 0;
+  opt->beam           = 0;
+  opt->beam_size      = VRNA_BEAM_SIZE_DEFAULT;
   opt->bppmThreshold  = 1e-5;
   opt->verbose        = 0;
   opt->ligandMotif    = NULL;
@@ -521,6 +527,31 @@ main(int  argc,
       opt.MEAgamma = args_info.MEA_arg;
   }
 
+  /* sparsified recursions */
+  if (args_info.sparse_given)
+    opt.sparse = 1;
+
+  /* beam search */
+  if (args_info.beam_given) {
+    if (args_info.beam_arg < 0) {
+      vrna_log_error("Beam size must be non-negative");
+      exit(EXIT_FAILURE);
+    }
+
+    opt.beam      = 1;
+    opt.beam_size = (unsigned int)args_info.beam_arg;
+
+    if (opt.lucky) {
+      vrna_log_warning("Stochastic backtracking requires the full partition function matrices, "
+                       "ignoring --beam option");
+      opt.beam = 0;
+    } else if (opt.md.compute_bpp == 2) {
+      vrna_log_warning("Stack probabilities are not available with beam search, "
+                       "computing base pair probabilities only");
+      opt.md.compute_bpp = 1;
+    }
+  }
+
   if (args_info.layout_type_given)
     opt.plot_layout = rna_plot_type = args_info.layout_type_arg;
 
@@ -771,11 +802,12 @@ process_input(FILE            *input_stream,
               const char      *input_filename,
               struct options  *opt)
 {
-  int           ret       = 1;
-  int           istty_in  = isatty(fileno(input_stream));
-  int           istty_out = isatty(fileno(stdout));
+  int                 ret       = 1;
+  int                 istty_in  = isatty(fileno(input_stream));
+  int                 istty_out = isatty(fileno(stdout));
 
-  unsigned int  read_opt = 0;
+  unsigned int        read_opt  = 0;
+  vrna_file_reader_t  *reader   = vrna_file_reader_stream(input_stream);
 
   /* print user help if we get input from tty */
   if (istty_in && istty_out) {
@@ -787,7 +819,7 @@ process_input(FILE            *input_stream,
     }
   }
 
-  /* set options we wanna pass to vrna_file_fasta_read_record() */
+  /* set options we wanna pass to vrna_file_reader_fasta_record() */
   if (istty_in)
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
 
@@ -804,11 +836,11 @@ process_input(FILE            *input_stream,
     rec_rest        = NULL;
     maybe_multiline = 0;
 
-    rec_type = vrna_file_fasta_read_record(&rec_id,
-                                           &rec_sequence,
-                                           &rec_rest,
-                                           input_stream,
-                                           read_opt);
+    rec_type = vrna_file_reader_fasta_record(reader,
+                                             &rec_id,
+                                             &rec_sequence,
+                                             &rec_rest,
+                                             read_opt);
 
     if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
       break;
@@ -861,6 +893,8 @@ process_input(FILE            *input_stream,
     }
   } while (1);
 
+  vrna_file_reader_close(reader);
+
   return ret;
 }
 
@@ -895,7 +929,11 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(rec_sequence);
 
-  vc = vrna_fold_compound(rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
+  vc = vrna_fold_compound(rec_sequence,
+                          &(opt->md),
+                          VRNA_OPTION_DEFAULT |
+                          ((opt->sparse) ? VRNA_OPTION_SPARSE : 0) |
+                          ((opt->beam) ? VRNA_OPTION_BEAM : 0));
 
   if (!vc) {
     vrna_log_warning("Skipping computations for \"%s\"",
@@ -903,6 +941,9 @@ process_record(struct record_data *record)
     return;
   }
 
+  if (opt->beam)
+    vc->beam_size = opt->beam_size;
+
   length = vc->length;
 
   if ((opt->md.circ) && (vrna_rotational_symmetry(rec_sequence) > 1))
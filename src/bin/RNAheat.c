@@ -348,11 +348,12 @@ process_input(FILE            *input_stream,
               const char      *input_filename,
               struct options  *opt)
 {
-  int           ret       = 1;
-  int           istty_in  = isatty(fileno(input_stream));
-  int           istty_out = isatty(fileno(stdout));
+  int                 ret       = 1;
+  int                 istty_in  = isatty(fileno(input_stream));
+  int                 istty_out = isatty(fileno(stdout));
 
-  unsigned int  read_opt = VRNA_INPUT_NO_REST;
+  unsigned int        read_opt  = VRNA_INPUT_NO_REST;
+  vrna_file_reader_t  *reader   = vrna_file_reader_stream(input_stream);
 
   /* print user help if we get input from tty */
   if (istty_in && istty_out) {
@@ -374,11 +375,11 @@ process_input(FILE            *input_stream,
     rec_rest        = NULL;
     maybe_multiline = 0;
 
-    rec_type = vrna_file_fasta_read_record(&rec_id,
-                                           &rec_sequence,
-                                           &rec_rest,
-                                           input_stream,
-                                           read_opt);
+    rec_type = vrna_file_reader_fasta_record(reader,
+                                             &rec_id,
+                                             &rec_sequence,
+                                             &rec_rest,
+                                             read_opt);
 
     if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
       break;
@@ -418,6 +419,8 @@ process_input(FILE            *input_stream,
       vrna_message_input_seq_simple();
   } while (1);
 
+  vrna_file_reader_close(reader);
+
   return ret;
 }
 
@@ -478,10 +481,15 @@ process_record(struct record_data *record)
    */
   vrna_cstr_print_fasta_header(o_stream->data, record->id);
 
-  (void)vrna_heat_capacity_cb(fc,
-                              T_min, T_max, h, m,
-                              &print_to_stream_callback,
-                              (void *)o_stream->data);
+  /*
+   *  parallelize the temperature sweep only if we do not already
+   *  process multiple sequences in parallel
+   */
+  (void)vrna_heat_capacity_cb_mt(fc,
+                                 T_min, T_max, h, m,
+                                 (opt->jobs > 1) ? 1 : 0,
+                                 &print_to_stream_callback,
+                                 (void *)o_stream->data);
 
   if (opt->output_queue)
     vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
@@ -25,6 +25,7 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/profiledist.h"
+#include "ViennaRNA/structures/edit_distance.h"
 
 #include "gengetopt_helpers.h"
 #include "RNApdist_cmdl.h"
@@ -43,11 +44,18 @@ PRIVATE void
 print_aligned_lines(FILE *somewhere);
 
 
+PRIVATE void
+print_distance_row(unsigned int  i,
+                   const float   *row,
+                   void          *data);
+
+
 PRIVATE char  task;
 PRIVATE char  outfile[FILENAME_MAX_LENGTH];
 PRIVATE char  ruler[] = "....,....1....,....2....,....3....,....4"
                         "....,....5....,....6....,....7....,....8";
 static int    noconv = 0;
+static int    jobs    = 1;
 
 int
 main(int  argc,
@@ -148,15 +156,24 @@ main(int  argc,
         printf("* END of taxa list\n");
 
       printf("> p %d (pdist)\n", n);
-      for (i = 1; i < n; i++) {
-        for (j = 0; j < i; j++) {
-          printf("%g ", profile_edit_distance(T[i], T[j]));
-          if (edit_backtrack)
+      if (edit_backtrack) {
+        for (i = 1; i < n; i++) {
+          for (j = 0; j < i; j++) {
+            printf("%g ", profile_edit_distance(T[i], T[j]));
             fprintf(somewhere, "> %d %d\n", i + 1, j + 1);
-
-          print_aligned_lines(somewhere);
+            print_aligned_lines(somewhere);
+          }
+          printf("\n");
         }
-        printf("\n");
+      } else {
+        /* print the matrix row by row instead of keeping it in memory */
+        (void)vrna_edit_dist_matrix_cb((const void **)T,
+                                       (unsigned int)n,
+                                       VRNA_EDIT_DIST_PROFILE,
+                                       VRNA_EDIT_DIST_DEFAULT,
+                                       (unsigned int)jobs,
+                                       &print_distance_row,
+                                       NULL);
       }
       if (type == 888) {
         /* do another distance matrix */
@@ -363,6 +380,14 @@ command_line(int        argc,
     edit_backtrack = 1;
   }
 
+  /* number of threads for distance matrix computations, 0 means all cores */
+  if (args_info.jobs_arg < 0) {
+    vrna_log_error("Number of jobs must be non-negative");
+    exit(EXIT_FAILURE);
+  }
+
+  jobs = args_info.jobs_arg;
+
   ggo_geometry_settings(args_info, md);
 
   /* free allocated memory of command line data structure */
@@ -384,3 +409,16 @@ print_aligned_lines(FILE *somewhere)
 
 
 /*--------------------------------------------------------------------------*/
+
+PRIVATE void
+print_distance_row(unsigned int  i,
+                   const float   *row,
+                   void          *data)
+{
+  unsigned int j;
+
+  for (j = 0; j < i; j++)
+    printf("%g ", row[j]);
+
+  printf("\n");
+}
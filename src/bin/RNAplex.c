@@ -2593,7 +2593,7 @@ linear_fit(int  *il_a,
     sumxy += internal_loop_x[i] * internal_loop_y[i];
   }
   if ((sumxx - (sumx * sumx) / n) < 1e-6) {
-    free(P);
+    vrna_params_free(P);
     printf("divisor for internal loop is too small %d\n", (sumxx - (sumx * sumx) / n));
     vrna_log_error("Problem in fitting");
     exit(EXIT_FAILURE);
@@ -2627,7 +2627,7 @@ linear_fit(int  *il_a,
   tb_b  = sumy / n - (tb_a * sumx / n);
   *b_a  = (int)tb_a;
   *b_b  = (int)tb_b;
-  free(P);
+  vrna_params_free(P);
   if ((sumxx - (sumx * sumx) / n) < 1e-6) {
     printf("divisor for bulge loop is too small %d\n", (sumxx - (sumx * sumx) / n));
     vrna_log_error("Problem in fitting");
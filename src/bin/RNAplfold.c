@@ -156,6 +156,7 @@ main(int  argc,
   vrna_cmd_t                  commands;
   dataset_id                  id_control;
   vrna_sc_mod_param_t         *mod_params;
+  vrna_file_reader_t          *reader;
 
   pUfp                = NULL;
   dangles             = 2;
@@ -349,13 +350,15 @@ main(int  argc,
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
   }
 
+  reader = vrna_file_reader_stream(stdin);
+
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
   while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, NULL, read_opt))
+    !((rec_type = vrna_file_reader_fasta_record(reader, &rec_id, &rec_sequence, &rec_rest, read_opt))
       & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
     size_t  **mod_positions, mod_param_sets;
     char    *SEQ_ID = NULL;
@@ -615,7 +618,7 @@ main(int  argc,
 
       vrna_fold_compound_free(fc);
 
-      free(pf_parameters);
+      vrna_exp_params_free(pf_parameters);
 
       /* clean up data */
       if (data.pUfp)
@@ -656,6 +659,8 @@ main(int  argc,
 
 rnaplfold_exit:
 
+  vrna_file_reader_close(reader);
+
   free(filename_delim);
   free(command_file);
   free(shape_method);
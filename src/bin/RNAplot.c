@@ -366,13 +366,14 @@ process_input(FILE            *input_stream,
               const char      *input_filename,
               struct options  *opt)
 {
-  int           ret       = 1;
-  int           istty_in  = isatty(fileno(input_stream));
-  int           istty_out = isatty(fileno(stdout));
+  int                 ret       = 1;
+  int                 istty_in  = isatty(fileno(input_stream));
+  int                 istty_out = isatty(fileno(stdout));
 
-  unsigned int  read_opt = 0;
+  unsigned int        read_opt  = 0;
+  vrna_file_reader_t  *reader   = vrna_file_reader_stream(input_stream);
 
-  /* set options we wanna pass to vrna_file_fasta_read_record() */
+  /* set options we wanna pass to vrna_file_reader_fasta_record() */
   if (istty_in && istty_out) {
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
     vrna_message_input_seq("Input sequence (upper or lower case) followed by structure");
@@ -392,11 +393,11 @@ process_input(FILE            *input_stream,
     rec_rest        = NULL;
     maybe_multiline = 0;
 
-    rec_type = vrna_file_fasta_read_record(&rec_id,
-                                           &rec_sequence,
-                                           &rec_rest,
-                                           input_stream,
-                                           read_opt);
+    rec_type = vrna_file_reader_fasta_record(reader,
+                                             &rec_id,
+                                             &rec_sequence,
+                                             &rec_rest,
+                                             read_opt);
 
     if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
       break;
@@ -434,6 +435,8 @@ process_input(FILE            *input_stream,
       vrna_message_input_seq("Input sequence (upper or lower case) followed by structure");
   } while (1);
 
+  vrna_file_reader_close(reader);
+
   return ret;
 }
 
@@ -100,6 +100,7 @@ main(int  argc,
   int                       istty, algorithm, i, sample_size, verbose;
   double                    *shape_data, initialStepSize, minStepSize, minImprovement,
                             minimizerTolerance;
+  vrna_file_reader_t        *reader;
 
   istty               = 0;
   read_opt            = 0;
@@ -195,6 +196,8 @@ main(int  argc,
                      minimizer_arg_vector_bfgs2 },
                    { VRNA_MINIMIZER_STEEPEST_DESCENT,
                      minimizer_arg_steepest_descent },
+                   { VRNA_MINIMIZER_LBFGS,
+                     minimizer_arg_lbfgs },
                    { 0,
                      0 } };
     for (i = 0; mapper[i].algorithm; ++i)
@@ -236,7 +239,10 @@ main(int  argc,
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
   }
 
-  rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, NULL, read_opt);
+  reader    = vrna_file_reader_stream(stdin);
+  rec_type  = vrna_file_reader_fasta_record(reader, &rec_id, &rec_sequence, &rec_rest, read_opt);
+  vrna_file_reader_close(reader);
+
   if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
     return 0;
 
@@ -72,6 +72,7 @@ main(int  argc,
      char *argv[])
 {
   FILE                                *input, *output;
+  vrna_file_reader_t                  *reader;
   struct          RNAsubopt_args_info args_info;
   char                                *rec_sequence, *rec_id,
                                       **rec_rest, *orig_sequence, *constraints_file, *cstruc,
@@ -286,7 +287,8 @@ main(int  argc,
     input = stdin;
   }
 
-  istty = (!infile) && isatty(fileno(stdout)) && isatty(fileno(stdin));
+  reader  = vrna_file_reader_stream(input);
+  istty   = (!infile) && isatty(fileno(stdout)) && isatty(fileno(stdin));
 
   /* print user help if we get input from tty */
   if (istty) {
@@ -303,7 +305,7 @@ main(int  argc,
     }
   }
 
-  /* set options we wanna pass to vrna_file_fasta_read_record() */
+  /* set options we wanna pass to vrna_file_reader_fasta_record() */
   if (istty)
     read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
 
@@ -316,7 +318,7 @@ main(int  argc,
    #############################################
    */
   while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, input, read_opt))
+    !((rec_type = vrna_file_reader_fasta_record(reader, &rec_id, &rec_sequence, &rec_rest, read_opt))
       & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
     size_t  **mod_positions, mod_param_sets;
     char    *SEQ_ID         = NULL;
@@ -621,6 +623,8 @@ main(int  argc,
     }
   }
 
+  vrna_file_reader_close(reader);
+
   if (infile && input)
     fclose(input);
 
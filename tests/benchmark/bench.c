@@ -0,0 +1,881 @@
+/*
+ *  Performance benchmarks for the core recursions of RNAlib
+ *
+ *  Each benchmark case runs in a child process of its own, such that the
+ *  peak resident set size can be attributed to a single case. Results are
+ *  written to stdout in JSON format, see tests/benchmark/bench_compare.py
+ *  for the comparison against a stored baseline.
+ *
+ *  Usage: bench [--data DIR] [--max-length N] [--repeat N] [--seed N]
+ *               [--filter STRING] [--quick] [--list]
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/mfe/global.h>
+#include <ViennaRNA/mfe/local.h>
+#include <ViennaRNA/partfunc/global.h>
+#include <ViennaRNA/partfunc/local.h>
+#include <ViennaRNA/probabilities/basepairs.h>
+#include <ViennaRNA/subopt/wuchty.h>
+#include <ViennaRNA/sampling/basic.h>
+#include <ViennaRNA/structures/problist.h>
+#include <ViennaRNA/io/utils.h>
+#include <ViennaRNA/io/file_formats_msa.h>
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/utils/strings.h>
+
+#ifndef VRNA_VERSION
+#define VRNA_VERSION  "unknown"
+#endif
+
+#define BENCH_MAX_REPEATS     32
+#define BENCH_MIN_TOTAL_TIME  2.     /* stop repeating a case after this many seconds */
+#define BENCH_SUBOPT_DELTA    100    /* energy range for suboptimal structures in dcal/mol */
+#define BENCH_SAMPLES         1000   /* number of stochastic backtracking samples */
+#define BENCH_WINDOW_SIZE     200    /* window size for sliding-window predictions */
+#define BENCH_MAX_SPAN        150    /* maximum base pair span for sliding-window predictions */
+
+
+typedef enum {
+  BENCH_MFE,
+  BENCH_PF,
+  BENCH_BPP,
+  BENCH_SUBOPT,
+  BENCH_PBACKTRACK,
+  BENCH_MFE_WINDOW,
+  BENCH_PROBS_WINDOW
+} bench_function_e;
+
+
+typedef enum {
+  BENCH_SINGLE,
+  BENCH_COMPARATIVE,
+  BENCH_MULTISTRAND
+} bench_mode_e;
+
+
+typedef struct {
+  bench_function_e  function;
+  const char        *name;
+  const char        *symbol;      /* library function that is timed */
+  unsigned int      max_length;   /* default length limit for synthetic inputs */
+} bench_function_t;
+
+
+typedef struct {
+  char              *name;
+  bench_function_e  function;
+  bench_mode_e      mode;
+  char              *input;       /* "random" or the input file name */
+  char              **sequences;  /* NULL-terminated, a single sequence unless comparative */
+  unsigned int      length;
+  unsigned int      n_seq;
+} bench_case_t;
+
+
+/* what the child process reports back */
+typedef struct {
+  unsigned int  repeats;
+  double        times[BENCH_MAX_REPEATS];
+  double        result;
+} bench_run_t;
+
+
+typedef struct {
+  const char    *data_dir;
+  unsigned int  max_length;
+  unsigned int  repeat;
+  unsigned long seed;
+  const char    *filter;
+  int           list;
+} bench_options_t;
+
+
+static const bench_function_t functions[] = {
+  { BENCH_MFE,          "mfe",          "vrna_mfe",           10000 },
+  { BENCH_PF,           "pf",           "vrna_pf",            5000  },
+  { BENCH_BPP,          "bpp",          "vrna_pairing_probs", 5000  },
+  { BENCH_SUBOPT,       "subopt",       "vrna_subopt_cb",     500   },
+  { BENCH_PBACKTRACK,   "pbacktrack",   "vrna_pbacktrack_cb", 2000  },
+  { BENCH_MFE_WINDOW,   "mfe_window",   "vrna_mfe_window_cb", 10000 },
+  { BENCH_PROBS_WINDOW, "probs_window", "vrna_probs_window",  10000 }
+};
+
+
+static const unsigned int synthetic_lengths[] = {
+  50, 100, 200, 500, 1000, 2000, 5000, 10000, 0
+};
+
+
+/* single sequences with known structures from the data directory */
+static const char *real_inputs[] = {
+  "TPP_riboswitch_E.coli.db",
+  "Lysine_riboswitch_T._martima.db",
+  "5domain16S_rRNA_H.volcanii.db",
+  "5domain16S_rRNA_E.coli.db",
+  NULL
+};
+
+
+static const char *alignment_inputs[] = {
+  "ebag9_5utr.aln",
+  "adam10_5utr.aln",
+  "070313_ecoli_cdiff_16S_clustalw.aln",
+  NULL
+};
+
+
+static const char *mode_names[] = {
+  "single", "comparative", "multistrand"
+};
+
+
+/*
+ #################################
+ # input generation              #
+ #################################
+ */
+
+/* xorshift64*, such that synthetic inputs do not depend on the C library */
+static unsigned long long
+next_random(unsigned long long *state)
+{
+  *state  ^= *state >> 12;
+  *state  ^= *state << 25;
+  *state  ^= *state >> 27;
+
+  return *state * 2685821657736338717ULL;
+}
+
+
+static char *
+random_sequence(unsigned int  length,
+                unsigned long seed)
+{
+  unsigned int        i;
+  unsigned long long  state;
+  char                *s;
+
+  state = ((unsigned long long)seed << 32) ^ (unsigned long long)length ^ 0x9E3779B97F4A7C15ULL;
+  s     = (char *)vrna_alloc(sizeof(char) * (length + 1));
+
+  for (i = 0; i < length; i++)
+    s[i] = "ACGU"[next_random(&state) >> 62];
+
+  return s;
+}
+
+
+static int
+selected(const bench_options_t  *opt,
+         const char             *name)
+{
+  return (opt->filter == NULL) || (strstr(name, opt->filter) != NULL);
+}
+
+
+static void
+add_case(bench_case_t           **cases,
+         unsigned int           *num,
+         const bench_options_t  *opt,
+         bench_function_e       function,
+         bench_mode_e           mode,
+         const char             *input,
+         char                   **sequences,
+         unsigned int           n_seq)
+{
+  char          *name;
+  unsigned int  length;
+
+  /* strand delimiters do not count towards the sequence length */
+  length = 0;
+  for (char *c = sequences[0]; *c; c++)
+    if (*c != '&')
+      length++;
+
+  name = vrna_strdup_printf("%s/%s/%s/%u",
+                            functions[function].name,
+                            mode_names[mode],
+                            input,
+                            length);
+
+  if (!selected(opt, name)) {
+    free(name);
+    return;
+  }
+
+  *cases = (bench_case_t *)vrna_realloc(*cases, sizeof(bench_case_t) * (*num + 1));
+
+  (*cases)[*num].name       = name;
+  (*cases)[*num].function   = function;
+  (*cases)[*num].mode       = mode;
+  (*cases)[*num].input      = strdup(input);
+  (*cases)[*num].sequences  = (char **)vrna_alloc(sizeof(char *) * (n_seq + 1));
+  (*cases)[*num].length     = length;
+  (*cases)[*num].n_seq      = n_seq;
+
+  for (unsigned int s = 0; s < n_seq; s++)
+    (*cases)[*num].sequences[s] = strdup(sequences[s]);
+
+  (*num)++;
+}
+
+
+/* dot-bracket files hold the sequence in their first line */
+static char *
+read_single_sequence(const char *filename)
+{
+  char  *sequence;
+  FILE  *fp;
+
+  sequence  = NULL;
+  fp        = fopen(filename, "r");
+
+  if (fp) {
+    sequence = vrna_read_line(fp);
+    fclose(fp);
+
+    if ((sequence) &&
+        (*sequence == '\0')) {
+      free(sequence);
+      sequence = NULL;
+    }
+  }
+
+  return sequence;
+}
+
+
+static unsigned int
+read_alignment(const char *filename,
+               char       ***alignment)
+{
+  char          **names, *id, *structure;
+  int           n_seq;
+  unsigned int  format;
+
+  names     = NULL;
+  id        = NULL;
+  structure = NULL;
+  format    = vrna_file_msa_detect_format(filename, VRNA_FILE_FORMAT_MSA_DEFAULT);
+
+  if (format == VRNA_FILE_FORMAT_MSA_UNKNOWN)
+    return 0;
+
+  n_seq = vrna_file_msa_read(filename, &names, alignment, &id, &structure, format);
+
+  if (n_seq > 0) {
+    for (int s = 0; s < n_seq; s++)
+      free(names[s]);
+
+    free(names);
+  } else {
+    n_seq = 0;
+  }
+
+  free(id);
+  free(structure);
+
+  return (unsigned int)n_seq;
+}
+
+
+static bench_case_t *
+collect_cases(const bench_options_t *opt,
+              unsigned int          *num)
+{
+  char          *path, *seq, *seqs[2], **alignment;
+  unsigned int  f, l, length, n_seq;
+  bench_case_t  *cases;
+
+  cases = NULL;
+  *num  = 0;
+
+  /* single sequences, synthetic inputs */
+  for (f = 0; f < sizeof(functions) / sizeof(bench_function_t); f++) {
+    for (l = 0; (length = synthetic_lengths[l]); l++) {
+      if ((length > functions[f].max_length) ||
+          (length > opt->max_length))
+        continue;
+
+      seqs[0] = random_sequence(length, opt->seed);
+      add_case(&cases, num, opt, functions[f].function, BENCH_SINGLE, "random", seqs, 1);
+      free(seqs[0]);
+    }
+  }
+
+  /* single sequences, real inputs */
+  for (l = 0; real_inputs[l]; l++) {
+    path  = vrna_strdup_printf("%s/%s", opt->data_dir, real_inputs[l]);
+    seq   = read_single_sequence(path);
+
+    if (!seq) {
+      fprintf(stderr, "WARNING: skipping unreadable input file \"%s\"\n", path);
+    } else if (strlen(seq) <= opt->max_length) {
+      add_case(&cases, num, opt, BENCH_MFE, BENCH_SINGLE, real_inputs[l], &seq, 1);
+      add_case(&cases, num, opt, BENCH_PF, BENCH_SINGLE, real_inputs[l], &seq, 1);
+      add_case(&cases, num, opt, BENCH_BPP, BENCH_SINGLE, real_inputs[l], &seq, 1);
+    }
+
+    free(seq);
+    free(path);
+  }
+
+  /* comparative mode */
+  for (l = 0; alignment_inputs[l]; l++) {
+    path      = vrna_strdup_printf("%s/%s", opt->data_dir, alignment_inputs[l]);
+    alignment = NULL;
+    n_seq     = read_alignment(path, &alignment);
+
+    if (n_seq == 0) {
+      fprintf(stderr, "WARNING: skipping unreadable alignment file \"%s\"\n", path);
+    } else if (strlen(alignment[0]) <= opt->max_length) {
+      add_case(&cases, num, opt, BENCH_MFE, BENCH_COMPARATIVE, alignment_inputs[l], alignment, n_seq);
+      add_case(&cases, num, opt, BENCH_PF, BENCH_COMPARATIVE, alignment_inputs[l], alignment, n_seq);
+      add_case(&cases, num, opt, BENCH_BPP, BENCH_COMPARATIVE, alignment_inputs[l], alignment,
+               n_seq);
+    }
+
+    for (unsigned int s = 0; s < n_seq; s++)
+      free(alignment[s]);
+
+    free(alignment);
+    free(path);
+  }
+
+  /* multistrand mode, two synthetic strands of equal length */
+  for (l = 0; (length = synthetic_lengths[l]); l++) {
+    if ((length < 100) ||
+        (length > 2000) ||
+        (length > opt->max_length))
+      continue;
+
+    seqs[0] = random_sequence(length + 1, opt->seed + 1);
+    seqs[0][length / 2] = '&';
+
+    add_case(&cases, num, opt, BENCH_MFE, BENCH_MULTISTRAND, "random", seqs, 1);
+    add_case(&cases, num, opt, BENCH_PF, BENCH_MULTISTRAND, "random", seqs, 1);
+    add_case(&cases, num, opt, BENCH_BPP, BENCH_MULTISTRAND, "random", seqs, 1);
+
+    free(seqs[0]);
+  }
+
+  return cases;
+}
+
+
+/*
+ #################################
+ # benchmark execution           #
+ #################################
+ */
+static double
+now(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+
+static void
+count_subopt(const char *structure,
+             float      energy,
+             void       *data)
+{
+  if (structure)
+    (*((double *)data))++;
+}
+
+
+static void
+count_sample(const char *structure,
+             void       *data)
+{
+  if (structure)
+    (*((double *)data))++;
+}
+
+
+static void
+count_mfe_window(unsigned int start,
+                 unsigned int end,
+                 const char   *structure,
+                 float        en,
+                 void         *data)
+{
+  (*((double *)data)) += en;
+}
+
+
+static void
+sum_probs_window(FLT_OR_DBL   *pr,
+                 int          pr_size,
+                 int          i,
+                 int          max,
+                 unsigned int type,
+                 void         *data)
+{
+  if (type & VRNA_PROBS_WINDOW_BPP)
+    for (int j = i + 1; j <= pr_size; j++)
+      (*((double *)data)) += pr[j];
+}
+
+
+static vrna_fold_compound_t *
+prepare(bench_case_t *c)
+{
+  unsigned int          options;
+  double                mfe;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+
+  options = VRNA_OPTION_DEFAULT;
+
+  switch (c->function) {
+    case BENCH_PF:
+      md.compute_bpp  = 0;
+      options         = VRNA_OPTION_MFE | VRNA_OPTION_PF;
+      break;
+
+    case BENCH_BPP:
+      options = VRNA_OPTION_MFE | VRNA_OPTION_PF;
+      break;
+
+    case BENCH_SUBOPT:
+      md.uniq_ML = 1;
+      break;
+
+    case BENCH_PBACKTRACK:
+      md.uniq_ML      = 1;
+      md.compute_bpp  = 0;
+      options         = VRNA_OPTION_MFE | VRNA_OPTION_PF;
+      break;
+
+    case BENCH_MFE_WINDOW:
+      md.window_size  = BENCH_WINDOW_SIZE;
+      md.max_bp_span  = BENCH_MAX_SPAN;
+      options         = VRNA_OPTION_MFE | VRNA_OPTION_WINDOW;
+      break;
+
+    case BENCH_PROBS_WINDOW:
+      md.window_size  = BENCH_WINDOW_SIZE;
+      md.max_bp_span  = BENCH_MAX_SPAN;
+      options         = VRNA_OPTION_PF | VRNA_OPTION_WINDOW;
+      break;
+
+    default:
+      break;
+  }
+
+  if (c->mode == BENCH_COMPARATIVE)
+    fc = vrna_fold_compound_comparative((const char **)c->sequences, &md, options);
+  else
+    fc = vrna_fold_compound(c->sequences[0], &md, options);
+
+  /* scale Boltzmann factors to avoid overflows for long sequences */
+  if ((fc) &&
+      (options & VRNA_OPTION_PF) &&
+      (!(options & VRNA_OPTION_WINDOW))) {
+    mfe = (double)vrna_mfe(fc, NULL);
+    vrna_exp_params_rescale(fc, &mfe);
+  }
+
+  return fc;
+}
+
+
+/* run the benchmarked function once, returns a checksum of its result */
+static double
+execute(bench_case_t          *c,
+        vrna_fold_compound_t  *fc,
+        double                *elapsed)
+{
+  double  t, result;
+  char    *structure;
+
+  result    = 0.;
+  structure = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
+
+  if (c->function == BENCH_BPP) {
+    /* vrna_pairing_probs() requires filled partition function matrices */
+    fc->exp_params->model_details.compute_bpp = 0;
+    (void)vrna_pf(fc, NULL);
+    fc->exp_params->model_details.compute_bpp = 1;
+  }
+
+  t = now();
+
+  switch (c->function) {
+    case BENCH_MFE:
+      result = (double)vrna_mfe(fc, structure);
+      break;
+
+    case BENCH_PF:
+      result = (double)vrna_pf(fc, NULL);
+      break;
+
+    case BENCH_BPP:
+      (void)vrna_pairing_probs(fc, NULL);
+      break;
+
+    case BENCH_SUBOPT:
+      vrna_subopt_cb(fc, BENCH_SUBOPT_DELTA, &count_subopt, (void *)&result);
+      break;
+
+    case BENCH_PBACKTRACK:
+      vrna_pbacktrack_cb(fc,
+                         BENCH_SAMPLES,
+                         &count_sample,
+                         (void *)&result,
+                         VRNA_PBACKTRACK_DEFAULT);
+      break;
+
+    case BENCH_MFE_WINDOW:
+      (void)vrna_mfe_window_cb(fc, &count_mfe_window, (void *)&result);
+      break;
+
+    case BENCH_PROBS_WINDOW:
+      (void)vrna_probs_window(fc, 0, VRNA_PROBS_WINDOW_BPP, &sum_probs_window, (void *)&result);
+      break;
+  }
+
+  *elapsed = now() - t;
+
+  /* expected number of base pairs, summed up directly within the probability matrix */
+  if (c->function == BENCH_BPP) {
+    FLT_OR_DBL  *probs  = fc->exp_matrices->probs;
+    int         *iindx  = fc->iindx;
+    int         n       = (int)fc->length;
+
+    for (int i = 1; i < n; i++)
+      for (int j = i + 1; j <= n; j++)
+        result += probs[iindx[i] - j];
+  }
+
+  free(structure);
+
+  return result;
+}
+
+
+static void
+run_case(bench_case_t           *c,
+         const bench_options_t  *opt,
+         bench_run_t            *run)
+{
+  double                total, elapsed;
+  vrna_fold_compound_t  *fc;
+
+  memset(run, 0, sizeof(bench_run_t));
+
+  /* each repetition starts from a fresh fold compound, without cached matrices */
+  for (total = 0.; run->repeats < opt->repeat; run->repeats++) {
+    fc = prepare(c);
+    if (!fc)
+      break;
+
+    if (c->function == BENCH_PBACKTRACK)
+      (void)vrna_pf(fc, NULL);
+
+    run->result                 = execute(c, fc, &elapsed);
+    run->times[run->repeats]    = elapsed;
+    total                       += elapsed;
+
+    vrna_fold_compound_free(fc);
+
+    if (total >= BENCH_MIN_TOTAL_TIME) {
+      run->repeats++;
+      break;
+    }
+  }
+}
+
+
+/*
+ *  Run a case in a child process and collect its timings through a pipe.
+ *  The resource usage of the child yields the peak RSS of this case only
+ */
+static int
+run_isolated(bench_case_t           *c,
+             const bench_options_t  *opt,
+             bench_run_t            *run,
+             long                   *peak_rss)
+{
+  int           fd[2], status;
+  pid_t         pid;
+  ssize_t       r;
+  size_t        received;
+  struct rusage usage;
+
+  if (pipe(fd) != 0)
+    return 0;
+
+  fflush(stdout);
+  fflush(stderr);
+
+  pid = fork();
+
+  if (pid < 0) {
+    close(fd[0]);
+    close(fd[1]);
+    return 0;
+  }
+
+  if (pid == 0) {
+    close(fd[0]);
+    run_case(c, opt, run);
+    r = write(fd[1], run, sizeof(bench_run_t));
+    close(fd[1]);
+    _exit((r == (ssize_t)sizeof(bench_run_t)) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  close(fd[1]);
+
+  for (received = 0; received < sizeof(bench_run_t); received += (size_t)r) {
+    r = read(fd[0], (char *)run + received, sizeof(bench_run_t) - received);
+    if (r <= 0)
+      break;
+  }
+
+  close(fd[0]);
+
+  if (wait4(pid, &status, 0, &usage) != pid)
+    return 0;
+
+#ifdef __APPLE__
+  *peak_rss = usage.ru_maxrss / 1024;  /* bytes on macOS */
+#else
+  *peak_rss = usage.ru_maxrss;         /* kilobytes */
+#endif
+
+  return (WIFEXITED(status)) &&
+         (WEXITSTATUS(status) == EXIT_SUCCESS) &&
+         (received == sizeof(bench_run_t)) &&
+         (run->repeats > 0);
+}
+
+
+/*
+ #################################
+ # JSON output                   #
+ #################################
+ */
+static int
+compare_doubles(const void  *a,
+                const void  *b)
+{
+  double x = *((const double *)a);
+  double y = *((const double *)b);
+
+  return (x > y) - (x < y);
+}
+
+
+/*
+ *  Amount of work for the throughput, i.e. n^3 for the global recursions and
+ *  n * W^2 for sliding-window predictions with window size W
+ */
+static double
+work(bench_case_t *c,
+     const char   **unit)
+{
+  double n = (double)c->length;
+
+  if ((c->function == BENCH_MFE_WINDOW) ||
+      (c->function == BENCH_PROBS_WINDOW)) {
+    *unit = "nt*W^2/s";
+    return n * BENCH_WINDOW_SIZE * BENCH_WINDOW_SIZE;
+  }
+
+  *unit = "nt^3/s";
+
+  return n * n * n;
+}
+
+
+static void
+print_result(bench_case_t *c,
+             bench_run_t  *run,
+             long         peak_rss,
+             int          success,
+             int          last)
+{
+  double      times[BENCH_MAX_REPEATS], median, amount;
+  const char  *unit;
+
+  printf("    {\n"
+         "      \"name\": \"%s\",\n"
+         "      \"function\": \"%s\",\n"
+         "      \"mode\": \"%s\",\n"
+         "      \"input\": \"%s\",\n"
+         "      \"length\": %u,\n"
+         "      \"sequences\": %u,\n",
+         c->name,
+         functions[c->function].symbol,
+         mode_names[c->mode],
+         c->input,
+         c->length,
+         c->n_seq);
+
+  if (success) {
+    memcpy(times, run->times, sizeof(double) * run->repeats);
+    qsort(times, run->repeats, sizeof(double), &compare_doubles);
+
+    median = (run->repeats % 2) ?
+             times[run->repeats / 2] :
+             (times[run->repeats / 2 - 1] + times[run->repeats / 2]) / 2.;
+    amount = work(c, &unit);
+
+    printf("      \"repeats\": %u,\n"
+           "      \"time\": { \"min\": %.6f, \"median\": %.6f, \"max\": %.6f },\n"
+           "      \"throughput\": %.6g,\n"
+           "      \"throughput_unit\": \"%s\",\n"
+           "      \"peak_rss_kb\": %ld,\n"
+           "      \"result\": %.6g\n",
+           run->repeats,
+           times[0],
+           median,
+           times[run->repeats - 1],
+           (times[0] > 0.) ? amount / times[0] : 0.,
+           unit,
+           peak_rss,
+           run->result);
+  } else {
+    printf("      \"error\": \"benchmark failed\"\n");
+  }
+
+  printf("    }%s\n", (last) ? "" : ",");
+}
+
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+          "Usage: %s [--data DIR] [--max-length N] [--repeat N] [--seed N]\n"
+          "          [--filter STRING] [--quick] [--list]\n",
+          prog);
+}
+
+
+int
+main(int  argc,
+     char *argv[])
+{
+  unsigned int    i, num;
+  long            peak_rss;
+  int             success;
+  bench_case_t    *cases;
+  bench_run_t     run;
+  bench_options_t opt;
+  struct utsname  host;
+  char            date[64];
+  time_t          t;
+
+  opt.data_dir    = "data";
+  opt.max_length  = 10000;
+  opt.repeat      = 3;
+  opt.seed        = 1;
+  opt.filter      = NULL;
+  opt.list        = 0;
+
+  for (i = 1; i < (unsigned int)argc; i++) {
+    if ((!strcmp(argv[i], "--data")) && (i + 1 < (unsigned int)argc)) {
+      opt.data_dir = argv[++i];
+    } else if ((!strcmp(argv[i], "--max-length")) && (i + 1 < (unsigned int)argc)) {
+      opt.max_length = (unsigned int)strtoul(argv[++i], NULL, 10);
+    } else if ((!strcmp(argv[i], "--repeat")) && (i + 1 < (unsigned int)argc)) {
+      opt.repeat = (unsigned int)strtoul(argv[++i], NULL, 10);
+    } else if ((!strcmp(argv[i], "--seed")) && (i + 1 < (unsigned int)argc)) {
+      opt.seed = strtoul(argv[++i], NULL, 10);
+    } else if ((!strcmp(argv[i], "--filter")) && (i + 1 < (unsigned int)argc)) {
+      opt.filter = argv[++i];
+    } else if (!strcmp(argv[i], "--quick")) {
+      opt.max_length  = 1000;
+      opt.repeat      = 1;
+    } else if (!strcmp(argv[i], "--list")) {
+      opt.list = 1;
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  opt.repeat = MAX2(1, MIN2(opt.repeat, BENCH_MAX_REPEATS));
+
+  cases = collect_cases(&opt, &num);
+
+  if (opt.list) {
+    for (i = 0; i < num; i++)
+      printf("%s\n", cases[i].name);
+  } else {
+    t = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+    if (uname(&host) != 0)
+      memset(&host, 0, sizeof(struct utsname));
+
+    printf("{\n"
+           "  \"format\": 1,\n"
+           "  \"version\": \"%s\",\n"
+           "  \"date\": \"%s\",\n"
+           "  \"host\": { \"system\": \"%s\", \"machine\": \"%s\", \"cpus\": %ld },\n"
+           "  \"config\": { \"seed\": %lu, \"repeat\": %u, \"max_length\": %u },\n"
+           "  \"results\": [\n",
+           VRNA_VERSION,
+           date,
+           host.sysname,
+           host.machine,
+           sysconf(_SC_NPROCESSORS_ONLN),
+           opt.seed,
+           opt.repeat,
+           opt.max_length);
+
+    for (i = 0; i < num; i++) {
+      fprintf(stderr, "[%u/%u] %s\n", i + 1, num, cases[i].name);
+
+      peak_rss  = -1;
+      success   = run_isolated(cases + i, &opt, &run, &peak_rss);
+
+      print_result(cases + i, &run, peak_rss, success, i + 1 == num);
+    }
+
+    printf("  ]\n"
+           "}\n");
+  }
+
+  for (i = 0; i < num; i++) {
+    free(cases[i].name);
+    free(cases[i].input);
+    for (unsigned int s = 0; s < cases[i].n_seq; s++)
+      free(cases[i].sequences[s]);
+    free(cases[i].sequences);
+  }
+
+  free(cases);
+
+  return EXIT_SUCCESS;
+}
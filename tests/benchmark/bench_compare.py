@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#
+# Compare the output of the RNAlib benchmark harness (tests/benchmark/bench)
+# against a stored baseline and flag performance regressions.
+#
+# Usage: bench_compare.py [options] baseline.json current.json
+#
+# The exit status is 1 if at least one benchmark case regressed, 2 on
+# invalid input, and 0 otherwise.
+
+import argparse
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        data = json.load(f)
+
+    return data, {r["name"]: r for r in data.get("results", [])}
+
+
+def relative_change(old, new):
+    if old <= 0:
+        return 0.
+    return (new - old) / old
+
+
+def compare(old, new, args):
+    """Return a status string and a list of changes for a single case"""
+    if "error" in new:
+        return "FAILED", []
+    if "error" in old:
+        return "new", []
+
+    status  = "ok"
+    changes = []
+
+    t_old = old["time"]["median"]
+    t_new = new["time"]["median"]
+    d     = relative_change(t_old, t_new)
+    changes.append("time {:+.1%}".format(d))
+
+    # very short runs are dominated by timer noise
+    if max(t_old, t_new) >= args.min_time:
+        if d > args.threshold:
+            status = "REGRESSION"
+        elif d < -args.threshold:
+            status = "improved"
+
+    rss_old = old.get("peak_rss_kb", -1)
+    rss_new = new.get("peak_rss_kb", -1)
+    if rss_old > 0 and rss_new > 0:
+        d = relative_change(rss_old, rss_new)
+        changes.append("rss {:+.1%}".format(d))
+        if d > args.rss_threshold and rss_new - rss_old > args.min_rss:
+            status = "REGRESSION"
+
+    # a different result indicates a change in the energy model or a bug
+    if "result" in old and "result" in new:
+        r_old = old["result"]
+        r_new = new["result"]
+        if abs(r_new - r_old) > 1e-4 * max(1., abs(r_old)):
+            changes.append("result {} -> {}".format(r_old, r_new))
+            if status == "ok":
+                status = "changed"
+
+    return status, changes
+
+
+def main():
+    parser = argparse.ArgumentParser(description = "Compare RNAlib benchmark results against a baseline")
+    parser.add_argument("baseline", help = "JSON output of a previous benchmark run")
+    parser.add_argument("current", help = "JSON output of the current benchmark run")
+    parser.add_argument("--threshold", type = float, default = 0.10,
+                        help = "relative increase of the median run time considered a regression (default: 0.10)")
+    parser.add_argument("--rss-threshold", type = float, default = 0.10,
+                        help = "relative increase of the peak RSS considered a regression (default: 0.10)")
+    parser.add_argument("--min-time", type = float, default = 0.005,
+                        help = "ignore run time changes of cases faster than this many seconds (default: 0.005)")
+    parser.add_argument("--min-rss", type = int, default = 1024,
+                        help = "ignore peak RSS increases below this many kilobytes (default: 1024)")
+    parser.add_argument("--quiet", action = "store_true",
+                        help = "only list cases that did not pass")
+    args = parser.parse_args()
+
+    try:
+        base, base_results = load(args.baseline)
+        cur, cur_results = load(args.current)
+    except (OSError, ValueError, KeyError) as e:
+        print("Error reading benchmark results: {}".format(e), file = sys.stderr)
+        return 2
+
+    if base.get("host") != cur.get("host"):
+        print("Warning: baseline was recorded on a different host, timings may not be comparable",
+              file = sys.stderr)
+
+    counts = {}
+
+    print("{:<56} {:>10} {:>10}  {:<10} {}".format("benchmark", "baseline", "current", "status", "changes"))
+
+    for name, new in cur_results.items():
+        old = base_results.get(name)
+
+        if old is None:
+            status, changes = "new", []
+        else:
+            status, changes = compare(old, new, args)
+
+        counts[status] = counts.get(status, 0) + 1
+
+        if args.quiet and status in ("ok", "improved", "new"):
+            continue
+
+        t_old = "-" if old is None or "time" not in old else "{:.4f}s".format(old["time"]["median"])
+        t_new = "-" if "time" not in new else "{:.4f}s".format(new["time"]["median"])
+
+        print("{:<56} {:>10} {:>10}  {:<10} {}".format(name, t_old, t_new, status, ", ".join(changes)))
+
+    for name in base_results:
+        if name not in cur_results:
+            counts["missing"] = counts.get("missing", 0) + 1
+            if not args.quiet:
+                print("{:<56} {:>10} {:>10}  {:<10}".format(name, "", "-", "missing"))
+
+    print("\nSummary: " + ", ".join("{} {}".format(v, k) for k, v in sorted(counts.items())))
+
+    if counts.get("REGRESSION", 0) or counts.get("FAILED", 0):
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
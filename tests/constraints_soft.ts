@@ -1,12 +1,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string.h>
 #include <math.h>
 
 #include <ViennaRNA/data_structures.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/mfe/global.h>
+#include <ViennaRNA/partfunc/global.h>
+#include <ViennaRNA/sampling/basic.h>
+#include <ViennaRNA/perturbation_fold.h>
+#include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/constraints/soft.h>
 
+static int    num_scores = 0;
+static double scores[128];
+
+
+static void
+record_score(int    iteration,
+             double score,
+             double *epsilon)
+{
+  if (num_scores < 128)
+    scores[num_scores++] = score;
+}
+
+
 #suite Constraints
 
 #tcase  SoftConstraints
@@ -218,5 +240,135 @@
 }
 
 
+#tcase  Perturbation
+
+#test test_vrna_sc_minimize_pertubation_lbfgs
+{
+  const char            *seq = "GGGGAAAACCCCAUCGAUCGGCUAGCUAAAAGCUAGCCGAUCGAU";
+  unsigned int          i, n;
+  double                mfe, f, *eps_true, *eps, *q, *p;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  n         = strlen(seq);
+  eps_true  = (double *)vrna_alloc(sizeof(double) * (n + 1));
+  eps       = (double *)vrna_alloc(sizeof(double) * (n + 1));
+  q         = (double *)vrna_alloc(sizeof(double) * (n + 1));
+  p         = (double *)vrna_alloc(sizeof(double) * (n + 1));
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 1;
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+  /* observed probabilities to be unpaired from a known perturbation that opens the first helix */
+  for (i = 1; i <= 4; i++)
+    eps_true[i] = -3.;
+
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  ck_assert_int_eq(vrna_sc_perturbation_derivatives(fc, eps_true, NULL, q, NULL), 1);
+
+  num_scores = 0;
+  vrna_sc_minimize_pertubation(fc, q, VRNA_OBJECTIVE_FUNCTION_QUADRATIC, 0.01, 1.,
+                               VRNA_MINIMIZER_LBFGS, 0, eps,
+                               0.01, 1e-15, 1e-3, 1e-3,
+                               &record_score);
+
+  /* the objective never increases and drops by more than an order of magnitude */
+  ck_assert_int_gt(num_scores, 1);
+  for (i = 1; i < num_scores; i++)
+    ck_assert(scores[i] <= scores[i - 1]);
+
+  ck_assert(scores[num_scores - 1] < 0.05 * scores[0]);
+
+  /* the reported score belongs to the returned perturbation vector */
+  ck_assert_int_eq(vrna_sc_perturbation_derivatives(fc, eps, NULL, p, NULL), 1);
+  for (f = 0., i = 1; i <= n; i++)
+    f += eps[i] * eps[i] + (p[i] - q[i]) * (p[i] - q[i]) / 0.01;
+
+  ck_assert(fabs(f - scores[num_scores - 1]) < 1e-3 * f);
+
+  /* the perturbation points towards the helix being opened */
+  for (i = 1; i <= 4; i++)
+    ck_assert(eps[i] < -0.5);
+
+  vrna_fold_compound_free(fc);
+  free(eps_true);
+  free(eps);
+  free(q);
+  free(p);
+}
+
+#test test_vrna_pbacktrack_sc_up_only
+{
+  /*
+   *  Stochastic backtracking through multibranch loops with soft constraints
+   *  for unpaired nucleotides only used to call the missing decomp_ml callback
+   */
+  const char            *seq =
+    "GGGAAAUCCCGCGGCCAUGGCGGCCGGGAGCAUCUCUGCUCGCCCGUUACAUGCGAUUCGCUAAGGCUGUCAUCGAAUCGCUAACAGCUACGCCUACGCUGGCAGUUCGGCUGCCGUGA";
+  unsigned int          i, k, n, num;
+  double                mfe, *eps, *q, *freq;
+  char                  **s;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  n     = strlen(seq);
+  num   = 1000;
+  eps   = (double *)vrna_alloc(sizeof(double) * (n + 1));
+  q     = (double *)vrna_alloc(sizeof(double) * (n + 1));
+  freq  = (double *)vrna_alloc(sizeof(double) * (n + 1));
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 1;
+
+  for (i = 1; i <= 4; i++)
+    eps[i] = -3.;
+
+  /* reference probabilities to be unpaired */
+  fc  = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  ck_assert_int_eq(vrna_sc_perturbation_derivatives(fc, eps, NULL, q, NULL), 1);
+  vrna_fold_compound_free(fc);
+
+  /* the same perturbation as soft constraints for unpaired nucleotides */
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  for (i = 1; i <= n; i++)
+    vrna_sc_add_up(fc, i, eps[i], VRNA_OPTION_DEFAULT);
+
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  vrna_pf(fc, NULL);
+
+  s = vrna_pbacktrack_num(fc, num, VRNA_PBACKTRACK_DEFAULT);
+  ck_assert(s != NULL);
+
+  for (k = 0; s[k]; k++) {
+    ck_assert_int_eq(strlen(s[k]), n);
+    for (i = 1; i <= n; i++)
+      if (s[k][i - 1] == '.')
+        freq[i] += 1.;
+
+    free(s[k]);
+  }
+
+  ck_assert_int_eq(k, num);
+
+  /* sampled frequencies agree with the probabilities */
+  for (i = 1; i <= n; i++)
+    ck_assert(fabs(freq[i] / num - q[i]) < 0.07);
+
+  free(s);
+  vrna_fold_compound_free(fc);
+  free(eps);
+  free(q);
+  free(freq);
+}
+
+
 #main-pre
     srunner_set_tap(sr, "-");
@@ -1,7 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
 #include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/params/io.h>
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/loops/all.h>
 
+#define CACHE_TEST_MODELS   11
+#define CACHE_TEST_THREADS  8
+#define CACHE_TEST_ROUNDS   40
+
+struct cache_test_ref {
+  vrna_md_t         md[CACHE_TEST_MODELS];
+  vrna_param_t      *P[CACHE_TEST_MODELS];
+  vrna_exp_param_t  *exp_P[CACHE_TEST_MODELS];
+  int               thread;
+  int               mismatches;
+};
+
+
+static void
+cache_test_models(vrna_md_t *md)
+{
+  int i;
+
+  for (i = 0; i < CACHE_TEST_MODELS; i++) {
+    vrna_md_set_default(&(md[i]));
+    md[i].temperature = 20. + 3. * i;
+    md[i].dangles     = (i % 3 == 0) ? 0 : 2;
+    if (i % 4 == 1)
+      md[i].salt = 0.5 + 0.1 * i;
+  }
+}
+
+
+static int
+cache_test_compare(vrna_param_t     *P,
+                   vrna_exp_param_t *exp_P,
+                   vrna_param_t     *ref,
+                   vrna_exp_param_t *exp_ref)
+{
+  return (P->stack[1][2] != ref->stack[1][2]) ||
+         (P->hairpin[6] != ref->hairpin[6]) ||
+         (P->internal_loop[5] != ref->internal_loop[5]) ||
+         (P->MLclosing != ref->MLclosing) ||
+         (P->TerminalAU != ref->TerminalAU) ||
+         (P->dangle5[1][2] != ref->dangle5[1][2]) ||
+         (P->int11[1][2][3][4] != ref->int11[1][2][3][4]) ||
+         (P->int21[1][2][1][2][3] != ref->int21[1][2][1][2][3]) ||
+         (P->int22[1][2][1][2][3][4] != ref->int22[1][2][1][2][3][4]) ||
+         (P->model_details.temperature != ref->model_details.temperature) ||
+         (exp_P->expstack[1][2] != exp_ref->expstack[1][2]) ||
+         (exp_P->exphairpin[6] != exp_ref->exphairpin[6]) ||
+         (exp_P->expint21[1][2][1][2][3] != exp_ref->expint21[1][2][1][2][3]) ||
+         (exp_P->expint22[1][2][1][2][3][4] != exp_ref->expint22[1][2][1][2][3][4]) ||
+         (exp_P->kT != exp_ref->kT);
+}
+
+
+static void *
+cache_test_worker(void *data)
+{
+  int                   r, i, m, mismatches;
+  vrna_param_t          *P;
+  vrna_exp_param_t      *exp_P;
+  struct cache_test_ref *ref = (struct cache_test_ref *)data;
+
+  mismatches = 0;
+
+  for (r = 0; r < CACHE_TEST_ROUNDS; r++) {
+    for (i = 0; i < CACHE_TEST_MODELS; i++) {
+      m     = (i + r + ref->thread) % CACHE_TEST_MODELS;
+      P     = vrna_params(&(ref->md[m]));
+      exp_P = vrna_exp_params(&(ref->md[m]));
+
+      mismatches += cache_test_compare(P, exp_P, ref->P[m], ref->exp_P[m]);
+
+      vrna_params_free(P);
+      vrna_exp_params_free(exp_P);
+    }
+
+    /* evict everything every now and then while the other threads keep going */
+    if ((ref->thread == 0) &&
+        (r % 8 == 7))
+      vrna_params_cache_clear();
+  }
+
+  return (void *)(long)mismatches;
+}
+
+
 #suite EnergyEvaluation
 
 /*
@@ -165,6 +255,10 @@
     0
   };
 
+  /* 1x2 and 2x2 interior loop tables are not part of the structure itself */
+  param.int21 = vrna_alloc(sizeof(*param.int21) * (NBPAIRS + 1));
+  param.int22 = vrna_alloc(sizeof(*param.int22) * (NBPAIRS + 1));
+
   param.stack[1][2] = 1;
   ck_assert_int_eq(E_IntLoop(0, 0, 1, 2, -1, -1, -1, -1, &param), 1);
 
@@ -207,6 +301,129 @@
   param.mismatchI[2][4][3]  = 3;
   ck_assert_int_eq(E_IntLoop(3, 5, 1, 2, 1, 2, 3, 4, &param), 235);
   ck_assert_int_eq(E_IntLoop(5, 3, 1, 2, 1, 2, 3, 4, &param), 235);
+
+  free(param.int21);
+  free(param.int22);
+}
+
+
+#suite Energy_Parameters
+
+#tcase Parameter_Cache
+
+#test test_params_cache_threads
+{
+  int                   i, mismatches;
+  void                  *res;
+  pthread_t             threads[CACHE_TEST_THREADS];
+  struct cache_test_ref refs[CACHE_TEST_THREADS];
+
+  cache_test_models(refs[0].md);
+
+  /* reference parameters, each derived from scratch */
+  for (i = 0; i < CACHE_TEST_MODELS; i++) {
+    vrna_params_cache_clear();
+    refs[0].P[i]      = vrna_params(&(refs[0].md[i]));
+    refs[0].exp_P[i]  = vrna_exp_params(&(refs[0].md[i]));
+  }
+
+  /* copies obtained from the cache equal the reference */
+  for (i = 0; i < CACHE_TEST_MODELS; i++) {
+    vrna_param_t      *P      = vrna_params(&(refs[0].md[i]));
+    vrna_exp_param_t  *exp_P  = vrna_exp_params(&(refs[0].md[i]));
+    ck_assert_int_eq(cache_test_compare(P, exp_P, refs[0].P[i], refs[0].exp_P[i]), 0);
+    vrna_params_free(P);
+    vrna_exp_params_free(exp_P);
+  }
+
+  for (i = 0; i < CACHE_TEST_THREADS; i++) {
+    refs[i]         = refs[0];
+    refs[i].thread  = i;
+    ck_assert_int_eq(pthread_create(&(threads[i]), NULL, cache_test_worker, &(refs[i])), 0);
+  }
+
+  mismatches = 0;
+  for (i = 0; i < CACHE_TEST_THREADS; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], &res), 0);
+    mismatches += (int)(long)res;
+  }
+
+  ck_assert_int_eq(mismatches, 0);
+
+  for (i = 0; i < CACHE_TEST_MODELS; i++) {
+    vrna_params_free(refs[0].P[i]);
+    vrna_exp_params_free(refs[0].exp_P[i]);
+  }
+
+  vrna_params_cache_clear();
+}
+
+
+#tcase Parameter_Snapshots
+
+#test test_params_snapshot
+{
+  char              snapshot[] = "/tmp/vrna-test-XXXXXX";
+  int               fd;
+  FILE              *fp;
+  vrna_md_t         md;
+  vrna_param_t      *P, *ref;
+  vrna_exp_param_t  *exp_P, *exp_ref;
+
+  ck_assert_int_ne(vrna_params_load_RNA_Turner2004(), 0);
+
+  vrna_md_set_default(&md);
+  md.temperature  = 42.;
+  md.dangles      = 0;
+
+  vrna_params_cache_clear();
+  ref     = vrna_params(&md);
+  exp_ref = vrna_exp_params(&md);
+
+  fd = mkstemp(snapshot);
+  ck_assert(fd != -1);
+  close(fd);
+
+  ck_assert_int_ne(vrna_params_snapshot_save(snapshot, &md), 0);
+
+  /* parameters obtained through a loaded snapshot equal freshly derived ones */
+  vrna_params_cache_clear();
+  ck_assert_int_ne(vrna_params_snapshot_load(snapshot), 0);
+
+  P     = vrna_params(&md);
+  exp_P = vrna_exp_params(&md);
+  ck_assert_int_eq(cache_test_compare(P, exp_P, ref, exp_ref), 0);
+  ck_assert(memcmp(P->int22, ref->int22, sizeof(int) * (NBPAIRS + 1) * (NBPAIRS + 1) * 625) == 0);
+  vrna_params_free(P);
+  vrna_exp_params_free(exp_P);
+
+  /* snapshots derived from a different energy parameter set are rejected */
+  ck_assert_int_ne(vrna_params_load_RNA_Andronescu2007(), 0);
+  ck_assert_int_eq(vrna_params_snapshot_load(snapshot), 0);
+
+  P     = vrna_params(&md);
+  exp_P = vrna_exp_params(&md);
+  ck_assert_int_ne(cache_test_compare(P, exp_P, ref, exp_ref), 0);
+  vrna_params_free(P);
+  vrna_exp_params_free(exp_P);
+
+  /* and accepted again once the original parameter set is back */
+  ck_assert_int_ne(vrna_params_load_RNA_Turner2004(), 0);
+  ck_assert_int_ne(vrna_params_snapshot_load(snapshot), 0);
+
+  /* truncated snapshots are rejected, release the mapped file before truncating it */
+  vrna_params_cache_clear();
+  fp = fopen(snapshot, "r+b");
+  ck_assert(fp != NULL);
+  ck_assert_int_eq(ftruncate(fileno(fp), 128), 0);
+  fclose(fp);
+  ck_assert_int_eq(vrna_params_snapshot_load(snapshot), 0);
+
+  unlink(snapshot);
+
+  vrna_params_free(ref);
+  vrna_exp_params_free(exp_ref);
+  vrna_params_cache_clear();
 }
 
 
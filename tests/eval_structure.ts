@@ -2,12 +2,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 
 
 #include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/utils/structures.h>
+#include <ViennaRNA/part_func.h>
+#include <ViennaRNA/boltzmann_sampling.h>
 #include "ViennaRNA/eval.h"
 
+#define BATCH_SAMPLES 200
+
 typedef struct {
   char  *sequence;
   char  *structure;
@@ -150,5 +156,121 @@ typedef struct {
 }
 
 
+#test eval_structures_batch
+{
+  const char            *seqs[] = {
+    "GGGCUAUUAGCUCAGUUGGUUAGAGCGCACCCCUGAUAAGGGUGAGGUCGCUGAUUCGAAUUCAGCAUAGCCCA",
+    "AUGCUAGCUAGGCUAUAUCCGGAUAGCCGCUAAAGCGGCUACGAUCGAUCGAUGCUAGCUAGCAUCGAUCGA"
+  };
+  const double          salts[] = {
+    1.021, 0.3
+  };
+  char                  **samples[2], **sequences, **structures;
+  short                 **pts;
+  int                   *e_pt;
+  float                 *e, *e_batch, ref;
+  unsigned int          i, j, k, d, s, num, mismatches;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  /* draw structures from the equilibrium ensembles at an elevated temperature */
+  for (i = 0; i < 2; i++) {
+    vrna_md_set_default(&md);
+    md.uniq_ML      = 1;
+    md.temperature  = 50.;
+    fc              = vrna_fold_compound(seqs[i], &md, VRNA_OPTION_DEFAULT);
+    vrna_pf(fc, NULL);
+    samples[i] = vrna_pbacktrack_num(fc, BATCH_SAMPLES, VRNA_PBACKTRACK_DEFAULT);
+    ck_assert(samples[i] != NULL);
+    vrna_fold_compound_free(fc);
+  }
+
+  /* the batch alternates between the sequences in blocks of different size */
+  num         = 2 * BATCH_SAMPLES;
+  sequences   = (char **)vrna_alloc(sizeof(char *) * num);
+  structures  = (char **)vrna_alloc(sizeof(char *) * num);
+  for (k = 0, i = 0; i < BATCH_SAMPLES; i += 25)
+    for (j = 0; j < 2; j++)
+      for (s = i; s < i + 25; s++) {
+        sequences[k]    = (char *)seqs[j];
+        structures[k++] = samples[j][s];
+      }
+
+  e       = (float *)vrna_alloc(sizeof(float) * num);
+  e_batch = (float *)vrna_alloc(sizeof(float) * num);
+  e_pt    = (int *)vrna_alloc(sizeof(int) * BATCH_SAMPLES);
+  pts     = (short **)vrna_alloc(sizeof(short *) * BATCH_SAMPLES);
+
+  for (d = 0; d <= 3; d++)
+    for (s = 0; s < 2; s++) {
+      vrna_md_set_default(&md);
+      md.dangles  = d;
+      md.salt     = salts[s];
+
+      mismatches = 0;
+
+      for (i = 0; i < 2; i++) {
+        fc = vrna_fold_compound(seqs[i], &md, VRNA_OPTION_EVAL_ONLY);
+
+        ck_assert_int_eq(vrna_eval_structures(fc, (const char **)samples[i], BATCH_SAMPLES, e), 1);
+
+        for (j = 0; j < BATCH_SAMPLES; j++)
+          pts[j] = vrna_ptable(samples[i][j]);
+
+        ck_assert_int_eq(vrna_eval_structures_pt(fc, (const short **)pts, BATCH_SAMPLES, e_pt), 1);
+
+        for (j = 0; j < BATCH_SAMPLES; j++) {
+          ref = vrna_eval_structure(fc, samples[i][j]);
+          if ((fabs(e[j] - ref) > 1e-4) ||
+              (e_pt[j] != vrna_eval_structure_pt(fc, pts[j])))
+            mismatches++;
+
+          free(pts[j]);
+        }
+
+        vrna_fold_compound_free(fc);
+      }
+
+      ck_assert_msg(mismatches == 0,
+                    "vrna_eval_structures() differs from vrna_eval_structure() for %u structures (d%u, salt %g)",
+                    mismatches, d, salts[s]);
+
+      ck_assert_int_eq(vrna_eval_batch((const char **)sequences,
+                                       (const char **)structures,
+                                       num,
+                                       &md,
+                                       e_batch,
+                                       2),
+                       1);
+
+      for (k = 0; k < num; k++) {
+        fc  = vrna_fold_compound(sequences[k], &md, VRNA_OPTION_EVAL_ONLY);
+        ref = vrna_eval_structure(fc, structures[k]);
+        if (fabs(e_batch[k] - ref) > 1e-4)
+          mismatches++;
+
+        vrna_fold_compound_free(fc);
+      }
+
+      ck_assert_msg(mismatches == 0,
+                    "vrna_eval_batch() differs from vrna_eval_structure() for %u structures (d%u, salt %g)",
+                    mismatches, d, salts[s]);
+    }
+
+  for (i = 0; i < 2; i++) {
+    for (j = 0; j < BATCH_SAMPLES; j++)
+      free(samples[i][j]);
+    free(samples[i]);
+  }
+
+  free(sequences);
+  free(structures);
+  free(pts);
+  free(e_pt);
+  free(e);
+  free(e_batch);
+}
+
+
 #main-pre
     srunner_set_tap(sr, "-");
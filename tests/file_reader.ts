@@ -0,0 +1,378 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifdef VRNA_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef VRNA_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/io/file_formats.h>
+#include <ViennaRNA/io/file_reader.h>
+
+struct pipe_writer {
+  int         fd;
+  const char  *data;
+  size_t      size;
+};
+
+
+static int
+make_temp_file(char tempfile[42])
+{
+  int fd;
+
+  errno = 0;
+
+  memset(tempfile, 0, 42);
+  strncpy(tempfile, "/tmp/vrna-test-XXXXXX", 22);
+
+  if ((fd = mkstemp(tempfile)) < 1)
+    fprintf(stderr,
+            "Creation of temp file failed with error [%s]\n",
+            strerror(errno));
+
+  return fd;
+}
+
+
+static int
+write_temp_file(char        tempfile[42],
+                const char  *data,
+                size_t      size)
+{
+  int fd = make_temp_file(tempfile);
+
+  if (fd > 0) {
+    write(fd, data, sizeof(char) * size);
+    close(fd);
+  }
+
+  return (fd > 0) ? 1 : 0;
+}
+
+
+static void *
+pipe_writer_thread(void *arg)
+{
+  size_t              n;
+  ssize_t             w;
+  struct pipe_writer  *pw = (struct pipe_writer *)arg;
+
+  for (n = 0; n < pw->size; n += (size_t)w) {
+    w = write(pw->fd, pw->data + n, pw->size - n);
+    if (w <= 0)
+      break;
+  }
+
+  close(pw->fd);
+
+  return NULL;
+}
+
+
+/*
+ *  Many lines of different length, including empty lines, and one
+ *  line that exceeds the initial buffer size of the reader. The
+ *  text spans several buffer refills of the reader.
+ */
+static char *
+make_text(size_t *size)
+{
+  size_t  i, l, n, long_line;
+  char    *text;
+
+  long_line = 3 * (1UL << 19);  /* 1.5 times the size of the reader buffer */
+  text      = (char *)vrna_alloc(sizeof(char) * (long_line + 4 * (1UL << 20)));
+  n         = 0;
+
+  for (i = 0; i < 60000; i++) {
+    if (i == 30000) {
+      for (l = 0; l < long_line; l++)
+        text[n++] = "ACGU"[l % 4];
+      text[n++] = '\n';
+    }
+
+    if (i % 5 == 0)
+      n += sprintf(text + n, ">record_%lu\n", (unsigned long)i);
+    else if (i % 17 == 0)
+      text[n++] = '\n';
+    else
+      for (l = 0; l < 10 + (i * 7) % 53; l++)
+        text[n++] = "ACGU"[(i + l) % 4];
+
+    text[n++] = '\n';
+  }
+
+  text[n] = '\0';
+  *size   = n;
+
+  return text;
+}
+
+
+/* compare the lines handed out by a reader with the expected text */
+static int
+check_lines(vrna_file_reader_t  *reader,
+            const char          *text,
+            size_t              size)
+{
+  size_t  l, n, num;
+  char    *line;
+  char    *nl;
+
+  num = 0;
+
+  for (n = 0; n < size; n += l + 1) {
+    nl  = memchr(text + n, '\n', size - n);
+    l   = (nl) ? (size_t)(nl - (text + n)) : size - n;
+
+    line = vrna_file_reader_line(reader);
+    if ((!line) ||
+        (strlen(line) != l) ||
+        (memcmp(line, text + n, l) != 0)) {
+      fprintf(stderr, "line %lu differs\n", (unsigned long)num);
+      free(line);
+      return 0;
+    }
+
+    free(line);
+    num++;
+  }
+
+  /* nothing left */
+  line = vrna_file_reader_line(reader);
+  if (line) {
+    fprintf(stderr, "unexpected line \"%.20s\" after the end of input\n", line);
+    free(line);
+    return 0;
+  }
+
+  return 1;
+}
+
+
+#suite File_Reader
+
+#tcase Plain_Text
+
+#test test_file_reader_plain
+{
+  char                tempfile[42];
+  const char          text[] = ">seq1\nGGGAAACCC\n\n(((...)))\n>seq2\nACGU";
+  size_t              size;
+  char                *data;
+  vrna_file_reader_t  *reader;
+
+  /* with and without trailing newline */
+  ck_assert(write_temp_file(tempfile, text, strlen(text)));
+  reader = vrna_file_reader_open(tempfile);
+  ck_assert(reader != NULL);
+  ck_assert_int_eq(vrna_file_reader_compression(reader), VRNA_FILE_READER_PLAIN);
+  ck_assert(check_lines(reader, text, strlen(text)));
+  vrna_file_reader_close(reader);
+  unlink(tempfile);
+
+  data = make_text(&size);
+  ck_assert(write_temp_file(tempfile, data, size));
+  reader = vrna_file_reader_open(tempfile);
+  ck_assert(check_lines(reader, data, size));
+  vrna_file_reader_close(reader);
+  unlink(tempfile);
+
+  /* empty file */
+  ck_assert(write_temp_file(tempfile, "", 0));
+  reader = vrna_file_reader_open(tempfile);
+  ck_assert(reader != NULL);
+  ck_assert(vrna_file_reader_line(reader) == NULL);
+  vrna_file_reader_close(reader);
+  unlink(tempfile);
+
+  ck_assert(vrna_file_reader_open("/tmp/vrna-test-does-not-exist") == NULL);
+
+  free(data);
+}
+
+
+#test test_file_reader_pipe
+{
+  int                 fds[2];
+  size_t              size;
+  char                *data;
+  FILE                *fp;
+  pthread_t           writer;
+  struct pipe_writer  pw;
+  vrna_file_reader_t  *reader;
+
+  /* the text exceeds the pipe capacity, so records arrive in pieces */
+  data = make_text(&size);
+
+  ck_assert_int_eq(pipe(fds), 0);
+
+  pw.fd   = fds[1];
+  pw.data = data;
+  pw.size = size;
+  ck_assert_int_eq(pthread_create(&writer, NULL, pipe_writer_thread, &pw), 0);
+
+  fp      = fdopen(fds[0], "r");
+  reader  = vrna_file_reader_stream(fp);
+  ck_assert(reader != NULL);
+  ck_assert_int_eq(vrna_file_reader_compression(reader), VRNA_FILE_READER_PLAIN);
+  ck_assert(check_lines(reader, data, size));
+  vrna_file_reader_close(reader);
+
+  pthread_join(writer, NULL);
+  fclose(fp);
+  free(data);
+}
+
+
+#test test_file_reader_fasta_parity
+{
+  char                tempfile[42];
+  const char          text[] =
+    "# comment\n"
+    ">seq1 some description\n"
+    "GGGAAACCC\n"
+    "GGGAAACCC\n"
+    "(((...)))\n"
+    "\n"
+    ">seq2\n"
+    "acguacguacgu\n"
+    "xxxx........ # constraint\n"
+    "ACGUACGU\n"
+    ">seq3\n"
+    "GGGGAAAACCCC&GGGAAACCC\n"
+    "((((....))))&(((...)))";
+  char                *h1, *s1, **r1, *h2, *s2, **r2;
+  unsigned int        i, t1, t2, records;
+  FILE                *fp;
+  vrna_file_reader_t  *reader;
+
+  ck_assert(write_temp_file(tempfile, text, strlen(text)));
+
+  fp      = fopen(tempfile, "r");
+  reader  = vrna_file_reader_open(tempfile);
+  records = 0;
+
+  do {
+    t1  = vrna_file_fasta_read_record(&h1, &s1, &r1, fp, 0);
+    t2  = vrna_file_reader_fasta_record(reader, &h2, &s2, &r2, 0);
+
+    ck_assert_int_eq(t1, t2);
+
+    if (t1 & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
+
+    ck_assert((h1 == NULL) == (h2 == NULL));
+    if (h1)
+      ck_assert_str_eq(h1, h2);
+
+    ck_assert_str_eq(s1, s2);
+
+    for (i = 0; r1[i]; i++) {
+      ck_assert(r2[i] != NULL);
+      ck_assert_str_eq(r1[i], r2[i]);
+      free(r1[i]);
+      free(r2[i]);
+    }
+    ck_assert(r2[i] == NULL);
+
+    free(h1);
+    free(h2);
+    free(s1);
+    free(s2);
+    free(r1);
+    free(r2);
+
+    records++;
+  } while (1);
+
+  ck_assert_int_eq(records, 4);
+
+  vrna_file_reader_close(reader);
+  fclose(fp);
+  unlink(tempfile);
+}
+
+
+#tcase Compressed_Input
+
+#test test_file_reader_gzip
+{
+#ifdef VRNA_WITH_ZLIB
+  char                tempfile[42];
+  size_t              size, half;
+  char                *data;
+  int                 fd;
+  gzFile              gz;
+  vrna_file_reader_t  *reader;
+
+  data = make_text(&size);
+
+  /* two gzip members with a line split between them, just like 'cat a.gz b.gz' */
+  half  = size / 2 + 3;
+  fd    = make_temp_file(tempfile);
+  ck_assert(fd > 0);
+  close(fd);
+
+  gz = gzopen(tempfile, "wb");
+  ck_assert_int_eq(gzwrite(gz, data, (unsigned int)half), (int)half);
+  gzclose(gz);
+
+  gz = gzopen(tempfile, "ab");
+  ck_assert_int_eq(gzwrite(gz, data + half, (unsigned int)(size - half)), (int)(size - half));
+  gzclose(gz);
+
+  reader = vrna_file_reader_open(tempfile);
+  ck_assert(reader != NULL);
+  ck_assert_int_eq(vrna_file_reader_compression(reader), VRNA_FILE_READER_GZIP);
+  ck_assert(check_lines(reader, data, size));
+  vrna_file_reader_close(reader);
+
+  unlink(tempfile);
+  free(data);
+#endif
+}
+
+
+#test test_file_reader_zstd
+{
+#ifdef VRNA_WITH_ZSTD
+  char                tempfile[42];
+  size_t              size, csize;
+  char                *data, *cdata;
+  vrna_file_reader_t  *reader;
+
+  /*
+   *  the text is highly compressible, so the decoder produces much more
+   *  output than fits into the reader buffer from the last input chunk
+   */
+  data  = make_text(&size);
+  cdata = (char *)vrna_alloc(sizeof(char) * ZSTD_compressBound(size));
+  csize = ZSTD_compress(cdata, ZSTD_compressBound(size), data, size, 19);
+  ck_assert(!ZSTD_isError(csize));
+
+  ck_assert(write_temp_file(tempfile, cdata, csize));
+  reader = vrna_file_reader_open(tempfile);
+  ck_assert(reader != NULL);
+  ck_assert_int_eq(vrna_file_reader_compression(reader), VRNA_FILE_READER_ZSTD);
+  ck_assert(check_lines(reader, data, size));
+  vrna_file_reader_close(reader);
+
+  unlink(tempfile);
+  free(cdata);
+  free(data);
+#endif
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
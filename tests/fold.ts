@@ -1,5 +1,7 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <string.h>     /* strlen */
+#include <math.h>       /* fabs */
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
@@ -8,6 +10,109 @@
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
 #include <ViennaRNA/part_func.h>
+#include <ViennaRNA/density_of_states.h>
+#include <ViennaRNA/heat_capacity.h>
+#include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/2Dfold.h>
+#include <ViennaRNA/2Dpfold.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct hc_results {
+  unsigned int  num;
+  float         T[100];
+  float         hc[100];
+};
+
+
+static void
+collect_heat_capacity(float temp,
+                      float heat_capacity,
+                      void  *data)
+{
+  struct hc_results *r = (struct hc_results *)data;
+
+  if (r->num < 100) {
+    r->T[r->num]  = temp;
+    r->hc[r->num] = heat_capacity;
+  }
+
+  r->num++;
+}
+
+
+struct TwoD_class {
+  int     k;
+  int     l;
+  float   mfe;  /* minimum free energy of the class */
+  double  G;    /* ensemble free energy of the class */
+};
+
+
+/* compare RNA2Dfold results with a list of reference distance classes */
+static void
+check_TwoD(const char         *sequence,
+           const char         *s1,
+           const char         *s2,
+           int                maxD1,
+           int                maxD2,
+           struct TwoD_class  *ref,
+           unsigned int       num)
+{
+  unsigned int          i, n;
+  double                mfe, kT, G;
+  vrna_sol_TwoD_t       *mfe_s;
+  vrna_sol_TwoD_pf_t    *pf_s;
+  vrna_fold_compound_t  *fc;
+
+  n   = strlen(sequence);
+  fc  = vrna_fold_compound_TwoD(sequence, s1, s2, NULL, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+  ck_assert(fc != NULL);
+
+  mfe_s = vrna_mfe_TwoD(fc, maxD1, maxD2);
+  ck_assert(mfe_s != NULL);
+
+  mfe = (double)mfe_s[0].en;
+  for (i = 0; mfe_s[i].k != INF; i++) {
+    ck_assert(i < num);
+    ck_assert_int_eq(mfe_s[i].k, ref[i].k);
+    ck_assert_int_eq(mfe_s[i].l, ref[i].l);
+    ck_assert_msg(fabs(mfe_s[i].en - ref[i].mfe) < 1e-4,
+                  "MFE of class (%d,%d) is %6.2f instead of %6.2f",
+                  ref[i].k, ref[i].l, mfe_s[i].en, ref[i].mfe);
+
+    if (mfe_s[i].en < mfe)
+      mfe = (double)mfe_s[i].en;
+
+    free(mfe_s[i].s);
+  }
+  ck_assert_int_eq(i, num);
+  free(mfe_s);
+
+  vrna_exp_params_rescale(fc, &mfe);
+
+  pf_s = vrna_pf_TwoD(fc, maxD1, maxD2);
+  ck_assert(pf_s != NULL);
+
+  kT = fc->exp_params->kT / 1000.;
+  for (i = 0; pf_s[i].k != INF; i++) {
+    ck_assert(i < num);
+    ck_assert_int_eq(pf_s[i].k, ref[i].k);
+    ck_assert_int_eq(pf_s[i].l, ref[i].l);
+
+    G = -kT * (log(pf_s[i].q) + n * log(fc->exp_params->pf_scale));
+    ck_assert_msg(fabs(G - ref[i].G) < 1e-3,
+                  "ensemble free energy of class (%d,%d) is %8.4f instead of %8.4f",
+                  ref[i].k, ref[i].l, G, ref[i].G);
+  }
+  ck_assert_int_eq(i, num);
+  free(pf_s);
+
+  vrna_fold_compound_free(fc);
+}
+
 
 #suite  MFE_Prediction
 
@@ -24,6 +129,177 @@
   free(structure);
 }
 
+#tcase  Sparse_Recursions
+
+#test test_mfe_sparse
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_sparse;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s1, *s2;
+  float                 mfe, mfe_sparse;
+  int                   d;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+  s2  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+
+  for (d = 0; d <= 2; d += 2) {
+    vrna_md_set_default(&md);
+    md.dangles = d;
+
+    fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    fc_sparse = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_SPARSE);
+
+    mfe         = vrna_mfe(fc, s1);
+    mfe_sparse  = vrna_mfe(fc_sparse, s2);
+
+    ck_assert(mfe == mfe_sparse);
+    ck_assert(strcmp(s1, s2) == 0);
+
+    vrna_fold_compound_free(fc);
+    vrna_fold_compound_free(fc_sparse);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+#tcase  Beam_Search
+
+#test test_mfe_beam
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_beam;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s1, *s2;
+  float                 mfe, mfe_beam;
+  int                   d;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+  s2  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+
+  for (d = 0; d <= 2; d += 2) {
+    vrna_md_set_default(&md);
+    md.dangles = d;
+
+    fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    fc_beam = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT | VRNA_OPTION_BEAM);
+
+    /* default hard constraints are evaluated on the fly */
+    ck_assert(fc_beam->hc == NULL);
+    ck_assert(fc_beam->ptype == NULL);
+
+    /* without pruning, beam search must find the exact MFE */
+    fc_beam->beam_size = 0;
+
+    mfe       = vrna_mfe(fc, s1);
+    mfe_beam  = vrna_mfe(fc_beam, s2);
+
+    ck_assert(mfe == mfe_beam);
+    ck_assert(fabs(vrna_eval_structure(fc_beam, s2) - mfe_beam) < 1e-4);
+
+    /* pruned beam search yields an upper bound */
+    fc_beam->beam_size  = 10;
+    mfe_beam            = vrna_mfe(fc_beam, s2);
+
+    ck_assert(mfe_beam >= mfe);
+    ck_assert(fabs(vrna_eval_structure(fc_beam, s2) - mfe_beam) < 1e-4);
+
+    /* user-defined hard constraints are respected */
+    vrna_hc_add_up(fc, 3, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS);
+    vrna_hc_add_up(fc_beam, 3, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS);
+    vrna_hc_add_bp(fc, 20, 97, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS | VRNA_CONSTRAINT_CONTEXT_ENFORCE);
+    vrna_hc_add_bp(fc_beam, 20, 97, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS | VRNA_CONSTRAINT_CONTEXT_ENFORCE);
+    ck_assert(fc_beam->hc != NULL);
+
+    fc_beam->beam_size  = 0;
+    mfe                 = vrna_mfe(fc, s1);
+    mfe_beam            = vrna_mfe(fc_beam, s2);
+
+    ck_assert(mfe == mfe_beam);
+    ck_assert(s2[2] == '.');
+    ck_assert((s2[19] == '(') && (s2[96] == ')'));
+
+    vrna_fold_compound_free(fc);
+    vrna_fold_compound_free(fc_beam);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+#tcase  Density_of_States
+
+#test test_dos
+{
+  /* energy bands (dcal/mol) and counts as reported by the previous RNAdos implementation */
+  const int             ref_d0[][2] = {
+    { -620, 1 }, { -540, 1 }, { -490, 1 }, { -460, 1 }, { -420, 1 }, { -380, 2 }, { -350, 4 },
+    { -340, 1 }, { -320, 1 }, { 0, 0 }
+  };
+  const int             ref_d2[][2] = {
+    { -820, 1 }, { -710, 1 }, { -700, 1 }, { -690, 2 }, { -670, 1 }, { -580, 3 }, { -570, 1 },
+    { -550, 1 }, { -530, 1 }, { -500, 2 }, { -490, 1 }, { -480, 1 }, { -470, 2 }, { -460, 1 },
+    { -450, 1 }, { -440, 1 }, { -430, 2 }, { -420, 5 }, { -410, 1 }, { -400, 3 }, { -390, 3 },
+    { -380, 2 }, { -370, 2 }, { -360, 2 }, { -350, 1 }, { -340, 2 }, { -330, 1 }, { -320, 1 },
+    { -310, 4 }, { -300, 3 }, { 0, 0 }
+  };
+  const char            sequence[]  = "GGGGAAAACCCCAUCCGAUAGCGAUCG";
+  const int             (*ref)[2];
+  char                  *s1, *s2;
+  int                   d, e, k, mfe_f5;
+  float                 mfe;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_dos_t            *dos;
+
+  s1  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+  s2  = (char *)vrna_alloc(sizeof(char) * sizeof(sequence));
+
+  for (d = 0; d <= 2; d += 2) {
+    vrna_md_set_default(&md);
+    md.dangles  = d;
+    ref         = (d == 0) ? ref_d0 : ref_d2;
+
+    fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+    mfe     = vrna_mfe(fc, s1);
+    mfe_f5  = fc->matrices->f5[fc->length];
+
+    dos = vrna_dos(fc, -300);
+    ck_assert(dos != NULL);
+    ck_assert_int_eq(dos->e_max, -300);
+
+    for (k = 0, e = dos->e_min; e <= dos->e_max; e++) {
+      if ((ref[k][1] != 0) && (ref[k][0] == e)) {
+        ck_assert_msg(dos->counts[e - dos->e_min] == (double)ref[k][1],
+                      "d%d: wrong count at %d dcal/mol (%g instead of %d)",
+                      d, e, dos->counts[e - dos->e_min], ref[k][1]);
+        k++;
+      } else {
+        ck_assert_msg(dos->counts[e - dos->e_min] == 0.,
+                      "d%d: unexpected count at %d dcal/mol (%g)",
+                      d, e, dos->counts[e - dos->e_min]);
+      }
+    }
+    ck_assert_int_eq(ref[k][1], 0);
+
+    /* the DP matrices of the caller remain intact */
+    ck_assert(fc->matrices != NULL);
+    ck_assert_int_eq(fc->matrices->f5[fc->length], mfe_f5);
+    vrna_backtrack5(fc, fc->length, s2);
+    ck_assert_str_eq(s1, s2);
+    ck_assert(fabs(vrna_eval_structure(fc, s2) - mfe) < 1e-4);
+
+    vrna_dos_free(dos);
+    vrna_fold_compound_free(fc);
+  }
+
+  free(s1);
+  free(s2);
+}
+
 #suite  Partition_Function
 
 #tcase Stochastic_Backtracking
@@ -55,6 +331,242 @@
   vrna_fold_compound_free(vc);
 }
 
+#tcase Sparse_Recursions_PF
+
+#test test_pf_sparse
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_sparse;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  unsigned int          i, j, n;
+  int                   ij;
+  double                G, G_sparse;
+
+  vrna_md_set_default(&md);
+
+  fc        = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  fc_sparse = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF | VRNA_OPTION_SPARSE);
+  n         = fc->length;
+
+  G         = vrna_pf(fc, NULL);
+  G_sparse  = vrna_pf(fc_sparse, NULL);
+
+  ck_assert(fabs(G - G_sparse) < 1e-9);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      ij = fc->iindx[i] - j;
+      ck_assert(fabs(fc->exp_matrices->probs[ij] - fc_sparse->exp_matrices->probs[ij]) < 1e-9);
+    }
+
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_sparse);
+}
+
+#tcase Beam_Search_PF
+
+#test test_pf_beam
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_beam;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  int                   ij;
+  double                G, G_beam;
+  vrna_ep_t             *ptr, *pl;
+
+  vrna_md_set_default(&md);
+  md.dangles = 0;
+
+  fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  fc_beam = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF | VRNA_OPTION_BEAM);
+
+  fc_beam->beam_size = 0;
+
+  G       = vrna_pf(fc, NULL);
+  G_beam  = vrna_pf(fc_beam, NULL);
+
+  ck_assert(fabs(G - G_beam) < 1e-4);
+  ck_assert(fc_beam->exp_matrices == NULL);
+
+  pl = vrna_plist_from_probs(fc_beam, 1e-5);
+
+  for (ptr = pl; ptr->i; ptr++) {
+    ij = fc->iindx[ptr->i] - ptr->j;
+    ck_assert(fabs(fc->exp_matrices->probs[ij] - ptr->p) < 1e-4);
+  }
+
+  free(pl);
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_beam);
+}
+
+#tcase Incremental_PF
+
+#test test_pf_update
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_inc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  unsigned int          i, j, k, n;
+  int                   ij;
+  double                G, G_inc;
+
+  vrna_md_set_default(&md);
+
+  fc      = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  fc_inc  = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  n       = fc->length;
+
+  G     = vrna_pf(fc, NULL);
+  G_inc = vrna_pf_update(fc_inc, NULL, 1, n);
+
+  ck_assert(fabs(G - G_inc) < 1e-9);
+
+  /* penalize a stretch of unpaired nucleotides */
+  for (k = 40; k <= 45; k++) {
+    vrna_sc_add_up(fc, k, 0.8, VRNA_OPTION_DEFAULT);
+    vrna_sc_add_up(fc_inc, k, 0.8, VRNA_OPTION_DEFAULT);
+  }
+
+  G     = vrna_pf(fc, NULL);
+  G_inc = vrna_pf_update(fc_inc, NULL, 40, 45);
+
+  ck_assert(fabs(G - G_inc) < 1e-9);
+
+  /* favor a single base pair */
+  vrna_sc_add_bp(fc, 87, 96, -1.5, VRNA_OPTION_DEFAULT);
+  vrna_sc_add_bp(fc_inc, 87, 96, -1.5, VRNA_OPTION_DEFAULT);
+
+  G     = vrna_pf(fc, NULL);
+  G_inc = vrna_pf_update(fc_inc, NULL, 87, 96);
+
+  ck_assert(fabs(G - G_inc) < 1e-9);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      ij = fc->iindx[i] - j;
+      ck_assert(fabs(fc->exp_matrices->probs[ij] - fc_inc->exp_matrices->probs[ij]) < 1e-9);
+    }
+
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_inc);
+}
+
+#tcase Heat_Capacity
+
+#test test_heat_capacity_mt
+{
+  /* temperatures and heat capacities as obtained from the previous serial implementation */
+  const float           ref[][2] = {
+    { 20, 0.0856 }, { 25, 0.0947 }, { 30, 0.1104 }, { 35, 0.1358 }, { 40, 0.1765 },
+    { 45, 0.2426 }, { 50, 0.3525 }, { 55, 0.5390 }, { 60, 0.8581 }, { 65, 1.3921 },
+    { 70, 2.2186 }, { 75, 3.2794 }, { 80, 4.2327 }
+  };
+  const char            sequence[] = "GGGGAAAACCCCAUCCGAUAGCGAUCGGAUGCAUCGCAUCGAUCGAUC";
+  const unsigned int    threads[] = {
+    1, 2, 3, 8, 0
+  };
+  unsigned int          i, t, num;
+  vrna_heat_capacity_t  *hc;
+  vrna_fold_compound_t  *fc;
+  struct hc_results     serial, parallel;
+
+  num = sizeof(ref) / sizeof(ref[0]);
+  fc  = vrna_fold_compound(sequence, NULL, VRNA_OPTION_DEFAULT);
+
+  hc = vrna_heat_capacity(fc, 20., 80., 5., 2);
+  ck_assert(hc != NULL);
+  for (i = 0; i < num; i++) {
+    ck_assert(hc[i].temperature == ref[i][0]);
+    ck_assert_msg(fabs(hc[i].heat_capacity - ref[i][1]) < 1e-3,
+                  "heat capacity at %g: %g instead of %g",
+                  hc[i].temperature, hc[i].heat_capacity, ref[i][1]);
+  }
+  ck_assert(hc[num].temperature < 20.);
+
+  serial.num = 0;
+  ck_assert(vrna_heat_capacity_cb_mt(fc, 20., 80., 5., 2, 1, &collect_heat_capacity, &serial));
+  ck_assert_int_eq(serial.num, num);
+
+  for (i = 0; i < num; i++) {
+    ck_assert(serial.T[i] == hc[i].temperature);
+    ck_assert(serial.hc[i] == hc[i].heat_capacity);
+  }
+
+  /* chunked parallel sweeps yield the same results in the same order */
+  for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+    parallel.num = 0;
+    ck_assert(vrna_heat_capacity_cb_mt(fc, 20., 80., 5., 2, threads[t], &collect_heat_capacity, &parallel));
+    ck_assert_int_eq(parallel.num, num);
+
+    for (i = 0; i < num; i++) {
+      ck_assert(parallel.T[i] == serial.T[i]);
+      ck_assert_msg(parallel.hc[i] == serial.hc[i],
+                    "%u threads: heat capacity at %g differs (%g instead of %g)",
+                    threads[t], parallel.T[i], parallel.hc[i], serial.hc[i]);
+    }
+  }
+
+  free(hc);
+  vrna_fold_compound_free(fc);
+}
+
+#suite  Distance_Class_Partitioning
+
+#tcase  TwoD
+
+#test test_TwoD_mfe_pf
+{
+  /* distance classes as obtained from the previous implementation */
+  struct TwoD_class     all[] = {
+    { 0, 6, -10.80, -10.8000 }, { 1, 5, -8.50, -8.5401 }, { 1, 7, -12.70, -12.7037 },
+    { 2, 4, -5.20, -5.5335 }, { 2, 6, -10.40, -10.4070 }, { 2, 8, -10.50, -10.9311 },
+    { 3, 3, -2.30, -2.6547 }, { 3, 5, -7.10, -7.1327 }, { 3, 7, -8.20, -8.6340 },
+    { 4, 2, 0.10, -0.1026 }, { 4, 4, -3.80, -3.8589 }, { 4, 6, -6.40, -6.6952 },
+    { 5, 1, 3.90, 3.2615 }, { 5, 3, -1.80, -1.8138 }, { 5, 5, -4.50, -4.8189 },
+    { 5, 7, -4.20, -4.7842 }, { 6, 0, 0.00, 0.0000 }, { 6, 2, 2.00, 1.9550 },
+    { 6, 4, -1.40, -1.7507 }, { 6, 6, -6.40, -6.5565 }, { 7, 1, 1.70, 0.9878 },
+    { 7, 3, 1.70, 1.2416 }, { 7, 5, -3.30, -3.3384 }, { 7, 7, -4.20, -4.7836 },
+    { 8, 2, -1.10, -1.6246 }, { 8, 4, 0.90, 0.5484 }, { 8, 6, -1.10, -1.6060 },
+    { 9, 3, -4.40, -4.4131 }, { 9, 5, 1.10, 0.7083 }, { 9, 7, 5.40, 5.4000 },
+    { 10, 4, -5.70, -5.7027 }, { 10, 6, 1.60, 1.5268 }, { 11, 5, -2.00, -2.3734 },
+    { 11, 7, 6.90, 6.9000 }, { 12, 6, -2.20, -2.3969 }, { 13, 7, 2.30, 2.3000 }
+  };
+  /* maximum distances 4 and 5, the remaining structures are collected in class (-1,-1) */
+  struct TwoD_class     restricted[] = {
+    { 1, 5, -8.50, -8.5401 }, { 2, 4, -5.20, -5.5335 }, { 3, 3, -2.30, -2.6547 },
+    { 3, 5, -7.10, -7.1327 }, { 4, 2, 0.10, -0.1026 }, { 4, 4, -3.80, -3.8589 },
+    { -1, -1, -12.70, -12.7776 }
+  };
+  const char            sequence[]  = "GGGCGCAAGCCUAUAUGCGCCC";
+  const char            s1[]        = "((((((..........))))))";
+  const char            s2[]        = "......................";
+  unsigned int          t;
+  int                   threads[]   = {
+    1, 4
+  };
+
+#ifdef _OPENMP
+  int                   max_threads = omp_get_max_threads();
+#endif
+
+  for (t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+#ifdef _OPENMP
+    omp_set_num_threads(threads[t]);
+#endif
+    check_TwoD(sequence, s1, s2, -1, -1, all, sizeof(all) / sizeof(all[0]));
+    check_TwoD(sequence, s1, s2, 4, 5, restricted, sizeof(restricted) / sizeof(restricted[0]));
+  }
+
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+}
+
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <ViennaRNA/datastructures/hash_tables.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 
 static unsigned
@@ -12,6 +13,14 @@ hash_function_test(void           *hash_entry,
 }
 
 
+static unsigned
+hash_function_identity(void           *hash_entry,
+                       unsigned long  hashtable_size)
+{
+  return *((unsigned int *)hash_entry) % hashtable_size;
+}
+
+
 static int
 hash_comparison_test(void *x,
                      void *y)
@@ -33,6 +42,39 @@ free_dummy(void *x)
 }
 
 
+#define MT_TEST_THREADS 8
+#define MT_TEST_KEYS    20000
+
+struct mt_test_data {
+  vrna_hash_table_mt_t  ht;
+  unsigned int          *vals;  /* MT_TEST_KEYS candidate entries for this thread */
+  unsigned int          failures;
+};
+
+
+/* every thread inserts the same keys, only one entry per key may win */
+static void *
+mt_test_worker(void *arg)
+{
+  unsigned int        i, *res;
+  struct mt_test_data *d = (struct mt_test_data *)arg;
+
+  for (i = 0; i < MT_TEST_KEYS; i++) {
+    res = (unsigned int *)vrna_ht_mt_get_or_insert(d->ht, (void *)&(d->vals[i]));
+    if ((!res) ||
+        (*res != d->vals[i]))
+      d->failures++;
+
+    res = (unsigned int *)vrna_ht_mt_get(d->ht, (void *)&(d->vals[(i * 7) % MT_TEST_KEYS]));
+    if ((res) &&
+        (*res != d->vals[(i * 7) % MT_TEST_KEYS]))
+      d->failures++;
+  }
+
+  return NULL;
+}
+
+
 #suite Hash Table
 
 #test test_vrna_hash_table
@@ -79,5 +121,151 @@ free_dummy(void *x)
 }
 
 
+#test test_vrna_hash_table_growth
+{
+  unsigned int      i, n, *vals, *res_p;
+  unsigned long     max_length, sum, *lengths;
+  vrna_hash_table_t ht;
+
+  n     = 10000;
+  vals  = (unsigned int *)malloc(sizeof(unsigned int) * n);
+  ht    = vrna_ht_init(4,
+                       hash_comparison_test,
+                       hash_function_identity,
+                       free_dummy);
+
+  ck_assert(vrna_ht_size(ht) <= 16);
+
+  for (i = 0; i < n; i++) {
+    vals[i] = 3 * i;
+    ck_assert_int_eq(vrna_ht_insert(ht, (void *)&(vals[i])), 0);
+  }
+
+  /* inserting an equal entry again leaves the table unchanged */
+  ck_assert_int_eq(vrna_ht_insert(ht, (void *)&(vals[42])), 0);
+  ck_assert_int_eq(vrna_ht_num_entries(ht), n);
+
+  /* the table grows automatically */
+  ck_assert(vrna_ht_size(ht) >= n);
+  ck_assert(vrna_ht_load_factor(ht) > 0.);
+  ck_assert(vrna_ht_load_factor(ht) < 1.);
+
+  for (i = 0; i < n; i++) {
+    res_p = vrna_ht_get(ht, (void *)&(vals[i]));
+    ck_assert_ptr_eq(res_p, &(vals[i]));
+  }
+
+  lengths = vrna_ht_probe_lengths(ht, &max_length);
+  ck_assert_ptr_ne(lengths, NULL);
+  for (sum = 0, i = 0; i <= max_length; i++)
+    sum += lengths[i];
+
+  ck_assert_int_eq(sum, n);
+  free(lengths);
+
+  /* remove every other entry */
+  for (i = 0; i < n; i += 2)
+    vrna_ht_remove(ht, (void *)&(vals[i]));
+
+  ck_assert_int_eq(vrna_ht_num_entries(ht), n / 2);
+
+  for (i = 0; i < n; i++) {
+    res_p = vrna_ht_get(ht, (void *)&(vals[i]));
+    if (i % 2)
+      ck_assert_ptr_eq(res_p, &(vals[i]));
+    else
+      ck_assert_ptr_eq(res_p, NULL);
+  }
+
+  vrna_ht_clear(ht);
+  ck_assert_int_eq(vrna_ht_num_entries(ht), 0);
+
+  vrna_ht_free(ht);
+  free(vals);
+}
+
+
+#test test_vrna_hash_table_mt
+{
+  unsigned int          i, n, *vals, val, *res_p;
+  vrna_hash_table_mt_t  ht;
+
+  n     = 1000;
+  vals  = (unsigned int *)malloc(sizeof(unsigned int) * n);
+  ht    = vrna_ht_mt_init(4,
+                          8,
+                          hash_comparison_test,
+                          hash_function_identity,
+                          free_dummy);
+
+  for (i = 0; i < n; i++) {
+    vals[i] = 7 * i;
+    ck_assert_int_eq(vrna_ht_mt_insert(ht, (void *)&(vals[i])), 0);
+  }
+
+  ck_assert_int_eq(vrna_ht_mt_num_entries(ht), n);
+
+  /* look-up by an equal key returns the stored entry */
+  val   = 7 * 13;
+  res_p = vrna_ht_mt_get(ht, (void *)&val);
+  ck_assert_ptr_eq(res_p, &(vals[13]));
+
+  res_p = vrna_ht_mt_get_or_insert(ht, (void *)&val);
+  ck_assert_ptr_eq(res_p, &(vals[13]));
+
+  val   = 7 * n;
+  res_p = vrna_ht_mt_get_or_insert(ht, (void *)&val);
+  ck_assert_ptr_eq(res_p, &val);
+  ck_assert_int_eq(vrna_ht_mt_num_entries(ht), n + 1);
+
+  vrna_ht_mt_remove(ht, (void *)&val);
+  ck_assert_ptr_eq(vrna_ht_mt_get(ht, (void *)&val), NULL);
+  ck_assert_int_eq(vrna_ht_mt_num_entries(ht), n);
+
+  vrna_ht_mt_free(ht);
+  free(vals);
+}
+
+
+#test test_vrna_hash_table_mt_concurrent
+{
+  unsigned int          i, t, failures, *vals;
+  pthread_t             threads[MT_TEST_THREADS];
+  struct mt_test_data   data[MT_TEST_THREADS];
+  vrna_hash_table_mt_t  ht;
+
+  ht = vrna_ht_mt_init(10,
+                       4,
+                       hash_comparison_test,
+                       hash_function_identity,
+                       free_dummy);
+  ck_assert(ht != NULL);
+
+  vals = (unsigned int *)malloc(sizeof(unsigned int) * MT_TEST_KEYS * MT_TEST_THREADS);
+
+  for (t = 0; t < MT_TEST_THREADS; t++) {
+    data[t].ht        = ht;
+    data[t].vals      = vals + t * MT_TEST_KEYS;
+    data[t].failures  = 0;
+    for (i = 0; i < MT_TEST_KEYS; i++)
+      data[t].vals[i] = 3 * ((i + 977 * t) % MT_TEST_KEYS);
+
+    ck_assert_int_eq(pthread_create(&(threads[t]), NULL, mt_test_worker, &(data[t])), 0);
+  }
+
+  failures = 0;
+  for (t = 0; t < MT_TEST_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+    failures += data[t].failures;
+  }
+
+  ck_assert_int_eq(failures, 0);
+  ck_assert_int_eq(vrna_ht_mt_num_entries(ht), MT_TEST_KEYS);
+
+  vrna_ht_mt_free(ht);
+  free(vals);
+}
+
+
 #main-pre
     srunner_set_tap(sr, "-");
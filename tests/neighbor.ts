@@ -5,6 +5,7 @@
 #include <ViennaRNA/utils/basic.h>
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/data_structures.h>
+#include <ViennaRNA/eval/structures.h>
 #include <stdarg.h>
 
 
@@ -617,6 +618,69 @@ test_RNA2_move_it(vrna_fold_compound_t  *vc,
   free(neighbors);
 }
 
+#test test_vrna_nbhd
+{
+  char                  *sequence   = "GGGAAAUCCCGCGCGAUAUAGCGCUUAGCGAUAGCUAGC";
+  char                  *structure  = "((((...))))....((((....))))............";
+  unsigned int          options     = VRNA_MOVESET_DEFAULT | VRNA_MOVESET_SHIFT;
+  /* shift into the enclosing loop, insertion, shift into the loop, deletion */
+  vrna_move_t           moves[4] = {
+    { 16, -32 }, { 34, 39 }, { 19, -23 }, { -2, -10 }
+  };
+  vrna_md_t             md;
+
+  vrna_md_set_default(&md);
+  vrna_fold_compound_t  *vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_EVAL_ONLY);
+  short                 *pt = vrna_ptable(structure);
+  vrna_nbhd_t           nb  = vrna_nbhd_init(vc, pt, options);
+
+  ck_assert(nb != NULL);
+
+  for (int step = 0; step <= 4; step++) {
+    int         *dE, length = 0, found = 0;
+    vrna_move_t *neighbors  = vrna_nbhd_list(nb, &dE);
+    vrna_move_t *expected   = vrna_neighbors(vc, pt, options);
+
+    ck_assert_int_eq(vrna_nbhd_energy(nb), vrna_eval_structure_pt(vc, pt));
+
+    for (vrna_move_t *m = neighbors; m->pos_5 != 0; m++, length++) {
+      ck_assert_int_eq(dE[length], vrna_eval_move_shift_pt(vc, m, pt));
+      for (vrna_move_t *e = expected; e->pos_5 != 0; e++)
+        if ((e->pos_5 == m->pos_5) && (e->pos_3 == m->pos_3)) {
+          found++;
+          break;
+        }
+    }
+
+    ck_assert_int_eq(length, (int)vrna_nbhd_size(nb));
+    ck_assert_int_eq(found, length);
+    for (vrna_move_t *e = expected; e->pos_5 != 0; e++)
+      length--;
+
+    ck_assert_int_eq(length, 0);
+
+    if (step < 4) {
+      int e = vrna_eval_move_shift_pt(vc, &(moves[step]), pt);
+      ck_assert_int_eq(vrna_nbhd_apply(nb, &(moves[step])), e);
+      vrna_move_apply(pt, &(moves[step]));
+    }
+
+    free(neighbors);
+    free(expected);
+    free(dE);
+  }
+
+  /* not a neighbor of the current structure */
+  vrna_move_t invalid = {
+    1, 2
+  };
+  ck_assert_int_eq(vrna_nbhd_apply(nb, &invalid), INF);
+
+  vrna_nbhd_free(nb);
+  vrna_fold_compound_free(vc);
+  free(pt);
+}
+
 /* Test generation of neighbor structures, without shift moves, with lonely pairs */
 #test test_rnamoves_noshift_lp
 {
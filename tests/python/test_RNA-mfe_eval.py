@@ -52,6 +52,19 @@ class mfe_eval_functionTest(unittest.TestCase):
         print( struct1, "[ %6.2f ]" % energy)
 
 
+    def test_eval_structures(self):
+        """Structure energy evaluation - batch of dot-bracket strings"""
+        fc = RNA.fold_compound(seq1)
+        energies = fc.eval_structures([struct1, struct11, "." * len(seq1)])
+        self.assertEqual(len(energies), 3)
+        for s, e in zip([struct1, struct11, "." * len(seq1)], energies):
+            self.assertEqual("%6.2f" % e, "%6.2f" % fc.eval_structure(s))
+
+        energies = RNA.eval_batch([seq1, seq1], [struct1, struct11])
+        self.assertEqual("%6.2f" % energies[0], "%6.2f" % -5.60)
+        self.assertEqual("%6.2f" % energies[1], "%6.2f" % fc.eval_structure(struct11))
+
+
     # Testing with filehandler and with stdout
     def test_eval_structure_verbose(self):
         """Structure energy evaluation - dot-bracket string - verbose output"""
@@ -111,6 +111,16 @@ class pf_window_functionTest(unittest.TestCase):
         self.assertTrue(max([max([u for u in v]) for v in up]) <= 1.)
 
 
+    def test_pfl_fold_up_array(self):
+        """RNA.pfl_fold_up_array() - unpaired probabilities as memoryview"""
+        up  = RNA.pfl_fold_up(longseq, 10, 200, 150)
+        upv = RNA.pfl_fold_up_array(longseq, 10, 200, 150)
+        self.assertEqual(upv.shape, (301, 11))
+        self.assertEqual(upv.format, 'd')
+        self.assertTrue(upv.readonly)
+        self.assertEqual(upv.tolist(), [list(v) for v in up])
+
+
     def test_probs_window(self):
         """fold_compound.probs_window() - sanity checks for probabiities"""
         data = { 'bpp': [], 'up': []}
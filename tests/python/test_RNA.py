@@ -1,4 +1,6 @@
 import os
+import gc
+import weakref
 import unittest
 from struct import *
 import locale
@@ -55,6 +57,43 @@ class GeneralTests(unittest.TestCase):
         self.assertTrue(abs(RNA.energy_of_struct(seq1, struct1) - mfe) < 0.0001)
 
 
+    def test_fold_many(self):
+        """Thread-parallel MFE prediction for a batch of sequences"""
+        import math
+        import threading
+
+        seqs = [seq1, seq2, seq3, seq1 + seq2, ""]
+        md   = RNA.md(temperature = 25)
+
+        for threads in [1, 3, 0]:
+            (structures, energies) = RNA.fold_many(seqs, md, threads = threads)
+            self.assertEqual(len(structures), len(seqs))
+            self.assertEqual(energies.format, 'd')
+            self.assertTrue(energies.readonly)
+
+            for s, ss, e in zip(seqs[:-1], structures, energies):
+                (ref_ss, ref_e) = RNA.fold_compound(s, md).mfe()
+                self.assertEqual(ss, ref_ss)
+                self.assertTrue(abs(e - ref_e) < 0.0001)
+
+            # sequences that can not be processed yield None and NaN
+            self.assertIsNone(structures[-1])
+            self.assertTrue(math.isnan(energies[-1]))
+
+        # the GIL is released, so several Python threads may fold concurrently
+        results = []
+        workers = [threading.Thread(target = lambda: results.append(RNA.fold_many(seqs[:-1])[0])) for i in range(4)]
+        for w in workers:
+            w.start()
+        for w in workers:
+            w.join()
+
+        self.assertEqual(len(results), 4)
+        for r in results:
+            self.assertEqual(r[0], struct1)
+            self.assertEqual(r, results[0])
+
+
     def test_constrained_folding(self):
         """Simple constrained MFE folding"""
         RNA.cvar.fold_constrained = 1
@@ -241,6 +280,25 @@ class GeneralTests(unittest.TestCase):
         pf_params = RNA.exp_param(md)
         self.assertEqual(pf_params.temperature,42.1)
 
+    def test_params_snapshot(self):
+        """Energy Parameter structure - binary snapshots"""
+        import tempfile
+        md = RNA.md()
+        md.temperature = 42.1
+        (ss, mfe) = RNA.fold_compound(seq1, md).mfe()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, "params.bin")
+            self.assertEqual(RNA.params_snapshot_save(filename, md), 1)
+            RNA.params_cache_clear()
+            self.assertEqual(RNA.params_snapshot_load(filename), 1)
+            self.assertEqual(RNA.params_snapshot_load(os.path.join(tmpdir, "missing.bin")), 0)
+        # snapshot stays valid after the file has been removed
+        (ss2, mfe2) = RNA.fold_compound(seq1, md).mfe()
+        self.assertEqual(ss2, ss)
+        self.assertEqual(mfe2, mfe)
+        self.assertEqual(RNA.exp_param(md).temperature, 42.1)
+        RNA.params_cache_clear()
+
 
 class FoldCompoundTest(unittest.TestCase):
     def test_create_fold_compound_Single(self):
@@ -283,6 +341,53 @@ class FoldCompoundTest(unittest.TestCase):
         self.assertTrue(bp_dis)
 
 
+    def test_bpp_view(self):
+        """fold_compound method - Views of DP matrices and base pair probabilities"""
+        fc = RNA.fold_compound(seq1)
+        fc.mfe()
+        fc.pf()
+        n   = len(seq1)
+        bpp = fc.bpp()
+
+        # dense copy of the triangular probability matrix
+        view = fc.bpp_view()
+        self.assertEqual(view.shape, (n + 1, n + 1))
+        self.assertTrue(view.readonly)
+        for i in range(1, n + 1):
+            for j in range(i + 1, n + 1):
+                self.assertEqual(view[i, j], bpp[i][j])
+
+        # raw linear arrays are views without copying
+        iindx = fc.iindx
+        raw   = fc.bpp_view(dense=False)
+        self.assertEqual(raw[iindx[1] - n], bpp[1][n])
+
+        f5 = fc.matrices.f5.view()
+        self.assertEqual(f5.format, 'i')
+        self.assertEqual(f5.shape, (n + 1,))
+        self.assertEqual(f5[n], fc.matrices.f5[n])
+
+        c = fc.matrices.c.view(dense=True)
+        jindx = fc.jindx
+        self.assertEqual(c[1, n], fc.matrices.c[jindx[n] + 1])
+
+        qb = fc.exp_matrices.qb.view(dense=True)
+        self.assertEqual(qb[1, n], fc.exp_matrices.qb[iindx[1] - n])
+
+        # views of arrays keep the fold compound alive
+        idx   = iindx[1] - n
+        ref   = fc.exp_matrices.probs[idx]
+        probs = fc.exp_matrices.probs.view()
+        owner = weakref.ref(fc)
+        del fc, view, raw, f5, c, qb, iindx, jindx
+        gc.collect()
+        self.assertIsNotNone(owner())
+        self.assertEqual(probs[idx], ref)
+        del probs
+        gc.collect()
+        self.assertIsNone(owner())
+
+
     def test_pf_dimer(self):
         """fold_compound method - Partition function for dimer"""
         fc = RNA.fold_compound(seq1 + "&" + seq2)
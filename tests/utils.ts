@@ -6,6 +6,15 @@
 #include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/alphabet.h>
 #include <ViennaRNA/mfe.h>
+#include <ViennaRNA/RNAstruct.h>
+#include <ViennaRNA/treedist.h>
+#include <ViennaRNA/stringdist.h>
+#include <ViennaRNA/structures/edit_distance.h>
+#include <ViennaRNA/structures/metrics.h>
+#include <ViennaRNA/structures/pairtable.h>
+#include <ViennaRNA/partfunc/global.h>
+#include <ViennaRNA/sampling/basic.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
 
 static int
 compare_str(const void  *a,
@@ -14,6 +23,32 @@ compare_str(const void  *a,
   return strcmp(*((const char **)a), *((const char **)b));
 }
 
+struct row_check {
+  vrna_dist_mx_t  *mx;
+  unsigned int    next;
+  unsigned int    mismatches;
+};
+
+
+/* compare the rows of a row-wise distance matrix computation against a full matrix */
+static void
+check_distance_row(unsigned int i,
+                   const float  *row,
+                   void         *data)
+{
+  struct row_check *c = (struct row_check *)data;
+
+  if (i != c->next)
+    c->mismatches++;
+
+  for (unsigned int j = 0; j < i; j++)
+    if (row[j] != vrna_dist_mx_get(c->mx, i, j))
+      c->mismatches++;
+
+  c->next = i + 1;
+}
+
+
 #suite Utilities
 
 #tcase Sequence_Utils
@@ -306,3 +341,161 @@ compare_str(const void  *a,
 
 #main-pre
     srunner_set_tap(sr, "-");
+
+#tcase Structure_Distances
+
+#test test_edit_distance_matrix
+{
+  const char        *structures[] = {
+    "((((((...((((........))))...((((.......))))...))))))....",
+    "((((((...((((........))))......................))))))...",
+    "........((((((((.....)))).))))....((((((.......))))))...",
+    "(((((.((((....)))).)))))..((((((((.......)))))....)))...",
+    "........................................................",
+    "..((((((((....))))...(((((.......))))).))))............."
+  };
+  unsigned int      i, j, num;
+  char              *s;
+  Tree              *T[6];
+  swString          *S[6];
+  vrna_edit_dist_t  *ctx;
+  vrna_dist_mx_t    *mx_tree, *mx_string;
+
+  num = sizeof(structures) / sizeof(structures[0]);
+
+  for (i = 0; i < num; i++) {
+    s     = expand_Full(structures[i]);
+    T[i]  = make_tree(s);
+    free(s);
+    s     = b2C(structures[i]);
+    S[i]  = Make_swString(s);
+    free(s);
+  }
+
+  mx_tree   = vrna_edit_dist_matrix((const void **)T, num, VRNA_EDIT_DIST_TREE, VRNA_EDIT_DIST_DEFAULT, 2, NULL);
+  mx_string = vrna_edit_dist_matrix((const void **)S, num, VRNA_EDIT_DIST_STRING, VRNA_EDIT_DIST_DEFAULT, 2, NULL);
+
+  ck_assert(mx_tree != NULL);
+  ck_assert(mx_string != NULL);
+  ck_assert_int_eq(mx_tree->size, num * (num - 1) / 2);
+
+  /* row-wise computation yields the same rows in increasing order */
+  struct row_check check = {
+    mx_tree, 1, 0
+  };
+
+  ck_assert_int_eq(vrna_edit_dist_matrix_cb((const void **)T, num, VRNA_EDIT_DIST_TREE,
+                                            VRNA_EDIT_DIST_DEFAULT, 2, &check_distance_row,
+                                            (void *)&check), 1);
+  ck_assert_int_eq(check.mismatches, 0);
+  ck_assert_int_eq(check.next, num);
+
+  edit_backtrack  = 1;
+  cost_matrix     = 0;
+  ctx             = vrna_edit_dist_init(VRNA_EDIT_DIST_BACKTRACK);
+
+  for (i = 0; i < num; i++) {
+    ck_assert(vrna_dist_mx_get(mx_tree, i, i) == 0.);
+
+    for (j = 0; j < i; j++) {
+      /* matrix entries, reentrant, and legacy functions agree */
+      ck_assert(vrna_dist_mx_get(mx_tree, i, j) == vrna_dist_mx_get(mx_tree, j, i));
+      ck_assert(vrna_dist_mx_get(mx_tree, i, j) == vrna_tree_edit_distance(ctx, T[i], T[j]));
+      ck_assert(vrna_dist_mx_get(mx_tree, i, j) == tree_edit_distance(T[i], T[j]));
+      ck_assert_str_eq(vrna_edit_dist_aligned_line(ctx, 0), aligned_line[0]);
+      ck_assert_str_eq(vrna_edit_dist_aligned_line(ctx, 1), aligned_line[1]);
+
+      ck_assert(vrna_dist_mx_get(mx_string, i, j) == vrna_string_edit_distance(ctx, S[i], S[j]));
+      ck_assert(vrna_dist_mx_get(mx_string, i, j) == string_edit_distance(S[i], S[j]));
+      ck_assert_str_eq(vrna_edit_dist_aligned_line(ctx, 0), aligned_line[0]);
+      ck_assert_str_eq(vrna_edit_dist_aligned_line(ctx, 1), aligned_line[1]);
+    }
+  }
+
+  edit_backtrack = 0;
+
+  vrna_edit_dist_free(ctx);
+  vrna_dist_mx_free(mx_tree);
+  vrna_dist_mx_free(mx_string);
+
+  for (i = 0; i < num; i++) {
+    free_tree(T[i]);
+    free(S[i]);
+  }
+}
+
+
+#test test_bp_distance_matrix
+{
+  const char            *seq =
+    "GGGAAAUCCCGCGGCCAUGGCGGCCGGGAGCAUCUCUGCUCGCCCGUUACAUGCGAUUCGCUAAGGCUGUCAUCGAAUCGCUAACAGCUACGCCUACGCUGGCAGUUCGGCUGCCGUGA";
+  unsigned int          i, j, k, num;
+  int                   *d;
+  char                  *mfe, **s;
+  short                 *pt;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_bp_set_t         *set;
+  vrna_dist_mx_t        *mx;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML = 1;
+
+  fc  = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  mfe = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+
+  vrna_mfe(fc, mfe);
+  vrna_pf(fc, NULL);
+
+  num = 200;
+  s   = vrna_pbacktrack_num(fc, num, VRNA_PBACKTRACK_DEFAULT);
+  pt  = vrna_ptable(mfe);
+
+  ck_assert(s != NULL);
+
+  /* vectorized and plain kernels */
+  for (k = 0; k < 2; k++) {
+    if (k)
+      vrna_fun_dispatch_disable();
+
+    mx  = vrna_bp_distance_matrix((const char **)s, num, 2, NULL);
+    set = vrna_bp_set((const char **)s, num);
+    d   = vrna_bp_set_distances(set, pt);
+
+    ck_assert(mx != NULL);
+    ck_assert(set != NULL);
+    ck_assert_int_eq(vrna_bp_set_size(set), num);
+
+    /* row-wise computation across several bands of rows */
+    struct row_check check = {
+      mx, 1, 0
+    };
+
+    ck_assert_int_eq(vrna_bp_set_distance_matrix_cb(set, 2, &check_distance_row, (void *)&check), 1);
+    ck_assert_int_eq(check.mismatches, 0);
+    ck_assert_int_eq(check.next, num);
+
+    for (i = 0; i < num; i++) {
+      ck_assert_int_eq(d[i], vrna_bp_distance(mfe, s[i]));
+
+      for (j = 0; j < i; j++) {
+        ck_assert_int_eq((int)vrna_dist_mx_get(mx, i, j), vrna_bp_distance(s[i], s[j]));
+        ck_assert_int_eq(vrna_bp_set_distance(set, i, j), vrna_bp_distance(s[i], s[j]));
+      }
+    }
+
+    free(d);
+    vrna_bp_set_free(set);
+    vrna_dist_mx_free(mx);
+  }
+
+  vrna_fun_dispatch_enable();
+
+  for (i = 0; i < num; i++)
+    free(s[i]);
+
+  free(s);
+  free(pt);
+  free(mfe);
+  vrna_fold_compound_free(fc);
+}